@@ -247,6 +247,9 @@ public:
         return remaining_bits;
     }
 
+    /// The number of bits that were already read from the underlying stream, but not from this one.
+    ALWAYS_INLINE size_t buffered_bit_count() const { return m_bit_count; }
+
 private:
     ErrorOr<void> refill_buffer_from_stream(size_t requested_bit_count)
     {
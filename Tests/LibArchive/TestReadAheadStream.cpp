@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/MemoryStream.h>
+#include <LibArchive/ReadAheadStream.h>
+#include <LibTest/TestCase.h>
+
+static ByteBuffer make_data(size_t size)
+{
+    auto data = MUST(ByteBuffer::create_uninitialized(size));
+    for (size_t i = 0; i < size; ++i)
+        data[i] = static_cast<u8>(i * 7 + (i >> 8));
+    return data;
+}
+
+// Hands out its data a few bytes at a time, and then fails instead of reaching the end.
+class FailingStream final : public Stream {
+public:
+    FailingStream(ReadonlyBytes data)
+        : m_data(data)
+    {
+    }
+
+    virtual ErrorOr<Bytes> read_some(Bytes bytes) override
+    {
+        if (m_offset == m_data.size())
+            return Error::from_errno(EIO);
+        auto size = m_data.slice(m_offset).trim(13).copy_trimmed_to(bytes);
+        m_offset += size;
+        return bytes.trim(size);
+    }
+
+    virtual ErrorOr<size_t> write_some(ReadonlyBytes) override { return Error::from_errno(EBADF); }
+    virtual bool is_eof() const override { return false; }
+    virtual bool is_open() const override { return true; }
+    virtual void close() override { }
+
+private:
+    ReadonlyBytes m_data;
+    size_t m_offset { 0 };
+};
+
+TEST_CASE(read_across_chunk_boundaries)
+{
+    auto data = make_data(10'000);
+    auto stream = TRY_OR_FAIL(Archive::ReadAheadStream::create(make<FixedMemoryStream>(data.bytes()), 64, 3));
+
+    // Reads that are larger and smaller than a chunk, and that don't line up with chunk boundaries.
+    ByteBuffer result;
+    Array<size_t, 4> read_sizes { 100, 1, 63, 257 };
+    for (size_t i = 0; !stream->is_eof(); ++i) {
+        u8 buffer[257];
+        auto bytes = TRY_OR_FAIL(stream->read_some({ buffer, read_sizes[i % read_sizes.size()] }));
+        EXPECT(!bytes.is_empty());
+        result.append(bytes);
+    }
+    EXPECT_EQ(result, data);
+
+    // Reading past the end keeps returning nothing.
+    u8 buffer[16];
+    EXPECT(TRY_OR_FAIL(stream->read_some({ buffer, sizeof(buffer) })).is_empty());
+    EXPECT(stream->is_eof());
+}
+
+TEST_CASE(read_until_eof)
+{
+    for (size_t size : { 0, 1, 4096, 4097, 100'000 }) {
+        auto data = make_data(size);
+        auto stream = TRY_OR_FAIL(Archive::ReadAheadStream::create(make<FixedMemoryStream>(data.bytes()), 4096, 2));
+        EXPECT_EQ(TRY_OR_FAIL(stream->read_until_eof()), data);
+    }
+}
+
+TEST_CASE(error_is_reported_after_the_data_before_it)
+{
+    auto data = make_data(1'000);
+    auto stream = TRY_OR_FAIL(Archive::ReadAheadStream::create(make<FailingStream>(data.bytes()), 64, 2));
+
+    ByteBuffer result;
+    while (true) {
+        // The stream must not claim to be at its end while an error is still to be reported.
+        EXPECT(!stream->is_eof());
+
+        u8 buffer[100];
+        auto bytes = stream->read_some({ buffer, sizeof(buffer) });
+        if (bytes.is_error()) {
+            EXPECT_EQ(bytes.error().code(), EIO);
+            break;
+        }
+        result.append(bytes.value());
+    }
+    EXPECT_EQ(result, data);
+
+    // The error sticks.
+    u8 buffer[100];
+    auto bytes = stream->read_some({ buffer, sizeof(buffer) });
+    EXPECT(bytes.is_error());
+}
+
+TEST_CASE(error_propagates_through_read_until_eof)
+{
+    auto data = make_data(5'000);
+    auto stream = TRY_OR_FAIL(Archive::ReadAheadStream::create(make<FailingStream>(data.bytes()), 1024, 4));
+    auto result = stream->read_until_eof();
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.error().code(), EIO);
+}
+
+TEST_CASE(destroy_before_reading_everything)
+{
+    // The reader thread must be stopped while it waits for room in a chunk.
+    auto data = make_data(100'000);
+    auto stream = TRY_OR_FAIL(Archive::ReadAheadStream::create(make<FixedMemoryStream>(data.bytes()), 64, 2));
+    u8 buffer[10];
+    EXPECT_EQ(TRY_OR_FAIL(stream->read_some({ buffer, sizeof(buffer) })).size(), sizeof(buffer));
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/MemoryStream.h>
+#include <AK/Random.h>
+#include <LibArchive/Extraction.h>
+#include <LibArchive/Zip.h>
+#include <LibCore/DateTime.h>
+#include <LibCore/File.h>
+#include <LibCore/System.h>
+#include <LibFileSystem/FileSystem.h>
+#include <LibTest/TestCase.h>
+
+// Extraction works below the current directory, so every test runs in a fresh temporary directory.
+class TemporaryDirectory {
+public:
+    static ErrorOr<TemporaryDirectory> enter()
+    {
+        char pattern[] = "/tmp/test-zip-extraction.XXXXXX";
+        auto path = TRY(Core::System::mkdtemp(pattern)).to_byte_string();
+        auto previous_directory = TRY(Core::System::getcwd());
+        TRY(Core::System::chdir(path));
+        return TemporaryDirectory { move(path), move(previous_directory) };
+    }
+
+    ~TemporaryDirectory()
+    {
+        if (m_path.is_empty())
+            return;
+        MUST(Core::System::chdir(m_previous_directory));
+        MUST(FileSystem::remove(m_path, FileSystem::RecursionMode::Allowed));
+    }
+
+    TemporaryDirectory(TemporaryDirectory&& other)
+        : m_path(move(other.m_path))
+        , m_previous_directory(move(other.m_previous_directory))
+    {
+        other.m_path = {};
+    }
+
+private:
+    TemporaryDirectory(ByteString path, ByteString previous_directory)
+        : m_path(move(path))
+        , m_previous_directory(move(previous_directory))
+    {
+    }
+
+    ByteString m_path;
+    ByteString m_previous_directory;
+};
+
+struct TestFile {
+    StringView path;
+    ByteBuffer contents;
+};
+
+static Vector<TestFile> make_test_files()
+{
+    auto compressible = MUST(ByteBuffer::create_uninitialized(100'000));
+    for (size_t i = 0; i < compressible.size(); ++i)
+        compressible[i] = static_cast<u8>((i * i) >> 9);
+
+    auto random = MUST(ByteBuffer::create_uninitialized(10'000));
+    fill_with_random(random);
+
+    Vector<TestFile> files;
+    files.append({ "hello.txt"sv, MUST(ByteBuffer::copy("Hello, friends!\n"sv.bytes())) });
+    files.append({ "empty.txt"sv, {} });
+    files.append({ "data/compressible.bin"sv, move(compressible) });
+    files.append({ "data/nested/random.bin"sv, move(random) });
+    return files;
+}
+
+// Writes a zip of the test files, and returns its contents.
+static ByteBuffer make_zip(Vector<TestFile> const& files)
+{
+    auto now = Core::DateTime::now();
+    {
+        auto file = MUST(Core::File::open("archive.zip"sv, Core::File::OpenMode::Write));
+        Archive::ZipOutputStream zip_stream(move(file));
+        MUST(zip_stream.add_directory("data/"sv, now));
+        MUST(zip_stream.add_directory("data/nested/"sv, now));
+        for (auto const& test_file : files) {
+            FixedMemoryStream stream { test_file.contents.bytes() };
+            MUST(zip_stream.add_member_from_stream(test_file.path, stream, now));
+        }
+        MUST(zip_stream.finish());
+    }
+
+    auto file = MUST(Core::File::open("archive.zip"sv, Core::File::OpenMode::Read));
+    return MUST(file->read_until_eof());
+}
+
+static Vector<Archive::ZipMember> zip_members(ReadonlyBytes zip_data)
+{
+    auto zip = Archive::Zip::try_create(zip_data);
+    VERIFY(zip.has_value());
+
+    Vector<Archive::ZipMember> members;
+    MUST(zip->for_each_member([&](auto const& member) -> ErrorOr<IterationDecision> {
+        TRY(members.try_append(member));
+        return IterationDecision::Continue;
+    }));
+    return members;
+}
+
+TEST_CASE(extract_zip_members_on_several_threads)
+{
+    auto directory = TRY_OR_FAIL(TemporaryDirectory::enter());
+    auto files = make_test_files();
+    auto zip_data = make_zip(files);
+    auto members = zip_members(zip_data);
+    EXPECT_EQ(members.size(), 6u);
+
+    size_t extracted_count = 0;
+    auto result = Archive::extract_zip_members(members, 4, [&](auto const&, ErrorOr<void> const& member_result) {
+        EXPECT(!member_result.is_error());
+        ++extracted_count;
+    });
+    EXPECT(!result.is_error());
+    EXPECT_EQ(extracted_count, members.size());
+
+    EXPECT(FileSystem::is_directory("data/nested"sv));
+    for (auto const& test_file : files) {
+        auto file = TRY_OR_FAIL(Core::File::open(test_file.path, Core::File::OpenMode::Read));
+        auto contents = TRY_OR_FAIL(file->read_until_eof());
+        EXPECT_EQ(contents, test_file.contents);
+    }
+}
+
+TEST_CASE(extract_zip_members_reports_crc_mismatch)
+{
+    auto directory = TRY_OR_FAIL(TemporaryDirectory::enter());
+    auto files = make_test_files();
+    auto zip_data = make_zip(files);
+    auto members = zip_members(zip_data);
+
+    auto corrupted_member = members.find_first_index_if([](auto const& member) { return member.name == "data/compressible.bin"sv; });
+    EXPECT(corrupted_member.has_value());
+    members[*corrupted_member].crc32 ^= 1;
+
+    Vector<String> failed_members;
+    auto result = Archive::extract_zip_members(members, 4, [&](auto const& member, ErrorOr<void> const& member_result) {
+        if (member_result.is_error())
+            failed_members.append(member.name);
+    });
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.error().string_literal(), "CRC32 mismatch"sv);
+    EXPECT_EQ(failed_members, Vector<String> { "data/compressible.bin"_string });
+
+    // A file whose contents don't match the archive must not be left behind.
+    EXPECT(!FileSystem::exists("data/compressible.bin"sv));
+}
+
+TEST_CASE(decompress_zip_member_checks_size)
+{
+    auto directory = TRY_OR_FAIL(TemporaryDirectory::enter());
+    auto files = make_test_files();
+    auto zip_data = make_zip(files);
+    auto members = zip_members(zip_data);
+
+    for (auto member : members) {
+        if (member.is_directory || member.uncompressed_size == 0)
+            continue;
+
+        AllocatingMemoryStream output;
+        EXPECT(!Archive::decompress_zip_member(member, output).is_error());
+        EXPECT_EQ(output.used_buffer_size(), member.uncompressed_size);
+
+        AllocatingMemoryStream short_output;
+        member.uncompressed_size -= 1;
+        EXPECT(Archive::decompress_zip_member(member, short_output).is_error());
+
+        AllocatingMemoryStream long_output;
+        member.uncompressed_size += 2;
+        EXPECT(Archive::decompress_zip_member(member, long_output).is_error());
+    }
+}
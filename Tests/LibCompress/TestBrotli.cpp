@@ -9,7 +9,10 @@
 #include <AK/BitStream.h>
 #include <AK/MaybeOwned.h>
 #include <AK/MemoryStream.h>
+#include <AK/Random.h>
+#include <AK/StringBuilder.h>
 #include <LibCompress/Brotli.h>
+#include <LibCompress/Deflate.h>
 #include <LibCore/File.h>
 
 TEST_CASE(dictionary_use_after_uncompressed_block)
@@ -177,3 +180,109 @@ TEST_CASE(brotli_decompress_zero_one_bin)
     EXPECT(bytes_read == 32 * MiB);
     EXPECT(brotli_stream.is_eof());
 }
+
+static ByteBuffer brotli_round_trip(ReadonlyBytes input, u8 quality)
+{
+    auto compressed = MUST(Compress::BrotliCompressor::compress_all(input, quality));
+    auto decompressor = Compress::BrotliDecompressionStream { MaybeOwned<Stream>(make<FixedMemoryStream>(compressed.bytes())) };
+    auto decompressed = MUST(decompressor.read_until_eof());
+    EXPECT_EQ(decompressed.bytes(), input);
+    return compressed;
+}
+
+static ByteBuffer read_brotli_test_file(StringView file_name)
+{
+#ifdef AK_OS_SERENITY
+    ByteString path = ByteString::formatted("/usr/Tests/LibCompress/brotli-test-files/{}", file_name);
+#else
+    ByteString path = ByteString::formatted("brotli-test-files/{}", file_name);
+#endif
+    auto file = MUST(Core::File::open(path, Core::File::OpenMode::Read));
+    return MUST(file->read_until_eof());
+}
+
+TEST_CASE(brotli_compress_empty)
+{
+    for (u8 quality = 0; quality <= Compress::BrotliCompressor::maximum_quality; ++quality)
+        brotli_round_trip({}, quality);
+}
+
+TEST_CASE(brotli_compress_small)
+{
+    for (u8 quality = 0; quality <= Compress::BrotliCompressor::maximum_quality; ++quality) {
+        brotli_round_trip("x"sv.bytes(), quality);
+        brotli_round_trip("Hello, world!"sv.bytes(), quality);
+        brotli_round_trip("abcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabc"sv.bytes(), quality);
+    }
+}
+
+TEST_CASE(brotli_compress_quality_levels)
+{
+    auto input = read_brotli_test_file("happy3rd.html"sv);
+    size_t fastest_size = 0;
+    for (u8 quality = 0; quality <= Compress::BrotliCompressor::maximum_quality; ++quality) {
+        auto compressed = brotli_round_trip(input, quality);
+        if (quality == 0)
+            fastest_size = compressed.size();
+        else
+            EXPECT(compressed.size() <= fastest_size);
+    }
+}
+
+TEST_CASE(brotli_compress_multiple_meta_blocks)
+{
+    // Larger than the window of the lowest quality levels, so that the history is moved around.
+    StringBuilder builder;
+    for (size_t i = 0; i < 150000; ++i)
+        builder.appendff("line {}\n", i);
+    auto input = MUST(builder.to_byte_buffer());
+    brotli_round_trip(input, 0);
+    brotli_round_trip(input, Compress::BrotliCompressor::default_quality);
+}
+
+TEST_CASE(brotli_compress_incompressible)
+{
+    auto input = MUST(ByteBuffer::create_uninitialized(300 * KiB));
+    fill_with_random(input);
+    auto compressed = brotli_round_trip(input, Compress::BrotliCompressor::default_quality);
+    // Incompressible meta-blocks are stored as they are.
+    EXPECT(compressed.size() < input.size() + 64);
+}
+
+TEST_CASE(brotli_compress_streaming)
+{
+    auto input = read_brotli_test_file("transform.txt"sv);
+    auto stream = make<AllocatingMemoryStream>();
+    auto compressor = TRY_OR_FAIL(Compress::BrotliCompressor::create(MaybeOwned<Stream>(*stream)));
+    for (size_t offset = 0; offset < input.size(); offset += 1000)
+        TRY_OR_FAIL(compressor->write_until_depleted(input.bytes().slice(offset, min(1000uz, input.size() - offset))));
+    TRY_OR_FAIL(compressor->finish());
+    EXPECT(compressor->finish().is_error());
+
+    auto decompressor = Compress::BrotliDecompressionStream { MaybeOwned<Stream>(move(stream)) };
+    auto decompressed = TRY_OR_FAIL(decompressor.read_until_eof());
+    EXPECT_EQ(decompressed, input);
+}
+
+TEST_CASE(brotli_compression_ratio)
+{
+    // The default quality should do at least as well as Deflate.
+    auto input = read_brotli_test_file("KaticaRegular10.font"sv);
+    auto brotli = TRY_OR_FAIL(Compress::BrotliCompressor::compress_all(input));
+    auto deflate = TRY_OR_FAIL(Compress::DeflateCompressor::compress_all(input));
+    EXPECT(brotli.size() <= deflate.size());
+}
+
+BENCHMARK_CASE(brotli_compress_font)
+{
+    auto input = read_brotli_test_file("KaticaRegular10.font"sv);
+    for (u8 quality : Array<u8, 3> { 1, Compress::BrotliCompressor::default_quality, 9 })
+        (void)MUST(Compress::BrotliCompressor::compress_all(input, quality));
+}
+
+BENCHMARK_CASE(deflate_compress_font)
+{
+    auto input = read_brotli_test_file("KaticaRegular10.font"sv);
+    for (auto level : { Compress::DeflateCompressor::CompressionLevel::FAST, Compress::DeflateCompressor::CompressionLevel::GOOD, Compress::DeflateCompressor::CompressionLevel::GREAT })
+        (void)MUST(Compress::DeflateCompressor::compress_all(input, level));
+}
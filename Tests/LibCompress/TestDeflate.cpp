@@ -156,6 +156,94 @@ TEST_CASE(deflate_round_trip_compress_large)
     EXPECT(uncompressed == original);
 }
 
+TEST_CASE(deflate_compress_in_parallel_across_chunks)
+{
+    // Back references should be able to reach into the previous chunk.
+    auto random_data = ByteBuffer::create_uninitialized(20'000).release_value();
+    fill_with_random(random_data);
+    ByteBuffer original;
+    for (size_t i = 0; i < 3; ++i)
+        original.append(random_data);
+
+    auto compressed = TRY_OR_FAIL(Compress::DeflateCompressor::compress_all_in_parallel(original, random_data.size()));
+    EXPECT(compressed.size() < random_data.size() + 1'000);
+    auto uncompressed = TRY_OR_FAIL(Compress::DeflateDecompressor::decompress_all(compressed));
+    EXPECT(uncompressed == original);
+}
+
+TEST_CASE(deflate_decompress_with_varying_read_sizes)
+{
+    // Large reads are decoded straight into the caller's buffer and small ones through the window, so back references
+    // have to be resolved across both.
+    auto random_data = ByteBuffer::create_uninitialized(30'000).release_value();
+    fill_with_random(random_data);
+    ByteBuffer original;
+    for (size_t i = 0; i < 20; ++i) {
+        original.append(random_data.bytes().slice(0, 1'000 * (i + 1)));
+        original.append(random_data);
+    }
+
+    for (auto level : { Compress::DeflateCompressor::CompressionLevel::STORE, Compress::DeflateCompressor::CompressionLevel::GOOD }) {
+        auto compressed = TRY_OR_FAIL(Compress::DeflateCompressor::compress_all(original, level));
+        auto memory_stream = make<FixedMemoryStream>(compressed.bytes());
+        auto decompressor = TRY_OR_FAIL(Compress::DeflateDecompressor::construct(make<LittleEndianInputBitStream>(move(memory_stream))));
+
+        auto uncompressed = ByteBuffer::create_uninitialized(original.size()).release_value();
+        size_t offset = 0;
+        for (size_t i = 0; offset < uncompressed.size(); ++i) {
+            auto read_size = (i % 3 == 0) ? 100'000 : 7 * i;
+            auto read_bytes = TRY_OR_FAIL(decompressor->read_some(uncompressed.bytes().slice(offset).trim(read_size)));
+            EXPECT(!read_bytes.is_empty());
+            offset += read_bytes.size();
+        }
+        EXPECT(uncompressed == original);
+        EXPECT(decompressor->is_eof());
+    }
+}
+
+TEST_CASE(deflate_compress_with_dictionary)
+{
+    auto data = ByteBuffer::create_uninitialized(10'000).release_value();
+    fill_with_random(data);
+
+    // Compress the data twice, the second time primed with the first copy, and join the results into a single stream.
+    AllocatingMemoryStream stream;
+    auto first_compressor = TRY_OR_FAIL(Compress::DeflateCompressor::construct(MaybeOwned<Stream>(stream)));
+    TRY_OR_FAIL(first_compressor->write_until_depleted(data));
+    TRY_OR_FAIL(first_compressor->sync_flush_and_finish());
+    auto first_size = stream.used_buffer_size();
+
+    auto second_compressor = TRY_OR_FAIL(Compress::DeflateCompressor::construct(MaybeOwned<Stream>(stream)));
+    second_compressor->set_dictionary(data);
+    TRY_OR_FAIL(second_compressor->write_until_depleted(data));
+    TRY_OR_FAIL(second_compressor->final_flush());
+    EXPECT(stream.used_buffer_size() - first_size < 500);
+
+    auto compressed = TRY_OR_FAIL(stream.read_until_eof());
+    auto uncompressed = TRY_OR_FAIL(Compress::DeflateDecompressor::decompress_all(compressed));
+    EXPECT_EQ(uncompressed.bytes().slice(0, data.size()), data.bytes());
+    EXPECT_EQ(uncompressed.bytes().slice(data.size()), data.bytes());
+}
+
+TEST_CASE(parallel_deflate_compressor)
+{
+    auto original = ByteBuffer::create_uninitialized(100'000).release_value();
+    fill_with_random(original.bytes().trim(5'000));
+    for (size_t i = 5'000; i < original.size(); ++i)
+        original[i] = (i % 3 == 0) ? original[i - 4'321] : static_cast<u8>((i * i) >> 7);
+
+    AllocatingMemoryStream stream;
+    auto compressor = TRY_OR_FAIL(Compress::ParallelDeflateCompressor::construct(MaybeOwned<Stream>(stream), Compress::DeflateCompressor::CompressionLevel::FAST, 3, 1'000));
+    // Write in pieces that don't line up with the chunks, so that batches end in the middle of a write.
+    for (size_t offset = 0; offset < original.size(); offset += 777)
+        TRY_OR_FAIL(compressor->write_until_depleted(original.bytes().slice(offset, min(777uz, original.size() - offset))));
+    TRY_OR_FAIL(compressor->final_flush());
+
+    auto compressed = TRY_OR_FAIL(stream.read_until_eof());
+    auto uncompressed = TRY_OR_FAIL(Compress::DeflateDecompressor::decompress_all(compressed));
+    EXPECT(uncompressed == original);
+}
+
 TEST_CASE(deflate_compress_literals)
 {
     // This byte array is known to not produce any back references with our lz77 implementation even at the highest compression settings
@@ -180,3 +268,22 @@ TEST_CASE(ossfuzz_58046)
     auto test_data = TRY_OR_FAIL(test_file->read_until_eof());
     EXPECT(Compress::DeflateDecompressor::decompress_all(test_data).is_error());
 }
+
+BENCHMARK_CASE(deflate_decompress)
+{
+    // Compressible data with literals as well as back references of all kinds of lengths and distances.
+    auto random_data = ByteBuffer::create_uninitialized(64 * KiB).release_value();
+    fill_with_random(random_data);
+    ByteBuffer original;
+    for (size_t i = 0; original.size() < 8 * MiB; ++i) {
+        auto offset = (i * 7919) % (random_data.size() - 512);
+        original.append(random_data.bytes().slice(offset, 3 + (i * 31) % 509));
+        original.append(static_cast<u8>('a' + i % 26));
+    }
+    auto compressed = TRY_OR_FAIL(Compress::DeflateCompressor::compress_all(original));
+
+    for (size_t i = 0; i < 10; ++i) {
+        auto uncompressed = TRY_OR_FAIL(Compress::DeflateDecompressor::decompress_all(compressed));
+        EXPECT_EQ(uncompressed.size(), original.size());
+    }
+}
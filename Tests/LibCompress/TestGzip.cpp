@@ -6,7 +6,9 @@
 
 #include <LibTest/TestCase.h>
 
+#include <AK/AnyOf.h>
 #include <AK/Array.h>
+#include <AK/MemoryStream.h>
 #include <AK/Random.h>
 #include <LibCompress/Gzip.h>
 
@@ -94,6 +96,23 @@ TEST_CASE(gzip_round_trip)
     EXPECT(uncompressed == original);
 }
 
+TEST_CASE(gzip_round_trip_in_parallel)
+{
+    auto original = ByteBuffer::create_uninitialized(300'000).release_value();
+    fill_with_random(original.bytes().trim(1'000));
+    for (size_t i = 1'000; i < original.size(); ++i)
+        original[i] = original[i - 1'000] ^ static_cast<u8>(i >> 12);
+
+    AllocatingMemoryStream stream;
+    auto compressor = TRY_OR_FAIL(Compress::ParallelGzipCompressor::construct(MaybeOwned<Stream>(stream), 4, 16 * KiB));
+    TRY_OR_FAIL(compressor->write_until_depleted(original));
+    TRY_OR_FAIL(compressor->finish());
+
+    auto compressed = TRY_OR_FAIL(stream.read_until_eof());
+    auto uncompressed = TRY_OR_FAIL(Compress::GzipDecompressor::decompress_all(compressed));
+    EXPECT(uncompressed == original);
+}
+
 TEST_CASE(gzip_truncated_uncompressed_block)
 {
     Array<u8, 38> const compressed {
@@ -105,3 +124,95 @@ TEST_CASE(gzip_truncated_uncompressed_block)
     auto const decompressed_or_error = Compress::GzipDecompressor::decompress_all(compressed);
     EXPECT(decompressed_or_error.is_error());
 }
+
+static ByteBuffer create_gzip_test_data(size_t size)
+{
+    auto data = ByteBuffer::create_uninitialized(size).release_value();
+    fill_with_random(data.bytes().trim(1'000));
+    for (size_t i = 1'000; i < data.size(); ++i)
+        data[i] = data[i - 1'000] ^ static_cast<u8>(i >> 12);
+    return data;
+}
+
+static void expect_random_access(SeekableStream& stream, ReadonlyBytes original)
+{
+    auto buffer = ByteBuffer::create_uninitialized(5'000).release_value();
+    for (size_t i = 0; i < 50; ++i) {
+        auto offset = get_random_uniform(original.size());
+        EXPECT_EQ(TRY_OR_FAIL(stream.seek(offset, SeekMode::SetPosition)), offset);
+
+        auto size = min(buffer.size(), original.size() - offset);
+        TRY_OR_FAIL(stream.read_until_filled(buffer.bytes().trim(size)));
+        EXPECT(buffer.bytes().trim(size) == original.slice(offset, size));
+        EXPECT_EQ(TRY_OR_FAIL(stream.tell()), offset + size);
+    }
+
+    EXPECT_EQ(TRY_OR_FAIL(stream.seek(0, SeekMode::FromEndPosition)), original.size());
+    EXPECT(stream.is_eof());
+    EXPECT(stream.seek(1, SeekMode::FromCurrentPosition).is_error());
+
+    TRY_OR_FAIL(stream.seek(0, SeekMode::SetPosition));
+    EXPECT(TRY_OR_FAIL(stream.read_until_eof()) == original);
+}
+
+TEST_CASE(gzip_index_random_access)
+{
+    auto original = create_gzip_test_data(600'000);
+    auto compressed = TRY_OR_FAIL(Compress::GzipCompressor::compress_all(original));
+
+    auto index = TRY_OR_FAIL(Compress::GzipIndex::create(compressed, 64 * KiB));
+    EXPECT_EQ(index.uncompressed_size(), original.size());
+    EXPECT(index.access_points().size() >= 5);
+    for (auto const& access_point : index.access_points()) {
+        EXPECT(!access_point.starts_member);
+        EXPECT_EQ(access_point.history.size(), 32 * KiB);
+    }
+
+    auto decompressor = TRY_OR_FAIL(Compress::SeekableGzipDecompressor::create(compressed, move(index)));
+    expect_random_access(*decompressor, original);
+}
+
+TEST_CASE(gzip_index_multiple_members)
+{
+    ByteBuffer original;
+    ByteBuffer compressed;
+    for (size_t i = 0; i < 5; ++i) {
+        auto member = create_gzip_test_data(50'000 + i * 10'000);
+        original.append(member);
+        compressed.append(TRY_OR_FAIL(Compress::GzipCompressor::compress_all(member)));
+    }
+
+    auto index = TRY_OR_FAIL(Compress::GzipIndex::create(compressed, 40 * KiB));
+    EXPECT_EQ(index.uncompressed_size(), original.size());
+    EXPECT(any_of(index.access_points(), [](auto const& access_point) { return access_point.starts_member; }));
+
+    auto decompressor = TRY_OR_FAIL(Compress::SeekableGzipDecompressor::create(compressed, move(index)));
+    expect_random_access(*decompressor, original);
+}
+
+TEST_CASE(gzip_index_sidecar_round_trip)
+{
+    auto original = create_gzip_test_data(300'000);
+    auto compressed = TRY_OR_FAIL(Compress::GzipCompressor::compress_all(original));
+    auto index = TRY_OR_FAIL(Compress::GzipIndex::create(compressed, 32 * KiB));
+
+    AllocatingMemoryStream sidecar;
+    TRY_OR_FAIL(index.write_to_stream(sidecar));
+    auto sidecar_data = TRY_OR_FAIL(sidecar.read_until_eof());
+
+    FixedMemoryStream sidecar_stream { sidecar_data.bytes() };
+    auto read_index = TRY_OR_FAIL(Compress::GzipIndex::read_from_stream(sidecar_stream));
+    EXPECT_EQ(read_index.access_points().size(), index.access_points().size());
+    EXPECT(read_index.matches(compressed));
+
+    auto decompressor = TRY_OR_FAIL(Compress::SeekableGzipDecompressor::create(compressed, move(read_index)));
+    expect_random_access(*decompressor, original);
+
+    // An index doesn't fit other files, or survive being cut off.
+    auto other_compressed = TRY_OR_FAIL(Compress::GzipCompressor::compress_all(create_gzip_test_data(300'000)));
+    EXPECT(!index.matches(other_compressed));
+    EXPECT(Compress::SeekableGzipDecompressor::create(other_compressed, move(index)).is_error());
+
+    FixedMemoryStream truncated_stream { sidecar_data.bytes().trim(sidecar_data.size() - 1) };
+    EXPECT(Compress::GzipIndex::read_from_stream(truncated_stream).is_error());
+}
@@ -7,6 +7,8 @@
 #include <LibTest/TestCase.h>
 
 #include <AK/MemoryStream.h>
+#include <AK/Random.h>
+#include <LibCompress/Lzma2.h>
 #include <LibCompress/Xz.h>
 
 TEST_CASE(lzma2_compressed_without_settings_after_uncompressed)
@@ -1939,6 +1941,11 @@ TEST_CASE(xz_utils_good_2_lzma2)
     auto decompressor = MUST(Compress::XzDecompressor::create(move(stream)));
     auto buffer = TRY_OR_FAIL(decompressor->read_until_eof(PAGE_SIZE));
     EXPECT_EQ(buffer.span(), xz_utils_hello_world.bytes());
+
+    AllocatingMemoryStream output;
+    TRY_OR_FAIL(Compress::XzDecompressor::decompress_all_in_parallel(compressed, output, 2));
+    auto parallel_buffer = TRY_OR_FAIL(output.read_until_eof());
+    EXPECT_EQ(parallel_buffer.span(), xz_utils_hello_world.bytes());
 }
 
 // The following test files are designated as "unsupported", which usually means that they test indicators
@@ -2057,3 +2064,126 @@ TEST_CASE(xz_utils_unsupported_filter_flags_3)
     auto buffer_or_error = decompressor->read_until_eof(PAGE_SIZE);
     EXPECT(buffer_or_error.is_error());
 }
+
+static ByteBuffer create_compressible_data(size_t size)
+{
+    auto random_data = MUST(ByteBuffer::create_uninitialized(4 * KiB));
+    fill_with_random(random_data);
+    auto data = MUST(ByteBuffer::create_uninitialized(size));
+    for (size_t i = 0; i < size; i += 64)
+        random_data.bytes().slice(get_random_uniform(random_data.size() - 64), 64).copy_trimmed_to(data.bytes().slice(i));
+    return data;
+}
+
+TEST_CASE(lzma2_uncompressed_chunk_larger_than_dictionary)
+{
+    auto data = create_compressible_data(8 * KiB);
+
+    // A dictionary reset followed by a single uncompressed chunk of 8 KiB, which is twice the size of the dictionary.
+    Array<u8, 3> const chunk_header { 0x01, 0x1F, 0xFF };
+    ByteBuffer raw;
+    raw.append(chunk_header);
+    raw.append(data);
+    raw.append(0x00);
+
+    auto stream = MUST(try_make<FixedMemoryStream>(raw.bytes()));
+    auto decompressor = TRY_OR_FAIL(Compress::Lzma2Decompressor::create_from_raw_stream(move(stream), 4 * KiB));
+    auto uncompressed = TRY_OR_FAIL(decompressor->read_until_eof(64 * KiB));
+    EXPECT(uncompressed == data);
+}
+
+TEST_CASE(xz_compress_round_trip)
+{
+    auto original = create_compressible_data(300 * KiB);
+    auto compressed = TRY_OR_FAIL(Compress::XzCompressor::compress_all(original, 4, 64 * KiB));
+    EXPECT(compressed.size() < original.size() / 2);
+
+    auto stream = MUST(try_make<FixedMemoryStream>(compressed.bytes()));
+    auto decompressor = MUST(Compress::XzDecompressor::create(move(stream)));
+    auto uncompressed = TRY_OR_FAIL(decompressor->read_until_eof(PAGE_SIZE));
+    EXPECT(uncompressed == original);
+
+    AllocatingMemoryStream output;
+    TRY_OR_FAIL(Compress::XzDecompressor::decompress_all_in_parallel(compressed, output, 4));
+    EXPECT(TRY_OR_FAIL(output.read_until_eof()) == original);
+}
+
+TEST_CASE(xz_compress_empty)
+{
+    auto compressed = TRY_OR_FAIL(Compress::XzCompressor::compress_all({}));
+
+    auto stream = MUST(try_make<FixedMemoryStream>(compressed.bytes()));
+    auto decompressor = MUST(Compress::XzDecompressor::create(move(stream)));
+    EXPECT(TRY_OR_FAIL(decompressor->read_until_eof(PAGE_SIZE)).is_empty());
+
+    AllocatingMemoryStream output;
+    TRY_OR_FAIL(Compress::XzDecompressor::decompress_all_in_parallel(compressed, output));
+    EXPECT_EQ(output.used_buffer_size(), 0u);
+}
+
+TEST_CASE(xz_decompress_in_parallel_multiple_streams)
+{
+    auto first = create_compressible_data(100 * KiB);
+    auto second = TRY_OR_FAIL(ByteBuffer::create_zeroed(150 * KiB));
+
+    ByteBuffer compressed;
+    compressed.append(TRY_OR_FAIL(Compress::XzCompressor::compress_all(first, 2, 32 * KiB)));
+    compressed.append("\0\0\0\0\0\0\0\0"sv.bytes()); // Stream Padding
+    compressed.append(TRY_OR_FAIL(Compress::XzCompressor::compress_all(second, 2, 32 * KiB)));
+
+    ByteBuffer original;
+    original.append(first);
+    original.append(second);
+
+    AllocatingMemoryStream output;
+    TRY_OR_FAIL(Compress::XzDecompressor::decompress_all_in_parallel(compressed, output, 3));
+    EXPECT(TRY_OR_FAIL(output.read_until_eof()) == original);
+}
+
+TEST_CASE(xz_decompress_in_parallel_corrupted_index)
+{
+    auto original = create_compressible_data(100 * KiB);
+    auto compressed = TRY_OR_FAIL(Compress::XzCompressor::compress_all(original, 2, 32 * KiB));
+
+    // The last record of the Index is right before the Index Padding, the CRC32 and the Stream Footer.
+    compressed[compressed.size() - 12 - 4 - 2] ^= 1;
+
+    AllocatingMemoryStream output;
+    EXPECT(Compress::XzDecompressor::decompress_all_in_parallel(compressed, output).is_error());
+}
+
+TEST_CASE(xz_seek)
+{
+    auto first = create_compressible_data(200 * KiB);
+    auto second = create_compressible_data(100 * KiB);
+
+    ByteBuffer compressed;
+    compressed.append(TRY_OR_FAIL(Compress::XzCompressor::compress_all(first, 2, 32 * KiB)));
+    compressed.append("\0\0\0\0"sv.bytes()); // Stream Padding
+    compressed.append(TRY_OR_FAIL(Compress::XzCompressor::compress_all(second, 2, 16 * KiB)));
+
+    ByteBuffer original;
+    original.append(first);
+    original.append(second);
+
+    auto decompressor = TRY_OR_FAIL(Compress::SeekableXzDecompressor::create(compressed));
+    EXPECT_EQ(TRY_OR_FAIL(decompressor->size()), original.size());
+    EXPECT_EQ(decompressor->blocks().size(), 7u + 7u);
+
+    auto buffer = TRY_OR_FAIL(ByteBuffer::create_uninitialized(5'000));
+    for (size_t i = 0; i < 50; ++i) {
+        auto offset = get_random_uniform(original.size());
+        EXPECT_EQ(TRY_OR_FAIL(decompressor->seek(offset, SeekMode::SetPosition)), offset);
+
+        auto size = min(buffer.size(), original.size() - offset);
+        TRY_OR_FAIL(decompressor->read_until_filled(buffer.bytes().trim(size)));
+        EXPECT(buffer.bytes().trim(size) == original.bytes().slice(offset, size));
+    }
+
+    EXPECT_EQ(TRY_OR_FAIL(decompressor->seek(-1000, SeekMode::FromEndPosition)), original.size() - 1000);
+    EXPECT(TRY_OR_FAIL(decompressor->read_until_eof()) == original.bytes().slice_from_end(1000));
+    EXPECT(decompressor->is_eof());
+
+    TRY_OR_FAIL(decompressor->seek(0, SeekMode::SetPosition));
+    EXPECT(TRY_OR_FAIL(decompressor->read_until_eof()) == original);
+}
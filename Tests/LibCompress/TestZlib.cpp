@@ -81,3 +81,22 @@ TEST_CASE(zlib_decompress_with_missing_end_bits)
     auto decompressed = TRY_OR_FAIL(decompressor->read_until_eof());
     EXPECT_EQ(decompressed.span(), uncompressed.span());
 }
+
+TEST_CASE(zlib_compress_in_parallel)
+{
+    auto data = TRY_OR_FAIL(ByteBuffer::create_uninitialized(100'000));
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<u8>((i * i) >> 7);
+
+    // Chunk sizes that divide the data evenly, leave a short last chunk, and exceed the size of the data.
+    for (size_t chunk_size : { 1'000uz, 12'345uz, 200'000uz }) {
+        auto compressed = TRY_OR_FAIL(Compress::ZlibCompressor::compress_all_in_parallel(data, chunk_size, Compress::ZlibCompressionLevel::Default, 3));
+        auto decompressor = TRY_OR_FAIL(Compress::ZlibDecompressor::create(make<FixedMemoryStream>(compressed.bytes())));
+        auto decompressed = TRY_OR_FAIL(decompressor->read_until_eof());
+        EXPECT_EQ(decompressed.span(), data.span());
+    }
+
+    auto compressed = TRY_OR_FAIL(Compress::ZlibCompressor::compress_all_in_parallel({}, 1'000));
+    auto decompressor = TRY_OR_FAIL(Compress::ZlibDecompressor::create(make<FixedMemoryStream>(compressed.bytes())));
+    EXPECT(TRY_OR_FAIL(decompressor->read_until_eof()).is_empty());
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/AllOf.h>
+#include <AK/MemoryStream.h>
+#include <AK/Random.h>
+#include <AK/StringBuilder.h>
+#include <LibCompress/Deflate.h>
+#include <LibCompress/Zstd.h>
+#include <LibCore/File.h>
+
+static ByteString test_file_path(StringView file_name)
+{
+    // This makes sure that the tests will run both on target and in Lagom.
+#ifdef AK_OS_SERENITY
+    return ByteString::formatted("/usr/Tests/LibCompress/zstd-test-files/{}", file_name);
+#else
+    return ByteString::formatted("zstd-test-files/{}", file_name);
+#endif
+}
+
+static ByteBuffer read_test_file(StringView file_name)
+{
+    auto file = MUST(Core::File::open(test_file_path(file_name), Core::File::OpenMode::Read));
+    return MUST(file->read_until_eof());
+}
+
+static ByteBuffer decompress_test_file(StringView file_name)
+{
+    auto file = MUST(Core::File::open(test_file_path(file_name), Core::File::OpenMode::Read));
+    auto decompressor = MUST(Compress::ZstdDecompressor::create(MaybeOwned<Stream> { *file }));
+    return MUST(decompressor->read_until_eof());
+}
+
+static void run_test(StringView file_name)
+{
+    auto data = decompress_test_file(ByteString::formatted("{}.zst", file_name));
+    EXPECT_EQ(data, read_test_file(file_name));
+}
+
+static ByteBuffer generate_lines(size_t count)
+{
+    StringBuilder builder;
+    for (size_t i = 0; i < count; ++i)
+        builder.appendff("line {}\n", i);
+    return MUST(builder.to_byte_buffer());
+}
+
+static void expect_round_trip(ReadonlyBytes input)
+{
+    auto compressed = TRY_OR_FAIL(Compress::ZstdCompressor::compress_all(input));
+    EXPECT(Compress::ZstdDecompressor::is_likely_compressed(compressed));
+    auto decompressed = TRY_OR_FAIL(Compress::ZstdDecompressor::decompress_all(compressed));
+    EXPECT_EQ(decompressed.bytes(), input);
+}
+
+TEST_CASE(zstd_decompress_raw_block)
+{
+    run_test("hello.txt"sv);
+}
+
+TEST_CASE(zstd_decompress_without_checksum)
+{
+    run_test("lorem.txt"sv);
+}
+
+TEST_CASE(zstd_decompress_html)
+{
+    run_test("happy3rd.html"sv);
+}
+
+TEST_CASE(zstd_decompress_multiple_blocks)
+{
+    // Compressed at the highest level, which uses FSE-compressed and repeated tables across blocks.
+    auto data = decompress_test_file("lines.txt.zst"sv);
+    EXPECT_EQ(data, generate_lines(100000));
+}
+
+TEST_CASE(zstd_decompress_rle_blocks)
+{
+    auto data = decompress_test_file("zeros.bin.zst"sv);
+    EXPECT_EQ(data.size(), 300000u);
+    EXPECT(all_of(data.bytes(), [](u8 byte) { return byte == 0; }));
+}
+
+TEST_CASE(zstd_decompress_empty)
+{
+    auto data = decompress_test_file("empty.zst"sv);
+    EXPECT(data.is_empty());
+}
+
+TEST_CASE(zstd_decompress_concatenated_and_skippable_frames)
+{
+    auto data = decompress_test_file("concatenated.zst"sv);
+    auto expected = read_test_file("hello.txt"sv);
+    expected.append(read_test_file("lorem.txt"sv));
+    EXPECT_EQ(data, expected);
+}
+
+TEST_CASE(zstd_decompress_checksum_mismatch)
+{
+    auto compressed = read_test_file("happy3rd.html.zst"sv);
+    compressed[compressed.size() - 1] ^= 1;
+    EXPECT(Compress::ZstdDecompressor::decompress_all(compressed).is_error());
+}
+
+TEST_CASE(zstd_decompress_truncated)
+{
+    auto compressed = read_test_file("happy3rd.html.zst"sv);
+    for (size_t size : { 0uz, 3uz, 4uz, 10uz, compressed.size() / 2, compressed.size() - 1 }) {
+        if (size == 0)
+            continue;
+        EXPECT(Compress::ZstdDecompressor::decompress_all(compressed.bytes().trim(size)).is_error());
+    }
+}
+
+TEST_CASE(zstd_decompress_invalid_magic)
+{
+    Array<u8, 8> const data { 0x28, 0xB5, 0x2F, 0xFE, 0x00, 0x00, 0x00, 0x00 };
+    EXPECT(Compress::ZstdDecompressor::decompress_all(data).is_error());
+}
+
+TEST_CASE(zstd_round_trip_empty)
+{
+    expect_round_trip({});
+}
+
+TEST_CASE(zstd_round_trip_small)
+{
+    expect_round_trip("Hello, world!"sv.bytes());
+    expect_round_trip("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"sv.bytes());
+}
+
+TEST_CASE(zstd_round_trip_text)
+{
+    expect_round_trip(read_test_file("happy3rd.html"sv));
+    expect_round_trip(read_test_file("lorem.txt"sv));
+}
+
+TEST_CASE(zstd_round_trip_multiple_blocks)
+{
+    // Larger than the window, so that matches have to be found across blocks and the history is moved around.
+    expect_round_trip(generate_lines(300000));
+}
+
+TEST_CASE(zstd_round_trip_incompressible)
+{
+    auto data = MUST(ByteBuffer::create_uninitialized(300 * KiB));
+    fill_with_random(data);
+    auto compressed = TRY_OR_FAIL(Compress::ZstdCompressor::compress_all(data));
+    // Incompressible blocks are stored as they are.
+    EXPECT(compressed.size() < data.size() + 64);
+    auto decompressed = TRY_OR_FAIL(Compress::ZstdDecompressor::decompress_all(compressed));
+    EXPECT_EQ(decompressed, data);
+}
+
+TEST_CASE(zstd_round_trip_streaming)
+{
+    auto input = generate_lines(50000);
+    auto output_stream = make<AllocatingMemoryStream>();
+    auto compressor = TRY_OR_FAIL(Compress::ZstdCompressor::create(MaybeOwned<Stream> { *output_stream }));
+    // Write in uneven pieces, to cross block boundaries in the middle of writes.
+    for (size_t offset = 0; offset < input.size(); offset += 12345)
+        TRY_OR_FAIL(compressor->write_until_depleted(input.bytes().slice(offset, min(12345uz, input.size() - offset))));
+    TRY_OR_FAIL(compressor->finish());
+    EXPECT(compressor->finish().is_error());
+
+    auto decompressor = TRY_OR_FAIL(Compress::ZstdDecompressor::create(move(output_stream)));
+    auto decompressed = TRY_OR_FAIL(decompressor->read_until_eof());
+    EXPECT_EQ(decompressed, input);
+}
+
+TEST_CASE(zstd_compression_ratio)
+{
+    // The fast zstd compressor should be in the same league as Deflate.
+    auto input = read_test_file("happy3rd.html"sv);
+    auto zstd = TRY_OR_FAIL(Compress::ZstdCompressor::compress_all(input));
+    auto deflate = TRY_OR_FAIL(Compress::DeflateCompressor::compress_all(input));
+    EXPECT(zstd.size() < deflate.size() * 5 / 4);
+}
+
+BENCHMARK_CASE(zstd_compress_text)
+{
+    auto input = generate_lines(500000);
+    for (size_t i = 0; i < 10; ++i)
+        (void)MUST(Compress::ZstdCompressor::compress_all(input));
+}
+
+BENCHMARK_CASE(deflate_compress_text)
+{
+    auto input = generate_lines(500000);
+    for (size_t i = 0; i < 10; ++i)
+        (void)MUST(Compress::DeflateCompressor::compress_all(input));
+}
+
+BENCHMARK_CASE(zstd_decompress_text)
+{
+    auto compressed = MUST(Compress::ZstdCompressor::compress_all(generate_lines(500000)));
+    for (size_t i = 0; i < 10; ++i)
+        (void)MUST(Compress::ZstdDecompressor::decompress_all(compressed));
+}
+
+BENCHMARK_CASE(deflate_decompress_text)
+{
+    auto compressed = MUST(Compress::DeflateCompressor::compress_all(generate_lines(500000)));
+    for (size_t i = 0; i < 10; ++i)
+        (void)MUST(Compress::DeflateDecompressor::decompress_all(compressed));
+}
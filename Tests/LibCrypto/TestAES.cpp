@@ -4,7 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Random.h>
 #include <LibCrypto/BigInt/UnsignedBigInteger.h>
+#include <LibCrypto/CPUFeatures.h>
 #include <LibCrypto/Checksum/Adler32.h>
 #include <LibCrypto/Cipher/AES.h>
 #include <LibTest/TestCase.h>
@@ -465,3 +467,72 @@ TEST_CASE(test_AES_GCM_128bit_decrypt_multiple_blocks_with_aad)
     EXPECT(memcmp(result_pt, out.data(), out.size()) == 0);
     EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
 }
+
+// Runs an operation with the portable implementation and with the accelerated one (if any), which must agree.
+template<typename Callback>
+static void expect_same_result_with_and_without_acceleration(Callback callback)
+{
+    Crypto::set_enabled_cpu_features(Crypto::CPUFeatures::None);
+    auto portable = callback();
+    Crypto::set_enabled_cpu_features(Crypto::CPUFeatures::All);
+    auto accelerated = callback();
+    EXPECT_EQ(portable, accelerated);
+}
+
+TEST_CASE(test_AES_accelerated_implementation)
+{
+    // These cover the blocks that are processed in parallel, the ones after them and partial blocks.
+    constexpr size_t lengths[] { 16, 48, 128, 144, 200, 1024, 4099 };
+
+    auto input = ByteBuffer::create_uninitialized(4099).release_value();
+    fill_with_random(input);
+    auto aad = ByteBuffer::create_uninitialized(77).release_value();
+    fill_with_random(aad);
+    u8 iv[16];
+    fill_with_random(iv);
+    // Make the low half of the counter overflow in the middle of the data.
+    memset(iv + 8, 0xff, 7);
+
+    for (size_t key_bits : { 128, 192, 256 }) {
+        auto key = ByteBuffer::create_uninitialized(key_bits / 8).release_value();
+        fill_with_random(key);
+
+        for (auto length : lengths) {
+            auto in = input.bytes().trim(length);
+
+            expect_same_result_with_and_without_acceleration([&] {
+                Crypto::Cipher::AESCipher::CBCMode cipher(key, key_bits, Crypto::Cipher::Intent::Encryption);
+                auto out = cipher.create_aligned_buffer(length).release_value();
+                auto out_bytes = out.bytes();
+                cipher.encrypt(in, out_bytes, { iv, 16 });
+                return out;
+            });
+
+            if (length % 16 == 0) {
+                expect_same_result_with_and_without_acceleration([&] {
+                    Crypto::Cipher::AESCipher::CBCMode cipher(key, key_bits, Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::Null);
+                    auto out = ByteBuffer::create_uninitialized(length).release_value();
+                    auto out_bytes = out.bytes();
+                    cipher.decrypt(in, out_bytes, { iv, 16 });
+                    return out;
+                });
+            }
+
+            expect_same_result_with_and_without_acceleration([&] {
+                Crypto::Cipher::AESCipher::CTRMode cipher(key, key_bits, Crypto::Cipher::Intent::Encryption);
+                auto out = ByteBuffer::create_uninitialized(length + 16).release_value();
+                auto out_bytes = out.bytes();
+                Bytes next_iv = out_bytes.slice(length);
+                cipher.encrypt(in, out_bytes, { iv, 16 }, &next_iv);
+                return out;
+            });
+
+            expect_same_result_with_and_without_acceleration([&] {
+                Crypto::Cipher::AESCipher::GCMMode cipher(key, key_bits, Crypto::Cipher::Intent::Encryption);
+                auto out = ByteBuffer::create_uninitialized(length + 16).release_value();
+                cipher.encrypt(in, out.bytes().trim(length), { iv, 16 }, aad, out.bytes().slice(length));
+                return out;
+            });
+        }
+    }
+}
@@ -23,6 +23,36 @@ static Crypto::UnsignedBigInteger bigint_fibonacci(size_t n)
     return num1;
 }
 
+// Deterministic numbers with all of their words set, so that the tests exercise the same code paths on every run.
+static Crypto::UnsignedBigInteger bigint_pseudo_random(size_t number_of_words, u32 seed)
+{
+    Vector<u32, Crypto::STARTING_WORD_SIZE> words;
+    u32 state = seed;
+    for (size_t i = 0; i < number_of_words; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        words.append(state);
+    }
+    words.last() |= 1u << 31;
+    return Crypto::UnsignedBigInteger { move(words) };
+}
+
+// Multiplies in pieces of the right operand that are small enough for the schoolbook method.
+static Crypto::UnsignedBigInteger bigint_reference_product(Crypto::UnsignedBigInteger const& left, Crypto::UnsignedBigInteger const& right)
+{
+    constexpr size_t piece_length = 8;
+    Crypto::UnsignedBigInteger result { 0 };
+    auto const& words = right.words();
+    for (size_t offset = 0; offset < words.size(); offset += piece_length) {
+        Vector<u32, Crypto::STARTING_WORD_SIZE> piece;
+        piece.append(words.span().slice(offset, min(piece_length, words.size() - offset)).data(), min(piece_length, words.size() - offset));
+        auto product = left.multiplied_by(Crypto::UnsignedBigInteger { move(piece) });
+        result = result.plus(product.shift_left(offset * 32));
+    }
+    return result;
+}
+
 static Crypto::SignedBigInteger bigint_signed_fibonacci(size_t n)
 {
     Crypto::SignedBigInteger num1(0);
@@ -232,6 +262,65 @@ TEST_CASE(test_unsigned_bigint_division_combined_test)
     EXPECT_EQ(div_result.quotient.multiplied_by(num2).plus(div_result.remainder), num1);
 }
 
+TEST_CASE(test_unsigned_bigint_multiplication_karatsuba)
+{
+    struct Lengths {
+        size_t left;
+        size_t right;
+    };
+    for (auto [left_length, right_length] : Array<Lengths, 5> { { { 32, 32 }, { 63, 40 }, { 100, 100 }, { 200, 37 }, { 500, 130 } } }) {
+        auto left = bigint_pseudo_random(left_length, left_length);
+        auto right = bigint_pseudo_random(right_length, right_length + 1000);
+        auto result = left.multiplied_by(right);
+        EXPECT_EQ(result, bigint_reference_product(left, right));
+        EXPECT_EQ(result, right.multiplied_by(left));
+        EXPECT_EQ(result.length(), left_length + right_length);
+    }
+}
+
+TEST_CASE(test_unsigned_bigint_multiplication_toom_3)
+{
+    auto left = bigint_pseudo_random(2500, 1);
+    auto right = bigint_pseudo_random(2200, 2);
+    EXPECT_EQ(left.multiplied_by(right), bigint_reference_product(left, right));
+}
+
+TEST_CASE(test_unsigned_bigint_squaring)
+{
+    for (size_t length : { 1uz, 5uz, 31uz, 32uz, 77uz, 300uz, 2100uz }) {
+        auto number = bigint_pseudo_random(length, length);
+        auto copy = number;
+        EXPECT_EQ(number.multiplied_by(number), bigint_reference_product(number, copy));
+    }
+
+    // Every word is all ones, which maximizes the carries.
+    auto number = Crypto::UnsignedBigInteger { 1 }.shift_left(100 * 32).minus(1);
+    auto copy = number;
+    EXPECT_EQ(number.multiplied_by(number), bigint_reference_product(number, copy));
+}
+
+TEST_CASE(test_unsigned_bigint_division_burnikel_ziegler)
+{
+    struct Lengths {
+        size_t numerator;
+        size_t denominator;
+    };
+    for (auto [numerator_length, denominator_length] : Array<Lengths, 4> { { { 600, 256 }, { 1000, 300 }, { 1500, 700 }, { 2000, 513 } } }) {
+        auto numerator = bigint_pseudo_random(numerator_length, numerator_length);
+        auto denominator = bigint_pseudo_random(denominator_length, denominator_length + 1000);
+        auto result = numerator.divided_by(denominator);
+        EXPECT(result.remainder < denominator);
+        EXPECT_EQ(result.quotient.multiplied_by(denominator).plus(result.remainder), numerator);
+    }
+
+    // An exact division, where the numerator is a product.
+    auto left = bigint_pseudo_random(700, 3);
+    auto right = bigint_pseudo_random(600, 4);
+    auto result = left.multiplied_by(right).divided_by(right);
+    EXPECT_EQ(result.quotient, left);
+    EXPECT(result.remainder.is_zero());
+}
+
 TEST_CASE(test_unsigned_bigint_base10_from_string)
 {
     auto result = TRY_OR_FAIL(Crypto::UnsignedBigInteger::from_base(10, "57195071295721390579057195715793"sv));
@@ -1041,3 +1130,47 @@ struct Formatter<Crypto::UnsignedBigInteger::CompareResult> : Formatter<StringVi
 };
 
 }
+
+
+BENCHMARK_CASE(bigint_multiply_4096_bits)
+{
+    auto left = bigint_pseudo_random(128, 1);
+    auto right = bigint_pseudo_random(128, 2);
+    for (size_t i = 0; i < 10000; ++i)
+        (void)left.multiplied_by(right);
+}
+
+BENCHMARK_CASE(bigint_multiply_100000_bits)
+{
+    auto left = bigint_pseudo_random(3125, 1);
+    auto right = bigint_pseudo_random(3125, 2);
+    for (size_t i = 0; i < 10; ++i)
+        (void)left.multiplied_by(right);
+}
+
+BENCHMARK_CASE(bigint_divide_8192_by_4096_bits)
+{
+    auto numerator = bigint_pseudo_random(256, 1);
+    auto denominator = bigint_pseudo_random(128, 2);
+    for (size_t i = 0; i < 10000; ++i)
+        (void)numerator.divided_by(denominator);
+}
+
+BENCHMARK_CASE(bigint_divide_200000_by_100000_bits)
+{
+    auto numerator = bigint_pseudo_random(6250, 1);
+    auto denominator = bigint_pseudo_random(3125, 2);
+    for (size_t i = 0; i < 10; ++i)
+        (void)numerator.divided_by(denominator);
+}
+
+BENCHMARK_CASE(bigint_modular_power_2048_bits_even_modulus)
+{
+    auto base = bigint_pseudo_random(64, 1);
+    auto exponent = bigint_pseudo_random(8, 2);
+    auto modulus = bigint_pseudo_random(64, 3);
+    modulus.set_bit_inplace(0);
+    modulus = modulus.minus(1);
+    for (size_t i = 0; i < 10; ++i)
+        (void)Crypto::NumberTheory::ModularPower(base, exponent, modulus);
+}
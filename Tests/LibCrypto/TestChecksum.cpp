@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Random.h>
+#include <LibCrypto/CPUFeatures.h>
 #include <LibCrypto/Checksum/Adler32.h>
 #include <LibCrypto/Checksum/CRC32.h>
 #include <LibCrypto/Checksum/cksum.h>
@@ -63,3 +65,23 @@ TEST_CASE(test_crc32)
     do_test("The quick brown fox jumps over the lazy dog"sv.bytes(), 0x414FA339);
     do_test("various CRC algorithms input data"sv.bytes(), 0x9BD366AE);
 }
+
+TEST_CASE(test_crc32_accelerated_implementation)
+{
+    auto data = MUST(ByteBuffer::create_uninitialized(5000));
+    fill_with_random(data);
+
+    auto crc32 = [&](size_t offset, size_t length, bool accelerated) {
+        Crypto::set_enabled_cpu_features(accelerated ? Crypto::CPUFeatures::All : Crypto::CPUFeatures::None);
+        Crypto::Checksum::CRC32 crc32;
+        // Update twice, to continue from an existing state.
+        crc32.update(data.bytes().slice(offset, length / 3));
+        crc32.update(data.bytes().slice(offset + length / 3, length - length / 3));
+        return crc32.digest();
+    };
+
+    for (size_t offset : { 0, 1, 7 }) {
+        for (size_t length : { 63, 64, 65, 127, 200, 1000, 4096 })
+            EXPECT_EQ(crc32(offset, length, false), crc32(offset, length, true));
+    }
+}
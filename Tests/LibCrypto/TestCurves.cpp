@@ -5,6 +5,7 @@
  */
 
 #include <AK/ByteBuffer.h>
+#include <AK/Hex.h>
 #include <LibCrypto/Curves/SECPxxxr1.h>
 #include <LibCrypto/Curves/X25519.h>
 #include <LibCrypto/Curves/X448.h>
@@ -306,3 +307,31 @@ TEST_CASE(test_secp384r1)
     auto generated_public = MUST(curve.generate_public_key(private_key));
     EXPECT_EQ(expected_public_key.span(), generated_public);
 }
+
+TEST_CASE(test_secp256r1_verify)
+{
+    // SHA-256("hello world"), signed with OpenSSL
+    auto hash = MUST(decode_hex("b94d27b9934d3e08a52e52d7da7dabfac484efe37a5380ee9088f7ace2efcde9"sv));
+    auto public_key = MUST(decode_hex("04a50eba1be1ab67af8e0849ea24de756d37525cf2eecc989f06a34abf71015d3a1d13241252f87570a223c1c3705e7fd64c9c38ebf871f97412b17032929329f6"sv));
+    auto signature = MUST(decode_hex("304502200fd015893aa290562427f88817b93ad9e4891b0d8321378c54537dd31073a5e2022100846e9371ff2c2d3a93840cde560b257b3ba96c8f971c60be3ed09341ffad6b11"sv));
+
+    Crypto::Curves::SECP256r1 curve;
+    EXPECT(MUST(curve.verify(hash, public_key, signature)));
+
+    hash[0] ^= 1;
+    EXPECT(!MUST(curve.verify(hash, public_key, signature)));
+}
+
+TEST_CASE(test_secp384r1_verify)
+{
+    // SHA-384("hello world"), signed with OpenSSL
+    auto hash = MUST(decode_hex("fdbd8e75a67f29f701a4e040385e2e23986303ea10239211af907fcbb83578b3e417cb71ce646efd0819dd8c088de1bd"sv));
+    auto public_key = MUST(decode_hex("04e649db14f092c4639c8715e81b0f72c4b96533cfa96e464d9ce46f2c11ff18901ea3ad2c7d599dc9230ff0fce135d2bcec6b455c3ab5c198ab74740c40ba79f1cba6b7f1db692ce9c06c87b16b272246882a474053d6bfe91573912c67dd090f"sv));
+    auto signature = MUST(decode_hex("3066023100cf9e78e696d43c1c6432f14343bcc69e51b114eba886caba908f92c560f8127e30bb8590acefbade49282a21fcac6234023100ad1f372608f3f5c7b01370358a0ac2f13ca3b7be5df4e3d50a4a9e6c84f7a0ea53821972143973989458bbba8523680d"sv));
+
+    Crypto::Curves::SECP384r1 curve;
+    EXPECT(MUST(curve.verify(hash, public_key, signature)));
+
+    hash[0] ^= 1;
+    EXPECT(!MUST(curve.verify(hash, public_key, signature)));
+}
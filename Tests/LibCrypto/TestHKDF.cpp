@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Hex.h>
+#include <LibCrypto/Hash/HKDF.h>
+#include <LibCrypto/Hash/HashManager.h>
+#include <LibCrypto/Hash/SHA2.h>
+#include <LibTest/TestCase.h>
+
+using HKDF_SHA256 = Crypto::Hash::HKDF<Crypto::Hash::SHA256>;
+
+// https://www.rfc-editor.org/rfc/rfc5869#appendix-A.1
+TEST_CASE(test_basic_sha256)
+{
+    auto ikm = MUST(decode_hex("0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b"sv));
+    auto salt = MUST(decode_hex("000102030405060708090a0b0c"sv));
+    auto info = MUST(decode_hex("f0f1f2f3f4f5f6f7f8f9"sv));
+
+    auto prk = MUST(HKDF_SHA256::extract(salt, ikm));
+    EXPECT_EQ(prk, MUST(decode_hex("077709362c2e32df0ddc3f0dc47bba6390b6c73bb50f9c3122ec844ad7c2b3e5"sv)));
+
+    auto okm = MUST(HKDF_SHA256::expand(prk, info, 42));
+    EXPECT_EQ(okm, MUST(decode_hex("3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf34007208d5b887185865"sv)));
+}
+
+// https://www.rfc-editor.org/rfc/rfc5869#appendix-A.2
+TEST_CASE(test_longer_inputs_and_outputs_sha256)
+{
+    auto ikm = MUST(decode_hex("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+                               "202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+                               "404142434445464748494a4b4c4d4e4f"sv));
+    auto salt = MUST(decode_hex("606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+                                "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+                                "a0a1a2a3a4a5a6a7a8a9aaabacadaeaf"sv));
+    auto info = MUST(decode_hex("b0b1b2b3b4b5b6b7b8b9babbbcbdbebfc0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+                                "d0d1d2d3d4d5d6d7d8d9dadbdcdddedfe0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+                                "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff"sv));
+
+    auto prk = MUST(HKDF_SHA256::extract(salt, ikm));
+    EXPECT_EQ(prk, MUST(decode_hex("06a6b88c5853361a06104c9ceb35b45cef760014904671014a193f40c15fc244"sv)));
+
+    auto okm = MUST(HKDF_SHA256::expand(prk, info, 82));
+    EXPECT_EQ(okm, MUST(decode_hex("b11e398dc80327a1c8e7f78c596a49344f012eda2d4efad8a050cc4c19afa97c"
+                                   "59045a99cac7827271cb41c65e590e09da3275600c2f09b8367793a9aca3db71"
+                                   "cc30c58179ec3e87c14c01d5c1f3434f1d87"sv)));
+}
+
+// https://www.rfc-editor.org/rfc/rfc5869#appendix-A.3
+TEST_CASE(test_zero_length_salt_and_info_sha256)
+{
+    auto ikm = MUST(decode_hex("0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b"sv));
+
+    auto prk = MUST(HKDF_SHA256::extract({}, ikm));
+    EXPECT_EQ(prk, MUST(decode_hex("19ef24a32c717b167f33a91d6f648bdf96596776afdb6377ac434c1c293ccb04"sv)));
+
+    auto okm = MUST(HKDF_SHA256::expand(prk, {}, 42));
+    EXPECT_EQ(okm, MUST(decode_hex("8da4e775a563c18f715f802a063c5a31b8a11f5c5ee1879ec3454e5f3c738d2d9d201395faa4b61a96c8"sv)));
+}
+
+TEST_CASE(test_hash_manager_sha384)
+{
+    using HKDF = Crypto::Hash::HKDF<Crypto::Hash::Manager>;
+    auto ikm = MUST(decode_hex("0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b"sv));
+
+    auto prk = MUST(HKDF::extract({}, ikm, Crypto::Hash::HashKind::SHA384));
+    EXPECT_EQ(prk, MUST(decode_hex("10e40cf072a4c5626e43dd22c1cf727d4bb140975c9ad0cbc8e45b40068f8f0ba57cdb598af9dfa6963a96899af047e5"sv)));
+
+    auto okm = MUST(HKDF::expand(prk, "tls13 x"sv.bytes(), 100, Crypto::Hash::HashKind::SHA384));
+    EXPECT_EQ(okm, MUST(decode_hex("1e728f85e02476747314bc5e50f7602834365814a130dd7db3ab802fc3913ee9abb1d57a838d39427604644b0a23571a"
+                                   "03a3a4d93b10638358f8ecc81d56a8bd84d7e2a19e14998263ef409df480641dd04e541d4fd68cd03685194a1df4549f"
+                                   "cb1b93e1"sv)));
+
+    EXPECT(HKDF::expand(prk, {}, 255 * 48 + 1, Crypto::Hash::HashKind::SHA384).is_error());
+}
@@ -4,8 +4,10 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Random.h>
 #include <LibCrypto/Authentication/GHash.h>
 #include <LibCrypto/Authentication/HMAC.h>
+#include <LibCrypto/CPUFeatures.h>
 #include <LibCrypto/Hash/BLAKE2b.h>
 #include <LibCrypto/Hash/MD5.h>
 #include <LibCrypto/Hash/SHA1.h>
@@ -325,3 +327,78 @@ TEST_CASE(test_ghash_galois_field_multiply2)
     Crypto::Authentication::galois_multiply(z, x, y);
     EXPECT(memcmp(result, z, 4 * sizeof(u32)) == 0);
 }
+
+// Runs an operation with the portable implementation and with the accelerated one (if any), which must agree.
+template<typename Callback>
+static void expect_same_result_with_and_without_acceleration(Callback callback)
+{
+    Crypto::set_enabled_cpu_features(Crypto::CPUFeatures::None);
+    auto portable = callback();
+    Crypto::set_enabled_cpu_features(Crypto::CPUFeatures::All);
+    auto accelerated = callback();
+    EXPECT_EQ(portable, accelerated);
+}
+
+template<typename Hash>
+static ByteBuffer hash_in_pieces(ReadonlyBytes data, size_t piece_length)
+{
+    Hash hash;
+    for (size_t offset = 0; offset < data.size(); offset += piece_length)
+        hash.update(data.slice(offset, min(piece_length, data.size() - offset)));
+    auto digest = hash.digest();
+    return MUST(ByteBuffer::copy(digest.bytes()));
+}
+
+TEST_CASE(test_SHA1_hash_million_characters)
+{
+    u8 result[] {
+        0x34, 0xaa, 0x97, 0x3c, 0xd4, 0xc4, 0xda, 0xa4, 0xf6, 0x1e, 0xeb, 0x2b, 0xdb, 0xad, 0x27, 0x31, 0x65, 0x34, 0x01, 0x6f
+    };
+    auto data = MUST(ByteBuffer::create_uninitialized(1'000'000));
+    data.bytes().fill('a');
+    auto digest = Crypto::Hash::SHA1::hash(data);
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA1::digest_size()) == 0);
+}
+
+TEST_CASE(test_SHA256_hash_million_characters)
+{
+    u8 result[] {
+        0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67,
+        0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0
+    };
+    auto data = MUST(ByteBuffer::create_uninitialized(1'000'000));
+    data.bytes().fill('a');
+    auto digest = Crypto::Hash::SHA256::hash(data);
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+}
+
+TEST_CASE(test_SHA_accelerated_implementation)
+{
+    auto data = MUST(ByteBuffer::create_uninitialized(5000));
+    fill_with_random(data);
+
+    // Pieces that fill the buffer partially, exactly and across several blocks at once.
+    for (size_t piece_length : { 1, 37, 64, 100, 1000, 5000 }) {
+        expect_same_result_with_and_without_acceleration([&] { return hash_in_pieces<Crypto::Hash::SHA1>(data, piece_length); });
+        expect_same_result_with_and_without_acceleration([&] { return hash_in_pieces<Crypto::Hash::SHA256>(data, piece_length); });
+    }
+}
+
+TEST_CASE(test_ghash_accelerated_implementation)
+{
+    auto data = MUST(ByteBuffer::create_uninitialized(1000));
+    fill_with_random(data);
+    u8 key[16];
+    fill_with_random(key);
+
+    // These cover the blocks that are folded together, the ones after them and partial blocks.
+    for (size_t aad_length : { 0, 13, 64 }) {
+        for (size_t length : { 0, 16, 50, 64, 100, 1000 }) {
+            expect_same_result_with_and_without_acceleration([&] {
+                Crypto::Authentication::GHash ghash({ key, sizeof(key) });
+                auto tag = ghash.process(data.bytes().trim(aad_length), data.bytes().slice(aad_length).trim(length));
+                return MUST(ByteBuffer::copy(ReadonlyBytes { tag.data, sizeof(tag.data) }));
+            });
+        }
+    }
+}
@@ -6,7 +6,10 @@
 
 #include <LibTest/TestCase.h>
 
+#include <AK/Math.h>
+#include <AK/Time.h>
 #include <LibGfx/Bitmap.h>
+#include <LibGfx/EdgeFlagPathRasterizer.h>
 #include <LibGfx/Font/FontDatabase.h>
 #include <LibGfx/Painter.h>
 #include <stdio.h>
@@ -52,3 +55,199 @@ BENCHMARK_CASE(fill_with_gradient)
         painter.fill_rect_with_gradient(bitmap->rect(), Color::Blue, Color::Red);
     }
 }
+
+// Runs the operation a number of times, and reports its throughput in megapixels per second.
+template<typename Callback>
+static void report_throughput(StringView operation, int run_count, size_t pixels_per_run, Callback callback)
+{
+    auto start = MonotonicTime::now();
+    for (int run = 0; run < run_count; run++)
+        callback();
+    auto elapsed = MonotonicTime::now() - start;
+
+    auto megapixels = static_cast<double>(run_count) * pixels_per_run / 1'000'000;
+    outln("{}: {:.1} MP/s", operation, megapixels / max<i64>(elapsed.to_microseconds(), 1) * 1'000'000);
+}
+
+static NonnullRefPtr<Gfx::Bitmap> create_translucent_bitmap(Gfx::BitmapFormat format, int size)
+{
+    auto bitmap = MUST(Gfx::Bitmap::create(format, { size, size }));
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++)
+            bitmap->scanline(y)[x] = (((x + y) & 0xff) << 24) | (x & 0xff) << 16 | (y & 0xff) << 8 | ((x ^ y) & 0xff);
+    }
+    return bitmap;
+}
+
+BENCHMARK_CASE(blit_with_opacity)
+{
+    int const bitmap_size = 2000;
+
+    auto bitmap = TRY_OR_FAIL(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size }));
+    auto source = create_translucent_bitmap(Gfx::BitmapFormat::BGRA8888, bitmap_size);
+    Gfx::Painter painter(bitmap);
+    painter.clear_rect(bitmap->rect(), Color::White);
+
+    report_throughput("blit_with_opacity"sv, 20, bitmap_size * bitmap_size, [&] {
+        painter.blit({ 0, 0 }, source, source->rect(), 0.5f);
+    });
+}
+
+BENCHMARK_CASE(blit_rgba)
+{
+    int const bitmap_size = 2000;
+
+    auto bitmap = TRY_OR_FAIL(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size }));
+    auto source = create_translucent_bitmap(Gfx::BitmapFormat::RGBA8888, bitmap_size);
+    Gfx::Painter painter(bitmap);
+    painter.clear_rect(bitmap->rect(), Color::White);
+
+    report_throughput("blit_rgba"sv, 50, bitmap_size * bitmap_size, [&] {
+        painter.blit({ 0, 0 }, source, source->rect(), 1.0f, false);
+    });
+}
+
+BENCHMARK_CASE(fill_with_translucent_color)
+{
+    int const bitmap_size = 2000;
+
+    auto bitmap = TRY_OR_FAIL(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size }));
+    Gfx::Painter painter(bitmap);
+    painter.clear_rect(bitmap->rect(), Color::White);
+
+    report_throughput("fill_with_translucent_color"sv, 20, bitmap_size * bitmap_size, [&] {
+        painter.fill_rect(bitmap->rect(), Color(0, 0, 255, 128));
+    });
+}
+
+BENCHMARK_CASE(draw_scaled_bitmap_bilinear)
+{
+    int const bitmap_size = 2000;
+
+    auto bitmap = TRY_OR_FAIL(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size }));
+    auto source = create_translucent_bitmap(Gfx::BitmapFormat::BGRA8888, bitmap_size / 3);
+    Gfx::Painter painter(bitmap);
+    painter.clear_rect(bitmap->rect(), Color::White);
+
+    report_throughput("draw_scaled_bitmap_bilinear"sv, 5, bitmap_size * bitmap_size, [&] {
+        painter.draw_scaled_bitmap(bitmap->rect(), source, source->rect(), 1.0f, Gfx::Painter::ScalingMode::BilinearBlend);
+    });
+}
+
+static constexpr int path_bitmap_size = 1000;
+
+// A grid of small icon-like shapes: circles, rounded rectangles and check marks.
+static Gfx::Path create_icon_set_path(int size)
+{
+    Gfx::Path path;
+    for (int y = 0; y + 24 <= size; y += 32) {
+        for (int x = 0; x + 24 <= size; x += 32) {
+            Gfx::FloatRect cell(x, y, 24, 24);
+            switch ((x + y) / 32 % 3) {
+            case 0:
+                path.move_to({ cell.x() + 22, cell.center().y() });
+                path.arc_to({ cell.x() + 2, cell.center().y() }, 10, false, false);
+                path.arc_to({ cell.x() + 22, cell.center().y() }, 10, false, false);
+                path.close();
+                break;
+            case 1:
+                path.rounded_rect(cell.shrunken(4, 4), { 4, 4 }, { 4, 4 }, { 4, 4 }, { 4, 4 });
+                break;
+            default:
+                path.move_to({ cell.x() + 3, cell.y() + 13 });
+                path.line_to({ cell.x() + 9, cell.y() + 19 });
+                path.line_to({ cell.x() + 21, cell.y() + 5 });
+                path.line_to({ cell.x() + 18, cell.y() + 3 });
+                path.line_to({ cell.x() + 9, cell.y() + 14 });
+                path.line_to({ cell.x() + 6, cell.y() + 10 });
+                path.close();
+                break;
+            }
+        }
+    }
+    return path;
+}
+
+// Lines of small glyph-like outlines, made of quadratic and cubic curves with counters, like a page of text.
+static Gfx::Path create_glyph_outlines_path(int size)
+{
+    Gfx::Path path;
+    for (int y = 2; y + 14 <= size; y += 16) {
+        for (int x = 2; x + 8 <= size; x += 9) {
+            float left = x;
+            float top = y;
+            // An outer bowl...
+            path.move_to({ left + 4, top });
+            path.cubic_bezier_curve_to({ left + 8, top }, { left + 8, top + 12 }, { left + 4, top + 12 });
+            path.cubic_bezier_curve_to({ left, top + 12 }, { left, top }, { left + 4, top });
+            path.close();
+            // ...with a counter wound the other way...
+            path.move_to({ left + 4, top + 2 });
+            path.quadratic_bezier_curve_to({ left + 2, top + 6 }, { left + 4, top + 10 });
+            path.quadratic_bezier_curve_to({ left + 6, top + 6 }, { left + 4, top + 2 });
+            path.close();
+            // ...and a stem that overlaps it.
+            if ((x / 9) % 2 == 0)
+                path.rect({ left + 6, top - 2, 1.5f, 14 });
+        }
+    }
+    return path;
+}
+
+// One large, self-intersecting star with many points.
+static Gfx::Path create_complex_star_path(int size)
+{
+    Gfx::Path path;
+    auto center = Gfx::FloatPoint { size / 2.0f, size / 2.0f };
+    auto radius = size / 2.0f - 1;
+    constexpr int point_count = 1001;
+    for (int i = 0; i < point_count; i++) {
+        auto angle = 2 * AK::Pi<float> * i * 400 / point_count;
+        auto point = center + Gfx::FloatPoint { AK::cos(angle) * radius, AK::sin(angle) * radius };
+        if (i == 0)
+            path.move_to(point);
+        else
+            path.line_to(point);
+    }
+    path.close();
+    return path;
+}
+
+template<unsigned SamplesPerPixel>
+static void benchmark_fill_path(Gfx::Painter& painter, StringView name, Gfx::Path const& path, Gfx::Painter::WindingRule winding_rule, int run_count)
+{
+    auto path_size = Gfx::enclosing_int_rect(path.bounding_box()).size();
+    auto operation = ByteString::formatted("{} ({} samples, {})", name, SamplesPerPixel, winding_rule == Gfx::Painter::WindingRule::Nonzero ? "nonzero"sv : "even-odd"sv);
+    report_throughput(operation, run_count, path_bitmap_size * path_bitmap_size, [&] {
+        Gfx::EdgeFlagPathRasterizer<SamplesPerPixel> rasterizer(path_size);
+        rasterizer.fill(painter, path, Gfx::Color(0, 0, 0), winding_rule);
+    });
+}
+
+static void benchmark_fill_path_at_each_sample_count(StringView name, Gfx::Path const& path, int run_count)
+{
+    auto bitmap = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { path_bitmap_size, path_bitmap_size }));
+    Gfx::Painter painter(bitmap);
+    painter.clear_rect(bitmap->rect(), Color::White);
+
+    for (auto winding_rule : { Gfx::Painter::WindingRule::Nonzero, Gfx::Painter::WindingRule::EvenOdd }) {
+        benchmark_fill_path<8>(painter, name, path, winding_rule, run_count);
+        benchmark_fill_path<16>(painter, name, path, winding_rule, run_count);
+        benchmark_fill_path<32>(painter, name, path, winding_rule, run_count);
+    }
+}
+
+BENCHMARK_CASE(fill_path_icon_set)
+{
+    benchmark_fill_path_at_each_sample_count("fill_path_icon_set"sv, create_icon_set_path(path_bitmap_size), 20);
+}
+
+BENCHMARK_CASE(fill_path_glyph_outlines)
+{
+    benchmark_fill_path_at_each_sample_count("fill_path_glyph_outlines"sv, create_glyph_outlines_path(path_bitmap_size), 10);
+}
+
+BENCHMARK_CASE(fill_path_complex_star)
+{
+    benchmark_fill_path_at_each_sample_count("fill_path_complex_star"sv, create_complex_star_path(path_bitmap_size), 5);
+}
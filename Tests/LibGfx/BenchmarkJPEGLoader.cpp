@@ -4,8 +4,11 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/MemoryStream.h>
 #include <LibCore/File.h>
 #include <LibGfx/ImageFormats/JPEGLoader.h>
+#include <LibGfx/ImageFormats/JPEGWriter.h>
+#include <LibGfx/ImageFormats/WebPLoader.h>
 #include <LibTest/TestCase.h>
 
 #ifdef AK_OS_SERENITY
@@ -14,10 +17,27 @@
 #    define TEST_INPUT(x) ("test-inputs/" x)
 #endif
 
-auto small_image = Core::File::open(TEST_INPUT("jpg/rgb24.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
-auto big_image = Core::File::open(TEST_INPUT("jpg/big_image.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
-auto rgb_image = Core::File::open(TEST_INPUT("jpg/rgb_components.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
-auto several_scans = Core::File::open(TEST_INPUT("jpg/several_scans.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
+static ByteBuffer read_test_input(StringView path)
+{
+    return Core::File::open(path, Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
+}
+
+// A photo taken with a camera, see test_webp_lossy_4 in TestImageDecoder.cpp. It is re-encoded as a (sequential, 4:4:4)
+// JPEG here, as there are no camera JPEGs of that size in the test inputs.
+static ByteBuffer encode_camera_photo()
+{
+    auto webp = read_test_input(TEST_INPUT("webp/4.webp"sv));
+    auto frame = MUST(MUST(Gfx::WebPImageDecoderPlugin::create(webp))->frame(0));
+    AllocatingMemoryStream stream;
+    MUST(Gfx::JPEGWriter::encode(stream, *frame.image, { .icc_data = {}, .quality = 90 }));
+    return MUST(stream.read_until_eof());
+}
+
+auto small_image = read_test_input(TEST_INPUT("jpg/rgb24.jpg"sv));
+auto camera_photo = encode_camera_photo();
+auto rgb_image = read_test_input(TEST_INPUT("jpg/rgb_components.jpg"sv));
+auto several_scans = read_test_input(TEST_INPUT("jpg/several_scans.jpg"sv));
+auto progressive_image = read_test_input(TEST_INPUT("jpg/successive_approximation.jpg"sv));
 
 BENCHMARK_CASE(small_image)
 {
@@ -25,12 +45,35 @@ BENCHMARK_CASE(small_image)
     MUST(plugin_decoder->frame(0));
 }
 
-BENCHMARK_CASE(big_image)
+BENCHMARK_CASE(camera_photo)
 {
-    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(big_image));
+    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(camera_photo));
     MUST(plugin_decoder->frame(0));
 }
 
+static void decode_at_scale(ReadonlyBytes data, int scale)
+{
+    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(data));
+    auto size = plugin_decoder->size();
+    auto frame = MUST(plugin_decoder->frame(0, Gfx::IntSize { size.width() / scale, size.height() / scale }));
+    VERIFY(frame.image->width() == ceil_div(size.width(), scale));
+}
+
+BENCHMARK_CASE(camera_photo_at_half_size)
+{
+    decode_at_scale(camera_photo, 2);
+}
+
+BENCHMARK_CASE(camera_photo_at_quarter_size)
+{
+    decode_at_scale(camera_photo, 4);
+}
+
+BENCHMARK_CASE(camera_photo_at_eighth_size)
+{
+    decode_at_scale(camera_photo, 8);
+}
+
 BENCHMARK_CASE(rgb_image)
 {
     auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(rgb_image));
@@ -42,3 +85,9 @@ BENCHMARK_CASE(several_scans)
     auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(several_scans));
     MUST(plugin_decoder->frame(0));
 }
+
+BENCHMARK_CASE(progressive_image)
+{
+    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(progressive_image));
+    MUST(plugin_decoder->frame(0));
+}
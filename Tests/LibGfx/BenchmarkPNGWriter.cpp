@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/File.h>
+#include <LibGfx/ImageFormats/PNGWriter.h>
+#include <LibGfx/ImageFormats/WebPLoader.h>
+#include <LibTest/TestCase.h>
+
+#ifdef AK_OS_SERENITY
+#    define TEST_INPUT(x) ("/usr/Tests/LibGfx/test-inputs/" x)
+#else
+#    define TEST_INPUT(x) ("test-inputs/" x)
+#endif
+
+// A photo taken with a camera, see test_webp_lossy_4 in TestImageDecoder.cpp.
+static NonnullRefPtr<Gfx::Bitmap> decode_camera_photo()
+{
+    auto webp = MUST(MUST(Core::File::open(TEST_INPUT("webp/4.webp"sv), Core::File::OpenMode::Read))->read_until_eof());
+    return *MUST(MUST(Gfx::WebPImageDecoderPlugin::create(webp))->frame(0)).image;
+}
+
+auto camera_photo = decode_camera_photo();
+
+static void encode(Gfx::PNGWriter::Options::CompressionLevel compression_level, bool compress_in_parallel)
+{
+    Gfx::PNGWriter::Options options;
+    options.compression_level = compression_level;
+    options.compress_in_parallel = compress_in_parallel;
+    (void)MUST(Gfx::PNGWriter::encode(*camera_photo, options));
+}
+
+BENCHMARK_CASE(camera_photo_fast)
+{
+    encode(Gfx::PNGWriter::Options::CompressionLevel::Fast, false);
+}
+
+BENCHMARK_CASE(camera_photo_default)
+{
+    encode(Gfx::PNGWriter::Options::CompressionLevel::Default, false);
+}
+
+BENCHMARK_CASE(camera_photo_best)
+{
+    encode(Gfx::PNGWriter::Options::CompressionLevel::Best, false);
+}
+
+BENCHMARK_CASE(camera_photo_fast_in_parallel)
+{
+    encode(Gfx::PNGWriter::Options::CompressionLevel::Fast, true);
+}
+
+BENCHMARK_CASE(camera_photo_best_in_parallel)
+{
+    encode(Gfx::PNGWriter::Options::CompressionLevel::Best, true);
+}
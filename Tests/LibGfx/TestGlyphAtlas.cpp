@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGfx/Font/GlyphAtlas.h>
+#include <LibTest/TestCase.h>
+
+// The atlas only uses the typeface as part of the key, so any distinct pointer will do.
+static Gfx::VectorFont const* const typeface = reinterpret_cast<Gfx::VectorFont const*>(0x1000);
+
+static Gfx::GlyphAtlas::Key key_for_glyph(u32 glyph_id)
+{
+    return { typeface, 1.0f, 1.0f, glyph_id, { 0, 0 } };
+}
+
+static RefPtr<Gfx::Bitmap> create_glyph_bitmap(Gfx::IntSize size, u32 value)
+{
+    auto bitmap = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, size));
+    bitmap->fill(Color::from_argb(value));
+    return bitmap;
+}
+
+static bool entry_is_filled_with(Gfx::GlyphAtlas::Entry const& entry, u32 value)
+{
+    for (int y = entry.rect.top(); y < entry.rect.bottom(); ++y) {
+        for (int x = entry.rect.left(); x < entry.rect.right(); ++x) {
+            if (entry.bitmap->scanline(y)[x] != value)
+                return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE(glyphs_are_packed_into_shared_pages)
+{
+    Gfx::GlyphAtlas atlas({ 64, 64 }, 2);
+
+    Vector<Gfx::GlyphAtlas::Entry> entries;
+    for (u32 glyph_id = 0; glyph_id < 8; ++glyph_id) {
+        auto entry = atlas.find_or_rasterize(key_for_glyph(glyph_id), [&] {
+            return create_glyph_bitmap({ 7, 5 + static_cast<int>(glyph_id % 3) }, 0xff000000 | glyph_id);
+        });
+        EXPECT(entry.has_value());
+        entries.append(entry.release_value());
+    }
+    EXPECT_EQ(atlas.page_count(), 1u);
+    EXPECT_EQ(atlas.glyph_count(), 8u);
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        EXPECT_EQ(entries[i].bitmap.ptr(), entries[0].bitmap.ptr());
+        EXPECT(entry_is_filled_with(entries[i], 0xff000000 | i));
+        for (size_t j = i + 1; j < entries.size(); ++j)
+            EXPECT(!entries[i].rect.intersects(entries[j].rect));
+    }
+}
+
+TEST_CASE(glyphs_are_only_rasterized_once)
+{
+    Gfx::GlyphAtlas atlas({ 64, 64 }, 2);
+
+    int rasterize_count = 0;
+    Function<RefPtr<Gfx::Bitmap>()> rasterize = [&] {
+        ++rasterize_count;
+        return create_glyph_bitmap({ 10, 10 }, 0x80ffffff);
+    };
+    auto first = atlas.find_or_rasterize(key_for_glyph(1), rasterize);
+    auto second = atlas.find_or_rasterize(key_for_glyph(1), rasterize);
+    EXPECT_EQ(rasterize_count, 1);
+    EXPECT_EQ(first->rect, second->rect);
+
+    // Glyphs without a bitmap are remembered too.
+    Function<RefPtr<Gfx::Bitmap>()> empty_rasterize = [&] {
+        ++rasterize_count;
+        return RefPtr<Gfx::Bitmap> {};
+    };
+    EXPECT(!atlas.find_or_rasterize(key_for_glyph(2), empty_rasterize).has_value());
+    EXPECT(!atlas.find_or_rasterize(key_for_glyph(2), empty_rasterize).has_value());
+    EXPECT_EQ(rasterize_count, 2);
+
+    // A different size or subpixel offset is a different glyph.
+    Gfx::GlyphAtlas::Key scaled_key { typeface, 2.0f, 2.0f, 1, { 0, 0 } };
+    Gfx::GlyphAtlas::Key offset_key { typeface, 1.0f, 1.0f, 1, { 1, 0 } };
+    (void)atlas.find_or_rasterize(scaled_key, rasterize);
+    (void)atlas.find_or_rasterize(offset_key, rasterize);
+    EXPECT_EQ(rasterize_count, 4);
+}
+
+TEST_CASE(least_recently_used_page_is_evicted)
+{
+    // Each page fits four 32x32 glyphs.
+    Gfx::GlyphAtlas atlas({ 64, 64 }, 2);
+    auto rasterize = [&](u32 glyph_id) {
+        return atlas.find_or_rasterize(key_for_glyph(glyph_id), [&] {
+            return create_glyph_bitmap({ 32, 32 }, 0xff000000 | glyph_id);
+        });
+    };
+
+    for (u32 glyph_id = 0; glyph_id < 8; ++glyph_id)
+        (void)rasterize(glyph_id);
+    EXPECT_EQ(atlas.page_count(), 2u);
+    EXPECT_EQ(atlas.glyph_count(), 8u);
+
+    // Use a glyph on the first page, so that the second one becomes the least recently used page.
+    auto first_page_glyph = rasterize(0);
+    auto second_page_glyph = rasterize(4);
+    (void)rasterize(1);
+
+    auto new_glyph = rasterize(8);
+    EXPECT_EQ(atlas.page_count(), 2u);
+    // The second page has been evicted, leaving the four glyphs of the first page and the new one.
+    EXPECT_EQ(atlas.glyph_count(), 5u);
+    EXPECT_NE(new_glyph->bitmap.ptr(), second_page_glyph->bitmap.ptr());
+    EXPECT_EQ(rasterize(0)->bitmap.ptr(), first_page_glyph->bitmap.ptr());
+
+    // Glyphs that were handed out before the eviction keep their contents.
+    EXPECT(entry_is_filled_with(*second_page_glyph, 0xff000004));
+    EXPECT(entry_is_filled_with(*new_glyph, 0xff000008));
+}
+
+TEST_CASE(evicted_pages_are_never_drawn_into_again)
+{
+    // Each page fits four 32x32 glyphs, so every glyph after the first eight evicts a page and reuses its space.
+    Gfx::GlyphAtlas atlas({ 64, 64 }, 2);
+    Vector<Gfx::GlyphAtlas::Entry> entries;
+    for (u32 glyph_id = 0; glyph_id < 40; ++glyph_id) {
+        auto entry = atlas.find_or_rasterize(key_for_glyph(glyph_id), [&] {
+            return create_glyph_bitmap({ 32, 32 }, 0xff000000 | glyph_id);
+        });
+        EXPECT(entry.has_value());
+        entries.append(entry.release_value());
+        EXPECT(atlas.page_count() <= 2u);
+    }
+
+    // Every glyph that was handed out still shows its own pixels, even though its page has long been evicted.
+    for (u32 glyph_id = 0; glyph_id < entries.size(); ++glyph_id)
+        EXPECT(entry_is_filled_with(entries[glyph_id], 0xff000000 | glyph_id));
+}
+
+TEST_CASE(glyphs_larger_than_a_page_are_not_packed)
+{
+    Gfx::GlyphAtlas atlas({ 64, 64 }, 1);
+
+    int rasterize_count = 0;
+    Function<RefPtr<Gfx::Bitmap>()> rasterize = [&] {
+        ++rasterize_count;
+        return create_glyph_bitmap({ 100, 20 }, 0xffff0000);
+    };
+    auto entry = atlas.find_or_rasterize(key_for_glyph(1), rasterize);
+    EXPECT(entry.has_value());
+    EXPECT_EQ(entry->rect, Gfx::IntRect(0, 0, 100, 20));
+    EXPECT_EQ(atlas.page_count(), 0u);
+
+    // The glyph is kept on its own instead.
+    EXPECT_EQ(atlas.glyph_count(), 1u);
+    EXPECT_EQ(atlas.find_or_rasterize(key_for_glyph(1), rasterize)->bitmap.ptr(), entry->bitmap.ptr());
+    EXPECT_EQ(rasterize_count, 1);
+}
+
+TEST_CASE(least_recently_used_unpacked_glyph_is_evicted)
+{
+    // Unpacked glyphs may take up as much memory as one page, which is enough for two of these.
+    Gfx::GlyphAtlas atlas({ 64, 64 }, 1);
+    int rasterize_count = 0;
+    auto rasterize = [&](u32 glyph_id) {
+        return atlas.find_or_rasterize(key_for_glyph(glyph_id), [&] {
+            ++rasterize_count;
+            return create_glyph_bitmap({ 100, 20 }, 0xff000000 | glyph_id);
+        });
+    };
+
+    (void)rasterize(1);
+    (void)rasterize(2);
+    (void)rasterize(1);
+    EXPECT_EQ(rasterize_count, 2);
+
+    // The second glyph has been used least recently, so it makes room for the third one.
+    (void)rasterize(3);
+    EXPECT_EQ(atlas.glyph_count(), 2u);
+    (void)rasterize(1);
+    EXPECT_EQ(rasterize_count, 3);
+    (void)rasterize(2);
+    EXPECT_EQ(rasterize_count, 4);
+}
+
+TEST_CASE(glyphs_without_a_bitmap_are_evicted)
+{
+    Gfx::GlyphAtlas atlas({ 64, 64 }, 1, 4);
+    int rasterize_count = 0;
+    Function<RefPtr<Gfx::Bitmap>()> empty_rasterize = [&] {
+        ++rasterize_count;
+        return RefPtr<Gfx::Bitmap> {};
+    };
+
+    for (u32 glyph_id = 0; glyph_id < 100; ++glyph_id)
+        EXPECT(!atlas.find_or_rasterize(key_for_glyph(glyph_id), empty_rasterize).has_value());
+    EXPECT_EQ(rasterize_count, 100);
+    EXPECT_EQ(atlas.glyph_count(), 4u);
+
+    // Only the most recently used ones are remembered.
+    EXPECT(!atlas.find_or_rasterize(key_for_glyph(99), empty_rasterize).has_value());
+    EXPECT_EQ(rasterize_count, 100);
+    EXPECT(!atlas.find_or_rasterize(key_for_glyph(0), empty_rasterize).has_value());
+    EXPECT_EQ(rasterize_count, 101);
+}
@@ -23,6 +23,7 @@
 #include <LibGfx/ImageFormats/PNGLoader.h>
 #include <LibGfx/ImageFormats/PPMLoader.h>
 #include <LibGfx/ImageFormats/QMArithmeticDecoder.h>
+#include <LibGfx/ImageFormats/ScanlineDownscaler.h>
 #include <LibGfx/ImageFormats/TGALoader.h>
 #include <LibGfx/ImageFormats/TIFFLoader.h>
 #include <LibGfx/ImageFormats/TIFFMetadata.h>
@@ -553,6 +554,145 @@ TEST_CASE(test_jpeg_grayscale_with_weird_mcu_and_reset_marker)
     TRY_OR_FAIL(expect_single_frame_of_size(*plugin_decoder, { 320, 240 }));
 }
 
+static float mean_difference_to_downscaled(Gfx::Bitmap const& reduced, Gfx::Bitmap const& full)
+{
+    int const factor = full.width() / reduced.width();
+    float total_difference = 0;
+    for (int y = 0; y < reduced.height(); ++y) {
+        for (int x = 0; x < reduced.width(); ++x) {
+            Array<float, 3> sums {};
+            int count = 0;
+            for (int full_y = y * factor; full_y < min((y + 1) * factor, full.height()); ++full_y) {
+                for (int full_x = x * factor; full_x < min((x + 1) * factor, full.width()); ++full_x) {
+                    auto color = full.get_pixel(full_x, full_y);
+                    sums[0] += color.red();
+                    sums[1] += color.green();
+                    sums[2] += color.blue();
+                    ++count;
+                }
+            }
+            auto color = reduced.get_pixel(x, y);
+            total_difference += fabsf(color.red() - sums[0] / count) + fabsf(color.green() - sums[1] / count) + fabsf(color.blue() - sums[2] / count);
+        }
+    }
+    return total_difference / (reduced.width() * reduced.height() * 3);
+}
+
+TEST_CASE(test_jpeg_reduced_scale)
+{
+    Array test_inputs = {
+        TEST_INPUT("jpg/several_scans.jpg"sv),
+        TEST_INPUT("jpg/successive_approximation.jpg"sv),
+        TEST_INPUT("jpg/ycck-2111.jpg"sv),
+    };
+
+    for (auto test_input : test_inputs) {
+        auto file = TRY_OR_FAIL(Core::MappedFile::map(test_input));
+        auto plugin_decoder = TRY_OR_FAIL(Gfx::JPEGImageDecoderPlugin::create(file->bytes()));
+        auto size = plugin_decoder->size();
+        auto full_frame = TRY_OR_FAIL(plugin_decoder->frame(0));
+        EXPECT_EQ(full_frame.image->size(), size);
+
+        // The smallest scale that is at least as large as the ideal size is picked.
+        for (int scale : { 8, 4, 2 }) {
+            auto scaled_size = Gfx::IntSize { ceil_div(size.width(), scale), ceil_div(size.height(), scale) };
+            auto frame = TRY_OR_FAIL(plugin_decoder->frame(0, scaled_size));
+            EXPECT_EQ(frame.image->size(), scaled_size);
+            EXPECT(mean_difference_to_downscaled(*frame.image, *full_frame.image) < 2.5f);
+
+            frame = TRY_OR_FAIL(plugin_decoder->frame(0, Gfx::IntSize { scaled_size.width() + 1, scaled_size.height() }));
+            EXPECT_EQ(frame.image->width(), ceil_div(size.width() * 2, scale));
+        }
+
+        // Asking for the full size again decodes the image again.
+        auto frame = TRY_OR_FAIL(plugin_decoder->frame(0));
+        EXPECT_EQ(frame.image->size(), size);
+        EXPECT_EQ(frame.image->get_pixel(size.width() / 2, size.height() / 2), full_frame.image->get_pixel(size.width() / 2, size.height() / 2));
+    }
+}
+
+static void expect_bitmaps_equal(Gfx::Bitmap const& a, Gfx::Bitmap const& b)
+{
+    EXPECT_EQ(a.size(), b.size());
+    if (a.size() != b.size())
+        return;
+    for (int y = 0; y < a.height(); ++y)
+        for (int x = 0; x < a.width(); ++x)
+            EXPECT_EQ(a.get_pixel(x, y), b.get_pixel(x, y));
+}
+
+using PluginCreator = ErrorOr<NonnullOwnPtr<Gfx::ImageDecoderPlugin>> (*)(ReadonlyBytes);
+
+// Decoding a region directly has to give the same result as cropping and scaling down the whole image.
+static void expect_regions_match_full_image(StringView path, PluginCreator create)
+{
+    auto file = TRY_OR_FAIL(Core::MappedFile::map(path));
+    auto full_frame = TRY_OR_FAIL(TRY_OR_FAIL(create(file->bytes()))->frame(0));
+    auto const size = full_frame.image->size();
+
+    Array regions {
+        Gfx::IntRect { {}, size },
+        Gfx::IntRect { size.width() / 4, size.height() / 3, size.width() / 2, size.height() / 2 },
+        Gfx::IntRect { size.width() - 1, size.height() - 1, 1, 1 },
+    };
+    for (auto region : regions) {
+        for (auto ideal_size : { Optional<Gfx::IntSize> {}, Optional<Gfx::IntSize> { Gfx::IntSize { region.width() / 3, region.height() / 3 } } }) {
+            auto plugin_decoder = TRY_OR_FAIL(create(file->bytes()));
+            auto frame = TRY_OR_FAIL(plugin_decoder->frame_region(0, region, ideal_size));
+            auto factor = Gfx::ScanlineDownscaler::factor_for_ideal_size(region.size(), ideal_size);
+            auto expected = TRY_OR_FAIL(Gfx::ScanlineDownscaler::downscale(*full_frame.image, region, factor));
+            expect_bitmaps_equal(*frame.image, *expected);
+        }
+    }
+}
+
+// Asking for a smaller version of the whole image scales it down while decoding.
+static void expect_scaled_down_while_decoding(StringView path, PluginCreator create)
+{
+    auto file = TRY_OR_FAIL(Core::MappedFile::map(path));
+    auto full_frame = TRY_OR_FAIL(TRY_OR_FAIL(create(file->bytes()))->frame(0));
+    auto const size = full_frame.image->size();
+
+    auto plugin_decoder = TRY_OR_FAIL(create(file->bytes()));
+    auto frame = TRY_OR_FAIL(plugin_decoder->frame(0, Gfx::IntSize { size.width() / 4, size.height() / 4 }));
+    expect_bitmaps_equal(*frame.image, *TRY_OR_FAIL(Gfx::ScanlineDownscaler::downscale(*full_frame.image, { {}, size }, 4)));
+}
+
+TEST_CASE(test_jpeg_region)
+{
+    Array test_inputs = {
+        TEST_INPUT("jpg/several_scans.jpg"sv),
+        TEST_INPUT("jpg/ycck-2111.jpg"sv),
+        TEST_INPUT("jpg/buggie-cmyk.jpg"sv),
+    };
+
+    for (auto test_input : test_inputs) {
+        auto file = TRY_OR_FAIL(Core::MappedFile::map(test_input));
+        auto plugin_decoder = TRY_OR_FAIL(Gfx::JPEGImageDecoderPlugin::create(file->bytes()));
+        auto full_frame = TRY_OR_FAIL(plugin_decoder->frame(0));
+        auto const size = full_frame.image->size();
+
+        Gfx::IntRect region { 16, 16, (size.width() - 16) / 2, (size.height() - 16) / 2 };
+        plugin_decoder = TRY_OR_FAIL(Gfx::JPEGImageDecoderPlugin::create(file->bytes()));
+        auto frame = TRY_OR_FAIL(plugin_decoder->frame_region(0, region));
+        expect_bitmaps_equal(*frame.image, *TRY_OR_FAIL(full_frame.image->cropped(region)));
+
+        // At reduced scales, the result matches cropping the whole image that was decoded at the same scale.
+        // CMYK images are always decoded as a whole, and cropped afterwards.
+        if (plugin_decoder->natural_frame_format() == Gfx::NaturalFrameFormat::CMYK)
+            continue;
+        for (int scale : { 2, 4, 8 }) {
+            auto ideal_size = Gfx::IntSize { region.width() / scale, region.height() / scale };
+            frame = TRY_OR_FAIL(plugin_decoder->frame_region(0, region, ideal_size));
+            auto reduced_frame = TRY_OR_FAIL(plugin_decoder->frame(0, Gfx::IntSize { ceil_div(size.width(), scale), ceil_div(size.height(), scale) }));
+            auto reduced_region = Gfx::IntRect::from_two_points(
+                { region.left() / scale, region.top() / scale },
+                { ceil_div(region.right(), scale), ceil_div(region.bottom(), scale) });
+            expect_bitmaps_equal(*frame.image, *TRY_OR_FAIL(reduced_frame.image->cropped(reduced_region)));
+        }
+    }
+}
+
 TEST_CASE(test_jpeg_malformed_header)
 {
     Array test_inputs = {
@@ -781,6 +921,28 @@ TEST_CASE(test_exif)
     EXPECT_EQ(*exif_metadata.orientation(), Gfx::TIFF::Orientation::Rotate90Clockwise);
 }
 
+TEST_CASE(test_apng)
+{
+    auto file = TRY_OR_FAIL(Core::MappedFile::map(TEST_INPUT("png/animated.png"sv)));
+    auto plugin_decoder = TRY_OR_FAIL(Gfx::PNGImageDecoderPlugin::create(file->bytes()));
+    EXPECT(plugin_decoder->is_animated());
+    EXPECT_EQ(plugin_decoder->frame_count(), 3u);
+    EXPECT_EQ(plugin_decoder->loop_count(), 0u);
+
+    auto expect_frame = [&](size_t index) {
+        auto frame = TRY_OR_FAIL(plugin_decoder->frame(index));
+        EXPECT_EQ(frame.duration, 100);
+        EXPECT_EQ(frame.image->size(), Gfx::IntSize(4, 4));
+        EXPECT_EQ(frame.image->get_pixel(3, 3), Gfx::Color::NamedColor::Red);
+        EXPECT_EQ(frame.image->get_pixel(2, 2), index >= 1 ? Gfx::Color::NamedColor::Blue : Gfx::Color::NamedColor::Red);
+        EXPECT_EQ(frame.image->get_pixel(0, 0), index >= 2 ? Gfx::Color::NamedColor::Green : Gfx::Color::NamedColor::Red);
+    };
+
+    // Going back to an earlier frame has to render all frames up to it again.
+    for (size_t index : { 2, 1, 2, 0, 1, 1 })
+        expect_frame(index);
+}
+
 TEST_CASE(test_png_malformed_frame)
 {
     Array test_inputs = {
@@ -796,6 +958,15 @@ TEST_CASE(test_png_malformed_frame)
     }
 }
 
+TEST_CASE(test_png_region)
+{
+    // RGBA, 16-bit RGB and indexed color images.
+    expect_regions_match_full_image(TEST_INPUT("png/buggie.png"sv), Gfx::PNGImageDecoderPlugin::create);
+    expect_regions_match_full_image(TEST_INPUT("png/wide-gamut-only.png"sv), Gfx::PNGImageDecoderPlugin::create);
+    expect_regions_match_full_image(TEST_INPUT("png/exif.png"sv), Gfx::PNGImageDecoderPlugin::create);
+    expect_scaled_down_while_decoding(TEST_INPUT("png/buggie.png"sv), Gfx::PNGImageDecoderPlugin::create);
+}
+
 TEST_CASE(test_ppm)
 {
     auto file = TRY_OR_FAIL(Core::MappedFile::map(TEST_INPUT("pnm/buggie-raw.ppm"sv)));
@@ -1099,6 +1270,22 @@ TEST_CASE(test_tiff_tiled)
     EXPECT_EQ(frame.image->get_pixel(60, 75), Gfx::Color::NamedColor::Red);
 }
 
+TEST_CASE(test_tiff_region)
+{
+    // Strips with different compressions and a predictor, tiles, and bilevel images.
+    expect_regions_match_full_image(TEST_INPUT("tiff/uncompressed.tiff"sv), Gfx::TIFFImageDecoderPlugin::create);
+    expect_regions_match_full_image(TEST_INPUT("tiff/lzw.tiff"sv), Gfx::TIFFImageDecoderPlugin::create);
+    expect_regions_match_full_image(TEST_INPUT("tiff/alpha_predictor.tiff"sv), Gfx::TIFFImageDecoderPlugin::create);
+    expect_regions_match_full_image(TEST_INPUT("tiff/tiled.tiff"sv), Gfx::TIFFImageDecoderPlugin::create);
+    expect_regions_match_full_image(TEST_INPUT("tiff/ccitt4.tiff"sv), Gfx::TIFFImageDecoderPlugin::create);
+
+    // These can't be decoded region by region (yet), and fall back to cropping the whole image.
+    expect_regions_match_full_image(TEST_INPUT("tiff/orientation.tiff"sv), Gfx::TIFFImageDecoderPlugin::create);
+    expect_regions_match_full_image(TEST_INPUT("tiff/cmyk.tiff"sv), Gfx::TIFFImageDecoderPlugin::create);
+
+    expect_scaled_down_while_decoding(TEST_INPUT("tiff/tiled.tiff"sv), Gfx::TIFFImageDecoderPlugin::create);
+}
+
 TEST_CASE(test_tiff_invalid_tag)
 {
     auto file = TRY_OR_FAIL(Core::MappedFile::map(TEST_INPUT("tiff/invalid_tag.tiff"sv)));
@@ -1125,6 +1312,17 @@ TEST_CASE(test_webp_simple_lossy)
     EXPECT_EQ(frame.image->get_pixel(198, 202), Gfx::Color(0x7b, 0xaa, 0xd5, 255));
 }
 
+TEST_CASE(test_webp_lossy_region)
+{
+    expect_regions_match_full_image(TEST_INPUT("webp/simple-vp8.webp"sv), Gfx::WebPImageDecoderPlugin::create);
+    expect_regions_match_full_image(TEST_INPUT("webp/4.webp"sv), Gfx::WebPImageDecoderPlugin::create);
+    expect_scaled_down_while_decoding(TEST_INPUT("webp/4.webp"sv), Gfx::WebPImageDecoderPlugin::create);
+
+    // Lossless images and images with alpha are decoded as a whole, and cropped and scaled down afterwards.
+    expect_regions_match_full_image(TEST_INPUT("webp/simple-vp8l.webp"sv), Gfx::WebPImageDecoderPlugin::create);
+    expect_regions_match_full_image(TEST_INPUT("webp/extended-lossy.webp"sv), Gfx::WebPImageDecoderPlugin::create);
+}
+
 TEST_CASE(test_webp_simple_lossless)
 {
     auto file = TRY_OR_FAIL(Core::MappedFile::map(TEST_INPUT("webp/simple-vp8l.webp"sv)));
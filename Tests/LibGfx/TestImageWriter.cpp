@@ -174,6 +174,28 @@ TEST_CASE(test_png)
     TRY_OR_FAIL((test_roundtrip<Gfx::PNGWriter, Gfx::PNGImageDecoderPlugin>(TRY_OR_FAIL(create_test_rgba_bitmap()))));
 }
 
+TEST_CASE(test_png_compression_options)
+{
+    // Wide enough for the filters to work on whole vectors for a while, with a few pixels left over at the end of each row.
+    auto bitmap = TRY_OR_FAIL(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, { 1023, 300 }));
+    for (int y = 0; y < bitmap->height(); ++y) {
+        for (int x = 0; x < bitmap->width(); ++x)
+            bitmap->set_pixel(x, y, Gfx::Color(x ^ y, (x * y) >> 4, x + y * 3, 255 - ((x + y) & 0x7f)));
+    }
+
+    using CompressionLevel = Gfx::PNGWriter::Options::CompressionLevel;
+    for (auto compression_level : { CompressionLevel::Fast, CompressionLevel::Default, CompressionLevel::Best }) {
+        for (bool compress_in_parallel : { false, true }) {
+            Gfx::PNGWriter::Options options;
+            options.compression_level = compression_level;
+            options.compress_in_parallel = compress_in_parallel;
+            auto encoded_data = TRY_OR_FAIL(encode_bitmap<Gfx::PNGWriter>(*bitmap, options));
+            auto decoded = TRY_OR_FAIL(expect_single_frame_of_size(*TRY_OR_FAIL(Gfx::PNGImageDecoderPlugin::create(encoded_data)), bitmap->size()));
+            expect_bitmaps_equal(*decoded, *bitmap);
+        }
+    }
+}
+
 TEST_CASE(test_qoi)
 {
     TRY_OR_FAIL((test_roundtrip<Gfx::QOIWriter, Gfx::QOIImageDecoderPlugin>(TRY_OR_FAIL(create_test_rgb_bitmap()))));
@@ -6,6 +6,9 @@
 
 #include <LibTest/TestCase.h>
 
+#include <AK/Math.h>
+#include <LibGfx/EdgeFlagPathRasterizer.h>
+#include <LibGfx/PaintStyle.h>
 #include <LibGfx/Painter.h>
 
 TEST_CASE(draw_scaled_bitmap_with_transform)
@@ -53,3 +56,69 @@ TEST_CASE(draw_rect_rough_bounds)
     painter.draw_rect(Gfx::IntRect(0, 0, 1, 1), Color::Black, true);
     painter.draw_rect(Gfx::IntRect(9, 9, 1, 1), Color::Black, true);
 }
+
+static Gfx::Path create_star_with_curves_path()
+{
+    Gfx::Path path;
+    auto center = Gfx::FloatPoint { 50.5f, 40.25f };
+    for (int i = 0; i < 37; i++) {
+        auto angle = 2 * AK::Pi<float> * i * 16 / 37;
+        auto point = center + Gfx::FloatPoint { AK::cos(angle) * 45, AK::sin(angle) * 35 };
+        if (i == 0)
+            path.move_to(point);
+        else
+            path.line_to(point);
+    }
+    path.close();
+    path.move_to({ 3.3f, 70 });
+    path.cubic_bezier_curve_to({ 40, 50 }, { 60, 95 }, { 97.7f, 72 });
+    path.quadratic_bezier_curve_to({ 50, 100 }, { 3.3f, 70 });
+    path.close();
+    return path;
+}
+
+template<unsigned SamplesPerPixel>
+static void expect_fill_with_color_matches_fill_with_paint_style(Gfx::BitmapFormat format, Color color, Gfx::Painter::WindingRule winding_rule)
+{
+    auto path = create_star_with_curves_path();
+    auto path_size = Gfx::enclosing_int_rect(path.bounding_box()).size();
+    auto paint_style = MUST(Gfx::SolidColorPaintStyle::create(color));
+
+    auto create_target = [&] {
+        auto bitmap = MUST(Gfx::Bitmap::create(format, { 110, 110 }));
+        for (int y = 0; y < bitmap->height(); ++y) {
+            for (int x = 0; x < bitmap->width(); ++x)
+                bitmap->scanline(y)[x] = ((x * 7 + y) & 0xff) << 24 | (x & 0xff) << 16 | (y & 0xff) << 8 | ((x ^ y) & 0xff);
+        }
+        return bitmap;
+    };
+
+    // Filling with a color takes the span fast paths, while a paint style is sampled for every pixel.
+    auto filled_with_color = create_target();
+    Gfx::Painter color_painter(filled_with_color);
+    color_painter.add_clip_rect({ 5, 0, 100, 105 });
+    Gfx::EdgeFlagPathRasterizer<SamplesPerPixel>(path_size).fill(color_painter, path, color, winding_rule, { 2.5f, 3 });
+
+    auto filled_with_paint_style = create_target();
+    Gfx::Painter paint_style_painter(filled_with_paint_style);
+    paint_style_painter.add_clip_rect({ 5, 0, 100, 105 });
+    Gfx::EdgeFlagPathRasterizer<SamplesPerPixel>(path_size).fill(paint_style_painter, path, paint_style, 1.0f, winding_rule, { 2.5f, 3 });
+
+    for (int y = 0; y < filled_with_color->height(); ++y) {
+        for (int x = 0; x < filled_with_color->width(); ++x)
+            EXPECT_EQ(filled_with_color->scanline(y)[x], filled_with_paint_style->scanline(y)[x]);
+    }
+}
+
+TEST_CASE(fill_path_with_color_matches_paint_style)
+{
+    for (auto format : { Gfx::BitmapFormat::BGRx8888, Gfx::BitmapFormat::BGRA8888 }) {
+        for (auto color : { Color(20, 40, 200), Color(200, 100, 0, 100) }) {
+            for (auto winding_rule : { Gfx::Painter::WindingRule::Nonzero, Gfx::Painter::WindingRule::EvenOdd }) {
+                expect_fill_with_color_matches_fill_with_paint_style<8>(format, color, winding_rule);
+                expect_fill_with_color_matches_fill_with_paint_style<16>(format, color, winding_rule);
+                expect_fill_with_color_matches_fill_with_paint_style<32>(format, color, winding_rule);
+            }
+        }
+    }
+}
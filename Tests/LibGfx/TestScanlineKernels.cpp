@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/Vector.h>
+#include <LibGfx/ScanlineKernels.h>
+#include <LibTest/TestCase.h>
+
+// A small deterministic generator, so that failures are reproducible.
+static u32 next_random(u32& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state;
+}
+
+static u32 swap_red_and_blue(u32 pixel)
+{
+    return (pixel & 0xff00ff00) | ((pixel & 0x000000ff) << 16) | ((pixel & 0x00ff0000) >> 16);
+}
+
+static Color reference_blend(u32 destination, u32 source, Gfx::ScanlineBlendOptions const& options)
+{
+    if (options.source_is_rgba)
+        source = swap_red_and_blue(source);
+    auto source_color = options.source_has_alpha ? Color::from_argb(source) : Color::from_rgb(source);
+    if (options.source_alpha_table)
+        source_color.set_alpha(options.source_alpha_table[source_color.alpha()]);
+    auto destination_color = options.destination_has_alpha ? Color::from_argb(destination) : Color::from_rgb(destination);
+    return destination_color.blend(source_color);
+}
+
+TEST_CASE(blend_scanline_matches_color_blend_for_all_alphas)
+{
+    u32 state = 1;
+    Vector<Gfx::ARGB32> destination;
+    Vector<Gfx::ARGB32> source;
+    // Every combination of source and destination alpha, with random colors. Each row has either the same source alpha
+    // or the same destination alpha throughout, and the odd row length exercises the scalar tail.
+    for (u32 row = 0; row < 512; ++row) {
+        destination.clear_with_capacity();
+        source.clear_with_capacity();
+        for (u32 column = 0; column < 256; ++column) {
+            auto destination_alpha = row < 256 ? row : column;
+            auto source_alpha = row < 256 ? column : row - 256;
+            destination.append((destination_alpha << 24) | (next_random(state) & 0xffffff));
+            source.append((source_alpha << 24) | (next_random(state) & 0xffffff));
+        }
+        source.append(next_random(state));
+        destination.append(next_random(state));
+
+        auto expected = destination;
+        for (size_t i = 0; i < expected.size(); ++i)
+            expected[i] = reference_blend(destination[i], source[i], {}).value();
+
+        Gfx::blend_scanline(destination.data(), source.data(), destination.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+            EXPECT_EQ(destination[i], expected[i]);
+    }
+}
+
+TEST_CASE(blend_scanline_options)
+{
+    Array<u8, 256> alpha_table;
+    for (size_t alpha = 0; alpha < alpha_table.size(); ++alpha)
+        alpha_table[alpha] = alpha * 0.6f;
+    Array<u8 const*, 2> alpha_tables { nullptr, alpha_table.data() };
+
+    u32 state = 2;
+    for (auto source_is_rgba : { false, true }) {
+        for (auto source_has_alpha : { false, true }) {
+            for (auto destination_has_alpha : { false, true }) {
+                for (auto* table : alpha_tables) {
+                    Gfx::ScanlineBlendOptions options {
+                        .source_is_rgba = source_is_rgba,
+                        .source_has_alpha = source_has_alpha,
+                        .destination_has_alpha = destination_has_alpha,
+                        .source_alpha_table = table,
+                    };
+
+                    Vector<Gfx::ARGB32> destination;
+                    Vector<Gfx::ARGB32> source;
+                    for (size_t i = 0; i < 1023; ++i) {
+                        destination.append(next_random(state));
+                        source.append(next_random(state));
+                    }
+
+                    auto expected = destination;
+                    for (size_t i = 0; i < expected.size(); ++i)
+                        expected[i] = reference_blend(destination[i], source[i], options).value();
+
+                    Gfx::blend_scanline(destination.data(), source.data(), destination.size(), options);
+                    EXPECT_EQ(destination, expected);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(blend_color_over_scanline)
+{
+    u32 state = 3;
+    for (auto destination_has_alpha : { false, true }) {
+        for (size_t i = 0; i < 256; ++i) {
+            auto color = Color::from_argb(next_random(state));
+
+            Vector<Gfx::ARGB32> destination;
+            for (size_t j = 0; j < 37; ++j)
+                destination.append(next_random(state));
+
+            auto expected = destination;
+            for (auto& pixel : expected)
+                pixel = (destination_has_alpha ? Color::from_argb(pixel) : Color::from_rgb(pixel)).blend(color).value();
+
+            Gfx::blend_color_over_scanline(destination.data(), destination.size(), color, destination_has_alpha);
+            EXPECT_EQ(destination, expected);
+        }
+    }
+}
+
+TEST_CASE(convert_rgba_to_bgra_scanline)
+{
+    Vector<u32> source { 0x11223344, 0xff0000ff, 0x00ff0000, 0x80808080, 0xdeadbeef };
+    Vector<Gfx::ARGB32> destination;
+    destination.resize(source.size());
+
+    Gfx::convert_rgba_to_bgra_scanline(destination.data(), source.data(), source.size());
+    EXPECT_EQ(destination, (Vector<Gfx::ARGB32> { 0x11443322, 0xffff0000, 0x000000ff, 0x80808080, 0xdeefbead }));
+}
+
+TEST_CASE(bilinear_blend_matches_mixed_with)
+{
+    u32 state = 4;
+    auto random_color = [&] {
+        auto value = next_random(state);
+        // Make equal alphas and equal colors common, as Color::mixed_with() takes a different path for those.
+        switch (value % 4) {
+        case 0:
+            return Color::from_argb(value | 0xff000000);
+        case 1:
+            return Color::from_argb(value & 0x00ffffff);
+        default:
+            return Color::from_argb(value);
+        }
+    };
+
+    for (size_t i = 0; i < 100'000; ++i) {
+        auto top_left = random_color();
+        auto top_right = (i % 5 == 0) ? top_left.with_alpha(next_random(state) & 0xff) : random_color();
+        auto bottom_left = random_color();
+        auto bottom_right = random_color();
+        float x_ratio = (next_random(state) % 1025) / 1024.0f;
+        float y_ratio = (next_random(state) % 1025) / 1024.0f;
+
+        auto top = top_left.mixed_with(top_right, x_ratio);
+        auto bottom = bottom_left.mixed_with(bottom_right, x_ratio);
+        auto expected = top.mixed_with(bottom, y_ratio);
+
+        EXPECT_EQ(Gfx::bilinear_blend(top_left, top_right, bottom_left, bottom_right, x_ratio, y_ratio), expected);
+    }
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Hex.h>
+#include <LibTLS/KeySchedule.h>
+#include <LibTest/TestCase.h>
+
+// The traces of a full handshake with TLS_AES_128_GCM_SHA256 and x25519:
+// https://www.rfc-editor.org/rfc/rfc8448#section-3
+
+static constexpr auto hash_kind = Crypto::Hash::HashKind::SHA256;
+
+static ByteBuffer client_handshake_traffic_secret()
+{
+    return MUST(decode_hex("b3eddb126e067f35a780b3abf45e2d8f3b1a950738f52e9600746a0e27a55a21"sv));
+}
+
+static ByteBuffer server_handshake_traffic_secret()
+{
+    return MUST(decode_hex("b67b7d690cc16c4e75e54213cb2d37b4e9c912bcded9105d42befd59d391ad38"sv));
+}
+
+// The client Finished handshake message, which is the first record that the client encrypts.
+static ByteBuffer client_finished()
+{
+    return MUST(decode_hex("14000020a8ec436d677634ae525ac1fcebe11a039ec17694fac6e98527b642f2edd5ce61"sv));
+}
+
+static ByteBuffer client_finished_record()
+{
+    return MUST(decode_hex("170303003575ec4dc238cce60b298044a71e219c56cc77b0517fe9b93c7a4bfc44d87f38f80338ac98fc46deb384bd1caeacab6867d726c40546"sv));
+}
+
+TEST_CASE(test_rfc8448_handshake_secrets)
+{
+    auto shared_secret = MUST(decode_hex("8bd4054fb55b9d63fdfbacf9f04b9f0d35e6d63f537563efd46272900f89492d"sv));
+    // Transcript-Hash(ClientHello, ServerHello)
+    auto transcript_hash = MUST(decode_hex("860c06edc07858ee8e78f0e7428c58edd6b43f2ca3e6e95f02ed063cf0e1cad8"sv));
+
+    auto secrets = TRY_OR_FAIL(TLS::TLS13::derive_handshake_secrets(hash_kind, {}, shared_secret, transcript_hash));
+    EXPECT_EQ(secrets.early_secret, MUST(decode_hex("33ad0a1c607ec03b09e6cd9893680ce210adf300aa1f2660e1b22e10f170f92a"sv)));
+    EXPECT_EQ(secrets.handshake_secret, MUST(decode_hex("1dc826e93606aa6fdc0aadc12f741b01046aa6b99f691ed221a9f0ca043fbeac"sv)));
+    EXPECT_EQ(secrets.client_handshake_traffic_secret, client_handshake_traffic_secret());
+    EXPECT_EQ(secrets.server_handshake_traffic_secret, server_handshake_traffic_secret());
+    EXPECT_EQ(secrets.master_secret, MUST(decode_hex("18df06843d13a08bf2a449844c5f8a478001bc4d4c627984d5a41da8d0402919"sv)));
+}
+
+TEST_CASE(test_rfc8448_derived_secret)
+{
+    auto early_secret = MUST(decode_hex("33ad0a1c607ec03b09e6cd9893680ce210adf300aa1f2660e1b22e10f170f92a"sv));
+    auto derived_secret = TRY_OR_FAIL(TLS::TLS13::derive_secret_for_empty_transcript(hash_kind, early_secret, "derived"sv));
+    EXPECT_EQ(derived_secret, MUST(decode_hex("6f2615a108c702c5678f54fc9dbab69716c076189c48250cebeac3576c3611ba"sv)));
+}
+
+TEST_CASE(test_rfc8448_handshake_traffic_keys)
+{
+    auto server_key = TRY_OR_FAIL(TLS::TLS13::derive_traffic_key(hash_kind, server_handshake_traffic_secret(), 16));
+    EXPECT_EQ(server_key.key, MUST(decode_hex("3fce516009c21727d0f2e4e86ee403bc"sv)));
+    EXPECT_EQ(ReadonlyBytes(server_key.iv, sizeof(server_key.iv)), MUST(decode_hex("5d313eb2671276ee13000b30"sv)).bytes());
+
+    auto client_key = TRY_OR_FAIL(TLS::TLS13::derive_traffic_key(hash_kind, client_handshake_traffic_secret(), 16));
+    EXPECT_EQ(client_key.key, MUST(decode_hex("dbfaa693d1762c5b666af5d950258d01"sv)));
+    EXPECT_EQ(ReadonlyBytes(client_key.iv, sizeof(client_key.iv)), MUST(decode_hex("5bd3c71b836e0b76bb73265f"sv)).bytes());
+}
+
+TEST_CASE(test_rfc8448_server_finished)
+{
+    // Transcript-Hash(ClientHello, ..., CertificateVerify)
+    auto transcript_hash = MUST(decode_hex("edb7725fa7a3473b031ec8ef65a2485493900138a2b91291407d7951a06110ed"sv));
+    auto verify_data = TRY_OR_FAIL(TLS::TLS13::finished_verify_data(hash_kind, server_handshake_traffic_secret(), transcript_hash));
+    EXPECT_EQ(verify_data, MUST(decode_hex("9b9b141d906337fbd2cbdce71df4deda4ab42c309572cb7fffee5454b78f0718"sv)));
+}
+
+TEST_CASE(test_rfc8448_record_encryption)
+{
+    auto traffic_key = TRY_OR_FAIL(TLS::TLS13::derive_traffic_key(hash_kind, client_handshake_traffic_secret(), 16));
+    Crypto::Cipher::AESCipher::GCMMode gcm(traffic_key.key, 128, Crypto::Cipher::Intent::Encryption, Crypto::Cipher::PaddingMode::RFC5246);
+
+    auto record = TRY_OR_FAIL(TLS::TLS13::encrypt_record(gcm, traffic_key.iv, 0, TLS::ContentType::HANDSHAKE, client_finished()));
+    EXPECT_EQ(record, client_finished_record());
+
+    // The nonce depends on the sequence number.
+    auto next_record = TRY_OR_FAIL(TLS::TLS13::encrypt_record(gcm, traffic_key.iv, 1, TLS::ContentType::HANDSHAKE, client_finished()));
+    EXPECT_EQ(next_record.size(), record.size());
+    EXPECT_NE(next_record, record);
+}
+
+TEST_CASE(test_rfc8448_record_decryption)
+{
+    auto traffic_key = TRY_OR_FAIL(TLS::TLS13::derive_traffic_key(hash_kind, client_handshake_traffic_secret(), 16));
+    Crypto::Cipher::AESCipher::GCMMode gcm(traffic_key.key, 128, Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::RFC5246);
+
+    ByteBuffer content;
+    auto type = TLS::TLS13::decrypt_record(gcm, traffic_key.iv, 0, client_finished_record(), content);
+    EXPECT(!type.is_error());
+    EXPECT_EQ(type.value(), TLS::ContentType::HANDSHAKE);
+    EXPECT_EQ(content, client_finished());
+}
+
+TEST_CASE(test_record_decryption_failures)
+{
+    auto traffic_key = TRY_OR_FAIL(TLS::TLS13::derive_traffic_key(hash_kind, client_handshake_traffic_secret(), 16));
+    Crypto::Cipher::AESCipher::GCMMode gcm(traffic_key.key, 128, Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::RFC5246);
+    ByteBuffer content;
+
+    // A record with the wrong sequence number doesn't authenticate.
+    auto result = TLS::TLS13::decrypt_record(gcm, traffic_key.iv, 1, client_finished_record(), content);
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.error(), TLS::AlertDescription::BAD_RECORD_MAC);
+
+    // Neither does a record that was tampered with.
+    auto tampered_record = client_finished_record();
+    tampered_record[10] ^= 1;
+    result = TLS::TLS13::decrypt_record(gcm, traffic_key.iv, 0, tampered_record, content);
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.error(), TLS::AlertDescription::BAD_RECORD_MAC);
+
+    // A record has to have room for at least the content type and the tag.
+    result = TLS::TLS13::decrypt_record(gcm, traffic_key.iv, 0, client_finished_record().bytes().trim(5 + 16), content);
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.error(), TLS::AlertDescription::DECODE_ERROR);
+}
+
+TEST_CASE(test_record_round_trip_with_padding_type)
+{
+    auto traffic_key = TRY_OR_FAIL(TLS::TLS13::derive_traffic_key(hash_kind, server_handshake_traffic_secret(), 16));
+    Crypto::Cipher::AESCipher::GCMMode encryption(traffic_key.key, 128, Crypto::Cipher::Intent::Encryption, Crypto::Cipher::PaddingMode::RFC5246);
+    Crypto::Cipher::AESCipher::GCMMode decryption(traffic_key.key, 128, Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::RFC5246);
+
+    // Trailing zeros of the content must not be taken for padding.
+    auto data = MUST(decode_hex("0001020000"sv));
+    auto record = TRY_OR_FAIL(TLS::TLS13::encrypt_record(encryption, traffic_key.iv, 7, TLS::ContentType::APPLICATION_DATA, data));
+    EXPECT_EQ(record[0], (u8)TLS::ContentType::APPLICATION_DATA);
+
+    ByteBuffer content;
+    auto type = TLS::TLS13::decrypt_record(decryption, traffic_key.iv, 7, record, content);
+    EXPECT(!type.is_error());
+    EXPECT_EQ(type.value(), TLS::ContentType::APPLICATION_DATA);
+    EXPECT_EQ(content, data);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteString.h>
+#include <LibTLS/SessionCache.h>
+#include <LibTest/TestCase.h>
+
+static TLS::SessionCache::TLS12Session make_tls12_session(u8 id, Duration lifetime = Duration::from_seconds(60))
+{
+    return TLS::SessionCache::TLS12Session {
+        .session_id = MUST(ByteBuffer::copy(&id, 1)),
+        .ticket = {},
+        .master_secret = MUST(ByteBuffer::create_zeroed(48)),
+        .cipher = TLS::CipherSuite::TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256,
+        .extended_master_secret = true,
+        .expires_at = UnixDateTime::now() + lifetime,
+    };
+}
+
+static TLS::SessionCache::TLS13Ticket make_tls13_ticket(u8 id, Duration lifetime = Duration::from_seconds(60))
+{
+    auto now = UnixDateTime::now();
+    return TLS::SessionCache::TLS13Ticket {
+        .ticket = MUST(ByteBuffer::copy(&id, 1)),
+        .pre_shared_key = MUST(ByteBuffer::create_zeroed(32)),
+        .cipher = TLS::CipherSuite::TLS_AES_128_GCM_SHA256,
+        .age_add = id,
+        .received_at = now,
+        .expires_at = now + lifetime,
+    };
+}
+
+TEST_CASE(tls12_session_is_kept_per_host)
+{
+    auto cache = TLS::SessionCache::create();
+    cache->store_tls12_session("a.example"sv, make_tls12_session(1));
+    cache->store_tls12_session("b.example"sv, make_tls12_session(2));
+
+    // Unlike TLS 1.3 tickets, a session can be resumed any number of times.
+    for (size_t i = 0; i < 2; ++i) {
+        auto session = cache->tls12_session("a.example"sv);
+        EXPECT(session.has_value());
+        EXPECT_EQ(session->session_id[0], 1);
+    }
+    EXPECT_EQ(cache->tls12_session("b.example"sv)->session_id[0], 2);
+    EXPECT(!cache->tls12_session("c.example"sv).has_value());
+
+    cache->forget_tls12_session("a.example"sv);
+    EXPECT(!cache->tls12_session("a.example"sv).has_value());
+    EXPECT(cache->tls12_session("b.example"sv).has_value());
+}
+
+TEST_CASE(tls13_ticket_is_taken_only_once)
+{
+    auto cache = TLS::SessionCache::create();
+    cache->store_tls13_ticket("a.example"sv, make_tls13_ticket(1));
+
+    auto ticket = cache->take_tls13_ticket("a.example"sv);
+    EXPECT(ticket.has_value());
+    EXPECT_EQ(ticket->ticket[0], 1);
+    EXPECT(!cache->take_tls13_ticket("a.example"sv).has_value());
+}
+
+TEST_CASE(newest_tls13_ticket_is_taken_first)
+{
+    auto cache = TLS::SessionCache::create();
+    for (u8 i = 0; i < TLS::SessionCache::max_tls13_tickets_per_host + 2; ++i)
+        cache->store_tls13_ticket("a.example"sv, make_tls13_ticket(i));
+
+    // Only the newest tickets are kept.
+    for (size_t i = 0; i < TLS::SessionCache::max_tls13_tickets_per_host; ++i) {
+        auto ticket = cache->take_tls13_ticket("a.example"sv);
+        EXPECT(ticket.has_value());
+        EXPECT_EQ(ticket->ticket[0], TLS::SessionCache::max_tls13_tickets_per_host + 1 - i);
+    }
+    EXPECT(!cache->take_tls13_ticket("a.example"sv).has_value());
+}
+
+TEST_CASE(expired_entries_are_not_returned)
+{
+    auto cache = TLS::SessionCache::create();
+    cache->store_tls12_session("a.example"sv, make_tls12_session(1, Duration::from_seconds(-1)));
+    EXPECT(!cache->tls12_session("a.example"sv).has_value());
+
+    cache->store_tls13_ticket("a.example"sv, make_tls13_ticket(1));
+    cache->store_tls13_ticket("a.example"sv, make_tls13_ticket(2, Duration::from_seconds(-1)));
+
+    // The expired ticket is newer, but must be skipped.
+    auto ticket = cache->take_tls13_ticket("a.example"sv);
+    EXPECT(ticket.has_value());
+    EXPECT_EQ(ticket->ticket[0], 1);
+    EXPECT(!cache->take_tls13_ticket("a.example"sv).has_value());
+}
+
+TEST_CASE(least_recently_used_host_is_evicted)
+{
+    auto cache = TLS::SessionCache::create();
+    auto host = [](size_t i) { return ByteString::formatted("{}.example", i); };
+
+    for (size_t i = 0; i < TLS::SessionCache::max_hosts; ++i)
+        cache->store_tls12_session(host(i), make_tls12_session(static_cast<u8>(i)));
+
+    // Using the first host makes the second one the least recently used.
+    EXPECT(cache->tls12_session(host(0)).has_value());
+    cache->store_tls13_ticket(host(TLS::SessionCache::max_hosts), make_tls13_ticket(0));
+
+    EXPECT(cache->tls12_session(host(0)).has_value());
+    EXPECT(!cache->tls12_session(host(1)).has_value());
+    for (size_t i = 2; i < TLS::SessionCache::max_hosts; ++i)
+        EXPECT(cache->tls12_session(host(i)).has_value());
+    EXPECT(cache->take_tls13_ticket(host(TLS::SessionCache::max_hosts)).has_value());
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/ThreadPool.h>
+
+TEST_CASE(wait_for_all_waits_for_all_work)
+{
+    Atomic<size_t> done_count { 0 };
+    Threading::ThreadPool<size_t> pool(
+        [&](size_t) {
+            done_count++;
+        },
+        4);
+
+    // Many short rounds, so that work finishing right as wait_for_all() starts waiting is likely to happen.
+    for (size_t round = 1; round <= 1000; ++round) {
+        for (size_t i = 0; i < 10; ++i)
+            pool.submit(i);
+        pool.wait_for_all();
+        EXPECT_EQ(done_count.load(), round * 10);
+    }
+}
+
+TEST_CASE(wait_for_all_without_work)
+{
+    Threading::ThreadPool<size_t> pool([](size_t) {}, 2);
+    pool.wait_for_all();
+}
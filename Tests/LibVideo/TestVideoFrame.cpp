@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibVideo/Color/ColorConverter.h>
+#include <LibVideo/VideoFrame.h>
+
+static constexpr auto bt709_srgb_studio = Video::CodingIndependentCodePoints(Video::ColorPrimaries::BT709, Video::TransferCharacteristics::SRGB, Video::MatrixCoefficients::BT709, Video::VideoFullRangeFlag::Studio);
+
+static Vector<u16> create_plane(u32 width, u32 height, u32 seed)
+{
+    Vector<u16> plane;
+    plane.resize(width * height);
+    for (u32 y = 0; y < height; y++) {
+        for (u32 x = 0; x < width; x++)
+            plane[y * width + x] = static_cast<u16>((x * 7 + y * 13 + seed * (x ^ y)) % 256);
+    }
+    return plane;
+}
+
+static NonnullOwnPtr<Video::SubsampledYUVFrame> create_frame(Gfx::Size<u32> size, bool subsampling_horizontal, bool subsampling_vertical, Video::CodingIndependentCodePoints cicp)
+{
+    auto uv_width = (size.width() + subsampling_horizontal) >> subsampling_horizontal;
+    auto uv_height = (size.height() + subsampling_vertical) >> subsampling_vertical;
+    auto plane_y = create_plane(size.width(), size.height(), 3);
+    auto plane_u = create_plane(uv_width, uv_height, 5);
+    auto plane_v = create_plane(uv_width, uv_height, 11);
+    return MUST(Video::SubsampledYUVFrame::try_create(size, 8, cicp, subsampling_horizontal, subsampling_vertical, plane_y, plane_u, plane_v));
+}
+
+TEST_CASE(simple_conversion_matches_scalar_conversion)
+{
+    // Without subsampling, each pixel is converted from the samples at the same position, whatever the SIMD width is.
+    Gfx::Size<u32> size { 37, 5 };
+    auto frame = create_frame(size, false, false, bt709_srgb_studio);
+    auto bitmap = MUST(frame->to_bitmap());
+
+    for (u32 y = 0; y < size.height(); y++) {
+        for (u32 x = 0; x < size.width(); x++) {
+            auto index = y * size.width() + x;
+            auto expected = Video::ColorConverter::convert_simple_yuv_to_rgb<Video::MatrixCoefficients::BT709, Video::VideoFullRangeFlag::Studio>(
+                frame->buffer().plane(0)[index], frame->buffer().plane(1)[index], frame->buffer().plane(2)[index]);
+            EXPECT_EQ(bitmap->get_pixel(x, y), expected);
+        }
+    }
+}
+
+TEST_CASE(full_range_conversion_matches_color_converter)
+{
+    auto cicp = Video::CodingIndependentCodePoints(Video::ColorPrimaries::BT709, Video::TransferCharacteristics::SRGB, Video::MatrixCoefficients::BT709, Video::VideoFullRangeFlag::Full);
+    Gfx::Size<u32> size { 19, 3 };
+    auto frame = create_frame(size, false, false, cicp);
+    auto bitmap = MUST(frame->to_bitmap());
+
+    auto converter = MUST(Video::ColorConverter::create(8, cicp, cicp));
+    for (u32 y = 0; y < size.height(); y++) {
+        for (u32 x = 0; x < size.width(); x++) {
+            auto index = y * size.width() + x;
+            auto expected = converter.convert_yuv(frame->buffer().plane(0)[index], frame->buffer().plane(1)[index], frame->buffer().plane(2)[index]);
+            auto actual = bitmap->get_pixel(x, y);
+            EXPECT(abs(actual.red() - expected.red()) <= 1);
+            EXPECT(abs(actual.green() - expected.green()) <= 1);
+            EXPECT(abs(actual.blue() - expected.blue()) <= 1);
+        }
+    }
+}
+
+TEST_CASE(planes_with_padding)
+{
+    // Decoders hand out their buffers with the padding they decoded into, which must not show up in the output.
+    Gfx::Size<u32> size { 21, 9 };
+    auto packed_frame = create_frame(size, true, true, bt709_srgb_studio);
+    auto const& packed = packed_frame->buffer();
+
+    u32 y_stride = 32;
+    u32 uv_stride = 16;
+    auto buffer = MUST(Video::VideoFrameBuffer::create());
+    auto pad = [](Vector<u16> const& plane, Vector<u16>& padded_plane, u32 width, u32 stride) {
+        padded_plane.resize(plane.size() / width * stride);
+        padded_plane.span().fill(0xff);
+        for (size_t row = 0; row < plane.size() / width; row++)
+            memcpy(padded_plane.data() + row * stride, plane.data() + row * width, width * sizeof(u16));
+    };
+    pad(packed.plane(0), buffer->plane(0), size.width(), y_stride);
+    pad(packed.plane(1), buffer->plane(1), (size.width() + 1) / 2, uv_stride);
+    pad(packed.plane(2), buffer->plane(2), (size.width() + 1) / 2, uv_stride);
+    Video::SubsampledYUVFrame padded_frame(size, 8, bt709_srgb_studio, true, true, buffer, y_stride, uv_stride);
+
+    auto expected = MUST(packed_frame->to_bitmap());
+    auto actual = MUST(padded_frame.to_bitmap());
+    for (int y = 0; y < expected->height(); y++) {
+        for (int x = 0; x < expected->width(); x++)
+            EXPECT_EQ(actual->get_pixel(x, y), expected->get_pixel(x, y));
+    }
+}
+
+TEST_CASE(frame_buffer_pool_reuses_released_buffers)
+{
+    Video::VideoFrameBufferPool pool(2);
+    auto first = MUST(pool.take());
+    auto second = MUST(pool.take());
+    EXPECT_NE(first.ptr(), second.ptr());
+
+    // Buffers beyond the size of the pool are not kept around.
+    auto* third = MUST(pool.take()).ptr();
+    EXPECT_NE(third, first.ptr());
+    EXPECT_NE(third, second.ptr());
+
+    auto* released = second.ptr();
+    second = first;
+    EXPECT_EQ(MUST(pool.take()).ptr(), released);
+}
+
+BENCHMARK_CASE(convert_4k_frame)
+{
+    auto frame = create_frame({ 3840, 2160 }, true, true, bt709_srgb_studio);
+    auto bitmap = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { 3840, 2160 }));
+    for (size_t i = 0; i < 20; i++)
+        MUST(frame->output_to_bitmap(bitmap));
+}
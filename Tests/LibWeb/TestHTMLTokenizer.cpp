@@ -86,6 +86,65 @@ static Vector<Token> run_tokenizer(StringView input)
     return tokens;
 }
 
+static Vector<Token> run_tokenizer_with_streamed_input(StringView input, size_t chunk_size)
+{
+    Vector<Token> tokens;
+    Tokenizer tokenizer;
+    tokenizer.open_input_stream();
+
+    auto run_until_out_of_input = [&] {
+        while (true) {
+            auto maybe_token = tokenizer.next_token();
+            if (!maybe_token.has_value())
+                break;
+            tokens.append(maybe_token.release_value());
+        }
+    };
+
+    size_t offset = 0;
+    while (offset < input.length()) {
+        auto end = min(offset + chunk_size, input.length());
+        // Never split a UTF-8 sequence, just like the HTML parser doesn't.
+        while (end < input.length() && (static_cast<u8>(input[end]) & 0xC0) == 0x80)
+            ++end;
+        tokenizer.append_to_input_stream(input.substring_view(offset, end - offset));
+        run_until_out_of_input();
+        offset = end;
+    }
+
+    tokenizer.close_input_stream();
+    run_until_out_of_input();
+    return tokens;
+}
+
+enum class UseTextRuns {
+    No,
+    Yes,
+};
+
+// Describes the tokens as text, with the data of consecutive character tokens merged into one run.
+static ByteString describe_tokens(StringView input, UseTextRuns use_text_runs)
+{
+    StringBuilder builder;
+    Tokenizer tokenizer { input, "UTF-8"sv };
+    while (true) {
+        if (use_text_runs == UseTextRuns::Yes) {
+            if (auto text = tokenizer.consume_text_run(); !text.is_empty()) {
+                builder.append(text);
+                continue;
+            }
+        }
+        auto maybe_token = tokenizer.next_token();
+        if (!maybe_token.has_value())
+            break;
+        if (maybe_token->is_character())
+            builder.append_code_point(maybe_token->code_point());
+        else
+            builder.appendff("\n{}\n", maybe_token->to_string());
+    }
+    return builder.to_byte_string();
+}
+
 // FIXME: It's not very nice to rely on the format of HTMLToken::to_string() to stay the same.
 static u32 hash_tokens(Vector<Token> const& tokens)
 {
@@ -219,6 +278,34 @@ TEST_CASE(doctype)
     EXPECT_END_TAG_TOKEN(html, 23u, 27u);
 }
 
+TEST_CASE(streamed_input)
+{
+    auto input = "<!DOCTYPE html><p class=\"a b\" id=x>Fish &amp; chips&nbsp;&notin;\r\n<!-- comment --><br/></p>\r\n<script>if (a < b) {}</script>"sv;
+    auto expected_hash = hash_tokens(run_tokenizer(input));
+
+    for (size_t chunk_size : { 1, 2, 3, 7, 64, 1000 })
+        EXPECT_EQ(hash_tokens(run_tokenizer_with_streamed_input(input, chunk_size)), expected_hash);
+}
+
+TEST_CASE(text_runs)
+{
+    auto input = "<!DOCTYPE html>\n<p>Plain text that is long enough to be scanned in blocks of sixteen bytes.</p>\r\n<p>Non-ASCII: \xc3\xa9t\xc3\xa9, \xe2\x82\xac, \xf0\x9f\x90\x9e\n   \xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e</p>\r\r\n"
+                 "Fish &amp; chips&nbsp;&notin;<b>bold</b>\0null\rcarriage return<!-- comment --><br/>"
+                 "<p title=\"text\">more text</p>trailing text without a tag"sv;
+    auto expected = describe_tokens(input, UseTextRuns::No);
+    EXPECT_EQ(describe_tokens(input, UseTextRuns::Yes), expected);
+
+    // Consuming a run is a no-op outside the data state.
+    Tokenizer tokenizer { "<p>text"sv, "UTF-8"sv };
+    EXPECT(tokenizer.consume_text_run().is_empty());
+    EXPECT(tokenizer.next_token()->is_start_tag());
+    EXPECT_EQ(tokenizer.consume_text_run(), "text"sv);
+    EXPECT(tokenizer.next_token()->is_end_of_file());
+
+    tokenizer.switch_to(Tokenizer::State::RCDATA);
+    EXPECT(tokenizer.consume_text_run().is_empty());
+}
+
 // NOTE: This relies on the format of HTMLToken::to_string() staying the same.
 //       If that changes, or something is added to the test HTML, the hash needs to be adjusted.
 TEST_CASE(regression)
@@ -238,4 +325,54 @@ TEST_CASE(regression)
     auto tokens = run_tokenizer(file_contents);
     u32 hash = hash_tokens(tokens);
     EXPECT_EQ(hash, 3657343287u);
+
+    auto streamed_tokens = run_tokenizer_with_streamed_input(file_contents, 100);
+    EXPECT_EQ(hash_tokens(streamed_tokens), 3657343287u);
+
+    EXPECT_EQ(describe_tokens(file_contents, UseTextRuns::Yes), describe_tokens(file_contents, UseTextRuns::No));
+}
+
+static ByteString make_text_heavy_document()
+{
+    StringBuilder builder;
+    builder.append("<!DOCTYPE html><html><head><title>Benchmark</title></head><body>\n"sv);
+    for (size_t i = 0; i < 2000; ++i) {
+        builder.appendff("<p class=\"paragraph\" id=\"p{}\">Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+                         "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud exercitation "
+                         "ullamco laboris nisi ut aliquip ex ea commodo consequat. <a href=\"#p{}\">Link</a> &amp; more text.</p>\n",
+            i, i);
+    }
+    builder.append("</body></html>\n"sv);
+    return builder.to_byte_string();
+}
+
+BENCHMARK_CASE(tokenize_text_heavy_document)
+{
+    auto input = make_text_heavy_document();
+    size_t token_count = 0;
+    for (size_t i = 0; i < 10; ++i) {
+        Tokenizer tokenizer { input, "UTF-8"sv };
+        while (tokenizer.next_token().has_value())
+            ++token_count;
+    }
+    EXPECT(token_count > 0);
+}
+
+BENCHMARK_CASE(tokenize_text_heavy_document_with_text_runs)
+{
+    auto input = make_text_heavy_document();
+    size_t token_count = 0;
+    for (size_t i = 0; i < 10; ++i) {
+        Tokenizer tokenizer { input, "UTF-8"sv };
+        while (true) {
+            if (!tokenizer.consume_text_run().is_empty()) {
+                ++token_count;
+                continue;
+            }
+            if (!tokenizer.next_token().has_value())
+                break;
+            ++token_count;
+        }
+    }
+    EXPECT(token_count > 0);
 }
@@ -242,11 +242,17 @@ ErrorOr<void> ViewWidget::try_open_file(String const& path, Core::File& file)
         auto decoded_image = TRY(client->decode_image(file_data, {}, {}, OptionalNone {}, mime_type)->await());
         is_animated = decoded_image.is_animated;
         loop_count = decoded_image.loop_count;
-        frames.ensure_capacity(decoded_image.frames.size());
+        frames.ensure_capacity(decoded_image.frame_count);
         for (u32 i = 0; i < decoded_image.frames.size(); i++) {
             auto& frame_data = decoded_image.frames[i];
             frames.unchecked_append({ BitmapImage::create(frame_data.bitmap, decoded_image.scale), int(frame_data.duration) });
         }
+        // Animated images only come with their first frame.
+        for (u32 i = decoded_image.frames.size(); i < decoded_image.frame_count; i++) {
+            auto frame_data = TRY(client->request_frame(decoded_image.image_id, i, {}, {})->await());
+            frames.unchecked_append({ BitmapImage::create(frame_data.bitmap, decoded_image.scale), int(frame_data.duration) });
+        }
+        client->release_image(decoded_image.image_id);
     }
 
     m_image = frames[0].image;
@@ -201,6 +201,7 @@ RefPtr<Gfx::Bitmap> SoundPlayerWidget::get_image_from_music_file()
         return {};
 
     auto const decoded_image = decoded_image_or_error.release_value();
+    m_image_decoder_client.release_image(decoded_image.image_id);
     return decoded_image.frames[0].bitmap;
 }
 
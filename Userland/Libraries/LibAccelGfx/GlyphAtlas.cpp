@@ -21,7 +21,11 @@ GlyphAtlas& GlyphAtlas::the()
 void GlyphAtlas::update(HashMap<Gfx::Font const*, HashTable<u32>> const& unique_glyphs)
 {
     auto need_to_rebuild_texture = false;
-    HashMap<GlyphsTextureKey, NonnullRefPtr<Gfx::Bitmap>> glyph_bitmaps;
+    struct GlyphBitmap {
+        NonnullRefPtr<Gfx::Bitmap> bitmap;
+        Gfx::IntRect rect;
+    };
+    HashMap<GlyphsTextureKey, GlyphBitmap> glyph_bitmaps;
     for (auto const& [font, code_points] : unique_glyphs) {
         for (auto const& code_point : code_points) {
             auto glyph = font->glyph(code_point);
@@ -29,7 +33,7 @@ void GlyphAtlas::update(HashMap<Gfx::Font const*, HashTable<u32>> const& unique_
             if (!m_glyphs_texture_map.contains(atlas_key))
                 need_to_rebuild_texture = true;
             if (glyph.bitmap()) {
-                glyph_bitmaps.set(atlas_key, *glyph.bitmap());
+                glyph_bitmaps.set(atlas_key, { *glyph.bitmap(), glyph.bitmap_rect() });
             }
         }
     }
@@ -45,9 +49,9 @@ void GlyphAtlas::update(HashMap<Gfx::Font const*, HashTable<u32>> const& unique_
         glyphs_sorted_by_height.append(atlas_key);
     }
     quick_sort(glyphs_sorted_by_height, [&](auto const& a, auto const& b) {
-        auto const* bitmap_a = *glyph_bitmaps.get(a);
-        auto const* bitmap_b = *glyph_bitmaps.get(b);
-        return bitmap_a->height() > bitmap_b->height();
+        auto const& bitmap_a = glyph_bitmaps.get(a).value();
+        auto const& bitmap_b = glyph_bitmaps.get(b).value();
+        return bitmap_a.rect.height() > bitmap_b.rect.height();
     });
 
     int current_x = 0;
@@ -56,22 +60,22 @@ void GlyphAtlas::update(HashMap<Gfx::Font const*, HashTable<u32>> const& unique_
     int const texture_width = 512;
     int const padding = 1;
     for (auto const& glyphs_texture_key : glyphs_sorted_by_height) {
-        auto const* bitmap = *glyph_bitmaps.get(glyphs_texture_key);
-        if (current_x + bitmap->width() > texture_width) {
+        auto const& glyph_rect = glyph_bitmaps.get(glyphs_texture_key)->rect;
+        if (current_x + glyph_rect.width() > texture_width) {
             current_x = 0;
             current_y += row_height + padding;
             row_height = 0;
         }
-        m_glyphs_texture_map.set(glyphs_texture_key, { current_x, current_y, bitmap->width(), bitmap->height() });
-        current_x += bitmap->width() + padding;
-        row_height = max(row_height, bitmap->height());
+        m_glyphs_texture_map.set(glyphs_texture_key, { current_x, current_y, glyph_rect.width(), glyph_rect.height() });
+        current_x += glyph_rect.width() + padding;
+        row_height = max(row_height, glyph_rect.height());
     }
 
     auto glyphs_texture_bitmap = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, { texture_width, current_y + row_height }));
     auto glyphs_texture_painter = Gfx::Painter(*glyphs_texture_bitmap);
     for (auto const& [glyphs_texture_key, glyph_bitmap] : glyph_bitmaps) {
         auto rect = m_glyphs_texture_map.get(glyphs_texture_key).value();
-        glyphs_texture_painter.blit({ rect.x(), rect.y() }, glyph_bitmap, glyph_bitmap->rect());
+        glyphs_texture_painter.blit({ rect.x(), rect.y() }, glyph_bitmap.bitmap, glyph_bitmap.rect);
     }
 
     GL::upload_texture_data(m_texture, *glyphs_texture_bitmap);
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/BitStream.h>
+#include <AK/LexicalPath.h>
+#include <AK/MemoryStream.h>
+#include <AK/QuickSort.h>
+#include <LibArchive/Extraction.h>
+#include <LibCompress/Deflate.h>
+#include <LibCore/Directory.h>
+#include <LibCore/System.h>
+#include <LibCrypto/Checksum/CRC32.h>
+#include <LibThreading/ThreadPool.h>
+#include <fcntl.h>
+
+namespace Archive {
+
+static constexpr size_t decompression_buffer_size = 256 * KiB;
+
+ErrorOr<NonnullOwnPtr<Core::File>> create_file_for_extraction(StringView path, mode_t mode, u64 size)
+{
+    auto fd = TRY(Core::System::open(path, O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC, mode));
+    auto file = TRY(Core::File::adopt_fd(fd, Core::File::OpenMode::Write));
+
+#if defined(AK_OS_SERENITY) || defined(AK_OS_LINUX)
+    if (size >= preallocation_threshold) {
+        // This lets the file system allocate the whole file at once, and a full disk is noticed before anything is written.
+        // Where preallocation isn't supported, the file is simply extended as it is written.
+        auto result = Core::System::posix_fallocate(fd, 0, size);
+        if (result.is_error() && result.error().code() == ENOSPC)
+            return result.release_error();
+    }
+#else
+    (void)size;
+#endif
+
+    return file;
+}
+
+ErrorOr<void> decompress_zip_member(ZipMember const& member, Stream& output)
+{
+    Crypto::Checksum::CRC32 checksum;
+    size_t decompressed_size = 0;
+
+    switch (member.compression_method) {
+    case ZipCompressionMethod::Store:
+        TRY(output.write_until_depleted(member.compressed_data));
+        checksum.update(member.compressed_data);
+        decompressed_size = member.compressed_data.size();
+        break;
+    case ZipCompressionMethod::Deflate: {
+        FixedMemoryStream memory_stream { member.compressed_data };
+        LittleEndianInputBitStream bit_stream { MaybeOwned<Stream>(memory_stream) };
+        auto deflate_stream = TRY(Compress::DeflateDecompressor::construct(MaybeOwned<LittleEndianInputBitStream>(bit_stream)));
+
+        auto buffer = TRY(ByteBuffer::create_uninitialized(clamp<size_t>(member.uncompressed_size, 1, decompression_buffer_size)));
+        while (!deflate_stream->is_eof()) {
+            auto slice = TRY(deflate_stream->read_some(buffer));
+            decompressed_size += slice.size();
+            if (decompressed_size > member.uncompressed_size)
+                return Error::from_string_literal("Zip member is larger than its recorded size");
+            checksum.update(slice);
+            TRY(output.write_until_depleted(slice));
+        }
+        break;
+    }
+    default:
+        return Error::from_string_literal("Unsupported zip compression method");
+    }
+
+    if (decompressed_size != member.uncompressed_size)
+        return Error::from_string_literal("Zip member is smaller than its recorded size");
+    if (checksum.digest() != member.crc32)
+        return Error::from_string_literal("CRC32 mismatch");
+    return {};
+}
+
+static ErrorOr<void> adjust_modification_time(ZipMember const& member)
+{
+    auto time = time_from_packed_dos(member.modification_date, member.modification_time);
+    auto seconds = static_cast<time_t>(time.seconds_since_epoch());
+    struct utimbuf buf {
+        .actime = seconds,
+        .modtime = seconds
+    };
+
+    return Core::System::utime(member.name, buf);
+}
+
+ErrorOr<void> extract_zip_member(ZipMember const& member)
+{
+    auto path = member.name.to_byte_string();
+
+    if (member.is_directory) {
+        TRY(Core::Directory::create(path, Core::Directory::CreateDirectories::Yes));
+        return adjust_modification_time(member);
+    }
+
+    TRY(Core::Directory::create(LexicalPath(path).parent(), Core::Directory::CreateDirectories::Yes));
+    auto file = TRY(create_file_for_extraction(path, 0666, member.uncompressed_size));
+
+    if (auto result = decompress_zip_member(member, *file); result.is_error()) {
+        file->close();
+        (void)Core::System::unlink(path);
+        return result.release_error();
+    }
+
+    file->close();
+    return adjust_modification_time(member);
+}
+
+ErrorOr<void> extract_zip_members(ReadonlySpan<ZipMember> members, Optional<size_t> thread_count, Function<void(ZipMember const&, ErrorOr<void> const&)> on_member_extracted)
+{
+    Threading::Mutex report_mutex;
+    Optional<Error> first_error;
+    Atomic<bool> failed { false };
+
+    auto extract = [&](ZipMember const& member) {
+        auto result = extract_zip_member(member);
+
+        Threading::MutexLocker locker(report_mutex);
+        if (on_member_extracted)
+            on_member_extracted(member, result);
+        if (result.is_error() && !first_error.has_value()) {
+            first_error = result.release_error();
+            failed.store(true);
+        }
+    };
+
+    Vector<size_t> file_indices;
+    for (size_t i = 0; i < members.size(); ++i) {
+        if (!members[i].is_directory) {
+            TRY(file_indices.try_append(i));
+            continue;
+        }
+
+        // The directories are created up front, so the files don't have to race to create them.
+        extract(members[i]);
+        if (first_error.has_value())
+            return first_error.release_value();
+    }
+
+    auto resolved_thread_count = min(max<size_t>(thread_count.value_or(Core::System::hardware_concurrency()), 1), file_indices.size());
+    if (resolved_thread_count <= 1) {
+        for (auto index : file_indices) {
+            extract(members[index]);
+            if (first_error.has_value())
+                return first_error.release_value();
+        }
+    } else {
+        // Start with the largest files, so that no big one is left to be extracted on its own at the end.
+        quick_sort(file_indices, [&](size_t a, size_t b) {
+            return members[a].uncompressed_size > members[b].uncompressed_size;
+        });
+
+        Threading::ThreadPool<size_t> pool(
+            [&](size_t index) {
+                if (!failed.load())
+                    extract(members[index]);
+            },
+            resolved_thread_count);
+
+        for (auto index : file_indices)
+            pool.submit(index);
+        pool.wait_for_all();
+
+        if (first_error.has_value())
+            return first_error.release_value();
+    }
+
+    // Writing the files has updated the modification times of the directories they are in, so set them again.
+    for (auto const& member : members) {
+        if (member.is_directory)
+            TRY(adjust_modification_time(member));
+    }
+
+    return {};
+}
+
+}
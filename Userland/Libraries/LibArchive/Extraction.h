@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/Span.h>
+#include <AK/Stream.h>
+#include <LibArchive/Zip.h>
+#include <LibCore/File.h>
+
+namespace Archive {
+
+// Files of at least this size get their storage reserved before any of their contents are written.
+static constexpr u64 preallocation_threshold = 1 * MiB;
+
+// Creates the file at `path` (or truncates it) to receive `size` bytes of extracted contents.
+ErrorOr<NonnullOwnPtr<Core::File>> create_file_for_extraction(StringView path, mode_t, u64 size);
+
+// Writes the contents of a zip member to `output`, and checks them against the size and CRC32 the archive records.
+ErrorOr<void> decompress_zip_member(ZipMember const&, Stream& output);
+
+// Extracts a single zip member below the current directory.
+ErrorOr<void> extract_zip_member(ZipMember const&);
+
+// Extracts zip members below the current directory. Directories are created first, in order. The files are then
+// decompressed and written on a pool of `thread_count` threads (one per CPU by default), largest first.
+// `on_member_extracted` is called once for every member that was attempted, one call at a time. Once a member fails,
+// no further ones are started and the first error is returned.
+ErrorOr<void> extract_zip_members(ReadonlySpan<ZipMember>, Optional<size_t> thread_count = {}, Function<void(ZipMember const&, ErrorOr<void> const&)> on_member_extracted = {});
+
+}
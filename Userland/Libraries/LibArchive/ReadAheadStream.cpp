@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibArchive/ReadAheadStream.h>
+
+namespace Archive {
+
+ErrorOr<NonnullOwnPtr<ReadAheadStream>> ReadAheadStream::create(NonnullOwnPtr<Stream> stream, size_t chunk_size, size_t chunk_count)
+{
+    VERIFY(chunk_size > 0);
+    VERIFY(chunk_count > 0);
+
+    Vector<Chunk> chunks;
+    TRY(chunks.try_ensure_capacity(chunk_count));
+    for (size_t i = 0; i < chunk_count; ++i)
+        chunks.unchecked_append({ TRY(ByteBuffer::create_uninitialized(chunk_size)) });
+
+    auto read_ahead_stream = TRY(adopt_nonnull_own_or_enomem(new (nothrow) ReadAheadStream(move(stream), move(chunks))));
+    read_ahead_stream->m_thread = TRY(Threading::Thread::try_create([stream = read_ahead_stream.ptr()] {
+        return stream->read_ahead();
+    },
+        "Read-ahead"sv));
+    read_ahead_stream->m_thread->start();
+    return read_ahead_stream;
+}
+
+ReadAheadStream::ReadAheadStream(NonnullOwnPtr<Stream> stream, Vector<Chunk> chunks)
+    : m_stream(move(stream))
+    , m_chunks(move(chunks))
+{
+}
+
+ReadAheadStream::~ReadAheadStream()
+{
+    if (!m_thread)
+        return;
+
+    {
+        Threading::MutexLocker locker(m_mutex);
+        m_should_stop = true;
+        m_chunk_drained.signal();
+    }
+    (void)m_thread->join();
+}
+
+intptr_t ReadAheadStream::read_ahead()
+{
+    while (true) {
+        Chunk* chunk;
+        {
+            Threading::MutexLocker locker(m_mutex);
+            while (m_filled_count == m_chunks.size() && !m_should_stop)
+                m_chunk_drained.wait();
+            if (m_should_stop)
+                return 0;
+            chunk = &m_chunks[m_fill_index];
+        }
+
+        // The consumer never looks at chunks that are not filled yet, so this doesn't need the lock.
+        size_t size = 0;
+        Optional<Error> error;
+        while (size < chunk->data.size() && !m_stream->is_eof()) {
+            auto result = m_stream->read_some(chunk->data.bytes().slice(size));
+            if (result.is_error()) {
+                error = result.release_error();
+                break;
+            }
+            size += result.value().size();
+        }
+        auto finished = error.has_value() || m_stream->is_eof();
+
+        Threading::MutexLocker locker(m_mutex);
+        if (size > 0) {
+            chunk->size = size;
+            m_fill_index = (m_fill_index + 1) % m_chunks.size();
+            m_filled_count++;
+        }
+        if (finished) {
+            m_finished = true;
+            m_error = move(error);
+        }
+        m_chunk_filled.signal();
+
+        if (finished)
+            return 0;
+    }
+}
+
+ErrorOr<Bytes> ReadAheadStream::read_some(Bytes bytes)
+{
+    Threading::MutexLocker locker(m_mutex);
+    while (m_filled_count == 0 && !m_finished)
+        m_chunk_filled.wait();
+
+    if (m_filled_count == 0) {
+        // Everything that was read before the error has been consumed, so report it now.
+        if (m_error.has_value())
+            return Error::copy(*m_error);
+        return bytes.trim(0);
+    }
+
+    auto& chunk = m_chunks[m_drain_index];
+    auto copied_size = chunk.data.bytes().slice(m_drain_offset, chunk.size - m_drain_offset).copy_trimmed_to(bytes);
+    m_drain_offset += copied_size;
+
+    if (m_drain_offset == chunk.size) {
+        m_drain_offset = 0;
+        m_drain_index = (m_drain_index + 1) % m_chunks.size();
+        m_filled_count--;
+        m_chunk_drained.signal();
+    }
+
+    return bytes.trim(copied_size);
+}
+
+ErrorOr<size_t> ReadAheadStream::write_some(ReadonlyBytes)
+{
+    return Error::from_errno(EBADF);
+}
+
+bool ReadAheadStream::is_eof() const
+{
+    // Whether there is more data can only be known once the reader thread got to it.
+    Threading::MutexLocker locker(m_mutex);
+    while (m_filled_count == 0 && !m_finished)
+        m_chunk_filled.wait();
+
+    return m_filled_count == 0 && !m_error.has_value();
+}
+
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Stream.h>
+#include <AK/Vector.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
+
+namespace Archive {
+
+// Reads the wrapped stream on a separate thread, up to `chunk_count` chunks ahead of the reader.
+// Wrapping a decompressor in this lets decompression run in parallel with whatever consumes the data,
+// such as unpacking a .tar.gz and writing out its files.
+class ReadAheadStream final : public Stream {
+public:
+    static constexpr size_t default_chunk_size = 1 * MiB;
+    static constexpr size_t default_chunk_count = 4;
+
+    static ErrorOr<NonnullOwnPtr<ReadAheadStream>> create(NonnullOwnPtr<Stream>, size_t chunk_size = default_chunk_size, size_t chunk_count = default_chunk_count);
+    virtual ~ReadAheadStream() override;
+
+    virtual ErrorOr<Bytes> read_some(Bytes) override;
+    virtual ErrorOr<size_t> write_some(ReadonlyBytes) override;
+    virtual bool is_eof() const override;
+    virtual bool is_open() const override { return true; }
+    virtual void close() override { }
+
+private:
+    struct Chunk {
+        ByteBuffer data;
+        size_t size { 0 };
+    };
+
+    ReadAheadStream(NonnullOwnPtr<Stream>, Vector<Chunk> chunks);
+
+    intptr_t read_ahead();
+
+    NonnullOwnPtr<Stream> m_stream;
+    RefPtr<Threading::Thread> m_thread;
+
+    // The chunks form a ring buffer. The reader thread fills them in order, starting at m_fill_index, while the
+    // consumer drains them starting at m_drain_index. m_filled_count chunks are ready to be read.
+    Vector<Chunk> m_chunks;
+    size_t m_fill_index { 0 };
+    size_t m_drain_index { 0 };
+    size_t m_drain_offset { 0 };
+    size_t m_filled_count { 0 };
+
+    // Set by the reader thread once the wrapped stream has no more data, or failed to produce it.
+    bool m_finished { false };
+    Optional<Error> m_error;
+
+    bool m_should_stop { false };
+
+    mutable Threading::Mutex m_mutex;
+    mutable Threading::ConditionVariable m_chunk_filled { m_mutex };
+    Threading::ConditionVariable m_chunk_drained { m_mutex };
+};
+
+}
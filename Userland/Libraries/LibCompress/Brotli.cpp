@@ -5,9 +5,15 @@
  */
 
 #include <AK/BinarySearch.h>
+#include <AK/BuiltinWrappers.h>
+#include <AK/ByteReader.h>
+#include <AK/IntegralMath.h>
+#include <AK/MemoryStream.h>
 #include <AK/QuickSort.h>
 #include <LibCompress/Brotli.h>
 #include <LibCompress/BrotliDictionary.h>
+#include <LibCompress/Deflate.h>
+#include <LibCompress/Huffman.h>
 
 namespace Compress {
 
@@ -943,4 +949,676 @@ bool BrotliDecompressionStream::is_eof() const
     return m_read_final_block && m_current_state == State::Idle;
 }
 
+namespace Brotli {
+
+// RFC 7932 section 5: Insert and copy lengths
+struct LengthCode {
+    u32 base;
+    u8 extra_bits;
+};
+
+static constexpr Array<LengthCode, 24> insert_length_codes { {
+    { 0, 0 }, { 1, 0 }, { 2, 0 }, { 3, 0 }, { 4, 0 }, { 5, 0 }, { 6, 1 }, { 8, 1 },
+    { 10, 2 }, { 14, 2 }, { 18, 3 }, { 26, 3 }, { 34, 4 }, { 50, 4 }, { 66, 5 }, { 98, 5 },
+    { 130, 6 }, { 194, 7 }, { 322, 8 }, { 578, 9 }, { 1090, 10 }, { 2114, 12 }, { 6210, 14 }, { 22594, 24 },
+} };
+
+static constexpr Array<LengthCode, 24> copy_length_codes { {
+    { 2, 0 }, { 3, 0 }, { 4, 0 }, { 5, 0 }, { 6, 0 }, { 7, 0 }, { 8, 0 }, { 9, 0 },
+    { 10, 1 }, { 12, 1 }, { 14, 2 }, { 18, 2 }, { 22, 3 }, { 30, 3 }, { 38, 4 }, { 54, 4 },
+    { 70, 5 }, { 102, 5 }, { 134, 6 }, { 198, 7 }, { 326, 8 }, { 582, 9 }, { 1094, 10 }, { 2118, 24 },
+} };
+
+static constexpr size_t literal_alphabet_size = 256;
+static constexpr size_t insert_and_copy_alphabet_size = 704;
+// With NPOSTFIX = 0 and NDIRECT = 0.
+static constexpr size_t distance_alphabet_size = 64;
+
+static ALWAYS_INLINE u8 highest_bit(u32 value)
+{
+    return 31 - count_leading_zeroes(value);
+}
+
+static u8 insert_length_code(u32 length)
+{
+    if (length < 6)
+        return length;
+    if (length < 130) {
+        u8 bits = highest_bit(length - 2) - 1;
+        return (bits << 1) + ((length - 2) >> bits) + 2;
+    }
+    if (length < 2114)
+        return highest_bit(length - 66) + 10;
+    if (length < 6210)
+        return 21;
+    if (length < 22594)
+        return 22;
+    return 23;
+}
+
+static u8 copy_length_code(u32 length)
+{
+    if (length < 10)
+        return length - 2;
+    if (length < 134) {
+        u8 bits = highest_bit(length - 6) - 1;
+        return (bits << 1) + ((length - 6) >> bits) + 4;
+    }
+    if (length < 2118)
+        return highest_bit(length - 70) + 12;
+    return 23;
+}
+
+// The insert-and-copy symbols are made up of cells of 8 insert codes by 8 copy codes, the first two of which imply the
+// last distance.
+static u16 insert_and_copy_symbol(u8 insert_code, u8 copy_code, bool uses_last_distance)
+{
+    static constexpr u8 cells[3][3] = { { 2, 3, 6 }, { 4, 5, 8 }, { 7, 9, 10 } };
+    u16 cell = uses_last_distance ? copy_code >> 3 : cells[insert_code >> 3][copy_code >> 3];
+    return (cell << 6) | ((insert_code & 7) << 3) | (copy_code & 7);
+}
+
+// RFC 7932 section 3: Prefix codes, from the perspective of the encoder. Codes of a single symbol use the simple
+// format and take no bits per symbol, all others are written in the complex format.
+template<size_t AlphabetSize>
+class PrefixCodeBuilder {
+public:
+    static ErrorOr<PrefixCodeBuilder> create(Array<u32, AlphabetSize> const& histogram)
+    {
+        PrefixCodeBuilder builder;
+
+        u32 max_count = 0;
+        size_t used_symbol_count = 0;
+        for (size_t symbol = 0; symbol < AlphabetSize; ++symbol) {
+            if (histogram[symbol] == 0)
+                continue;
+            ++used_symbol_count;
+            builder.m_last_symbol = symbol;
+            max_count = max(max_count, histogram[symbol]);
+        }
+        if (used_symbol_count <= 1) {
+            builder.m_is_single_symbol = true;
+            return builder;
+        }
+
+        Array<u16, AlphabetSize> frequencies {};
+        u8 const shift = max(0, static_cast<int>(highest_bit(max_count)) - 15);
+        for (size_t symbol = 0; symbol < AlphabetSize; ++symbol) {
+            if (histogram[symbol] != 0)
+                frequencies[symbol] = max(1u, histogram[symbol] >> shift);
+        }
+        generate_huffman_lengths(builder.m_lengths, frequencies, Compress::CanonicalCode::max_code_length);
+        builder.m_code = TRY(Compress::CanonicalCode::from_bytes(builder.m_lengths));
+
+        // Section 3.5: Runs of code lengths are written with the repeat codes 16 (the last non-zero length) and 17
+        // (zeros). Consecutive repeat codes of the same kind would multiply their counts, so they aren't used.
+        u8 previous_length = 8;
+        i16 previous_symbol = -1;
+        for (size_t i = 0; i <= builder.m_last_symbol;) {
+            u8 const length = builder.m_lengths[i];
+            size_t run_length = 1;
+            while (i + run_length <= builder.m_last_symbol && builder.m_lengths[i + run_length] == length)
+                ++run_length;
+
+            if (length == 0 && run_length >= 3 && previous_symbol != 17) {
+                run_length = min<size_t>(run_length, 10);
+                TRY(builder.m_code_length_symbols.try_append({ 17, static_cast<u8>(run_length - 3) }));
+                previous_symbol = 17;
+                i += run_length;
+            } else if (length != 0 && length == previous_length && run_length >= 3 && previous_symbol != 16) {
+                run_length = min<size_t>(run_length, 6);
+                TRY(builder.m_code_length_symbols.try_append({ 16, static_cast<u8>(run_length - 3) }));
+                previous_symbol = 16;
+                i += run_length;
+            } else {
+                TRY(builder.m_code_length_symbols.try_append({ length, 0 }));
+                previous_symbol = length;
+                if (length != 0)
+                    previous_length = length;
+                ++i;
+            }
+        }
+
+        Array<u16, code_length_alphabet_size> code_length_frequencies {};
+        for (auto const& code_length_symbol : builder.m_code_length_symbols)
+            ++code_length_frequencies[code_length_symbol.symbol];
+        size_t used_code_length_symbol_count = 0;
+        for (auto frequency : code_length_frequencies)
+            used_code_length_symbol_count += frequency != 0 ? 1 : 0;
+
+        if (used_code_length_symbol_count == 1) {
+            // A code of a single symbol would take no bits, so pair it with an unused symbol to make it a 1-bit code.
+            auto used_symbol = builder.m_code_length_symbols[0].symbol;
+            builder.m_code_length_code_lengths[used_symbol] = 1;
+            builder.m_code_length_code_lengths[used_symbol == 0 ? 1 : 0] = 1;
+        } else {
+            generate_huffman_lengths(builder.m_code_length_code_lengths, code_length_frequencies, 5);
+        }
+        builder.m_code_length_code = TRY(Compress::CanonicalCode::from_bytes(builder.m_code_length_code_lengths));
+
+        return builder;
+    }
+
+    size_t data_cost_in_bits(Array<u32, AlphabetSize> const& histogram) const
+    {
+        if (m_is_single_symbol)
+            return 0;
+        size_t cost = 0;
+        for (size_t symbol = 0; symbol < AlphabetSize; ++symbol)
+            cost += histogram[symbol] * m_lengths[symbol];
+        return cost;
+    }
+
+    size_t code_cost_in_bits() const
+    {
+        if (m_is_single_symbol)
+            return 4 + alphabet_bits;
+
+        size_t cost = 2;
+        size_t const skip = number_of_skipped_code_length_code_lengths();
+        size_t sum = 0;
+        for (size_t i = skip; i < code_length_alphabet_size && sum < 32; ++i) {
+            auto length = m_code_length_code_lengths[code_length_code_order[i]];
+            cost += static_code_length_code[length].bit_count;
+            if (length != 0)
+                sum += 32 >> length;
+        }
+        for (auto const& code_length_symbol : m_code_length_symbols)
+            cost += m_code_length_code_lengths[code_length_symbol.symbol] + repeat_extra_bits(code_length_symbol.symbol);
+        return cost;
+    }
+
+    ErrorOr<void> write_code(LittleEndianOutputBitStream& stream) const
+    {
+        // Section 3.4: Simple prefix codes
+        if (m_is_single_symbol) {
+            TRY(stream.write_bits(1u, 2));                          // HSKIP = 1
+            TRY(stream.write_bits(0u, 2));                          // NSYM - 1 = 0
+            TRY(stream.write_bits(m_last_symbol, alphabet_bits)); // The symbol
+            return {};
+        }
+
+        // Section 3.5: Complex prefix codes
+        size_t const skip = number_of_skipped_code_length_code_lengths();
+        TRY(stream.write_bits(skip, 2));
+        size_t sum = 0;
+        for (size_t i = skip; i < code_length_alphabet_size && sum < 32; ++i) {
+            auto length = m_code_length_code_lengths[code_length_code_order[i]];
+            TRY(stream.write_bits(static_code_length_code[length].bits, static_code_length_code[length].bit_count));
+            if (length != 0)
+                sum += 32 >> length;
+        }
+
+        for (auto const& code_length_symbol : m_code_length_symbols) {
+            TRY(m_code_length_code.write_symbol(stream, code_length_symbol.symbol));
+            TRY(stream.write_bits(code_length_symbol.repeat_extra, repeat_extra_bits(code_length_symbol.symbol)));
+        }
+        return {};
+    }
+
+    ALWAYS_INLINE ErrorOr<void> write_symbol(LittleEndianOutputBitStream& stream, u16 symbol) const
+    {
+        if (m_is_single_symbol)
+            return {};
+        return m_code.write_symbol(stream, symbol);
+    }
+
+private:
+    static constexpr size_t code_length_alphabet_size = 18;
+    static constexpr Array<u8, code_length_alphabet_size> code_length_code_order { 1, 2, 3, 4, 0, 5, 17, 6, 16, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+    static constexpr size_t alphabet_bits = AK::ceil_log2(AlphabetSize);
+
+    // The lengths of the code length code are written with this fixed code.
+    struct StaticCode {
+        u8 bits;
+        u8 bit_count;
+    };
+    static constexpr Array<StaticCode, 6> static_code_length_code { { { 0, 2 }, { 7, 4 }, { 3, 3 }, { 2, 2 }, { 1, 2 }, { 15, 4 } } };
+
+    struct CodeLengthSymbol {
+        u8 symbol;
+        u8 repeat_extra;
+    };
+
+    static u8 repeat_extra_bits(u8 symbol) { return symbol == 16 ? 2 : symbol == 17 ? 3 : 0; }
+
+    // HSKIP allows leaving out the first two or three code length code lengths if they are zero.
+    size_t number_of_skipped_code_length_code_lengths() const
+    {
+        if (m_code_length_code_lengths[code_length_code_order[0]] != 0 || m_code_length_code_lengths[code_length_code_order[1]] != 0)
+            return 0;
+        return m_code_length_code_lengths[code_length_code_order[2]] == 0 ? 3 : 2;
+    }
+
+    bool m_is_single_symbol { false };
+    size_t m_last_symbol { 0 };
+    Array<u8, AlphabetSize> m_lengths {};
+    Compress::CanonicalCode m_code;
+
+    Vector<CodeLengthSymbol> m_code_length_symbols;
+    Array<u8, code_length_alphabet_size> m_code_length_code_lengths {};
+    Compress::CanonicalCode m_code_length_code;
+};
+
+}
+
+BrotliCompressor::Parameters BrotliCompressor::parameters_for_quality(u8 quality)
+{
+    // Low qualities use a small window and a greedy matcher with short hash chains, high qualities search longer chains
+    // in a larger window, and defer matches when the next position has a better one.
+    static constexpr Array<Parameters, maximum_quality + 1> parameters { {
+        { 18, 14, 1, 16, false },
+        { 18, 15, 2, 32, false },
+        { 18, 15, 4, 32, false },
+        { 18, 16, 8, 64, false },
+        { 20, 16, 8, 64, true },
+        { 20, 16, 16, 128, true },
+        { 20, 16, 32, 128, true },
+        { 20, 17, 64, 256, true },
+        { 20, 17, 128, 256, true },
+        { 22, 17, 256, 512, true },
+        { 22, 17, 1024, 1024, true },
+        { 22, 17, 4096, 2048, true },
+    } };
+    return parameters[min(quality, maximum_quality)];
+}
+
+ErrorOr<NonnullOwnPtr<BrotliCompressor>> BrotliCompressor::create(MaybeOwned<Stream> stream, u8 quality, Optional<u8> window_bits)
+{
+    auto parameters = parameters_for_quality(quality);
+    if (window_bits.has_value()) {
+        if (window_bits.value() < 10 || window_bits.value() > 24)
+            return Error::from_string_literal("Invalid Brotli window size");
+        parameters.window_bits = window_bits.value();
+    }
+
+    size_t const window_size = 1u << parameters.window_bits;
+    auto buffer = TRY(ByteBuffer::create_uninitialized(2 * window_size + meta_block_size));
+    Vector<u32> hash_heads;
+    TRY(hash_heads.try_resize(1u << parameters.hash_bits));
+    Vector<u32> hash_chain;
+    TRY(hash_chain.try_resize(window_size));
+    auto output_stream = TRY(try_make<LittleEndianOutputBitStream>(move(stream)));
+    auto compressor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) BrotliCompressor(move(output_stream), parameters, move(buffer), move(hash_heads), move(hash_chain))));
+
+    // RFC 7932 section 9.1: WBITS
+    auto& output = *compressor->m_output_stream;
+    u8 const bits = parameters.window_bits;
+    if (bits == 16) {
+        TRY(output.write_bits(0u, 1));
+    } else if (bits == 17) {
+        TRY(output.write_bits(1u, 1));
+        TRY(output.write_bits(0u, 3));
+        TRY(output.write_bits(0u, 3));
+    } else if (bits > 17) {
+        TRY(output.write_bits(1u, 1));
+        TRY(output.write_bits(bits - 17u, 3));
+    } else {
+        TRY(output.write_bits(1u, 1));
+        TRY(output.write_bits(0u, 3));
+        TRY(output.write_bits(bits - 8u, 3));
+    }
+
+    return compressor;
+}
+
+BrotliCompressor::BrotliCompressor(NonnullOwnPtr<LittleEndianOutputBitStream> stream, Parameters parameters, ByteBuffer buffer, Vector<u32> hash_heads, Vector<u32> hash_chain)
+    : m_parameters(parameters)
+    , m_output_stream(move(stream))
+    , m_buffer(move(buffer))
+    , m_window_size(1u << parameters.window_bits)
+    , m_max_distance(m_window_size - 16)
+    , m_hash_heads(move(hash_heads))
+    , m_hash_chain(move(hash_chain))
+{
+}
+
+BrotliCompressor::~BrotliCompressor()
+{
+    if (!m_finished) {
+        // Note: We need a better API for specifying things like this.
+        finish().release_value_but_fixme_should_propagate_errors();
+    }
+}
+
+ErrorOr<ByteBuffer> BrotliCompressor::compress_all(ReadonlyBytes bytes, u8 quality)
+{
+    // There is no point in a window that is larger than the data.
+    u8 window_bits = parameters_for_quality(quality).window_bits;
+    while (window_bits > 10 && (1u << (window_bits - 1)) - 16 >= bytes.size())
+        --window_bits;
+
+    auto output_stream = TRY(try_make<AllocatingMemoryStream>());
+    auto compressor = TRY(BrotliCompressor::create(MaybeOwned<Stream> { *output_stream }, quality, window_bits));
+    TRY(compressor->write_until_depleted(bytes));
+    TRY(compressor->finish());
+    return output_stream->read_until_eof();
+}
+
+ErrorOr<Bytes> BrotliCompressor::read_some(Bytes)
+{
+    return Error::from_errno(EBADF);
+}
+
+ErrorOr<size_t> BrotliCompressor::write_some(ReadonlyBytes bytes)
+{
+    if (m_finished)
+        return Error::from_string_literal("Tried to write to a finished Brotli stream");
+
+    for (auto remaining = bytes; !remaining.is_empty();) {
+        auto size = min(remaining.size(), m_block_start + meta_block_size - m_buffered_size);
+        remaining.trim(size).copy_to(m_buffer.bytes().slice(m_buffered_size));
+        m_buffered_size += size;
+        remaining = remaining.slice(size);
+        if (m_buffered_size == m_block_start + meta_block_size)
+            TRY(compress_meta_block());
+    }
+    return bytes.size();
+}
+
+ErrorOr<void> BrotliCompressor::finish()
+{
+    if (m_finished)
+        return Error::from_string_literal("Finished a Brotli stream twice");
+    m_finished = true;
+
+    TRY(compress_meta_block());
+
+    // RFC 7932 section 9.2: The stream ends with an empty last meta-block.
+    TRY(m_output_stream->write_bits(1u, 1)); // ISLAST
+    TRY(m_output_stream->write_bits(1u, 1)); // ISLASTEMPTY
+    TRY(m_output_stream->align_to_byte_boundary());
+    TRY(m_output_stream->flush_buffer_to_stream());
+    return {};
+}
+
+ErrorOr<void> BrotliCompressor::write_meta_block_header(size_t size, bool is_uncompressed)
+{
+    // RFC 7932 section 9.2: Meta-block header
+    VERIFY(size > 0 && size <= 1 << 24);
+    size_t const nibbles = size - 1 < (1 << 16) ? 4 : size - 1 < (1 << 20) ? 5 : 6;
+    TRY(m_output_stream->write_bits(0u, 1));            // ISLAST
+    TRY(m_output_stream->write_bits(nibbles - 4, 2));   // MNIBBLES
+    TRY(m_output_stream->write_bits(size - 1, nibbles * 4)); // MLEN - 1
+    TRY(m_output_stream->write_bits(is_uncompressed ? 1u : 0u, 1)); // ISUNCOMPRESSED
+    return {};
+}
+
+ErrorOr<void> BrotliCompressor::compress_meta_block()
+{
+    size_t const size = m_buffered_size - m_block_start;
+    if (size == 0)
+        return {};
+
+    auto const previous_distances = m_distances;
+    m_commands.clear_with_capacity();
+    m_literals.clear();
+    find_commands(m_block_start, m_buffered_size);
+
+    Array<u32, Brotli::literal_alphabet_size> literal_histogram {};
+    Array<u32, Brotli::insert_and_copy_alphabet_size> insert_and_copy_histogram {};
+    Array<u32, Brotli::distance_alphabet_size> distance_histogram {};
+    size_t extra_bit_count = 0;
+    for (auto literal : m_literals.bytes())
+        ++literal_histogram[literal];
+    for (auto const& command : m_commands) {
+        ++insert_and_copy_histogram[command.insert_and_copy_symbol];
+        extra_bit_count += Brotli::insert_length_codes[Brotli::insert_length_code(command.insert_length)].extra_bits;
+        extra_bit_count += Brotli::copy_length_codes[Brotli::copy_length_code(command.copy_length)].extra_bits;
+        if (command.has_distance_symbol) {
+            ++distance_histogram[command.distance_symbol];
+            extra_bit_count += command.distance_extra_bit_count;
+        }
+    }
+
+    auto literal_code = TRY(Brotli::PrefixCodeBuilder<Brotli::literal_alphabet_size>::create(literal_histogram));
+    auto insert_and_copy_code = TRY(Brotli::PrefixCodeBuilder<Brotli::insert_and_copy_alphabet_size>::create(insert_and_copy_histogram));
+    auto distance_code = TRY(Brotli::PrefixCodeBuilder<Brotli::distance_alphabet_size>::create(distance_histogram));
+
+    size_t const compressed_bit_count = literal_code.code_cost_in_bits() + literal_code.data_cost_in_bits(literal_histogram)
+        + insert_and_copy_code.code_cost_in_bits() + insert_and_copy_code.data_cost_in_bits(insert_and_copy_histogram)
+        + distance_code.code_cost_in_bits() + distance_code.data_cost_in_bits(distance_histogram)
+        + extra_bit_count + 16;
+
+    auto const data = m_buffer.bytes().slice(m_block_start, size);
+    if (compressed_bit_count / 8 >= size) {
+        // Data that doesn't compress is stored as it is, which leaves the last distances untouched.
+        m_distances = previous_distances;
+        TRY(write_meta_block_header(size, true));
+        TRY(m_output_stream->align_to_byte_boundary());
+        TRY(m_output_stream->write_until_depleted(data));
+    } else {
+        TRY(write_meta_block_header(size, false));
+        TRY(m_output_stream->write_bits(0u, 1));  // NBLTYPESL = 1
+        TRY(m_output_stream->write_bits(0u, 1));  // NBLTYPESI = 1
+        TRY(m_output_stream->write_bits(0u, 1));  // NBLTYPESD = 1
+        TRY(m_output_stream->write_bits(0u, 2));  // NPOSTFIX = 0
+        TRY(m_output_stream->write_bits(0u, 4));  // NDIRECT = 0
+        TRY(m_output_stream->write_bits(0u, 2));  // CMODE = LSB6, which is irrelevant with a single literal code
+        TRY(m_output_stream->write_bits(0u, 1));  // NTREESL = 1
+        TRY(m_output_stream->write_bits(0u, 1));  // NTREESD = 1
+        TRY(literal_code.write_code(*m_output_stream));
+        TRY(insert_and_copy_code.write_code(*m_output_stream));
+        TRY(distance_code.write_code(*m_output_stream));
+
+        // Section 9.3: Meta-block data
+        size_t literal_offset = 0;
+        for (auto const& command : m_commands) {
+            TRY(insert_and_copy_code.write_symbol(*m_output_stream, command.insert_and_copy_symbol));
+            auto const& insert_length_code = Brotli::insert_length_codes[Brotli::insert_length_code(command.insert_length)];
+            TRY(m_output_stream->write_bits(command.insert_length - insert_length_code.base, insert_length_code.extra_bits));
+            auto const& copy_length_code = Brotli::copy_length_codes[Brotli::copy_length_code(command.copy_length)];
+            TRY(m_output_stream->write_bits(command.copy_length - copy_length_code.base, copy_length_code.extra_bits));
+
+            for (size_t i = 0; i < command.insert_length; ++i)
+                TRY(literal_code.write_symbol(*m_output_stream, m_literals[literal_offset + i]));
+            literal_offset += command.insert_length;
+
+            if (command.has_distance_symbol) {
+                TRY(distance_code.write_symbol(*m_output_stream, command.distance_symbol));
+                TRY(m_output_stream->write_bits(command.distance_extra_bits, command.distance_extra_bit_count));
+            }
+        }
+    }
+
+    m_block_start = m_buffered_size;
+
+    // Keep at least a window of history, and make room for the next meta-block. The history is moved by a multiple of
+    // the window size, so that the hash chain, which is indexed by position modulo the window size, stays valid.
+    if (m_buffered_size + meta_block_size > m_buffer.size()) {
+        size_t const shift = (m_block_start - m_window_size) & ~(m_window_size - 1);
+        memmove(m_buffer.data(), m_buffer.data() + shift, m_buffered_size - shift);
+        m_buffered_size -= shift;
+        m_block_start -= shift;
+        for (auto& position : m_hash_heads)
+            position = position >= shift ? position - shift : 0;
+        for (auto& position : m_hash_chain)
+            position = position >= shift ? position - shift : 0;
+    }
+    return {};
+}
+
+void BrotliCompressor::add_command(size_t insert_length, size_t copy_length, size_t distance)
+{
+    Command command;
+    command.insert_length = insert_length;
+    command.copy_length = copy_length;
+    u8 const insert_code = Brotli::insert_length_code(insert_length);
+    u8 const copy_code = Brotli::copy_length_code(copy_length);
+
+    // RFC 7932 section 4: Distance codes 0 to 3 refer to the last distances, and all but code 0 push their distance
+    // onto them like new distances do.
+    if (distance == m_distances[0]) {
+        bool const uses_implicit_distance = insert_code < 8 && copy_code < 16;
+        command.insert_and_copy_symbol = Brotli::insert_and_copy_symbol(insert_code, copy_code, uses_implicit_distance);
+        command.has_distance_symbol = !uses_implicit_distance;
+        command.distance_symbol = 0;
+        m_commands.append(command);
+        return;
+    }
+
+    command.insert_and_copy_symbol = Brotli::insert_and_copy_symbol(insert_code, copy_code, false);
+    command.has_distance_symbol = true;
+    if (distance == m_distances[1]) {
+        command.distance_symbol = 1;
+    } else if (distance == m_distances[2]) {
+        command.distance_symbol = 2;
+    } else if (distance == m_distances[3]) {
+        command.distance_symbol = 3;
+    } else {
+        // With NPOSTFIX = 0 and NDIRECT = 0, the distance is split into its highest bit below the top one and the
+        // remaining extra bits.
+        u32 const value = distance + 3;
+        u8 const extra_bit_count = Brotli::highest_bit(value) - 1;
+        command.distance_symbol = 16 + 2 * (extra_bit_count - 1) + ((value >> extra_bit_count) & 1);
+        command.distance_extra_bit_count = extra_bit_count;
+        command.distance_extra_bits = value & ((1u << extra_bit_count) - 1);
+    }
+    m_distances = { static_cast<u32>(distance), m_distances[0], m_distances[1], m_distances[2] };
+    m_commands.append(command);
+}
+
+void BrotliCompressor::add_last_command(size_t insert_length)
+{
+    // The meta-block ends after the literals of its last command, so its copy length and distance are never used.
+    Command command;
+    command.insert_length = insert_length;
+    command.copy_length = Brotli::copy_length_codes[0].base;
+    u8 const insert_code = Brotli::insert_length_code(insert_length);
+    command.insert_and_copy_symbol = Brotli::insert_and_copy_symbol(insert_code, 0, insert_code < 8);
+    m_commands.append(command);
+}
+
+void BrotliCompressor::find_commands(size_t start, size_t end)
+{
+    u8 const* const data = m_buffer.data();
+    size_t const window_mask = m_window_size - 1;
+    u32 const hash_shift = 32 - m_parameters.hash_bits;
+
+    auto load32 = [&](size_t position) {
+        u32 value;
+        ByteReader::load(data + position, value);
+        return value;
+    };
+    auto hash = [&](size_t position) {
+        return (load32(position) * 0x1E35A7BDu) >> hash_shift;
+    };
+    auto insert = [&](size_t position) {
+        auto& head = m_hash_heads[hash(position)];
+        m_hash_chain[position & window_mask] = head;
+        head = position;
+    };
+    auto match_length = [&](size_t position, size_t candidate, size_t max_length) {
+        size_t length = 0;
+        while (length + sizeof(u64) <= max_length) {
+            u64 a;
+            u64 b;
+            ByteReader::load(data + position + length, a);
+            ByteReader::load(data + candidate + length, b);
+            if (auto difference = a ^ b; difference != 0)
+                return length + (AK::HostIsLittleEndian ? count_trailing_zeroes(difference) : count_leading_zeroes(difference)) / 8;
+            length += sizeof(u64);
+        }
+        while (length < max_length && data[position + length] == data[candidate + length])
+            ++length;
+        return length;
+    };
+
+    // Matches are scored like in the reference encoder: each byte that doesn't have to be written as a literal is worth
+    // about the same, distances cost about their number of bits, and the last distances are almost free.
+    struct Match {
+        size_t length { 0 };
+        size_t distance { 0 };
+        i32 score { 0 };
+    };
+    auto find_match = [&](size_t position) {
+        Match best;
+        size_t const max_length = end - position;
+        for (size_t i = 0; i < m_distances.size(); ++i) {
+            size_t const distance = m_distances[i];
+            if (distance > position || distance > m_max_distance)
+                continue;
+            size_t const length = match_length(position, position - distance, max_length);
+            if (length < (i == 0 ? 2u : 3u))
+                continue;
+            i32 const score = 135 * length + (i == 0 ? 15 : -30);
+            if (score > best.score)
+                best = { length, distance, score };
+        }
+
+        size_t candidate = m_hash_heads[hash(position)];
+        for (size_t depth = m_parameters.max_chain_length; depth > 0 && best.length < m_parameters.nice_match_length; --depth) {
+            if (candidate >= position || position - candidate > m_max_distance)
+                break;
+            if (best.length < max_length && data[candidate + best.length] == data[position + best.length]) {
+                size_t const length = match_length(position, candidate, max_length);
+                size_t const distance = position - candidate;
+                i32 const score = 135 * length - 30 * Brotli::highest_bit(distance);
+                if (length >= min_match_length && score > best.score && score > 0)
+                    best = { length, distance, score };
+            }
+            size_t const next = m_hash_chain[candidate & window_mask];
+            if (next >= candidate)
+                break;
+            candidate = next;
+        }
+        return best;
+    };
+
+    size_t position = start;
+    size_t anchor = start;
+    while (position + min_match_length <= end) {
+        auto match = find_match(position);
+        insert(position);
+        if (match.length == 0) {
+            // The greedy matcher skips ahead faster the longer no match was found, to get through incompressible data.
+            position += m_parameters.lazy_matching ? 1 : 1 + ((position - anchor) >> 6);
+            continue;
+        }
+
+        if (m_parameters.lazy_matching) {
+            while (match.length < m_parameters.nice_match_length && position + 1 + min_match_length <= end) {
+                auto next_match = find_match(position + 1);
+                if (next_match.score < match.score + 175)
+                    break;
+                ++position;
+                insert(position);
+                match = next_match;
+            }
+        }
+
+        m_literals.append(data + anchor, position - anchor);
+        add_command(position - anchor, match.length, match.distance);
+
+        size_t const match_end = position + match.length;
+        for (++position; position < match_end && position + min_match_length <= end; ++position)
+            insert(position);
+        position = match_end;
+        anchor = match_end;
+    }
+
+    if (anchor < end) {
+        m_literals.append(data + anchor, end - anchor);
+        add_last_command(end - anchor);
+    }
+}
+
+bool BrotliCompressor::is_eof() const
+{
+    return true;
+}
+
+bool BrotliCompressor::is_open() const
+{
+    return !m_finished;
+}
+
+void BrotliCompressor::close()
+{
+    if (!m_finished) {
+        // Note: We need a better API for specifying things like this.
+        finish().release_value_but_fixme_should_propagate_errors();
+    }
+}
+
 }
@@ -7,8 +7,12 @@
 #pragma once
 
 #include <AK/BitStream.h>
+#include <AK/ByteBuffer.h>
 #include <AK/CircularQueue.h>
 #include <AK/FixedArray.h>
+#include <AK/MaybeOwned.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
 #include <AK/Vector.h>
 
 namespace Compress {
@@ -162,4 +166,79 @@ private:
     Vector<CanonicalCode> m_distance_codes;
 };
 
+// Compresses data into a Brotli stream with a single prefix code per alphabet and meta-block. Quality levels range from
+// a greedy matcher with short hash chains to lazy matching with long chains and a larger window, like the levels of the
+// reference encoder. The static dictionary and context modeling aren't used.
+class BrotliCompressor final : public Stream {
+public:
+    static constexpr u8 maximum_quality = 11;
+    static constexpr u8 default_quality = 5;
+    static constexpr size_t meta_block_size = 256 * KiB;
+    static constexpr size_t min_match_length = 4;
+
+    // Defaults to the window size of the quality level. Smaller windows let decoders allocate less memory for small data.
+    static ErrorOr<NonnullOwnPtr<BrotliCompressor>> create(MaybeOwned<Stream>, u8 quality = default_quality, Optional<u8> window_bits = {});
+    ~BrotliCompressor();
+
+    static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes, u8 quality = default_quality);
+
+    // Compresses the remaining data and ends the stream.
+    ErrorOr<void> finish();
+
+    virtual ErrorOr<Bytes> read_some(Bytes) override;
+    virtual ErrorOr<size_t> write_some(ReadonlyBytes) override;
+    virtual bool is_eof() const override;
+    virtual bool is_open() const override;
+    virtual void close() override;
+
+private:
+    struct Parameters {
+        u8 window_bits;
+        u8 hash_bits;
+        u16 max_chain_length;
+        u16 nice_match_length; // Matches of at least this length end the search.
+        bool lazy_matching;
+    };
+
+    struct Command {
+        u32 insert_length { 0 };
+        u32 copy_length { 0 };
+        u16 insert_and_copy_symbol { 0 };
+        u8 distance_symbol { 0 };
+        bool has_distance_symbol { false };
+        u8 distance_extra_bit_count { 0 };
+        u32 distance_extra_bits { 0 };
+    };
+
+    BrotliCompressor(NonnullOwnPtr<LittleEndianOutputBitStream>, Parameters, ByteBuffer buffer, Vector<u32> hash_heads, Vector<u32> hash_chain);
+
+    static Parameters parameters_for_quality(u8 quality);
+
+    ErrorOr<void> compress_meta_block();
+    void find_commands(size_t start, size_t end);
+    void add_command(size_t insert_length, size_t copy_length, size_t distance);
+    void add_last_command(size_t insert_length);
+    ErrorOr<void> write_meta_block_header(size_t size, bool is_uncompressed);
+
+    Parameters m_parameters;
+    NonnullOwnPtr<LittleEndianOutputBitStream> m_output_stream;
+    bool m_finished { false };
+
+    // Holds (up to) a window of history, followed by the data of the next meta-block.
+    ByteBuffer m_buffer;
+    size_t m_buffered_size { 0 };
+    size_t m_block_start { 0 };
+    size_t m_window_size { 0 };
+    size_t m_max_distance { 0 };
+
+    // Hash chains of positions in m_buffer, with one link per position in the window.
+    Vector<u32> m_hash_heads;
+    Vector<u32> m_hash_chain;
+
+    // The last four distances, which are cheaper to refer to.
+    Array<u32, 4> m_distances { 4, 11, 15, 16 };
+    Vector<Command> m_commands;
+    ByteBuffer m_literals;
+};
+
 }
@@ -7,12 +7,15 @@
 
 #include <AK/Array.h>
 #include <AK/Assertions.h>
-#include <AK/BinarySearch.h>
+#include <AK/Atomic.h>
 #include <AK/MemoryStream.h>
+#include <AK/ScopeGuard.h>
 #include <string.h>
 
 #include <LibCompress/Deflate.h>
 #include <LibCompress/Huffman.h>
+#include <LibCore/System.h>
+#include <LibThreading/Thread.h>
 
 namespace Compress {
 
@@ -64,9 +67,11 @@ ErrorOr<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
     }
 
     if (non_zero_symbols == 1) { // special case - only 1 symbol
-        code.m_prefix_table[0] = PrefixTableEntry { static_cast<u16>(last_non_zero), 1u };
-        code.m_prefix_table[1] = code.m_prefix_table[0];
-        code.m_max_prefixed_code_length = 1;
+        TRY(code.m_decoding_table.try_resize(2));
+        code.m_decoding_table[0] = DecodingTableEntry { static_cast<u16>(last_non_zero), 1, 0 };
+        code.m_decoding_table[1] = code.m_decoding_table[0];
+        code.m_primary_table_bits = 1;
+        code.m_max_code_length = 1;
 
         if (code.m_bit_codes.size() < static_cast<size_t>(last_non_zero + 1)) {
             TRY(code.m_bit_codes.try_resize(last_non_zero + 1));
@@ -78,16 +83,8 @@ ErrorOr<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         return code;
     }
 
-    struct PrefixCode {
-        u16 symbol_code { 0 };
-        u16 symbol_value { 0 };
-        u16 code_length { 0 };
-    };
-    Array<PrefixCode, 1 << CanonicalCode::max_allowed_prefixed_code_length> prefix_codes;
-    size_t number_of_prefix_codes = 0;
-
     auto next_code = 0;
-    for (size_t code_length = 1; code_length <= 15; ++code_length) {
+    for (size_t code_length = 1; code_length <= max_code_length; ++code_length) {
         next_code <<= 1;
         auto start_bit = 1 << code_length;
 
@@ -98,45 +95,67 @@ ErrorOr<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
             if (next_code > start_bit)
                 return Error::from_string_literal("Failed to decode code lengths");
 
-            if (code_length <= CanonicalCode::max_allowed_prefixed_code_length) {
-                if (number_of_prefix_codes >= prefix_codes.size())
-                    return Error::from_string_literal("Invalid canonical Huffman code");
-
-                auto& prefix_code = prefix_codes[number_of_prefix_codes++];
-                prefix_code.symbol_code = next_code;
-                prefix_code.symbol_value = symbol;
-                prefix_code.code_length = code_length;
-
-                code.m_max_prefixed_code_length = code_length;
-            } else {
-                code.m_symbol_codes.append(start_bit | next_code);
-                code.m_symbol_values.append(symbol);
-            }
-
             if (code.m_bit_codes.size() < symbol + 1) {
                 TRY(code.m_bit_codes.try_resize(symbol + 1));
                 TRY(code.m_bit_code_lengths.try_resize(symbol + 1));
             }
             code.m_bit_codes[symbol] = fast_reverse16(start_bit | next_code, code_length); // DEFLATE writes huffman encoded symbols as lsb-first
             code.m_bit_code_lengths[symbol] = code_length;
+            code.m_max_code_length = code_length;
 
             next_code++;
         }
     }
 
-    if (next_code != (1 << 15))
+    if (next_code != (1 << max_code_length))
         return Error::from_string_literal("Failed to decode code lengths");
 
-    for (auto [symbol_code, symbol_value, code_length] : prefix_codes) {
-        if (code_length == 0 || code_length > CanonicalCode::max_allowed_prefixed_code_length)
-            break;
+    // The bit codes are in the order they are read, so they are the indices of the decoding table entries for their
+    // symbols. Shorter codes fill every entry whose index starts with them.
+    code.m_primary_table_bits = min(code.m_max_code_length, max_primary_table_bits);
+    size_t const primary_table_size = 1u << code.m_primary_table_bits;
+    u16 const primary_table_mask = primary_table_size - 1;
+
+    // Size each secondary table for the longest code that starts with its index into the primary table.
+    Array<u8, 1 << max_primary_table_bits> secondary_table_bits {};
+    for (size_t symbol = 0; symbol < code.m_bit_code_lengths.size(); ++symbol) {
+        auto code_length = code.m_bit_code_lengths[symbol];
+        if (code_length > code.m_primary_table_bits) {
+            auto& bits = secondary_table_bits[code.m_bit_codes[symbol] & primary_table_mask];
+            bits = max<u8>(bits, code_length - code.m_primary_table_bits);
+        }
+    }
+
+    size_t table_size = primary_table_size;
+    for (size_t i = 0; i < primary_table_size; ++i) {
+        if (secondary_table_bits[i] != 0)
+            table_size += 1u << secondary_table_bits[i];
+    }
+    TRY(code.m_decoding_table.try_resize(table_size));
 
-        auto shift = code.m_max_prefixed_code_length - code_length;
-        symbol_code <<= shift;
+    size_t secondary_table_index = primary_table_size;
+    for (size_t i = 0; i < primary_table_size; ++i) {
+        if (secondary_table_bits[i] == 0)
+            continue;
+        code.m_decoding_table[i] = DecodingTableEntry { static_cast<u16>(secondary_table_index), 0, secondary_table_bits[i] };
+        secondary_table_index += 1u << secondary_table_bits[i];
+    }
+
+    for (size_t symbol = 0; symbol < code.m_bit_code_lengths.size(); ++symbol) {
+        u8 code_length = code.m_bit_code_lengths[symbol];
+        if (code_length == 0)
+            continue;
 
-        for (size_t j = 0; j < (1u << shift); ++j) {
-            auto index = fast_reverse16(symbol_code + j, code.m_max_prefixed_code_length);
-            code.m_prefix_table[index] = PrefixTableEntry { symbol_value, code_length };
+        auto bit_code = code.m_bit_codes[symbol];
+        DecodingTableEntry const entry { static_cast<u16>(symbol), code_length, 0 };
+        if (code_length <= code.m_primary_table_bits) {
+            for (size_t index = bit_code; index < primary_table_size; index += 1u << code_length)
+                code.m_decoding_table[index] = entry;
+        } else {
+            auto const& link = code.m_decoding_table[bit_code & primary_table_mask];
+            auto remaining_length = code_length - code.m_primary_table_bits;
+            for (size_t index = bit_code >> code.m_primary_table_bits; index < (1u << link.secondary_table_bits); index += 1u << remaining_length)
+                code.m_decoding_table[link.value + index] = entry;
         }
     }
 
@@ -145,26 +164,47 @@ ErrorOr<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
 
 ErrorOr<u32> CanonicalCode::read_symbol(LittleEndianInputBitStream& stream) const
 {
-    auto prefix = TRY(stream.peek_bits<size_t>(m_max_prefixed_code_length));
-
-    if (auto [symbol_value, code_length] = m_prefix_table[prefix]; code_length != 0) {
-        stream.discard_previously_peeked_bits(code_length);
-        return symbol_value;
-    }
-
-    auto code_bits = TRY(stream.read_bits<u16>(m_max_prefixed_code_length));
-    code_bits = fast_reverse16(code_bits, m_max_prefixed_code_length);
-    code_bits |= 1 << m_max_prefixed_code_length;
-
-    for (size_t i = m_max_prefixed_code_length; i < 16; ++i) {
-        size_t index;
-        if (binary_search(m_symbol_codes.span(), code_bits, &index))
-            return m_symbol_values[index];
+    // Near the end of the input, fewer bits than the longest code needs might be left.
+    size_t available_bits = m_max_code_length;
+    auto bits_or_error = stream.peek_bits<u64>(available_bits);
+    while (bits_or_error.is_error() && available_bits > 1)
+        bits_or_error = stream.peek_bits<u64>(--available_bits);
+    auto bits = TRY(bits_or_error);
+
+    auto [symbol, code_length] = decode_symbol(bits);
+    if (code_length == 0 || code_length > available_bits)
+        return Error::from_string_literal("Symbol exceeds maximum symbol number");
+
+    stream.discard_previously_peeked_bits(code_length);
+    return symbol;
+}
 
-        code_bits = code_bits << 1 | TRY(stream.read_bit());
+// Copies a back reference that starts `distance` bytes before `output`, where the source and destination may overlap.
+// May write up to DeflateDecompressor::copy_overrun bytes past the end of the copy.
+ALWAYS_INLINE static void copy_back_reference(u8* output, size_t distance, size_t length)
+{
+    u8 const* source = output - distance;
+    u8* const end = output + length;
+
+    if (distance >= 16) {
+        // The 16 bytes that are read have all been written before.
+        do {
+            __builtin_memcpy(output, source, 16);
+            output += 16;
+            source += 16;
+        } while (output < end);
+    } else if (distance >= 8) {
+        do {
+            __builtin_memcpy(output, source, 8);
+            output += 8;
+            source += 8;
+        } while (output < end);
+    } else if (distance == 1) {
+        __builtin_memset(output, *source, length);
+    } else {
+        while (output < end)
+            *output++ = *source++;
     }
-
-    return Error::from_string_literal("Symbol exceeds maximum symbol number");
 }
 
 DeflateDecompressor::CompressedBlock::CompressedBlock(DeflateDecompressor& decompressor, CanonicalCode literal_codes, Optional<CanonicalCode> distance_codes)
@@ -174,41 +214,165 @@ DeflateDecompressor::CompressedBlock::CompressedBlock(DeflateDecompressor& decom
 {
 }
 
-ErrorOr<bool> DeflateDecompressor::CompressedBlock::try_read_more()
+ErrorOr<bool> DeflateDecompressor::CompressedBlock::decode(Bytes output, size_t& output_size, ReadonlyBytes history)
 {
-    if (m_eof == true)
+    if (m_eof)
         return false;
 
-    auto const symbol = TRY(m_literal_codes.read_symbol(*m_decompressor.m_input_stream));
-
-    if (symbol >= 286)
-        return Error::from_string_literal("Invalid deflate literal/length symbol");
+    u8 const* const output_start = output.data();
+    u8 const* const output_end = output.data() + output.size();
+    u8* output_pointer = output.data() + output_size;
+    ScopeGuard update_output_size = [&] { output_size = output_pointer - output_start; };
+
+    auto copy_match = [&](size_t length, size_t distance) -> ErrorOr<void> {
+        size_t const decoded_size = output_pointer - output_start;
+        if (distance > decoded_size) [[unlikely]] {
+            // The back reference starts in the history.
+            auto const history_distance = distance - decoded_size;
+            if (history_distance > history.size())
+                return Error::from_string_literal("Back reference distance exceeds the decoded data");
+            auto const history_length = min(length, history_distance);
+            __builtin_memcpy(output_pointer, history.data() + history.size() - history_distance, history_length);
+            output_pointer += history_length;
+            length -= history_length;
+            if (length == 0)
+                return {};
+        }
+        copy_back_reference(output_pointer, distance, length);
+        output_pointer += length;
+        return {};
+    };
 
-    if (symbol < EndOfBlock) {
-        u8 byte_symbol = symbol;
-        m_decompressor.m_output_buffer.write({ &byte_symbol, sizeof(byte_symbol) });
+    auto& stream = *m_decompressor.m_input_stream;
+    CanonicalCode const* distance_codes = m_distance_codes.has_value() ? &m_distance_codes.value() : nullptr;
+
+    // Peek at 56 bits of input at a time, which is enough for several literals or a whole back reference, and only
+    // hand the bits that were used back to the stream once they run low.
+    static constexpr size_t peeked_bit_count = 56;
+    u64 bits = 0;
+    size_t peeked_bits = 0;
+    size_t available_bits = 0;
+    auto hand_back_bits = [&] {
+        stream.discard_previously_peeked_bits(peeked_bits - available_bits);
+        peeked_bits = 0;
+        available_bits = 0;
+    };
+    auto ensure_bits = [&](size_t count) {
+        if (available_bits >= count)
+            return true;
+        hand_back_bits();
+        auto bits_or_error = stream.peek_bits<u64>(peeked_bit_count);
+        if (bits_or_error.is_error())
+            return false;
+        bits = bits_or_error.value();
+        peeked_bits = peeked_bit_count;
+        available_bits = peeked_bit_count;
         return true;
-    }
+    };
+    auto consume_bits = [&](size_t count) {
+        auto value = bits & ((1ull << count) - 1);
+        bits >>= count;
+        available_bits -= count;
+        return value;
+    };
 
-    if (symbol == EndOfBlock) {
-        m_eof = true;
-        return false;
+    while (static_cast<size_t>(output_end - output_pointer) >= minimum_output_space) {
+        if (!ensure_bits(CanonicalCode::max_code_length))
+            break;
+
+        auto const [symbol, code_length] = m_literal_codes.decode_symbol(bits);
+        if (code_length == 0)
+            return Error::from_string_literal("Invalid deflate literal/length code");
+        consume_bits(code_length);
+
+        if (symbol < EndOfBlock) {
+            *output_pointer++ = symbol;
+            continue;
+        }
+
+        if (symbol == EndOfBlock) {
+            hand_back_bits();
+            m_eof = true;
+            return false;
+        }
+
+        if (symbol >= 286)
+            return Error::from_string_literal("Invalid deflate literal/length symbol");
+        if (!distance_codes)
+            return Error::from_string_literal("Distance codes have not been initialized");
+
+        // The extra bits of the length, the distance code and the extra bits of the distance take up at most 33 bits.
+        if (!ensure_bits(33)) {
+            // The input is about to end, so finish this back reference the slow way.
+            hand_back_bits();
+            auto const length = TRY(m_decompressor.decode_length(symbol));
+            auto const distance_symbol = TRY(distance_codes->read_symbol(stream));
+            if (distance_symbol >= 30)
+                return Error::from_string_literal("Invalid deflate distance symbol");
+            TRY(copy_match(length, TRY(m_decompressor.decode_distance(distance_symbol))));
+            break;
+        }
+
+        auto const& length_symbol = packed_length_symbols[symbol - 257];
+        auto const length = length_symbol.base_length + consume_bits(length_symbol.extra_bits);
+
+        auto const [distance_symbol, distance_code_length] = distance_codes->decode_symbol(bits);
+        if (distance_code_length == 0)
+            return Error::from_string_literal("Invalid deflate distance code");
+        consume_bits(distance_code_length);
+        if (distance_symbol >= 30)
+            return Error::from_string_literal("Invalid deflate distance symbol");
+
+        auto const& distance_base = packed_distances[distance_symbol];
+        auto const distance = distance_base.base_distance + consume_bits(distance_base.extra_bits);
+
+        TRY(copy_match(length, distance));
     }
 
-    if (!m_distance_codes.has_value())
-        return Error::from_string_literal("Distance codes have not been initialized");
+    hand_back_bits();
+    if (static_cast<size_t>(output_end - output_pointer) < minimum_output_space)
+        return true;
+
+    return decode_near_end_of_input(output_pointer, output_start, output_end, history);
+}
+
+ErrorOr<bool> DeflateDecompressor::CompressedBlock::decode_near_end_of_input(u8*& output_pointer, u8 const* output_start, u8 const* output_end, ReadonlyBytes history)
+{
+    // Fewer bits are left than the fast loop needs, so read one symbol at a time.
+    while (static_cast<size_t>(output_end - output_pointer) >= minimum_output_space) {
+        auto const symbol = TRY(m_literal_codes.read_symbol(*m_decompressor.m_input_stream));
+
+        if (symbol >= 286)
+            return Error::from_string_literal("Invalid deflate literal/length symbol");
+
+        if (symbol < EndOfBlock) {
+            *output_pointer++ = symbol;
+            continue;
+        }
+
+        if (symbol == EndOfBlock) {
+            m_eof = true;
+            return false;
+        }
 
-    auto const length = TRY(m_decompressor.decode_length(symbol));
-    auto const distance_symbol = TRY(m_distance_codes.value().read_symbol(*m_decompressor.m_input_stream));
-    if (distance_symbol >= 30)
-        return Error::from_string_literal("Invalid deflate distance symbol");
+        if (!m_distance_codes.has_value())
+            return Error::from_string_literal("Distance codes have not been initialized");
 
-    auto const distance = TRY(m_decompressor.decode_distance(distance_symbol));
+        auto const length = TRY(m_decompressor.decode_length(symbol));
+        auto const distance_symbol = TRY(m_distance_codes.value().read_symbol(*m_decompressor.m_input_stream));
+        if (distance_symbol >= 30)
+            return Error::from_string_literal("Invalid deflate distance symbol");
 
-    auto copied_length = TRY(m_decompressor.m_output_buffer.copy_from_seekback(distance, length));
+        auto const distance = TRY(m_decompressor.decode_distance(distance_symbol));
 
-    // TODO: What should we do if the output buffer is full?
-    VERIFY(copied_length == length);
+        size_t const decoded_size = output_pointer - output_start;
+        if (distance > decoded_size + history.size())
+            return Error::from_string_literal("Back reference distance exceeds the decoded data");
+        for (size_t i = 0; i < length; ++i, ++output_pointer) {
+            auto const position = static_cast<ssize_t>(output_pointer - output_start) - static_cast<ssize_t>(distance);
+            *output_pointer = position >= 0 ? output_start[position] : history[history.size() + position];
+        }
+    }
 
     return true;
 }
@@ -219,7 +383,7 @@ DeflateDecompressor::UncompressedBlock::UncompressedBlock(DeflateDecompressor& d
 {
 }
 
-ErrorOr<bool> DeflateDecompressor::UncompressedBlock::try_read_more()
+ErrorOr<bool> DeflateDecompressor::UncompressedBlock::decode(Bytes output, size_t& output_size)
 {
     if (m_bytes_remaining == 0)
         return false;
@@ -227,25 +391,23 @@ ErrorOr<bool> DeflateDecompressor::UncompressedBlock::try_read_more()
     if (m_decompressor.m_input_stream->is_eof())
         return Error::from_string_literal("Input data ends in the middle of an uncompressed DEFLATE block");
 
-    Array<u8, 4096> temporary_buffer;
-    auto readable_bytes = temporary_buffer.span().trim(min(m_bytes_remaining, m_decompressor.m_output_buffer.empty_space()));
-    auto read_bytes = TRY(m_decompressor.m_input_stream->read_some(readable_bytes));
-    auto written_bytes = m_decompressor.m_output_buffer.write(read_bytes);
-    VERIFY(read_bytes.size() == written_bytes);
-
-    m_bytes_remaining -= written_bytes;
-    return true;
+    auto read_bytes = TRY(m_decompressor.m_input_stream->read_some(output.slice(output_size).trim(m_bytes_remaining)));
+    output_size += read_bytes.size();
+    m_bytes_remaining -= read_bytes.size();
+    return m_bytes_remaining > 0;
 }
 
-ErrorOr<NonnullOwnPtr<DeflateDecompressor>> DeflateDecompressor::construct(MaybeOwned<LittleEndianInputBitStream> stream)
+ErrorOr<NonnullOwnPtr<DeflateDecompressor>> DeflateDecompressor::construct(MaybeOwned<LittleEndianInputBitStream> stream, ReadonlyBytes history)
 {
-    auto output_buffer = TRY(CircularBuffer::create_empty(32 * KiB));
-    return TRY(adopt_nonnull_own_or_enomem(new (nothrow) DeflateDecompressor(move(stream), move(output_buffer))));
+    auto window = TRY(ByteBuffer::create_uninitialized(window_capacity));
+    auto decompressor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DeflateDecompressor(move(stream), move(window))));
+    decompressor->append_to_history(history);
+    return decompressor;
 }
 
-DeflateDecompressor::DeflateDecompressor(MaybeOwned<LittleEndianInputBitStream> stream, CircularBuffer output_buffer)
+DeflateDecompressor::DeflateDecompressor(MaybeOwned<LittleEndianInputBitStream> stream, ByteBuffer window)
     : m_input_stream(move(stream))
-    , m_output_buffer(move(output_buffer))
+    , m_window(move(window))
 {
 }
 
@@ -257,96 +419,135 @@ DeflateDecompressor::~DeflateDecompressor()
         m_uncompressed_block.~UncompressedBlock();
 }
 
-ErrorOr<Bytes> DeflateDecompressor::read_some(Bytes bytes)
+ReadonlyBytes DeflateDecompressor::history() const
 {
-    size_t total_read = 0;
-    while (total_read < bytes.size()) {
-        auto slice = bytes.slice(total_read);
+    auto history_size = min(m_window_size, max_back_reference_distance);
+    return m_window.bytes().slice(m_window_size - history_size, history_size);
+}
 
-        if (m_state == State::Idle) {
-            if (m_read_final_block)
-                break;
+void DeflateDecompressor::make_room_in_window(size_t size)
+{
+    VERIFY(size <= window_capacity - max_back_reference_distance);
+    if (m_window.size() - m_window_size >= size)
+        return;
+
+    // Move the history and the output that hasn't been read yet to the start of the window.
+    auto keep_offset = min(m_window_read_offset, m_window_size - history().size());
+    VERIFY(m_window.size() - (m_window_size - keep_offset) >= size);
+    memmove(m_window.data(), m_window.data() + keep_offset, m_window_size - keep_offset);
+    m_window_size -= keep_offset;
+    m_window_read_offset -= keep_offset;
+}
 
-            m_read_final_block = TRY(m_input_stream->read_bit());
-            auto const block_type = TRY(m_input_stream->read_bits(2));
+void DeflateDecompressor::append_to_history(ReadonlyBytes bytes)
+{
+    VERIFY(m_window_read_offset == m_window_size);
+    if (bytes.size() > max_back_reference_distance)
+        bytes = bytes.slice(bytes.size() - max_back_reference_distance);
+
+    make_room_in_window(bytes.size());
+    bytes.copy_to(m_window.bytes().slice(m_window_size));
+    m_window_size += bytes.size();
+    m_window_read_offset = m_window_size;
+}
 
-            if (block_type == 0b00) {
-                m_input_stream->align_to_byte_boundary();
+ErrorOr<void> DeflateDecompressor::read_block_header()
+{
+    VERIFY(m_state == State::Idle);
 
-                u16 length = TRY(m_input_stream->read_value<LittleEndian<u16>>());
-                u16 negated_length = TRY(m_input_stream->read_value<LittleEndian<u16>>());
+    m_read_final_block = TRY(m_input_stream->read_bit());
+    auto const block_type = TRY(m_input_stream->read_bits(2));
 
-                if ((length ^ 0xffff) != negated_length)
-                    return Error::from_string_literal("Calculated negated length does not equal stored negated length");
+    if (block_type == 0b00) {
+        m_input_stream->align_to_byte_boundary();
 
-                m_state = State::ReadingUncompressedBlock;
-                new (&m_uncompressed_block) UncompressedBlock(*this, length);
+        u16 length = TRY(m_input_stream->read_value<LittleEndian<u16>>());
+        u16 negated_length = TRY(m_input_stream->read_value<LittleEndian<u16>>());
 
-                continue;
-            }
+        if ((length ^ 0xffff) != negated_length)
+            return Error::from_string_literal("Calculated negated length does not equal stored negated length");
 
-            if (block_type == 0b01) {
-                m_state = State::ReadingCompressedBlock;
-                new (&m_compressed_block) CompressedBlock(*this, CanonicalCode::fixed_literal_codes(), CanonicalCode::fixed_distance_codes());
+        m_state = State::ReadingUncompressedBlock;
+        new (&m_uncompressed_block) UncompressedBlock(*this, length);
+        return {};
+    }
 
-                continue;
-            }
+    if (block_type == 0b01) {
+        m_state = State::ReadingCompressedBlock;
+        new (&m_compressed_block) CompressedBlock(*this, CanonicalCode::fixed_literal_codes(), CanonicalCode::fixed_distance_codes());
+        return {};
+    }
 
-            if (block_type == 0b10) {
-                CanonicalCode literal_codes;
-                Optional<CanonicalCode> distance_codes;
-                TRY(decode_codes(literal_codes, distance_codes));
+    if (block_type == 0b10) {
+        CanonicalCode literal_codes;
+        Optional<CanonicalCode> distance_codes;
+        TRY(decode_codes(literal_codes, distance_codes));
 
-                m_state = State::ReadingCompressedBlock;
-                new (&m_compressed_block) CompressedBlock(*this, literal_codes, distance_codes);
+        m_state = State::ReadingCompressedBlock;
+        new (&m_compressed_block) CompressedBlock(*this, literal_codes, distance_codes);
+        return {};
+    }
 
-                continue;
-            }
+    return Error::from_string_literal("Unhandled block type for Idle state");
+}
 
-            return Error::from_string_literal("Unhandled block type for Idle state");
+ErrorOr<Bytes> DeflateDecompressor::read_some(Bytes bytes)
+{
+    size_t total_read = 0;
+    while (total_read < bytes.size()) {
+        if (m_window_read_offset < m_window_size) {
+            auto unread_data = m_window.bytes().slice(m_window_read_offset, m_window_size - m_window_read_offset);
+            auto nread = unread_data.copy_trimmed_to(bytes.slice(total_read));
+            m_window_read_offset += nread;
+            total_read += nread;
+            continue;
         }
 
-        if (m_state == State::ReadingCompressedBlock) {
-            auto nread = m_output_buffer.read(slice).size();
-
-            while (nread < slice.size() && TRY(m_compressed_block.try_read_more())) {
-                nread += m_output_buffer.read(slice.slice(nread)).size();
-            }
-
-            total_read += nread;
-            if (nread == slice.size())
+        if (m_state == State::Idle) {
+            if (m_read_final_block)
                 break;
-
-            m_compressed_block.~CompressedBlock();
-            m_state = State::Idle;
-
+            TRY(read_block_header());
             continue;
         }
 
-        if (m_state == State::ReadingUncompressedBlock) {
-            auto nread = m_output_buffer.read(slice).size();
-
-            while (nread < slice.size() && TRY(m_uncompressed_block.try_read_more())) {
-                nread += m_output_buffer.read(slice.slice(nread)).size();
-            }
+        auto decode = [&](Bytes output, size_t& output_size, ReadonlyBytes history) -> ErrorOr<bool> {
+            if (m_state == State::ReadingCompressedBlock)
+                return m_compressed_block.decode(output, output_size, history);
+            return m_uncompressed_block.decode(output, output_size);
+        };
 
-            total_read += nread;
-            if (nread == slice.size())
-                break;
+        bool block_continues;
+        auto slice = bytes.slice(total_read);
+        if (slice.size() >= direct_output_threshold) {
+            size_t decoded_size = 0;
+            block_continues = TRY(decode(slice, decoded_size, history()));
+            append_to_history(slice.trim(decoded_size));
+            total_read += decoded_size;
+            m_decoded_size += decoded_size;
+        } else {
+            make_room_in_window(max_back_reference_distance);
+            auto const previous_window_size = m_window_size;
+            block_continues = TRY(decode(m_window.bytes(), m_window_size, {}));
+            m_decoded_size += m_window_size - previous_window_size;
+        }
 
-            m_uncompressed_block.~UncompressedBlock();
+        if (!block_continues) {
+            if (m_state == State::ReadingCompressedBlock)
+                m_compressed_block.~CompressedBlock();
+            else
+                m_uncompressed_block.~UncompressedBlock();
             m_state = State::Idle;
 
-            continue;
+            // The window always ends with the most recently decoded data, whether or not it has been read yet.
+            if (!m_read_final_block && on_block_boundary)
+                TRY(on_block_boundary(m_decoded_size, history()));
         }
-
-        VERIFY_NOT_REACHED();
     }
 
     return bytes.slice(0, total_read);
 }
 
-bool DeflateDecompressor::is_eof() const { return m_state == State::Idle && m_read_final_block; }
+bool DeflateDecompressor::is_eof() const { return m_state == State::Idle && m_read_final_block && m_window_read_offset == m_window_size; }
 
 ErrorOr<size_t> DeflateDecompressor::write_some(ReadonlyBytes)
 {
@@ -367,7 +568,8 @@ ErrorOr<ByteBuffer> DeflateDecompressor::decompress_all(ReadonlyBytes bytes)
     FixedMemoryStream memory_stream { bytes };
     LittleEndianInputBitStream bit_stream { MaybeOwned<Stream>(memory_stream) };
     auto deflate_stream = TRY(DeflateDecompressor::construct(MaybeOwned<LittleEndianInputBitStream>(bit_stream)));
-    return deflate_stream->read_until_eof(4096);
+    // Read in large blocks, so that most of the data is decoded straight into the result.
+    return deflate_stream->read_until_eof(4 * direct_output_threshold);
 }
 
 ErrorOr<u32> DeflateDecompressor::decode_length(u32 symbol)
@@ -522,6 +724,15 @@ void DeflateCompressor::close()
 {
 }
 
+void DeflateCompressor::set_dictionary(ReadonlyBytes dictionary)
+{
+    VERIFY(m_pending_block_size == 0);
+    if (dictionary.size() > block_size)
+        dictionary = dictionary.slice(dictionary.size() - block_size);
+    dictionary.copy_to({ m_rolling_window + block_size - dictionary.size(), dictionary.size() });
+    m_history_size = dictionary.size();
+}
+
 // Knuth's multiplicative hash on 4 bytes
 u16 DeflateCompressor::hash_sequence(u8 const* bytes)
 {
@@ -569,7 +780,7 @@ size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previou
             break; // no remaining candidates
 
         VERIFY(candidate < start);
-        if (start - candidate > window_size)
+        if (start - candidate > max_back_reference_distance)
             break; // outside the window
 
         auto match_length = compare_match_candidate(start, candidate, previous_match_length, maximum_match_length);
@@ -631,6 +842,11 @@ void DeflateCompressor::lz77_compress_block()
 
     // our block starts at block_size and is m_pending_block_size in length
     auto block_end = block_size + m_pending_block_size;
+
+    // make the dictionary that precedes the first block available to back references
+    for (size_t position = block_size - m_history_size; position < min(block_size, block_end - min_match_length + 1); position++)
+        insert_hash(position, hash_sequence(&m_rolling_window[position]));
+
     size_t current_position;
     for (current_position = block_size; current_position < block_end - min_match_length + 1; current_position++) {
         auto hash = hash_sequence(&m_rolling_window[current_position]);
@@ -942,6 +1158,7 @@ ErrorOr<void> DeflateCompressor::flush()
     // reset all block specific members
     m_pending_block_size = 0;
     m_pending_symbol_size = 0;
+    m_history_size = 0;
     m_symbol_frequencies.fill(0);
     m_distance_frequencies.fill(0);
     // On the final block this copy will potentially produce an invalid search window, but since its the final block we dont care
@@ -959,6 +1176,21 @@ ErrorOr<void> DeflateCompressor::final_flush()
     return {};
 }
 
+ErrorOr<void> DeflateCompressor::sync_flush_and_finish()
+{
+    VERIFY(!m_finished);
+    if (m_pending_block_size > 0)
+        TRY(flush());
+    m_finished = true;
+
+    TRY(m_output_stream->write_bits(0b000u, 3)); // not final, no compression
+    TRY(m_output_stream->align_to_byte_boundary());
+    TRY(m_output_stream->write_value<LittleEndian<u16>>(0));
+    TRY(m_output_stream->write_value<LittleEndian<u16>>(0xffff));
+    TRY(m_output_stream->flush_buffer_to_stream());
+    return {};
+}
+
 ErrorOr<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, CompressionLevel compression_level)
 {
     auto output_stream = TRY(try_make<AllocatingMemoryStream>());
@@ -973,4 +1205,165 @@ ErrorOr<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, Compres
     return buffer;
 }
 
+ErrorOr<ByteBuffer> DeflateCompressor::compress_all_in_parallel(ReadonlyBytes bytes, size_t chunk_size, CompressionLevel compression_level, Optional<size_t> thread_count)
+{
+    auto compressed_chunks = TRY(compress_chunks_in_parallel(bytes, 0, chunk_size, true, compression_level, thread_count));
+
+    size_t total_size = 0;
+    for (auto const& compressed_chunk : compressed_chunks)
+        total_size += compressed_chunk.size();
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(total_size));
+    size_t offset = 0;
+    for (auto const& compressed_chunk : compressed_chunks) {
+        compressed_chunk.bytes().copy_to(buffer.bytes().slice(offset));
+        offset += compressed_chunk.size();
+    }
+    return buffer;
+}
+
+ErrorOr<Vector<ByteBuffer>> DeflateCompressor::compress_chunks_in_parallel(ReadonlyBytes bytes, size_t history_size, size_t chunk_size, bool is_final, CompressionLevel compression_level, Optional<size_t> thread_count)
+{
+    VERIFY(chunk_size > 0);
+    VERIFY(history_size <= bytes.size());
+    auto data_size = bytes.size() - history_size;
+    auto chunk_count = max<size_t>(ceil_div(data_size, chunk_size), 1);
+
+    auto compress_chunk = [&](size_t index) -> ErrorOr<ByteBuffer> {
+        auto output_stream = TRY(try_make<AllocatingMemoryStream>());
+        auto deflate_stream = TRY(DeflateCompressor::construct(MaybeOwned<Stream>(*output_stream), compression_level));
+
+        // Let back references reach into the data before the chunk, like they would if a single compressor did all the work.
+        auto chunk_start = history_size + index * chunk_size;
+        deflate_stream->set_dictionary(bytes.slice(0, chunk_start));
+
+        auto chunk = bytes.slice(chunk_start, min(chunk_size, bytes.size() - chunk_start));
+        TRY(deflate_stream->write_until_depleted(chunk));
+        if (is_final && index == chunk_count - 1)
+            TRY(deflate_stream->final_flush());
+        else
+            TRY(deflate_stream->sync_flush_and_finish());
+
+        auto buffer = TRY(ByteBuffer::create_uninitialized(output_stream->used_buffer_size()));
+        TRY(output_stream->read_until_filled(buffer));
+        return buffer;
+    };
+
+    Vector<Optional<ErrorOr<ByteBuffer>>> compressed_chunks;
+    TRY(compressed_chunks.try_resize(chunk_count));
+
+    Atomic<size_t> next_chunk_index { 0 };
+    auto compress_chunks = [&] {
+        for (size_t index; (index = next_chunk_index.fetch_add(1)) < chunk_count;)
+            compressed_chunks[index] = compress_chunk(index);
+    };
+
+    // The calling thread compresses chunks too.
+    auto worker_count = min(thread_count.value_or(Core::System::hardware_concurrency()), chunk_count);
+    Vector<NonnullRefPtr<Threading::Thread>> workers;
+    TRY(workers.try_ensure_capacity(worker_count));
+    for (size_t i = 1; i < worker_count; ++i) {
+        // If no more threads can be created, the threads that are already running do the remaining work.
+        auto worker = Threading::Thread::try_create([&]() -> intptr_t {
+            compress_chunks();
+            return 0;
+        },
+            "Deflate worker"sv);
+        if (worker.is_error())
+            break;
+        worker.value()->start();
+        workers.unchecked_append(worker.release_value());
+    }
+    compress_chunks();
+    for (auto& worker : workers)
+        (void)worker->join();
+
+    Vector<ByteBuffer> result;
+    TRY(result.try_ensure_capacity(chunk_count));
+    for (auto& compressed_chunk : compressed_chunks) {
+        if (compressed_chunk->is_error())
+            return compressed_chunk->release_error();
+        result.unchecked_append(compressed_chunk->release_value());
+    }
+    return result;
+}
+
+ErrorOr<NonnullOwnPtr<ParallelDeflateCompressor>> ParallelDeflateCompressor::construct(MaybeOwned<Stream> stream, DeflateCompressor::CompressionLevel compression_level, Optional<size_t> thread_count, size_t chunk_size)
+{
+    VERIFY(chunk_size > 0);
+    auto resolved_thread_count = max<size_t>(thread_count.value_or(Core::System::hardware_concurrency()), 1);
+
+    // A few chunks per thread make up for chunks that take longer to compress than others.
+    static constexpr size_t chunks_per_thread = 4;
+    auto buffer = TRY(ByteBuffer::create_uninitialized(DeflateCompressor::block_size + resolved_thread_count * chunks_per_thread * chunk_size));
+    return adopt_nonnull_own_or_enomem(new (nothrow) ParallelDeflateCompressor(move(stream), compression_level, resolved_thread_count, chunk_size, move(buffer)));
+}
+
+ParallelDeflateCompressor::ParallelDeflateCompressor(MaybeOwned<Stream> stream, DeflateCompressor::CompressionLevel compression_level, size_t thread_count, size_t chunk_size, ByteBuffer buffer)
+    : m_output_stream(move(stream))
+    , m_compression_level(compression_level)
+    , m_thread_count(thread_count)
+    , m_chunk_size(chunk_size)
+    , m_buffer(move(buffer))
+{
+}
+
+ParallelDeflateCompressor::~ParallelDeflateCompressor()
+{
+    VERIFY(m_finished);
+}
+
+ErrorOr<Bytes> ParallelDeflateCompressor::read_some(Bytes)
+{
+    return Error::from_errno(EBADF);
+}
+
+ErrorOr<size_t> ParallelDeflateCompressor::write_some(ReadonlyBytes bytes)
+{
+    VERIFY(!m_finished);
+
+    if (m_buffered_size == m_buffer.size())
+        TRY(compress_batch(false));
+
+    auto n_written = bytes.copy_trimmed_to(m_buffer.bytes().slice(m_buffered_size));
+    m_buffered_size += n_written;
+    return n_written;
+}
+
+bool ParallelDeflateCompressor::is_eof() const
+{
+    return true;
+}
+
+bool ParallelDeflateCompressor::is_open() const
+{
+    return m_output_stream->is_open();
+}
+
+void ParallelDeflateCompressor::close()
+{
+}
+
+ErrorOr<void> ParallelDeflateCompressor::final_flush()
+{
+    VERIFY(!m_finished);
+    TRY(compress_batch(true));
+    m_finished = true;
+    return {};
+}
+
+ErrorOr<void> ParallelDeflateCompressor::compress_batch(bool is_final)
+{
+    auto batch = m_buffer.bytes().trim(m_buffered_size);
+    auto compressed_chunks = TRY(DeflateCompressor::compress_chunks_in_parallel(batch, m_history_size, m_chunk_size, is_final, m_compression_level, m_thread_count));
+    for (auto const& compressed_chunk : compressed_chunks)
+        TRY(m_output_stream->write_until_depleted(compressed_chunk));
+
+    // Keep the end of the batch around to prime the first chunk of the next one.
+    m_history_size = min(m_buffered_size, DeflateCompressor::block_size);
+    memmove(m_buffer.data(), m_buffer.data() + m_buffered_size - m_history_size, m_history_size);
+    m_buffered_size = m_history_size;
+    return {};
+}
+
 }
@@ -9,9 +9,9 @@
 
 #include <AK/BitStream.h>
 #include <AK/ByteBuffer.h>
-#include <AK/CircularBuffer.h>
 #include <AK/Endian.h>
 #include <AK/Forward.h>
+#include <AK/Function.h>
 #include <AK/MaybeOwned.h>
 #include <AK/Stream.h>
 #include <AK/Vector.h>
@@ -30,20 +30,38 @@ public:
 
     static ErrorOr<CanonicalCode> from_bytes(ReadonlyBytes);
 
-private:
-    static constexpr size_t max_allowed_prefixed_code_length = 8;
+    static constexpr size_t max_code_length = 15;
 
-    struct PrefixTableEntry {
-        u16 symbol_value { 0 };
-        u16 code_length { 0 };
+    struct DecodedSymbol {
+        u16 symbol { 0 };
+        u8 code_length { 0 }; // 0 if the bits don't start with a valid code.
     };
 
-    // Decompression - indexed by code
-    Vector<u16, 286> m_symbol_codes;
-    Vector<u16, 286> m_symbol_values;
+    // Decodes the code that the lowest bits of `bits` start with. `bits` has to hold (at least) the next
+    // max_code_length bits of input, or zeroes after the end of the input.
+    ALWAYS_INLINE DecodedSymbol decode_symbol(u64 bits) const
+    {
+        auto entry = m_decoding_table[bits & ((1u << m_primary_table_bits) - 1)];
+        if (entry.secondary_table_bits != 0) [[unlikely]]
+            entry = m_decoding_table[entry.value + ((bits >> m_primary_table_bits) & ((1u << entry.secondary_table_bits) - 1))];
+        return { entry.value, entry.code_length };
+    }
 
-    Array<PrefixTableEntry, 1 << max_allowed_prefixed_code_length> m_prefix_table {};
-    size_t m_max_prefixed_code_length { 0 };
+private:
+    static constexpr size_t max_primary_table_bits = 9;
+
+    // Decompression - indexed by the next m_primary_table_bits bits of input (in the order they are read). Each entry of
+    // this primary table either holds a symbol and the length of its code, or points to a secondary table that is
+    // indexed by the bits that follow, for codes that are longer than m_primary_table_bits. The secondary tables are
+    // stored after the primary table.
+    struct DecodingTableEntry {
+        u16 value { 0 }; // The symbol, or the index of the secondary table.
+        u8 code_length { 0 };
+        u8 secondary_table_bits { 0 };
+    };
+    Vector<DecodingTableEntry> m_decoding_table;
+    u8 m_primary_table_bits { 0 };
+    u8 m_max_code_length { 0 };
 
     // Compression - indexed by symbol
     // Deflate uses a maximum of 288 symbols (maximum of 32 for distances),
@@ -62,13 +80,18 @@ ALWAYS_INLINE ErrorOr<void> CanonicalCode::write_symbol(LittleEndianOutputBitStr
 
 class DeflateDecompressor final : public Stream {
 private:
+    // Both kinds of blocks decode into `output`, after the first `output_size` bytes of it that were already decoded,
+    // and return false once the block has ended. Back references that reach past the start of `output` continue in
+    // `history`, which holds the data that was decoded before it.
     class CompressedBlock {
     public:
         CompressedBlock(DeflateDecompressor&, CanonicalCode literal_codes, Optional<CanonicalCode> distance_codes);
 
-        ErrorOr<bool> try_read_more();
+        ErrorOr<bool> decode(Bytes output, size_t& output_size, ReadonlyBytes history);
 
     private:
+        ErrorOr<bool> decode_near_end_of_input(u8*& output_pointer, u8 const* output_start, u8 const* output_end, ReadonlyBytes history);
+
         bool m_eof { false };
 
         DeflateDecompressor& m_decompressor;
@@ -80,7 +103,7 @@ private:
     public:
         UncompressedBlock(DeflateDecompressor&, size_t);
 
-        ErrorOr<bool> try_read_more();
+        ErrorOr<bool> decode(Bytes output, size_t& output_size);
 
     private:
         DeflateDecompressor& m_decompressor;
@@ -97,9 +120,15 @@ public:
     friend CompressedBlock;
     friend UncompressedBlock;
 
-    static ErrorOr<NonnullOwnPtr<DeflateDecompressor>> construct(MaybeOwned<LittleEndianInputBitStream> stream);
+    // `history` is the data that was decoded before the block that the stream starts at, for resuming decoding in the
+    // middle of a stream. Only its last 32 KiB can be referred to.
+    static ErrorOr<NonnullOwnPtr<DeflateDecompressor>> construct(MaybeOwned<LittleEndianInputBitStream> stream, ReadonlyBytes history = {});
     ~DeflateDecompressor();
 
+    // Called after each block other than the final one, with the amount of data decoded so far and the history that
+    // the next block may refer to. Decoding can later be resumed from the input position at this point.
+    Function<ErrorOr<void>(u64 decoded_size, ReadonlyBytes history)> on_block_boundary;
+
     virtual ErrorOr<Bytes> read_some(Bytes) override;
     virtual ErrorOr<size_t> write_some(ReadonlyBytes) override;
     virtual bool is_eof() const override;
@@ -109,13 +138,28 @@ public:
     static ErrorOr<ByteBuffer> decompress_all(ReadonlyBytes);
 
 private:
-    DeflateDecompressor(MaybeOwned<LittleEndianInputBitStream> stream, CircularBuffer buffer);
+    DeflateDecompressor(MaybeOwned<LittleEndianInputBitStream> stream, ByteBuffer window);
 
+    ErrorOr<void> read_block_header();
     ErrorOr<u32> decode_length(u32);
     ErrorOr<u32> decode_distance(u32);
     ErrorOr<void> decode_codes(CanonicalCode& literal_code, Optional<CanonicalCode>& distance_code);
 
+    ReadonlyBytes history() const;
+    void make_room_in_window(size_t);
+    void append_to_history(ReadonlyBytes);
+
     static constexpr u16 max_back_reference_length = 258;
+    static constexpr size_t max_back_reference_distance = 32 * KiB;
+
+    // Back references are copied 16 bytes at a time, so they may write up to 15 bytes past their end. Decoding stops
+    // once there is less space left than the longest back reference needs.
+    static constexpr size_t copy_overrun = 15;
+    static constexpr size_t minimum_output_space = max_back_reference_length + copy_overrun;
+
+    // Reads into buffers that are at least this large are decoded straight into the buffer.
+    static constexpr size_t direct_output_threshold = 64 * KiB;
+    static constexpr size_t window_capacity = 128 * KiB;
 
     bool m_read_final_block { false };
 
@@ -126,7 +170,15 @@ private:
     };
 
     MaybeOwned<LittleEndianInputBitStream> m_input_stream;
-    CircularBuffer m_output_buffer;
+
+    // Data is decoded into the window, unless it can be decoded into the reader's buffer directly. The window holds
+    // (at least) the last max_back_reference_distance bytes of output as the history for back references, followed by
+    // output that hasn't been read yet.
+    ByteBuffer m_window;
+    size_t m_window_size { 0 };
+    size_t m_window_read_offset { 0 };
+
+    u64 m_decoded_size { 0 };
 };
 
 class DeflateCompressor final : public Stream {
@@ -134,6 +186,7 @@ public:
     static constexpr size_t block_size = 32 * KiB - 1; // TODO: this can theoretically be increased to 64 KiB - 2
     static constexpr size_t window_size = block_size * 2;
     static constexpr size_t hash_bits = 15;
+    static constexpr size_t max_back_reference_distance = 32 * KiB;
     static constexpr size_t max_huffman_literals = 288;
     static constexpr size_t max_huffman_distances = 32;
     static constexpr size_t min_match_length = 4;   // matches smaller than these are not worth the size of the back reference
@@ -172,10 +225,29 @@ public:
     virtual bool is_eof() const override;
     virtual bool is_open() const override;
     virtual void close() override;
+
+    // Primes the compressor with (the last block_size bytes of) data that precedes the data that is about to be written,
+    // so that back references of the first block can reach into it. The dictionary itself isn't written. Must be called
+    // before any data is written.
+    void set_dictionary(ReadonlyBytes);
+
     ErrorOr<void> final_flush();
+    // Like final_flush(), but ends the data with an empty stored block (a "sync flush") instead of a final block. This
+    // aligns the output to a byte boundary, so that another Deflate stream can follow it to form a single stream.
+    ErrorOr<void> sync_flush_and_finish();
 
     static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes, CompressionLevel = CompressionLevel::GOOD);
 
+    // Compresses chunks of `chunk_size` bytes on up to `thread_count` threads (one per CPU by default), and joins them into
+    // a single Deflate stream. Each chunk is primed with the end of the previous one, but the Huffman codes of a block
+    // can't span two chunks, so the result is slightly larger than with compress_all().
+    static ErrorOr<ByteBuffer> compress_all_in_parallel(ReadonlyBytes bytes, size_t chunk_size, CompressionLevel = CompressionLevel::GOOD, Optional<size_t> thread_count = {});
+
+    // Compresses the data after the first `history_size` bytes of `bytes` as described above, and returns the compressed
+    // chunks. The first chunk is primed with the history. Unless `is_final` is set, the last chunk ends with a sync flush
+    // as well, so that more chunks can follow it.
+    static ErrorOr<Vector<ByteBuffer>> compress_chunks_in_parallel(ReadonlyBytes bytes, size_t history_size, size_t chunk_size, bool is_final, CompressionLevel = CompressionLevel::GOOD, Optional<size_t> thread_count = {});
+
 private:
     DeflateCompressor(NonnullOwnPtr<LittleEndianOutputBitStream>, CompressionLevel = CompressionLevel::GOOD);
 
@@ -209,8 +281,10 @@ private:
     CompressionConstants m_compression_constants;
     NonnullOwnPtr<LittleEndianOutputBitStream> m_output_stream;
 
+    // The first pending block is preceded by the dictionary (if any), which its back references can reach into.
     u8 m_rolling_window[window_size];
     size_t m_pending_block_size { 0 };
+    size_t m_history_size { 0 };
 
     struct [[gnu::packed]] {
         u16 distance; // back reference length
@@ -228,4 +302,38 @@ private:
     u16 m_hash_prev[window_size];
 };
 
+// Compresses a stream into a single Deflate stream on several threads at once, in the style of pigz. The input is split
+// into chunks that are compressed by DeflateCompressor::compress_chunks_in_parallel(), a batch of a few chunks per thread
+// at a time.
+class ParallelDeflateCompressor final : public Stream {
+public:
+    static constexpr size_t default_chunk_size = 128 * KiB;
+
+    static ErrorOr<NonnullOwnPtr<ParallelDeflateCompressor>> construct(MaybeOwned<Stream>, DeflateCompressor::CompressionLevel = DeflateCompressor::CompressionLevel::GOOD, Optional<size_t> thread_count = {}, size_t chunk_size = default_chunk_size);
+    ~ParallelDeflateCompressor();
+
+    virtual ErrorOr<Bytes> read_some(Bytes) override;
+    virtual ErrorOr<size_t> write_some(ReadonlyBytes) override;
+    virtual bool is_eof() const override;
+    virtual bool is_open() const override;
+    virtual void close() override;
+    ErrorOr<void> final_flush();
+
+private:
+    ParallelDeflateCompressor(MaybeOwned<Stream>, DeflateCompressor::CompressionLevel, size_t thread_count, size_t chunk_size, ByteBuffer);
+
+    ErrorOr<void> compress_batch(bool is_final);
+
+    bool m_finished { false };
+    MaybeOwned<Stream> m_output_stream;
+    DeflateCompressor::CompressionLevel m_compression_level;
+    size_t m_thread_count { 0 };
+    size_t m_chunk_size { 0 };
+
+    // The end of the previous batch, followed by the data of the current batch.
+    ByteBuffer m_buffer;
+    size_t m_history_size { 0 };
+    size_t m_buffered_size { 0 };
+};
+
 }
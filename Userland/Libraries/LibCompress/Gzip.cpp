@@ -42,6 +42,55 @@ bool BlockHeader::supported_by_implementation() const
     return true;
 }
 
+// Skips the fields that follow the fixed-size part of a member header, as indicated by its flags.
+static ErrorOr<void> discard_optional_header_fields(BlockHeader const& header, Stream& stream)
+{
+    if (header.flags & Flags::FEXTRA) {
+        u16 subfield_id = TRY(stream.read_value<LittleEndian<u16>>());
+        u16 length = TRY(stream.read_value<LittleEndian<u16>>());
+        TRY(stream.discard(length));
+        (void)subfield_id;
+    }
+
+    auto discard_string = [&]() -> ErrorOr<void> {
+        char next_char;
+        do {
+            next_char = TRY(stream.read_value<char>());
+        } while (next_char);
+
+        return {};
+    };
+
+    if (header.flags & Flags::FNAME)
+        TRY(discard_string());
+
+    if (header.flags & Flags::FCOMMENT)
+        TRY(discard_string());
+
+    if (header.flags & Flags::FHCRC) {
+        u16 crc = TRY(stream.read_value<LittleEndian<u16>>());
+        // FIXME: we should probably verify this instead of just assuming it matches
+        (void)crc;
+    }
+
+    return {};
+}
+
+// Reads a whole member header, up to the start of the Deflate data.
+static ErrorOr<void> read_member_header(Stream& stream)
+{
+    BlockHeader header;
+    TRY(stream.read_until_filled({ &header, sizeof(header) }));
+
+    if (!header.valid_magic_number())
+        return Error::from_string_literal("Header does not have a valid magic number");
+
+    if (!header.supported_by_implementation())
+        return Error::from_string_literal("Header is not supported by implementation");
+
+    return discard_optional_header_fields(header, stream);
+}
+
 ErrorOr<NonnullOwnPtr<GzipDecompressor::Member>> GzipDecompressor::Member::construct(BlockHeader header, LittleEndianInputBitStream& stream)
 {
     auto deflate_stream = TRY(DeflateDecompressor::construct(MaybeOwned<LittleEndianInputBitStream>(stream)));
@@ -117,33 +166,7 @@ ErrorOr<Bytes> GzipDecompressor::read_some(Bytes bytes)
             if (!header.supported_by_implementation())
                 return Error::from_string_literal("Header is not supported by implementation");
 
-            if (header.flags & Flags::FEXTRA) {
-                u16 subfield_id = TRY(m_input_stream->read_value<LittleEndian<u16>>());
-                u16 length = TRY(m_input_stream->read_value<LittleEndian<u16>>());
-                TRY(m_input_stream->discard(length));
-                (void)subfield_id;
-            }
-
-            auto discard_string = [&]() -> ErrorOr<void> {
-                char next_char;
-                do {
-                    next_char = TRY(m_input_stream->read_value<char>());
-                } while (next_char);
-
-                return {};
-            };
-
-            if (header.flags & Flags::FNAME)
-                TRY(discard_string());
-
-            if (header.flags & Flags::FCOMMENT)
-                TRY(discard_string());
-
-            if (header.flags & Flags::FHCRC) {
-                u16 crc = TRY(m_input_stream->read_value<LittleEndian<u16>>());
-                // FIXME: we should probably verify this instead of just assuming it matches
-                (void)crc;
-            }
+            TRY(discard_optional_header_fields(header, *m_input_stream));
 
             m_current_member = TRY(Member::construct(header, *m_input_stream));
             continue;
@@ -189,6 +212,303 @@ ErrorOr<size_t> GzipDecompressor::write_some(ReadonlyBytes)
     return Error::from_errno(EBADF);
 }
 
+static constexpr u32 gzip_index_magic = 0x58495a47; // "GZIX"
+static constexpr u32 gzip_index_version = 1;
+static constexpr size_t gzip_index_history_size = 32 * KiB;
+
+ErrorOr<GzipIndex> GzipIndex::create(ReadonlyBytes compressed_data, u64 span)
+{
+    VERIFY(span > 0);
+
+    GzipIndex index;
+    index.m_span = span;
+    index.m_compressed_size = compressed_data.size();
+
+    FixedMemoryStream input { compressed_data };
+    LittleEndianInputBitStream bit_stream { MaybeOwned<Stream>(input) };
+    auto bit_position = [&] { return input.offset() * 8 - bit_stream.buffered_bit_count(); };
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(256 * KiB));
+    u64 last_access_point_offset = 0;
+
+    while (!bit_stream.is_eof()) {
+        if (index.m_uncompressed_size - last_access_point_offset >= span) {
+            TRY(index.m_access_points.try_append({ .uncompressed_offset = index.m_uncompressed_size, .compressed_bit_offset = bit_position(), .starts_member = true, .history = {} }));
+            last_access_point_offset = index.m_uncompressed_size;
+        }
+
+        TRY(read_member_header(bit_stream));
+
+        auto const member_start = index.m_uncompressed_size;
+        auto deflate_stream = TRY(DeflateDecompressor::construct(MaybeOwned<LittleEndianInputBitStream>(bit_stream)));
+        deflate_stream->on_block_boundary = [&](u64 decoded_size, ReadonlyBytes history) -> ErrorOr<void> {
+            auto const offset = member_start + decoded_size;
+            if (offset - last_access_point_offset < span)
+                return {};
+            TRY(index.m_access_points.try_append({ .uncompressed_offset = offset, .compressed_bit_offset = bit_position(), .starts_member = false, .history = TRY(ByteBuffer::copy(history)) }));
+            last_access_point_offset = offset;
+            return {};
+        };
+
+        Crypto::Checksum::CRC32 checksum;
+        while (!deflate_stream->is_eof()) {
+            auto data = TRY(deflate_stream->read_some(buffer));
+            checksum.update(data);
+            index.m_uncompressed_size += data.size();
+        }
+
+        u32 crc32 = TRY(bit_stream.read_value<LittleEndian<u32>>());
+        u32 input_size = TRY(bit_stream.read_value<LittleEndian<u32>>());
+        if (crc32 != checksum.digest())
+            return Error::from_string_literal("Stored CRC32 does not match the calculated CRC32 of the current member");
+        if (input_size != static_cast<u32>(index.m_uncompressed_size - member_start))
+            return Error::from_string_literal("Input size does not match the number of read bytes");
+
+        index.m_last_member_crc32 = crc32;
+        index.m_last_member_size = input_size;
+    }
+
+    return index;
+}
+
+// The index is stored as a header, followed by the access points. All integers are little-endian.
+ErrorOr<GzipIndex> GzipIndex::read_from_stream(Stream& stream)
+{
+    if (TRY(stream.read_value<LittleEndian<u32>>()) != gzip_index_magic)
+        return Error::from_string_literal("Not a gzip index");
+    if (TRY(stream.read_value<LittleEndian<u32>>()) != gzip_index_version)
+        return Error::from_string_literal("Unsupported gzip index version");
+
+    GzipIndex index;
+    index.m_span = TRY(stream.read_value<LittleEndian<u64>>());
+    index.m_compressed_size = TRY(stream.read_value<LittleEndian<u64>>());
+    index.m_uncompressed_size = TRY(stream.read_value<LittleEndian<u64>>());
+    index.m_last_member_crc32 = TRY(stream.read_value<LittleEndian<u32>>());
+    index.m_last_member_size = TRY(stream.read_value<LittleEndian<u32>>());
+
+    u64 const access_point_count = TRY(stream.read_value<LittleEndian<u64>>());
+    for (u64 i = 0; i < access_point_count; ++i) {
+        AccessPoint access_point;
+        access_point.uncompressed_offset = TRY(stream.read_value<LittleEndian<u64>>());
+        access_point.compressed_bit_offset = TRY(stream.read_value<LittleEndian<u64>>());
+        access_point.starts_member = TRY(stream.read_value<u8>()) != 0;
+        u32 const history_size = TRY(stream.read_value<LittleEndian<u32>>());
+
+        if (access_point.uncompressed_offset > index.m_uncompressed_size || access_point.compressed_bit_offset >= index.m_compressed_size * 8)
+            return Error::from_string_literal("Gzip index contains an access point outside of the file");
+        if (!index.m_access_points.is_empty() && access_point.uncompressed_offset <= index.m_access_points.last().uncompressed_offset)
+            return Error::from_string_literal("Gzip index contains access points out of order");
+        if (history_size > gzip_index_history_size || (access_point.starts_member && history_size != 0))
+            return Error::from_string_literal("Gzip index contains an access point with an invalid history");
+
+        access_point.history = TRY(ByteBuffer::create_uninitialized(history_size));
+        TRY(stream.read_until_filled(access_point.history));
+        TRY(index.m_access_points.try_append(move(access_point)));
+    }
+
+    return index;
+}
+
+ErrorOr<void> GzipIndex::write_to_stream(Stream& stream) const
+{
+    TRY(stream.write_value<LittleEndian<u32>>(gzip_index_magic));
+    TRY(stream.write_value<LittleEndian<u32>>(gzip_index_version));
+    TRY(stream.write_value<LittleEndian<u64>>(m_span));
+    TRY(stream.write_value<LittleEndian<u64>>(m_compressed_size));
+    TRY(stream.write_value<LittleEndian<u64>>(m_uncompressed_size));
+    TRY(stream.write_value<LittleEndian<u32>>(m_last_member_crc32));
+    TRY(stream.write_value<LittleEndian<u32>>(m_last_member_size));
+
+    TRY(stream.write_value<LittleEndian<u64>>(m_access_points.size()));
+    for (auto const& access_point : m_access_points) {
+        TRY(stream.write_value<LittleEndian<u64>>(access_point.uncompressed_offset));
+        TRY(stream.write_value<LittleEndian<u64>>(access_point.compressed_bit_offset));
+        TRY(stream.write_value<u8>(access_point.starts_member));
+        TRY(stream.write_value<LittleEndian<u32>>(access_point.history.size()));
+        TRY(stream.write_until_depleted(access_point.history));
+    }
+
+    return {};
+}
+
+bool GzipIndex::matches(ReadonlyBytes compressed_data) const
+{
+    if (compressed_data.size() != m_compressed_size || compressed_data.size() < 2 * sizeof(u32))
+        return false;
+
+    auto const trailer = compressed_data.slice_from_end(2 * sizeof(u32));
+    return *reinterpret_cast<LittleEndian<u32> const*>(trailer.data()) == m_last_member_crc32
+        && *reinterpret_cast<LittleEndian<u32> const*>(trailer.data() + sizeof(u32)) == m_last_member_size;
+}
+
+GzipIndex::AccessPoint const* GzipIndex::access_point_for(u64 uncompressed_offset) const
+{
+    // Find the first access point after the offset, the one before it is the one we want.
+    size_t low = 0;
+    size_t high = m_access_points.size();
+    while (low < high) {
+        auto middle = low + (high - low) / 2;
+        if (m_access_points[middle].uncompressed_offset <= uncompressed_offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    if (low == 0)
+        return nullptr;
+    return &m_access_points[low - 1];
+}
+
+ErrorOr<NonnullOwnPtr<SeekableGzipDecompressor>> SeekableGzipDecompressor::create(ReadonlyBytes compressed_data, GzipIndex index)
+{
+    if (!index.matches(compressed_data))
+        return Error::from_string_literal("Gzip index does not belong to this file");
+
+    auto decompressor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) SeekableGzipDecompressor(compressed_data, move(index))));
+    TRY(decompressor->start_at(nullptr));
+    return decompressor;
+}
+
+SeekableGzipDecompressor::SeekableGzipDecompressor(ReadonlyBytes compressed_data, GzipIndex index)
+    : m_index(move(index))
+    , m_input(compressed_data)
+{
+}
+
+ErrorOr<void> SeekableGzipDecompressor::start_at(GzipIndex::AccessPoint const* access_point)
+{
+    // The decompressor reads from the bit stream, so it has to go first.
+    m_deflate_stream.clear();
+    m_bit_stream.clear();
+    m_checking_member = false;
+
+    auto const bit_offset = access_point ? access_point->compressed_bit_offset : 0;
+    TRY(m_input.seek(bit_offset / 8, SeekMode::SetPosition));
+    m_bit_stream = TRY(try_make<LittleEndianInputBitStream>(MaybeOwned<Stream>(m_input)));
+    if (bit_offset % 8 != 0)
+        TRY(m_bit_stream->read_bits(bit_offset % 8));
+
+    m_position = access_point ? access_point->uncompressed_offset : 0;
+    if (access_point && !access_point->starts_member)
+        m_deflate_stream = TRY(DeflateDecompressor::construct(MaybeOwned<LittleEndianInputBitStream>(*m_bit_stream), access_point->history));
+
+    return {};
+}
+
+ErrorOr<void> SeekableGzipDecompressor::start_member()
+{
+    TRY(read_member_header(*m_bit_stream));
+    m_deflate_stream = TRY(DeflateDecompressor::construct(MaybeOwned<LittleEndianInputBitStream>(*m_bit_stream)));
+    m_checking_member = true;
+    m_checksum = {};
+    m_member_size = 0;
+    return {};
+}
+
+ErrorOr<void> SeekableGzipDecompressor::finish_member()
+{
+    u32 crc32 = TRY(m_bit_stream->read_value<LittleEndian<u32>>());
+    u32 input_size = TRY(m_bit_stream->read_value<LittleEndian<u32>>());
+
+    if (m_checking_member) {
+        if (crc32 != m_checksum.digest())
+            return Error::from_string_literal("Stored CRC32 does not match the calculated CRC32 of the current member");
+        if (input_size != m_member_size)
+            return Error::from_string_literal("Input size does not match the number of read bytes");
+    }
+
+    m_deflate_stream.clear();
+    m_checking_member = false;
+    return {};
+}
+
+ErrorOr<Bytes> SeekableGzipDecompressor::read_some(Bytes bytes)
+{
+    size_t total_read = 0;
+    while (total_read < bytes.size()) {
+        if (!m_deflate_stream) {
+            if (m_bit_stream->is_eof())
+                break;
+            TRY(start_member());
+            continue;
+        }
+
+        auto data = TRY(m_deflate_stream->read_some(bytes.slice(total_read)));
+        total_read += data.size();
+        m_position += data.size();
+        if (m_checking_member) {
+            m_checksum.update(data);
+            m_member_size += data.size();
+        }
+
+        if (m_deflate_stream->is_eof())
+            TRY(finish_member());
+    }
+
+    return bytes.trim(total_read);
+}
+
+ErrorOr<size_t> SeekableGzipDecompressor::write_some(ReadonlyBytes)
+{
+    return Error::from_errno(EBADF);
+}
+
+bool SeekableGzipDecompressor::is_eof() const
+{
+    return m_position >= m_index.uncompressed_size();
+}
+
+ErrorOr<size_t> SeekableGzipDecompressor::seek(i64 offset, SeekMode mode)
+{
+    i64 target;
+    switch (mode) {
+    case SeekMode::SetPosition:
+        target = offset;
+        break;
+    case SeekMode::FromCurrentPosition:
+        target = static_cast<i64>(m_position) + offset;
+        break;
+    case SeekMode::FromEndPosition:
+        target = static_cast<i64>(m_index.uncompressed_size()) + offset;
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+    if (target < 0 || static_cast<u64>(target) > m_index.uncompressed_size())
+        return Error::from_errno(EINVAL);
+
+    // Start over at an access point if that gets us closer to the target than where we are.
+    auto const* access_point = m_index.access_point_for(target);
+    auto const access_point_offset = access_point ? access_point->uncompressed_offset : 0;
+    if (static_cast<u64>(target) < m_position || access_point_offset > m_position)
+        TRY(start_at(access_point));
+
+    TRY(skip(target - m_position));
+    return m_position;
+}
+
+ErrorOr<void> SeekableGzipDecompressor::skip(u64 count)
+{
+    if (count == 0)
+        return {};
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(min<u64>(count, 256 * KiB)));
+    while (count > 0) {
+        auto data = TRY(read_some(buffer.bytes().trim(count)));
+        if (data.is_empty())
+            return Error::from_string_literal("Gzip data ends before the size recorded in the index");
+        count -= data.size();
+    }
+
+    return {};
+}
+
+ErrorOr<void> SeekableGzipDecompressor::truncate(size_t)
+{
+    return Error::from_errno(EBADF);
+}
+
 GzipCompressor::GzipCompressor(MaybeOwned<Stream> stream)
     : m_output_stream(move(stream))
 {
@@ -199,7 +519,7 @@ ErrorOr<Bytes> GzipCompressor::read_some(Bytes)
     return Error::from_errno(EBADF);
 }
 
-ErrorOr<size_t> GzipCompressor::write_some(ReadonlyBytes bytes)
+ErrorOr<void> GzipCompressor::write_header(Stream& stream)
 {
     BlockHeader header;
     header.identification_1 = 0x1f;
@@ -209,7 +529,13 @@ ErrorOr<size_t> GzipCompressor::write_some(ReadonlyBytes bytes)
     header.modification_time = 0;
     header.extra_flags = 3;      // DEFLATE sets 2 for maximum compression and 4 for minimum compression
     header.operating_system = 3; // unix
-    TRY(m_output_stream->write_until_depleted({ &header, sizeof(header) }));
+    TRY(stream.write_until_depleted({ &header, sizeof(header) }));
+    return {};
+}
+
+ErrorOr<size_t> GzipCompressor::write_some(ReadonlyBytes bytes)
+{
+    TRY(write_header(*m_output_stream));
     auto compressed_stream = TRY(DeflateCompressor::construct(MaybeOwned(*m_output_stream)));
     TRY(compressed_stream->write_until_depleted(bytes));
     TRY(compressed_stream->final_flush());
@@ -246,4 +572,64 @@ ErrorOr<ByteBuffer> GzipCompressor::compress_all(ReadonlyBytes bytes)
     return buffer;
 }
 
+ErrorOr<NonnullOwnPtr<ParallelGzipCompressor>> ParallelGzipCompressor::construct(MaybeOwned<Stream> stream, Optional<size_t> thread_count, size_t chunk_size)
+{
+    TRY(GzipCompressor::write_header(*stream));
+    auto compressor = TRY(ParallelDeflateCompressor::construct(MaybeOwned<Stream>(*stream), DeflateCompressor::CompressionLevel::GOOD, thread_count, chunk_size));
+    return adopt_nonnull_own_or_enomem(new (nothrow) ParallelGzipCompressor(move(stream), move(compressor)));
+}
+
+ParallelGzipCompressor::ParallelGzipCompressor(MaybeOwned<Stream> stream, NonnullOwnPtr<ParallelDeflateCompressor> compressor)
+    : m_output_stream(move(stream))
+    , m_compressor(move(compressor))
+{
+}
+
+ParallelGzipCompressor::~ParallelGzipCompressor()
+{
+    VERIFY(m_finished);
+}
+
+ErrorOr<Bytes> ParallelGzipCompressor::read_some(Bytes)
+{
+    return Error::from_errno(EBADF);
+}
+
+ErrorOr<size_t> ParallelGzipCompressor::write_some(ReadonlyBytes bytes)
+{
+    VERIFY(!m_finished);
+
+    auto n_written = TRY(m_compressor->write_some(bytes));
+    m_crc32.update(bytes.trim(n_written));
+    m_input_size += n_written;
+    return n_written;
+}
+
+bool ParallelGzipCompressor::is_eof() const
+{
+    return true;
+}
+
+bool ParallelGzipCompressor::is_open() const
+{
+    return m_output_stream->is_open();
+}
+
+void ParallelGzipCompressor::close()
+{
+}
+
+ErrorOr<void> ParallelGzipCompressor::finish()
+{
+    VERIFY(!m_finished);
+
+    TRY(m_compressor->final_flush());
+    // The size is stored modulo 2^32.
+    TRY(m_output_stream->write_value<LittleEndian<u32>>(m_crc32.digest()));
+    TRY(m_output_stream->write_value<LittleEndian<u32>>(m_input_size));
+
+    m_finished = true;
+    return {};
+}
+
 }
@@ -7,9 +7,11 @@
 
 #pragma once
 
+#include <AK/MemoryStream.h>
 #include <AK/NonnullOwnPtr.h>
 #include <AK/OwnPtr.h>
 #include <AK/Stream.h>
+#include <AK/Vector.h>
 #include <LibCompress/Deflate.h>
 #include <LibCrypto/Checksum/CRC32.h>
 
@@ -81,6 +83,93 @@ private:
     bool m_eof { false };
 };
 
+// The points in a gzip file that decompression can start from, so that data in the middle of the file can be read
+// without decompressing everything before it. Like zlib's zran.c, a point is recorded at the start of a Deflate block
+// roughly every `span` bytes of output, together with the (up to) 32 KiB of data that the block may refer back to.
+class GzipIndex {
+public:
+    static constexpr u64 default_span = 1 * MiB;
+
+    // An index is stored next to the file it belongs to, with this suffix appended to the name of that file.
+    static constexpr StringView sidecar_suffix = ".gzi"sv;
+
+    struct AccessPoint {
+        u64 uncompressed_offset { 0 };
+        u64 compressed_bit_offset { 0 };
+        // Whether decompression starts with the header of a member, rather than with a Deflate block of one.
+        bool starts_member { false };
+        ByteBuffer history;
+    };
+
+    // Decompresses the whole file once, to find the access points.
+    static ErrorOr<GzipIndex> create(ReadonlyBytes compressed_data, u64 span = default_span);
+
+    static ErrorOr<GzipIndex> read_from_stream(Stream&);
+    ErrorOr<void> write_to_stream(Stream&) const;
+
+    // Whether this index was (most likely) created for `compressed_data`.
+    bool matches(ReadonlyBytes compressed_data) const;
+
+    // Returns the last access point at or before `uncompressed_offset`, or null if decompression has to start at the
+    // beginning of the file.
+    AccessPoint const* access_point_for(u64 uncompressed_offset) const;
+
+    u64 span() const { return m_span; }
+    u64 uncompressed_size() const { return m_uncompressed_size; }
+    ReadonlySpan<AccessPoint> access_points() const { return m_access_points; }
+
+private:
+    GzipIndex() = default;
+
+    u64 m_span { 0 };
+    u64 m_compressed_size { 0 };
+    u64 m_uncompressed_size { 0 };
+
+    // The trailer of the last member, to tell files of the same size apart.
+    u32 m_last_member_crc32 { 0 };
+    u32 m_last_member_size { 0 };
+
+    Vector<AccessPoint> m_access_points;
+};
+
+// Decompresses a gzip file (which has to be in memory, e.g. mapped) with random access. A seek starts decompressing at
+// the closest access point of the index before the new position, unless reading on from the current position is shorter.
+// The checksums of members whose beginning hasn't been decompressed can't be verified.
+class SeekableGzipDecompressor final : public SeekableStream {
+public:
+    static ErrorOr<NonnullOwnPtr<SeekableGzipDecompressor>> create(ReadonlyBytes compressed_data, GzipIndex);
+
+    virtual ErrorOr<Bytes> read_some(Bytes) override;
+    virtual ErrorOr<size_t> write_some(ReadonlyBytes) override;
+    virtual bool is_eof() const override;
+    virtual bool is_open() const override { return true; }
+    virtual void close() override { }
+    virtual ErrorOr<size_t> seek(i64 offset, SeekMode) override;
+    virtual ErrorOr<size_t> tell() const override { return m_position; }
+    virtual ErrorOr<size_t> size() override { return m_index.uncompressed_size(); }
+    virtual ErrorOr<void> truncate(size_t) override;
+
+    GzipIndex const& index() const { return m_index; }
+
+private:
+    SeekableGzipDecompressor(ReadonlyBytes compressed_data, GzipIndex);
+
+    ErrorOr<void> start_at(GzipIndex::AccessPoint const*);
+    ErrorOr<void> start_member();
+    ErrorOr<void> finish_member();
+    ErrorOr<void> skip(u64);
+
+    GzipIndex m_index;
+    FixedMemoryStream m_input;
+    OwnPtr<LittleEndianInputBitStream> m_bit_stream;
+    OwnPtr<DeflateDecompressor> m_deflate_stream;
+    u64 m_position { 0 };
+
+    bool m_checking_member { false };
+    Crypto::Checksum::CRC32 m_checksum;
+    u32 m_member_size { 0 };
+};
+
 class GzipCompressor final : public Stream {
 public:
     GzipCompressor(MaybeOwned<Stream>);
@@ -93,8 +182,33 @@ public:
 
     static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes);
 
+    static ErrorOr<void> write_header(Stream&);
+
+private:
+    MaybeOwned<Stream> m_output_stream;
+};
+
+// Compresses a stream into a single gzip member on several threads at once. See ParallelDeflateCompressor.
+class ParallelGzipCompressor final : public Stream {
+public:
+    static ErrorOr<NonnullOwnPtr<ParallelGzipCompressor>> construct(MaybeOwned<Stream>, Optional<size_t> thread_count = {}, size_t chunk_size = ParallelDeflateCompressor::default_chunk_size);
+    ~ParallelGzipCompressor();
+
+    virtual ErrorOr<Bytes> read_some(Bytes) override;
+    virtual ErrorOr<size_t> write_some(ReadonlyBytes) override;
+    virtual bool is_eof() const override;
+    virtual bool is_open() const override;
+    virtual void close() override;
+    ErrorOr<void> finish();
+
 private:
+    ParallelGzipCompressor(MaybeOwned<Stream>, NonnullOwnPtr<ParallelDeflateCompressor>);
+
+    bool m_finished { false };
     MaybeOwned<Stream> m_output_stream;
+    NonnullOwnPtr<ParallelDeflateCompressor> m_compressor;
+    Crypto::Checksum::CRC32 m_crc32;
+    u32 m_input_size { 0 };
 };
 
 }
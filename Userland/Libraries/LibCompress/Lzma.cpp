@@ -1214,19 +1214,33 @@ void LzmaDecompressor::close()
 
 ErrorOr<NonnullOwnPtr<LzmaCompressor>> LzmaCompressor::create_container(MaybeOwned<Stream> stream, LzmaCompressorOptions const& options)
 {
-    auto dictionary = TRY(try_make<SearchableCircularBuffer>(TRY(SearchableCircularBuffer::create_empty(options.dictionary_size + largest_real_match_length))));
+    auto header = TRY(LzmaHeader::from_compressor_options(options));
+    TRY(stream->write_value(header));
+
+    return TRY(LzmaCompressor::create_raw_stream(move(stream), options));
+}
+
+ErrorOr<NonnullOwnPtr<LzmaCompressor>> LzmaCompressor::create_raw_stream(MaybeOwned<Stream> stream, LzmaCompressorOptions const& options, Optional<MaybeOwned<SearchableCircularBuffer>> dictionary)
+{
+    if (!dictionary.has_value())
+        dictionary = TRY(try_make<SearchableCircularBuffer>(TRY(create_dictionary(options))));
+
+    VERIFY((*dictionary)->capacity() >= options.dictionary_size + largest_real_match_length);
 
     // "The LZMA Decoder uses (1 << (lc + lp)) tables with CProb values, where each table contains 0x300 CProb values."
     auto literal_probabilities = TRY(FixedArray<Probability>::create(literal_probability_table_size * (1 << (options.literal_context_bits + options.literal_position_bits))));
 
-    auto header = TRY(LzmaHeader::from_compressor_options(options));
-    TRY(stream->write_value(header));
-
-    auto compressor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) LzmaCompressor(move(stream), options, move(dictionary), move(literal_probabilities))));
+    auto compressor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) LzmaCompressor(move(stream), options, dictionary.release_value(), move(literal_probabilities))));
 
     return compressor;
 }
 
+ErrorOr<SearchableCircularBuffer> LzmaCompressor::create_dictionary(LzmaCompressorOptions const& options)
+{
+    // The dictionary doubles as the input buffer, so it also has to hold the longest possible match.
+    return SearchableCircularBuffer::create_empty(options.dictionary_size + largest_real_match_length);
+}
+
 LzmaCompressor::LzmaCompressor(MaybeOwned<AK::Stream> stream, Compress::LzmaCompressorOptions options, MaybeOwned<SearchableCircularBuffer> dictionary, FixedArray<Compress::LzmaState::Probability> literal_probabilities)
     : LzmaState(move(literal_probabilities))
     , m_stream(move(stream))
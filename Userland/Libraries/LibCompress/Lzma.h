@@ -217,6 +217,12 @@ public:
     /// Creates a compressor for a standalone LZMA container (.lzma file extension, occasionally known as an LZMA 'archive').
     static ErrorOr<NonnullOwnPtr<LzmaCompressor>> create_container(MaybeOwned<Stream>, LzmaCompressorOptions const&);
 
+    /// Creates a compressor for a raw stream of LZMA-compressed data (to be embedded in other file formats).
+    static ErrorOr<NonnullOwnPtr<LzmaCompressor>> create_raw_stream(MaybeOwned<Stream>, LzmaCompressorOptions const&, Optional<MaybeOwned<SearchableCircularBuffer>> dictionary = {});
+
+    /// Creates a dictionary that can be shared between consecutive raw streams (such as the chunks of an LZMA2 stream).
+    static ErrorOr<SearchableCircularBuffer> create_dictionary(LzmaCompressorOptions const&);
+
     /// Finishes the archive by writing out the remaining data from the range coder.
     ErrorOr<void> flush();
 
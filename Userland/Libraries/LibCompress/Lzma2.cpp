@@ -6,6 +6,7 @@
 
 #include <AK/ConstrainedStream.h>
 #include <AK/Endian.h>
+#include <AK/MemoryStream.h>
 #include <LibCompress/Lzma2.h>
 
 namespace Compress {
@@ -156,7 +157,7 @@ ErrorOr<Bytes> Lzma2Decompressor::read_some(Bytes bytes)
 
         auto relevant_data = result;
         if (relevant_data.size() > m_dictionary.capacity())
-            relevant_data = relevant_data.slice(relevant_data.size() - m_dictionary.capacity(), relevant_data.size());
+            relevant_data = relevant_data.slice(relevant_data.size() - m_dictionary.capacity());
 
         auto written_bytes = m_dictionary.write(relevant_data);
         VERIFY(written_bytes == relevant_data.size());
@@ -186,4 +187,134 @@ void Lzma2Decompressor::close()
 {
 }
 
+ErrorOr<NonnullOwnPtr<Lzma2Compressor>> Lzma2Compressor::create_raw_stream(MaybeOwned<Stream> stream, LzmaCompressorOptions const& options)
+{
+    auto dictionary = TRY(LzmaCompressor::create_dictionary(options));
+    auto chunk = TRY(ByteBuffer::create_uninitialized(maximum_uncompressed_chunk_size));
+    return TRY(adopt_nonnull_own_or_enomem(new (nothrow) Lzma2Compressor(move(stream), options, move(dictionary), move(chunk))));
+}
+
+Lzma2Compressor::Lzma2Compressor(MaybeOwned<Stream> stream, LzmaCompressorOptions options, SearchableCircularBuffer dictionary, ByteBuffer chunk)
+    : m_stream(move(stream))
+    , m_options(move(options))
+    , m_dictionary(move(dictionary))
+    , m_chunk(move(chunk))
+{
+}
+
+Lzma2Compressor::~Lzma2Compressor()
+{
+    if (!m_has_flushed_data) {
+        // Note: We need a better API for specifying things like this.
+        flush().release_value_but_fixme_should_propagate_errors();
+    }
+}
+
+ErrorOr<Bytes> Lzma2Compressor::read_some(Bytes)
+{
+    return Error::from_errno(EBADF);
+}
+
+ErrorOr<size_t> Lzma2Compressor::write_some(ReadonlyBytes bytes)
+{
+    if (m_has_flushed_data)
+        return Error::from_string_literal("Tried to write to a flushed LZMA2 stream");
+
+    auto written_bytes = bytes.copy_trimmed_to(m_chunk.bytes().slice(m_chunk_size, m_next_chunk_size - m_chunk_size));
+    m_chunk_size += written_bytes;
+
+    if (m_chunk_size == m_next_chunk_size)
+        TRY(write_chunk());
+
+    return written_bytes;
+}
+
+ErrorOr<void> Lzma2Compressor::write_chunk()
+{
+    auto chunk = m_chunk.bytes().trim(m_chunk_size);
+    if (chunk.is_empty())
+        return {};
+
+    AllocatingMemoryStream compressed_stream;
+    auto chunk_options = m_options;
+    chunk_options.uncompressed_size = chunk.size();
+    {
+        // The encoder gets a fresh state for each chunk, but it shares the dictionary with the previous chunks.
+        auto lzma_stream = TRY(LzmaCompressor::create_raw_stream(MaybeOwned<Stream>(compressed_stream), chunk_options, MaybeOwned<SearchableCircularBuffer>(m_dictionary)));
+        TRY(lzma_stream->write_until_depleted(chunk));
+    }
+    auto compressed_size = compressed_stream.used_buffer_size();
+
+    if (compressed_size <= maximum_chunk_data_size && compressed_size < chunk.size()) {
+        // LZMA chunk: "Bits 5-6 for LZMA chunks can be:
+        //  - 3: state reset, properties reset using properties byte, dictionary reset
+        //  - 2: state reset, properties reset using properties byte"
+        u8 const reset_indicator = m_dictionary_initialized ? 2 : 3;
+        u32 const encoded_uncompressed_size = chunk.size() - 1;
+        TRY(m_stream->write_value<u8>(0x80 | (reset_indicator << 5) | (encoded_uncompressed_size >> 16)));
+        TRY(m_stream->write_value<BigEndian<u16>>(encoded_uncompressed_size & 0xFFFF));
+        TRY(m_stream->write_value<BigEndian<u16>>(compressed_size - 1));
+        TRY(m_stream->write_value<u8>(TRY(LzmaHeader::encode_model_properties({
+            .literal_context_bits = m_options.literal_context_bits,
+            .literal_position_bits = m_options.literal_position_bits,
+            .position_bits = m_options.position_bits,
+        }))));
+
+        auto compressed_data = TRY(ByteBuffer::create_uninitialized(compressed_size));
+        TRY(compressed_stream.read_until_filled(compressed_data));
+        TRY(m_stream->write_until_depleted(compressed_data));
+    } else {
+        // The data doesn't compress well enough, so store it in uncompressed chunks instead. The dictionary already
+        // holds the data either way.
+        for (size_t offset = 0; offset < chunk.size(); offset += maximum_chunk_data_size) {
+            auto data = chunk.slice(offset, min(maximum_chunk_data_size, chunk.size() - offset));
+            // " - 1 denotes a dictionary reset followed by an uncompressed chunk
+            //   - 2 denotes an uncompressed chunk without a dictionary reset"
+            TRY(m_stream->write_value<u8>(m_dictionary_initialized ? 2 : 1));
+            TRY(m_stream->write_value<BigEndian<u16>>(data.size() - 1));
+            TRY(m_stream->write_until_depleted(data));
+        }
+    }
+    m_dictionary_initialized = true;
+
+    // Aim for compressed chunks that are three quarters full, so that the next chunk most likely still fits.
+    auto expected_chunk_size = chunk.size() * (maximum_chunk_data_size * 3 / 4) / max<size_t>(compressed_size, 1);
+    m_next_chunk_size = clamp(expected_chunk_size, maximum_chunk_data_size, maximum_uncompressed_chunk_size);
+    m_chunk_size = 0;
+
+    return {};
+}
+
+ErrorOr<void> Lzma2Compressor::flush()
+{
+    if (m_has_flushed_data)
+        return Error::from_string_literal("Flushed an LZMA2 stream twice");
+
+    TRY(write_chunk());
+
+    // " - 0 denotes the end of the file"
+    TRY(m_stream->write_value<u8>(0));
+
+    m_has_flushed_data = true;
+    return {};
+}
+
+bool Lzma2Compressor::is_eof() const
+{
+    return true;
+}
+
+bool Lzma2Compressor::is_open() const
+{
+    return !m_has_flushed_data;
+}
+
+void Lzma2Compressor::close()
+{
+    if (!m_has_flushed_data) {
+        // Note: We need a better API for specifying things like this.
+        flush().release_value_but_fixme_should_propagate_errors();
+    }
+}
+
 }
@@ -43,4 +43,44 @@ private:
     Optional<LzmaDecompressorOptions> m_last_lzma_options;
 };
 
+class Lzma2Compressor : public Stream {
+public:
+    /// Creates a compressor that does not write the leading byte indicating the dictionary size.
+    static ErrorOr<NonnullOwnPtr<Lzma2Compressor>> create_raw_stream(MaybeOwned<Stream>, LzmaCompressorOptions const&);
+
+    /// Compresses the remaining data and finishes the stream with an end marker.
+    ErrorOr<void> flush();
+
+    virtual ErrorOr<Bytes> read_some(Bytes) override;
+    virtual ErrorOr<size_t> write_some(ReadonlyBytes) override;
+    virtual bool is_eof() const override;
+    virtual bool is_open() const override;
+    virtual void close() override;
+
+    virtual ~Lzma2Compressor();
+
+private:
+    // "A 16-bit big-endian value encoding the compressed size minus one" limits LZMA chunks to 64 KiB of compressed
+    // data, and uncompressed chunks to 64 KiB of data.
+    static constexpr size_t maximum_chunk_data_size = 64 * KiB;
+    // The uncompressed size of an LZMA chunk is encoded in 21 bits.
+    static constexpr size_t maximum_uncompressed_chunk_size = 2 * MiB;
+
+    Lzma2Compressor(MaybeOwned<Stream>, LzmaCompressorOptions, SearchableCircularBuffer dictionary, ByteBuffer chunk);
+
+    ErrorOr<void> write_chunk();
+
+    MaybeOwned<Stream> m_stream;
+    LzmaCompressorOptions m_options;
+    SearchableCircularBuffer m_dictionary;
+    bool m_dictionary_initialized { false };
+    bool m_has_flushed_data { false };
+
+    // Each LZMA chunk resets the state of the encoder, so chunks should be as large as possible while their compressed
+    // data still fits into a single chunk. The size of the next chunk is estimated from the compression ratio so far.
+    ByteBuffer m_chunk;
+    size_t m_chunk_size { 0 };
+    size_t m_next_chunk_size { maximum_chunk_data_size };
+};
+
 }
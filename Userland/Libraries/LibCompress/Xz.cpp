@@ -4,11 +4,15 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/ByteBuffer.h>
+#include <AK/Checked.h>
 #include <AK/MemoryStream.h>
 #include <LibCompress/Lzma2.h>
 #include <LibCompress/Xz.h>
+#include <LibCore/System.h>
 #include <LibCrypto/Checksum/CRC32.h>
+#include <LibThreading/Thread.h>
 
 namespace Compress {
 
@@ -44,6 +48,18 @@ ErrorOr<XzMultibyteInteger> XzMultibyteInteger::read_from_stream(Stream& stream)
     return XzMultibyteInteger { result };
 }
 
+ErrorOr<void> XzMultibyteInteger::write_to_stream(Stream& stream) const
+{
+    // See read_from_stream() for the encoding.
+    u64 value = m_value;
+    while (value >= 0x80) {
+        TRY(stream.write_value<u8>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    TRY(stream.write_value<u8>(value));
+    return {};
+}
+
 ErrorOr<void> XzStreamHeader::validate() const
 {
     // 2.1.1.1. Header Magic Bytes:
@@ -161,6 +177,14 @@ u32 XzFilterLzma2Properties::dictionary_size() const
     return dictionary_size;
 }
 
+XzFilterLzma2Properties XzFilterLzma2Properties::for_minimum_dictionary_size(u32 minimum_dictionary_size)
+{
+    XzFilterLzma2Properties properties { .encoded_dictionary_size = 0, .reserved = 0 };
+    while (properties.dictionary_size() < minimum_dictionary_size)
+        properties.encoded_dictionary_size++;
+    return properties;
+}
+
 u32 XzFilterDeltaProperties::distance() const
 {
     // "The Properties byte indicates the delta distance, which can be
@@ -812,4 +836,556 @@ void XzDecompressor::close()
 {
 }
 
+// Calls `callback` for every index in [0, count), on up to `thread_count` threads (including the calling thread).
+template<typename Callback>
+static void for_each_index_in_parallel(size_t count, size_t thread_count, Callback callback)
+{
+    Atomic<size_t> next_index { 0 };
+    auto process_indices = [&] {
+        for (size_t index; (index = next_index.fetch_add(1)) < count;)
+            callback(index);
+    };
+
+    auto worker_count = min(thread_count, count);
+    Vector<NonnullRefPtr<Threading::Thread>> workers;
+    for (size_t i = 1; i < worker_count; ++i) {
+        // If no more threads can be created, the threads that are already running do the remaining work.
+        auto worker = Threading::Thread::try_create([&]() -> intptr_t {
+            process_indices();
+            return 0;
+        },
+            "XZ worker"sv);
+        if (worker.is_error() || workers.try_append(worker.value()).is_error())
+            break;
+        worker.value()->start();
+    }
+    process_indices();
+    for (auto& worker : workers)
+        (void)worker->join();
+}
+
+// Finds all Blocks of all Streams by walking the file backwards from Stream Footer to Index to Stream Header.
+static ErrorOr<Vector<XzBlockLocation>> locate_xz_blocks(ReadonlyBytes bytes)
+{
+    if (bytes.size() % 4 != 0)
+        return Error::from_string_literal("XZ file size is not a multiple of four bytes");
+
+    Vector<Vector<XzBlockLocation>> streams;
+    size_t end = bytes.size();
+    while (end > 0) {
+        // 2.2. Stream Padding:
+        // "Stream Padding MUST contain only null bytes. [...] the size of Stream Padding MUST be a multiple of four bytes."
+        while (end >= 4 && bytes.slice(end - 4, 4) == ReadonlyBytes { "\0\0\0\0", 4 })
+            end -= 4;
+        if (end == 0 && !streams.is_empty())
+            break;
+
+        if (end < sizeof(XzStreamHeader) + sizeof(XzStreamFooter))
+            return Error::from_string_literal("XZ file is too small to contain a stream");
+
+        XzStreamFooter stream_footer {};
+        bytes.slice(end - sizeof(XzStreamFooter), sizeof(XzStreamFooter)).copy_to({ &stream_footer, sizeof(stream_footer) });
+        TRY(stream_footer.validate());
+
+        // 2.1.2.2. Backward Size: "[...] the size of the Index field"
+        size_t const index_size = stream_footer.backward_size();
+        if (index_size > end - sizeof(XzStreamHeader) - sizeof(XzStreamFooter))
+            return Error::from_string_literal("XZ stream footer points to an index outside of the file");
+        size_t const index_start = end - sizeof(XzStreamFooter) - index_size;
+        auto const index = bytes.slice(index_start, index_size);
+
+        FixedMemoryStream index_stream { index };
+        if (TRY(index_stream.read_value<u8>()) != 0x00)
+            return Error::from_string_literal("XZ stream footer does not point to an index");
+
+        Vector<XzBlockLocation> blocks;
+        u64 const number_of_records = TRY(index_stream.read_value<XzMultibyteInteger>());
+        u64 blocks_size = 0;
+        for (u64 i = 0; i < number_of_records; i++) {
+            u64 const unpadded_size = TRY(index_stream.read_value<XzMultibyteInteger>());
+            u64 const uncompressed_size = TRY(index_stream.read_value<XzMultibyteInteger>());
+            if (unpadded_size < 5 || unpadded_size > index_start)
+                return Error::from_string_literal("XZ index contains a record with an invalid unpadded size");
+            TRY(blocks.try_append({ .data = {}, .stream_flags = stream_footer.flags, .unpadded_size = unpadded_size, .uncompressed_size = uncompressed_size }));
+            blocks_size += align_up_to(unpadded_size, 4);
+            if (blocks_size > index_start)
+                return Error::from_string_literal("XZ index contains more blocks than fit into the file");
+        }
+
+        while (MUST(index_stream.tell()) % 4 != 0) {
+            if (TRY(index_stream.read_value<u8>()) != 0)
+                return Error::from_string_literal("XZ index contains a non-null padding byte");
+        }
+
+        auto const index_size_without_crc32 = MUST(index_stream.tell());
+        u32 const index_crc32 = TRY(index_stream.read_value<LittleEndian<u32>>());
+        if (Crypto::Checksum::CRC32(index.trim(index_size_without_crc32)).digest() != index_crc32)
+            return Error::from_string_literal("XZ index has an invalid CRC32 checksum");
+        if (!index_stream.is_eof())
+            return Error::from_string_literal("XZ index size does not match the stored size in the stream footer");
+
+        if (blocks_size + sizeof(XzStreamHeader) > index_start)
+            return Error::from_string_literal("XZ index contains more blocks than fit into the file");
+        size_t const stream_start = index_start - blocks_size - sizeof(XzStreamHeader);
+
+        XzStreamHeader stream_header {};
+        bytes.slice(stream_start, sizeof(XzStreamHeader)).copy_to({ &stream_header, sizeof(stream_header) });
+        TRY(stream_header.validate());
+        if (ReadonlyBytes { &stream_header.flags, sizeof(XzStreamFlags) } != ReadonlyBytes { &stream_footer.flags, sizeof(XzStreamFlags) })
+            return Error::from_string_literal("XZ stream header flags don't match the stream footer");
+
+        size_t block_start = stream_start + sizeof(XzStreamHeader);
+        for (auto& block : blocks) {
+            auto const padded_size = align_up_to(block.unpadded_size, 4);
+            block.data = bytes.slice(block_start, padded_size);
+            block_start += padded_size;
+        }
+
+        TRY(streams.try_append(move(blocks)));
+        end = stream_start;
+    }
+
+    Vector<XzBlockLocation> blocks;
+    for (auto& stream_blocks : streams.in_reverse())
+        TRY(blocks.try_extend(stream_blocks));
+
+    u64 uncompressed_offset = 0;
+    for (auto& block : blocks) {
+        block.uncompressed_offset = uncompressed_offset;
+        if (Checked<u64>::addition_would_overflow(uncompressed_offset, block.uncompressed_size))
+            return Error::from_string_literal("XZ index contains blocks that are too large");
+        uncompressed_offset += block.uncompressed_size;
+    }
+
+    return blocks;
+}
+
+ErrorOr<void> XzDecompressor::decompress_all_in_parallel(ReadonlyBytes bytes, Stream& output, Optional<size_t> thread_count)
+{
+    auto const blocks = TRY(locate_xz_blocks(bytes));
+    auto const resolved_thread_count = max<size_t>(thread_count.value_or(Core::System::hardware_concurrency()), 1);
+
+    auto decode_block = [](XzBlockLocation const& block, Stream& block_output) -> ErrorOr<void> {
+        auto decompressor = TRY(create_for_single_block(block));
+        return decompressor->decode_single_block(block_output, block.unpadded_size, block.uncompressed_size);
+    };
+
+    // Decode as many Blocks at a time as fit into a batch, so that all threads have work, while the amount of decoded
+    // data that is held in memory stays bounded.
+    static constexpr u64 maximum_batch_size = 64 * MiB;
+
+    for (size_t batch_start = 0; batch_start < blocks.size();) {
+        if (blocks[batch_start].uncompressed_size > maximum_batch_size) {
+            TRY(decode_block(blocks[batch_start], output));
+            batch_start++;
+            continue;
+        }
+
+        Vector<size_t> output_offsets;
+        u64 batch_size = 0;
+        size_t batch_end = batch_start;
+        for (; batch_end < blocks.size() && blocks[batch_end].uncompressed_size <= maximum_batch_size - batch_size; batch_end++) {
+            TRY(output_offsets.try_append(batch_size));
+            batch_size += blocks[batch_end].uncompressed_size;
+        }
+
+        auto batch = TRY(ByteBuffer::create_uninitialized(batch_size));
+        Vector<Optional<Error>> errors;
+        TRY(errors.try_resize(batch_end - batch_start));
+        for_each_index_in_parallel(batch_end - batch_start, resolved_thread_count, [&](size_t index) {
+            auto const& block = blocks[batch_start + index];
+            FixedMemoryStream block_output { batch.bytes().slice(output_offsets[index], block.uncompressed_size) };
+            auto result = decode_block(block, block_output);
+            if (result.is_error())
+                errors[index] = result.release_error();
+        });
+
+        for (auto& error : errors) {
+            if (error.has_value())
+                return error.release_value();
+        }
+
+        TRY(output.write_until_depleted(batch));
+        batch_start = batch_end;
+    }
+
+    return {};
+}
+
+ErrorOr<NonnullOwnPtr<XzDecompressor>> XzDecompressor::create_for_single_block(XzBlockLocation const& block)
+{
+    auto decompressor = TRY(XzDecompressor::create(TRY(try_make<FixedMemoryStream>(block.data))));
+    decompressor->m_stream_flags = block.stream_flags;
+    decompressor->m_found_first_stream_header = true;
+
+    auto const encoded_block_header_size = TRY(decompressor->m_stream->read_value<u8>());
+    if (encoded_block_header_size == 0x00)
+        return Error::from_string_literal("XZ index record does not point to a block");
+
+    TRY(decompressor->load_next_block(encoded_block_header_size));
+    return decompressor;
+}
+
+ErrorOr<Bytes> XzDecompressor::read_from_single_block(Bytes bytes, u64 uncompressed_size)
+{
+    auto data = TRY((*m_current_block_stream)->read_some(bytes));
+    m_current_block_uncompressed_size += data.size();
+    if (m_current_block_uncompressed_size > uncompressed_size)
+        return Error::from_string_literal("Uncompressed size of XZ Block does not match the Index");
+    return data;
+}
+
+ErrorOr<void> XzDecompressor::decode_single_block(Stream& output, u64 unpadded_size, u64 uncompressed_size)
+{
+    auto buffer = TRY(ByteBuffer::create_uninitialized(64 * KiB));
+    while (!(*m_current_block_stream)->is_eof()) {
+        auto data = TRY(read_from_single_block(buffer, uncompressed_size));
+        TRY(output.write_until_depleted(data));
+    }
+
+    return finish_single_block(unpadded_size, uncompressed_size);
+}
+
+ErrorOr<void> XzDecompressor::finish_single_block(u64 unpadded_size, u64 uncompressed_size)
+{
+    TRY(finish_current_block());
+
+    // 4.3. List of Records:
+    // "If the decoder has decoded all the Blocks of the Stream, it
+    //  MUST verify that the contents of the Records match the real
+    //  Unpadded Size and Uncompressed Size of the respective Blocks."
+    if (m_processed_blocks.last().uncompressed_size != uncompressed_size)
+        return Error::from_string_literal("Uncompressed size of XZ Block does not match the Index");
+
+    if (m_processed_blocks.last().unpadded_size != unpadded_size)
+        return Error::from_string_literal("Unpadded size of XZ Block does not match the Index");
+
+    return {};
+}
+
+ErrorOr<NonnullOwnPtr<SeekableXzDecompressor>> SeekableXzDecompressor::create(ReadonlyBytes bytes)
+{
+    auto blocks = TRY(locate_xz_blocks(bytes));
+    auto const uncompressed_size = blocks.is_empty() ? 0 : blocks.last().uncompressed_offset + blocks.last().uncompressed_size;
+    return adopt_nonnull_own_or_enomem(new (nothrow) SeekableXzDecompressor(move(blocks), uncompressed_size));
+}
+
+SeekableXzDecompressor::SeekableXzDecompressor(Vector<XzBlockLocation> blocks, u64 uncompressed_size)
+    : m_blocks(move(blocks))
+    , m_uncompressed_size(uncompressed_size)
+{
+}
+
+ErrorOr<Bytes> SeekableXzDecompressor::read_some(Bytes bytes)
+{
+    size_t total_read = 0;
+    while (total_read < bytes.size() && m_block_index < m_blocks.size()) {
+        auto const& block = m_blocks[m_block_index];
+        if (!m_block_decompressor)
+            m_block_decompressor = TRY(XzDecompressor::create_for_single_block(block));
+
+        if (!(*m_block_decompressor->m_current_block_stream)->is_eof()) {
+            auto data = TRY(m_block_decompressor->read_from_single_block(bytes.slice(total_read), block.uncompressed_size));
+            total_read += data.size();
+            m_position += data.size();
+        }
+
+        if ((*m_block_decompressor->m_current_block_stream)->is_eof()) {
+            TRY(m_block_decompressor->finish_single_block(block.unpadded_size, block.uncompressed_size));
+            m_block_decompressor.clear();
+            m_block_index++;
+        }
+    }
+
+    return bytes.trim(total_read);
+}
+
+ErrorOr<size_t> SeekableXzDecompressor::write_some(ReadonlyBytes)
+{
+    return Error::from_errno(EBADF);
+}
+
+bool SeekableXzDecompressor::is_eof() const
+{
+    return m_position >= m_uncompressed_size;
+}
+
+ErrorOr<size_t> SeekableXzDecompressor::seek(i64 offset, SeekMode mode)
+{
+    i64 target;
+    switch (mode) {
+    case SeekMode::SetPosition:
+        target = offset;
+        break;
+    case SeekMode::FromCurrentPosition:
+        target = static_cast<i64>(m_position) + offset;
+        break;
+    case SeekMode::FromEndPosition:
+        target = static_cast<i64>(m_uncompressed_size) + offset;
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+    if (target < 0 || static_cast<u64>(target) > m_uncompressed_size)
+        return Error::from_errno(EINVAL);
+
+    if (static_cast<u64>(target) == m_uncompressed_size) {
+        m_block_decompressor.clear();
+        m_block_index = m_blocks.size();
+        m_position = target;
+        return m_position;
+    }
+
+    // Find the last Block that starts at or before the target, which is the one that holds it.
+    size_t low = 0;
+    size_t high = m_blocks.size();
+    while (low < high) {
+        auto middle = low + (high - low) / 2;
+        if (m_blocks[middle].uncompressed_offset <= static_cast<u64>(target))
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    VERIFY(low > 0);
+    auto const block_index = low - 1;
+
+    if (block_index != m_block_index || static_cast<u64>(target) < m_position) {
+        m_block_decompressor.clear();
+        m_block_index = block_index;
+        m_position = m_blocks[block_index].uncompressed_offset;
+    }
+
+    TRY(skip(target - m_position));
+    return m_position;
+}
+
+ErrorOr<void> SeekableXzDecompressor::skip(u64 count)
+{
+    if (count == 0)
+        return {};
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(min<u64>(count, 64 * KiB)));
+    while (count > 0) {
+        auto data = TRY(read_some(buffer.bytes().trim(count)));
+        if (data.is_empty())
+            return Error::from_string_literal("XZ data ends before the size recorded in the Index");
+        count -= data.size();
+    }
+
+    return {};
+}
+
+ErrorOr<void> SeekableXzDecompressor::truncate(size_t)
+{
+    return Error::from_errno(EBADF);
+}
+
+static constexpr XzStreamFlags xz_compressor_stream_flags {
+    .reserved = 0,
+    .check_type = XzStreamCheckType::CRC32,
+    .reserved_bits = 0,
+};
+
+ErrorOr<NonnullOwnPtr<XzCompressor>> XzCompressor::create(MaybeOwned<Stream> stream, Optional<size_t> thread_count, size_t block_size)
+{
+    VERIFY(block_size > 0);
+    auto const resolved_thread_count = max<size_t>(thread_count.value_or(Core::System::hardware_concurrency()), 1);
+    auto buffer = TRY(ByteBuffer::create_uninitialized(resolved_thread_count * block_size));
+
+    // 2.1.1. Stream Header
+    XzStreamHeader stream_header {
+        .magic = { 0xFD, '7', 'z', 'X', 'Z', 0x00 },
+        .flags = xz_compressor_stream_flags,
+        .flags_crc32 = Crypto::Checksum::CRC32({ &xz_compressor_stream_flags, sizeof(xz_compressor_stream_flags) }).digest(),
+    };
+    TRY(stream->write_value(stream_header));
+
+    return adopt_nonnull_own_or_enomem(new (nothrow) XzCompressor(move(stream), resolved_thread_count, block_size, move(buffer)));
+}
+
+XzCompressor::XzCompressor(MaybeOwned<Stream> stream, size_t thread_count, size_t block_size, ByteBuffer buffer)
+    : m_stream(move(stream))
+    , m_thread_count(thread_count)
+    , m_block_size(block_size)
+    , m_buffer(move(buffer))
+{
+}
+
+XzCompressor::~XzCompressor()
+{
+    if (!m_finished) {
+        // Note: We need a better API for specifying things like this.
+        finish().release_value_but_fixme_should_propagate_errors();
+    }
+}
+
+ErrorOr<ByteBuffer> XzCompressor::compress_all(ReadonlyBytes bytes, Optional<size_t> thread_count, size_t block_size)
+{
+    AllocatingMemoryStream output_stream;
+    auto xz_stream = TRY(XzCompressor::create(MaybeOwned<Stream>(output_stream), thread_count, block_size));
+    TRY(xz_stream->write_until_depleted(bytes));
+    TRY(xz_stream->finish());
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(output_stream.used_buffer_size()));
+    TRY(output_stream.read_until_filled(buffer));
+    return buffer;
+}
+
+ErrorOr<XzCompressor::CompressedBlock> XzCompressor::compress_block(ReadonlyBytes bytes, size_t block_size)
+{
+    // The dictionary never needs to be larger than a Block.
+    auto const lzma2_properties = XzFilterLzma2Properties::for_minimum_dictionary_size(min(block_size, NumericLimits<u32>::max()));
+
+    AllocatingMemoryStream compressed_stream;
+    {
+        LzmaCompressorOptions options {};
+        options.dictionary_size = lzma2_properties.dictionary_size();
+        auto lzma2_stream = TRY(Lzma2Compressor::create_raw_stream(MaybeOwned<Stream>(compressed_stream), options));
+        TRY(lzma2_stream->write_until_depleted(bytes));
+        TRY(lzma2_stream->flush());
+    }
+    auto const compressed_size = compressed_stream.used_buffer_size();
+
+    // 3.1. Block Header
+    AllocatingMemoryStream header_stream;
+    TRY(header_stream.write_value<u8>(0)); // The Block Header Size is filled in below.
+    TRY(header_stream.write_value(XzBlockFlags {
+        .encoded_number_of_filters = 0,
+        .reserved = 0,
+        .compressed_size_present = true,
+        .uncompressed_size_present = true,
+    }));
+    TRY(header_stream.write_value(XzMultibyteInteger { compressed_size }));
+    TRY(header_stream.write_value(XzMultibyteInteger { bytes.size() }));
+    // 5.3.1. LZMA2
+    TRY(header_stream.write_value(XzMultibyteInteger { 0x21 }));
+    TRY(header_stream.write_value(XzMultibyteInteger { sizeof(lzma2_properties) }));
+    TRY(header_stream.write_value(lzma2_properties));
+
+    // 3.1.6. Header Padding and 3.1.7. CRC32
+    auto const block_header_size = align_up_to(header_stream.used_buffer_size() + sizeof(u32), 4);
+    auto block = TRY(ByteBuffer::create_zeroed(block_header_size - sizeof(u32)));
+    TRY(header_stream.read_until_filled(block.bytes().trim(header_stream.used_buffer_size())));
+    block[0] = block_header_size / 4 - 1;
+    LittleEndian<u32> const header_crc32 = Crypto::Checksum::CRC32(block.bytes()).digest();
+    TRY(block.try_append(&header_crc32, sizeof(header_crc32)));
+
+    // 3.2. Compressed Data
+    TRY(compressed_stream.read_until_filled(TRY(block.get_bytes_for_writing(compressed_size))));
+
+    // 3.3. Block Padding
+    auto const unpadded_size = block.size() + sizeof(u32);
+    while (block.size() % 4 != 0)
+        TRY(block.try_append(0));
+
+    // 3.4. Check
+    LittleEndian<u32> const check = Crypto::Checksum::CRC32(bytes).digest();
+    TRY(block.try_append(&check, sizeof(check)));
+
+    return CompressedBlock { .data = move(block), .unpadded_size = unpadded_size };
+}
+
+ErrorOr<void> XzCompressor::compress_buffered_blocks()
+{
+    auto const buffered_data = m_buffer.bytes().trim(m_buffered_size);
+    auto const block_count = ceil_div(buffered_data.size(), m_block_size);
+
+    Vector<Optional<ErrorOr<CompressedBlock>>> compressed_blocks;
+    TRY(compressed_blocks.try_resize(block_count));
+    for_each_index_in_parallel(block_count, m_thread_count, [&](size_t index) {
+        auto block_data = buffered_data.slice(index * m_block_size, min(m_block_size, buffered_data.size() - index * m_block_size));
+        compressed_blocks[index] = compress_block(block_data, m_block_size);
+    });
+
+    for (size_t i = 0; i < block_count; i++) {
+        auto compressed_block = TRY(compressed_blocks[i].release_value());
+        TRY(m_stream->write_until_depleted(compressed_block.data));
+        TRY(m_blocks.try_append({
+            .uncompressed_size = min(m_block_size, buffered_data.size() - i * m_block_size),
+            .unpadded_size = compressed_block.unpadded_size,
+        }));
+    }
+
+    m_buffered_size = 0;
+    return {};
+}
+
+ErrorOr<Bytes> XzCompressor::read_some(Bytes)
+{
+    return Error::from_errno(EBADF);
+}
+
+ErrorOr<size_t> XzCompressor::write_some(ReadonlyBytes bytes)
+{
+    if (m_finished)
+        return Error::from_string_literal("Tried to write to a finished XZ stream");
+
+    auto written_bytes = bytes.copy_trimmed_to(m_buffer.bytes().slice(m_buffered_size));
+    m_buffered_size += written_bytes;
+
+    if (m_buffered_size == m_buffer.size())
+        TRY(compress_buffered_blocks());
+
+    return written_bytes;
+}
+
+ErrorOr<void> XzCompressor::finish()
+{
+    if (m_finished)
+        return Error::from_string_literal("Finished an XZ stream twice");
+    m_finished = true;
+
+    TRY(compress_buffered_blocks());
+
+    // 4. Index
+    AllocatingMemoryStream index_stream;
+    TRY(index_stream.write_value<u8>(0x00));
+    TRY(index_stream.write_value(XzMultibyteInteger { m_blocks.size() }));
+    for (auto const& block : m_blocks) {
+        TRY(index_stream.write_value(XzMultibyteInteger { block.unpadded_size }));
+        TRY(index_stream.write_value(XzMultibyteInteger { block.uncompressed_size }));
+    }
+    while (index_stream.used_buffer_size() % 4 != 0)
+        TRY(index_stream.write_value<u8>(0));
+
+    auto index = TRY(ByteBuffer::create_uninitialized(index_stream.used_buffer_size()));
+    TRY(index_stream.read_until_filled(index));
+    TRY(m_stream->write_until_depleted(index));
+    TRY(m_stream->write_value<LittleEndian<u32>>(Crypto::Checksum::CRC32(index.bytes()).digest()));
+
+    // 2.1.2. Stream Footer
+    XzStreamFooter stream_footer {
+        .size_and_flags_crc32 = 0,
+        .encoded_backward_size = static_cast<u32>((index.size() + sizeof(u32)) / 4 - 1),
+        .flags = xz_compressor_stream_flags,
+        .magic = { 'Y', 'Z' },
+    };
+    Crypto::Checksum::CRC32 footer_crc32;
+    footer_crc32.update({ &stream_footer.encoded_backward_size, sizeof(stream_footer.encoded_backward_size) });
+    footer_crc32.update({ &stream_footer.flags, sizeof(stream_footer.flags) });
+    stream_footer.size_and_flags_crc32 = footer_crc32.digest();
+    TRY(m_stream->write_value(stream_footer));
+
+    return {};
+}
+
+bool XzCompressor::is_eof() const
+{
+    return true;
+}
+
+bool XzCompressor::is_open() const
+{
+    return !m_finished;
+}
+
+void XzCompressor::close()
+{
+    if (!m_finished) {
+        // Note: We need a better API for specifying things like this.
+        finish().release_value_but_fixme_should_propagate_errors();
+    }
+}
+
 }
@@ -35,6 +35,7 @@ public:
     constexpr operator u64() const { return m_value; }
 
     static ErrorOr<XzMultibyteInteger> read_from_stream(Stream& stream);
+    ErrorOr<void> write_to_stream(Stream& stream) const;
 
 private:
     u64 m_value { 0 };
@@ -96,6 +97,9 @@ struct [[gnu::packed]] XzFilterLzma2Properties {
 
     ErrorOr<void> validate() const;
     u32 dictionary_size() const;
+
+    // Returns the properties for the smallest dictionary size that is at least `minimum_dictionary_size`.
+    static XzFilterLzma2Properties for_minimum_dictionary_size(u32 minimum_dictionary_size);
 };
 static_assert(sizeof(XzFilterLzma2Properties) == 1);
 
@@ -152,10 +156,27 @@ private:
     CircularBuffer m_buffer;
 };
 
+// Where a Block of a file is, as found through the Index of its Stream.
+struct XzBlockLocation {
+    // The whole Block, including the Block Padding.
+    ReadonlyBytes data;
+    XzStreamFlags stream_flags;
+    u64 unpadded_size {};
+    u64 uncompressed_size {};
+    // Where the data of the Block starts in the decompressed file.
+    u64 uncompressed_offset {};
+};
+
 class XzDecompressor : public Stream {
+    friend class SeekableXzDecompressor;
+
 public:
     static ErrorOr<NonnullOwnPtr<XzDecompressor>> create(MaybeOwned<Stream>);
 
+    /// Decompresses a whole file (which has to be in memory, e.g. mapped) into `output`. The Blocks of the file are
+    /// located using the Index of each Stream, and decoded on `thread_count` threads (one per CPU by default).
+    static ErrorOr<void> decompress_all_in_parallel(ReadonlyBytes, Stream& output, Optional<size_t> thread_count = {});
+
     virtual ErrorOr<Bytes> read_some(Bytes) override;
     virtual ErrorOr<size_t> write_some(ReadonlyBytes) override;
     virtual bool is_eof() const override;
@@ -170,6 +191,15 @@ private:
     ErrorOr<void> finish_current_block();
     ErrorOr<void> finish_current_stream();
 
+    // Creates a decompressor for a single Block, and reads the Block Header.
+    static ErrorOr<NonnullOwnPtr<XzDecompressor>> create_for_single_block(XzBlockLocation const&);
+    ErrorOr<Bytes> read_from_single_block(Bytes, u64 uncompressed_size);
+    // Checks the end of the single Block against its Index record.
+    ErrorOr<void> finish_single_block(u64 unpadded_size, u64 uncompressed_size);
+
+    // Decodes the whole single Block, and checks it against its Index record.
+    ErrorOr<void> decode_single_block(Stream& output, u64 unpadded_size, u64 uncompressed_size);
+
     NonnullOwnPtr<CountingStream> m_stream;
     Optional<XzStreamFlags> m_stream_flags;
     bool m_found_first_stream_header { false };
@@ -187,6 +217,85 @@ private:
     Vector<BlockMetadata> m_processed_blocks;
 };
 
+// Decompresses an XZ file (which has to be in memory, e.g. mapped) with random access. A seek uses the Index of each
+// Stream to find the Block that holds the new position, so that only the data before it in that Block is decoded.
+// Files that consist of a single Block (as written by xz without multithreading) don't gain anything from this.
+class SeekableXzDecompressor final : public SeekableStream {
+public:
+    static ErrorOr<NonnullOwnPtr<SeekableXzDecompressor>> create(ReadonlyBytes);
+
+    virtual ErrorOr<Bytes> read_some(Bytes) override;
+    virtual ErrorOr<size_t> write_some(ReadonlyBytes) override;
+    virtual bool is_eof() const override;
+    virtual bool is_open() const override { return true; }
+    virtual void close() override { }
+    virtual ErrorOr<size_t> seek(i64 offset, SeekMode) override;
+    virtual ErrorOr<size_t> tell() const override { return m_position; }
+    virtual ErrorOr<size_t> size() override { return m_uncompressed_size; }
+    virtual ErrorOr<void> truncate(size_t) override;
+
+    ReadonlySpan<XzBlockLocation> blocks() const { return m_blocks; }
+
+private:
+    SeekableXzDecompressor(Vector<XzBlockLocation>, u64 uncompressed_size);
+
+    ErrorOr<void> start_block(size_t index);
+    ErrorOr<void> skip(u64);
+
+    Vector<XzBlockLocation> m_blocks;
+    u64 m_uncompressed_size { 0 };
+
+    // The Block that is being decoded, or the one that decoding continues with.
+    size_t m_block_index { 0 };
+    OwnPtr<XzDecompressor> m_block_decompressor;
+    u64 m_position { 0 };
+};
+
+class XzCompressor final : public Stream {
+public:
+    static constexpr size_t default_block_size = 1 * MiB;
+
+    // Every Block is compressed independently, up to `thread_count` Blocks at a time (one per CPU by default).
+    static ErrorOr<NonnullOwnPtr<XzCompressor>> create(MaybeOwned<Stream>, Optional<size_t> thread_count = {}, size_t block_size = default_block_size);
+    ~XzCompressor();
+
+    static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes, Optional<size_t> thread_count = {}, size_t block_size = default_block_size);
+
+    /// Compresses the remaining data and finishes the Stream with its Index and Stream Footer.
+    ErrorOr<void> finish();
+
+    virtual ErrorOr<Bytes> read_some(Bytes) override;
+    virtual ErrorOr<size_t> write_some(ReadonlyBytes) override;
+    virtual bool is_eof() const override;
+    virtual bool is_open() const override;
+    virtual void close() override;
+
+private:
+    XzCompressor(MaybeOwned<Stream>, size_t thread_count, size_t block_size, ByteBuffer buffer);
+
+    struct CompressedBlock {
+        ByteBuffer data;
+        u64 unpadded_size {};
+    };
+    static ErrorOr<CompressedBlock> compress_block(ReadonlyBytes, size_t block_size);
+
+    ErrorOr<void> compress_buffered_blocks();
+
+    MaybeOwned<Stream> m_stream;
+    size_t m_thread_count { 0 };
+    size_t m_block_size { 0 };
+    bool m_finished { false };
+
+    ByteBuffer m_buffer;
+    size_t m_buffered_size { 0 };
+
+    struct BlockMetadata {
+        u64 uncompressed_size {};
+        u64 unpadded_size {};
+    };
+    Vector<BlockMetadata> m_blocks;
+};
+
 }
 
 template<>
@@ -203,3 +312,8 @@ template<>
 struct AK::Traits<Compress::XzBlockFlags> : public AK::DefaultTraits<Compress::XzBlockFlags> {
     static constexpr bool is_trivially_serializable() { return true; }
 };
+
+template<>
+struct AK::Traits<Compress::XzFilterLzma2Properties> : public AK::DefaultTraits<Compress::XzFilterLzma2Properties> {
+    static constexpr bool is_trivially_serializable() { return true; }
+};
@@ -74,10 +74,12 @@ public:
     ErrorOr<void> finish();
 
     static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes, ZlibCompressionLevel = ZlibCompressionLevel::Default);
+    // See DeflateCompressor::compress_all_in_parallel().
+    static ErrorOr<ByteBuffer> compress_all_in_parallel(ReadonlyBytes bytes, size_t chunk_size, ZlibCompressionLevel = ZlibCompressionLevel::Default, Optional<size_t> thread_count = {});
 
 private:
     ZlibCompressor(MaybeOwned<Stream> stream, NonnullOwnPtr<Stream> compressor_stream);
-    ErrorOr<void> write_header(ZlibCompressionMethod, ZlibCompressionLevel);
+    static ErrorOr<void> write_header(Stream&, ZlibCompressionMethod, ZlibCompressionLevel);
 
     bool m_finished { false };
     MaybeOwned<Stream> m_output_stream;
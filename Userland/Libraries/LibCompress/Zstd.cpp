@@ -0,0 +1,1845 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/BuiltinWrappers.h>
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <AK/Math.h>
+#include <AK/MemoryStream.h>
+#include <LibCompress/Huffman.h>
+#include <LibCompress/Zstd.h>
+
+namespace Compress {
+
+namespace Zstd {
+
+// 3.1.1. Zstandard Frames
+static constexpr u32 frame_magic_number = 0xFD2FB528;
+// 3.1.2. Skippable Frames
+static constexpr u32 skippable_frame_magic_number = 0x184D2A50;
+static constexpr u32 skippable_frame_magic_number_mask = 0xFFFFFFF0;
+
+// 3.1.1.2.3. Block_Size
+static constexpr size_t maximum_block_size = 128 * KiB;
+
+// Matches and literals are copied 8 bytes at a time, which may write up to this many bytes past their end.
+static constexpr size_t copy_slack = 32;
+
+enum class BlockType : u8 {
+    Raw = 0,
+    Rle = 1,
+    Compressed = 2,
+    Reserved = 3,
+};
+
+// 3.1.1.3.1.1. Literals_Section_Header
+enum class LiteralsBlockType : u8 {
+    Raw = 0,
+    Rle = 1,
+    Compressed = 2,
+    Treeless = 3,
+};
+
+// 3.1.1.3.2.1. Sequences_Section_Header
+enum class SymbolCompressionMode : u8 {
+    Predefined = 0,
+    Rle = 1,
+    FseCompressed = 2,
+    Repeat = 3,
+};
+
+struct CodeInfo {
+    u32 baseline;
+    u8 number_of_bits;
+};
+
+// 3.1.1.3.2.1.1. Sequence Codes for Lengths and Offsets
+static constexpr Array<CodeInfo, 36> literal_length_codes { {
+    { 0, 0 }, { 1, 0 }, { 2, 0 }, { 3, 0 }, { 4, 0 }, { 5, 0 }, { 6, 0 }, { 7, 0 },
+    { 8, 0 }, { 9, 0 }, { 10, 0 }, { 11, 0 }, { 12, 0 }, { 13, 0 }, { 14, 0 }, { 15, 0 },
+    { 16, 1 }, { 18, 1 }, { 20, 1 }, { 22, 1 }, { 24, 2 }, { 28, 2 }, { 32, 3 }, { 40, 3 },
+    { 48, 4 }, { 64, 6 }, { 128, 7 }, { 256, 8 }, { 512, 9 }, { 1024, 10 }, { 2048, 11 }, { 4096, 12 },
+    { 8192, 13 }, { 16384, 14 }, { 32768, 15 }, { 65536, 16 },
+} };
+
+static constexpr Array<CodeInfo, 53> match_length_codes { {
+    { 3, 0 }, { 4, 0 }, { 5, 0 }, { 6, 0 }, { 7, 0 }, { 8, 0 }, { 9, 0 }, { 10, 0 },
+    { 11, 0 }, { 12, 0 }, { 13, 0 }, { 14, 0 }, { 15, 0 }, { 16, 0 }, { 17, 0 }, { 18, 0 },
+    { 19, 0 }, { 20, 0 }, { 21, 0 }, { 22, 0 }, { 23, 0 }, { 24, 0 }, { 25, 0 }, { 26, 0 },
+    { 27, 0 }, { 28, 0 }, { 29, 0 }, { 30, 0 }, { 31, 0 }, { 32, 0 }, { 33, 0 }, { 34, 0 },
+    { 35, 1 }, { 37, 1 }, { 39, 1 }, { 41, 1 }, { 43, 2 }, { 47, 2 }, { 51, 3 }, { 59, 3 },
+    { 67, 4 }, { 83, 4 }, { 99, 5 }, { 131, 7 }, { 259, 8 }, { 515, 9 }, { 1027, 10 }, { 2051, 11 },
+    { 4099, 12 }, { 8195, 13 }, { 16387, 14 }, { 32771, 15 }, { 65539, 16 },
+} };
+
+static constexpr u8 max_offset_code = 31;
+
+// 3.1.1.3.2.2. Default Distributions
+static constexpr Array<i16, 36> default_literal_length_distribution {
+    4, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 1, 1, 1, 1, 1,
+    -1, -1, -1, -1
+};
+static constexpr u8 default_literal_length_accuracy_log = 6;
+
+static constexpr Array<i16, 53> default_match_length_distribution {
+    1, 4, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1, -1, -1
+};
+static constexpr u8 default_match_length_accuracy_log = 6;
+
+static constexpr Array<i16, 29> default_offset_distribution {
+    1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1
+};
+static constexpr u8 default_offset_accuracy_log = 5;
+
+// 3.1.1.3.2.1. Sequences_Section_Header: Accuracy_Log limits of FSE_Compressed_Mode tables.
+static constexpr u8 max_literal_length_accuracy_log = 9;
+static constexpr u8 max_match_length_accuracy_log = 9;
+static constexpr u8 max_offset_accuracy_log = 8;
+
+// 4.2.1.2. FSE Compression of Huffman Weights
+static constexpr u8 max_weight_accuracy_log = 6;
+// 4.2.1. Huffman Tree Description
+static constexpr u8 max_huffman_code_length = 11;
+
+template<typename T>
+static ALWAYS_INLINE T load_little_endian(u8 const* data)
+{
+    T value;
+    ByteReader::load(data, value);
+    return AK::convert_between_host_and_little_endian(value);
+}
+
+template<typename T>
+static ALWAYS_INLINE void store_little_endian(u8* data, T value)
+{
+    value = AK::convert_between_host_and_little_endian(value);
+    __builtin_memcpy(data, &value, sizeof(value));
+}
+
+static ALWAYS_INLINE u8 highest_bit(u32 value)
+{
+    return 31 - count_leading_zeroes(value);
+}
+
+// 3.1.1.5. Sequence Execution
+static ALWAYS_INLINE u32 resolve_offset(RepeatOffsets& repeat_offsets, u32 offset_value, u32 literal_length)
+{
+    if (offset_value > 3) {
+        u32 offset = offset_value - 3;
+        repeat_offsets = { offset, repeat_offsets[0], repeat_offsets[1] };
+        return offset;
+    }
+
+    // Repeat offsets are shifted by one when there are no literals.
+    u32 index = offset_value - 1 + (literal_length == 0 ? 1 : 0);
+    if (index == 0)
+        return repeat_offsets[0];
+
+    u32 offset = index == 3 ? repeat_offsets[0] - 1 : repeat_offsets[index];
+    if (index == 1)
+        swap(repeat_offsets[0], repeat_offsets[1]);
+    else
+        repeat_offsets = { offset, repeat_offsets[0], repeat_offsets[1] };
+    return offset;
+}
+
+// 4.1. FSE and 4.2.2. Huffman-Coded Streams: These bitstreams are read backwards, starting right below the highest set
+// bit of their last byte. Bits are read in chunks of up to 57 bits, reload() has to be called before each chunk.
+class BackwardBitReader {
+public:
+    static ErrorOr<BackwardBitReader> create(ReadonlyBytes bytes)
+    {
+        if (bytes.is_empty() || bytes.last() == 0)
+            return Error::from_string_literal("Invalid end of zstd bitstream");
+
+        BackwardBitReader reader { bytes };
+        if (bytes.size() >= sizeof(u64)) {
+            reader.m_position = bytes.size() - sizeof(u64);
+            reader.m_container = load_little_endian<u64>(bytes.data() + reader.m_position);
+        } else {
+            for (size_t i = 0; i < bytes.size(); ++i)
+                reader.m_container |= static_cast<u64>(bytes[i]) << (i * 8);
+            reader.m_consumed_bits = (sizeof(u64) - bytes.size()) * 8;
+        }
+        // Skip the padding and the end mark.
+        reader.m_consumed_bits += 8 - highest_bit(bytes.last());
+        return reader;
+    }
+
+    ALWAYS_INLINE u64 peek_bits(u8 count) const
+    {
+        // NOTE: This also works for a count of 0, as the first shift by 1 clears the highest bit.
+        return ((m_container << (m_consumed_bits & 63)) >> 1) >> ((63 - count) & 63);
+    }
+
+    ALWAYS_INLINE void discard_bits(u8 count) { m_consumed_bits += count; }
+
+    ALWAYS_INLINE u64 read_bits(u8 count)
+    {
+        auto value = peek_bits(count);
+        discard_bits(count);
+        return value;
+    }
+
+    ALWAYS_INLINE void reload()
+    {
+        if (m_consumed_bits > 64)
+            return;
+
+        size_t bytes = m_consumed_bits / 8;
+        if (m_position >= sizeof(u64)) {
+            m_position -= bytes;
+        } else {
+            if (m_position == 0)
+                return;
+            bytes = min(bytes, m_position);
+            m_position -= bytes;
+        }
+        m_consumed_bits -= bytes * 8;
+        m_container = load_little_endian<u64>(m_bytes.data() + m_position);
+    }
+
+    // Whether more bits were read than the stream holds.
+    bool has_overflowed() const { return m_consumed_bits > 64; }
+
+    // Whether exactly all bits of the stream were read.
+    bool is_finished() const { return m_position == 0 && m_consumed_bits == 64; }
+
+private:
+    BackwardBitReader(ReadonlyBytes bytes)
+        : m_bytes(bytes)
+    {
+    }
+
+    ReadonlyBytes m_bytes;
+    size_t m_position { 0 };
+    u64 m_container { 0 };
+    u32 m_consumed_bits { 0 };
+};
+
+// The counterpart of BackwardBitReader: Bits are written from the lowest to the highest bit of each byte, and the
+// stream is finished with an end mark.
+class BitWriter {
+public:
+    BitWriter(Bytes output)
+        : m_output(output)
+    {
+    }
+
+    ALWAYS_INLINE void write_bits(u64 value, u8 count)
+    {
+        VERIFY(count <= 32);
+        m_bits |= (value & ((1ull << count) - 1)) << m_bit_count;
+        m_bit_count += count;
+        if (m_bit_count >= 32) {
+            VERIFY(m_offset + sizeof(u32) <= m_output.size());
+            store_little_endian(m_output.data() + m_offset, static_cast<u32>(m_bits));
+            m_offset += sizeof(u32);
+            m_bits >>= 32;
+            m_bit_count -= 32;
+        }
+    }
+
+    // Returns the size of the stream.
+    size_t finish()
+    {
+        write_bits(1, 1);
+        for (; m_bit_count > 0; m_bit_count -= min(m_bit_count, 8u)) {
+            VERIFY(m_offset < m_output.size());
+            m_output[m_offset++] = static_cast<u8>(m_bits);
+            m_bits >>= 8;
+        }
+        return m_offset;
+    }
+
+private:
+    Bytes m_output;
+    size_t m_offset { 0 };
+    u64 m_bits { 0 };
+    u32 m_bit_count { 0 };
+};
+
+struct FseDistribution {
+    Array<i16, 256> normalized_counts {};
+    size_t symbol_count { 0 };
+    u8 accuracy_log { 0 };
+
+    ReadonlySpan<i16> counts() const { return normalized_counts.span().trim(symbol_count); }
+};
+
+// 4.1.1. FSE Table Description
+static ErrorOr<FseDistribution> read_fse_distribution(ReadonlyBytes& data, u8 max_accuracy_log, u8 max_symbol)
+{
+    if (data.is_empty())
+        return Error::from_string_literal("Missing FSE table description");
+
+    size_t bit_offset = 0;
+    auto read_bits = [&](u8 count, bool consume = true) {
+        u32 value = 0;
+        for (u8 i = 0; i < count; ++i) {
+            size_t offset = bit_offset + i;
+            if (offset / 8 < data.size())
+                value |= ((data[offset / 8] >> (offset % 8)) & 1) << i;
+        }
+        if (consume)
+            bit_offset += count;
+        return value;
+    };
+
+    FseDistribution distribution;
+    distribution.accuracy_log = read_bits(4) + 5;
+    if (distribution.accuracy_log > max_accuracy_log)
+        return Error::from_string_literal("FSE table has a too large accuracy log");
+
+    i32 remaining = (1 << distribution.accuracy_log) + 1;
+    i32 threshold = 1 << distribution.accuracy_log;
+    u8 number_of_bits = distribution.accuracy_log + 1;
+    size_t symbol = 0;
+    bool previous_was_zero = false;
+    while (remaining > 1 && symbol <= max_symbol) {
+        if (previous_was_zero) {
+            // Zero probabilities are followed by 2-bit flags that repeat them.
+            size_t repeated_until = symbol;
+            while (true) {
+                auto repeat = read_bits(2);
+                repeated_until += repeat;
+                if (repeat != 3)
+                    break;
+            }
+            if (repeated_until > max_symbol)
+                return Error::from_string_literal("FSE table has too many symbols");
+            while (symbol < repeated_until)
+                distribution.normalized_counts[symbol++] = 0;
+        }
+
+        i32 const max = 2 * threshold - 1 - remaining;
+        i32 value = read_bits(number_of_bits - 1, false);
+        if (value < max) {
+            bit_offset += number_of_bits - 1;
+        } else {
+            value = read_bits(number_of_bits);
+            if (value >= threshold)
+                value -= max;
+        }
+
+        // A value of 0 stands for a "less than 1" probability of -1.
+        i16 count = value - 1;
+        remaining -= count < 0 ? -count : count;
+        distribution.normalized_counts[symbol++] = count;
+        previous_was_zero = count == 0;
+
+        while (remaining < threshold) {
+            --number_of_bits;
+            threshold >>= 1;
+        }
+    }
+
+    if (remaining != 1 || bit_offset > data.size() * 8)
+        return Error::from_string_literal("Invalid FSE table description");
+
+    distribution.symbol_count = symbol;
+    data = data.slice(ceil_div(bit_offset, 8ul));
+    return distribution;
+}
+
+// The counterpart of read_fse_distribution().
+static ErrorOr<void> write_fse_distribution(ByteBuffer& output, ReadonlySpan<i16> normalized_counts, u8 accuracy_log)
+{
+    u64 bits = accuracy_log - 5;
+    u32 bit_count = 4;
+    auto flush = [&]() -> ErrorOr<void> {
+        while (bit_count >= 8) {
+            TRY(output.try_append(static_cast<u8>(bits)));
+            bits >>= 8;
+            bit_count -= 8;
+        }
+        return {};
+    };
+
+    i32 remaining = (1 << accuracy_log) + 1;
+    i32 threshold = 1 << accuracy_log;
+    u8 number_of_bits = accuracy_log + 1;
+    size_t symbol = 0;
+    bool previous_was_zero = false;
+    while (symbol < normalized_counts.size() && remaining > 1) {
+        if (previous_was_zero) {
+            size_t start = symbol;
+            while (normalized_counts[symbol] == 0)
+                ++symbol;
+            for (; symbol >= start + 3; start += 3) {
+                bits |= 3ull << bit_count;
+                bit_count += 2;
+                TRY(flush());
+            }
+            bits |= static_cast<u64>(symbol - start) << bit_count;
+            bit_count += 2;
+        }
+
+        i32 count = normalized_counts[symbol++];
+        i32 const max = 2 * threshold - 1 - remaining;
+        remaining -= count < 0 ? -count : count;
+        ++count;
+        if (count >= threshold)
+            count += max;
+        bits |= static_cast<u64>(count) << bit_count;
+        bit_count += number_of_bits;
+        if (count < max)
+            --bit_count;
+        previous_was_zero = count == 1;
+        TRY(flush());
+
+        while (remaining < threshold) {
+            --number_of_bits;
+            threshold >>= 1;
+        }
+    }
+    VERIFY(remaining == 1);
+
+    if (bit_count > 0)
+        TRY(output.try_append(static_cast<u8>(bits)));
+    return {};
+}
+
+ErrorOr<FseTable> FseTable::create(ReadonlySpan<i16> normalized_counts, u8 accuracy_log)
+{
+    // 4.1.1. FSE Table Description
+    size_t const table_size = 1u << accuracy_log;
+    size_t sum = 0;
+    for (auto count : normalized_counts)
+        sum += count < 0 ? 1 : count;
+    if (sum != table_size || normalized_counts.size() > 256)
+        return Error::from_string_literal("Invalid FSE distribution");
+
+    FseTable table;
+    table.m_accuracy_log = accuracy_log;
+    TRY(table.m_entries.try_resize(table_size));
+
+    // Symbols with a "less than 1" probability get a single state at the end of the table, the others are spread over
+    // the remaining states.
+    Array<u16, 256> next_states;
+    size_t high_threshold = table_size - 1;
+    for (size_t symbol = 0; symbol < normalized_counts.size(); ++symbol) {
+        if (normalized_counts[symbol] == -1) {
+            table.m_entries[high_threshold--].symbol = symbol;
+            next_states[symbol] = 1;
+        } else {
+            next_states[symbol] = normalized_counts[symbol];
+        }
+    }
+
+    size_t const step = (table_size >> 1) + (table_size >> 3) + 3;
+    size_t const mask = table_size - 1;
+    size_t position = 0;
+    for (size_t symbol = 0; symbol < normalized_counts.size(); ++symbol) {
+        for (i16 i = 0; i < normalized_counts[symbol]; ++i) {
+            table.m_entries[position].symbol = symbol;
+            do {
+                position = (position + step) & mask;
+            } while (position > high_threshold);
+        }
+    }
+    if (position != 0)
+        return Error::from_string_literal("Invalid FSE distribution");
+
+    for (auto& entry : table.m_entries) {
+        u16 next_state = next_states[entry.symbol]++;
+        entry.number_of_bits = accuracy_log - highest_bit(next_state);
+        entry.base = (next_state << entry.number_of_bits) - table_size;
+    }
+
+    return table;
+}
+
+ErrorOr<FseTable> FseTable::create_rle(u8 symbol)
+{
+    FseTable table;
+    TRY(table.m_entries.try_append({ .base = 0, .symbol = symbol, .number_of_bits = 0 }));
+    return table;
+}
+
+ErrorOr<HuffmanTable> HuffmanTable::create(ReadonlySpan<u8> weights)
+{
+    // 4.2.1. Huffman Tree Description: The weight of the last symbol is implied by the others, as they have to add up
+    // to a power of 2.
+    if (weights.size() > 255)
+        return Error::from_string_literal("Huffman tree has too many symbols");
+
+    u32 weight_sum = 0;
+    for (auto weight : weights) {
+        if (weight > max_huffman_code_length)
+            return Error::from_string_literal("Huffman weight is too large");
+        if (weight > 0)
+            weight_sum += 1u << (weight - 1);
+    }
+    if (weight_sum == 0)
+        return Error::from_string_literal("Huffman tree has no symbols");
+
+    u8 const max_number_of_bits = highest_bit(weight_sum) + 1;
+    if (max_number_of_bits > max_huffman_code_length)
+        return Error::from_string_literal("Huffman tree is too deep");
+    u32 const left_over = (1u << max_number_of_bits) - weight_sum;
+    if (!is_power_of_two(left_over))
+        return Error::from_string_literal("Huffman weights don't add up");
+
+    Array<u8, 256> all_weights;
+    weights.copy_to(all_weights);
+    all_weights[weights.size()] = highest_bit(left_over) + 1;
+    size_t const symbol_count = weights.size() + 1;
+
+    // 4.2.1.3. Huffman Tree Construction: Prefix codes are assigned in order of increasing weight, and in order of
+    // increasing symbol value for symbols with the same weight. Each symbol covers 2^(weight - 1) entries of the table.
+    HuffmanTable table;
+    table.m_max_number_of_bits = max_number_of_bits;
+    TRY(table.m_entries.try_resize(1u << max_number_of_bits));
+    size_t position = 0;
+    for (u8 weight = 1; weight <= max_number_of_bits; ++weight) {
+        for (size_t symbol = 0; symbol < symbol_count; ++symbol) {
+            if (all_weights[symbol] != weight)
+                continue;
+            Entry entry { .symbol = static_cast<u8>(symbol), .number_of_bits = static_cast<u8>(max_number_of_bits + 1 - weight) };
+            for (size_t i = 0; i < (1u << (weight - 1)); ++i)
+                table.m_entries[position++] = entry;
+        }
+    }
+
+    return table;
+}
+
+static FseTable const& default_literal_length_table()
+{
+    static FseTable table = MUST(FseTable::create(default_literal_length_distribution, default_literal_length_accuracy_log));
+    return table;
+}
+
+static FseTable const& default_match_length_table()
+{
+    static FseTable table = MUST(FseTable::create(default_match_length_distribution, default_match_length_accuracy_log));
+    return table;
+}
+
+static FseTable const& default_offset_table()
+{
+    static FseTable table = MUST(FseTable::create(default_offset_distribution, default_offset_accuracy_log));
+    return table;
+}
+
+static ErrorOr<void> decode_huffman_stream(HuffmanTable const& table, ReadonlyBytes stream, Bytes output)
+{
+    auto reader = TRY(BackwardBitReader::create(stream));
+    auto const max_number_of_bits = table.max_number_of_bits();
+    auto decode_symbol = [&] {
+        auto const& entry = table[reader.peek_bits(max_number_of_bits)];
+        reader.discard_bits(entry.number_of_bits);
+        return entry.symbol;
+    };
+
+    // Four codes of up to 11 bits fit into the bits that are available after a reload.
+    size_t i = 0;
+    for (; i + 4 <= output.size(); i += 4) {
+        reader.reload();
+        output[i] = decode_symbol();
+        output[i + 1] = decode_symbol();
+        output[i + 2] = decode_symbol();
+        output[i + 3] = decode_symbol();
+    }
+    reader.reload();
+    for (; i < output.size(); ++i)
+        output[i] = decode_symbol();
+
+    if (!reader.is_finished())
+        return Error::from_string_literal("Huffman stream has an invalid size");
+    return {};
+}
+
+static ErrorOr<void> read_sequence_table(SymbolCompressionMode mode, ReadonlyBytes& data, Optional<FseTable>& table, FseTable const& default_table, u8 max_accuracy_log, u8 max_symbol)
+{
+    switch (mode) {
+    case SymbolCompressionMode::Predefined:
+        table = default_table;
+        return {};
+    case SymbolCompressionMode::Rle:
+        if (data.is_empty() || data[0] > max_symbol)
+            return Error::from_string_literal("Invalid RLE sequence code");
+        table = TRY(FseTable::create_rle(data[0]));
+        data = data.slice(1);
+        return {};
+    case SymbolCompressionMode::FseCompressed: {
+        auto distribution = TRY(read_fse_distribution(data, max_accuracy_log, max_symbol));
+        table = TRY(FseTable::create(distribution.counts(), distribution.accuracy_log));
+        return {};
+    }
+    case SymbolCompressionMode::Repeat:
+        if (!table.has_value())
+            return Error::from_string_literal("No sequence table to repeat");
+        return {};
+    }
+    VERIFY_NOT_REACHED();
+}
+
+// Copies a match that may overlap with its destination.
+static ALWAYS_INLINE void copy_match(u8* destination, size_t offset, size_t length)
+{
+    u8 const* source = destination - offset;
+    if (offset >= 8) {
+        for (size_t i = 0; i < length; i += 8)
+            __builtin_memcpy(destination + i, source + i, 8);
+        return;
+    }
+    for (size_t i = 0; i < length; ++i)
+        destination[i] = source[i];
+}
+
+}
+
+using namespace Zstd;
+
+ErrorOr<NonnullOwnPtr<ZstdDecompressor>> ZstdDecompressor::create(MaybeOwned<Stream> stream)
+{
+    return adopt_nonnull_own_or_enomem(new (nothrow) ZstdDecompressor(move(stream)));
+}
+
+ZstdDecompressor::ZstdDecompressor(MaybeOwned<Stream> stream)
+    : m_stream(move(stream))
+{
+}
+
+ErrorOr<ByteBuffer> ZstdDecompressor::decompress_all(ReadonlyBytes bytes)
+{
+    auto decompressor = TRY(create(make<FixedMemoryStream>(bytes)));
+    return decompressor->read_until_eof();
+}
+
+bool ZstdDecompressor::is_likely_compressed(ReadonlyBytes bytes)
+{
+    return bytes.size() >= sizeof(u32) && load_little_endian<u32>(bytes.data()) == frame_magic_number;
+}
+
+ErrorOr<Bytes> ZstdDecompressor::read_some(Bytes bytes)
+{
+    while (m_read_offset == m_write_offset) {
+        if (m_state == State::Done)
+            return bytes.trim(0);
+        if (m_state == State::FrameHeader)
+            TRY(read_frame_header());
+        else
+            TRY(read_block());
+    }
+
+    auto size = min(bytes.size(), m_write_offset - m_read_offset);
+    m_window.bytes().slice(m_read_offset, size).copy_to(bytes);
+    m_read_offset += size;
+    return bytes.trim(size);
+}
+
+ErrorOr<void> ZstdDecompressor::read_frame_header()
+{
+    // 3.1. Frames: Data consists of any number of frames.
+    u32 magic_number;
+    while (true) {
+        Array<u8, sizeof(u32)> magic_number_bytes;
+        auto first_bytes = TRY(m_stream->read_some(magic_number_bytes));
+        if (first_bytes.is_empty() && m_stream->is_eof()) {
+            m_state = State::Done;
+            return {};
+        }
+        TRY(m_stream->read_until_filled(magic_number_bytes.span().slice(first_bytes.size())));
+        magic_number = load_little_endian<u32>(magic_number_bytes.data());
+
+        // 3.1.2. Skippable Frames
+        if ((magic_number & skippable_frame_magic_number_mask) != skippable_frame_magic_number)
+            break;
+        auto frame_size = TRY(m_stream->read_value<LittleEndian<u32>>());
+        TRY(m_stream->discard(frame_size));
+    }
+
+    if (magic_number != frame_magic_number)
+        return Error::from_string_literal("Invalid zstd frame magic number");
+
+    // 3.1.1.1.1. Frame_Header_Descriptor
+    auto descriptor = TRY(m_stream->read_value<u8>());
+    u8 const content_size_flag = descriptor >> 6;
+    bool const is_single_segment = (descriptor >> 5) & 1;
+    bool const has_checksum = (descriptor >> 2) & 1;
+    u8 const dictionary_id_flag = descriptor & 3;
+    if ((descriptor >> 3) & 1)
+        return Error::from_string_literal("Reserved bit is set in zstd frame header");
+
+    // 3.1.1.1.2. Window_Descriptor
+    u64 window_size = 0;
+    if (!is_single_segment) {
+        auto window_descriptor = TRY(m_stream->read_value<u8>());
+        u8 const window_log = 10 + (window_descriptor >> 3);
+        u64 const window_base = 1ull << window_log;
+        window_size = window_base + (window_base / 8) * (window_descriptor & 7);
+    }
+
+    // 3.1.1.1.3. Dictionary_ID
+    static constexpr Array<u8, 4> dictionary_id_sizes { 0, 1, 2, 4 };
+    u32 dictionary_id = 0;
+    for (u8 i = 0; i < dictionary_id_sizes[dictionary_id_flag]; ++i)
+        dictionary_id |= TRY(m_stream->read_value<u8>()) << (i * 8);
+    if (dictionary_id != 0)
+        return Error::from_string_literal("Zstd dictionaries are not supported");
+
+    // 3.1.1.1.4. Frame_Content_Size
+    static constexpr Array<u8, 4> content_size_sizes { 0, 2, 4, 8 };
+    u8 const content_size_size = content_size_flag == 0 && is_single_segment ? 1 : content_size_sizes[content_size_flag];
+    m_content_size.clear();
+    if (content_size_size > 0) {
+        u64 content_size = 0;
+        for (u8 i = 0; i < content_size_size; ++i)
+            content_size |= static_cast<u64>(TRY(m_stream->read_value<u8>())) << (i * 8);
+        if (content_size_size == 2)
+            content_size += 256;
+        m_content_size = content_size;
+    }
+    if (is_single_segment)
+        window_size = m_content_size.value();
+
+    // Frames that fit into their window don't need more than their own size, and don't have to be moved around.
+    m_block_maximum_size = min(window_size, maximum_block_size);
+    bool const frame_fits_into_window = m_content_size.has_value() && m_content_size.value() <= window_size;
+    if (frame_fits_into_window)
+        window_size = m_content_size.value();
+    if (window_size > maximum_window_size)
+        return Error::from_string_literal("Zstd frame window size is too large");
+    m_window_size = window_size;
+
+    size_t const capacity = (frame_fits_into_window ? m_window_size : 2 * m_window_size) + m_block_maximum_size + copy_slack;
+    if (m_window.size() < capacity)
+        TRY(m_window.try_resize(capacity));
+    m_write_offset = 0;
+    m_read_offset = 0;
+
+    m_frame_size = 0;
+    m_checksum.clear();
+    if (has_checksum)
+        m_checksum = Crypto::Checksum::XXHash64 {};
+    m_repeat_offsets = { 1, 4, 8 };
+    m_huffman_table.clear();
+    m_literal_length_table.clear();
+    m_offset_table.clear();
+    m_match_length_table.clear();
+
+    m_state = State::Block;
+    return {};
+}
+
+ErrorOr<void> ZstdDecompressor::read_block()
+{
+    // 3.1.1.2. Blocks
+    Array<u8, 3> header_bytes;
+    TRY(m_stream->read_until_filled(header_bytes));
+    u32 const header = header_bytes[0] | (header_bytes[1] << 8) | (header_bytes[2] << 16);
+    bool const is_last_block = header & 1;
+    auto const type = static_cast<BlockType>((header >> 1) & 3);
+    size_t const size = header >> 3;
+
+    if (size > m_block_maximum_size)
+        return Error::from_string_literal("Zstd block is too large");
+
+    // Keep the last window_size bytes, and make room for the largest possible block.
+    if (m_write_offset + m_block_maximum_size > m_window.size() - copy_slack) {
+        auto history_size = min(m_write_offset, m_window_size);
+        memmove(m_window.data(), m_window.data() + m_write_offset - history_size, history_size);
+        m_write_offset = history_size;
+        m_read_offset = history_size;
+    }
+
+    size_t const block_start = m_write_offset;
+    switch (type) {
+    case BlockType::Raw:
+        TRY(m_stream->read_until_filled(m_window.bytes().slice(m_write_offset, size)));
+        m_write_offset += size;
+        break;
+    case BlockType::Rle: {
+        auto value = TRY(m_stream->read_value<u8>());
+        m_window.bytes().slice(m_write_offset, size).fill(value);
+        m_write_offset += size;
+        break;
+    }
+    case BlockType::Compressed:
+        TRY(m_block.try_resize(size));
+        TRY(m_stream->read_until_filled(m_block));
+        TRY(decompress_block(m_block));
+        break;
+    case BlockType::Reserved:
+        return Error::from_string_literal("Invalid zstd block type");
+    }
+
+    auto decompressed_data = m_window.bytes().slice(block_start, m_write_offset - block_start);
+    m_frame_size += decompressed_data.size();
+    if (m_content_size.has_value() && m_frame_size > m_content_size.value())
+        return Error::from_string_literal("Zstd frame is larger than its content size");
+    if (m_checksum.has_value())
+        m_checksum->update(decompressed_data);
+
+    if (is_last_block)
+        TRY(finish_frame());
+    return {};
+}
+
+ErrorOr<void> ZstdDecompressor::finish_frame()
+{
+    if (m_content_size.has_value() && m_frame_size != m_content_size.value())
+        return Error::from_string_literal("Zstd frame size doesn't match its content size");
+
+    // 3.1.1. Zstandard Frames: Content_Checksum
+    if (m_checksum.has_value()) {
+        u32 checksum = TRY(m_stream->read_value<LittleEndian<u32>>());
+        if (checksum != static_cast<u32>(m_checksum->digest()))
+            return Error::from_string_literal("Zstd frame checksum mismatch");
+    }
+
+    m_state = State::FrameHeader;
+    return {};
+}
+
+ErrorOr<void> ZstdDecompressor::decompress_block(ReadonlyBytes block)
+{
+    // 3.1.1.3. Compressed Blocks
+    auto literals = TRY(decode_literals(block));
+    TRY(decode_and_execute_sequences(block, literals));
+    return {};
+}
+
+ErrorOr<ReadonlyBytes> ZstdDecompressor::decode_literals(ReadonlyBytes& block)
+{
+    // 3.1.1.3.1.1. Literals_Section_Header
+    if (block.is_empty())
+        return Error::from_string_literal("Missing zstd literals section");
+
+    u8 const first_byte = block[0];
+    auto const type = static_cast<LiteralsBlockType>(first_byte & 3);
+    u8 const size_format = (first_byte >> 2) & 3;
+
+    if (type == LiteralsBlockType::Raw || type == LiteralsBlockType::Rle) {
+        size_t header_size = 1;
+        size_t regenerated_size = first_byte >> 3;
+        if (size_format == 1) {
+            header_size = 2;
+            if (block.size() < header_size)
+                return Error::from_string_literal("Truncated zstd literals section");
+            regenerated_size = (first_byte >> 4) | (block[1] << 4);
+        } else if (size_format == 3) {
+            header_size = 3;
+            if (block.size() < header_size)
+                return Error::from_string_literal("Truncated zstd literals section");
+            regenerated_size = (first_byte >> 4) | (block[1] << 4) | (block[2] << 12);
+        }
+        if (regenerated_size > m_block_maximum_size)
+            return Error::from_string_literal("Zstd literals section is too large");
+        block = block.slice(header_size);
+
+        if (type == LiteralsBlockType::Raw) {
+            if (block.size() < regenerated_size)
+                return Error::from_string_literal("Truncated zstd literals section");
+            auto literals = block.trim(regenerated_size);
+            block = block.slice(regenerated_size);
+            return literals;
+        }
+
+        if (block.is_empty())
+            return Error::from_string_literal("Truncated zstd literals section");
+        TRY(m_literals.try_resize(regenerated_size));
+        m_literals.bytes().fill(block[0]);
+        block = block.slice(1);
+        return m_literals.bytes();
+    }
+
+    size_t const stream_count = size_format == 0 ? 1 : 4;
+    u8 const size_bits = size_format <= 1 ? 10 : size_format == 2 ? 14 : 18;
+    size_t const header_size = size_format <= 1 ? 3 : size_format == 2 ? 4 : 5;
+    if (block.size() < header_size)
+        return Error::from_string_literal("Truncated zstd literals section");
+    u64 header = 0;
+    for (size_t i = 0; i < header_size; ++i)
+        header |= static_cast<u64>(block[i]) << (i * 8);
+    size_t const regenerated_size = (header >> 4) & ((1u << size_bits) - 1);
+    size_t const compressed_size = (header >> (4 + size_bits)) & ((1u << size_bits) - 1);
+    if (regenerated_size > m_block_maximum_size)
+        return Error::from_string_literal("Zstd literals section is too large");
+    block = block.slice(header_size);
+    if (block.size() < compressed_size)
+        return Error::from_string_literal("Truncated zstd literals section");
+    auto data = block.trim(compressed_size);
+    block = block.slice(compressed_size);
+
+    // 3.1.1.3.1.6. Huffman_Tree_Description
+    if (type == LiteralsBlockType::Compressed)
+        TRY(read_huffman_table(data));
+    else if (!m_huffman_table.has_value())
+        return Error::from_string_literal("No Huffman tree to repeat for zstd literals");
+
+    TRY(m_literals.try_resize(regenerated_size));
+    if (stream_count == 1) {
+        TRY(decode_huffman_stream(*m_huffman_table, data, m_literals));
+        return m_literals.bytes();
+    }
+
+    // 3.1.1.3.1.7. Jump_Table
+    if (data.size() < 6)
+        return Error::from_string_literal("Truncated zstd jump table");
+    Array<size_t, 4> stream_sizes;
+    for (size_t i = 0; i < 3; ++i)
+        stream_sizes[i] = load_little_endian<u16>(data.data() + i * 2);
+    data = data.slice(6);
+    if (stream_sizes[0] + stream_sizes[1] + stream_sizes[2] > data.size())
+        return Error::from_string_literal("Invalid zstd jump table");
+    stream_sizes[3] = data.size() - stream_sizes[0] - stream_sizes[1] - stream_sizes[2];
+
+    size_t const segment_size = ceil_div(regenerated_size, 4ul);
+    if (segment_size * 3 > regenerated_size)
+        return Error::from_string_literal("Invalid zstd literals size for 4 streams");
+    auto output = m_literals.bytes();
+    for (size_t i = 0; i < 4; ++i) {
+        auto segment = i < 3 ? output.slice(i * segment_size, segment_size) : output.slice(3 * segment_size);
+        TRY(decode_huffman_stream(*m_huffman_table, data.trim(stream_sizes[i]), segment));
+        data = data.slice(stream_sizes[i]);
+    }
+    return m_literals.bytes();
+}
+
+ErrorOr<void> ZstdDecompressor::read_huffman_table(ReadonlyBytes& data)
+{
+    // 4.2.1. Huffman Tree Description
+    if (data.is_empty())
+        return Error::from_string_literal("Missing Huffman tree description");
+
+    u8 const header = data[0];
+    Array<u8, 256> weights;
+    size_t weight_count = 0;
+
+    if (header < 128) {
+        // 4.2.1.2. FSE Compression of Huffman Weights
+        if (data.size() < 1u + header)
+            return Error::from_string_literal("Truncated Huffman tree description");
+        auto compressed_weights = data.slice(1, header);
+        data = data.slice(1 + header);
+
+        auto distribution = TRY(read_fse_distribution(compressed_weights, max_weight_accuracy_log, 255));
+        auto table = TRY(FseTable::create(distribution.counts(), distribution.accuracy_log));
+        auto reader = TRY(BackwardBitReader::create(compressed_weights));
+
+        // The weights are decoded with two interleaved states, until reading the next state would overflow the stream.
+        // The symbol of the other state is the last one.
+        Array<u16, 2> states;
+        states[0] = reader.read_bits(table.accuracy_log());
+        states[1] = reader.read_bits(table.accuracy_log());
+        for (size_t current = 0;; current ^= 1) {
+            if (weight_count > 253)
+                return Error::from_string_literal("Huffman tree has too many symbols");
+            auto const& entry = table[states[current]];
+            weights[weight_count++] = entry.symbol;
+            states[current] = entry.base + reader.read_bits(entry.number_of_bits);
+            reader.reload();
+            if (reader.has_overflowed()) {
+                weights[weight_count++] = table[states[current ^ 1]].symbol;
+                break;
+            }
+        }
+    } else {
+        // 4.2.1.1. Huffman Tree Header: Direct representation
+        weight_count = header - 127;
+        size_t const size = ceil_div(weight_count, 2ul);
+        if (data.size() < 1 + size)
+            return Error::from_string_literal("Truncated Huffman tree description");
+        for (size_t i = 0; i < weight_count; ++i)
+            weights[i] = i % 2 == 0 ? data[1 + i / 2] >> 4 : data[1 + i / 2] & 0xf;
+        data = data.slice(1 + size);
+    }
+
+    m_huffman_table = TRY(HuffmanTable::create(weights.span().trim(weight_count)));
+    return {};
+}
+
+ErrorOr<void> ZstdDecompressor::decode_and_execute_sequences(ReadonlyBytes block, ReadonlyBytes literals)
+{
+    // 3.1.1.3.2.1. Sequences_Section_Header
+    if (block.is_empty())
+        return Error::from_string_literal("Missing zstd sequences section");
+
+    size_t sequence_count = block[0];
+    size_t header_size = 1;
+    if (sequence_count >= 128 && sequence_count < 255) {
+        header_size = 2;
+        if (block.size() < header_size)
+            return Error::from_string_literal("Truncated zstd sequences section");
+        sequence_count = ((sequence_count - 128) << 8) + block[1];
+    } else if (sequence_count == 255) {
+        header_size = 3;
+        if (block.size() < header_size)
+            return Error::from_string_literal("Truncated zstd sequences section");
+        sequence_count = block[1] + (block[2] << 8) + 0x7f00;
+    }
+    block = block.slice(header_size);
+
+    u8* const output_start = m_window.data();
+    u8* output = output_start + m_write_offset;
+    u8 const* const output_end = output + m_block_maximum_size;
+
+    if (sequence_count == 0) {
+        if (!block.is_empty())
+            return Error::from_string_literal("Unexpected data after zstd sequences section");
+        if (literals.size() > m_block_maximum_size)
+            return Error::from_string_literal("Zstd block is too large");
+        literals.copy_to({ output, literals.size() });
+        m_write_offset += literals.size();
+        return {};
+    }
+
+    if (block.is_empty())
+        return Error::from_string_literal("Truncated zstd sequences section");
+    u8 const modes = block[0];
+    if ((modes & 3) != 0)
+        return Error::from_string_literal("Reserved bits are set in zstd sequences section");
+    block = block.slice(1);
+
+    TRY(read_sequence_table(static_cast<SymbolCompressionMode>(modes >> 6), block, m_literal_length_table, default_literal_length_table(), max_literal_length_accuracy_log, literal_length_codes.size() - 1));
+    TRY(read_sequence_table(static_cast<SymbolCompressionMode>((modes >> 4) & 3), block, m_offset_table, default_offset_table(), max_offset_accuracy_log, max_offset_code));
+    TRY(read_sequence_table(static_cast<SymbolCompressionMode>((modes >> 2) & 3), block, m_match_length_table, default_match_length_table(), max_match_length_accuracy_log, match_length_codes.size() - 1));
+
+    auto const& literal_length_table = *m_literal_length_table;
+    auto const& offset_table = *m_offset_table;
+    auto const& match_length_table = *m_match_length_table;
+
+    // 3.1.1.3.2.2. Sequences_Section: The bitstream starts with the initial states, followed by the sequences.
+    auto reader = TRY(BackwardBitReader::create(block));
+    u32 literal_length_state = reader.read_bits(literal_length_table.accuracy_log());
+    u32 offset_state = reader.read_bits(offset_table.accuracy_log());
+    u32 match_length_state = reader.read_bits(match_length_table.accuracy_log());
+
+    for (size_t i = 0; i < sequence_count; ++i) {
+        auto const& literal_length_entry = literal_length_table[literal_length_state];
+        auto const& offset_entry = offset_table[offset_state];
+        auto const& match_length_entry = match_length_table[match_length_state];
+
+        // 3.1.1.3.2.1.1. Sequence Codes for Lengths and Offsets: Offsets use their code as the number of extra bits.
+        reader.reload();
+        u32 const offset_value = (1u << offset_entry.symbol) + reader.read_bits(offset_entry.symbol);
+        reader.reload();
+        auto const& match_length_code = match_length_codes[match_length_entry.symbol];
+        u32 const match_length = match_length_code.baseline + reader.read_bits(match_length_code.number_of_bits);
+        auto const& literal_length_code = literal_length_codes[literal_length_entry.symbol];
+        u32 const literal_length = literal_length_code.baseline + reader.read_bits(literal_length_code.number_of_bits);
+
+        if (i + 1 < sequence_count) {
+            reader.reload();
+            literal_length_state = literal_length_entry.base + reader.read_bits(literal_length_entry.number_of_bits);
+            match_length_state = match_length_entry.base + reader.read_bits(match_length_entry.number_of_bits);
+            offset_state = offset_entry.base + reader.read_bits(offset_entry.number_of_bits);
+        }
+
+        u32 const offset = resolve_offset(m_repeat_offsets, offset_value, literal_length);
+
+        // 3.1.1.4. Sequence Execution
+        if (literal_length > literals.size())
+            return Error::from_string_literal("Zstd sequence has too many literals");
+        if (static_cast<size_t>(output_end - output) < static_cast<size_t>(literal_length) + match_length)
+            return Error::from_string_literal("Zstd block is too large");
+        __builtin_memcpy(output, literals.data(), literal_length);
+        literals = literals.slice(literal_length);
+        output += literal_length;
+
+        if (offset == 0 || offset > static_cast<size_t>(output - output_start))
+            return Error::from_string_literal("Zstd sequence has an invalid offset");
+        copy_match(output, offset, match_length);
+        output += match_length;
+    }
+
+    if (!reader.is_finished())
+        return Error::from_string_literal("Zstd sequences bitstream has an invalid size");
+
+    if (static_cast<size_t>(output_end - output) < literals.size())
+        return Error::from_string_literal("Zstd block is too large");
+    __builtin_memcpy(output, literals.data(), literals.size());
+    output += literals.size();
+
+    m_write_offset = output - output_start;
+    return {};
+}
+
+ErrorOr<size_t> ZstdDecompressor::write_some(ReadonlyBytes)
+{
+    return Error::from_errno(EBADF);
+}
+
+bool ZstdDecompressor::is_eof() const
+{
+    return m_state == State::Done && m_read_offset == m_write_offset;
+}
+
+bool ZstdDecompressor::is_open() const
+{
+    return m_stream->is_open();
+}
+
+void ZstdDecompressor::close()
+{
+}
+
+namespace Zstd {
+
+// The counterpart of FseTable.
+class FseEncoder {
+public:
+    static ErrorOr<FseEncoder> create(ReadonlySpan<i16> normalized_counts, u8 accuracy_log)
+    {
+        size_t const table_size = 1u << accuracy_log;
+
+        FseEncoder encoder;
+        encoder.m_accuracy_log = accuracy_log;
+        TRY(encoder.m_state_table.try_resize(table_size));
+        TRY(encoder.m_symbols.try_resize(normalized_counts.size()));
+
+        // Spread the symbols the same way as FseTable::create() does.
+        Array<u8, 512> table_symbols;
+        Array<u16, 257> cumulative_counts;
+        size_t high_threshold = table_size - 1;
+        cumulative_counts[0] = 0;
+        for (size_t symbol = 0; symbol < normalized_counts.size(); ++symbol) {
+            if (normalized_counts[symbol] == -1) {
+                cumulative_counts[symbol + 1] = cumulative_counts[symbol] + 1;
+                table_symbols[high_threshold--] = symbol;
+            } else {
+                cumulative_counts[symbol + 1] = cumulative_counts[symbol] + normalized_counts[symbol];
+            }
+        }
+
+        size_t const step = (table_size >> 1) + (table_size >> 3) + 3;
+        size_t const mask = table_size - 1;
+        size_t position = 0;
+        for (size_t symbol = 0; symbol < normalized_counts.size(); ++symbol) {
+            for (i16 i = 0; i < normalized_counts[symbol]; ++i) {
+                table_symbols[position] = symbol;
+                do {
+                    position = (position + step) & mask;
+                } while (position > high_threshold);
+            }
+        }
+        VERIFY(position == 0);
+
+        // For each symbol, its states sorted by the state that they transition to when decoding.
+        for (size_t state = 0; state < table_size; ++state)
+            encoder.m_state_table[cumulative_counts[table_symbols[state]]++] = table_size + state;
+
+        i32 total = 0;
+        for (size_t symbol = 0; symbol < normalized_counts.size(); ++symbol) {
+            auto& transform = encoder.m_symbols[symbol];
+            i32 const count = normalized_counts[symbol];
+            if (count == 0) {
+                transform.delta_number_of_bits = ((accuracy_log + 1) << 16) - table_size;
+            } else if (count == -1 || count == 1) {
+                transform.delta_number_of_bits = (accuracy_log << 16) - table_size;
+                transform.delta_find_state = total - 1;
+                ++total;
+            } else {
+                u32 const max_bits_out = accuracy_log - highest_bit(count - 1);
+                u32 const min_state_plus = count << max_bits_out;
+                transform.delta_number_of_bits = (max_bits_out << 16) - min_state_plus;
+                transform.delta_find_state = total - count;
+                total += count;
+            }
+        }
+
+        return encoder;
+    }
+
+    static FseEncoder create_rle()
+    {
+        FseEncoder encoder;
+        encoder.m_is_rle = true;
+        return encoder;
+    }
+
+    // Starts with the state of the smallest number of bits that decodes to the symbol. This is always at least one bit,
+    // which is important for the end detection of FSE-compressed Huffman weights.
+    u32 initial_state(u8 symbol) const
+    {
+        if (m_is_rle)
+            return 0;
+        auto const& transform = m_symbols[symbol];
+        u32 const number_of_bits = (transform.delta_number_of_bits + (1 << 15)) >> 16;
+        u32 const value = (number_of_bits << 16) - transform.delta_number_of_bits;
+        return m_state_table[(value >> number_of_bits) + transform.delta_find_state];
+    }
+
+    ALWAYS_INLINE void encode(BitWriter& writer, u32& state, u8 symbol) const
+    {
+        if (m_is_rle)
+            return;
+        auto const& transform = m_symbols[symbol];
+        u32 const number_of_bits = (state + transform.delta_number_of_bits) >> 16;
+        writer.write_bits(state, number_of_bits);
+        state = m_state_table[(state >> number_of_bits) + transform.delta_find_state];
+    }
+
+    void flush(BitWriter& writer, u32 state) const
+    {
+        if (m_is_rle)
+            return;
+        writer.write_bits(state, m_accuracy_log);
+    }
+
+private:
+    struct SymbolTransform {
+        i32 delta_find_state { 0 };
+        u32 delta_number_of_bits { 0 };
+    };
+
+    Vector<u16> m_state_table;
+    Vector<SymbolTransform> m_symbols;
+    u8 m_accuracy_log { 0 };
+    bool m_is_rle { false };
+};
+
+// Scales the counts of symbols to a sum of 2^accuracy_log, without dropping any of them.
+static FseDistribution normalize_counts(ReadonlySpan<u32> counts, u8 accuracy_log)
+{
+    FseDistribution distribution;
+    distribution.accuracy_log = accuracy_log;
+    distribution.symbol_count = counts.size();
+
+    u64 total = 0;
+    for (auto count : counts)
+        total += count;
+
+    i32 const table_size = 1 << accuracy_log;
+    i32 sum = 0;
+    size_t largest_symbol = 0;
+    for (size_t symbol = 0; symbol < counts.size(); ++symbol) {
+        if (counts[symbol] == 0)
+            continue;
+        i16 normalized = max<i16>(1, (static_cast<u64>(counts[symbol]) * table_size + total / 2) / total);
+        distribution.normalized_counts[symbol] = normalized;
+        sum += normalized;
+        if (counts[symbol] > counts[largest_symbol])
+            largest_symbol = symbol;
+    }
+
+    // Rounding errors are mostly corrected at the most common symbol, which has the smallest relative error.
+    if (sum < table_size) {
+        distribution.normalized_counts[largest_symbol] += table_size - sum;
+    } else {
+        while (sum > table_size) {
+            size_t symbol_to_reduce = largest_symbol;
+            for (size_t symbol = 0; symbol < counts.size(); ++symbol) {
+                if (distribution.normalized_counts[symbol] > distribution.normalized_counts[symbol_to_reduce])
+                    symbol_to_reduce = symbol;
+            }
+            auto reduction = min(sum - table_size, distribution.normalized_counts[symbol_to_reduce] / 4 + 1);
+            distribution.normalized_counts[symbol_to_reduce] -= reduction;
+            sum -= reduction;
+        }
+    }
+
+    return distribution;
+}
+
+static u8 optimal_accuracy_log(size_t symbol_count, size_t max_symbol, u8 max_accuracy_log)
+{
+    // Small inputs don't benefit from large tables, but each symbol needs to fit.
+    u8 accuracy_log = max_accuracy_log;
+    u8 const max_bits_for_input = highest_bit(max<size_t>(symbol_count - 1, 1)) - 2;
+    u8 const min_bits = min(highest_bit(max<size_t>(symbol_count - 1, 1)) + 1, highest_bit(max<size_t>(max_symbol, 1)) + 2);
+    if (max_bits_for_input < accuracy_log)
+        accuracy_log = max_bits_for_input;
+    if (min_bits > accuracy_log)
+        accuracy_log = min_bits;
+    return clamp(accuracy_log, 5, max_accuracy_log);
+}
+
+static double estimate_cost_in_bits(ReadonlySpan<u32> counts, ReadonlySpan<i16> normalized_counts, u8 accuracy_log)
+{
+    double cost = 0;
+    for (size_t symbol = 0; symbol < counts.size(); ++symbol) {
+        if (counts[symbol] == 0)
+            continue;
+        if (symbol >= normalized_counts.size() || normalized_counts[symbol] == 0)
+            return AK::Infinity<double>;
+        double const probability = static_cast<double>(max<i16>(normalized_counts[symbol], 1)) / (1 << accuracy_log);
+        cost -= counts[symbol] * AK::log2(probability);
+    }
+    return cost;
+}
+
+static ALWAYS_INLINE u8 literal_length_code(u32 literal_length)
+{
+    static constexpr auto codes = [] {
+        Array<u8, 64> codes {};
+        size_t code = 0;
+        for (u32 length = 0; length < codes.size(); ++length) {
+            while (code + 1 < literal_length_codes.size() && literal_length_codes[code + 1].baseline <= length)
+                ++code;
+            codes[length] = code;
+        }
+        return codes;
+    }();
+    if (literal_length < codes.size())
+        return codes[literal_length];
+    return highest_bit(literal_length) + 19;
+}
+
+static ALWAYS_INLINE u8 match_length_code(u32 match_length)
+{
+    static constexpr auto codes = [] {
+        Array<u8, 128> codes {};
+        size_t code = 0;
+        for (u32 length = 0; length < codes.size(); ++length) {
+            while (code + 1 < match_length_codes.size() && match_length_codes[code + 1].baseline <= length + 3)
+                ++code;
+            codes[length] = code;
+        }
+        return codes;
+    }();
+    u32 const value = match_length - 3;
+    if (value < codes.size())
+        return codes[value];
+    return highest_bit(value) + 36;
+}
+
+static ALWAYS_INLINE u32 hash(u64 value)
+{
+    // Hashes the first min_match_length bytes.
+    static constexpr u64 prime = 889523592379ull;
+    return ((value << (64 - 8 * ZstdCompressor::min_match_length)) * prime) >> (64 - ZstdCompressor::hash_bits);
+}
+
+static ALWAYS_INLINE size_t count_matching_bytes(u8 const* data, u8 const* match, u8 const* data_end)
+{
+    u8 const* const start = data;
+    while (data + sizeof(u64) <= data_end) {
+        u64 const difference = load_little_endian<u64>(data) ^ load_little_endian<u64>(match);
+        if (difference != 0)
+            return data - start + count_trailing_zeroes(difference) / 8;
+        data += sizeof(u64);
+        match += sizeof(u64);
+    }
+    while (data < data_end && *data == *match) {
+        ++data;
+        ++match;
+    }
+    return data - start;
+}
+
+// 4.2.1. Huffman Tree Description. Returns an empty buffer if the weights can't be described.
+static ErrorOr<ByteBuffer> describe_huffman_weights(ReadonlySpan<u8> weights)
+{
+    ByteBuffer description;
+
+    // 4.2.1.2. FSE Compression of Huffman Weights
+    Array<u32, max_huffman_code_length + 1> counts {};
+    size_t max_weight = 0;
+    size_t distinct_weights = 0;
+    for (auto weight : weights) {
+        if (counts[weight]++ == 0)
+            ++distinct_weights;
+        max_weight = max<size_t>(max_weight, weight);
+    }
+    if (weights.size() > 2 && distinct_weights > 1) {
+        u8 const accuracy_log = weights.size() > 64 ? max_weight_accuracy_log : 5;
+        auto distribution = normalize_counts(counts.span().trim(max_weight + 1), accuracy_log);
+        auto encoder = TRY(FseEncoder::create(distribution.counts(), accuracy_log));
+
+        TRY(description.try_append(0));
+        TRY(write_fse_distribution(description, distribution.counts(), accuracy_log));
+
+        // Two interleaved states, see ZstdDecompressor::read_huffman_table().
+        Array<u8, 128> stream_buffer;
+        BitWriter writer { stream_buffer };
+        size_t index = weights.size();
+        Array<u32, 2> states;
+        if (weights.size() % 2 == 1) {
+            states[0] = encoder.initial_state(weights[--index]);
+            states[1] = encoder.initial_state(weights[--index]);
+            encoder.encode(writer, states[0], weights[--index]);
+        } else {
+            states[1] = encoder.initial_state(weights[--index]);
+            states[0] = encoder.initial_state(weights[--index]);
+        }
+        while (index > 0) {
+            encoder.encode(writer, states[1], weights[--index]);
+            encoder.encode(writer, states[0], weights[--index]);
+        }
+        encoder.flush(writer, states[1]);
+        encoder.flush(writer, states[0]);
+        auto stream_size = writer.finish();
+        TRY(description.try_append(stream_buffer.data(), stream_size));
+
+        if (description.size() - 1 < 128)
+            description[0] = description.size() - 1;
+        else
+            description.clear();
+    }
+
+    // 4.2.1.1. Huffman Tree Header: Direct representation
+    if (weights.size() <= 128 && (description.is_empty() || description.size() > 1 + ceil_div(weights.size(), 2ul))) {
+        description.clear();
+        TRY(description.try_append(127 + weights.size()));
+        for (size_t i = 0; i < weights.size(); i += 2)
+            TRY(description.try_append((weights[i] << 4) | (i + 1 < weights.size() ? weights[i + 1] : 0)));
+    }
+
+    return description;
+}
+
+}
+
+ErrorOr<NonnullOwnPtr<ZstdCompressor>> ZstdCompressor::create(MaybeOwned<Stream> stream)
+{
+    auto buffer = TRY(ByteBuffer::create_uninitialized(2 * window_size + block_size));
+    Vector<u32> hash_table;
+    TRY(hash_table.try_resize(1 << hash_bits));
+    auto compressor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) ZstdCompressor(move(stream), move(buffer), move(hash_table))));
+
+    // 3.1.1.1. Frame_Header: The content size isn't known in advance, so it is left out, and blocks refer to at most
+    // window_size bytes of data before them.
+    TRY(compressor->m_stream->write_value<LittleEndian<u32>>(frame_magic_number));
+    u8 const descriptor = 1 << 2; // Content_Checksum_Flag
+    TRY(compressor->m_stream->write_value<u8>(descriptor));
+    u8 const window_descriptor = (highest_bit(window_size) - 10) << 3;
+    TRY(compressor->m_stream->write_value<u8>(window_descriptor));
+
+    return compressor;
+}
+
+ZstdCompressor::ZstdCompressor(MaybeOwned<Stream> stream, ByteBuffer buffer, Vector<u32> hash_table)
+    : m_stream(move(stream))
+    , m_buffer(move(buffer))
+    , m_hash_table(move(hash_table))
+    , m_repeat_offsets { 1, 4, 8 }
+{
+}
+
+ZstdCompressor::~ZstdCompressor()
+{
+    if (!m_finished) {
+        // Note: We need a better API for specifying things like this.
+        finish().release_value_but_fixme_should_propagate_errors();
+    }
+}
+
+ErrorOr<ByteBuffer> ZstdCompressor::compress_all(ReadonlyBytes bytes)
+{
+    auto output_stream = TRY(try_make<AllocatingMemoryStream>());
+    auto compressor = TRY(ZstdCompressor::create(MaybeOwned<Stream> { *output_stream }));
+    TRY(compressor->write_until_depleted(bytes));
+    TRY(compressor->finish());
+    return output_stream->read_until_eof();
+}
+
+ErrorOr<Bytes> ZstdCompressor::read_some(Bytes)
+{
+    return Error::from_errno(EBADF);
+}
+
+ErrorOr<size_t> ZstdCompressor::write_some(ReadonlyBytes bytes)
+{
+    if (m_finished)
+        return Error::from_string_literal("Tried to write to a finished zstd frame");
+
+    m_checksum.update(bytes);
+    for (auto remaining = bytes; !remaining.is_empty();) {
+        // Blocks are only compressed once more data follows, so that the last block can be marked as such.
+        if (m_buffered_size == m_block_start + block_size)
+            TRY(compress_block(false));
+        auto size = min(remaining.size(), m_block_start + block_size - m_buffered_size);
+        remaining.trim(size).copy_to(m_buffer.bytes().slice(m_buffered_size));
+        m_buffered_size += size;
+        remaining = remaining.slice(size);
+    }
+    return bytes.size();
+}
+
+ErrorOr<void> ZstdCompressor::finish()
+{
+    if (m_finished)
+        return Error::from_string_literal("Finished a zstd frame twice");
+    m_finished = true;
+
+    TRY(compress_block(true));
+    TRY(m_stream->write_value<LittleEndian<u32>>(static_cast<u32>(m_checksum.digest())));
+    return {};
+}
+
+ErrorOr<void> ZstdCompressor::compress_block(bool is_last_block)
+{
+    auto const block = m_buffer.bytes().slice(m_block_start, m_buffered_size - m_block_start);
+    auto const previous_repeat_offsets = m_repeat_offsets;
+
+    m_literals.clear();
+    m_sequences.clear_with_capacity();
+    m_compressed_block.clear();
+    find_sequences(m_block_start, m_buffered_size);
+    TRY(encode_literals(m_literals));
+    TRY(encode_sequences());
+
+    // 3.1.1.2. Blocks: Blocks that don't compress are stored as they are, which leaves the repeat offsets untouched.
+    auto type = BlockType::Compressed;
+    auto content = m_compressed_block.bytes();
+    if (content.size() >= block.size()) {
+        type = BlockType::Raw;
+        content = block;
+        m_repeat_offsets = previous_repeat_offsets;
+    }
+    u32 const header = (is_last_block ? 1 : 0) | (to_underlying(type) << 1) | (content.size() << 3);
+    Array<u8, 3> header_bytes { static_cast<u8>(header), static_cast<u8>(header >> 8), static_cast<u8>(header >> 16) };
+    TRY(m_stream->write_until_depleted(header_bytes));
+    TRY(m_stream->write_until_depleted(content));
+
+    m_block_start = m_buffered_size;
+
+    // Keep window_size bytes of history, and make room for the next block.
+    if (m_buffered_size + block_size > m_buffer.size()) {
+        size_t const shift = m_block_start - min(m_block_start, window_size);
+        memmove(m_buffer.data(), m_buffer.data() + shift, m_buffered_size - shift);
+        m_buffered_size -= shift;
+        m_block_start -= shift;
+        for (auto& position : m_hash_table)
+            position = position >= shift ? position - shift : 0;
+    }
+    return {};
+}
+
+void ZstdCompressor::find_sequences(size_t block_start, size_t block_end)
+{
+    u8 const* const data = m_buffer.data();
+    size_t anchor = block_start;
+
+    auto add_sequence = [&](size_t match_start, size_t match_length, u32 offset) {
+        u32 const literal_length = match_start - anchor;
+
+        // 3.1.1.5. Repeat offsets are cheaper than new ones, and behave differently without literals.
+        u32 offset_value = offset + 3;
+        auto const& repeat_offsets = m_repeat_offsets;
+        if (literal_length > 0) {
+            if (offset == repeat_offsets[0])
+                offset_value = 1;
+            else if (offset == repeat_offsets[1])
+                offset_value = 2;
+            else if (offset == repeat_offsets[2])
+                offset_value = 3;
+        } else {
+            if (offset == repeat_offsets[1])
+                offset_value = 1;
+            else if (offset == repeat_offsets[2])
+                offset_value = 2;
+            else if (offset == repeat_offsets[0] - 1)
+                offset_value = 3;
+        }
+        auto resolved_offset = resolve_offset(m_repeat_offsets, offset_value, literal_length);
+        VERIFY(resolved_offset == offset);
+
+        m_literals.append(data + anchor, literal_length);
+        m_sequences.append({ .literal_length = literal_length, .match_length = static_cast<u32>(match_length), .offset_value = offset_value });
+        anchor = match_start + match_length;
+    };
+
+    // Leave room for the 8-byte reads of the hash function and the repeat offset checks.
+    if (block_end - block_start >= 16) {
+        size_t const limit = block_end - 8;
+        size_t position = block_start;
+        while (position < limit) {
+            u32& hash_table_entry = m_hash_table[hash(load_little_endian<u64>(data + position))];
+            size_t const candidate = hash_table_entry;
+            hash_table_entry = position;
+
+            // Like the reference implementation, check the most recent offset at the next position first.
+            size_t match_start = position + 1;
+            size_t offset = m_repeat_offsets[0];
+            size_t match_length = 0;
+            if (offset <= match_start && offset <= window_size && load_little_endian<u32>(data + match_start) == load_little_endian<u32>(data + match_start - offset)) {
+                match_length = count_matching_bytes(data + match_start + 4, data + match_start + 4 - offset, data + block_end) + 4;
+            } else if (candidate < position && position - candidate <= window_size && load_little_endian<u32>(data + candidate) == load_little_endian<u32>(data + position)) {
+                match_start = position;
+                offset = position - candidate;
+                match_length = count_matching_bytes(data + position + 4, data + candidate + 4, data + block_end) + 4;
+                while (match_start > anchor && match_start > offset && data[match_start - 1] == data[match_start - 1 - offset]) {
+                    --match_start;
+                    ++match_length;
+                }
+            }
+
+            if (match_length < min_match_length) {
+                // Skip ahead faster the longer no match was found, to get through incompressible data quickly.
+                position += 1 + ((position - anchor) >> 6);
+                continue;
+            }
+
+            add_sequence(match_start, match_length, offset);
+            position = anchor;
+
+            if (position < limit) {
+                m_hash_table[hash(load_little_endian<u64>(data + match_start + 2))] = match_start + 2;
+                m_hash_table[hash(load_little_endian<u64>(data + position - 2))] = position - 2;
+            }
+
+            // Continue with the second most recent offset if it matches right away.
+            while (position < limit) {
+                offset = m_repeat_offsets[1];
+                if (offset > position || offset > window_size || load_little_endian<u32>(data + position) != load_little_endian<u32>(data + position - offset))
+                    break;
+                match_length = count_matching_bytes(data + position + 4, data + position + 4 - offset, data + block_end) + 4;
+                m_hash_table[hash(load_little_endian<u64>(data + position))] = position;
+                add_sequence(position, match_length, offset);
+                position = anchor;
+            }
+        }
+    }
+
+    m_literals.append(data + anchor, block_end - anchor);
+}
+
+ErrorOr<void> ZstdCompressor::encode_literals(ReadonlyBytes literals)
+{
+    // 3.1.1.3.1.1. Literals_Section_Header
+    auto write_raw_or_rle_literals = [&](LiteralsBlockType type) -> ErrorOr<void> {
+        size_t const size = literals.size();
+        u8 const type_bits = to_underlying(type);
+        if (size < 32) {
+            TRY(m_compressed_block.try_append(type_bits | (size << 3)));
+        } else if (size < 4096) {
+            TRY(m_compressed_block.try_append(type_bits | (1 << 2) | (size << 4)));
+            TRY(m_compressed_block.try_append(size >> 4));
+        } else {
+            TRY(m_compressed_block.try_append(type_bits | (3 << 2) | (size << 4)));
+            TRY(m_compressed_block.try_append(size >> 4));
+            TRY(m_compressed_block.try_append(size >> 12));
+        }
+        if (type == LiteralsBlockType::Rle)
+            TRY(m_compressed_block.try_append(literals[0]));
+        else
+            TRY(m_compressed_block.try_append(literals));
+        return {};
+    };
+
+    // Huffman coding doesn't pay off for a handful of literals.
+    if (literals.size() < 64)
+        return write_raw_or_rle_literals(LiteralsBlockType::Raw);
+
+    Array<u32, 256> counts {};
+    for (auto literal : literals)
+        ++counts[literal];
+    u32 max_count = 0;
+    size_t last_symbol = 0;
+    for (size_t symbol = 0; symbol < counts.size(); ++symbol) {
+        max_count = max(max_count, counts[symbol]);
+        if (counts[symbol] > 0)
+            last_symbol = symbol;
+    }
+    if (max_count == literals.size())
+        return write_raw_or_rle_literals(LiteralsBlockType::Rle);
+    // Close to uniformly distributed literals won't compress.
+    if (max_count <= (literals.size() >> 7) + 4)
+        return write_raw_or_rle_literals(LiteralsBlockType::Raw);
+
+    // 4.2.1. Huffman Tree Description: Code lengths are described as weights, and the last symbol's weight is implied.
+    Array<u16, 256> frequencies {};
+    u8 const frequency_shift = max(0, static_cast<int>(highest_bit(max_count)) - 15);
+    for (size_t symbol = 0; symbol < counts.size(); ++symbol) {
+        if (counts[symbol] > 0)
+            frequencies[symbol] = max(1u, counts[symbol] >> frequency_shift);
+    }
+    Array<u8, 256> code_lengths {};
+    generate_huffman_lengths(code_lengths, frequencies, max_huffman_code_length);
+    u8 max_number_of_bits = 0;
+    for (auto length : code_lengths)
+        max_number_of_bits = max(max_number_of_bits, length);
+
+    Array<u8, 256> weights {};
+    for (size_t symbol = 0; symbol <= last_symbol; ++symbol)
+        weights[symbol] = code_lengths[symbol] == 0 ? 0 : max_number_of_bits + 1 - code_lengths[symbol];
+    auto description = TRY(describe_huffman_weights(weights.span().trim(last_symbol)));
+    if (description.is_empty())
+        return write_raw_or_rle_literals(LiteralsBlockType::Raw);
+
+    // 4.2.1.3. Huffman Tree Construction: Codes are assigned in order of increasing weight and symbol value.
+    Array<u16, 256> codes {};
+    u32 position = 0;
+    for (u8 weight = 1; weight <= max_number_of_bits; ++weight) {
+        for (size_t symbol = 0; symbol <= last_symbol; ++symbol) {
+            if (weights[symbol] != weight)
+                continue;
+            codes[symbol] = position >> (weight - 1);
+            position += 1u << (weight - 1);
+        }
+    }
+
+    // 3.1.1.3.1.1. Literals_Section_Header: A single stream is only allowed for up to 1023 literals.
+    size_t const regenerated_size = literals.size();
+    size_t const stream_count = regenerated_size < 1024 ? 1 : 4;
+    u8 const size_format = stream_count == 1 ? 0 : regenerated_size < 16 * KiB ? 2 : 3;
+    u8 const size_bits = size_format == 0 ? 10 : size_format == 2 ? 14 : 18;
+    size_t const header_size = size_format == 0 ? 3 : size_format == 2 ? 4 : 5;
+
+    size_t const section_start = m_compressed_block.size();
+    size_t const maximum_stream_size = ceil_div(regenerated_size * max_huffman_code_length, 8ul) + 8 * stream_count;
+    TRY(m_compressed_block.try_resize(section_start + header_size + description.size() + 6 + maximum_stream_size));
+    u8* output = m_compressed_block.data() + section_start + header_size;
+    description.bytes().copy_to({ output, description.size() });
+    output += description.size();
+
+    u8* const jump_table = output;
+    if (stream_count == 4)
+        output += 6;
+
+    size_t const segment_size = ceil_div(regenerated_size, stream_count);
+    for (size_t i = 0; i < stream_count; ++i) {
+        auto segment = literals.slice(i * segment_size, min(segment_size, regenerated_size - i * segment_size));
+        BitWriter writer { { output, static_cast<size_t>(m_compressed_block.data() + m_compressed_block.size() - output) } };
+        // Streams are read backwards, so the literals are written in reverse.
+        for (size_t j = segment.size(); j-- > 0;) {
+            u8 const symbol = segment[j];
+            writer.write_bits(codes[symbol], max_number_of_bits + 1 - weights[symbol]);
+        }
+        auto stream_size = writer.finish();
+        if (i < 3 && stream_count == 4) {
+            if (stream_size > NumericLimits<u16>::max())
+                return write_raw_or_rle_literals(LiteralsBlockType::Raw);
+            store_little_endian(jump_table + i * 2, static_cast<u16>(stream_size));
+        }
+        output += stream_size;
+    }
+
+    size_t const compressed_size = output - (m_compressed_block.data() + section_start + header_size);
+    if (compressed_size >= regenerated_size) {
+        TRY(m_compressed_block.try_resize(section_start));
+        return write_raw_or_rle_literals(LiteralsBlockType::Raw);
+    }
+
+    u64 const header = to_underlying(LiteralsBlockType::Compressed) | (size_format << 2) | (regenerated_size << 4) | (static_cast<u64>(compressed_size) << (4 + size_bits));
+    for (size_t i = 0; i < header_size; ++i)
+        m_compressed_block[section_start + i] = static_cast<u8>(header >> (i * 8));
+    TRY(m_compressed_block.try_resize(output - m_compressed_block.data()));
+    return {};
+}
+
+ErrorOr<void> ZstdCompressor::encode_sequences()
+{
+    // 3.1.1.3.2.1. Sequences_Section_Header
+    size_t const sequence_count = m_sequences.size();
+    if (sequence_count < 128) {
+        TRY(m_compressed_block.try_append(sequence_count));
+    } else if (sequence_count < 0x7f00) {
+        TRY(m_compressed_block.try_append((sequence_count >> 8) + 128));
+        TRY(m_compressed_block.try_append(sequence_count));
+    } else {
+        TRY(m_compressed_block.try_append(255));
+        TRY(m_compressed_block.try_append(sequence_count - 0x7f00));
+        TRY(m_compressed_block.try_append((sequence_count - 0x7f00) >> 8));
+    }
+    if (sequence_count == 0)
+        return {};
+
+    Vector<u8> literal_length_codes_of_sequences;
+    Vector<u8> offset_codes;
+    Vector<u8> match_length_codes_of_sequences;
+    TRY(literal_length_codes_of_sequences.try_ensure_capacity(sequence_count));
+    TRY(offset_codes.try_ensure_capacity(sequence_count));
+    TRY(match_length_codes_of_sequences.try_ensure_capacity(sequence_count));
+    for (auto const& sequence : m_sequences) {
+        literal_length_codes_of_sequences.unchecked_append(literal_length_code(sequence.literal_length));
+        offset_codes.unchecked_append(highest_bit(sequence.offset_value));
+        match_length_codes_of_sequences.unchecked_append(match_length_code(sequence.match_length));
+    }
+
+    // Each kind of code uses whichever of the predefined, RLE or a new FSE table is cheapest.
+    ByteBuffer table_descriptions;
+    auto choose_table = [&](ReadonlySpan<u8> codes, size_t code_count, ReadonlySpan<i16> default_distribution, u8 default_accuracy_log, u8 max_accuracy_log, SymbolCompressionMode& mode) -> ErrorOr<FseEncoder> {
+        Array<u32, 53> counts {};
+        size_t max_code = 0;
+        for (auto code : codes) {
+            ++counts[code];
+            max_code = max<size_t>(max_code, code);
+        }
+        auto const used_counts = counts.span().trim(max(code_count, max_code + 1));
+
+        if (counts[codes[0]] == codes.size()) {
+            mode = SymbolCompressionMode::Rle;
+            TRY(table_descriptions.try_append(codes[0]));
+            return FseEncoder::create_rle();
+        }
+
+        auto const accuracy_log = optimal_accuracy_log(codes.size(), max_code, max_accuracy_log);
+        auto distribution = normalize_counts(used_counts.trim(max_code + 1), accuracy_log);
+        ByteBuffer description;
+        TRY(write_fse_distribution(description, distribution.counts(), accuracy_log));
+
+        double const default_cost = estimate_cost_in_bits(used_counts, default_distribution, default_accuracy_log);
+        double const compressed_cost = estimate_cost_in_bits(used_counts, distribution.counts(), accuracy_log) + description.size() * 8;
+        if (default_cost <= compressed_cost) {
+            mode = SymbolCompressionMode::Predefined;
+            return FseEncoder::create(default_distribution, default_accuracy_log);
+        }
+
+        mode = SymbolCompressionMode::FseCompressed;
+        TRY(table_descriptions.try_append(description));
+        return FseEncoder::create(distribution.counts(), accuracy_log);
+    };
+
+    Array<SymbolCompressionMode, 3> modes;
+    auto const literal_length_encoder = TRY(choose_table(literal_length_codes_of_sequences, literal_length_codes.size(), default_literal_length_distribution, default_literal_length_accuracy_log, max_literal_length_accuracy_log, modes[0]));
+    auto const offset_encoder = TRY(choose_table(offset_codes, default_offset_distribution.size(), default_offset_distribution, default_offset_accuracy_log, max_offset_accuracy_log, modes[1]));
+    auto const match_length_encoder = TRY(choose_table(match_length_codes_of_sequences, match_length_codes.size(), default_match_length_distribution, default_match_length_accuracy_log, max_match_length_accuracy_log, modes[2]));
+
+    TRY(m_compressed_block.try_append((to_underlying(modes[0]) << 6) | (to_underlying(modes[1]) << 4) | (to_underlying(modes[2]) << 2)));
+    TRY(m_compressed_block.try_append(table_descriptions));
+
+    // 3.1.1.3.2.2. Sequences_Section: Sequences are written in reverse, each with its extra bits followed by the bits
+    // of the state transitions that lead to its codes.
+    size_t const stream_start = m_compressed_block.size();
+    TRY(m_compressed_block.try_resize(stream_start + sequence_count * 16 + 16));
+    BitWriter writer { m_compressed_block.bytes().slice(stream_start) };
+
+    auto write_extra_bits = [&](size_t index) {
+        auto const& sequence = m_sequences[index];
+        auto const& literal_length_code = literal_length_codes[literal_length_codes_of_sequences[index]];
+        writer.write_bits(sequence.literal_length - literal_length_code.baseline, literal_length_code.number_of_bits);
+        auto const& match_length_code = match_length_codes[match_length_codes_of_sequences[index]];
+        writer.write_bits(sequence.match_length - match_length_code.baseline, match_length_code.number_of_bits);
+        writer.write_bits(sequence.offset_value, offset_codes[index]);
+    };
+
+    size_t last = sequence_count - 1;
+    u32 match_length_state = match_length_encoder.initial_state(match_length_codes_of_sequences[last]);
+    u32 offset_state = offset_encoder.initial_state(offset_codes[last]);
+    u32 literal_length_state = literal_length_encoder.initial_state(literal_length_codes_of_sequences[last]);
+    write_extra_bits(last);
+    for (size_t i = last; i-- > 0;) {
+        offset_encoder.encode(writer, offset_state, offset_codes[i]);
+        match_length_encoder.encode(writer, match_length_state, match_length_codes_of_sequences[i]);
+        literal_length_encoder.encode(writer, literal_length_state, literal_length_codes_of_sequences[i]);
+        write_extra_bits(i);
+    }
+    match_length_encoder.flush(writer, match_length_state);
+    offset_encoder.flush(writer, offset_state);
+    literal_length_encoder.flush(writer, literal_length_state);
+
+    auto stream_size = writer.finish();
+    TRY(m_compressed_block.try_resize(stream_start + stream_size));
+    return {};
+}
+
+bool ZstdCompressor::is_eof() const
+{
+    return true;
+}
+
+bool ZstdCompressor::is_open() const
+{
+    return !m_finished;
+}
+
+void ZstdCompressor::close()
+{
+    if (!m_finished) {
+        // Note: We need a better API for specifying things like this.
+        finish().release_value_but_fixme_should_propagate_errors();
+    }
+}
+
+}
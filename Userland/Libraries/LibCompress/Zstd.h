@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/ByteBuffer.h>
+#include <AK/MaybeOwned.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/Stream.h>
+#include <AK/Vector.h>
+#include <LibCrypto/Checksum/XXHash64.h>
+
+namespace Compress {
+
+// This implementation is based on the documentation found here:
+// https://datatracker.ietf.org/doc/html/rfc8878
+namespace Zstd {
+
+// 4.1. FSE
+class FseTable {
+public:
+    struct Entry {
+        u16 base { 0 };
+        u8 symbol { 0 };
+        u8 number_of_bits { 0 };
+    };
+
+    FseTable() = default;
+
+    // 4.1.1. FSE Table Description
+    static ErrorOr<FseTable> create(ReadonlySpan<i16> normalized_counts, u8 accuracy_log);
+    static ErrorOr<FseTable> create_rle(u8 symbol);
+
+    u8 accuracy_log() const { return m_accuracy_log; }
+    Entry const& operator[](size_t state) const { return m_entries[state]; }
+
+private:
+    Vector<Entry> m_entries;
+    u8 m_accuracy_log { 0 };
+};
+
+// 4.2. Huffman Coding
+class HuffmanTable {
+public:
+    struct Entry {
+        u8 symbol { 0 };
+        u8 number_of_bits { 0 };
+    };
+
+    HuffmanTable() = default;
+
+    static ErrorOr<HuffmanTable> create(ReadonlySpan<u8> weights);
+
+    u8 max_number_of_bits() const { return m_max_number_of_bits; }
+    Entry const& operator[](size_t index) const { return m_entries[index]; }
+
+private:
+    Vector<Entry> m_entries;
+    u8 m_max_number_of_bits { 0 };
+};
+
+// 3.1.1.5. Sequence Execution
+using RepeatOffsets = Array<u32, 3>;
+
+}
+
+class ZstdDecompressor final : public Stream {
+public:
+    // Frames with larger windows are rejected, as recommended by 3.1.1.1.2.
+    static constexpr size_t maximum_window_size = 128 * MiB;
+
+    static ErrorOr<NonnullOwnPtr<ZstdDecompressor>> create(MaybeOwned<Stream>);
+    static ErrorOr<ByteBuffer> decompress_all(ReadonlyBytes);
+    static bool is_likely_compressed(ReadonlyBytes);
+
+    virtual ErrorOr<Bytes> read_some(Bytes) override;
+    virtual ErrorOr<size_t> write_some(ReadonlyBytes) override;
+    virtual bool is_eof() const override;
+    virtual bool is_open() const override;
+    virtual void close() override;
+
+private:
+    ZstdDecompressor(MaybeOwned<Stream>);
+
+    enum class State {
+        FrameHeader,
+        Block,
+        Done,
+    };
+
+    ErrorOr<void> read_frame_header();
+    ErrorOr<void> read_block();
+    ErrorOr<void> finish_frame();
+
+    ErrorOr<void> decompress_block(ReadonlyBytes);
+    ErrorOr<ReadonlyBytes> decode_literals(ReadonlyBytes& block);
+    ErrorOr<void> read_huffman_table(ReadonlyBytes& block);
+    ErrorOr<void> decode_and_execute_sequences(ReadonlyBytes block, ReadonlyBytes literals);
+
+    MaybeOwned<Stream> m_stream;
+    State m_state { State::FrameHeader };
+
+    // The current frame.
+    size_t m_window_size { 0 };
+    size_t m_block_maximum_size { 0 };
+    Optional<u64> m_content_size;
+    u64 m_frame_size { 0 };
+    Optional<Crypto::Checksum::XXHash64> m_checksum;
+    Zstd::RepeatOffsets m_repeat_offsets {};
+    Optional<Zstd::HuffmanTable> m_huffman_table;
+    Optional<Zstd::FseTable> m_literal_length_table;
+    Optional<Zstd::FseTable> m_offset_table;
+    Optional<Zstd::FseTable> m_match_length_table;
+
+    // Decoded data is kept in this buffer until it is read, and for as long as it can be referenced by later matches.
+    ByteBuffer m_window;
+    size_t m_write_offset { 0 };
+    size_t m_read_offset { 0 };
+
+    ByteBuffer m_block;
+    ByteBuffer m_literals;
+};
+
+// A fast compressor in the spirit of the reference implementation's lowest compression levels: a greedy matcher with a
+// single hash table, Huffman-coded literals and FSE-coded sequences.
+class ZstdCompressor final : public Stream {
+public:
+    static constexpr size_t block_size = 128 * KiB;
+    static constexpr size_t window_size = 1 * MiB;
+    static constexpr size_t hash_bits = 16;
+    static constexpr size_t min_match_length = 5;
+
+    static ErrorOr<NonnullOwnPtr<ZstdCompressor>> create(MaybeOwned<Stream>);
+    ~ZstdCompressor();
+
+    static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes);
+
+    // Compresses the remaining data and finishes the frame with its checksum.
+    ErrorOr<void> finish();
+
+    virtual ErrorOr<Bytes> read_some(Bytes) override;
+    virtual ErrorOr<size_t> write_some(ReadonlyBytes) override;
+    virtual bool is_eof() const override;
+    virtual bool is_open() const override;
+    virtual void close() override;
+
+private:
+    ZstdCompressor(MaybeOwned<Stream>, ByteBuffer buffer, Vector<u32> hash_table);
+
+    struct Sequence {
+        u32 literal_length { 0 };
+        u32 match_length { 0 };
+        u32 offset_value { 0 };
+    };
+
+    ErrorOr<void> compress_block(bool is_last_block);
+    void find_sequences(size_t block_start, size_t block_end);
+    ErrorOr<void> encode_literals(ReadonlyBytes literals);
+    ErrorOr<void> encode_sequences();
+
+    MaybeOwned<Stream> m_stream;
+    bool m_finished { false };
+    Crypto::Checksum::XXHash64 m_checksum;
+
+    // Holds (up to) window_size bytes of history, followed by the data of the next block.
+    ByteBuffer m_buffer;
+    size_t m_buffered_size { 0 };
+    size_t m_block_start { 0 };
+    Vector<u32> m_hash_table;
+
+    Zstd::RepeatOffsets m_repeat_offsets;
+    ByteBuffer m_literals;
+    Vector<Sequence> m_sequences;
+    ByteBuffer m_compressed_block;
+};
+
+}
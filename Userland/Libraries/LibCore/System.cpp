@@ -1731,7 +1731,7 @@ ErrorOr<int> poll(Span<struct pollfd> poll_fds, int timeout)
     return { rc };
 }
 
-#ifdef AK_OS_SERENITY
+#if defined(AK_OS_SERENITY) || defined(AK_OS_LINUX)
 ErrorOr<void> posix_fallocate(int fd, off_t offset, off_t length)
 {
     int rc = ::posix_fallocate(fd, offset, length);
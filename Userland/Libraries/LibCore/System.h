@@ -277,7 +277,7 @@ private:
 
 ErrorOr<AddressInfoVector> getaddrinfo(char const* nodename, char const* servname, struct addrinfo const& hints);
 
-#ifdef AK_OS_SERENITY
+#if defined(AK_OS_SERENITY) || defined(AK_OS_LINUX)
 ErrorOr<void> posix_fallocate(int fd, off_t offset, off_t length);
 #endif
 
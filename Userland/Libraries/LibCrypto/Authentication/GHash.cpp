@@ -6,9 +6,15 @@
 
 #include <AK/ByteReader.h>
 #include <AK/Debug.h>
+#include <AK/Platform.h>
 #include <AK/Types.h>
 #include <LibCrypto/Authentication/GHash.h>
 
+#if ARCH(X86_64)
+#    include <LibCrypto/CPUFeatures.h>
+#    include <immintrin.h>
+#endif
+
 namespace {
 
 static u32 to_u32(u8 const* b)
@@ -23,12 +29,133 @@ static void to_u8s(u8* b, u32 const* w)
     }
 }
 
+#if ARCH(X86_64)
+
+constexpr auto pclmul_features = Crypto::CPUFeatures::PCLMUL | Crypto::CPUFeatures::SSSE3;
+
+// This follows Intel's "Carry-Less Multiplication Instruction and its Usage for Computing the GCM Mode". GHASH treats the
+// bits of a block as reflected, so the blocks are byte-reversed for the multiplication, and the product is shifted left
+// by one bit before it's reduced.
+[[gnu::target("pclmul,ssse3"), gnu::always_inline]] inline __m128i reverse_bytes(__m128i value)
+{
+    return _mm_shuffle_epi8(value, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+[[gnu::target("pclmul,ssse3"), gnu::always_inline]] inline __m128i load_block(u8 const* data)
+{
+    return reverse_bytes(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data)));
+}
+
+// The unreduced 256-bit product of two blocks, which can be accumulated for several products before the reduction.
+struct CarryLessProduct {
+    __m128i low { _mm_setzero_si128() };
+    __m128i middle { _mm_setzero_si128() };
+    __m128i high { _mm_setzero_si128() };
+};
+
+[[gnu::target("pclmul,ssse3"), gnu::always_inline]] inline void multiply_accumulate(CarryLessProduct& product, __m128i a, __m128i b)
+{
+    product.low = _mm_xor_si128(product.low, _mm_clmulepi64_si128(a, b, 0x00));
+    product.middle = _mm_xor_si128(product.middle, _mm_clmulepi64_si128(a, b, 0x10));
+    product.middle = _mm_xor_si128(product.middle, _mm_clmulepi64_si128(a, b, 0x01));
+    product.high = _mm_xor_si128(product.high, _mm_clmulepi64_si128(a, b, 0x11));
+}
+
+[[gnu::target("pclmul,ssse3"), gnu::always_inline]] inline __m128i reduce(CarryLessProduct const& product)
+{
+    auto low = _mm_xor_si128(product.low, _mm_slli_si128(product.middle, 8));
+    auto high = _mm_xor_si128(product.high, _mm_srli_si128(product.middle, 8));
+
+    // Shift the 256-bit product left by one bit.
+    auto low_carries = _mm_srli_epi32(low, 31);
+    auto high_carries = _mm_srli_epi32(high, 31);
+    low = _mm_or_si128(_mm_slli_epi32(low, 1), _mm_slli_si128(low_carries, 4));
+    high = _mm_or_si128(_mm_slli_epi32(high, 1), _mm_slli_si128(high_carries, 4));
+    high = _mm_or_si128(high, _mm_srli_si128(low_carries, 12));
+
+    // Reduce modulo x^128 + x^7 + x^2 + x + 1, in two phases.
+    auto a = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(low, 31), _mm_slli_epi32(low, 30)), _mm_slli_epi32(low, 25));
+    auto carried = _mm_srli_si128(a, 4);
+    low = _mm_xor_si128(low, _mm_slli_si128(a, 12));
+
+    auto b = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(low, 1), _mm_srli_epi32(low, 2)), _mm_srli_epi32(low, 7));
+    b = _mm_xor_si128(b, carried);
+    low = _mm_xor_si128(low, b);
+    return _mm_xor_si128(high, low);
+}
+
+[[gnu::target("pclmul,ssse3"), gnu::always_inline]] inline __m128i galois_multiply_pclmul(__m128i a, __m128i b)
+{
+    CarryLessProduct product;
+    multiply_accumulate(product, a, b);
+    return reduce(product);
+}
+
+// Folds four blocks at a time with the powers of the key, which only needs one reduction for all of them:
+// (((tag + x0) * H + x1) * H + x2) * H + x3) * H = (tag + x0) * H^4 + x1 * H^3 + x2 * H^2 + x3 * H
+[[gnu::target("pclmul,ssse3")]] __m128i ghash_pclmul(__m128i tag, __m128i const (&key_powers)[4], ReadonlyBytes data)
+{
+    while (data.size() >= 64) {
+        CarryLessProduct product;
+        multiply_accumulate(product, _mm_xor_si128(tag, load_block(data.offset(0))), key_powers[3]);
+        multiply_accumulate(product, load_block(data.offset(16)), key_powers[2]);
+        multiply_accumulate(product, load_block(data.offset(32)), key_powers[1]);
+        multiply_accumulate(product, load_block(data.offset(48)), key_powers[0]);
+        tag = reduce(product);
+        data = data.slice(64);
+    }
+
+    while (data.size() >= 16) {
+        tag = galois_multiply_pclmul(_mm_xor_si128(tag, load_block(data.data())), key_powers[0]);
+        data = data.slice(16);
+    }
+
+    if (!data.is_empty()) {
+        u8 buffer[16] = {};
+        data.copy_to({ buffer, sizeof(buffer) });
+        tag = galois_multiply_pclmul(_mm_xor_si128(tag, load_block(buffer)), key_powers[0]);
+    }
+
+    return tag;
+}
+
+[[gnu::target("pclmul,ssse3")]] Crypto::Authentication::GHashDigest ghash_process_pclmul(u32 const (&key)[4], ReadonlyBytes aad, ReadonlyBytes cipher)
+{
+    u8 key_bytes[16];
+    to_u8s(key_bytes, key);
+
+    __m128i key_powers[4];
+    key_powers[0] = load_block(key_bytes);
+    for (size_t i = 1; i < 4; ++i)
+        key_powers[i] = galois_multiply_pclmul(key_powers[i - 1], key_powers[0]);
+
+    auto tag = _mm_setzero_si128();
+    tag = ghash_pclmul(tag, key_powers, aad);
+    tag = ghash_pclmul(tag, key_powers, cipher);
+
+    u8 lengths[16];
+    ByteReader::store(lengths, AK::convert_between_host_and_big_endian(8 * static_cast<u64>(aad.size())));
+    ByteReader::store(lengths + 8, AK::convert_between_host_and_big_endian(8 * static_cast<u64>(cipher.size())));
+    tag = galois_multiply_pclmul(_mm_xor_si128(tag, load_block(lengths)), key_powers[0]);
+
+    Crypto::Authentication::GHashDigest digest;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(digest.data), reverse_bytes(tag));
+    return digest;
+}
+
+#endif
+
 }
 
 namespace Crypto::Authentication {
 
 GHash::TagType GHash::process(ReadonlyBytes aad, ReadonlyBytes cipher)
 {
+#if ARCH(X86_64)
+    if (has_cpu_features(pclmul_features))
+        return ghash_process_pclmul(m_key, aad, cipher);
+#endif
+
     u32 tag[4] { 0, 0, 0, 0 };
 
     auto transform_one = [&](auto& buf) {
@@ -213,8 +213,17 @@ FLATTEN void UnsignedBigIntegerAlgorithms::shift_right_without_allocation(
     size_t num_bits,
     UnsignedBigInteger& output)
 {
-    output.m_words.resize_and_keep_capacity(number.length() - (num_bits / UnsignedBigInteger::BITS_IN_WORD));
+    auto number_of_words = number.length();
+    if (num_bits / UnsignedBigInteger::BITS_IN_WORD >= number_of_words) {
+        output.set_to_0();
+        return;
+    }
+
+    // The shift operates on same-sized storage, after which the top words are zero.
+    output.set_to_0();
+    output.m_words.resize_and_keep_capacity(number_of_words);
     Ops::shift_right(number.words_span(), num_bits, output.words_span());
+    output.m_words.resize_and_keep_capacity(number_of_words - (num_bits / UnsignedBigInteger::BITS_IN_WORD));
 }
 
 void UnsignedBigIntegerAlgorithms::shift_left_by_n_words(
@@ -241,6 +250,20 @@ void UnsignedBigIntegerAlgorithms::shift_right_by_n_words(
     __builtin_memcpy(output.m_words.data(), &number.m_words.data()[number_of_words], (number.m_words.size() - number_of_words) * sizeof(unsigned));
 }
 
+void UnsignedBigIntegerAlgorithms::slice_words(
+    UnsignedBigInteger const& number,
+    size_t start,
+    size_t number_of_words,
+    UnsignedBigInteger& output)
+{
+    // words past the end of the number are zero
+    output.set_to_0();
+    output.m_words.resize_and_keep_capacity(number_of_words);
+    size_t number_of_words_to_copy = start < number.length() ? min(number_of_words, number.length() - start) : 0;
+    __builtin_memcpy(output.m_words.data(), &number.m_words.data()[start], number_of_words_to_copy * sizeof(unsigned));
+    __builtin_memset(&output.m_words.data()[number_of_words_to_copy], 0, (number_of_words - number_of_words_to_copy) * sizeof(unsigned));
+}
+
 /**
  * Returns the word at a requested index in the result of a shift operation
  */
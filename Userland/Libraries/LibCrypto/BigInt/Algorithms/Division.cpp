@@ -14,10 +14,14 @@ namespace Crypto {
 using AK::Detail::div_mod_words;
 using AK::Detail::dword;
 
+// Divisions by numbers with fewer words than this, or with quotients that are shorter than this, use Knuth's algorithm D.
+static constexpr size_t burnikel_ziegler_threshold = 256;
+
 /**
  * Complexity: O(N^2) where N is the number of words in the larger number
  * Division method:
- * Knuth's Algorithm D, see UFixedBigIntDivision.h for more details
+ * Knuth's Algorithm D, see UFixedBigIntDivision.h for more details.
+ * Large divisions with large quotients use burnikel_ziegler_divide() instead.
  */
 FLATTEN void UnsignedBigIntegerAlgorithms::divide_without_allocation(
     UnsignedBigInteger const& numerator,
@@ -71,11 +75,18 @@ FLATTEN void UnsignedBigIntegerAlgorithms::divide_without_allocation(
         return;
     }
 
+    if (divisor_len >= burnikel_ziegler_threshold && dividend_len - divisor_len >= burnikel_ziegler_threshold) {
+        burnikel_ziegler_divide(numerator, denominator, quotient, remainder);
+        return;
+    }
+
     // Knuth's algorithm D
     auto dividend = numerator;
     dividend.resize_with_leading_zeros(dividend_len + 1);
     auto divisor = denominator;
 
+    quotient.set_to_0();
+    remainder.set_to_0();
     quotient.resize_with_leading_zeros(dividend_len - divisor_len + 1);
     remainder.resize_with_leading_zeros(divisor_len);
 
@@ -85,6 +96,143 @@ FLATTEN void UnsignedBigIntegerAlgorithms::divide_without_allocation(
         dividend_len, divisor_len);
 }
 
+/**
+ * Complexity: O(M(N) log N) where M(N) is the complexity of multiplying N-word numbers
+ * Division method:
+ * Recursive division from Burnikel and Ziegler, "Fast Recursive Division".
+ * The divisor is normalized to n words with the highest bit set, where n halves evenly until it's below
+ * burnikel_ziegler_threshold. The numerator is then divided in blocks of n words, from the most significant
+ * one, where every step divides 2n words by n words with two recursive 3n/2 by n divisions.
+ */
+void UnsignedBigIntegerAlgorithms::burnikel_ziegler_divide(
+    UnsignedBigInteger const& numerator,
+    UnsignedBigInteger const& denominator,
+    UnsignedBigInteger& quotient,
+    UnsignedBigInteger& remainder)
+{
+    size_t divisor_len = denominator.trimmed_length();
+
+    size_t levels = 0;
+    while (ceil_div(divisor_len, 1uz << levels) >= burnikel_ziegler_threshold)
+        ++levels;
+    size_t block_len = ceil_div(divisor_len, 1uz << levels) << levels;
+
+    size_t shift = block_len * UnsignedBigInteger::BITS_IN_WORD - denominator.one_based_index_of_highest_set_bit();
+    auto divisor = denominator.shift_left(shift);
+    auto dividend = numerator.shift_left(shift);
+    divisor.clamp_to_trimmed_length();
+
+    // The most significant block must have its highest bit clear, so that it's smaller than the divisor.
+    size_t block_count = max(2uz, ceil_div(dividend.one_based_index_of_highest_set_bit() + 1, block_len * UnsignedBigInteger::BITS_IN_WORD));
+
+    quotient.set_to_0();
+    quotient.resize_with_leading_zeros((block_count - 1) * block_len);
+
+    UnsignedBigInteger block_dividend;
+    UnsignedBigInteger block_quotient;
+    UnsignedBigInteger block_remainder;
+    UnsignedBigInteger next_block;
+    slice_words(dividend, (block_count - 2) * block_len, 2 * block_len, block_dividend);
+
+    for (size_t i = block_count - 1; i-- > 0;) {
+        divide_2n_by_n(block_dividend, divisor, block_len, block_quotient, block_remainder);
+
+        auto quotient_words = min(block_quotient.length(), block_len);
+        __builtin_memcpy(&quotient.m_words.data()[i * block_len], block_quotient.m_words.data(), quotient_words * sizeof(UnsignedBigInteger::Word));
+
+        if (i > 0) {
+            // block_dividend = block_remainder * B^n + the next block of the dividend
+            shift_left_by_n_words(block_remainder, block_len, block_dividend);
+            slice_words(dividend, (i - 1) * block_len, block_len, next_block);
+            __builtin_memcpy(block_dividend.m_words.data(), next_block.m_words.data(), block_len * sizeof(UnsignedBigInteger::Word));
+        }
+    }
+
+    quotient.clamp_to_trimmed_length();
+    block_remainder.resize_with_leading_zeros(block_len);
+    remainder.set_to(block_remainder.shift_right(shift));
+    remainder.clamp_to_trimmed_length();
+}
+
+// Divides a numerator with (up to) 2n words by a normalized denominator with n words, where numerator < denominator * B^n.
+void UnsignedBigIntegerAlgorithms::divide_2n_by_n(
+    UnsignedBigInteger const& numerator,
+    UnsignedBigInteger const& denominator,
+    size_t n,
+    UnsignedBigInteger& quotient,
+    UnsignedBigInteger& remainder)
+{
+    if (n % 2 != 0 || n < burnikel_ziegler_threshold) {
+        divide_without_allocation(numerator, denominator, quotient, remainder);
+        return;
+    }
+
+    size_t half = n / 2;
+    UnsignedBigInteger upper_part;
+    UnsignedBigInteger lower_part;
+    UnsignedBigInteger upper_quotient;
+    UnsignedBigInteger upper_remainder;
+    UnsignedBigInteger lower_quotient;
+
+    slice_words(numerator, half, 3 * half, upper_part);
+    divide_3n_by_2n(upper_part, denominator, half, upper_quotient, upper_remainder);
+
+    shift_left_by_n_words(upper_remainder, half, lower_part);
+    for (size_t i = 0; i < half; ++i)
+        lower_part.m_words[i] = i < numerator.length() ? numerator.m_words[i] : 0;
+    divide_3n_by_2n(lower_part, denominator, half, lower_quotient, remainder);
+
+    // quotient = upper_quotient * B^(n/2) + lower_quotient
+    shift_left_by_n_words(upper_quotient, half, quotient);
+    add_into_accumulator_without_allocation(quotient, lower_quotient);
+}
+
+// Divides a numerator with (up to) 3n words by a normalized denominator with 2n words, where numerator < denominator * B^n.
+void UnsignedBigIntegerAlgorithms::divide_3n_by_2n(
+    UnsignedBigInteger const& numerator,
+    UnsignedBigInteger const& denominator,
+    size_t n,
+    UnsignedBigInteger& quotient,
+    UnsignedBigInteger& remainder)
+{
+    UnsignedBigInteger denominator_high;
+    UnsignedBigInteger denominator_low;
+    UnsignedBigInteger numerator_high;
+    UnsignedBigInteger numerator_top;
+    slice_words(denominator, n, n, denominator_high);
+    slice_words(denominator, 0, n, denominator_low);
+    slice_words(numerator, n, 2 * n, numerator_high);
+    slice_words(numerator, 2 * n, n, numerator_top);
+
+    // Estimate the quotient from the upper words, which is at most 2 too large.
+    UnsignedBigInteger partial_remainder;
+    if (numerator_top < denominator_high) {
+        divide_2n_by_n(numerator_high, denominator_high, n, quotient, partial_remainder);
+    } else {
+        // quotient = B^n - 1, partial_remainder = numerator_high - denominator_high * B^n + denominator_high
+        quotient.set_to_0();
+        quotient.m_words.resize_and_keep_capacity(n);
+        for (auto& word : quotient.m_words)
+            word = NumericLimits<UnsignedBigInteger::Word>::max();
+        partial_remainder = numerator_high.plus(denominator_high).minus(denominator_high.shift_left(n * UnsignedBigInteger::BITS_IN_WORD));
+    }
+
+    UnsignedBigInteger product;
+    UnsignedBigInteger temp;
+    multiply_without_allocation(quotient, denominator_low, temp, product);
+
+    // remainder = partial_remainder * B^n + the lowest n words of the numerator - product, corrected to be non-negative.
+    shift_left_by_n_words(partial_remainder, n, remainder);
+    for (size_t i = 0; i < n; ++i)
+        remainder.m_words[i] = i < numerator.length() ? numerator.m_words[i] : 0;
+
+    while (remainder < product) {
+        remainder.set_to(remainder.plus(denominator));
+        quotient.set_to(quotient.minus(1));
+    }
+    remainder.set_to(remainder.minus(product));
+}
+
 /**
  * Complexity : O(N) where N is the number of digits in the numerator
  * Division method :
@@ -6,41 +6,348 @@
  */
 
 #include "UnsignedBigIntegerAlgorithms.h"
+#include <AK/BigIntBase.h>
+#include <LibCrypto/BigInt/SignedBigInteger.h>
 
 namespace Crypto {
 
+using AK::Detail::add_words;
+using AK::Detail::sub_words;
+using AK::Detail::wide_multiply;
+using Word = UnsignedBigInteger::Word;
+using DoubleWord = AK::Detail::DoubleWord<Word>;
+
+// Operands with fewer words than this are multiplied with the schoolbook method.
+static constexpr size_t karatsuba_threshold = 32;
+// Operands with at least this many words are split into three parts instead of two.
+static constexpr size_t toom_3_threshold = 2048;
+
+// Adds `value` into `accumulator`, propagating the carry through the rest of the accumulator.
+// Words of `value` that don't fit into the accumulator must be zero, and so must the final carry.
+static void add_into(Span<Word> accumulator, ReadonlySpan<Word> value)
+{
+    bool carry = false;
+    size_t i = 0;
+    for (; i < value.size() && i < accumulator.size(); ++i)
+        accumulator[i] = add_words(accumulator[i], value[i], carry);
+    for (; carry && i < accumulator.size(); ++i)
+        accumulator[i] = add_words(accumulator[i], Word { 0 }, carry);
+    VERIFY(!carry);
+    for (; i < value.size(); ++i)
+        VERIFY(value[i] == 0);
+}
+
+// Subtracts `value` from `accumulator`, which must be at least as large as `value`.
+static void subtract_from(Span<Word> accumulator, ReadonlySpan<Word> value)
+{
+    bool borrow = false;
+    size_t i = 0;
+    for (; i < value.size(); ++i)
+        accumulator[i] = sub_words(accumulator[i], value[i], borrow);
+    for (; borrow && i < accumulator.size(); ++i)
+        accumulator[i] = sub_words(accumulator[i], Word { 0 }, borrow);
+    VERIFY(!borrow);
+}
+
+// Stores left + right into `output`, which must be one word longer than the longer operand.
+static void add_to(ReadonlySpan<Word> left, ReadonlySpan<Word> right, Span<Word> output)
+{
+    bool carry = false;
+    for (size_t i = 0; i < output.size() - 1; ++i) {
+        Word left_word = i < left.size() ? left[i] : 0;
+        Word right_word = i < right.size() ? right[i] : 0;
+        output[i] = add_words(left_word, right_word, carry);
+    }
+    output[output.size() - 1] = carry;
+}
+
 /**
- * Complexity: O(N^2) where N is the number of words in the larger number
+ * Complexity: O(N*M) where N and M are the number of words in the operands
  * Multiplication method:
- * An integer is equal to the sum of the powers of two
- * according to the indices of its 'on' bits.
- * So to multiple x*y, we go over each '1' bit in x (say the i'th bit),
- * and add y<<i to the result.
+ * Every word of the left operand is multiplied by the right operand into a
+ * row of double words, which is then added to the output.
+ */
+static void schoolbook_multiply(ReadonlySpan<Word> left, ReadonlySpan<Word> right, Span<Word> output)
+{
+    VERIFY(output.size() == left.size() + right.size());
+    output.fill(0);
+
+    for (size_t i = 0; i < left.size(); ++i) {
+        Word carry = 0;
+        auto left_word = left[i];
+        if (left_word == 0)
+            continue;
+        for (size_t j = 0; j < right.size(); ++j) {
+            // This can't overflow: (2^32 - 1)^2 + 2 * (2^32 - 1) == 2^64 - 1.
+            DoubleWord product = wide_multiply(left_word, right[j]) + output[i + j] + carry;
+            output[i + j] = static_cast<Word>(product);
+            carry = static_cast<Word>(product >> UnsignedBigInteger::BITS_IN_WORD);
+        }
+        output[i + right.size()] = carry;
+    }
+}
+
+/**
+ * Complexity: O(N^2), but with about half the word multiplications of schoolbook_multiply()
+ * Squaring method:
+ * The products of different words appear twice in a square, so each of them is
+ * only computed once and the sum is doubled, before adding the squares of the words.
+ */
+static void schoolbook_square(ReadonlySpan<Word> value, Span<Word> output)
+{
+    VERIFY(output.size() == 2 * value.size());
+    output.fill(0);
+
+    for (size_t i = 0; i < value.size(); ++i) {
+        Word carry = 0;
+        for (size_t j = i + 1; j < value.size(); ++j) {
+            DoubleWord product = wide_multiply(value[i], value[j]) + output[i + j] + carry;
+            output[i + j] = static_cast<Word>(product);
+            carry = static_cast<Word>(product >> UnsignedBigInteger::BITS_IN_WORD);
+        }
+        output[i + value.size()] = carry;
+    }
+
+    Word top_bit = 0;
+    for (size_t i = 0; i < output.size(); ++i) {
+        auto word = output[i];
+        output[i] = (word << 1) | top_bit;
+        top_bit = word >> (UnsignedBigInteger::BITS_IN_WORD - 1);
+    }
+
+    bool carry = false;
+    for (size_t i = 0; i < value.size(); ++i) {
+        auto square = wide_multiply(value[i], value[i]);
+        output[2 * i] = add_words(output[2 * i], static_cast<Word>(square), carry);
+        output[2 * i + 1] = add_words(output[2 * i + 1], static_cast<Word>(square >> UnsignedBigInteger::BITS_IN_WORD), carry);
+    }
+    VERIFY(!carry);
+}
+
+// An upper bound for the scratch space (in words) of karatsuba_multiply() and karatsuba_square().
+static size_t karatsuba_scratch_size(size_t total_length)
+{
+    // Every level of recursion takes at most twice the length of its operands plus a few words, and the operands halve
+    // with every level.
+    return 4 * total_length + 8 * UnsignedBigInteger::BITS_IN_WORD;
+}
+
+static void karatsuba_multiply(ReadonlySpan<Word> left, ReadonlySpan<Word> right, Span<Word> output, Span<Word> scratch);
+
+// Multiplies operands with very different lengths by splitting the longer one into pieces the size of the shorter one.
+static void unbalanced_multiply(ReadonlySpan<Word> left, ReadonlySpan<Word> right, Span<Word> output, Span<Word> scratch)
+{
+    auto piece_length = right.size();
+    auto product = scratch.slice(0, 2 * piece_length);
+    scratch = scratch.slice(2 * piece_length);
+
+    output.fill(0);
+    for (size_t offset = 0; offset < left.size(); offset += piece_length) {
+        auto piece = left.slice(offset, min(piece_length, left.size() - offset));
+        auto piece_product = product.slice(0, piece.size() + right.size());
+        karatsuba_multiply(right, piece, piece_product, scratch);
+        add_into(output.slice(offset), piece_product);
+    }
+}
+
+/**
+ * Complexity: O(N^log2(3)) where N is the number of words in the larger number
+ * Multiplication method:
+ * Split both operands at half of the longer one, so that left = l1 * B + l0 and right = r1 * B + r0.
+ * Then left * right = l1 * r1 * B^2 + ((l0 + l1) * (r0 + r1) - l0 * r0 - l1 * r1) * B + l0 * r0,
+ * which takes three half-size multiplications instead of four.
+ */
+static void karatsuba_multiply(ReadonlySpan<Word> left, ReadonlySpan<Word> right, Span<Word> output, Span<Word> scratch)
+{
+    if (left.size() < right.size())
+        swap(left, right);
+    VERIFY(output.size() == left.size() + right.size());
+
+    if (right.size() < karatsuba_threshold) {
+        schoolbook_multiply(left, right, output);
+        return;
+    }
+
+    auto half = (left.size() + 1) / 2;
+    if (right.size() <= half) {
+        unbalanced_multiply(left, right, output, scratch);
+        return;
+    }
+
+    auto left_low = left.trim(half);
+    auto left_high = left.slice(half);
+    auto right_low = right.trim(half);
+    auto right_high = right.slice(half);
+
+    auto low_product = output.slice(0, 2 * half);
+    auto high_product = output.slice(2 * half);
+    karatsuba_multiply(left_low, right_low, low_product, scratch);
+    karatsuba_multiply(left_high, right_high, high_product, scratch);
+
+    auto left_sum = scratch.slice(0, half + 1);
+    auto right_sum = scratch.slice(half + 1, half + 1);
+    auto middle_product = scratch.slice(2 * half + 2, 2 * half + 2);
+    add_to(left_low, left_high, left_sum);
+    add_to(right_low, right_high, right_sum);
+    karatsuba_multiply(left_sum, right_sum, middle_product, scratch.slice(4 * half + 4));
+
+    subtract_from(middle_product, low_product);
+    subtract_from(middle_product, high_product);
+    add_into(output.slice(half), middle_product);
+}
+
+// Like karatsuba_multiply(), but for squares: left^2 = l1^2 * B^2 + ((l0 + l1)^2 - l0^2 - l1^2) * B + l0^2.
+static void karatsuba_square(ReadonlySpan<Word> value, Span<Word> output, Span<Word> scratch)
+{
+    VERIFY(output.size() == 2 * value.size());
+
+    if (value.size() < karatsuba_threshold) {
+        schoolbook_square(value, output);
+        return;
+    }
+
+    auto half = (value.size() + 1) / 2;
+    auto low = value.trim(half);
+    auto high = value.slice(half);
+
+    auto low_square = output.slice(0, 2 * half);
+    auto high_square = output.slice(2 * half);
+    karatsuba_square(low, low_square, scratch);
+    karatsuba_square(high, high_square, scratch);
+
+    auto sum = scratch.slice(0, half + 1);
+    auto middle_square = scratch.slice(half + 1, 2 * half + 2);
+    add_to(low, high, sum);
+    karatsuba_square(sum, middle_square, scratch.slice(3 * half + 3));
+
+    subtract_from(middle_square, low_square);
+    subtract_from(middle_square, high_square);
+    add_into(output.slice(half), middle_square);
+}
+
+/**
+ * Complexity: O(N^log3(5)) where N is the number of words in the larger number
+ * Multiplication method:
+ * Toom-Cook 3-way multiplication, splitting both operands into three parts: left = l2 * B^2 + l1 * B + l0.
+ * The product is a polynomial of degree 4 in B, which is evaluated at 0, 1, -1, -2 and infinity with five
+ * third-size multiplications and interpolated with the sequence from Bodrato and Zanoni,
+ * "Integer and Polynomial Multiplication: Towards Optimal Toom-Cook Matrices".
+ */
+void UnsignedBigIntegerAlgorithms::toom_3_multiply(
+    UnsignedBigInteger const& left,
+    UnsignedBigInteger const& right,
+    size_t part_length,
+    UnsignedBigInteger& output)
+{
+    struct Evaluation {
+        SignedBigInteger at_0;
+        SignedBigInteger at_1;
+        SignedBigInteger at_minus_1;
+        SignedBigInteger at_minus_2;
+        SignedBigInteger at_infinity;
+    };
+
+    auto evaluate = [&](UnsignedBigInteger const& number) {
+        UnsignedBigInteger part;
+        slice_words(number, 0, part_length, part);
+        SignedBigInteger part_0 { part };
+        slice_words(number, part_length, part_length, part);
+        SignedBigInteger part_1 { part };
+        slice_words(number, 2 * part_length, part_length, part);
+        SignedBigInteger part_2 { part };
+
+        auto sum_of_even_parts = part_0.plus(part_2);
+        return Evaluation {
+            .at_0 = part_0,
+            .at_1 = sum_of_even_parts.plus(part_1),
+            .at_minus_1 = sum_of_even_parts.minus(part_1),
+            .at_minus_2 = part_0.minus(part_1.shift_left(1)).plus(part_2.shift_left(2)),
+            .at_infinity = part_2,
+        };
+    };
+
+    auto left_values = evaluate(left);
+    auto right_values = evaluate(right);
+
+    auto r0 = left_values.at_0.multiplied_by(right_values.at_0);
+    auto r1 = left_values.at_1.multiplied_by(right_values.at_1);
+    auto r_minus_1 = left_values.at_minus_1.multiplied_by(right_values.at_minus_1);
+    auto r_minus_2 = left_values.at_minus_2.multiplied_by(right_values.at_minus_2);
+    auto r_infinity = left_values.at_infinity.multiplied_by(right_values.at_infinity);
+
+    // All of these divisions are exact.
+    auto c3 = r_minus_2.minus(r1).divided_by(UnsignedBigInteger { 3 }).quotient;
+    auto c1 = r1.minus(r_minus_1).divided_by(UnsignedBigInteger { 2 }).quotient;
+    auto c2 = r_minus_1.minus(r0);
+    c3 = c2.minus(c3).divided_by(UnsignedBigInteger { 2 }).quotient.plus(r_infinity.shift_left(1));
+    c2 = c2.plus(c1).minus(r_infinity);
+    c1 = c1.minus(c3);
+
+    auto bits_per_part = part_length * UnsignedBigInteger::BITS_IN_WORD;
+    auto result = r0;
+    result = result.plus(c1.shift_left(bits_per_part));
+    result = result.plus(c2.shift_left(2 * bits_per_part));
+    result = result.plus(c3.shift_left(3 * bits_per_part));
+    result = result.plus(r_infinity.shift_left(4 * bits_per_part));
+    VERIFY(!result.is_negative());
+    output.set_to(result.unsigned_value());
+}
+
+/**
+ * Complexity: O(N^2) for small numbers, down to O(N^1.47) for large balanced ones
+ * Multiplication method:
+ * Word-level schoolbook multiplication (or squaring, when both operands are the same object),
+ * Karatsuba above karatsuba_threshold words and Toom-3 above toom_3_threshold words.
+ * `temp` is used as scratch space, so it can be reused between calls to avoid allocations.
  */
 FLATTEN void UnsignedBigIntegerAlgorithms::multiply_without_allocation(
     UnsignedBigInteger const& left,
     UnsignedBigInteger const& right,
-    UnsignedBigInteger& temp_shift_result,
-    UnsignedBigInteger& temp_shift_plus,
-    UnsignedBigInteger& temp_shift,
+    UnsignedBigInteger& temp,
     UnsignedBigInteger& output)
 {
-    output.set_to_0();
+    VERIFY(&output != &left && &output != &right && &temp != &output);
 
-    // iterate all bits
-    for (size_t word_index = 0; word_index < left.length(); ++word_index) {
-        for (size_t bit_index = 0; bit_index < UnsignedBigInteger::BITS_IN_WORD; ++bit_index) {
-            // If the bit is off - skip over it
-            if (!(left.m_words[word_index] & (1 << bit_index)))
-                continue;
+    auto left_length = left.trimmed_length();
+    auto right_length = right.trimmed_length();
 
-            size_t shift_amount = word_index * UnsignedBigInteger::BITS_IN_WORD + bit_index;
+    if (left_length == 0 || right_length == 0) {
+        output.set_to_0();
+        return;
+    }
 
-            // output += (right << shift_amount);
-            shift_left_without_allocation(right, shift_amount, temp_shift_result, temp_shift_plus, temp_shift);
-            add_into_accumulator_without_allocation(output, temp_shift);
-        }
+    auto left_words = left.words_span().trim(left_length);
+    auto right_words = right.words_span().trim(right_length);
+    bool is_square = &left == &right;
+
+    // Toom-3 only pays off when the operands have similar lengths, as the top parts would be empty otherwise.
+    auto part_length = (max(left_length, right_length) + 2) / 3;
+    if (min(left_length, right_length) >= toom_3_threshold && min(left_length, right_length) > 2 * part_length) {
+        toom_3_multiply(left, right, part_length, output);
+        output.clamp_to_trimmed_length();
+        return;
     }
+
+    output.set_to_0();
+    output.m_words.resize_and_keep_capacity(left_length + right_length);
+
+    if (min(left_length, right_length) < karatsuba_threshold) {
+        if (is_square)
+            schoolbook_square(left_words, output.words_span());
+        else if (left_length >= right_length)
+            schoolbook_multiply(left_words, right_words, output.words_span());
+        else
+            schoolbook_multiply(right_words, left_words, output.words_span());
+    } else {
+        temp.set_to_0();
+        temp.m_words.resize_and_keep_capacity(karatsuba_scratch_size(left_length + right_length));
+        if (is_square)
+            karatsuba_square(left_words, output.words_span(), temp.words_span());
+        else
+            karatsuba_multiply(left_words, right_words, output.words_span(), temp.words_span());
+    }
+
+    output.clamp_to_trimmed_length();
 }
 
 }
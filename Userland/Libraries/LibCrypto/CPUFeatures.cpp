@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/Platform.h>
+#include <LibCrypto/CPUFeatures.h>
+
+#if ARCH(X86_64)
+#    include <cpuid.h>
+#endif
+
+namespace Crypto {
+
+static Atomic<u32, AK::MemoryOrder::memory_order_relaxed> s_enabled_features { to_underlying(CPUFeatures::All) };
+
+static CPUFeatures detect_cpu_features()
+{
+    auto features = CPUFeatures::None;
+
+#if ARCH(X86_64)
+    u32 eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        if (ecx & bit_SSSE3)
+            features |= CPUFeatures::SSSE3;
+        if (ecx & bit_SSE4_1)
+            features |= CPUFeatures::SSE41;
+        if (ecx & bit_AES)
+            features |= CPUFeatures::AES;
+        if (ecx & bit_PCLMUL)
+            features |= CPUFeatures::PCLMUL;
+    }
+
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        if (ebx & bit_SHA)
+            features |= CPUFeatures::SHA;
+    }
+#endif
+
+    return features;
+}
+
+CPUFeatures cpu_features()
+{
+    static CPUFeatures const s_detected_features = detect_cpu_features();
+    return s_detected_features & static_cast<CPUFeatures>(s_enabled_features.load());
+}
+
+void set_enabled_cpu_features(CPUFeatures features)
+{
+    s_enabled_features.store(to_underlying(features));
+}
+
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/EnumBits.h>
+#include <AK/NumericLimits.h>
+#include <AK/Types.h>
+
+namespace Crypto {
+
+// Instruction set extensions that the accelerated implementations of some algorithms rely on.
+// Every algorithm keeps a portable implementation, which is used when any of the features it needs is missing.
+enum class CPUFeatures : u32 {
+    None = 0,
+    SSSE3 = 1 << 0,
+    SSE41 = 1 << 1,
+    AES = 1 << 2,    // AES-NI
+    PCLMUL = 1 << 3, // PCLMULQDQ
+    SHA = 1 << 4,    // SHA-NI
+    All = NumericLimits<u32>::max(),
+};
+
+AK_ENUM_BITWISE_OPERATORS(CPUFeatures);
+
+// Returns the features of this CPU that may be used, which are detected once with CPUID.
+CPUFeatures cpu_features();
+
+inline bool has_cpu_features(CPUFeatures features)
+{
+    return has_flag(cpu_features(), features);
+}
+
+// Limits the features that later operations may use, to compare or test the portable implementations.
+void set_enabled_cpu_features(CPUFeatures);
+
+}
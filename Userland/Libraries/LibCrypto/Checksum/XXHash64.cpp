@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <LibCrypto/Checksum/XXHash64.h>
+
+namespace Crypto::Checksum {
+
+static constexpr u64 prime_1 = 0x9E3779B185EBCA87;
+static constexpr u64 prime_2 = 0xC2B2AE3D27D4EB4F;
+static constexpr u64 prime_3 = 0x165667B19E3779F9;
+static constexpr u64 prime_4 = 0x85EBCA77C2B2AE63;
+static constexpr u64 prime_5 = 0x27D4EB2F165667C5;
+
+static ALWAYS_INLINE u64 rotate_left(u64 value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static ALWAYS_INLINE u64 round(u64 accumulator, u64 lane)
+{
+    accumulator += lane * prime_2;
+    accumulator = rotate_left(accumulator, 31);
+    return accumulator * prime_1;
+}
+
+static ALWAYS_INLINE u64 merge_accumulator(u64 accumulator, u64 value)
+{
+    accumulator ^= round(0, value);
+    return accumulator * prime_1 + prime_4;
+}
+
+static ALWAYS_INLINE u64 read_u64(u8 const* data)
+{
+    return AK::convert_between_host_and_little_endian(ByteReader::load64(data));
+}
+
+static ALWAYS_INLINE u32 read_u32(u8 const* data)
+{
+    return AK::convert_between_host_and_little_endian(ByteReader::load32(data));
+}
+
+XXHash64::XXHash64(u64 seed)
+    : m_seed(seed)
+    , m_accumulators { seed + prime_1 + prime_2, seed + prime_2, seed, seed - prime_1 }
+{
+}
+
+void XXHash64::consume_stripe(u8 const* stripe)
+{
+    for (size_t i = 0; i < 4; ++i)
+        m_accumulators[i] = round(m_accumulators[i], read_u64(stripe + i * 8));
+}
+
+void XXHash64::update(ReadonlyBytes data)
+{
+    m_total_length += data.size();
+
+    if (m_buffered_bytes > 0) {
+        auto count = min(data.size(), stripe_size - m_buffered_bytes);
+        data.slice(0, count).copy_to(Bytes { m_buffer }.slice(m_buffered_bytes));
+        m_buffered_bytes += count;
+        data = data.slice(count);
+        if (m_buffered_bytes < stripe_size)
+            return;
+        consume_stripe(m_buffer.data());
+        m_buffered_bytes = 0;
+    }
+
+    while (data.size() >= stripe_size) {
+        consume_stripe(data.data());
+        data = data.slice(stripe_size);
+    }
+
+    data.copy_to(m_buffer);
+    m_buffered_bytes = data.size();
+}
+
+u64 XXHash64::digest()
+{
+    u64 hash;
+    if (m_total_length >= stripe_size) {
+        hash = rotate_left(m_accumulators[0], 1) + rotate_left(m_accumulators[1], 7) + rotate_left(m_accumulators[2], 12) + rotate_left(m_accumulators[3], 18);
+        for (auto accumulator : m_accumulators)
+            hash = merge_accumulator(hash, accumulator);
+    } else {
+        hash = m_seed + prime_5;
+    }
+
+    hash += m_total_length;
+
+    u8 const* remaining = m_buffer.data();
+    size_t remaining_size = m_buffered_bytes;
+    for (; remaining_size >= 8; remaining += 8, remaining_size -= 8) {
+        hash ^= round(0, read_u64(remaining));
+        hash = rotate_left(hash, 27) * prime_1 + prime_4;
+    }
+    if (remaining_size >= 4) {
+        hash ^= static_cast<u64>(read_u32(remaining)) * prime_1;
+        hash = rotate_left(hash, 23) * prime_2 + prime_3;
+        remaining += 4;
+        remaining_size -= 4;
+    }
+    for (; remaining_size > 0; ++remaining, --remaining_size) {
+        hash ^= *remaining * prime_5;
+        hash = rotate_left(hash, 11) * prime_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime_2;
+    hash ^= hash >> 29;
+    hash *= prime_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+}
@@ -4,10 +4,18 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <AK/Platform.h>
 #include <AK/StringBuilder.h>
 #include <LibCrypto/Cipher/AES.h>
 #include <LibCrypto/Cipher/AESTables.h>
 
+#if ARCH(X86_64) && !defined(KERNEL)
+#    include <LibCrypto/CPUFeatures.h>
+#    include <immintrin.h>
+#endif
+
 namespace Crypto::Cipher {
 
 template<typename T>
@@ -23,6 +31,153 @@ constexpr void swap_keys(u32* keys, size_t i, size_t j)
     keys[j] = temp;
 }
 
+#if ARCH(X86_64) && !defined(KERNEL)
+
+static constexpr auto aes_ni_features = CPUFeatures::AES | CPUFeatures::SSSE3;
+
+// The number of blocks that are encrypted or decrypted together, to hide the latency of the AES instructions.
+static constexpr size_t aes_ni_parallel_blocks = 8;
+
+// AES-NI uses the same key schedules as the table-driven code, including the "equivalent inverse cipher" one for
+// decryption, but it wants their bytes rather than our big-endian words.
+[[gnu::target("aes,ssse3")]] static void load_aes_ni_round_keys(AESCipherKey const& key, __m128i (&round_keys)[15])
+{
+    auto const byte_swap_words = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    for (size_t i = 0; i <= key.rounds(); ++i)
+        round_keys[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(key.round_keys() + 4 * i)), byte_swap_words);
+}
+
+template<size_t BlockCount>
+[[gnu::target("aes,ssse3"), gnu::always_inline]] static inline void aes_ni_encrypt(__m128i (&blocks)[BlockCount], __m128i const (&round_keys)[15], size_t rounds)
+{
+    for (size_t i = 0; i < BlockCount; ++i)
+        blocks[i] = _mm_xor_si128(blocks[i], round_keys[0]);
+    for (size_t round = 1; round < rounds; ++round) {
+        for (size_t i = 0; i < BlockCount; ++i)
+            blocks[i] = _mm_aesenc_si128(blocks[i], round_keys[round]);
+    }
+    for (size_t i = 0; i < BlockCount; ++i)
+        blocks[i] = _mm_aesenclast_si128(blocks[i], round_keys[rounds]);
+}
+
+template<size_t BlockCount>
+[[gnu::target("aes,ssse3"), gnu::always_inline]] static inline void aes_ni_decrypt(__m128i (&blocks)[BlockCount], __m128i const (&round_keys)[15], size_t rounds)
+{
+    for (size_t i = 0; i < BlockCount; ++i)
+        blocks[i] = _mm_xor_si128(blocks[i], round_keys[0]);
+    for (size_t round = 1; round < rounds; ++round) {
+        for (size_t i = 0; i < BlockCount; ++i)
+            blocks[i] = _mm_aesdec_si128(blocks[i], round_keys[round]);
+    }
+    for (size_t i = 0; i < BlockCount; ++i)
+        blocks[i] = _mm_aesdeclast_si128(blocks[i], round_keys[rounds]);
+}
+
+[[gnu::target("aes,ssse3")]] static void aes_ni_encrypt_block(AESCipherKey const& key, u8 const* in, u8* out)
+{
+    __m128i round_keys[15];
+    load_aes_ni_round_keys(key, round_keys);
+    __m128i block[1] { _mm_loadu_si128(reinterpret_cast<__m128i const*>(in)) };
+    aes_ni_encrypt(block, round_keys, key.rounds());
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), block[0]);
+}
+
+[[gnu::target("aes,ssse3")]] static void aes_ni_decrypt_block(AESCipherKey const& key, u8 const* in, u8* out)
+{
+    __m128i round_keys[15];
+    load_aes_ni_round_keys(key, round_keys);
+    __m128i block[1] { _mm_loadu_si128(reinterpret_cast<__m128i const*>(in)) };
+    aes_ni_decrypt(block, round_keys, key.rounds());
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), block[0]);
+}
+
+[[gnu::target("aes,ssse3")]] static void aes_ni_encrypt_cbc(AESCipherKey const& key, u8 const* in, u8* out, size_t block_count, u8 const* ivec)
+{
+    __m128i round_keys[15];
+    load_aes_ni_round_keys(key, round_keys);
+
+    // Every block depends on the previous one, so there's nothing to parallelize.
+    __m128i block[1] { _mm_loadu_si128(reinterpret_cast<__m128i const*>(ivec)) };
+    for (size_t i = 0; i < block_count; ++i) {
+        block[0] = _mm_xor_si128(block[0], _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i * 16)));
+        aes_ni_encrypt(block, round_keys, key.rounds());
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 16), block[0]);
+    }
+}
+
+[[gnu::target("aes,ssse3")]] static void aes_ni_decrypt_cbc(AESCipherKey const& key, u8 const* in, u8* out, size_t block_count, u8 const* ivec)
+{
+    __m128i round_keys[15];
+    load_aes_ni_round_keys(key, round_keys);
+
+    auto previous = _mm_loadu_si128(reinterpret_cast<__m128i const*>(ivec));
+    size_t i = 0;
+    for (; i + aes_ni_parallel_blocks <= block_count; i += aes_ni_parallel_blocks) {
+        __m128i ciphertexts[aes_ni_parallel_blocks];
+        __m128i blocks[aes_ni_parallel_blocks];
+        for (size_t j = 0; j < aes_ni_parallel_blocks; ++j) {
+            ciphertexts[j] = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + (i + j) * 16));
+            blocks[j] = ciphertexts[j];
+        }
+        aes_ni_decrypt(blocks, round_keys, key.rounds());
+        for (size_t j = 0; j < aes_ni_parallel_blocks; ++j) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (i + j) * 16), _mm_xor_si128(blocks[j], previous));
+            previous = ciphertexts[j];
+        }
+    }
+    for (; i < block_count; ++i) {
+        auto ciphertext = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i * 16));
+        __m128i block[1] { ciphertext };
+        aes_ni_decrypt(block, round_keys, key.rounds());
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 16), _mm_xor_si128(block[0], previous));
+        previous = ciphertext;
+    }
+}
+
+// Turns a 128-bit counter, kept as two host-endian halves, into its big-endian bytes and increments it.
+[[gnu::target("aes,ssse3"), gnu::always_inline]] static inline __m128i next_counter_block(u64& high, u64& low)
+{
+    auto const byte_swap_halves = _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+    auto block = _mm_shuffle_epi8(_mm_set_epi64x(static_cast<i64>(low), static_cast<i64>(high)), byte_swap_halves);
+    if (++low == 0)
+        ++high;
+    return block;
+}
+
+[[gnu::target("aes,ssse3")]] static void aes_ni_process_ctr(AESCipherKey const& key, u8 const* in, u8* out, size_t block_count, u8* counter)
+{
+    __m128i round_keys[15];
+    load_aes_ni_round_keys(key, round_keys);
+
+    u64 high = AK::convert_between_host_and_big_endian(ByteReader::load64(counter));
+    u64 low = AK::convert_between_host_and_big_endian(ByteReader::load64(counter + 8));
+
+    size_t i = 0;
+    for (; i + aes_ni_parallel_blocks <= block_count; i += aes_ni_parallel_blocks) {
+        __m128i blocks[aes_ni_parallel_blocks];
+        for (size_t j = 0; j < aes_ni_parallel_blocks; ++j)
+            blocks[j] = next_counter_block(high, low);
+        aes_ni_encrypt(blocks, round_keys, key.rounds());
+        for (size_t j = 0; j < aes_ni_parallel_blocks; ++j) {
+            if (in)
+                blocks[j] = _mm_xor_si128(blocks[j], _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + (i + j) * 16)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (i + j) * 16), blocks[j]);
+        }
+    }
+    for (; i < block_count; ++i) {
+        __m128i block[1] { next_counter_block(high, low) };
+        aes_ni_encrypt(block, round_keys, key.rounds());
+        if (in)
+            block[0] = _mm_xor_si128(block[0], _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i * 16)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 16), block[0]);
+    }
+
+    ByteReader::store(counter, AK::convert_between_host_and_big_endian(high));
+    ByteReader::store(counter + 8, AK::convert_between_host_and_big_endian(low));
+}
+
+#endif
+
 #ifndef KERNEL
 ByteString AESCipherBlock::to_byte_string() const
 {
@@ -198,6 +353,13 @@ void AESCipherKey::expand_decrypt_key(ReadonlyBytes user_key, size_t bits)
 
 void AESCipher::encrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
 {
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_cpu_features(aes_ni_features)) {
+        aes_ni_encrypt_block(key(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
@@ -287,6 +449,13 @@ void AESCipher::encrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
 
 void AESCipher::decrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
 {
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_cpu_features(aes_ni_features)) {
+        aes_ni_decrypt_block(key(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
@@ -374,6 +543,48 @@ void AESCipher::decrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
     // clang-format on
 }
 
+size_t AESCipher::encrypt_cbc_blocks([[maybe_unused]] ReadonlyBytes in, [[maybe_unused]] Bytes out, [[maybe_unused]] ReadonlyBytes ivec)
+{
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_cpu_features(aes_ni_features)) {
+        auto block_count = in.size() / block_size();
+        VERIFY(out.size() >= block_count * block_size());
+        VERIFY(ivec.size() >= block_size());
+        aes_ni_encrypt_cbc(key(), in.data(), out.data(), block_count, ivec.data());
+        return block_count * block_size();
+    }
+#endif
+    return 0;
+}
+
+size_t AESCipher::decrypt_cbc_blocks([[maybe_unused]] ReadonlyBytes in, [[maybe_unused]] Bytes out, [[maybe_unused]] ReadonlyBytes ivec)
+{
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_cpu_features(aes_ni_features)) {
+        auto block_count = in.size() / block_size();
+        VERIFY(out.size() >= block_count * block_size());
+        VERIFY(ivec.size() >= block_size());
+        aes_ni_decrypt_cbc(key(), in.data(), out.data(), block_count, ivec.data());
+        return block_count * block_size();
+    }
+#endif
+    return 0;
+}
+
+size_t AESCipher::process_ctr_blocks([[maybe_unused]] ReadonlyBytes const* in, [[maybe_unused]] Bytes out, [[maybe_unused]] Bytes counter)
+{
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_cpu_features(aes_ni_features)) {
+        auto block_count = out.size() / block_size();
+        VERIFY(!in || in->size() >= block_count * block_size());
+        VERIFY(counter.size() >= block_size());
+        aes_ni_process_ctr(key(), in ? in->data() : nullptr, out.data(), block_count, counter.data());
+        return block_count * block_size();
+    }
+#endif
+    return 0;
+}
+
 void AESCipherBlock::overwrite(ReadonlyBytes bytes)
 {
     auto data = bytes.data();
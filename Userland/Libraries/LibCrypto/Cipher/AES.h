@@ -119,6 +119,14 @@ public:
     virtual void encrypt_block(BlockType const& in, BlockType& out) override;
     virtual void decrypt_block(BlockType const& in, BlockType& out) override;
 
+    // These let the block cipher modes work on many blocks at once with AES-NI. They process all whole blocks and return
+    // the number of bytes that they've processed, which is 0 if the CPU lacks AES-NI.
+    // For CBC, ivec is the previous ciphertext block. For CTR, counter is a big-endian counter that is advanced per block,
+    // and the key stream is written to out as is if in is null.
+    size_t encrypt_cbc_blocks(ReadonlyBytes in, Bytes out, ReadonlyBytes ivec);
+    size_t decrypt_cbc_blocks(ReadonlyBytes in, Bytes out, ReadonlyBytes ivec);
+    size_t process_ctr_blocks(ReadonlyBytes const* in, Bytes out, Bytes counter);
+
 #ifndef KERNEL
     virtual ByteString class_name() const override
     {
@@ -60,6 +60,14 @@ public:
         size_t offset { 0 };
         auto block_size = cipher.block_size();
 
+        if constexpr (requires { cipher.encrypt_cbc_blocks(in, out, iv); }) {
+            offset = cipher.encrypt_cbc_blocks(in, out, iv);
+            if (offset > 0) {
+                iv = out.slice(offset - block_size);
+                length -= offset;
+            }
+        }
+
         while (length >= block_size) {
             m_cipher_block.overwrite(in.slice(offset, block_size));
             m_cipher_block.apply_initialization_vector(iv);
@@ -104,6 +112,14 @@ public:
         m_cipher_block.set_padding_mode(cipher.padding_mode());
         size_t offset { 0 };
 
+        if constexpr (requires { cipher.decrypt_cbc_blocks(in, out, iv); }) {
+            offset = cipher.decrypt_cbc_blocks(in, out, iv);
+            if (offset > 0) {
+                iv = in.slice(offset - block_size);
+                length -= offset;
+            }
+        }
+
         while (length > 0) {
             auto slice = in.slice(offset);
             m_cipher_block.overwrite(slice.data(), block_size);
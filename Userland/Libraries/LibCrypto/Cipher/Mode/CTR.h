@@ -170,6 +170,17 @@ protected:
         size_t offset { 0 };
         auto block_size = cipher.block_size();
 
+        if constexpr (IsSame<IncrementFunctionType, IncrementInplace> && requires { cipher.process_ctr_blocks(in, out, iv); }) {
+            auto whole_blocks_length = length - length % block_size;
+            if (in) {
+                auto whole_blocks = in->trim(whole_blocks_length);
+                offset = cipher.process_ctr_blocks(&whole_blocks, out.trim(whole_blocks_length), iv);
+            } else {
+                offset = cipher.process_ctr_blocks(nullptr, out.trim(whole_blocks_length), iv);
+            }
+            length -= offset;
+        }
+
         while (length > 0) {
             m_cipher_block.overwrite(iv.slice(0, block_size));
 
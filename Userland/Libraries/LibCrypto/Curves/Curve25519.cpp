@@ -10,163 +10,195 @@
 
 namespace Crypto::Curves {
 
-void Curve25519::set(u32* state, u32 value)
+using DoubleLimb = unsigned __int128;
+
+static ALWAYS_INLINE DoubleLimb wide_multiply(u64 a, u64 b)
+{
+    return static_cast<DoubleLimb>(a) * b;
+}
+
+// Propagates the carries through all limbs once, folding the carry out of the top limb back in (2^255 = 19 mod p).
+// Afterwards the lowest limb is below 2^51 + 2^18 and the others are below 2^51 (for inputs below 2^64).
+static ALWAYS_INLINE void carry_propagate(u64* state)
+{
+    u64 carry = state[0] >> Curve25519::LIMB_BITS;
+    state[0] &= Curve25519::LIMB_MASK;
+    for (auto i = 1; i < Curve25519::LIMBS; i++) {
+        state[i] += carry;
+        carry = state[i] >> Curve25519::LIMB_BITS;
+        state[i] &= Curve25519::LIMB_MASK;
+    }
+    state[0] += carry * 19;
+}
+
+// Same as carry_propagate(), but for the 128-bit results of a multiplication.
+static ALWAYS_INLINE void carry_propagate_wide(u64* state, DoubleLimb const* wide)
+{
+    DoubleLimb carry = 0;
+    for (auto i = 0; i < Curve25519::LIMBS; i++) {
+        DoubleLimb value = wide[i] + carry;
+        state[i] = static_cast<u64>(value) & Curve25519::LIMB_MASK;
+        carry = value >> Curve25519::LIMB_BITS;
+    }
+
+    // The carry is below 2^64 / 19
+    state[0] += static_cast<u64>(carry) * 19;
+    state[1] += state[0] >> Curve25519::LIMB_BITS;
+    state[0] &= Curve25519::LIMB_MASK;
+}
+
+void Curve25519::set(u64* state, u64 value)
 {
     state[0] = value;
 
-    for (auto i = 1; i < WORDS; i++) {
+    for (auto i = 1; i < LIMBS; i++) {
         state[i] = 0;
     }
 }
 
-void Curve25519::modular_square(u32* state, u32 const* value)
+void Curve25519::modular_square(u64* state, u64 const* value)
 {
     // Compute R = (A ^ 2) mod p
-    modular_multiply(state, value, value);
+    // Schoolbook squaring computes every cross product once and doubles it. Limbs that wrap around 2^255 are
+    // multiplied by 19 upfront.
+    u64 a0 = value[0];
+    u64 a1 = value[1];
+    u64 a2 = value[2];
+    u64 a3 = value[3];
+    u64 a4 = value[4];
+
+    u64 a0_2 = a0 * 2;
+    u64 a1_2 = a1 * 2;
+    u64 a1_38 = a1 * 38;
+    u64 a2_38 = a2 * 38;
+    u64 a3_19 = a3 * 19;
+    u64 a3_38 = a3 * 38;
+    u64 a4_19 = a4 * 19;
+
+    DoubleLimb wide[LIMBS];
+    wide[0] = wide_multiply(a0, a0) + wide_multiply(a1_38, a4) + wide_multiply(a2_38, a3);
+    wide[1] = wide_multiply(a0_2, a1) + wide_multiply(a2_38, a4) + wide_multiply(a3_19, a3);
+    wide[2] = wide_multiply(a0_2, a2) + wide_multiply(a1, a1) + wide_multiply(a3_38, a4);
+    wide[3] = wide_multiply(a0_2, a3) + wide_multiply(a1_2, a2) + wide_multiply(a4_19, a4);
+    wide[4] = wide_multiply(a0_2, a4) + wide_multiply(a1_2, a3) + wide_multiply(a2, a2);
+
+    carry_propagate_wide(state, wide);
 }
 
-void Curve25519::modular_subtract(u32* state, u32 const* first, u32 const* second)
+void Curve25519::modular_subtract(u64* state, u64 const* first, u64 const* second)
 {
     // R = (A - B) mod p
-    i64 temp = -19;
-    for (auto i = 0; i < WORDS; i++) {
-        temp += first[i];
-        temp -= second[i];
-        state[i] = temp & 0xFFFFFFFF;
-        temp >>= 32;
+    // Compute R = A + 2 * p - B, which keeps all limbs positive for inputs with limbs below 2^52
+    state[0] = first[0] + 0xFFFFFFFFFFFDA - second[0];
+    for (auto i = 1; i < LIMBS; i++) {
+        state[i] = first[i] + 0xFFFFFFFFFFFFE - second[i];
     }
 
-    // Compute R = A + (2^255 - 19) - B
-    state[7] += 0x80000000;
-
-    modular_reduce(state, state);
+    carry_propagate(state);
 }
 
-void Curve25519::modular_add(u32* state, u32 const* first, u32 const* second)
+void Curve25519::modular_add(u64* state, u64 const* first, u64 const* second)
 {
     // R = (A + B) mod p
-    u64 temp = 0;
-    for (auto i = 0; i < WORDS; i++) {
-        temp += first[i];
-        temp += second[i];
-        state[i] = temp & 0xFFFFFFFF;
-        temp >>= 32;
+    for (auto i = 0; i < LIMBS; i++) {
+        state[i] = first[i] + second[i];
     }
 
-    modular_reduce(state, state);
+    carry_propagate(state);
 }
 
-void Curve25519::modular_multiply(u32* state, u32 const* first, u32 const* second)
+void Curve25519::modular_multiply(u64* state, u64 const* first, u64 const* second)
 {
     // Compute R = (A * B) mod p
-    u64 temp = 0;
-    u64 carry = 0;
-    u32 output[WORDS * 2];
-
-    // Comba's method
-    for (auto i = 0; i < 16; i++) {
-        if (i < WORDS) {
-            for (auto j = 0; j <= i; j++) {
-                temp += (u64)first[j] * second[i - j];
-                carry += temp >> 32;
-                temp &= 0xFFFFFFFF;
-            }
-        } else {
-            for (auto j = i - 7; j < WORDS; j++) {
-                temp += (u64)first[j] * second[i - j];
-                carry += temp >> 32;
-                temp &= 0xFFFFFFFF;
-            }
-        }
-
-        output[i] = temp & 0xFFFFFFFF;
-        temp = carry & 0xFFFFFFFF;
-        carry >>= 32;
-    }
-
-    // Reduce bit 255 (2^255 = 19 mod p)
-    temp = (output[7] >> 31) * 19;
-    // Mask the most significant bit
-    output[7] &= 0x7FFFFFFF;
-
-    // Fast modular reduction 1st pass
-    for (auto i = 0; i < WORDS; i++) {
-        temp += output[i];
-        temp += (u64)output[i + 8] * 38;
-        output[i] = temp & 0xFFFFFFFF;
-        temp >>= 32;
-    }
-
-    // Reduce bit 256 (2^256 = 38 mod p)
-    temp *= 38;
-    // Reduce bit 255 (2^255 = 19 mod p)
-    temp += (output[7] >> 31) * 19;
-    // Mask the most significant bit
-    output[7] &= 0x7FFFFFFF;
-
-    // Fast modular reduction 2nd pass
-    for (auto i = 0; i < WORDS; i++) {
-        temp += output[i];
-        output[i] = temp & 0xFFFFFFFF;
-        temp >>= 32;
-    }
-
-    modular_reduce(state, output);
+    // Products of limbs whose weights add up to 2^255 or more wrap around, so they are multiplied by 19 (2^255 = 19 mod p)
+    u64 a0 = first[0];
+    u64 a1 = first[1];
+    u64 a2 = first[2];
+    u64 a3 = first[3];
+    u64 a4 = first[4];
+
+    u64 b0 = second[0];
+    u64 b1 = second[1];
+    u64 b2 = second[2];
+    u64 b3 = second[3];
+    u64 b4 = second[4];
+
+    u64 b1_19 = b1 * 19;
+    u64 b2_19 = b2 * 19;
+    u64 b3_19 = b3 * 19;
+    u64 b4_19 = b4 * 19;
+
+    DoubleLimb wide[LIMBS];
+    wide[0] = wide_multiply(a0, b0) + wide_multiply(a1, b4_19) + wide_multiply(a2, b3_19) + wide_multiply(a3, b2_19) + wide_multiply(a4, b1_19);
+    wide[1] = wide_multiply(a0, b1) + wide_multiply(a1, b0) + wide_multiply(a2, b4_19) + wide_multiply(a3, b3_19) + wide_multiply(a4, b2_19);
+    wide[2] = wide_multiply(a0, b2) + wide_multiply(a1, b1) + wide_multiply(a2, b0) + wide_multiply(a3, b4_19) + wide_multiply(a4, b3_19);
+    wide[3] = wide_multiply(a0, b3) + wide_multiply(a1, b2) + wide_multiply(a2, b1) + wide_multiply(a3, b0) + wide_multiply(a4, b4_19);
+    wide[4] = wide_multiply(a0, b4) + wide_multiply(a1, b3) + wide_multiply(a2, b2) + wide_multiply(a3, b1) + wide_multiply(a4, b0);
+
+    carry_propagate_wide(state, wide);
 }
 
-void Curve25519::export_state(u32* state, u8* output)
+void Curve25519::export_state(u64* state, u8* output)
 {
-    for (u32 i = 0; i < WORDS; i++) {
-        state[i] = AK::convert_between_host_and_little_endian(state[i]);
+    // Only the unique representation below p is exported
+    modular_reduce(state, state);
+
+    u64 words[4] {
+        state[0] | (state[1] << 51),
+        (state[1] >> 13) | (state[2] << 38),
+        (state[2] >> 26) | (state[3] << 25),
+        (state[3] >> 39) | (state[4] << 12),
+    };
+
+    for (auto i = 0; i < 4; i++) {
+        words[i] = AK::convert_between_host_and_little_endian(words[i]);
     }
 
-    memcpy(output, state, BYTES);
+    memcpy(output, words, BYTES);
 }
 
-void Curve25519::import_state(u32* state, u8 const* data)
+void Curve25519::import_state(u64* state, u8 const* data)
 {
-    memcpy(state, data, BYTES);
-    for (u32 i = 0; i < WORDS; i++) {
-        state[i] = AK::convert_between_host_and_little_endian(state[i]);
+    // NOTE: The most significant bit of the input is ignored.
+    u64 words[4];
+    memcpy(words, data, BYTES);
+    for (auto i = 0; i < 4; i++) {
+        words[i] = AK::convert_between_host_and_little_endian(words[i]);
     }
+
+    state[0] = words[0] & LIMB_MASK;
+    state[1] = ((words[0] >> 51) | (words[1] << 13)) & LIMB_MASK;
+    state[2] = ((words[1] >> 38) | (words[2] << 26)) & LIMB_MASK;
+    state[3] = ((words[2] >> 25) | (words[3] << 39)) & LIMB_MASK;
+    state[4] = (words[3] >> 12) & LIMB_MASK;
 }
 
-void Curve25519::modular_subtract_single(u32* r, u32 const* a, u32 b)
+void Curve25519::modular_subtract_single(u64* r, u64 const* a, u32 b)
 {
-    i64 temp = -19;
-    temp -= b;
-
-    // Compute R = A - 19 - B
-    for (u32 i = 0; i < 8; i++) {
-        temp += a[i];
-        r[i] = temp & 0xFFFFFFFF;
-        temp >>= 32;
+    // Compute R = A + 2 * p - B
+    copy(r, a);
+    r[0] += 0xFFFFFFFFFFFDA - b;
+    for (auto i = 1; i < LIMBS; i++) {
+        r[i] += 0xFFFFFFFFFFFFE;
     }
 
-    // Compute R = A + (2^255 - 19) - B
-    r[7] += 0x80000000;
-    modular_reduce(r, r);
+    carry_propagate(r);
 }
 
-void Curve25519::modular_add_single(u32* state, u32 const* first, u32 second)
+void Curve25519::modular_add_single(u64* state, u64 const* first, u32 second)
 {
-    u64 temp = second;
-
     // Compute R = A + B
-    for (u32 i = 0; i < 8; i++) {
-        temp += first[i];
-        state[i] = temp & 0xFFFFFFFF;
-        temp >>= 32;
-    }
+    copy(state, first);
+    state[0] += second;
 
-    modular_reduce(state, state);
+    carry_propagate(state);
 }
 
-u32 Curve25519::modular_square_root(u32* r, u32 const* a, u32 const* b)
+u32 Curve25519::modular_square_root(u64* r, u64 const* a, u64 const* b)
 {
-    u32 c[8];
-    u32 u[8];
-    u32 v[8];
+    u64 c[LIMBS];
+    u64 u[LIMBS];
+    u64 v[LIMBS];
 
     // To compute the square root of (A / B), the first step is to compute the candidate root x = (A / B)^((p+3)/8)
     modular_square(v, b);
@@ -230,37 +262,46 @@ u32 Curve25519::modular_square_root(u32* r, u32 const* a, u32 const* b)
     return first_comparison & second_comparison;
 }
 
-u32 Curve25519::compare(u32 const* a, u32 const* b)
+u32 Curve25519::compare(u64 const* a, u64 const* b)
 {
-    u32 mask = 0;
-    for (u32 i = 0; i < 8; i++) {
-        mask |= a[i] ^ b[i];
+    // Compare the unique representations of both values
+    u64 reduced_a[LIMBS];
+    u64 reduced_b[LIMBS];
+    modular_reduce(reduced_a, a);
+    modular_reduce(reduced_b, b);
+
+    u64 mask = 0;
+    for (auto i = 0; i < LIMBS; i++) {
+        mask |= reduced_a[i] ^ reduced_b[i];
     }
 
     // Return 0 if A = B, else 1
-    return ((u32)(mask | (~mask + 1))) >> 31;
+    return static_cast<u32>((mask | (~mask + 1)) >> 63);
 }
 
-void Curve25519::modular_reduce(u32* state, u32 const* data)
+void Curve25519::modular_reduce(u64* state, u64 const* data)
 {
-    // R = A mod p
-    u64 temp = 19;
-    u32 other[WORDS];
-
-    for (auto i = 0; i < WORDS; i++) {
-        temp += data[i];
-        other[i] = temp & 0xFFFFFFFF;
-        temp >>= 32;
+    // R = A mod p, as the unique representation below p
+    copy(state, data);
+    carry_propagate(state);
+    carry_propagate(state);
+
+    // A is now below 2^255 + 19, so it is at most p + 37. Adding 19 carries into bit 255 exactly if A >= p.
+    u64 carry = (state[0] + 19) >> LIMB_BITS;
+    for (auto i = 1; i < LIMBS; i++) {
+        carry = (state[i] + carry) >> LIMB_BITS;
     }
 
-    // Compute B = A - (2^255 - 19)
-    other[7] -= 0x80000000;
-
-    u32 mask = (other[7] & 0x80000000) >> 31;
-    select(state, other, data, mask);
+    // If so, compute A - p = A + 19 - 2^255
+    state[0] += 19 * carry;
+    for (auto i = 1; i < LIMBS; i++) {
+        state[i] += state[i - 1] >> LIMB_BITS;
+        state[i - 1] &= LIMB_MASK;
+    }
+    state[LIMBS - 1] &= LIMB_MASK;
 }
 
-void Curve25519::to_power_of_2n(u32* state, u32 const* value, u8 n)
+void Curve25519::to_power_of_2n(u64* state, u64 const* value, u8 n)
 {
     // Pre-compute (A ^ 2) mod p
     modular_square(state, value);
@@ -271,28 +312,39 @@ void Curve25519::to_power_of_2n(u32* state, u32 const* value, u8 n)
     }
 }
 
-void Curve25519::select(u32* state, u32 const* a, u32 const* b, u32 condition)
+void Curve25519::select(u64* state, u64 const* a, u64 const* b, u32 condition)
 {
-    // If B < (2^255 - 19) then R = B, else R = A
-    u32 mask = condition - 1;
+    // If condition = 0 then R = A, else R = B
+    u64 mask = static_cast<u64>(condition) - 1;
 
-    for (auto i = 0; i < WORDS; i++) {
+    for (auto i = 0; i < LIMBS; i++) {
         state[i] = (a[i] & mask) | (b[i] & ~mask);
     }
 }
 
-void Curve25519::copy(u32* state, u32 const* value)
+void Curve25519::conditional_swap(u64* first, u64* second, u32 condition)
 {
-    for (auto i = 0; i < WORDS; i++) {
+    // If condition = 1 then swap A and B
+    u64 mask = ~static_cast<u64>(condition) + 1;
+    for (auto i = 0; i < LIMBS; i++) {
+        u64 temp = mask & (first[i] ^ second[i]);
+        first[i] ^= temp;
+        second[i] ^= temp;
+    }
+}
+
+void Curve25519::copy(u64* state, u64 const* value)
+{
+    for (auto i = 0; i < LIMBS; i++) {
         state[i] = value[i];
     }
 }
 
-void Curve25519::modular_multiply_inverse(u32* state, u32 const* value)
+void Curve25519::modular_multiply_inverse(u64* state, u64 const* value)
 {
     // Compute R = A^-1 mod p
-    u32 u[WORDS];
-    u32 v[WORDS];
+    u64 u[LIMBS];
+    u64 v[LIMBS];
 
     // Fermat's little theorem
     modular_square(u, value);
@@ -329,32 +381,14 @@ void Curve25519::modular_multiply_inverse(u32* state, u32 const* value)
     modular_multiply(state, u, value);
 }
 
-void Curve25519::modular_multiply_single(u32* state, u32 const* first, u32 second)
+void Curve25519::modular_multiply_single(u64* state, u64 const* first, u32 second)
 {
     // Compute R = (A * B) mod p
-    u64 temp = 0;
-    u32 output[WORDS];
-
-    for (auto i = 0; i < WORDS; i++) {
-        temp += (u64)first[i] * second;
-        output[i] = temp & 0xFFFFFFFF;
-        temp >>= 32;
-    }
-
-    // Reduce bit 256 (2^256 = 38 mod p)
-    temp *= 38;
-    // Reduce bit 255 (2^255 = 19 mod p)
-    temp += (output[7] >> 31) * 19;
-    // Mask the most significant bit
-    output[7] &= 0x7FFFFFFF;
-
-    // Fast modular reduction
-    for (auto i = 0; i < WORDS; i++) {
-        temp += output[i];
-        output[i] = temp & 0xFFFFFFFF;
-        temp >>= 32;
+    DoubleLimb wide[LIMBS];
+    for (auto i = 0; i < LIMBS; i++) {
+        wide[i] = wide_multiply(first[i], second);
     }
 
-    modular_reduce(state, output);
+    carry_propagate_wide(state, wide);
 }
 }
@@ -10,6 +10,9 @@
 
 namespace Crypto::Curves {
 
+// Field elements are stored as 5 limbs of 51 bits (radix 2^51), so products of two limbs fit comfortably into 128 bits
+// and carries can be deferred. Limbs may exceed 51 bits slightly between operations; modular_reduce() produces the
+// unique representation below p.
 class Curve25519 {
 public:
     static constexpr u8 BASE_POINT_L_ORDER[33] {
@@ -20,23 +23,20 @@ public:
         0x00
     };
 
-    static constexpr u32 CURVE_D[8] {
-        0x135978A3, 0x75EB4DCA, 0x4141D8AB, 0x00700A4D,
-        0x7779E898, 0x8CC74079, 0x2B6FFE73, 0x52036CEE
+    static constexpr u64 CURVE_D[5] {
+        0x34DCA135978A3, 0x1A8283B156EBD, 0x5E7A26001C029, 0x739C663A03CBB, 0x52036CEE2B6FF
     };
 
-    static constexpr u32 CURVE_D_2[8] {
-        0x26B2F159, 0xEBD69B94, 0x8283B156, 0x00E0149A,
-        0xEEF3D130, 0x198E80F2, 0x56DFFCE7, 0x2406D9DC
+    static constexpr u64 CURVE_D_2[5] {
+        0x69B9426B2F159, 0x35050762ADD7A, 0x3CF44C0038052, 0x6738CC7407977, 0x2406D9DC56DFF
     };
 
-    static constexpr u32 ZERO[8] {
-        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000
+    static constexpr u64 ZERO[5] {
+        0x0000000000000, 0x0000000000000, 0x0000000000000, 0x0000000000000, 0x0000000000000
     };
 
-    static constexpr u32 SQRT_MINUS_1[8] {
-        0x4A0EA0B0, 0xC4EE1B27, 0xAD2FE478, 0x2F431806,
-        0x3DFBD7A7, 0x2B4D0099, 0x4FC1DF0B, 0x2B832480
+    static constexpr u64 SQRT_MINUS_1[5] {
+        0x61B274A0EA0B0, 0x0D5A5FC8F189D, 0x7EF5E9CBD0C60, 0x78595A6804C9E, 0x2B8324804FC1D
     };
 
     static constexpr u8 BARRETT_REDUCTION_QUOTIENT[33] {
@@ -49,25 +49,28 @@ public:
 
     static constexpr u8 BITS = 255;
     static constexpr u8 BYTES = 32;
-    static constexpr u8 WORDS = 8;
+    static constexpr u8 LIMBS = 5;
+    static constexpr u8 LIMB_BITS = 51;
+    static constexpr u64 LIMB_MASK = (1ull << LIMB_BITS) - 1;
     static constexpr u32 A24 = 121666;
 
-    static void set(u32* a, u32 b);
-    static void select(u32* r, u32 const* a, u32 const* b, u32 c);
-    static void copy(u32* a, u32 const* b);
-    static void modular_square(u32* r, u32 const* a);
-    static void modular_subtract(u32* r, u32 const* a, u32 const* b);
-    static void modular_reduce(u32* r, u32 const* a);
-    static void modular_add(u32* r, u32 const* a, u32 const* b);
-    static void modular_multiply(u32* r, u32 const* a, u32 const* b);
-    static void modular_multiply_inverse(u32* r, u32 const* a);
-    static void to_power_of_2n(u32* r, u32 const* a, u8 n);
-    static void export_state(u32* a, u8* data);
-    static void import_state(u32* a, u8 const* data);
-    static void modular_subtract_single(u32* r, u32 const* a, u32 b);
-    static void modular_multiply_single(u32* r, u32 const* a, u32 b);
-    static void modular_add_single(u32* r, u32 const* a, u32 b);
-    static u32 modular_square_root(u32* r, u32 const* a, u32 const* b);
-    static u32 compare(u32 const* a, u32 const* b);
+    static void set(u64* a, u64 b);
+    static void select(u64* r, u64 const* a, u64 const* b, u32 c);
+    static void conditional_swap(u64* a, u64* b, u32 c);
+    static void copy(u64* a, u64 const* b);
+    static void modular_square(u64* r, u64 const* a);
+    static void modular_subtract(u64* r, u64 const* a, u64 const* b);
+    static void modular_reduce(u64* r, u64 const* a);
+    static void modular_add(u64* r, u64 const* a, u64 const* b);
+    static void modular_multiply(u64* r, u64 const* a, u64 const* b);
+    static void modular_multiply_inverse(u64* r, u64 const* a);
+    static void to_power_of_2n(u64* r, u64 const* a, u8 n);
+    static void export_state(u64* a, u8* data);
+    static void import_state(u64* a, u8 const* data);
+    static void modular_subtract_single(u64* r, u64 const* a, u32 b);
+    static void modular_multiply_single(u64* r, u64 const* a, u32 b);
+    static void modular_add_single(u64* r, u64 const* a, u32 b);
+    static u32 modular_square_root(u64* r, u64 const* a, u64 const* b);
+    static u32 compare(u64 const* a, u64 const* b);
 };
 }
@@ -11,6 +11,124 @@
 
 namespace Crypto::Curves {
 
+static constexpr u8 LIMBS = Curve25519::LIMBS;
+
+// A point in the form (Y + X, Y - X, 2 * Z, 2 * d * T), which saves some work when it is added to other points.
+struct Ed25519CachedPoint {
+    u64 y_plus_x[LIMBS] {};
+    u64 y_minus_x[LIMBS] {};
+    u64 z_2[LIMBS] {};
+    u64 t_2d[LIMBS] {};
+};
+
+// The multiples 1P to 8P of a point, for scalar multiplication with signed 4-bit windows.
+using Ed25519WindowTable = Ed25519CachedPoint[8];
+
+static void set_neutral(Ed25519Point* point)
+{
+    // The neutral element is (0, 1, 1, 0)
+    Curve25519::set(point->x, 0);
+    Curve25519::set(point->y, 1);
+    Curve25519::set(point->z, 1);
+    Curve25519::set(point->t, 0);
+}
+
+static void to_cached(Ed25519CachedPoint* result, Ed25519Point const* point)
+{
+    Curve25519::modular_add(result->y_plus_x, point->y, point->x);
+    Curve25519::modular_subtract(result->y_minus_x, point->y, point->x);
+    Curve25519::modular_add(result->z_2, point->z, point->z);
+    Curve25519::modular_multiply(result->t_2d, point->t, Curve25519::CURVE_D_2);
+}
+
+static void add_cached(Ed25519Point* result, Ed25519Point const* p, Ed25519CachedPoint const* q)
+{
+    // Compute R = P + Q
+    u64 a[LIMBS];
+    u64 b[LIMBS];
+    u64 c[LIMBS];
+    u64 d[LIMBS];
+    u64 e[LIMBS];
+    u64 f[LIMBS];
+    u64 g[LIMBS];
+    u64 h[LIMBS];
+
+    Curve25519::modular_add(c, p->y, p->x);
+    Curve25519::modular_multiply(a, c, q->y_plus_x);
+    Curve25519::modular_subtract(c, p->y, p->x);
+    Curve25519::modular_multiply(b, c, q->y_minus_x);
+    Curve25519::modular_multiply(c, p->z, q->z_2);
+    Curve25519::modular_multiply(d, p->t, q->t_2d);
+    Curve25519::modular_add(e, a, b);
+    Curve25519::modular_subtract(f, a, b);
+    Curve25519::modular_add(g, c, d);
+    Curve25519::modular_subtract(h, c, d);
+    Curve25519::modular_multiply(result->x, f, h);
+    Curve25519::modular_multiply(result->y, e, g);
+    Curve25519::modular_multiply(result->z, g, h);
+    Curve25519::modular_multiply(result->t, e, f);
+}
+
+static void make_window_table(Ed25519WindowTable& table, Ed25519Point const* point)
+{
+    Ed25519Point multiple = *point;
+    to_cached(&table[0], point);
+    for (auto i = 1; i < 8; i++) {
+        add_cached(&multiple, &multiple, &table[0]);
+        to_cached(&table[i], &multiple);
+    }
+}
+
+static u32 equal(u32 a, u32 b)
+{
+    // Return 1 if A = B, else 0
+    return ((a ^ b) - 1) >> 31;
+}
+
+static void select_from_window_table(Ed25519CachedPoint* result, Ed25519WindowTable const& table, i8 digit)
+{
+    // Select [digit]P for a digit in [-8, 8]. Every entry is read, so the memory access pattern does not depend on the digit.
+    u32 negative = static_cast<u8>(digit) >> 7;
+    u32 magnitude = static_cast<u8>(digit - ((-static_cast<i8>(negative) & digit) << 1));
+
+    // Start with the neutral element
+    Curve25519::set(result->y_plus_x, 1);
+    Curve25519::set(result->y_minus_x, 1);
+    Curve25519::set(result->z_2, 2);
+    Curve25519::set(result->t_2d, 0);
+
+    for (u32 i = 0; i < 8; i++) {
+        u32 condition = equal(magnitude, i + 1);
+        Curve25519::select(result->y_plus_x, result->y_plus_x, table[i].y_plus_x, condition);
+        Curve25519::select(result->y_minus_x, result->y_minus_x, table[i].y_minus_x, condition);
+        Curve25519::select(result->z_2, result->z_2, table[i].z_2, condition);
+        Curve25519::select(result->t_2d, result->t_2d, table[i].t_2d, condition);
+    }
+
+    // -(X, Y, Z, T) = (-X, Y, Z, -T), which swaps Y + X and Y - X
+    u64 negated_t_2d[LIMBS];
+    Curve25519::modular_subtract(negated_t_2d, Curve25519::ZERO, result->t_2d);
+    Curve25519::conditional_swap(result->y_plus_x, result->y_minus_x, negative);
+    Curve25519::select(result->t_2d, result->t_2d, negated_t_2d, negative);
+}
+
+static void recode_scalar(i8* digits, u8 const* scalar)
+{
+    // Write the scalar (below 2^255) as the sum of digits[i] * 16^i, with all 64 digits in [-8, 8]
+    for (auto i = 0; i < 32; i++) {
+        digits[2 * i] = scalar[i] & 15;
+        digits[2 * i + 1] = (scalar[i] >> 4) & 15;
+    }
+
+    i8 carry = 0;
+    for (auto i = 0; i < 63; i++) {
+        digits[i] += carry;
+        carry = (digits[i] + 8) >> 4;
+        digits[i] -= carry * 16;
+    }
+    digits[63] += carry;
+}
+
 // https://datatracker.ietf.org/doc/html/rfc8032#section-5.1.5
 ErrorOr<ByteBuffer> Ed25519::generate_private_key()
 {
@@ -45,7 +163,7 @@ ErrorOr<ByteBuffer> Ed25519::generate_public_key(ReadonlyBytes private_key)
     s[31] |= 0x40;
 
     // Perform a fixed-base scalar multiplication [s]B.
-    point_multiply_scalar(&sb, s, &BASE_POINT);
+    point_multiply_base(&sb, s);
 
     // 4.  The public key A is the encoding of the point [s]B.
     // First, encode the y-coordinate (in the range 0 <= y < p) as a little-endian string of 32 octets.
@@ -91,7 +209,7 @@ ErrorOr<ByteBuffer> Ed25519::sign(ReadonlyBytes public_key, ReadonlyBytes privat
     barrett_reduce(r, digest.data);
 
     // 3.  Compute the point [r]B.
-    point_multiply_scalar(&rb, r, &BASE_POINT);
+    point_multiply_base(&rb, r);
 
     auto R = TRY(ByteBuffer::create_uninitialized(32));
     // Let the string R be the encoding of this point
@@ -179,7 +297,7 @@ bool Ed25519::verify(ReadonlyBytes public_key, ReadonlyBytes signature, Readonly
     // NOTE: We check [S]B - [k]A' == R
     Curve25519::modular_subtract(ka.x, Curve25519::ZERO, ka.x);
     Curve25519::modular_subtract(ka.t, Curve25519::ZERO, ka.t);
-    point_multiply_scalar(&sb, s, &BASE_POINT);
+    point_multiply_base(&sb, s);
     point_multiply_scalar(&ka, k, &ka);
     point_add(&ka, &sb, &ka);
     encode_point(&ka, p);
@@ -191,6 +309,14 @@ bool Ed25519::verify(ReadonlyBytes public_key, ReadonlyBytes signature, Readonly
 
 void Ed25519::point_double(Ed25519Point* result, Ed25519Point const* point)
 {
+    u64 a[LIMBS];
+    u64 b[LIMBS];
+    u64 c[LIMBS];
+    u64 e[LIMBS];
+    u64 f[LIMBS];
+    u64 g[LIMBS];
+    u64 h[LIMBS];
+
     Curve25519::modular_square(a, point->x);
     Curve25519::modular_square(b, point->y);
     Curve25519::modular_square(c, point->z);
@@ -209,31 +335,68 @@ void Ed25519::point_double(Ed25519Point* result, Ed25519Point const* point)
 
 void Ed25519::point_multiply_scalar(Ed25519Point* result, u8 const* scalar, Ed25519Point const* point)
 {
-    // Set U to the neutral element (0, 1, 1, 0)
-    Curve25519::set(u.x, 0);
-    Curve25519::set(u.y, 1);
-    Curve25519::set(u.z, 1);
-    Curve25519::set(u.t, 0);
+    // Compute [scalar]P for a scalar below 2^255 with signed 4-bit windows, processing the most significant window first
+    i8 digits[64];
+    recode_scalar(digits, scalar);
+
+    Ed25519WindowTable table;
+    make_window_table(table, point);
+
+    Ed25519Point u;
+    Ed25519CachedPoint selected;
+    set_neutral(&u);
+
+    for (auto i = 63; i >= 0; i--) {
+        if (i != 63) {
+            for (auto j = 0; j < 4; j++)
+                point_double(&u, &u);
+        }
+
+        select_from_window_table(&selected, table, digits[i]);
+        add_cached(&u, &u, &selected);
+    }
+
+    *result = u;
+}
 
-    for (i32 i = Curve25519::BITS - 1; i >= 0; i--) {
-        u8 b = (scalar[i / 8] >> (i % 8)) & 1;
+void Ed25519::point_multiply_base(Ed25519Point* result, u8 const* scalar)
+{
+    // table[i][j] = [(j + 1) * 256^i]B, computed once on first use
+    static Ed25519WindowTable table[32];
+    static bool const initialized = [] {
+        Ed25519Point base = BASE_POINT;
+        for (auto i = 0; i < 32; i++) {
+            make_window_table(table[i], &base);
+            for (auto j = 0; j < 8; j++)
+                point_double(&base, &base);
+        }
+        return true;
+    }();
+    VERIFY(initialized);
+
+    // [scalar]B = sum of [digits[i] * 16^i]B. The odd digits are added first and multiplied by 16 afterwards,
+    // so a table for every other power of 16 is enough.
+    i8 digits[64];
+    recode_scalar(digits, scalar);
+
+    Ed25519Point u;
+    Ed25519CachedPoint selected;
+    set_neutral(&u);
+
+    for (auto i = 1; i < 64; i += 2) {
+        select_from_window_table(&selected, table[i / 2], digits[i]);
+        add_cached(&u, &u, &selected);
+    }
 
-        // Compute U = 2 * U
+    for (auto i = 0; i < 4; i++)
         point_double(&u, &u);
-        // Compute V = U + P
-        point_add(&v, &u, point);
-
-        // If b is set, then U = V
-        Curve25519::select(u.x, u.x, v.x, b);
-        Curve25519::select(u.y, u.y, v.y, b);
-        Curve25519::select(u.z, u.z, v.z, b);
-        Curve25519::select(u.t, u.t, v.t, b);
+
+    for (auto i = 0; i < 64; i += 2) {
+        select_from_window_table(&selected, table[i / 2], digits[i]);
+        add_cached(&u, &u, &selected);
     }
 
-    Curve25519::copy(result->x, u.x);
-    Curve25519::copy(result->y, u.y);
-    Curve25519::copy(result->z, u.z);
-    Curve25519::copy(result->t, u.t);
+    *result = u;
 }
 
 // https://datatracker.ietf.org/doc/html/rfc8032#section-5.1.2
@@ -252,6 +415,7 @@ void Ed25519::encode_point(Ed25519Point* point, u8* data)
 
     // To form the encoding of the point [s]B,
     // copy the least significant bit of the x coordinate to the most significant bit of the final octet.
+    Curve25519::modular_reduce(point->x, point->x);
     data[31] |= (point->x[0] & 1) << 7;
 }
 
@@ -342,10 +506,9 @@ void Ed25519::select(u8* r, u8 const* a, u8 const* b, u8 c, u8 n)
 // https://datatracker.ietf.org/doc/html/rfc8032#section-5.1.3
 u32 Ed25519::decode_point(Ed25519Point* point, u8 const* data)
 {
-    u32 u[8];
-    u32 v[8];
+    u64 u[LIMBS];
+    u64 v[LIMBS];
     u32 ret;
-    u64 temp = 19;
 
     // 1. First, interpret the string as an integer in little-endian representation.
     // Bit 255 of this number is the least significant bit of the x-coordinate and denote this value x_0.
@@ -353,17 +516,14 @@ u32 Ed25519::decode_point(Ed25519Point* point, u8 const* data)
 
     // The y-coordinate is recovered simply by clearing this bit.
     Curve25519::import_state(point->y, data);
-    point->y[7] &= 0x7FFFFFFF;
-
-    // Compute U = Y + 19
-    for (u32 i = 0; i < 8; i++) {
-        temp += point->y[i];
-        u[i] = temp & 0xFFFFFFFF;
-        temp >>= 32;
-    }
 
     // If the resulting value is >= p, decoding fails.
-    ret = (u[7] >> 31) & 1;
+    // NOTE: The imported value is only unchanged by a reduction modulo p if it was already below p.
+    u64 difference = 0;
+    Curve25519::modular_reduce(u, point->y);
+    for (auto i = 0; i < LIMBS; i++)
+        difference |= u[i] ^ point->y[i];
+    ret = static_cast<u32>((difference | (~difference + 1)) >> 63);
 
     // 2. To recover the x-coordinate, the curve equation implies x^2 = (y^2 - 1) / (d y^2 + 1) (mod p).
     // The denominator is always non-zero mod p.
@@ -380,6 +540,7 @@ u32 Ed25519::decode_point(Ed25519Point* point, u8 const* data)
     ret |= (Curve25519::compare(u, Curve25519::ZERO) ^ 1) & x0;
 
     // 4.  Finally, use the x_0 bit to select the right square root.
+    Curve25519::modular_reduce(u, u);
     Curve25519::modular_subtract(v, Curve25519::ZERO, u);
     Curve25519::select(point->x, u, v, (x0 ^ u[0]) & 1);
     Curve25519::set(point->z, 1);
@@ -392,24 +553,9 @@ u32 Ed25519::decode_point(Ed25519Point* point, u8 const* data)
 void Ed25519::point_add(Ed25519Point* result, Ed25519Point const* p, Ed25519Point const* q)
 {
     // Compute R = P + Q
-    Curve25519::modular_add(c, p->y, p->x);
-    Curve25519::modular_add(d, q->y, q->x);
-    Curve25519::modular_multiply(a, c, d);
-    Curve25519::modular_subtract(c, p->y, p->x);
-    Curve25519::modular_subtract(d, q->y, q->x);
-    Curve25519::modular_multiply(b, c, d);
-    Curve25519::modular_multiply(c, p->z, q->z);
-    Curve25519::modular_add(c, c, c);
-    Curve25519::modular_multiply(d, p->t, q->t);
-    Curve25519::modular_multiply(d, d, Curve25519::CURVE_D_2);
-    Curve25519::modular_add(e, a, b);
-    Curve25519::modular_subtract(f, a, b);
-    Curve25519::modular_add(g, c, d);
-    Curve25519::modular_subtract(h, c, d);
-    Curve25519::modular_multiply(result->x, f, h);
-    Curve25519::modular_multiply(result->y, e, g);
-    Curve25519::modular_multiply(result->z, g, h);
-    Curve25519::modular_multiply(result->t, e, f);
+    Ed25519CachedPoint cached_q;
+    to_cached(&cached_q, q);
+    add_cached(result, p, &cached_q);
 }
 
 u8 Ed25519::compare(u8 const* a, u8 const* b, u8 n)
@@ -12,21 +12,24 @@
 namespace Crypto::Curves {
 
 struct Ed25519Point {
-    u32 x[8] {};
-    u32 y[8] {};
-    u32 z[8] {};
-    u32 t[8] {};
+    u64 x[5] {};
+    u64 y[5] {};
+    u64 z[5] {};
+    u64 t[5] {};
 };
 
 class Ed25519 {
 public:
     static constexpr Ed25519Point BASE_POINT = {
-        { 0x8F25D51A, 0xC9562D60, 0x9525A7B2, 0x692CC760, 0xFDD6DC5C, 0xC0A4E231, 0xCD6E53FE, 0x216936D3 },
-        { 0x66666658, 0x66666666, 0x66666666, 0x66666666, 0x66666666, 0x66666666, 0x66666666, 0x66666666 },
-        { 0x00000001, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000 },
-        { 0xA5B7DDA3, 0x6DDE8AB3, 0x775152F5, 0x20F09F80, 0x64ABE37D, 0x66EA4E8E, 0xD78B7665, 0x67875F0F }
+        { 0x62D608F25D51A, 0x412A4B4F6592A, 0x75B7171A4B31D, 0x1FF60527118FE, 0x216936D3CD6E5 },
+        { 0x6666666666658, 0x4CCCCCCCCCCCC, 0x1999999999999, 0x3333333333333, 0x6666666666666 },
+        { 0x0000000000001, 0x0000000000000, 0x0000000000000, 0x0000000000000, 0x0000000000000 },
+        { 0x68AB3A5B7DDA3, 0x00EEA2A5EADBB, 0x2AF8DF483C27E, 0x332B375274732, 0x67875F0FD78B7 }
     };
 
+    // Computes [scalar]B for a 32-byte little-endian scalar below 2^255, in constant time.
+    static void point_multiply_base(Ed25519Point* result, u8 const* scalar);
+
     size_t key_size() { return 32; }
     size_t signature_size() { return 64; }
     ErrorOr<ByteBuffer> generate_private_key();
@@ -36,12 +39,12 @@ public:
     bool verify(ReadonlyBytes public_key, ReadonlyBytes signature, ReadonlyBytes message);
 
 private:
-    void encode_point(Ed25519Point* point, u8* data);
-    u32 decode_point(Ed25519Point* point, u8 const* data);
+    static void encode_point(Ed25519Point* point, u8* data);
+    static u32 decode_point(Ed25519Point* point, u8 const* data);
 
-    void point_add(Ed25519Point* result, Ed25519Point const* p, Ed25519Point const* q);
-    void point_double(Ed25519Point* result, Ed25519Point const* point);
-    void point_multiply_scalar(Ed25519Point* result, u8 const* scalar, Ed25519Point const* point);
+    static void point_add(Ed25519Point* result, Ed25519Point const* p, Ed25519Point const* q);
+    static void point_double(Ed25519Point* result, Ed25519Point const* point);
+    static void point_multiply_scalar(Ed25519Point* result, u8 const* scalar, Ed25519Point const* point);
 
     void barrett_reduce(u8* result, u8 const* input);
 
@@ -60,16 +63,6 @@ private:
     Ed25519Point ka {};
     Ed25519Point rb {};
     Ed25519Point sb {};
-    Ed25519Point u {};
-    Ed25519Point v {};
-    u32 a[8] {};
-    u32 b[8] {};
-    u32 c[8] {};
-    u32 d[8] {};
-    u32 e[8] {};
-    u32 f[8] {};
-    u32 g[8] {};
-    u32 h[8] {};
 };
 
 }
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/ByteBuffer.h>
 #include <AK/Endian.h>
 #include <AK/MemoryStream.h>
@@ -31,9 +32,11 @@ template<size_t bit_size, SECPxxxr1CurveParameters const& CURVE_PARAMETERS>
 class SECPxxxr1 : public EllipticCurve {
 private:
     using StorageType = AK::UFixedBigInt<bit_size>;
-    using StorageTypeX2 = AK::UFixedBigInt<bit_size * 2>;
+    using NativeWord = AK::Detail::NativeWord;
+    using NativeDoubleWord = AK::Detail::NativeDoubleWord;
 
-    struct JacobianPoint {
+    // Points are kept in homogeneous projective coordinates (x = X/Z, y = Y/Z), with the point at infinity being (0 : 1 : 0).
+    struct ProjectivePoint {
         StorageType x;
         StorageType y;
         StorageType z;
@@ -43,6 +46,17 @@ private:
     static constexpr size_t KEY_BIT_SIZE = bit_size;
     static constexpr size_t KEY_BYTE_SIZE = KEY_BIT_SIZE / 8;
     static constexpr size_t POINT_BYTE_SIZE = 1 + 2 * KEY_BYTE_SIZE;
+    static constexpr size_t WORD_COUNT = KEY_BIT_SIZE / AK::Detail::native_word_size;
+
+    static_assert(KEY_BIT_SIZE % AK::Detail::native_word_size == 0);
+
+    // Scalars are processed in signed windows of 4 bits (digits in [-8, 8]), so tables only need to hold 1P to 8P.
+    // The top window absorbs the sign of the window below it, hence the extra window.
+    static constexpr size_t WINDOW_BITS = 4;
+    static constexpr size_t WINDOW_COUNT = KEY_BIT_SIZE / WINDOW_BITS + 1;
+    static constexpr size_t WINDOW_TABLE_SIZE = 1 << (WINDOW_BITS - 1);
+
+    using WindowTable = Array<ProjectivePoint, WINDOW_TABLE_SIZE>;
 
     static constexpr StorageType make_unsigned_fixed_big_int_from_string(StringView str)
     {
@@ -92,27 +106,14 @@ private:
     // Check that the generator point starts with 0x04
     static_assert(GENERATOR_POINT[0] == 0x04);
 
-    static constexpr StorageType calculate_modular_inverse_mod_r(StorageType value)
+    static constexpr NativeWord calculate_modular_inverse_mod_word(NativeWord value)
     {
-        // Calculate the modular multiplicative inverse of value mod 2^bit_size using the extended euclidean algorithm
-        using StorageTypeP1 = AK::UFixedBigInt<bit_size + 1>;
-
-        StorageTypeP1 old_r = value;
-        StorageTypeP1 r = static_cast<StorageTypeP1>(1u) << KEY_BIT_SIZE;
-        StorageTypeP1 old_s = 1u;
-        StorageTypeP1 s = 0u;
-
-        while (!r.is_zero_constant_time()) {
-            StorageTypeP1 r_save = r;
-            StorageTypeP1 quotient = old_r.div_mod(r, r);
-            old_r = r_save;
-
-            StorageTypeP1 s_save = s;
-            s = old_s - quotient * s;
-            old_s = s_save;
-        }
-
-        return static_cast<StorageType>(old_s);
+        // Calculate the modular multiplicative inverse of an odd value mod 2^word_size using Newton's iteration.
+        // An odd value is its own inverse mod 8, and every iteration doubles the amount of correct low bits.
+        NativeWord inverse = value;
+        for (size_t bits = 3; bits < AK::Detail::native_word_size; bits *= 2)
+            inverse *= 2 - value * inverse;
+        return inverse;
     }
 
     static constexpr StorageType calculate_r2_mod(StorageType modulus)
@@ -127,11 +128,15 @@ private:
     // Verify that A = -3 mod p, which is required for some optimizations
     static_assert(A == PRIME - 3);
 
+    // Montgomery multiplication requires odd moduli
+    static_assert((static_cast<NativeWord>(PRIME) & 1) == 1);
+    static_assert((static_cast<NativeWord>(ORDER) & 1) == 1);
+
     // Precomputed helper values for reduction and Montgomery multiplication
     static constexpr StorageType REDUCE_PRIME = StorageType { 0 } - PRIME;
     static constexpr StorageType REDUCE_ORDER = StorageType { 0 } - ORDER;
-    static constexpr StorageType PRIME_INVERSE_MOD_R = StorageType { 0 } - calculate_modular_inverse_mod_r(PRIME);
-    static constexpr StorageType ORDER_INVERSE_MOD_R = StorageType { 0 } - calculate_modular_inverse_mod_r(ORDER);
+    static constexpr NativeWord PRIME_INVERSE_MOD_WORD = 0 - calculate_modular_inverse_mod_word(static_cast<NativeWord>(PRIME));
+    static constexpr NativeWord ORDER_INVERSE_MOD_WORD = 0 - calculate_modular_inverse_mod_word(static_cast<NativeWord>(ORDER));
     static constexpr StorageType R2_MOD_PRIME = calculate_r2_mod(PRIME);
     static constexpr StorageType R2_MOD_ORDER = calculate_r2_mod(ORDER);
 
@@ -147,7 +152,11 @@ public:
 
     ErrorOr<ByteBuffer> generate_public_key(ReadonlyBytes a) override
     {
-        return compute_coordinate(a, GENERATOR_POINT);
+        AK::FixedMemoryStream scalar_stream { a };
+
+        StorageType scalar = TRY(scalar_stream.read_value<BigEndian<StorageType>>());
+        ProjectivePoint result = TRY(generate_public_key_internal(scalar));
+        return export_uncompressed_point(result);
     }
 
     ErrorOr<ByteBuffer> compute_coordinate(ReadonlyBytes scalar_bytes, ReadonlyBytes point_bytes) override
@@ -156,16 +165,9 @@ public:
         AK::FixedMemoryStream point_stream { point_bytes };
 
         StorageType scalar = TRY(scalar_stream.read_value<BigEndian<StorageType>>());
-        JacobianPoint point = TRY(read_uncompressed_point(point_stream));
-        JacobianPoint result = TRY(compute_coordinate_internal(scalar, point));
-
-        // Export the values into an output buffer
-        auto buf = TRY(ByteBuffer::create_uninitialized(POINT_BYTE_SIZE));
-        AK::FixedMemoryStream buf_stream { buf.bytes() };
-        TRY(buf_stream.write_value<u8>(0x04));
-        TRY(buf_stream.write_value<BigEndian<StorageType>>(result.x));
-        TRY(buf_stream.write_value<BigEndian<StorageType>>(result.y));
-        return buf;
+        ProjectivePoint point = TRY(read_uncompressed_point(point_stream));
+        ProjectivePoint result = TRY(compute_coordinate_internal(scalar, point));
+        return export_uncompressed_point(result);
     }
 
     ErrorOr<ByteBuffer> derive_premaster_key(ReadonlyBytes shared_point) override
@@ -200,6 +202,10 @@ public:
             s |= (ss << (i * 32));
         }
 
+        // Both r and s have to be in [1, n - 1]
+        if (r.is_zero_constant_time() || s.is_zero_constant_time() || r >= ORDER || s >= ORDER)
+            return false;
+
         // z is the hash
         StorageType z = 0u;
         for (uint8_t byte : hash) {
@@ -208,7 +214,15 @@ public:
         }
 
         AK::FixedMemoryStream pubkey_stream { pubkey };
-        JacobianPoint pubkey_point = TRY(read_uncompressed_point(pubkey_stream));
+        ProjectivePoint pubkey_point = TRY(read_uncompressed_point(pubkey_stream));
+
+        // Convert the input point into Montgomery form
+        pubkey_point.x = to_montgomery(pubkey_point.x);
+        pubkey_point.y = to_montgomery(pubkey_point.y);
+        pubkey_point.z = to_montgomery(pubkey_point.z);
+
+        if (!is_point_on_curve(pubkey_point))
+            return Error::from_string_literal("SECPxxxr1: point is not on the curve");
 
         StorageType r_mo = to_montgomery_order(r);
         StorageType s_mo = to_montgomery_order(s);
@@ -222,50 +236,37 @@ public:
         u1 = from_montgomery_order(u1);
         u2 = from_montgomery_order(u2);
 
-        JacobianPoint point1 = TRY(generate_public_key_internal(u1));
-        JacobianPoint point2 = TRY(compute_coordinate_internal(u2, pubkey_point));
-
-        // Convert the input point into Montgomery form
-        point1.x = to_montgomery(point1.x);
-        point1.y = to_montgomery(point1.y);
-        point1.z = to_montgomery(point1.z);
-
-        VERIFY(is_point_on_curve(point1));
-
-        // Convert the input point into Montgomery form
-        point2.x = to_montgomery(point2.x);
-        point2.y = to_montgomery(point2.y);
-        point2.z = to_montgomery(point2.z);
-
-        VERIFY(is_point_on_curve(point2));
-
-        JacobianPoint result = point_add(point1, point2);
+        // R = u1 * G + u2 * Q
+        ProjectivePoint result = point_add(point_multiply_generator(u1), point_multiply(u2, pubkey_point));
+        if (modular_reduce(result.z).is_zero_constant_time())
+            return false;
 
-        // Convert from Jacobian coordinates back to Affine coordinates
-        convert_jacobian_to_affine(result);
+        // Convert from projective coordinates back to affine coordinates
+        convert_projective_to_affine(result);
 
         // Make sure the resulting point is on the curve
         VERIFY(is_point_on_curve(result));
 
-        // Convert the result back from Montgomery form
-        result.x = from_montgomery(result.x);
-        result.y = from_montgomery(result.y);
-        // Final modular reduction on the coordinates
-        result.x = modular_reduce(result.x);
-        result.y = modular_reduce(result.y);
+        // Convert the result back from Montgomery form, and check that x mod n = r
+        result.x = modular_reduce(from_montgomery(result.x));
+        result.x = modular_reduce_order(result.x);
 
         return r.is_equal_to_constant_time(result.x);
     }
 
 private:
-    ErrorOr<JacobianPoint> generate_public_key_internal(StorageType a)
+    ErrorOr<ProjectivePoint> generate_public_key_internal(StorageType scalar)
     {
-        AK::FixedMemoryStream generator_point_stream { GENERATOR_POINT };
-        JacobianPoint point = TRY(read_uncompressed_point(generator_point_stream));
-        return compute_coordinate_internal(a, point);
+        // FIXME: This will slightly bias the distribution of client secrets
+        scalar = modular_reduce_order(scalar);
+        if (scalar.is_zero_constant_time())
+            return Error::from_string_literal("SECPxxxr1: scalar is zero");
+
+        ProjectivePoint result = point_multiply_generator(scalar);
+        return convert_result_point(result);
     }
 
-    ErrorOr<JacobianPoint> compute_coordinate_internal(StorageType scalar, JacobianPoint point)
+    ErrorOr<ProjectivePoint> compute_coordinate_internal(StorageType scalar, ProjectivePoint point)
     {
         // FIXME: This will slightly bias the distribution of client secrets
         scalar = modular_reduce_order(scalar);
@@ -281,24 +282,14 @@ private:
         if (!is_point_on_curve(point))
             return Error::from_string_literal("SECPxxxr1: point is not on the curve");
 
-        JacobianPoint result { 0, 0, 0 };
-        JacobianPoint temp_result { 0, 0, 0 };
-
-        // Calculate the scalar times point multiplication in constant time
-        for (size_t i = 0; i < KEY_BIT_SIZE; i++) {
-            temp_result = point_add(result, point);
-
-            auto condition = (scalar & 1u) == 1u;
-            result.x = select(result.x, temp_result.x, condition);
-            result.y = select(result.y, temp_result.y, condition);
-            result.z = select(result.z, temp_result.z, condition);
-
-            point = point_double(point);
-            scalar >>= 1u;
-        }
+        ProjectivePoint result = point_multiply(scalar, point);
+        return convert_result_point(result);
+    }
 
-        // Convert from Jacobian coordinates back to Affine coordinates
-        convert_jacobian_to_affine(result);
+    static ProjectivePoint convert_result_point(ProjectivePoint result)
+    {
+        // Convert from projective coordinates back to affine coordinates
+        convert_projective_to_affine(result);
 
         // Make sure the resulting point is on the curve
         VERIFY(is_point_on_curve(result));
@@ -315,13 +306,24 @@ private:
         return result;
     }
 
-    static ErrorOr<JacobianPoint> read_uncompressed_point(Stream& stream)
+    static ErrorOr<ByteBuffer> export_uncompressed_point(ProjectivePoint const& point)
+    {
+        // Export the values into an output buffer
+        auto buf = TRY(ByteBuffer::create_uninitialized(POINT_BYTE_SIZE));
+        AK::FixedMemoryStream buf_stream { buf.bytes() };
+        TRY(buf_stream.write_value<u8>(0x04));
+        TRY(buf_stream.write_value<BigEndian<StorageType>>(point.x));
+        TRY(buf_stream.write_value<BigEndian<StorageType>>(point.y));
+        return buf;
+    }
+
+    static ErrorOr<ProjectivePoint> read_uncompressed_point(Stream& stream)
     {
         // Make sure the point is uncompressed
         if (TRY(stream.read_value<u8>()) != 0x04)
             return Error::from_string_literal("SECPxxxr1: point is not uncompressed format");
 
-        JacobianPoint point {
+        ProjectivePoint point {
             TRY(stream.read_value<BigEndian<StorageType>>()),
             TRY(stream.read_value<BigEndian<StorageType>>()),
             1u,
@@ -330,16 +332,23 @@ private:
         return point;
     }
 
-    constexpr StorageType select(StorageType const& left, StorageType const& right, bool condition)
+    static constexpr StorageType select(StorageType const& left, StorageType const& right, bool condition)
     {
         // If condition = 0 return left else right
-        StorageType mask = static_cast<StorageType>(condition) - 1;
+        NativeWord mask = static_cast<NativeWord>(condition) - 1;
         AK::taint_for_optimizer(mask);
 
-        return (left & mask) | (right & ~mask);
+        StorageType output;
+        auto left_words = left.span();
+        auto right_words = right.span();
+        auto output_words = output.span();
+#pragma GCC unroll 12
+        for (size_t i = 0; i < WORD_COUNT; i++)
+            output_words[i] = (left_words[i] & mask) | (right_words[i] & ~mask);
+        return output;
     }
 
-    constexpr StorageType modular_reduce(StorageType const& value)
+    static constexpr StorageType modular_reduce(StorageType const& value)
     {
         // Add -prime % 2^KEY_BIT_SIZE
         bool carry = false;
@@ -349,7 +358,7 @@ private:
         return select(value, other, carry);
     }
 
-    constexpr StorageType modular_reduce_order(StorageType const& value)
+    static constexpr StorageType modular_reduce_order(StorageType const& value)
     {
         // Add -order % 2^KEY_BIT_SIZE
         bool carry = false;
@@ -359,77 +368,148 @@ private:
         return select(value, other, carry);
     }
 
-    constexpr StorageType modular_add(StorageType const& left, StorageType const& right, bool carry_in = false)
+    // Field elements are always kept fully reduced (below p), which Montgomery multiplication preserves as long as one of
+    // its operands is reduced. This means additions and subtractions only ever need a single correction step.
+    static constexpr StorageType modular_add(StorageType const& left, StorageType const& right)
     {
-        bool carry = carry_in;
-        StorageType output = left.addc(right, carry);
+        using AK::Detail::add_words;
+        using AK::Detail::sub_words;
 
-        // If there is a carry, subtract p by adding 2^KEY_BIT_SIZE - p
-        StorageType addend = select(0u, REDUCE_PRIME, carry);
-        carry = false;
-        output = output.addc(addend, carry);
+        StorageType sum;
+        StorageType difference;
+        auto left_words = left.span();
+        auto right_words = right.span();
+        auto prime_words = PRIME.span();
+        auto sum_words = sum.span();
+        auto difference_words = difference.span();
 
-        // If there is still a carry, subtract p by adding 2^KEY_BIT_SIZE - p
-        addend = select(0u, REDUCE_PRIME, carry);
-        return output + addend;
+        // sum = left + right, difference = sum - p
+        bool carry = false;
+        bool borrow = false;
+#pragma GCC unroll 12
+        for (size_t i = 0; i < WORD_COUNT; i++) {
+            sum_words[i] = add_words(left_words[i], right_words[i], carry);
+            difference_words[i] = sub_words(sum_words[i], prime_words[i], borrow);
+        }
+
+        // Keep the sum only if it was smaller than p
+        return select(difference, sum, !carry & borrow);
     }
 
-    constexpr StorageType modular_sub(StorageType const& left, StorageType const& right)
+    static constexpr StorageType modular_sub(StorageType const& left, StorageType const& right)
     {
+        using AK::Detail::add_words;
+        using AK::Detail::sub_words;
+
+        StorageType difference;
+        auto left_words = left.span();
+        auto right_words = right.span();
+        auto difference_words = difference.span();
+
+        // difference = left - right
         bool borrow = false;
-        StorageType output = left.subc(right, borrow);
+#pragma GCC unroll 12
+        for (size_t i = 0; i < WORD_COUNT; i++)
+            difference_words[i] = sub_words(left_words[i], right_words[i], borrow);
 
-        // If there is a borrow, add p by subtracting 2^KEY_BIT_SIZE - p
-        StorageType sub = select(0u, REDUCE_PRIME, borrow);
-        borrow = false;
-        output = output.subc(sub, borrow);
+        // If there is a borrow, add p back
+        StorageType addend = select(0u, PRIME, borrow);
+        auto addend_words = addend.span();
+        bool carry = false;
+#pragma GCC unroll 12
+        for (size_t i = 0; i < WORD_COUNT; i++)
+            difference_words[i] = add_words(difference_words[i], addend_words[i], carry);
 
-        // If there is still a borrow, add p by subtracting 2^KEY_BIT_SIZE - p
-        sub = select(0u, REDUCE_PRIME, borrow);
-        return output - sub;
+        return difference;
     }
 
-    constexpr StorageType modular_multiply(StorageType const& left, StorageType const& right)
+    template<StorageType const& modulus, NativeWord modulus_inverse>
+    static constexpr StorageType montgomery_multiply(StorageType const& left, StorageType const& right)
     {
         // Modular multiplication using the Montgomery method: https://en.wikipedia.org/wiki/Montgomery_modular_multiplication
         // This requires that the inputs to this function are in Montgomery form.
+        //
+        // The reduction is interleaved with the multiplication one word at a time (the "CIOS" method), so the
+        // double-width product is never materialized. Since the modulus is a compile-time constant, the special form of
+        // the NIST primes (words that are 0 or all ones, and -p^-1 mod 2^64 being 1 for P-256) is folded into the
+        // multiplications by the compiler.
+        using AK::Detail::add_words;
+        using AK::Detail::native_word_size;
+        using AK::Detail::sub_words;
+        using AK::Detail::wide_multiply;
+
+        auto left_words = left.span();
+        auto right_words = right.span();
+        auto modulus_words = modulus.span();
+
+        NativeWord t[WORD_COUNT + 2] {};
+#pragma GCC unroll 12
+        for (size_t i = 0; i < WORD_COUNT; i++) {
+            // t = t + left * right[i]
+            NativeWord carry = 0;
+#pragma GCC unroll 12
+            for (size_t j = 0; j < WORD_COUNT; j++) {
+                NativeDoubleWord product = wide_multiply(left_words[j], right_words[i]) + t[j] + carry;
+                t[j] = static_cast<NativeWord>(product);
+                carry = static_cast<NativeWord>(product >> native_word_size);
+            }
+            bool overflow = false;
+            t[WORD_COUNT] = add_words(t[WORD_COUNT], carry, overflow);
+            t[WORD_COUNT + 1] = overflow;
+
+            // t = (t + m * modulus) / 2^word_size, where m is chosen such that the lowest word of the sum is zero
+            NativeWord m = t[0] * modulus_inverse;
+            NativeDoubleWord product = wide_multiply(m, modulus_words[0]) + t[0];
+            carry = static_cast<NativeWord>(product >> native_word_size);
+#pragma GCC unroll 12
+            for (size_t j = 1; j < WORD_COUNT; j++) {
+                product = wide_multiply(m, modulus_words[j]) + t[j] + carry;
+                t[j - 1] = static_cast<NativeWord>(product);
+                carry = static_cast<NativeWord>(product >> native_word_size);
+            }
+            overflow = false;
+            t[WORD_COUNT - 1] = add_words(t[WORD_COUNT], carry, overflow);
+            t[WORD_COUNT] = t[WORD_COUNT + 1] + overflow;
+        }
 
-        // T = left * right
-        StorageTypeX2 mult = left.wide_multiply(right);
-        StorageType mult_mod_r = static_cast<StorageType>(mult);
-
-        // m = ((T mod R) * curve_p')
-        StorageType m = mult_mod_r * PRIME_INVERSE_MOD_R;
-
-        // mp = (m mod R) * curve_p
-        StorageTypeX2 mp = m.wide_multiply(PRIME);
+        // The result is below 2 * modulus if either input was below the modulus (and below 2^KEY_BIT_SIZE + modulus
+        // otherwise), so subtracting the modulus once reduces it
+        StorageType output;
+        StorageType subtracted;
+        auto output_words = output.span();
+        auto subtracted_words = subtracted.span();
+        bool borrow = false;
+#pragma GCC unroll 12
+        for (size_t i = 0; i < WORD_COUNT; i++) {
+            output_words[i] = t[i];
+            subtracted_words[i] = sub_words(t[i], modulus_words[i], borrow);
+        }
 
-        // t = (T + mp)
-        bool carry = false;
-        mult_mod_r.addc(static_cast<StorageType>(mp), carry);
+        // Keep the unreduced value only if it was smaller than the modulus
+        return select(subtracted, output, borrow & (t[WORD_COUNT] == 0));
+    }
 
-        // output = t / R
-        StorageType mult_high = static_cast<StorageType>(mult >> KEY_BIT_SIZE);
-        StorageType mp_high = static_cast<StorageType>(mp >> KEY_BIT_SIZE);
-        return modular_add(mult_high, mp_high, carry);
+    static constexpr StorageType modular_multiply(StorageType const& left, StorageType const& right)
+    {
+        return montgomery_multiply<PRIME, PRIME_INVERSE_MOD_WORD>(left, right);
     }
 
-    constexpr StorageType modular_square(StorageType const& value)
+    static constexpr StorageType modular_square(StorageType const& value)
     {
         return modular_multiply(value, value);
     }
 
-    constexpr StorageType to_montgomery(StorageType const& value)
+    static constexpr StorageType to_montgomery(StorageType const& value)
     {
         return modular_multiply(value, R2_MOD_PRIME);
     }
 
-    constexpr StorageType from_montgomery(StorageType const& value)
+    static constexpr StorageType from_montgomery(StorageType const& value)
     {
         return modular_multiply(value, 1u);
     }
 
-    constexpr StorageType modular_inverse(StorageType const& value)
+    static constexpr StorageType modular_inverse(StorageType const& value)
     {
         // Modular inverse modulo the curve prime can be computed using Fermat's little theorem: a^(p-2) mod p = a^-1 mod p.
         // Calculating a^(p-2) mod p can be done using the square-and-multiply exponentiation method, as p-2 is constant.
@@ -448,62 +528,27 @@ private:
         return result;
     }
 
-    constexpr StorageType modular_add_order(StorageType const& left, StorageType const& right, bool carry_in = false)
+    static constexpr StorageType modular_multiply_order(StorageType const& left, StorageType const& right)
     {
-        bool carry = carry_in;
-        StorageType output = left.addc(right, carry);
-
-        // If there is a carry, subtract n by adding 2^KEY_BIT_SIZE - n
-        StorageType addend = select(0u, REDUCE_ORDER, carry);
-        carry = false;
-        output = output.addc(addend, carry);
-
-        // If there is still a carry, subtract n by adding 2^KEY_BIT_SIZE - n
-        addend = select(0u, REDUCE_ORDER, carry);
-        return output + addend;
+        return montgomery_multiply<ORDER, ORDER_INVERSE_MOD_WORD>(left, right);
     }
 
-    constexpr StorageType modular_multiply_order(StorageType const& left, StorageType const& right)
-    {
-        // Modular multiplication using the Montgomery method: https://en.wikipedia.org/wiki/Montgomery_modular_multiplication
-        // This requires that the inputs to this function are in Montgomery form.
-
-        // T = left * right
-        StorageTypeX2 mult = left.wide_multiply(right);
-        StorageType mult_mod_r = static_cast<StorageType>(mult);
-
-        // m = ((T mod R) * curve_n')
-        StorageType m = mult_mod_r * ORDER_INVERSE_MOD_R;
-
-        // mp = (m mod R) * curve_n
-        StorageTypeX2 mp = m.wide_multiply(ORDER);
-
-        // t = (T + mp)
-        bool carry = false;
-        mult_mod_r.addc(static_cast<StorageType>(mp), carry);
-
-        // output = t / R
-        StorageType mult_high = static_cast<StorageType>(mult >> KEY_BIT_SIZE);
-        StorageType mp_high = static_cast<StorageType>(mp >> KEY_BIT_SIZE);
-        return modular_add_order(mult_high, mp_high, carry);
-    }
-
-    constexpr StorageType modular_square_order(StorageType const& value)
+    static constexpr StorageType modular_square_order(StorageType const& value)
     {
         return modular_multiply_order(value, value);
     }
 
-    constexpr StorageType to_montgomery_order(StorageType const& value)
+    static constexpr StorageType to_montgomery_order(StorageType const& value)
     {
         return modular_multiply_order(value, R2_MOD_ORDER);
     }
 
-    constexpr StorageType from_montgomery_order(StorageType const& value)
+    static constexpr StorageType from_montgomery_order(StorageType const& value)
     {
         return modular_multiply_order(value, 1u);
     }
 
-    constexpr StorageType modular_inverse_order(StorageType const& value)
+    static constexpr StorageType modular_inverse_order(StorageType const& value)
     {
         // Modular inverse modulo the curve order can be computed using Fermat's little theorem: a^(n-2) mod n = a^-1 mod n.
         // Calculating a^(n-2) mod n can be done using the square-and-multiply exponentiation method, as n-2 is constant.
@@ -522,136 +567,213 @@ private:
         return result;
     }
 
-    JacobianPoint point_double(JacobianPoint const& point)
-    {
-        // Based on "Point Doubling" from http://point-at-infinity.org/ecc/Prime_Curve_Jacobian_Coordinates.html
+    static ProjectivePoint point_double(ProjectivePoint const& point)
+    {
+        // Complete doubling for a = -3, based on Algorithm 6 from "Complete addition formulas for prime order elliptic curves"
+        // by Renes, Costello and Batina: https://eprint.iacr.org/2015/1060.pdf
+        // This works for every input point (including the point at infinity) without any branches.
+        static constexpr StorageType b = to_montgomery(B);
+
+        StorageType t0 = modular_square(point.x);
+        StorageType t1 = modular_square(point.y);
+        StorageType t2 = modular_square(point.z);
+        StorageType t3 = modular_multiply(point.x, point.y);
+        t3 = modular_add(t3, t3);
+        StorageType z3 = modular_multiply(point.x, point.z);
+        z3 = modular_add(z3, z3);
+        StorageType y3 = modular_multiply(b, t2);
+        y3 = modular_sub(y3, z3);
+        StorageType x3 = modular_add(y3, y3);
+        y3 = modular_add(x3, y3);
+        x3 = modular_sub(t1, y3);
+        y3 = modular_add(t1, y3);
+        y3 = modular_multiply(x3, y3);
+        x3 = modular_multiply(x3, t3);
+        t3 = modular_add(t2, t2);
+        t2 = modular_add(t2, t3);
+        z3 = modular_multiply(b, z3);
+        z3 = modular_sub(z3, t2);
+        z3 = modular_sub(z3, t0);
+        t3 = modular_add(z3, z3);
+        z3 = modular_add(z3, t3);
+        t3 = modular_add(t0, t0);
+        t0 = modular_add(t3, t0);
+        t0 = modular_sub(t0, t2);
+        t0 = modular_multiply(t0, z3);
+        y3 = modular_add(y3, t0);
+        t0 = modular_multiply(point.y, point.z);
+        t0 = modular_add(t0, t0);
+        z3 = modular_multiply(t0, z3);
+        x3 = modular_sub(x3, z3);
+        z3 = modular_multiply(t0, t1);
+        z3 = modular_add(z3, z3);
+        z3 = modular_add(z3, z3);
+
+        return ProjectivePoint { x3, y3, z3 };
+    }
+
+    static ProjectivePoint point_add(ProjectivePoint const& point_a, ProjectivePoint const& point_b)
+    {
+        // Complete addition for a = -3, based on Algorithm 4 from "Complete addition formulas for prime order elliptic curves"
+        // by Renes, Costello and Batina: https://eprint.iacr.org/2015/1060.pdf
+        // This works for every pair of input points (including equal points and the point at infinity) without any branches.
+        static constexpr StorageType b = to_montgomery(B);
+
+        StorageType t0 = modular_multiply(point_a.x, point_b.x);
+        StorageType t1 = modular_multiply(point_a.y, point_b.y);
+        StorageType t2 = modular_multiply(point_a.z, point_b.z);
+        StorageType t3 = modular_add(point_a.x, point_a.y);
+        StorageType t4 = modular_add(point_b.x, point_b.y);
+        t3 = modular_multiply(t3, t4);
+        t4 = modular_add(t0, t1);
+        t3 = modular_sub(t3, t4);
+        t4 = modular_add(point_a.y, point_a.z);
+        StorageType x3 = modular_add(point_b.y, point_b.z);
+        t4 = modular_multiply(t4, x3);
+        x3 = modular_add(t1, t2);
+        t4 = modular_sub(t4, x3);
+        x3 = modular_add(point_a.x, point_a.z);
+        StorageType y3 = modular_add(point_b.x, point_b.z);
+        x3 = modular_multiply(x3, y3);
+        y3 = modular_add(t0, t2);
+        y3 = modular_sub(x3, y3);
+        StorageType z3 = modular_multiply(b, t2);
+        x3 = modular_sub(y3, z3);
+        z3 = modular_add(x3, x3);
+        x3 = modular_add(x3, z3);
+        z3 = modular_sub(t1, x3);
+        x3 = modular_add(t1, x3);
+        y3 = modular_multiply(b, y3);
+        t1 = modular_add(t2, t2);
+        t2 = modular_add(t1, t2);
+        y3 = modular_sub(y3, t2);
+        y3 = modular_sub(y3, t0);
+        t1 = modular_add(y3, y3);
+        y3 = modular_add(t1, y3);
+        t1 = modular_add(t0, t0);
+        t0 = modular_add(t1, t0);
+        t0 = modular_sub(t0, t2);
+        t1 = modular_multiply(t4, y3);
+        t2 = modular_multiply(t0, y3);
+        y3 = modular_multiply(x3, z3);
+        y3 = modular_add(y3, t2);
+        x3 = modular_multiply(x3, t3);
+        x3 = modular_sub(x3, t1);
+        z3 = modular_multiply(z3, t4);
+        t1 = modular_multiply(t3, t0);
+        z3 = modular_add(z3, t1);
+
+        return ProjectivePoint { x3, y3, z3 };
+    }
+
+    static WindowTable make_window_table(ProjectivePoint const& point)
+    {
+        // table[i] = (i + 1) * point
+        WindowTable table;
+        table[0] = point;
+        table[1] = point_double(point);
+        for (size_t i = 2; i < WINDOW_TABLE_SIZE; i++)
+            table[i] = point_add(table[i - 1], point);
+        return table;
+    }
+
+    static Array<WindowTable, WINDOW_COUNT> const& generator_table()
+    {
+        // table[i][j] = (j + 1) * 16^i * G, which turns a multiplication of the generator into one table lookup and one
+        // point addition per window, without any doublings. It is computed once, on first use.
+        static Array<WindowTable, WINDOW_COUNT> table;
+        static bool const initialized = [] {
+            AK::FixedMemoryStream generator_point_stream { GENERATOR_POINT.span() };
+            ProjectivePoint base = MUST(read_uncompressed_point(generator_point_stream));
+            base.x = to_montgomery(base.x);
+            base.y = to_montgomery(base.y);
+            base.z = to_montgomery(base.z);
+
+            for (size_t i = 0; i < WINDOW_COUNT; i++) {
+                table[i] = make_window_table(base);
+                base = point_double(table[i][WINDOW_TABLE_SIZE - 1]);
+            }
+            return true;
+        }();
+        VERIFY(initialized);
+        return table;
+    }
 
-        // if (Y == 0)
-        //   return POINT_AT_INFINITY
-        if (point.y.is_zero_constant_time()) {
-            VERIFY_NOT_REACHED();
+    static constexpr u8 scalar_window(StorageType const& scalar, size_t index)
+    {
+        // Returns the bits [4 * index - 1, 4 * index + 3] of the scalar, where bits outside of the scalar are zero.
+        // The positions only depend on the index, so this does not leak anything about the scalar.
+        auto words = scalar.span();
+        u8 window = 0;
+        for (size_t i = 0; i < WINDOW_BITS + 1; i++) {
+            size_t position = index * WINDOW_BITS + i;
+            if (position == 0 || position > KEY_BIT_SIZE)
+                continue;
+            position--;
+            window |= ((words[position / AK::Detail::native_word_size] >> (position % AK::Detail::native_word_size)) & 1) << i;
         }
+        return window;
+    }
+
+    static ProjectivePoint select_from_window_table(WindowTable const& table, u8 window)
+    {
+        // Booth recoding: the window bits b4..b0 represent the signed digit b0 + b1 + 2 * b2 + 4 * b3 - 8 * b4.
+        // Every table entry is read, so the memory access pattern does not depend on the digit.
+        u32 negative = window >> 4;
+        u32 low = (window & 1) + ((window >> 1) & 7);
+        u32 magnitude = low + negative * (WINDOW_TABLE_SIZE - 2 * low);
 
-        StorageType temp;
-
-        // Y2 = Y^2
-        StorageType y2 = modular_square(point.y);
-
-        // S = 4*X*Y2
-        StorageType s = modular_multiply(point.x, y2);
-        s = modular_add(s, s);
-        s = modular_add(s, s);
-
-        // M = 3*X^2 + a*Z^4 = 3*(X + Z^2)*(X - Z^2)
-        // This specific equation from https://github.com/earlephilhower/bearssl-esp8266/blob/6105635531027f5b298aa656d44be2289b2d434f/src/ec/ec_p256_m64.c#L811-L816
-        // This simplification only works because a = -3 mod p
-        temp = modular_square(point.z);
-        StorageType m = modular_add(point.x, temp);
-        temp = modular_sub(point.x, temp);
-        m = modular_multiply(m, temp);
-        temp = modular_add(m, m);
-        m = modular_add(m, temp);
-
-        // X' = M^2 - 2*S
-        StorageType xp = modular_square(m);
-        xp = modular_sub(xp, s);
-        xp = modular_sub(xp, s);
-
-        // Y' = M*(S - X') - 8*Y2^2
-        StorageType yp = modular_sub(s, xp);
-        yp = modular_multiply(yp, m);
-        temp = modular_square(y2);
-        temp = modular_add(temp, temp);
-        temp = modular_add(temp, temp);
-        temp = modular_add(temp, temp);
-        yp = modular_sub(yp, temp);
-
-        // Z' = 2*Y*Z
-        StorageType zp = modular_multiply(point.y, point.z);
-        zp = modular_add(zp, zp);
-
-        // return (X', Y', Z')
-        return JacobianPoint { xp, yp, zp };
-    }
-
-    JacobianPoint point_add(JacobianPoint const& point_a, JacobianPoint const& point_b)
-    {
-        // Based on "Point Addition" from  http://point-at-infinity.org/ecc/Prime_Curve_Jacobian_Coordinates.html
-        if (point_a.x.is_zero_constant_time() && point_a.y.is_zero_constant_time() && point_a.z.is_zero_constant_time()) {
-            return point_b;
+        ProjectivePoint result { 0u, to_montgomery(1u), 0u };
+        for (size_t i = 0; i < WINDOW_TABLE_SIZE; i++) {
+            bool match = magnitude == i + 1;
+            result.x = select(result.x, table[i].x, match);
+            result.y = select(result.y, table[i].y, match);
+            result.z = select(result.z, table[i].z, match);
         }
 
-        StorageType temp;
-
-        temp = modular_square(point_b.z);
-        // U1 = X1*Z2^2
-        StorageType u1 = modular_multiply(point_a.x, temp);
-        // S1 = Y1*Z2^3
-        StorageType s1 = modular_multiply(point_a.y, temp);
-        s1 = modular_multiply(s1, point_b.z);
-
-        temp = modular_square(point_a.z);
-        // U2 = X2*Z1^2
-        StorageType u2 = modular_multiply(point_b.x, temp);
-        // S2 = Y2*Z1^3
-        StorageType s2 = modular_multiply(point_b.y, temp);
-        s2 = modular_multiply(s2, point_a.z);
-
-        // if (U1 == U2)
-        //   if (S1 != S2)
-        //     return POINT_AT_INFINITY
-        //   else
-        //     return POINT_DOUBLE(X1, Y1, Z1)
-        if (u1.is_equal_to_constant_time(u2)) {
-            if (s1.is_equal_to_constant_time(s2)) {
-                return point_double(point_a);
-            } else {
-                VERIFY_NOT_REACHED();
-            }
+        result.y = select(result.y, modular_sub(0u, result.y), negative);
+        return result;
+    }
+
+    static ProjectivePoint point_multiply(StorageType const& scalar, ProjectivePoint const& point)
+    {
+        // Calculate the scalar times point multiplication in constant time, using a fixed window.
+        WindowTable table = make_window_table(point);
+
+        ProjectivePoint result = select_from_window_table(table, scalar_window(scalar, WINDOW_COUNT - 1));
+        for (size_t i = WINDOW_COUNT - 1; i-- > 0;) {
+            for (size_t j = 0; j < WINDOW_BITS; j++)
+                result = point_double(result);
+            result = point_add(result, select_from_window_table(table, scalar_window(scalar, i)));
         }
 
-        // H = U2 - U1
-        StorageType h = modular_sub(u2, u1);
-        StorageType h2 = modular_square(h);
-        StorageType h3 = modular_multiply(h2, h);
-        // R = S2 - S1
-        StorageType r = modular_sub(s2, s1);
-        // X3 = R^2 - H^3 - 2*U1*H^2
-        StorageType x3 = modular_square(r);
-        x3 = modular_sub(x3, h3);
-        temp = modular_multiply(u1, h2);
-        temp = modular_add(temp, temp);
-        x3 = modular_sub(x3, temp);
-        // Y3 = R*(U1*H^2 - X3) - S1*H^3
-        StorageType y3 = modular_multiply(u1, h2);
-        y3 = modular_sub(y3, x3);
-        y3 = modular_multiply(y3, r);
-        temp = modular_multiply(s1, h3);
-        y3 = modular_sub(y3, temp);
-        // Z3 = H*Z1*Z2
-        StorageType z3 = modular_multiply(h, point_a.z);
-        z3 = modular_multiply(z3, point_b.z);
-        // return (X3, Y3, Z3)
-        return JacobianPoint { x3, y3, z3 };
-    }
-
-    void convert_jacobian_to_affine(JacobianPoint& point)
-    {
-        StorageType temp;
-        // X' = X/Z^2
-        temp = modular_square(point.z);
-        temp = modular_inverse(temp);
+        return result;
+    }
+
+    static ProjectivePoint point_multiply_generator(StorageType const& scalar)
+    {
+        // Calculate the scalar times generator multiplication in constant time, using the precomputed table.
+        auto const& table = generator_table();
+
+        ProjectivePoint result = select_from_window_table(table[0], scalar_window(scalar, 0));
+        for (size_t i = 1; i < WINDOW_COUNT; i++)
+            result = point_add(result, select_from_window_table(table[i], scalar_window(scalar, i)));
+
+        return result;
+    }
+
+    static void convert_projective_to_affine(ProjectivePoint& point)
+    {
+        StorageType temp = modular_inverse(point.z);
+        // X' = X/Z
         point.x = modular_multiply(point.x, temp);
-        // Y' = Y/Z^3
-        temp = modular_square(point.z);
-        temp = modular_multiply(temp, point.z);
-        temp = modular_inverse(temp);
+        // Y' = Y/Z
         point.y = modular_multiply(point.y, temp);
         // Z' = 1
         point.z = to_montgomery(1u);
     }
 
-    bool is_point_on_curve(JacobianPoint const& point)
+    static bool is_point_on_curve(ProjectivePoint const& point)
     {
         // This check requires the point to be in Montgomery form, with Z=1
         StorageType temp, temp2;
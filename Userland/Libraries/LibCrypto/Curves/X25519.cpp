@@ -8,25 +8,16 @@
 #include <AK/Endian.h>
 #include <AK/Random.h>
 #include <LibCrypto/Curves/Curve25519.h>
+#include <LibCrypto/Curves/Ed25519.h>
 #include <LibCrypto/Curves/X25519.h>
 
 namespace Crypto::Curves {
 
 static constexpr u8 BITS = 255;
 static constexpr u8 BYTES = 32;
-static constexpr u8 WORDS = 8;
+static constexpr u8 LIMBS = Curve25519::LIMBS;
 static constexpr u32 A24 = 121666;
 
-static void conditional_swap(u32* first, u32* second, u32 condition)
-{
-    u32 mask = ~condition + 1;
-    for (auto i = 0; i < WORDS; i++) {
-        u32 temp = mask & (first[i] ^ second[i]);
-        first[i] ^= temp;
-        second[i] ^= temp;
-    }
-}
-
 ErrorOr<ByteBuffer> X25519::generate_private_key()
 {
     auto buffer = TRY(ByteBuffer::create_uninitialized(BYTES));
@@ -36,39 +27,61 @@ ErrorOr<ByteBuffer> X25519::generate_private_key()
 
 ErrorOr<ByteBuffer> X25519::generate_public_key(ReadonlyBytes a)
 {
-    u8 generator[BYTES] { 9 };
-    return compute_coordinate(a, { generator, BYTES });
+    u8 k[BYTES];
+    memcpy(k, a.data(), BYTES);
+
+    // Set the three least significant bits of the first byte and the most significant bit of the last to zero,
+    // set the second most significant bit of the last byte to 1
+    k[0] &= 0xF8;
+    k[31] &= 0x7F;
+    k[31] |= 0x40;
+
+    // The base point u = 9 is the image of the Ed25519 base point under the birational map u = (1 + y) / (1 - y)
+    // from https://datatracker.ietf.org/doc/html/rfc7748#section-4.1, so [k]u can be computed on the Edwards curve
+    // with its precomputed table of base point multiples, instead of a Montgomery ladder.
+    Ed25519Point point;
+    Ed25519::point_multiply_base(&point, k);
+
+    // u = (Z + Y) / (Z - Y)
+    u64 u[LIMBS];
+    u64 denominator[LIMBS];
+    Curve25519::modular_add(u, point.z, point.y);
+    Curve25519::modular_subtract(denominator, point.z, point.y);
+    Curve25519::modular_multiply_inverse(denominator, denominator);
+    Curve25519::modular_multiply(u, u, denominator);
+
+    // Encode state for export
+    auto buffer = TRY(ByteBuffer::create_uninitialized(BYTES));
+    Curve25519::export_state(u, buffer.data());
+
+    return buffer;
 }
 
 // https://datatracker.ietf.org/doc/html/rfc7748#section-5
 ErrorOr<ByteBuffer> X25519::compute_coordinate(ReadonlyBytes input_k, ReadonlyBytes input_u)
 {
-    u32 k[WORDS] {};
-    u32 u[WORDS] {};
-    u32 x1[WORDS] {};
-    u32 x2[WORDS] {};
-    u32 z1[WORDS] {};
-    u32 z2[WORDS] {};
-    u32 t1[WORDS] {};
-    u32 t2[WORDS] {};
+    u8 k[BYTES];
+    u64 u[LIMBS] {};
+    u64 x1[LIMBS] {};
+    u64 x2[LIMBS] {};
+    u64 z1[LIMBS] {};
+    u64 z2[LIMBS] {};
+    u64 t1[LIMBS] {};
+    u64 t2[LIMBS] {};
 
     // Copy input to internal state
-    Curve25519::import_state(k, input_k.data());
+    memcpy(k, input_k.data(), BYTES);
 
     // Set the three least significant bits of the first byte and the most significant bit of the last to zero,
     // set the second most significant bit of the last byte to 1
-    k[0] &= 0xFFFFFFF8;
-    k[7] &= 0x7FFFFFFF;
-    k[7] |= 0x40000000;
-
-    // Copy coordinate to internal state
-    Curve25519::import_state(u, input_u.data());
-    // mask the most significant bit in the final byte.
-    u[7] &= 0x7FFFFFFF;
+    k[0] &= 0xF8;
+    k[31] &= 0x7F;
+    k[31] |= 0x40;
 
+    // Copy coordinate to internal state, masking the most significant bit in the final byte.
     // Implementations MUST accept non-canonical values and process them as
-    // if they had been reduced modulo the field prime.
-    Curve25519::modular_reduce(u, u);
+    // if they had been reduced modulo the field prime, which the field arithmetic does implicitly.
+    Curve25519::import_state(u, input_u.data());
 
     Curve25519::set(x1, 1);
     Curve25519::set(z1, 0);
@@ -78,10 +91,10 @@ ErrorOr<ByteBuffer> X25519::compute_coordinate(ReadonlyBytes input_k, ReadonlyBy
     // Montgomery ladder
     u32 swap = 0;
     for (auto i = BITS - 1; i >= 0; i--) {
-        u32 b = (k[i / BYTES] >> (i % BYTES)) & 1;
+        u32 b = (k[i / 8] >> (i % 8)) & 1;
 
-        conditional_swap(x1, x2, swap ^ b);
-        conditional_swap(z1, z2, swap ^ b);
+        Curve25519::conditional_swap(x1, x2, swap ^ b);
+        Curve25519::conditional_swap(z1, z2, swap ^ b);
 
         swap = b;
 
@@ -105,8 +118,8 @@ ErrorOr<ByteBuffer> X25519::compute_coordinate(ReadonlyBytes input_k, ReadonlyBy
         Curve25519::modular_square(x2, x2);
     }
 
-    conditional_swap(x1, x2, swap);
-    conditional_swap(z1, z2, swap);
+    Curve25519::conditional_swap(x1, x2, swap);
+    Curve25519::conditional_swap(z1, z2, swap);
 
     // Retrieve affine representation
     Curve25519::modular_multiply_inverse(u, z1);
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Error.h>
+#include <AK/Vector.h>
+#include <LibCrypto/Authentication/HMAC.h>
+
+namespace Crypto::Hash {
+
+// https://www.rfc-editor.org/rfc/rfc5869
+template<typename HashT>
+class HKDF {
+public:
+    using MACType = Authentication::HMAC<HashT>;
+
+    // https://www.rfc-editor.org/rfc/rfc5869#section-2.2
+    // Any arguments after the input keying material are passed on to the hash function, e.g. the HashKind of a Hash::Manager.
+    template<typename... HashArgs>
+    static ErrorOr<ByteBuffer> extract(ReadonlyBytes salt, ReadonlyBytes input_keying_material, HashArgs... hash_args)
+    {
+        // Note: If the salt is not provided, it is set to a string of HashLen zeros. HMAC pads its key with zeros
+        //       anyway, so an empty salt already has the same effect.
+        MACType hmac(salt, hash_args...);
+
+        // PRK = HMAC-Hash(salt, IKM)
+        auto digest = hmac.process(input_keying_material);
+        return ByteBuffer::copy(digest.immutable_data(), hmac.digest_size());
+    }
+
+    // https://www.rfc-editor.org/rfc/rfc5869#section-2.3
+    template<typename... HashArgs>
+    static ErrorOr<ByteBuffer> expand(ReadonlyBytes pseudorandom_key, ReadonlyBytes info, size_t length, HashArgs... hash_args)
+    {
+        MACType hmac(pseudorandom_key, hash_args...);
+        size_t hash_length = hmac.digest_size();
+
+        // L: length of output keying material in octets (<= 255*HashLen)
+        if (length > 255 * hash_length)
+            return Error::from_string_literal("HKDF output keying material is too long");
+
+        auto output = TRY(ByteBuffer::create_uninitialized(length));
+
+        // T(0) = empty string (zero length)
+        // T(N) = HMAC-Hash(PRK, T(N-1) | info | N)
+        Vector<u8, 64> previous_block;
+        for (size_t offset = 0, counter = 1; offset < length; offset += hash_length, ++counter) {
+            hmac.update(previous_block.span());
+            hmac.update(info);
+            u8 counter_byte = counter;
+            hmac.update(&counter_byte, 1);
+            auto block = hmac.digest();
+
+            // OKM = first L octets of T = T(1) | T(2) | T(3) | ... | T(N)
+            output.overwrite(offset, block.immutable_data(), min(hash_length, length - offset));
+
+            previous_block.clear_with_capacity();
+            TRY(previous_block.try_append(block.immutable_data(), hash_length));
+        }
+
+        return output;
+    }
+};
+
+}
@@ -7,11 +7,88 @@
 
 #include <AK/Endian.h>
 #include <AK/Memory.h>
+#include <AK/Platform.h>
+#include <AK/StdLibExtras.h>
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA1.h>
 
+#if ARCH(X86_64)
+#    include <LibCrypto/CPUFeatures.h>
+#    include <immintrin.h>
+#endif
+
 namespace Crypto::Hash {
 
+#if ARCH(X86_64)
+
+static constexpr auto sha_ni_features = CPUFeatures::SHA | CPUFeatures::SSE41;
+
+struct SHA1NIState {
+    __m128i abcd;
+    __m128i e0;
+    __m128i e1;
+    __m128i messages[4];
+};
+
+// Does rounds 4 * Group to 4 * Group + 3 with SHA-NI, where the messages hold the next 16 words of the message schedule.
+// Based on Intel's "Intel SHA Extensions" paper and its accompanying sample code.
+template<size_t Group>
+[[gnu::target("sha,sse4.1"), gnu::always_inline]] static inline void sha1_ni_four_rounds(SHA1NIState& state, u8 const* data)
+{
+    auto& message = state.messages[Group % 4];
+    auto& e = Group % 2 == 0 ? state.e0 : state.e1;
+    auto& next_e = Group % 2 == 0 ? state.e1 : state.e0;
+
+    if constexpr (Group < 4) {
+        auto const byte_swap = _mm_set_epi64x(0x0001020304050607, 0x08090a0b0c0d0e0f);
+        message = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data + Group * 16)), byte_swap);
+    }
+
+    if constexpr (Group == 0)
+        e = _mm_add_epi32(e, message);
+    else
+        e = _mm_sha1nexte_epu32(e, message);
+    next_e = state.abcd;
+
+    if constexpr (Group >= 3 && Group <= 18)
+        state.messages[(Group + 1) % 4] = _mm_sha1msg2_epu32(state.messages[(Group + 1) % 4], message);
+
+    state.abcd = _mm_sha1rnds4_epu32(state.abcd, e, Group / 5);
+
+    if constexpr (Group >= 1 && Group <= 16)
+        state.messages[(Group + 3) % 4] = _mm_sha1msg1_epu32(state.messages[(Group + 3) % 4], message);
+    if constexpr (Group >= 2 && Group <= 17)
+        state.messages[(Group + 2) % 4] = _mm_xor_si128(state.messages[(Group + 2) % 4], message);
+}
+
+template<size_t... Groups>
+[[gnu::target("sha,sse4.1"), gnu::always_inline]] static inline void sha1_ni_rounds(SHA1NIState& state, u8 const* data, IndexSequence<Groups...>)
+{
+    (sha1_ni_four_rounds<Groups>(state, data), ...);
+}
+
+[[gnu::target("sha,sse4.1")]] static void sha1_ni_transform(u32 (&digest_state)[5], u8 const* data, size_t block_count)
+{
+    SHA1NIState state;
+    state.abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(digest_state)), 0x1b);
+    state.e0 = _mm_set_epi32(static_cast<int>(digest_state[4]), 0, 0, 0);
+
+    for (size_t i = 0; i < block_count; ++i, data += 64) {
+        auto saved_abcd = state.abcd;
+        auto saved_e0 = state.e0;
+
+        sha1_ni_rounds(state, data, MakeIndexSequence<20> {});
+
+        state.e0 = _mm_sha1nexte_epu32(state.e0, saved_e0);
+        state.abcd = _mm_add_epi32(state.abcd, saved_abcd);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(digest_state), _mm_shuffle_epi32(state.abcd, 0x1b));
+    digest_state[4] = static_cast<u32>(_mm_extract_epi32(state.e0, 3));
+}
+
+#endif
+
 static constexpr auto ROTATE_LEFT(u32 value, size_t bits)
 {
     return (value << bits) | (value >> (32 - bits));
@@ -67,20 +144,44 @@ inline void SHA1::transform(u8 const* data)
     secure_zero(blocks, 16 * sizeof(u32));
 }
 
+void SHA1::transform_blocks(u8 const* data, size_t block_count)
+{
+#if ARCH(X86_64)
+    if (has_cpu_features(sha_ni_features)) {
+        sha1_ni_transform(m_state, data, block_count);
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < block_count; ++i)
+        transform(data + i * BlockSize);
+}
+
 void SHA1::update(u8 const* message, size_t length)
 {
-    while (length > 0) {
+    if (m_data_length > 0) {
         size_t copy_bytes = AK::min(length, BlockSize - m_data_length);
         __builtin_memcpy(m_data_buffer + m_data_length, message, copy_bytes);
         message += copy_bytes;
         length -= copy_bytes;
         m_data_length += copy_bytes;
-        if (m_data_length == BlockSize) {
-            transform(m_data_buffer);
-            m_bit_length += BlockSize * 8;
-            m_data_length = 0;
-        }
+        if (m_data_length < BlockSize)
+            return;
+        transform_blocks(m_data_buffer, 1);
+        m_bit_length += BlockSize * 8;
+        m_data_length = 0;
     }
+
+    // Hash the whole blocks straight from the message.
+    size_t block_count = length / BlockSize;
+    transform_blocks(message, block_count);
+    m_bit_length += block_count * BlockSize * 8;
+    message += block_count * BlockSize;
+    length -= block_count * BlockSize;
+
+    if (length > 0)
+        __builtin_memcpy(m_data_buffer, message, length);
+    m_data_length = length;
 }
 
 SHA1::DigestType SHA1::digest()
@@ -111,7 +212,7 @@ SHA1::DigestType SHA1::peek()
         m_data_buffer[i++] = 0x80;
         while (i < BlockSize)
             m_data_buffer[i++] = 0x00;
-        transform(m_data_buffer);
+        transform_blocks(m_data_buffer, 1);
 
         // Then start another block with BlockSize - 8 bytes of zeros
         __builtin_memset(m_data_buffer, 0, FinalBlockDataSize);
@@ -128,7 +229,7 @@ SHA1::DigestType SHA1::peek()
     m_data_buffer[BlockSize - 7] = m_bit_length >> 48;
     m_data_buffer[BlockSize - 8] = m_bit_length >> 56;
 
-    transform(m_data_buffer);
+    transform_blocks(m_data_buffer, 1);
 
     for (i = 0; i < 4; ++i) {
         digest.data[i + 0] = (m_state[0] >> (24 - i * 8)) & 0x000000ff;
@@ -5,9 +5,16 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Platform.h>
+#include <AK/StdLibExtras.h>
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA2.h>
 
+#if ARCH(X86_64) && !defined(KERNEL)
+#    include <LibCrypto/CPUFeatures.h>
+#    include <immintrin.h>
+#endif
+
 namespace Crypto::Hash {
 constexpr static auto ROTRIGHT(u32 a, size_t b) { return (a >> b) | (a << (32 - b)); }
 constexpr static auto CH(u32 x, u32 y, u32 z) { return (x & y) ^ (z & ~x); }
@@ -66,6 +73,92 @@ inline void SHA256::transform(u8 const* data)
     m_state[7] += h;
 }
 
+#if ARCH(X86_64) && !defined(KERNEL)
+
+static constexpr auto sha_ni_features = CPUFeatures::SHA | CPUFeatures::SSE41;
+
+struct SHA256NIState {
+    __m128i abef;
+    __m128i cdgh;
+    __m128i messages[4];
+};
+
+// Does rounds 4 * Group to 4 * Group + 3 with SHA-NI, where the messages hold the next 16 words of the message schedule.
+// Based on Intel's "Intel SHA Extensions" paper and its accompanying sample code.
+template<size_t Group>
+[[gnu::target("sha,sse4.1"), gnu::always_inline]] static inline void sha256_ni_four_rounds(SHA256NIState& state, u8 const* data)
+{
+    auto& message = state.messages[Group % 4];
+
+    if constexpr (Group < 4) {
+        auto const byte_swap_words = _mm_set_epi64x(0x0c0d0e0f08090a0b, 0x0405060700010203);
+        message = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data + Group * 16)), byte_swap_words);
+    }
+
+    auto words = _mm_add_epi32(message, _mm_loadu_si128(reinterpret_cast<__m128i const*>(&SHA256Constants::RoundConstants[Group * 4])));
+    state.cdgh = _mm_sha256rnds2_epu32(state.cdgh, state.abef, words);
+
+    if constexpr (Group >= 3 && Group <= 14) {
+        auto& next_message = state.messages[(Group + 1) % 4];
+        next_message = _mm_add_epi32(next_message, _mm_alignr_epi8(message, state.messages[(Group + 3) % 4], 4));
+        next_message = _mm_sha256msg2_epu32(next_message, message);
+    }
+
+    state.abef = _mm_sha256rnds2_epu32(state.abef, state.cdgh, _mm_shuffle_epi32(words, 0x0e));
+
+    if constexpr (Group >= 1 && Group <= 12)
+        state.messages[(Group + 3) % 4] = _mm_sha256msg1_epu32(state.messages[(Group + 3) % 4], message);
+}
+
+template<size_t... Groups>
+[[gnu::target("sha,sse4.1"), gnu::always_inline]] static inline void sha256_ni_rounds(SHA256NIState& state, u8 const* data, IndexSequence<Groups...>)
+{
+    (sha256_ni_four_rounds<Groups>(state, data), ...);
+}
+
+[[gnu::target("sha,sse4.1")]] static void sha256_ni_transform(u32 (&digest_state)[8], u8 const* data, size_t block_count)
+{
+    // The round instructions want the state words as ABEF and CDGH.
+    auto dcba = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&digest_state[0]));
+    auto hgfe = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&digest_state[4]));
+    auto cdab = _mm_shuffle_epi32(dcba, 0xb1);
+    auto efgh = _mm_shuffle_epi32(hgfe, 0x1b);
+
+    SHA256NIState state;
+    state.abef = _mm_alignr_epi8(cdab, efgh, 8);
+    state.cdgh = _mm_blend_epi16(efgh, cdab, 0xf0);
+
+    for (size_t i = 0; i < block_count; ++i, data += 64) {
+        auto saved_abef = state.abef;
+        auto saved_cdgh = state.cdgh;
+
+        sha256_ni_rounds(state, data, MakeIndexSequence<16> {});
+
+        state.abef = _mm_add_epi32(state.abef, saved_abef);
+        state.cdgh = _mm_add_epi32(state.cdgh, saved_cdgh);
+    }
+
+    auto feba = _mm_shuffle_epi32(state.abef, 0x1b);
+    auto dchg = _mm_shuffle_epi32(state.cdgh, 0xb1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&digest_state[0]), _mm_blend_epi16(feba, dchg, 0xf0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&digest_state[4]), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+#endif
+
+void SHA256::transform_blocks(u8 const* data, size_t block_count)
+{
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_cpu_features(sha_ni_features)) {
+        sha256_ni_transform(m_state, data, block_count);
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < block_count; ++i)
+        transform(data + i * BlockSize);
+}
+
 template<size_t BlockSize, typename Callback>
 void update_buffer(u8* buffer, u8 const* input, size_t length, size_t& data_length, Callback callback)
 {
@@ -84,10 +177,29 @@ void update_buffer(u8* buffer, u8 const* input, size_t length, size_t& data_leng
 
 void SHA256::update(u8 const* message, size_t length)
 {
-    update_buffer<BlockSize>(m_data_buffer, message, length, m_data_length, [&]() {
-        transform(m_data_buffer);
+    if (m_data_length > 0) {
+        size_t copy_bytes = AK::min(length, BlockSize - m_data_length);
+        __builtin_memcpy(m_data_buffer + m_data_length, message, copy_bytes);
+        message += copy_bytes;
+        length -= copy_bytes;
+        m_data_length += copy_bytes;
+        if (m_data_length < BlockSize)
+            return;
+        transform_blocks(m_data_buffer, 1);
         m_bit_length += BlockSize * 8;
-    });
+        m_data_length = 0;
+    }
+
+    // Hash the whole blocks straight from the message.
+    size_t block_count = length / BlockSize;
+    transform_blocks(message, block_count);
+    m_bit_length += block_count * BlockSize * 8;
+    message += block_count * BlockSize;
+    length -= block_count * BlockSize;
+
+    if (length > 0)
+        __builtin_memcpy(m_data_buffer, message, length);
+    m_data_length = length;
 }
 
 SHA256::DigestType SHA256::digest()
@@ -111,7 +223,7 @@ SHA256::DigestType SHA256::peek()
         m_data_buffer[i++] = 0x80;
         while (i < BlockSize)
             m_data_buffer[i++] = 0x00;
-        transform(m_data_buffer);
+        transform_blocks(m_data_buffer, 1);
 
         // Then start another block with BlockSize - 8 bytes of zeros
         __builtin_memset(m_data_buffer, 0, FinalBlockDataSize);
@@ -128,7 +240,7 @@ SHA256::DigestType SHA256::peek()
     m_data_buffer[BlockSize - 7] = m_bit_length >> 48;
     m_data_buffer[BlockSize - 8] = m_bit_length >> 56;
 
-    transform(m_data_buffer);
+    transform_blocks(m_data_buffer, 1);
 
     // SHA uses big-endian and we assume little-endian
     // FIXME: looks like a thing for AK::NetworkOrdered,
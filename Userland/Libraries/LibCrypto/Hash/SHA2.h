@@ -116,6 +116,7 @@ public:
 
 private:
     inline void transform(u8 const*);
+    void transform_blocks(u8 const*, size_t block_count);
 
     u8 m_data_buffer[BlockSize] {};
     size_t m_data_length { 0 };
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Random.h>
+#include <LibCrypto/Hash/HashManager.h>
+#include <LibCrypto/PK/Code/Code.h>
+
+namespace Crypto::PK {
+
+// https://www.rfc-editor.org/rfc/rfc8017#section-9.1
+// The salt is as long as the hash output, which is what TLS 1.3 requires (RFC 8446 section 4.2.3) and what most
+// signers use. MGF1 with the same hash function is the mask generation function.
+template<typename HashFunction>
+class EMSA_PSS : public Code<HashFunction> {
+public:
+    template<typename... Args>
+    EMSA_PSS(Args... args)
+        : Code<HashFunction>(args...)
+    {
+    }
+
+    // https://www.rfc-editor.org/rfc/rfc8017#section-9.1.1
+    virtual void encode(ReadonlyBytes in, ByteBuffer& out, size_t em_bits) override
+    {
+        auto& hash_fn = this->hasher();
+        auto h_len = hash_fn.digest_size();
+        auto s_len = h_len;
+        auto em_len = (em_bits + 7) / 8;
+
+        // 2. Let mHash = Hash(M), an octet string of length hLen.
+        hash_fn.update(in);
+        auto message_hash = hash_fn.digest();
+
+        // 3. If emLen < hLen + sLen + 2, output "encoding error" and stop.
+        if (em_len < h_len + s_len + 2) {
+            dbgln("EMSA-PSS-ENCODE: encoding error");
+            return;
+        }
+        if (out.try_resize(em_len).is_error()) {
+            dbgln("EMSA-PSS-ENCODE: out of memory");
+            return;
+        }
+
+        // 4. Generate a random octet string salt of length sLen.
+        // 8. Let DB = PS || 0x01 || salt, where PS consists of emLen - sLen - hLen - 2 zero octets.
+        auto db_length = em_len - h_len - 1;
+        auto db = out.bytes().trim(db_length);
+        db.fill(0);
+        db[db_length - s_len - 1] = 0x01;
+        auto salt = db.slice(db_length - s_len);
+        fill_with_random(salt);
+
+        // 5. Let M' = (0x)00 00 00 00 00 00 00 00 || mHash || salt.
+        // 6. Let H = Hash(M'), an octet string of length hLen.
+        auto h = out.bytes().slice(db_length, h_len);
+        hash_with_prefix({ message_hash.immutable_data(), h_len }, salt, h);
+
+        // 9. Let dbMask = MGF(H, emLen - hLen - 1).
+        // 10. Let maskedDB = DB \xor dbMask.
+        apply_mask(h, db);
+
+        // 11. Set the leftmost 8emLen - emBits bits of the leftmost octet in maskedDB to zero.
+        db[0] &= 0xff >> (8 * em_len - em_bits);
+
+        // 12. Let EM = maskedDB || H || 0xbc.
+        out[em_len - 1] = 0xbc;
+    }
+
+    // https://www.rfc-editor.org/rfc/rfc8017#section-9.1.2
+    virtual VerificationConsistency verify(ReadonlyBytes msg, ReadonlyBytes emsg, size_t em_bits) override
+    {
+        auto& hash_fn = this->hasher();
+        auto h_len = hash_fn.digest_size();
+        auto s_len = h_len;
+        auto em_len = (em_bits + 7) / 8;
+
+        // Note: The caller may hand us the encoded message with leading zeros (e.g. as long as the modulus) or without
+        //       them, so bring it to exactly emLen octets first.
+        Vector<u8, 512> em;
+        if (emsg.size() > em_len) {
+            for (auto byte : emsg.trim(emsg.size() - em_len)) {
+                if (byte != 0)
+                    return VerificationConsistency::Inconsistent;
+            }
+            emsg = emsg.slice(emsg.size() - em_len);
+        }
+        if (em.try_resize(em_len - emsg.size()).is_error() || em.try_append(emsg.data(), emsg.size()).is_error())
+            return VerificationConsistency::Inconsistent;
+
+        // 2. Let mHash = Hash(M), an octet string of length hLen.
+        hash_fn.update(msg);
+        auto message_hash = hash_fn.digest();
+
+        // 3. If emLen < hLen + sLen + 2, output "inconsistent" and stop.
+        if (em_len < h_len + s_len + 2)
+            return VerificationConsistency::Inconsistent;
+
+        // 4. If the rightmost octet of EM does not have hexadecimal value 0xbc, output "inconsistent" and stop.
+        if (em[em_len - 1] != 0xbc)
+            return VerificationConsistency::Inconsistent;
+
+        // 5. Let maskedDB be the leftmost emLen - hLen - 1 octets of EM, and let H be the next hLen octets.
+        auto db_length = em_len - h_len - 1;
+        auto db = em.span().trim(db_length);
+        auto h = em.span().slice(db_length, h_len);
+
+        // 6. If the leftmost 8emLen - emBits bits of the leftmost octet in maskedDB are not all equal to zero, output
+        //    "inconsistent" and stop.
+        u8 unused_bits_mask = ~(0xff >> (8 * em_len - em_bits));
+        if (db[0] & unused_bits_mask)
+            return VerificationConsistency::Inconsistent;
+
+        // 7. Let dbMask = MGF(H, emLen - hLen - 1).
+        // 8. Let DB = maskedDB \xor dbMask.
+        apply_mask(h, db);
+
+        // 9. Set the leftmost 8emLen - emBits bits of the leftmost octet in DB to zero.
+        db[0] &= ~unused_bits_mask;
+
+        // 10. If the emLen - hLen - sLen - 2 leftmost octets of DB are not zero or if the octet at position
+        //     emLen - hLen - sLen - 1 (the leftmost position is "position 1") does not have hexadecimal value 0x01,
+        //     output "inconsistent" and stop.
+        auto padding_length = em_len - h_len - s_len - 2;
+        for (size_t i = 0; i < padding_length; ++i) {
+            if (db[i] != 0)
+                return VerificationConsistency::Inconsistent;
+        }
+        if (db[padding_length] != 0x01)
+            return VerificationConsistency::Inconsistent;
+
+        // 11. Let salt be the last sLen octets of DB.
+        auto salt = db.slice(db_length - s_len);
+
+        // 12. Let M' = (0x)00 00 00 00 00 00 00 00 || mHash || salt.
+        // 13. Let H' = Hash(M'), an octet string of length hLen.
+        u8 h_prime[64];
+        VERIFY(h_len <= sizeof(h_prime));
+        hash_with_prefix({ message_hash.immutable_data(), h_len }, salt, { h_prime, h_len });
+
+        // 14. If H = H', output "consistent". Otherwise, output "inconsistent".
+        if (h != ReadonlyBytes { h_prime, h_len })
+            return VerificationConsistency::Inconsistent;
+        return VerificationConsistency::Consistent;
+    }
+
+private:
+    void hash_with_prefix(ReadonlyBytes message_hash, ReadonlyBytes salt, Bytes out)
+    {
+        auto& hash_fn = this->hasher();
+        u8 zeros[8] {};
+        hash_fn.update(zeros, sizeof(zeros));
+        hash_fn.update(message_hash);
+        hash_fn.update(salt);
+        auto digest = hash_fn.digest();
+        out.overwrite(0, digest.immutable_data(), out.size());
+    }
+
+    // XORs MGF1(seed, data.size()) into data, see https://www.rfc-editor.org/rfc/rfc8017#appendix-B.2.1
+    void apply_mask(ReadonlyBytes seed, Bytes data)
+    {
+        auto& hash_fn = this->hasher();
+        auto h_len = hash_fn.digest_size();
+        for (u32 counter = 0; counter * h_len < data.size(); ++counter) {
+            auto counter_bytes = AK::convert_between_host_and_big_endian(counter);
+            hash_fn.update(seed);
+            hash_fn.update(reinterpret_cast<u8 const*>(&counter_bytes), sizeof(counter_bytes));
+            auto digest = hash_fn.digest();
+
+            auto offset = counter * h_len;
+            for (size_t i = 0; i < h_len && offset + i < data.size(); ++i)
+                data[offset + i] ^= digest.immutable_data()[i];
+        }
+    }
+};
+
+}
@@ -720,6 +720,8 @@ static ErrorOr<NonnullRefPtr<Gfx::Bitmap>> render_thumbnail(StringView path)
 
         // FIXME: Refactor thumbnail rendering to be more async-aware. Possibly return this promise to the caller.
         auto decoded_image = TRY(maybe_client->decode_image(file->bytes(), {}, {}, thumbnail_size, mime_type)->await());
+        // Thumbnails only show the first frame of animated images.
+        maybe_client->release_image(decoded_image.image_id);
 
         return decoded_image;
     }));
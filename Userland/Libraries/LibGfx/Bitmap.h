@@ -7,9 +7,9 @@
 
 #pragma once
 
+#include <AK/AtomicRefCounted.h>
 #include <AK/Forward.h>
 #include <AK/Function.h>
-#include <AK/RefCounted.h>
 #include <LibCore/AnonymousBuffer.h>
 #include <LibCore/Forward.h>
 #include <LibGfx/Color.h>
@@ -94,7 +94,8 @@ enum class RotationDirection {
     Clockwise,
 };
 
-class Bitmap : public RefCounted<Bitmap> {
+// NOTE: Bitmaps are reference counted atomically, as some (like the pages of the GlyphAtlas) are shared between threads.
+class Bitmap : public AtomicRefCounted<Bitmap> {
 public:
     [[nodiscard]] static ErrorOr<NonnullRefPtr<Bitmap>> create(BitmapFormat, IntSize, int intrinsic_scale = 1);
     [[nodiscard]] static ErrorOr<NonnullRefPtr<Bitmap>> create_shareable(BitmapFormat, IntSize, int intrinsic_scale = 1);
@@ -7,9 +7,11 @@
 #include <AK/Array.h>
 #include <AK/Debug.h>
 #include <AK/IntegralMath.h>
+#include <AK/SIMD.h>
 #include <AK/Types.h>
 #include <LibGfx/AntiAliasingPainter.h>
 #include <LibGfx/EdgeFlagPathRasterizer.h>
+#include <LibGfx/ScanlineKernels.h>
 
 #if defined(AK_COMPILER_GCC)
 #    pragma GCC optimize("O3")
@@ -305,44 +307,87 @@ __attribute__((hot)) Detail::Edge* EdgeFlagPathRasterizer<SamplesPerPixel>::plot
     return active_edges;
 }
 
+// Returns the index of the first non-zero cell in [start, end], or end + 1 if there is none. Most cells of a scanline are
+// empty (they're only set where edges cross), so this skips over the runs between edges 16 bytes at a time.
+template<typename T>
+ALWAYS_INLINE static int find_next_occupied_cell(T const* cells, int start, int end)
+{
+    constexpr int cells_per_vector = sizeof(AK::SIMD::u8x16) / sizeof(T);
+    int x = start;
+    // Runs are often short, so check the first cell before starting on whole vectors.
+    if (x <= end && cells[x])
+        return x;
+    for (; x + cells_per_vector <= end + 1; x += cells_per_vector) {
+        AK::SIMD::u64x2 vector;
+        __builtin_memcpy(&vector, cells + x, sizeof(vector));
+        if (vector[0] | vector[1])
+            break;
+    }
+    for (; x <= end; x++) {
+        if (cells[x])
+            return x;
+    }
+    return end + 1;
+}
+
 template<unsigned SamplesPerPixel>
-auto EdgeFlagPathRasterizer<SamplesPerPixel>::accumulate_even_odd_scanline(EdgeExtent edge_extent, auto init, auto sample_callback)
+auto EdgeFlagPathRasterizer<SamplesPerPixel>::accumulate_even_odd_scanline(EdgeExtent edge_extent, auto init, auto span_callback)
 {
     SampleType sample = init;
     VERIFY(edge_extent.min_x >= 0);
     VERIFY(edge_extent.max_x < static_cast<int>(m_scanline.size()));
-    for (int x = edge_extent.min_x; x <= edge_extent.max_x; x += 1) {
-        sample ^= m_scanline.data()[x];
-        sample_callback(x, sample);
-        m_scanline.data()[x] = 0;
+    auto* cells = m_scanline.data();
+    for (int x = edge_extent.min_x; x <= edge_extent.max_x;) {
+        sample ^= cells[x];
+        cells[x] = 0;
+        // The sample stays the same until the next cell an edge crossed.
+        auto next_x = find_next_occupied_cell(cells, x + 1, edge_extent.max_x);
+        span_callback(x, next_x - 1, sample);
+        x = next_x;
+    }
+    return sample;
+}
+
+// Packs the lanes of a comparison result (where each lane is either 0 or -1) into a sample, with one bit per lane.
+template<typename SampleType, typename Lanes>
+ALWAYS_INLINE static SampleType lanes_to_sample(Lanes lanes)
+{
+    SampleType sample = 0;
+    for (size_t i = 0; i < sizeof(Lanes) / sizeof(u64); i++) {
+        u64 chunk;
+        __builtin_memcpy(&chunk, reinterpret_cast<u8 const*>(&lanes) + i * sizeof(u64), sizeof(u64));
+        // Keep bit n of byte n, then sum all the bytes into the top byte.
+        chunk &= 0x8040201008040201;
+        sample |= static_cast<SampleType>((chunk * 0x0101010101010101) >> 56) << (i * 8);
     }
     return sample;
 }
 
 template<unsigned SamplesPerPixel>
-auto EdgeFlagPathRasterizer<SamplesPerPixel>::accumulate_non_zero_scanline(EdgeExtent edge_extent, auto init, auto sample_callback)
+auto EdgeFlagPathRasterizer<SamplesPerPixel>::accumulate_non_zero_scanline(EdgeExtent edge_extent, auto init, auto span_callback)
 {
     NonZeroAcc acc = init;
     VERIFY(edge_extent.min_x >= 0);
     VERIFY(edge_extent.max_x < static_cast<int>(m_scanline.size()));
-    for (int x = edge_extent.min_x; x <= edge_extent.max_x; x += 1) {
-        if (auto edges = m_scanline.data()[x]) {
-            // We only need to process the windings when we hit some edges.
-            for (auto y_sub = 0u; y_sub < SamplesPerPixel; y_sub++) {
-                auto subpixel_bit = 1 << y_sub;
-                if (edges & subpixel_bit) {
-                    auto winding = m_windings.data()[x].counts[y_sub];
-                    auto previous_winding_count = acc.winding.counts[y_sub];
-                    acc.winding.counts[y_sub] += winding;
-                    // Toggle fill on change to/from zero.
-                    if (bool(previous_winding_count) ^ bool(acc.winding.counts[y_sub]))
-                        acc.sample ^= subpixel_bit;
-                }
-            }
+    auto* cells = m_scanline.data();
+    for (int x = edge_extent.min_x; x <= edge_extent.max_x;) {
+        if (cells[x]) {
+            // We only need to process the windings when we hit some edges. Since windings are only plotted alongside
+            // their edge flags, the counts of all other subpixels are zero, so they can all be added at once.
+            WindingVector previous_winding_counts;
+            WindingVector winding_counts;
+            __builtin_memcpy(&previous_winding_counts, acc.winding.counts, sizeof(WindingVector));
+            __builtin_memcpy(&winding_counts, m_windings.data()[x].counts, sizeof(WindingVector));
+            winding_counts += previous_winding_counts;
+            __builtin_memcpy(acc.winding.counts, &winding_counts, sizeof(WindingVector));
+            // Toggle fill on change to/from zero.
+            acc.sample ^= lanes_to_sample<SampleType>((previous_winding_counts == 0) != (winding_counts == 0));
+            cells[x] = 0;
+            m_windings.data()[x] = {};
         }
-        sample_callback(x, acc.sample);
-        m_scanline.data()[x] = 0;
-        m_windings.data()[x] = {};
+        auto next_x = find_next_occupied_cell(cells, x + 1, edge_extent.max_x);
+        span_callback(x, next_x - 1, acc.sample);
+        x = next_x;
     }
     return acc;
 }
@@ -358,14 +403,29 @@ auto EdgeFlagPathRasterizer<SamplesPerPixel>::accumulate_scanline(EdgeExtent edg
 }
 
 template<unsigned SamplesPerPixel>
-void EdgeFlagPathRasterizer<SamplesPerPixel>::write_pixel(BitmapFormat format, ARGB32* scanline_ptr, int scanline, int offset, SampleType sample, auto& color_or_function)
+void EdgeFlagPathRasterizer<SamplesPerPixel>::write_span(BitmapFormat format, ARGB32* scanline_ptr, int scanline, int start, int end, SampleType sample, auto& color_or_function)
 {
     if (!sample)
         return;
-    auto dest_x = offset + m_blit_origin.x();
-    auto coverage = SubpixelSample::compute_coverage(sample);
-    auto paint_color = scanline_color(scanline, offset, coverage_to_alpha(coverage), color_or_function);
-    scanline_ptr[dest_x] = color_for_format(format, scanline_ptr[dest_x]).blend(paint_color).value();
+    auto alpha = coverage_to_alpha(SubpixelSample::compute_coverage(sample));
+    auto* span_ptr = scanline_ptr + start + m_blit_origin.x();
+    switch_on_color_or_function(
+        color_or_function,
+        [&](Color color) {
+            // The coverage (and so the color) is the same across the whole span, so blend it in one go. Spans next to
+            // edges are usually a single pixel wide though, and those are cheaper to blend directly.
+            auto paint_color = scanline_color(scanline, start, alpha, color);
+            if (start == end)
+                *span_ptr = color_for_format(format, *span_ptr).blend(paint_color).value();
+            else
+                blend_color_over_scanline(span_ptr, end - start + 1, paint_color, format == BitmapFormat::BGRA8888);
+        },
+        [&](auto& function) {
+            for (int x = start; x <= end; x++) {
+                auto paint_color = scanline_color(scanline, x, alpha, function);
+                span_ptr[x - start] = color_for_format(format, span_ptr[x - start]).blend(paint_color).value();
+            }
+        });
 }
 
 template<unsigned SamplesPerPixel>
@@ -392,7 +452,7 @@ FLATTEN __attribute__((hot)) void EdgeFlagPathRasterizer<SamplesPerPixel>::write
     }
 
     // Accumulate non-visible section (without plotting pixels).
-    auto acc = accumulate_scanline<WindingRule>(EdgeExtent { edge_extent.min_x, left_clip - 1 }, initial_acc<WindingRule>(), [](int, SampleType) {
+    auto acc = accumulate_scanline<WindingRule>(EdgeExtent { edge_extent.min_x, left_clip - 1 }, initial_acc<WindingRule>(), [](int, int, SampleType) {
         // Do nothing!
     });
 
@@ -400,37 +460,28 @@ FLATTEN __attribute__((hot)) void EdgeFlagPathRasterizer<SamplesPerPixel>::write
     auto dest_format = painter.target()->format();
     auto dest_ptr = painter.target()->scanline(scanline + m_blit_origin.y());
 
-    // Simple case: Handle each pixel individually.
+    // Simple case: Handle each span of constant coverage individually.
     // Used for PaintStyle fills and semi-transparent colors.
-    auto write_scanline_pixelwise = [&](auto& color_or_function) {
-        accumulate_scanline<WindingRule>(clipped_extent, acc, [&](int x, SampleType sample) {
-            write_pixel(dest_format, dest_ptr, scanline, x, sample, color_or_function);
+    auto write_scanline_spanwise = [&](auto& color_or_function) {
+        accumulate_scanline<WindingRule>(clipped_extent, acc, [&](int start, int end, SampleType sample) {
+            write_span(dest_format, dest_ptr, scanline, start, end, sample, color_or_function);
         });
     };
-    // Fast fill case: Track spans of solid color and set the entire span via a fast_u32_fill().
+    // Fast fill case: Set spans of full coverage via a fast_u32_fill().
     // Used for opaque colors (i.e. alpha == 255).
     auto write_scanline_with_fast_fills = [&](Color color) {
         if (color.alpha() != 255)
-            return write_scanline_pixelwise(color);
+            return write_scanline_spanwise(color);
         constexpr SampleType full_converage = NumericLimits<SampleType>::max();
-        int full_converage_count = 0;
-        accumulate_scanline<WindingRule>(clipped_extent, acc, [&](int x, SampleType sample) {
-            if (sample == full_converage) {
-                full_converage_count++;
-                return;
-            } else {
-                write_pixel(dest_format, dest_ptr, scanline, x, sample, color);
-            }
-            if (full_converage_count > 0) {
-                fast_fill_solid_color_span(dest_ptr, x - full_converage_count, x - 1, color);
-                full_converage_count = 0;
-            }
+        accumulate_scanline<WindingRule>(clipped_extent, acc, [&](int start, int end, SampleType sample) {
+            if (sample == full_converage)
+                fast_fill_solid_color_span(dest_ptr, start, end, color);
+            else
+                write_span(dest_format, dest_ptr, scanline, start, end, sample, color);
         });
-        if (full_converage_count > 0)
-            fast_fill_solid_color_span(dest_ptr, clipped_extent.max_x - full_converage_count + 1, clipped_extent.max_x, color);
     };
     switch_on_color_or_function(
-        color_or_function, write_scanline_with_fast_fills, write_scanline_pixelwise);
+        color_or_function, write_scanline_with_fast_fills, write_scanline_spanwise);
 }
 
 static IntSize path_bounds(Gfx::Path const& path)
@@ -8,6 +8,8 @@
 
 #include <AK/Array.h>
 #include <AK/GenericShorthands.h>
+#include <AK/IntegralMath.h>
+#include <AK/SIMD.h>
 #include <AK/Vector.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/PaintStyle.h>
@@ -178,13 +180,16 @@ private:
     template<Painter::WindingRule>
     FLATTEN void write_scanline(Painter&, int scanline, EdgeExtent, auto& color_or_function);
     Color scanline_color(int scanline, int offset, u8 alpha, auto& color_or_function);
-    void write_pixel(BitmapFormat format, ARGB32* scanline_ptr, int scanline, int offset, SampleType sample, auto& color_or_function);
+    void write_span(BitmapFormat format, ARGB32* scanline_ptr, int scanline, int start, int end, SampleType sample, auto& color_or_function);
     void fast_fill_solid_color_span(ARGB32* scanline_ptr, int start, int end, Color color);
 
     template<Painter::WindingRule, typename Callback>
     auto accumulate_scanline(EdgeExtent, auto, Callback);
-    auto accumulate_even_odd_scanline(EdgeExtent, auto, auto sample_callback);
-    auto accumulate_non_zero_scanline(EdgeExtent, auto, auto sample_callback);
+    // These call `span_callback(start, end, sample)` for each run of pixels [start, end] that has the same sample.
+    auto accumulate_even_odd_scanline(EdgeExtent, auto, auto span_callback);
+    auto accumulate_non_zero_scanline(EdgeExtent, auto, auto span_callback);
+
+    using WindingVector = Conditional<SamplesPerPixel == 8, AK::SIMD::i8x8, Conditional<SamplesPerPixel == 16, AK::SIMD::i8x16, AK::SIMD::i8x32>>;
 
     struct WindingCounts {
         // NOTE: This only allows up to 256 winding levels. Increase this if required (i.e. to an i16).
@@ -64,6 +64,7 @@ public:
 
     Glyph(RefPtr<Bitmap> bitmap, float left_bearing, float advance, float ascent, bool is_color_bitmap)
         : m_bitmap(bitmap)
+        , m_bitmap_rect(bitmap ? bitmap->rect() : IntRect {})
         , m_left_bearing(left_bearing)
         , m_advance(advance)
         , m_ascent(ascent)
@@ -71,11 +72,23 @@ public:
     {
     }
 
+    // A glyph that only occupies part of a (shared) bitmap, like the pages of the GlyphAtlas.
+    Glyph(NonnullRefPtr<Bitmap> bitmap, IntRect bitmap_rect, float left_bearing, float advance, float ascent)
+        : m_bitmap(move(bitmap))
+        , m_bitmap_rect(bitmap_rect)
+        , m_left_bearing(left_bearing)
+        , m_advance(advance)
+        , m_ascent(ascent)
+    {
+    }
+
     bool is_color_bitmap() const { return m_color_bitmap; }
 
     bool is_glyph_bitmap() const { return !m_bitmap; }
     GlyphBitmap glyph_bitmap() const { return m_glyph_bitmap; }
     RefPtr<Bitmap> bitmap() const { return m_bitmap; }
+    // The part of bitmap() that the glyph occupies.
+    IntRect bitmap_rect() const { return m_bitmap_rect; }
     float left_bearing() const { return m_left_bearing; }
     float advance() const { return m_advance; }
     float ascent() const { return m_ascent; }
@@ -83,6 +96,7 @@ public:
 private:
     GlyphBitmap m_glyph_bitmap;
     RefPtr<Bitmap> m_bitmap;
+    IntRect m_bitmap_rect;
     float m_left_bearing;
     float m_advance;
     float m_ascent;
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGfx/Font/GlyphAtlas.h>
+
+namespace Gfx {
+
+// Shelf heights are rounded up to this, so that glyphs of similar heights share shelves.
+static constexpr int shelf_height_granularity = 4;
+
+GlyphAtlas& GlyphAtlas::the()
+{
+    // NOTE: This is intentionally leaked, as fonts may still be destroyed during static destruction.
+    static auto* s_the = new GlyphAtlas;
+    return *s_the;
+}
+
+GlyphAtlas::GlyphAtlas(IntSize page_size, size_t max_page_count, size_t max_unpacked_glyph_count)
+    : m_page_size(page_size)
+    , m_max_page_count(max_page_count)
+    , m_max_unpacked_glyph_count(max_unpacked_glyph_count)
+    , m_max_unpacked_glyph_bytes(page_size.width() * page_size.height() * sizeof(ARGB32))
+{
+    VERIFY(m_max_page_count > 0);
+    VERIFY(m_max_unpacked_glyph_count > 0);
+}
+
+GlyphAtlas::~GlyphAtlas() = default;
+
+Optional<GlyphAtlas::Entry> GlyphAtlas::find_or_rasterize(Key const& key, Function<RefPtr<Bitmap>()> const& rasterize)
+{
+    auto entry_for = [&](Location const& location) {
+        location.page->last_used = ++m_use_counter;
+        return Entry { location.page->bitmap, location.rect };
+    };
+
+    {
+        Threading::MutexLocker locker(m_mutex);
+        if (auto location = m_glyphs.get(key); location.has_value())
+            return entry_for(*location);
+        if (m_unpacked_glyphs.contains(key))
+            return use_unpacked_glyph(key);
+    }
+
+    // Rasterizing is by far the slowest part, so don't block other threads while doing it.
+    auto bitmap = rasterize();
+
+    Threading::MutexLocker locker(m_mutex);
+    // Another thread may have added the same glyph in the meantime.
+    if (auto location = m_glyphs.get(key); location.has_value())
+        return entry_for(*location);
+    if (m_unpacked_glyphs.contains(key))
+        return use_unpacked_glyph(key);
+
+    // Glyphs that don't fit onto a page at all (or can't be packed for some other reason) are kept as they are.
+    auto add_unpacked = [&]() -> Optional<Entry> {
+        add_unpacked_glyph(key, bitmap);
+        if (!bitmap)
+            return {};
+        auto rect = bitmap->rect();
+        return Entry { bitmap.release_nonnull(), rect };
+    };
+    if (!bitmap || bitmap->format() != BitmapFormat::BGRA8888 || bitmap->width() > m_page_size.width() || bitmap->height() > m_page_size.height())
+        return add_unpacked();
+    auto maybe_location = allocate(bitmap->size());
+    if (maybe_location.is_error())
+        return add_unpacked();
+    auto location = maybe_location.release_value();
+
+    auto& page_bitmap = location.page->bitmap;
+    for (int y = 0; y < bitmap->height(); ++y)
+        memcpy(page_bitmap->scanline(location.rect.y() + y) + location.rect.x(), bitmap->scanline(y), bitmap->width() * sizeof(ARGB32));
+
+    location.page->keys.append(key);
+    m_glyphs.set(key, location);
+    return entry_for(location);
+}
+
+Optional<IntRect> GlyphAtlas::allocate_in_page(Page& page, IntSize size)
+{
+    auto shelf_height = round_up_to_power_of_two(size.height(), shelf_height_granularity);
+    for (auto& shelf : page.shelves) {
+        if (shelf.height != shelf_height || shelf.used_width + size.width() > m_page_size.width())
+            continue;
+        IntRect rect { shelf.used_width, shelf.y, size.width(), size.height() };
+        shelf.used_width += size.width();
+        return rect;
+    }
+
+    auto shelf_y = page.shelves.is_empty() ? 0 : page.shelves.last().y + page.shelves.last().height;
+    if (shelf_y + shelf_height > m_page_size.height())
+        return {};
+    page.shelves.append({ .y = shelf_y, .height = shelf_height, .used_width = size.width() });
+    return IntRect { 0, shelf_y, size.width(), size.height() };
+}
+
+ErrorOr<GlyphAtlas::Location> GlyphAtlas::allocate(IntSize size)
+{
+    for (auto& page : m_pages) {
+        if (auto rect = allocate_in_page(*page, size); rect.has_value())
+            return Location { page.ptr(), *rect };
+    }
+
+    Page* page = nullptr;
+    if (m_pages.size() < m_max_page_count) {
+        // NOTE: Pages are zero-filled on allocation, so only the shelves that are actually used take up memory.
+        auto bitmap = TRY(Bitmap::create(BitmapFormat::BGRA8888, m_page_size));
+        TRY(m_pages.try_append(TRY(adopt_nonnull_own_or_enomem(new (nothrow) Page { .bitmap = move(bitmap), .shelves = {}, .keys = {}, .last_used = 0 }))));
+        page = m_pages.last().ptr();
+    } else {
+        auto least_recently_used = m_pages.first().ptr();
+        for (auto& candidate : m_pages) {
+            if (candidate->last_used < least_recently_used->last_used)
+                least_recently_used = candidate.ptr();
+        }
+        page = least_recently_used;
+        // Glyphs that were handed out still refer to the old bitmap, so the page only gets a fresh one (and is emptied)
+        // once that could be allocated.
+        auto bitmap = TRY(Bitmap::create(BitmapFormat::BGRA8888, m_page_size));
+        evict_page(*page);
+        page->bitmap = move(bitmap);
+    }
+
+    auto rect = allocate_in_page(*page, size);
+    VERIFY(rect.has_value());
+    return Location { page, *rect };
+}
+
+void GlyphAtlas::evict_page(Page& page)
+{
+    for (auto const& key : page.keys)
+        m_glyphs.remove(key);
+    page.keys.clear();
+    page.shelves.clear();
+}
+
+Optional<GlyphAtlas::Entry> GlyphAtlas::use_unpacked_glyph(Key const& key)
+{
+    // Moving the glyph to the end keeps the glyphs ordered from least to most recently used.
+    auto bitmap = m_unpacked_glyphs.take(key).release_value();
+    m_unpacked_glyphs.set(key, bitmap);
+    if (!bitmap)
+        return {};
+    auto rect = bitmap->rect();
+    return Entry { bitmap.release_nonnull(), rect };
+}
+
+void GlyphAtlas::add_unpacked_glyph(Key const& key, RefPtr<Bitmap> bitmap)
+{
+    auto bytes = bitmap ? bitmap->size_in_bytes() : 0;
+    // A glyph that takes up more memory than all unpacked glyphs together may is handed out, but not kept.
+    if (bytes > m_max_unpacked_glyph_bytes)
+        return;
+
+    while (!m_unpacked_glyphs.is_empty() && (m_unpacked_glyphs.size() >= m_max_unpacked_glyph_count || m_unpacked_glyph_bytes + bytes > m_max_unpacked_glyph_bytes))
+        remove_unpacked_glyph(m_unpacked_glyphs.begin()->key);
+
+    m_unpacked_glyphs.set(key, move(bitmap));
+    m_unpacked_glyph_bytes += bytes;
+}
+
+void GlyphAtlas::remove_unpacked_glyph(Key const& key)
+{
+    auto bitmap = m_unpacked_glyphs.take(key);
+    VERIFY(bitmap.has_value());
+    if (*bitmap)
+        m_unpacked_glyph_bytes -= (*bitmap)->size_in_bytes();
+}
+
+void GlyphAtlas::evict_typeface(VectorFont const& typeface)
+{
+    Threading::MutexLocker locker(m_mutex);
+    // NOTE: The space these glyphs took up is only reclaimed once their page is evicted.
+    m_glyphs.remove_all_matching([&](auto const& key, auto const&) { return key.typeface == &typeface; });
+    for (auto& page : m_pages)
+        page->keys.remove_all_matching([&](auto const& key) { return key.typeface == &typeface; });
+
+    Vector<Key> unpacked_glyphs_of_typeface;
+    for (auto const& it : m_unpacked_glyphs) {
+        if (it.key.typeface == &typeface)
+            unpacked_glyphs_of_typeface.append(it.key);
+    }
+    for (auto const& key : unpacked_glyphs_of_typeface)
+        remove_unpacked_glyph(key);
+}
+
+size_t GlyphAtlas::glyph_count() const
+{
+    Threading::MutexLocker locker(m_mutex);
+    return m_glyphs.size() + m_unpacked_glyphs.size();
+}
+
+size_t GlyphAtlas::page_count() const
+{
+    Threading::MutexLocker locker(m_mutex);
+    return m_pages.size();
+}
+
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/Noncopyable.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Font/Font.h>
+#include <LibGfx/Rect.h>
+#include <LibThreading/Mutex.h>
+
+namespace Gfx {
+
+class VectorFont;
+
+// A process-wide cache of rasterized glyphs, shared by every ScaledFont and safe to use from several threads.
+//
+// Glyphs are packed into large page bitmaps, in rows ("shelves") of similar height. When all pages are full, the least
+// recently used page is evicted as a whole, so that freed space never fragments. Evicted pages are never drawn into
+// again, as glyphs handed out earlier may still reference them.
+//
+// Glyphs that can't be packed (e.g. because they are larger than a page), as well as glyphs without a bitmap, are kept
+// on their own. They are evicted one by one in least recently used order, once there are too many of them or their
+// bitmaps take up more memory than a page.
+class GlyphAtlas {
+    AK_MAKE_NONCOPYABLE(GlyphAtlas);
+    AK_MAKE_NONMOVABLE(GlyphAtlas);
+
+public:
+    static constexpr IntSize default_page_size { 1024, 1024 };
+    static constexpr size_t default_max_page_count = 8;
+    static constexpr size_t default_max_unpacked_glyph_count = 4096;
+
+    struct Key {
+        VectorFont const* typeface { nullptr };
+        float x_scale { 0 };
+        float y_scale { 0 };
+        u32 glyph_id { 0 };
+        GlyphSubpixelOffset subpixel_offset { 0, 0 };
+
+        bool operator==(Key const&) const = default;
+    };
+
+    struct Entry {
+        NonnullRefPtr<Bitmap> bitmap;
+        IntRect rect;
+    };
+
+    static GlyphAtlas& the();
+
+    explicit GlyphAtlas(IntSize page_size = default_page_size, size_t max_page_count = default_max_page_count, size_t max_unpacked_glyph_count = default_max_unpacked_glyph_count);
+    ~GlyphAtlas();
+
+    // Returns the glyph for `key`, calling `rasterize` to create it if it isn't in the atlas yet. Glyphs without a
+    // bitmap are remembered too, and yield an empty Optional.
+    // NOTE: `rasterize` is called without holding the atlas lock, and may be called by several threads at once.
+    Optional<Entry> find_or_rasterize(Key const&, Function<RefPtr<Bitmap>()> const& rasterize);
+
+    // Forgets all glyphs of a typeface, e.g. because it is being destroyed.
+    void evict_typeface(VectorFont const&);
+
+    size_t glyph_count() const;
+    size_t page_count() const;
+
+private:
+    struct Shelf {
+        int y { 0 };
+        int height { 0 };
+        int used_width { 0 };
+    };
+
+    struct Page {
+        NonnullRefPtr<Bitmap> bitmap;
+        Vector<Shelf> shelves;
+        Vector<Key> keys;
+        u64 last_used { 0 };
+    };
+
+    struct Location {
+        Page* page { nullptr };
+        IntRect rect;
+    };
+
+    Optional<IntRect> allocate_in_page(Page&, IntSize);
+    ErrorOr<Location> allocate(IntSize);
+    void evict_page(Page&);
+
+    Optional<Entry> use_unpacked_glyph(Key const&);
+    void add_unpacked_glyph(Key const&, RefPtr<Bitmap>);
+    void remove_unpacked_glyph(Key const&);
+
+    IntSize m_page_size;
+    size_t m_max_page_count { 0 };
+    size_t m_max_unpacked_glyph_count { 0 };
+    size_t m_max_unpacked_glyph_bytes { 0 };
+
+    mutable Threading::Mutex m_mutex;
+    Vector<NonnullOwnPtr<Page>> m_pages;
+    HashMap<Key, Location> m_glyphs;
+    u64 m_use_counter { 0 };
+
+    // Glyphs that aren't packed into a page, ordered from least to most recently used. A null bitmap means that the
+    // glyph has no bitmap.
+    OrderedHashMap<Key, RefPtr<Bitmap>> m_unpacked_glyphs;
+    size_t m_unpacked_glyph_bytes { 0 };
+};
+
+}
+
+namespace AK {
+
+template<>
+struct Traits<Gfx::GlyphAtlas::Key> : public DefaultTraits<Gfx::GlyphAtlas::Key> {
+    static unsigned hash(Gfx::GlyphAtlas::Key const& key)
+    {
+        auto hash = pair_int_hash(ptr_hash(key.typeface), key.glyph_id);
+        hash = pair_int_hash(hash, pair_int_hash(bit_cast<u32>(key.x_scale), bit_cast<u32>(key.y_scale)));
+        return pair_int_hash(hash, (key.subpixel_offset.x << 8) | key.subpixel_offset.y);
+    }
+};
+
+}
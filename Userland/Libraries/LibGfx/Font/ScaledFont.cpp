@@ -7,6 +7,7 @@
 #include <AK/Utf32View.h>
 #include <AK/Utf8View.h>
 #include <LibGfx/Font/Emoji.h>
+#include <LibGfx/Font/GlyphAtlas.h>
 #include <LibGfx/Font/ScaledFont.h>
 
 namespace Gfx {
@@ -107,9 +108,20 @@ Gfx::Glyph ScaledFont::glyph(u32 code_point) const
 Gfx::Glyph ScaledFont::glyph(u32 code_point, GlyphSubpixelOffset subpixel_offset) const
 {
     auto id = glyph_id_for_code_point(code_point);
-    auto bitmap = rasterize_glyph(id, subpixel_offset);
     auto metrics = glyph_metrics(id);
-    return Gfx::Glyph(bitmap, metrics.left_side_bearing, metrics.advance_width, metrics.ascender, m_font->has_color_bitmaps());
+    if (m_font->has_color_bitmaps()) {
+        auto bitmap = rasterize_glyph(id, subpixel_offset);
+        return Gfx::Glyph(bitmap, metrics.left_side_bearing, metrics.advance_width, metrics.ascender, true);
+    }
+
+    // Coverage masks are shared with all other fonts through the glyph atlas.
+    GlyphAtlas::Key key { m_font.ptr(), m_x_scale, m_y_scale, id, subpixel_offset };
+    auto entry = GlyphAtlas::the().find_or_rasterize(key, [&] {
+        return m_font->rasterize_glyph(id, m_x_scale, m_y_scale, subpixel_offset);
+    });
+    if (!entry.has_value())
+        return Gfx::Glyph(RefPtr<Gfx::Bitmap> {}, metrics.left_side_bearing, metrics.advance_width, metrics.ascender, false);
+    return Gfx::Glyph(move(entry->bitmap), entry->rect, metrics.left_side_bearing, metrics.advance_width, metrics.ascender);
 }
 
 float ScaledFont::glyph_left_bearing(u32 code_point) const
@@ -82,6 +82,7 @@ private:
     float m_point_height { 0.0f };
 
     mutable HashMap<u32, Gfx::Path> m_glyph_cache;
+    // NOTE: Only color bitmap glyphs are cached here, all others live in the GlyphAtlas.
     mutable HashMap<GlyphIndexWithSubpixelOffset, RefPtr<Gfx::Bitmap>> m_cached_glyph_bitmaps;
     Gfx::FontPixelMetrics m_pixel_metrics;
 
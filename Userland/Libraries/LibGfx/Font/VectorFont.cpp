@@ -4,13 +4,18 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <LibGfx/Font/GlyphAtlas.h>
 #include <LibGfx/Font/ScaledFont.h>
 #include <LibGfx/Font/VectorFont.h>
 
 namespace Gfx {
 
 VectorFont::VectorFont() = default;
-VectorFont::~VectorFont() = default;
+
+VectorFont::~VectorFont()
+{
+    GlyphAtlas::the().evict_typeface(*this);
+}
 
 NonnullRefPtr<ScaledFont> VectorFont::scaled_font(float point_size) const
 {
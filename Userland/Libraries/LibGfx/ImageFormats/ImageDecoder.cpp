@@ -21,6 +21,7 @@
 #include <LibGfx/ImageFormats/PNGLoader.h>
 #include <LibGfx/ImageFormats/PPMLoader.h>
 #include <LibGfx/ImageFormats/QOILoader.h>
+#include <LibGfx/ImageFormats/ScanlineDownscaler.h>
 #include <LibGfx/ImageFormats/TGALoader.h>
 #include <LibGfx/ImageFormats/TIFFLoader.h>
 #include <LibGfx/ImageFormats/TinyVGLoader.h>
@@ -106,4 +107,38 @@ ImageDecoder::ImageDecoder(NonnullOwnPtr<ImageDecoderPlugin> plugin)
 {
 }
 
+ErrorOr<ImageFrameDescriptor> ImageDecoder::frame_region(size_t index, IntRect region, Optional<IntSize> ideal_size) const
+{
+    if (region.is_empty() || !IntRect { {}, size() }.contains(region))
+        return Error::from_string_literal("ImageDecoder: Region is outside of the image");
+    return m_plugin->frame_region(index, region, ideal_size);
+}
+
+ErrorOr<ImageFrameDescriptor> ImageDecoderPlugin::frame_region(size_t index, IntRect region, Optional<IntSize> ideal_size)
+{
+    // Ask for a frame that is just large enough for the region to still have the ideal size once it's cropped.
+    auto const image_size = size();
+    auto scale_rounding_down = [](int value, int to, int from) { return static_cast<int>(static_cast<i64>(value) * to / from); };
+    auto scale_rounding_up = [](int value, int to, int from) { return static_cast<int>(ceil_div(static_cast<i64>(value) * to, static_cast<i64>(from))); };
+    Optional<IntSize> frame_ideal_size;
+    if (ideal_size.has_value()) {
+        frame_ideal_size = IntSize {
+            scale_rounding_up(ideal_size->width(), image_size.width(), region.width()),
+            scale_rounding_up(ideal_size->height(), image_size.height(), region.height()),
+        };
+    }
+    auto frame = TRY(this->frame(index, frame_ideal_size));
+
+    // The frame may have been decoded at a smaller scale, and may still need to be scaled down further.
+    auto const frame_size = frame.image->size();
+    auto const left = scale_rounding_down(region.left(), frame_size.width(), image_size.width());
+    auto const top = scale_rounding_down(region.top(), frame_size.height(), image_size.height());
+    auto const right = scale_rounding_up(region.right(), frame_size.width(), image_size.width());
+    auto const bottom = scale_rounding_up(region.bottom(), frame_size.height(), image_size.height());
+    auto const frame_region = IntRect::from_two_points({ left, top }, { right, bottom });
+    auto const factor = ScanlineDownscaler::factor_for_ideal_size(frame_region.size(), ideal_size);
+    frame.image = TRY(ScanlineDownscaler::downscale(*frame.image, frame_region, factor));
+    return frame;
+}
+
 }
@@ -14,6 +14,7 @@
 #include <AK/String.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/CMYKBitmap.h>
+#include <LibGfx/Rect.h>
 #include <LibGfx/Size.h>
 #include <LibGfx/VectorGraphic.h>
 
@@ -84,6 +85,11 @@ public:
 
     virtual ErrorOr<ImageFrameDescriptor> frame(size_t index, Optional<IntSize> ideal_size = {}) = 0;
 
+    // Decodes only `region` (in the coordinates of size()) of a frame. The result may be scaled down, but is never smaller
+    // than `ideal_size`. The default implementation crops (and scales down) the result of frame(), override this if the
+    // format allows skipping the work for the rest of the image.
+    virtual ErrorOr<ImageFrameDescriptor> frame_region(size_t index, IntRect region, Optional<IntSize> ideal_size = {});
+
     virtual Optional<Metadata const&> metadata() { return OptionalNone {}; }
 
     virtual ErrorOr<Optional<ReadonlyBytes>> icc_data() { return OptionalNone {}; }
@@ -110,6 +116,7 @@ public:
     size_t first_animated_frame_index() const { return m_plugin->first_animated_frame_index(); }
 
     ErrorOr<ImageFrameDescriptor> frame(size_t index, Optional<IntSize> ideal_size = {}) const { return m_plugin->frame(index, ideal_size); }
+    ErrorOr<ImageFrameDescriptor> frame_region(size_t index, IntRect region, Optional<IntSize> ideal_size = {}) const;
 
     Optional<Metadata const&> metadata() const { return m_plugin->metadata(); }
     ErrorOr<Optional<ReadonlyBytes>> icc_data() const { return m_plugin->icc_data(); }
@@ -5,6 +5,8 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/BitCast.h>
+#include <AK/BuiltinWrappers.h>
 #include <AK/Debug.h>
 #include <AK/Endian.h>
 #include <AK/Error.h>
@@ -13,6 +15,8 @@
 #include <AK/Math.h>
 #include <AK/MemoryStream.h>
 #include <AK/NumericLimits.h>
+#include <AK/SIMD.h>
+#include <AK/SIMDExtras.h>
 #include <AK/String.h>
 #include <AK/Try.h>
 #include <AK/Vector.h>
@@ -23,6 +27,14 @@
 
 namespace Gfx {
 
+using AK::SIMD::all;
+using AK::SIMD::f32x4;
+using AK::SIMD::i16x4;
+using AK::SIMD::i16x8;
+using AK::SIMD::i32x4;
+using AK::SIMD::u16x8;
+using AK::SIMD::u32x4;
+
 struct MacroblockMeta {
     u32 total { 0 };
     u32 padded_total { 0 };
@@ -472,6 +484,14 @@ struct JPEGLoadingContext {
     HashMap<u8, HuffmanTable> ac_tables;
     Array<i16, 4> previous_dc_values {};
     MacroblockMeta mblock_meta;
+
+    // The number of samples that each block is decoded to in each direction. Decoding to fewer than 8 samples shrinks
+    // the image by the same factor, see inverse_dct_reduced().
+    u8 block_size { 8 };
+
+    // If set, only this part of the image (in the coordinates of the full-size image) is turned into a bitmap.
+    Optional<IntRect> region;
+
     JPEGStream stream;
     JPEGDecoderOptions options;
 
@@ -1407,243 +1427,329 @@ static ErrorOr<void> skip_segment(JPEGStream& stream)
     return {};
 }
 
-static void dequantize(JPEGLoadingContext& context, Vector<Macroblock>& macroblocks)
+struct InverseDCTConstants {
+    float m1, m2, m3, m4, m5;
+    float s0, s1, s2, s3, s4, s5, s6, s7;
+
+    static InverseDCTConstants const& the()
+    {
+        static InverseDCTConstants const constants = [] {
+            float const m0 = 2.0f * AK::cos(1.0f / 16.0f * 2.0f * AK::Pi<float>);
+            float const m5 = 2.0f * AK::cos(3.0f / 16.0f * 2.0f * AK::Pi<float>);
+            return InverseDCTConstants {
+                .m1 = 2.0f * AK::cos(2.0f / 16.0f * 2.0f * AK::Pi<float>),
+                .m2 = m0 - m5,
+                .m3 = 2.0f * AK::cos(2.0f / 16.0f * 2.0f * AK::Pi<float>),
+                .m4 = m0 + m5,
+                .m5 = m5,
+                .s0 = AK::cos(0.0f / 16.0f * AK::Pi<float>) / AK::sqrt(8.0f),
+                .s1 = AK::cos(1.0f / 16.0f * AK::Pi<float>) / 2.0f,
+                .s2 = AK::cos(2.0f / 16.0f * AK::Pi<float>) / 2.0f,
+                .s3 = AK::cos(3.0f / 16.0f * AK::Pi<float>) / 2.0f,
+                .s4 = AK::cos(4.0f / 16.0f * AK::Pi<float>) / 2.0f,
+                .s5 = AK::cos(5.0f / 16.0f * AK::Pi<float>) / 2.0f,
+                .s6 = AK::cos(6.0f / 16.0f * AK::Pi<float>) / 2.0f,
+                .s7 = AK::cos(7.0f / 16.0f * AK::Pi<float>) / 2.0f,
+            };
+        }();
+        return constants;
+    }
+};
+
+// One 1-D pass of the IDCT, on four columns at once. Each vector holds one row.
+// The 1-D DCT idea is described at https://unix4lyfe.org/dct-1d/, read aan.cc from bottom to top.
+ALWAYS_INLINE static void inverse_dct_1d(f32x4 (&values)[8], InverseDCTConstants const& k)
 {
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.sampling_factors.vertical) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.sampling_factors.horizontal) {
-            for (u32 i = 0; i < context.components.size(); i++) {
-                auto const& component = context.components[i];
+    f32x4 const g0 = values[0] * k.s0;
+    f32x4 const g1 = values[4] * k.s4;
+    f32x4 const g2 = values[2] * k.s2;
+    f32x4 const g3 = values[6] * k.s6;
+    f32x4 const g4 = values[5] * k.s5;
+    f32x4 const g5 = values[1] * k.s1;
+    f32x4 const g6 = values[7] * k.s7;
+    f32x4 const g7 = values[3] * k.s3;
+
+    f32x4 const f0 = g0;
+    f32x4 const f1 = g1;
+    f32x4 const f2 = g2;
+    f32x4 const f3 = g3;
+    f32x4 const f4 = g4 - g7;
+    f32x4 const f5 = g5 + g6;
+    f32x4 const f6 = g5 - g6;
+    f32x4 const f7 = g4 + g7;
+
+    f32x4 const e0 = f0;
+    f32x4 const e1 = f1;
+    f32x4 const e2 = f2 - f3;
+    f32x4 const e3 = f2 + f3;
+    f32x4 const e4 = f4;
+    f32x4 const e5 = f5 - f7;
+    f32x4 const e6 = f6;
+    f32x4 const e7 = f5 + f7;
+    f32x4 const e8 = f4 + f6;
+
+    f32x4 const d0 = e0;
+    f32x4 const d1 = e1;
+    f32x4 const d2 = e2 * k.m1;
+    f32x4 const d3 = e3;
+    f32x4 const d4 = e4 * k.m2;
+    f32x4 const d5 = e5 * k.m3;
+    f32x4 const d6 = e6 * k.m4;
+    f32x4 const d7 = e7;
+    f32x4 const d8 = e8 * k.m5;
+
+    f32x4 const c0 = d0 + d1;
+    f32x4 const c1 = d0 - d1;
+    f32x4 const c2 = d2 - d3;
+    f32x4 const c3 = d3;
+    f32x4 const c4 = d4 + d8;
+    f32x4 const c5 = d5 + d7;
+    f32x4 const c6 = d6 - d8;
+    f32x4 const c7 = d7;
+    f32x4 const c8 = c5 - c6;
+
+    f32x4 const b0 = c0 + c3;
+    f32x4 const b1 = c1 + c2;
+    f32x4 const b2 = c1 - c2;
+    f32x4 const b3 = c0 - c3;
+    f32x4 const b4 = c4 - c8;
+    f32x4 const b5 = c8;
+    f32x4 const b6 = c6 - c7;
+    f32x4 const b7 = c7;
+
+    values[0] = b0 + b7;
+    values[1] = b1 + b6;
+    values[2] = b2 + b5;
+    values[3] = b3 + b4;
+    values[4] = b3 - b4;
+    values[5] = b2 - b5;
+    values[6] = b1 - b6;
+    values[7] = b0 - b7;
+}
 
-                auto const& table = context.quantization_tables[component.quantization_table_id];
+// Intermediate and final results used to be stored as i16 between the passes, so truncate (and wrap) them the same way.
+ALWAYS_INLINE static i32x4 truncate_to_i16(f32x4 values)
+{
+    return __builtin_convertvector(__builtin_convertvector(__builtin_convertvector(values, i32x4), i16x4), i32x4);
+}
 
-                for (u32 vfactor_i = 0; vfactor_i < component.sampling_factors.vertical; vfactor_i++) {
-                    for (u32 hfactor_i = 0; hfactor_i < component.sampling_factors.horizontal; hfactor_i++) {
-                        u32 macroblock_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
-                        Macroblock& block = macroblocks[macroblock_index];
-                        auto* block_component = get_component(block, i);
-                        for (u32 k = 0; k < 64; k++)
-                            block_component[k] *= table[k];
-                    }
+ALWAYS_INLINE static void transpose_4x4(f32x4 const* rows, f32x4* columns)
+{
+    auto const low = __builtin_shufflevector(rows[0], rows[1], 0, 4, 1, 5);
+    auto const high = __builtin_shufflevector(rows[0], rows[1], 2, 6, 3, 7);
+    auto const other_low = __builtin_shufflevector(rows[2], rows[3], 0, 4, 1, 5);
+    auto const other_high = __builtin_shufflevector(rows[2], rows[3], 2, 6, 3, 7);
+    columns[0] = __builtin_shufflevector(low, other_low, 0, 1, 4, 5);
+    columns[1] = __builtin_shufflevector(low, other_low, 2, 3, 6, 7);
+    columns[2] = __builtin_shufflevector(high, other_high, 0, 1, 4, 5);
+    columns[3] = __builtin_shufflevector(high, other_high, 2, 3, 6, 7);
+}
+
+// Transposes the 8x8 matrix formed by the rows of `left` (columns 0-3) and `right` (columns 4-7).
+ALWAYS_INLINE static void transpose_8x8(f32x4 (&left)[8], f32x4 (&right)[8])
+{
+    f32x4 transposed_left[8];
+    f32x4 transposed_right[8];
+    transpose_4x4(left, transposed_left);
+    transpose_4x4(right, transposed_left + 4);
+    transpose_4x4(left + 4, transposed_right);
+    transpose_4x4(right + 4, transposed_right + 4);
+    for (size_t i = 0; i < 8; ++i) {
+        left[i] = transposed_left[i];
+        right[i] = transposed_right[i];
+    }
+}
+
+struct SampleRange {
+    // F.2.1.5 - Inverse DCT (IDCT)
+    i32 level_shift { 0 };
+    i32 max_value { 0 };
+
+    // FIXME: This just truncate all coefficients, it's an easy way to support (read hack)
+    //        12 bits JPEGs without rewriting all color transformations.
+    u8 shift_to_8_bits { 0 };
+
+    static SampleRange for_precision(u8 precision)
+    {
+        return {
+            .level_shift = 1 << (precision - 1),
+            .max_value = (1 << precision) - 1,
+            .shift_to_8_bits = static_cast<u8>(precision == 8 ? 0 : 4),
+        };
+    }
+};
+
+static void inverse_dct_8x8(i16* block_component, Array<u16, 64> const& quantization_table, SampleRange const& range)
+{
+    // Does a 2-D IDCT by doing two 1-D IDCTs as described in https://unix4lyfe.org/dct/, four columns at a time.
+    // The block is dequantized on the way in, and level shifted and clamped on the way out.
+    auto const& constants = InverseDCTConstants::the();
+
+    i16x8 rows[8];
+    i16x8 ac_coefficients {};
+    for (size_t row = 0; row < 8; ++row) {
+        i16x8 coefficients;
+        u16x8 quantizers;
+        __builtin_memcpy(&coefficients, block_component + row * 8, sizeof(coefficients));
+        __builtin_memcpy(&quantizers, quantization_table.data() + row * 8, sizeof(quantizers));
+        // NOTE: The dequantized coefficients used to be stored as i16, so make them wrap around the same way.
+        rows[row] = coefficients * bit_cast<i16x8>(quantizers);
+        ac_coefficients |= rows[row];
+    }
+
+    // Many blocks only have a DC coefficient, which both passes simply spread across the whole block.
+    ac_coefficients[0] = 0;
+    for (size_t row = 1; row < 8; ++row)
+        ac_coefficients[0] |= rows[row][0];
+    if (all(bit_cast<i32x4>(ac_coefficients) == 0)) {
+        auto const column_value = static_cast<i16>(rows[0][0] * constants.s0);
+        auto const value = static_cast<i16>(column_value * constants.s0);
+        auto const sample = clamp(value + range.level_shift, 0, range.max_value) >> range.shift_to_8_bits;
+        for (size_t i = 0; i < 64; ++i)
+            block_component[i] = static_cast<i16>(sample);
+        return;
+    }
+
+    f32x4 left[8];
+    f32x4 right[8];
+    for (size_t row = 0; row < 8; ++row) {
+        left[row] = __builtin_convertvector(__builtin_shufflevector(rows[row], rows[row], 0, 1, 2, 3), f32x4);
+        right[row] = __builtin_convertvector(__builtin_shufflevector(rows[row], rows[row], 4, 5, 6, 7), f32x4);
+    }
+
+    inverse_dct_1d(left, constants);
+    inverse_dct_1d(right, constants);
+    for (size_t row = 0; row < 8; ++row) {
+        left[row] = __builtin_convertvector(truncate_to_i16(left[row]), f32x4);
+        right[row] = __builtin_convertvector(truncate_to_i16(right[row]), f32x4);
+    }
+
+    transpose_8x8(left, right);
+    inverse_dct_1d(left, constants);
+    inverse_dct_1d(right, constants);
+    transpose_8x8(left, right);
+
+    auto store = [&](f32x4 values, i16* destination) {
+        auto samples = truncate_to_i16(values) + range.level_shift;
+        samples = samples < 0 ? 0 : samples;
+        samples = samples > range.max_value ? range.max_value : samples;
+        auto narrowed = __builtin_convertvector(samples >> range.shift_to_8_bits, i16x4);
+        __builtin_memcpy(destination, &narrowed, sizeof(narrowed));
+    };
+    for (size_t row = 0; row < 8; ++row) {
+        store(left[row], block_component + row * 8);
+        store(right[row], block_component + row * 8 + 4);
+    }
+}
+
+// Decodes a block to `size` x `size` samples instead of 8x8 ones, by doing a `size`-point IDCT of its lowest frequency
+// coefficients only. The samples are stored with a row stride of 8.
+static void inverse_dct_reduced(i16* block_component, Array<u16, 64> const& quantization_table, u8 size, SampleRange const& range)
+{
+    VERIFY(size == 1 || size == 2 || size == 4);
+
+    // cos((2x + 1) * u * pi / (2 * size)), scaled by C(u) from A.3.3 - FDCT and IDCT, for each of the three sizes.
+    static auto const cosine_tables = [] {
+        Array<Array<float, 16>, 3> tables {};
+        for (u8 i = 0; i < tables.size(); ++i) {
+            u8 const table_size = 1 << i;
+            for (u8 x = 0; x < table_size; ++x) {
+                for (u8 u = 0; u < table_size; ++u) {
+                    auto value = AK::cos((2 * x + 1) * u * AK::Pi<float> / (2 * table_size));
+                    tables[i][x * table_size + u] = u == 0 ? value / AK::sqrt(2.0f) : value;
                 }
             }
         }
+        return tables;
+    }();
+    float const* cosines = cosine_tables[count_trailing_zeroes(size)].data();
+
+    float coefficients[16];
+    for (u8 v = 0; v < size; ++v) {
+        for (u8 u = 0; u < size; ++u)
+            coefficients[v * size + u] = block_component[v * 8 + u] * quantization_table.data()[v * 8 + u];
+    }
+
+    float rows[16];
+    for (u8 v = 0; v < size; ++v) {
+        for (u8 x = 0; x < size; ++x) {
+            float sum = 0;
+            for (u8 u = 0; u < size; ++u)
+                sum += cosines[x * size + u] * coefficients[v * size + u];
+            rows[v * size + x] = sum;
+        }
     }
-}
 
-static void inverse_dct_8x8(i16* block_component)
-{
-    // Does a 2-D IDCT by doing two 1-D IDCTs as described in https://unix4lyfe.org/dct/
-    // The 1-D DCT idea is described at https://unix4lyfe.org/dct-1d/, read aan.cc from bottom to top.
-    static float const m0 = 2.0f * AK::cos(1.0f / 16.0f * 2.0f * AK::Pi<float>);
-    static float const m1 = 2.0f * AK::cos(2.0f / 16.0f * 2.0f * AK::Pi<float>);
-    static float const m3 = 2.0f * AK::cos(2.0f / 16.0f * 2.0f * AK::Pi<float>);
-    static float const m5 = 2.0f * AK::cos(3.0f / 16.0f * 2.0f * AK::Pi<float>);
-    static float const m2 = m0 - m5;
-    static float const m4 = m0 + m5;
-    static float const s0 = AK::cos(0.0f / 16.0f * AK::Pi<float>) / AK::sqrt(8.0f);
-    static float const s1 = AK::cos(1.0f / 16.0f * AK::Pi<float>) / 2.0f;
-    static float const s2 = AK::cos(2.0f / 16.0f * AK::Pi<float>) / 2.0f;
-    static float const s3 = AK::cos(3.0f / 16.0f * AK::Pi<float>) / 2.0f;
-    static float const s4 = AK::cos(4.0f / 16.0f * AK::Pi<float>) / 2.0f;
-    static float const s5 = AK::cos(5.0f / 16.0f * AK::Pi<float>) / 2.0f;
-    static float const s6 = AK::cos(6.0f / 16.0f * AK::Pi<float>) / 2.0f;
-    static float const s7 = AK::cos(7.0f / 16.0f * AK::Pi<float>) / 2.0f;
-
-    for (u32 k = 0; k < 8; ++k) {
-        float const g0 = block_component[0 * 8 + k] * s0;
-        float const g1 = block_component[4 * 8 + k] * s4;
-        float const g2 = block_component[2 * 8 + k] * s2;
-        float const g3 = block_component[6 * 8 + k] * s6;
-        float const g4 = block_component[5 * 8 + k] * s5;
-        float const g5 = block_component[1 * 8 + k] * s1;
-        float const g6 = block_component[7 * 8 + k] * s7;
-        float const g7 = block_component[3 * 8 + k] * s3;
-
-        float const f0 = g0;
-        float const f1 = g1;
-        float const f2 = g2;
-        float const f3 = g3;
-        float const f4 = g4 - g7;
-        float const f5 = g5 + g6;
-        float const f6 = g5 - g6;
-        float const f7 = g4 + g7;
-
-        float const e0 = f0;
-        float const e1 = f1;
-        float const e2 = f2 - f3;
-        float const e3 = f2 + f3;
-        float const e4 = f4;
-        float const e5 = f5 - f7;
-        float const e6 = f6;
-        float const e7 = f5 + f7;
-        float const e8 = f4 + f6;
-
-        float const d0 = e0;
-        float const d1 = e1;
-        float const d2 = e2 * m1;
-        float const d3 = e3;
-        float const d4 = e4 * m2;
-        float const d5 = e5 * m3;
-        float const d6 = e6 * m4;
-        float const d7 = e7;
-        float const d8 = e8 * m5;
-
-        float const c0 = d0 + d1;
-        float const c1 = d0 - d1;
-        float const c2 = d2 - d3;
-        float const c3 = d3;
-        float const c4 = d4 + d8;
-        float const c5 = d5 + d7;
-        float const c6 = d6 - d8;
-        float const c7 = d7;
-        float const c8 = c5 - c6;
-
-        float const b0 = c0 + c3;
-        float const b1 = c1 + c2;
-        float const b2 = c1 - c2;
-        float const b3 = c0 - c3;
-        float const b4 = c4 - c8;
-        float const b5 = c8;
-        float const b6 = c6 - c7;
-        float const b7 = c7;
-
-        block_component[0 * 8 + k] = b0 + b7;
-        block_component[1 * 8 + k] = b1 + b6;
-        block_component[2 * 8 + k] = b2 + b5;
-        block_component[3 * 8 + k] = b3 + b4;
-        block_component[4 * 8 + k] = b3 - b4;
-        block_component[5 * 8 + k] = b2 - b5;
-        block_component[6 * 8 + k] = b1 - b6;
-        block_component[7 * 8 + k] = b0 - b7;
-    }
-    for (u32 l = 0; l < 8; ++l) {
-        float const g0 = block_component[l * 8 + 0] * s0;
-        float const g1 = block_component[l * 8 + 4] * s4;
-        float const g2 = block_component[l * 8 + 2] * s2;
-        float const g3 = block_component[l * 8 + 6] * s6;
-        float const g4 = block_component[l * 8 + 5] * s5;
-        float const g5 = block_component[l * 8 + 1] * s1;
-        float const g6 = block_component[l * 8 + 7] * s7;
-        float const g7 = block_component[l * 8 + 3] * s3;
-
-        float const f0 = g0;
-        float const f1 = g1;
-        float const f2 = g2;
-        float const f3 = g3;
-        float const f4 = g4 - g7;
-        float const f5 = g5 + g6;
-        float const f6 = g5 - g6;
-        float const f7 = g4 + g7;
-
-        float const e0 = f0;
-        float const e1 = f1;
-        float const e2 = f2 - f3;
-        float const e3 = f2 + f3;
-        float const e4 = f4;
-        float const e5 = f5 - f7;
-        float const e6 = f6;
-        float const e7 = f5 + f7;
-        float const e8 = f4 + f6;
-
-        float const d0 = e0;
-        float const d1 = e1;
-        float const d2 = e2 * m1;
-        float const d3 = e3;
-        float const d4 = e4 * m2;
-        float const d5 = e5 * m3;
-        float const d6 = e6 * m4;
-        float const d7 = e7;
-        float const d8 = e8 * m5;
-
-        float const c0 = d0 + d1;
-        float const c1 = d0 - d1;
-        float const c2 = d2 - d3;
-        float const c3 = d3;
-        float const c4 = d4 + d8;
-        float const c5 = d5 + d7;
-        float const c6 = d6 - d8;
-        float const c7 = d7;
-        float const c8 = c5 - c6;
-
-        float const b0 = c0 + c3;
-        float const b1 = c1 + c2;
-        float const b2 = c1 - c2;
-        float const b3 = c0 - c3;
-        float const b4 = c4 - c8;
-        float const b5 = c8;
-        float const b6 = c6 - c7;
-        float const b7 = c7;
-
-        block_component[l * 8 + 0] = b0 + b7;
-        block_component[l * 8 + 1] = b1 + b6;
-        block_component[l * 8 + 2] = b2 + b5;
-        block_component[l * 8 + 3] = b3 + b4;
-        block_component[l * 8 + 4] = b3 - b4;
-        block_component[l * 8 + 5] = b2 - b5;
-        block_component[l * 8 + 6] = b1 - b6;
-        block_component[l * 8 + 7] = b0 - b7;
+    for (u8 y = 0; y < size; ++y) {
+        for (u8 x = 0; x < size; ++x) {
+            float sum = 0;
+            for (u8 v = 0; v < size; ++v)
+                sum += cosines[y * size + v] * rows[v * size + x];
+            // Keep the 1/4 scale factor of the 8-point IDCT, so that each sample ends up as the average of the 8 / size
+            // by 8 / size samples it replaces.
+            auto sample = clamp(round_to<i32>(sum / 4) + range.level_shift, 0, range.max_value);
+            block_component[y * 8 + x] = static_cast<i16>(sample >> range.shift_to_8_bits);
+        }
     }
 }
 
 static void inverse_dct(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
 {
+    auto const range = SampleRange::for_precision(context.frame.precision);
+
     for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.sampling_factors.vertical) {
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.sampling_factors.horizontal) {
+            // Subsampled components never reach outside of their MCU, so MCUs outside of the region can be skipped.
+            if (context.region.has_value()) {
+                auto const mcu_rect = IntRect(hcursor * 8, vcursor * 8, context.sampling_factors.horizontal * 8, context.sampling_factors.vertical * 8);
+                if (!mcu_rect.intersects(*context.region))
+                    continue;
+            }
             for (u32 component_i = 0; component_i < context.components.size(); component_i++) {
                 auto& component = context.components[component_i];
+                auto const& table = context.quantization_tables[component.quantization_table_id];
                 for (u8 vfactor_i = 0; vfactor_i < component.sampling_factors.vertical; vfactor_i++) {
                     for (u8 hfactor_i = 0; hfactor_i < component.sampling_factors.horizontal; hfactor_i++) {
                         u32 macroblock_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
                         Macroblock& block = macroblocks[macroblock_index];
                         auto* block_component = get_component(block, component_i);
-                        inverse_dct_8x8(block_component);
+                        if (context.block_size == 8)
+                            inverse_dct_8x8(block_component, table, range);
+                        else
+                            inverse_dct_reduced(block_component, table, context.block_size, range);
                     }
                 }
             }
         }
     }
+}
 
-    // F.2.1.5 - Inverse DCT (IDCT)
-    auto const level_shift = 1 << (context.frame.precision - 1);
-    auto const max_value = (1 << context.frame.precision) - 1;
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.sampling_factors.vertical) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.sampling_factors.horizontal) {
-            for (u8 vfactor_i = 0; vfactor_i < context.sampling_factors.vertical; ++vfactor_i) {
-                for (u8 hfactor_i = 0; hfactor_i < context.sampling_factors.horizontal; ++hfactor_i) {
-                    u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hcursor + hfactor_i);
-                    for (u8 i = 0; i < 8; ++i) {
-                        for (u8 j = 0; j < 8; ++j) {
-
-                            // FIXME: This just truncate all coefficients, it's an easy way to support (read hack)
-                            //        12 bits JPEGs without rewriting all color transformations.
-                            auto const clamp_to_8_bits = [&](u16 color) -> u8 {
-                                if (context.frame.precision == 8)
-                                    return static_cast<u8>(color);
-                                return static_cast<u8>(color >> 4);
-                            };
-
-                            macroblocks[mb_index].r[i * 8 + j] = clamp_to_8_bits(clamp(macroblocks[mb_index].r[i * 8 + j] + level_shift, 0, max_value));
-                            macroblocks[mb_index].g[i * 8 + j] = clamp_to_8_bits(clamp(macroblocks[mb_index].g[i * 8 + j] + level_shift, 0, max_value));
-                            macroblocks[mb_index].b[i * 8 + j] = clamp_to_8_bits(clamp(macroblocks[mb_index].b[i * 8 + j] + level_shift, 0, max_value));
-                            macroblocks[mb_index].k[i * 8 + j] = clamp_to_8_bits(clamp(macroblocks[mb_index].k[i * 8 + j] + level_shift, 0, max_value));
-                        }
-                    }
-                }
-            }
-        }
-    }
+struct SampleLocation {
+    u32 macroblock { 0 };
+    u32 sample { 0 };
+};
+
+// Finds the sample of a component that covers the given pixel column (or row) of the decoded image, in the direction
+// that has the given sampling factors. The first component has sampling factors of context.sampling_factors, while the
+// others divide the first component's sampling factors. This is enforced by read_start_of_frame().
+// See https://www.w3.org/Graphics/JPEG/itu-t81.pdf, A.2 Order of source image data encoding: each MCU holds the blocks of
+// all components, and the blocks of a subsampled component are stored in the first of the MCU's blocks.
+static SampleLocation locate_sample(u32 position, u8 block_size, u8 max_sampling_factor, u8 component_sampling_factor)
+{
+    u32 const component_position = position / (max_sampling_factor / component_sampling_factor);
+    u32 const component_block = component_position / block_size;
+    return {
+        .macroblock = (component_block / component_sampling_factor) * max_sampling_factor + component_block % component_sampling_factor,
+        .sample = component_position % block_size,
+    };
 }
 
 static void undo_subsampling(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
 {
-    // The first component has sampling factors of context.sampling_factors, while the others
-    // divide the first component's sampling factors. This is enforced by read_start_of_frame().
     // This function undoes the subsampling by duplicating the values of the smaller components.
-    // See https://www.w3.org/Graphics/JPEG/itu-t81.pdf, A.2 Order of source image data encoding.
-    //
-    // FIXME: Allow more combinations of sampling factors.
-    // See https://calendar.perfplanet.com/2015/why-arent-your-images-using-chroma-subsampling/ for
-    // subsampling factors visble on the web. In PDF files, YCCK 2111 and 2112 and CMYK 2111 and 2112 are also present.
+    // NOTE: Samples are only ever copied from blocks and positions that come earlier in the MCU, so going backwards
+    //       makes it possible to do this in place.
+    u8 const block_size = context.block_size;
     for (u32 component_i = 0; component_i < context.components.size(); component_i++) {
         auto& component = context.components[component_i];
         if (component.sampling_factors == context.sampling_factors)
@@ -1651,24 +1757,17 @@ static void undo_subsampling(JPEGLoadingContext const& context, Vector<Macrobloc
 
         for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.sampling_factors.vertical) {
             for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.sampling_factors.horizontal) {
-                u32 const component_block_index = vcursor * context.mblock_meta.hpadded_count + hcursor;
-                Macroblock& component_block = macroblocks[component_block_index];
-                auto* block_component_source = get_component(component_block, component_i);
-
                 // Overflows are intentional.
                 for (u8 vfactor_i = context.sampling_factors.vertical - 1; vfactor_i < context.sampling_factors.vertical; --vfactor_i) {
                     for (u8 hfactor_i = context.sampling_factors.horizontal - 1; hfactor_i < context.sampling_factors.horizontal; --hfactor_i) {
                         u32 macroblock_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
-                        Macroblock& block = macroblocks[macroblock_index];
-                        auto* block_component_destination = get_component(block, component_i);
-                        for (u8 i = 7; i < 8; --i) {
-                            for (u8 j = 7; j < 8; --j) {
-                                u8 const pixel = i * 8 + j;
-                                // The component is 8x8 subsampled 2x2. Upsample its 2x2 4x4 tiles.
-                                u32 const component_pxrow = (i / context.sampling_factors.vertical) + 4 * vfactor_i;
-                                u32 const component_pxcol = (j / context.sampling_factors.horizontal) + 4 * hfactor_i;
-                                u32 const component_pixel = component_pxrow * 8 + component_pxcol;
-                                block_component_destination[pixel] = block_component_source[component_pixel];
+                        auto* block_component_destination = get_component(macroblocks[macroblock_index], component_i);
+                        for (u8 i = block_size - 1; i < block_size; --i) {
+                            auto const row = locate_sample(vcursor * block_size + vfactor_i * block_size + i, block_size, context.sampling_factors.vertical, component.sampling_factors.vertical);
+                            for (u8 j = block_size - 1; j < block_size; --j) {
+                                auto const column = locate_sample(hcursor * block_size + hfactor_i * block_size + j, block_size, context.sampling_factors.horizontal, component.sampling_factors.horizontal);
+                                auto* block_component_source = get_component(macroblocks[row.macroblock * context.mblock_meta.hpadded_count + column.macroblock], component_i);
+                                block_component_destination[i * 8 + j] = block_component_source[row.sample * 8 + column.sample];
                             }
                         }
                     }
@@ -1783,23 +1882,130 @@ static ErrorOr<void> handle_color_transform(JPEGLoadingContext const& context, V
     return {};
 }
 
-static ErrorOr<void> compose_bitmap(JPEGLoadingContext& context, Vector<Macroblock> const& macroblocks)
+static IntSize decoded_size(JPEGLoadingContext const& context)
 {
-    context.bitmap = TRY(Bitmap::create(BitmapFormat::BGRx8888, { context.frame.width, context.frame.height }));
+    auto scale = [&](u16 dimension) { return ceil_div(dimension * context.block_size, 8); };
+    return { scale(context.frame.width), scale(context.frame.height) };
+}
 
-    for (u32 y = context.frame.height - 1; y < context.frame.height; y--) {
-        u32 const block_row = y / 8;
-        u32 const pixel_row = y % 8;
-        for (u32 x = 0; x < context.frame.width; x++) {
-            u32 const block_column = x / 8;
-            auto& block = macroblocks[block_row * context.mblock_meta.hpadded_count + block_column];
-            u32 const pixel_column = x % 8;
-            u32 const pixel_index = pixel_row * 8 + pixel_column;
-            Color const color { (u8)block.y[pixel_index], (u8)block.cb[pixel_index], (u8)block.cr[pixel_index] };
-            context.bitmap->set_pixel(x, y, color);
+// The part of the decoded image that ends up in the bitmap.
+static IntRect decoded_rect(JPEGLoadingContext const& context)
+{
+    if (!context.region.has_value())
+        return { {}, decoded_size(context) };
+    auto scale_rounding_down = [&](int position) { return position * context.block_size / 8; };
+    auto scale_rounding_up = [&](int position) { return ceil_div(position * context.block_size, 8); };
+    auto const& region = *context.region;
+    return IntRect::from_two_points(
+        { scale_rounding_down(region.left()), scale_rounding_down(region.top()) },
+        { scale_rounding_up(region.right()), scale_rounding_up(region.bottom()) });
+}
+
+enum class SampleFormat {
+    Grayscale,
+    RGB,
+    YCbCr,
+};
+
+template<typename T>
+struct RGBChannels {
+    T red;
+    T green;
+    T blue;
+};
+
+static void convert_row_to_bgrx(ARGB32* destination, Array<Vector<i32>, 3> const& samples, size_t count, SampleFormat format)
+{
+    auto to_bgrx = [](auto red, auto green, auto blue) {
+        return 0xff000000 | (red << 16) | (green << 8) | blue;
+    };
+
+    // See ycbcr_to_rgb(), this does the exact same computations.
+    auto ycbcr_to_rgb = [](auto y, auto cb, auto cr, auto convert_to_int) {
+        auto clamp_to_u8 = [](auto value) {
+            value = value < 0 ? 0 : value;
+            return value > 255 ? 255 : value;
+        };
+        auto red = clamp_to_u8(convert_to_int(y + 1.402f * cr));
+        auto green = clamp_to_u8(convert_to_int(y - 0.3441f * cb - 0.7141f * cr));
+        auto blue = clamp_to_u8(convert_to_int(y + 1.772f * cb));
+        return RGBChannels<decltype(red)> { red, green, blue };
+    };
+
+    size_t x = 0;
+    if (format == SampleFormat::YCbCr) {
+        auto load = [&](size_t component, i32 offset) {
+            i32x4 values;
+            __builtin_memcpy(&values, samples[component].data() + x, sizeof(values));
+            return __builtin_convertvector(values + offset, f32x4);
+        };
+        auto convert_to_int = [](f32x4 value) { return __builtin_convertvector(value, i32x4); };
+        for (; x + 4 <= count; x += 4) {
+            auto [red, green, blue] = ycbcr_to_rgb(load(0, 0), load(1, -128), load(2, -128), convert_to_int);
+            u32x4 pixels = to_bgrx(bit_cast<u32x4>(red), bit_cast<u32x4>(green), bit_cast<u32x4>(blue));
+            __builtin_memcpy(destination + x, &pixels, sizeof(pixels));
         }
     }
 
+    i32 const* first = samples[0].data();
+    i32 const* second = samples[1].data();
+    i32 const* third = samples[2].data();
+    for (; x < count; ++x) {
+        switch (format) {
+        case SampleFormat::Grayscale:
+            destination[x] = to_bgrx(first[x], first[x], first[x]);
+            break;
+        case SampleFormat::RGB:
+            destination[x] = to_bgrx(first[x], second[x], third[x]);
+            break;
+        case SampleFormat::YCbCr: {
+            auto convert_to_int = [](float value) { return static_cast<int>(value); };
+            auto [red, green, blue] = ycbcr_to_rgb(static_cast<float>(first[x]), static_cast<float>(second[x] - 128), static_cast<float>(third[x] - 128), convert_to_int);
+            destination[x] = to_bgrx(red, green, blue);
+            break;
+        }
+        }
+    }
+}
+
+static ErrorOr<void> compose_bitmap(JPEGLoadingContext& context, Vector<Macroblock>& macroblocks, SampleFormat format, bool is_upsampled)
+{
+    auto const rect = decoded_rect(context);
+    context.bitmap = TRY(Bitmap::create(BitmapFormat::BGRx8888, rect.size()));
+
+    // Subsampled components are upsampled on the fly, by reading each sample from the block that covers it.
+    static_assert(sizeof(Macroblock) == 4 * 64 * sizeof(i16));
+    auto const samples_per_macroblock = sizeof(Macroblock) / sizeof(i16);
+    auto const component_count = format == SampleFormat::Grayscale ? 1u : 3u;
+    auto const width = static_cast<u32>(context.bitmap->width());
+    auto sampling_factors_of = [&](u32 component_i) {
+        return is_upsampled ? context.sampling_factors : context.components[component_i].sampling_factors;
+    };
+
+    Array<Vector<u32>, 3> column_offsets;
+    Array<Vector<i32>, 3> samples;
+    for (u32 component_i = 0; component_i < component_count; ++component_i) {
+        TRY(column_offsets[component_i].try_resize(width));
+        TRY(samples[component_i].try_resize(width));
+        for (u32 x = 0; x < width; ++x) {
+            auto location = locate_sample(rect.x() + x, context.block_size, context.sampling_factors.horizontal, sampling_factors_of(component_i).horizontal);
+            column_offsets[component_i][x] = location.macroblock * samples_per_macroblock + location.sample;
+        }
+    }
+
+    auto const* all_samples = reinterpret_cast<i16 const*>(macroblocks.data());
+    for (u32 y = 0; y < static_cast<u32>(context.bitmap->height()); ++y) {
+        for (u32 component_i = 0; component_i < component_count; ++component_i) {
+            auto location = locate_sample(rect.y() + y, context.block_size, context.sampling_factors.vertical, sampling_factors_of(component_i).vertical);
+            auto const* row = all_samples + location.macroblock * context.mblock_meta.hpadded_count * samples_per_macroblock + component_i * 64 + location.sample * 8;
+            auto const* offsets = column_offsets[component_i].data();
+            auto* row_samples = samples[component_i].data();
+            for (u32 x = 0; x < width; ++x)
+                row_samples[x] = row[offsets[x]];
+        }
+        convert_row_to_bgrx(context.bitmap->scanline(y), samples, width, format);
+    }
+
     return {};
 }
 
@@ -1808,15 +2014,17 @@ static ErrorOr<void> compose_cmyk_bitmap(JPEGLoadingContext& context, Vector<Mac
     if (context.options.cmyk == JPEGDecoderOptions::CMYK::Normal)
         invert_colors_for_adobe_images(context, macroblocks);
 
-    context.cmyk_bitmap = TRY(Gfx::CMYKBitmap::create_with_size({ context.frame.width, context.frame.height }));
+    auto const size = decoded_size(context);
+    context.cmyk_bitmap = TRY(Gfx::CMYKBitmap::create_with_size(size));
 
-    for (u32 y = context.frame.height - 1; y < context.frame.height; y--) {
-        u32 const block_row = y / 8;
-        u32 const pixel_row = y % 8;
-        for (u32 x = 0; x < context.frame.width; x++) {
-            u32 const block_column = x / 8;
+    u32 const block_size = context.block_size;
+    for (u32 y = 0; y < static_cast<u32>(size.height()); y++) {
+        u32 const block_row = y / block_size;
+        u32 const pixel_row = y % block_size;
+        for (u32 x = 0; x < static_cast<u32>(size.width()); x++) {
+            u32 const block_column = x / block_size;
             auto& block = macroblocks[block_row * context.mblock_meta.hpadded_count + block_column];
-            u32 const pixel_column = x % 8;
+            u32 const pixel_column = x % block_size;
             u32 const pixel_index = pixel_row * 8 + pixel_column;
             context.cmyk_bitmap->scanline(y)[x] = { (u8)block.y[pixel_index], (u8)block.cb[pixel_index], (u8)block.cr[pixel_index], (u8)block.k[pixel_index] };
         }
@@ -1968,22 +2176,44 @@ static ErrorOr<Vector<Macroblock>> construct_macroblocks(JPEGLoadingContext& con
     }
 }
 
+// Returns how the samples can be turned into a bitmap directly, if handle_color_transform() wouldn't do anything else.
+static Optional<SampleFormat> sample_format_for_bitmap(JPEGLoadingContext const& context)
+{
+    // NOTE: Just like in handle_color_transform(), the color transform is ignored for grayscale images.
+    if (context.components.size() == 1)
+        return SampleFormat::Grayscale;
+    if (context.components.size() != 3)
+        return {};
+    if (!context.color_transform.has_value() || *context.color_transform == ColorTransform::YCbCr)
+        return SampleFormat::YCbCr;
+    if (*context.color_transform == ColorTransform::CmykOrRgb)
+        return SampleFormat::RGB;
+    return {};
+}
+
 static ErrorOr<void> decode_jpeg(JPEGLoadingContext& context)
 {
     auto macroblocks = TRY(construct_macroblocks(context));
-    dequantize(context, macroblocks);
     inverse_dct(context, macroblocks);
+
+    // The common cases are converted to RGB while composing the bitmap, which avoids a pass over the samples.
+    if (auto format = sample_format_for_bitmap(context); format.has_value())
+        return compose_bitmap(context, macroblocks, *format, false);
+
     undo_subsampling(context, macroblocks);
     TRY(handle_color_transform(context, macroblocks));
-    if (context.components.size() == 4)
+    if (context.components.size() == 4) {
+        VERIFY(!context.region.has_value());
         TRY(compose_cmyk_bitmap(context, macroblocks));
+    }
     else
-        TRY(compose_bitmap(context, macroblocks));
+        TRY(compose_bitmap(context, macroblocks, SampleFormat::RGB, true));
     return {};
 }
 
-JPEGImageDecoderPlugin::JPEGImageDecoderPlugin(NonnullOwnPtr<JPEGLoadingContext> context)
+JPEGImageDecoderPlugin::JPEGImageDecoderPlugin(NonnullOwnPtr<JPEGLoadingContext> context, ReadonlyBytes data)
     : m_context(move(context))
+    , m_data(data)
 {
 }
 
@@ -2007,16 +2237,60 @@ ErrorOr<NonnullOwnPtr<ImageDecoderPlugin>> JPEGImageDecoderPlugin::create(Readon
     return create_with_options(data, {});
 }
 
-ErrorOr<NonnullOwnPtr<ImageDecoderPlugin>> JPEGImageDecoderPlugin::create_with_options(ReadonlyBytes data, JPEGDecoderOptions options)
+static ErrorOr<NonnullOwnPtr<JPEGLoadingContext>> create_context(ReadonlyBytes data, JPEGDecoderOptions options)
 {
     auto stream = TRY(try_make<FixedMemoryStream>(data));
     auto context = TRY(JPEGLoadingContext::create(move(stream), options));
-    auto plugin = TRY(adopt_nonnull_own_or_enomem(new (nothrow) JPEGImageDecoderPlugin(move(context))));
-    TRY(decode_header(*plugin->m_context));
-    return plugin;
+    TRY(decode_header(*context));
+    return context;
+}
+
+ErrorOr<NonnullOwnPtr<ImageDecoderPlugin>> JPEGImageDecoderPlugin::create_with_options(ReadonlyBytes data, JPEGDecoderOptions options)
+{
+    auto context = TRY(create_context(data, options));
+    return TRY(adopt_nonnull_own_or_enomem(new (nothrow) JPEGImageDecoderPlugin(move(context), data)));
+}
+
+// Picks the smallest scale (1/8, 1/4, 1/2 or 1) at which the image is still at least as large as the ideal size, so that
+// it never has to be scaled back up.
+static u8 block_size_for_ideal_size(IntSize size, Optional<IntSize> ideal_size)
+{
+    if (!ideal_size.has_value())
+        return 8;
+    for (u8 block_size : { 1, 2, 4 }) {
+        auto scale = [&](int dimension) { return ceil_div(dimension * block_size, 8); };
+        if (scale(size.width()) >= ideal_size->width() && scale(size.height()) >= ideal_size->height())
+            return block_size;
+    }
+    return 8;
+}
+
+ErrorOr<void> JPEGImageDecoderPlugin::decode(u8 block_size)
+{
+    if (m_context->state == JPEGLoadingContext::State::BitmapDecoded) {
+        if (m_context->block_size == block_size)
+            return {};
+
+        // The image has been decoded at another scale already, so decode it again from the start.
+        auto context = TRY(create_context(m_data, m_context->options));
+        context->block_size = block_size;
+        TRY(decode_jpeg(*context));
+        m_context->bitmap = move(context->bitmap);
+        m_context->cmyk_bitmap = move(context->cmyk_bitmap);
+        m_context->block_size = block_size;
+        return {};
+    }
+
+    m_context->block_size = block_size;
+    if (auto result = decode_jpeg(*m_context); result.is_error()) {
+        m_context->state = JPEGLoadingContext::State::Error;
+        return result.release_error();
+    }
+    m_context->state = JPEGLoadingContext::State::BitmapDecoded;
+    return {};
 }
 
-ErrorOr<ImageFrameDescriptor> JPEGImageDecoderPlugin::frame(size_t index, Optional<IntSize>)
+ErrorOr<ImageFrameDescriptor> JPEGImageDecoderPlugin::frame(size_t index, Optional<IntSize> ideal_size)
 {
     if (index > 0)
         return Error::from_string_literal("JPEGImageDecoderPlugin: Invalid frame index");
@@ -2024,13 +2298,7 @@ ErrorOr<ImageFrameDescriptor> JPEGImageDecoderPlugin::frame(size_t index, Option
     if (m_context->state == JPEGLoadingContext::State::Error)
         return Error::from_string_literal("JPEGImageDecoderPlugin: Decoding failed");
 
-    if (m_context->state < JPEGLoadingContext::State::BitmapDecoded) {
-        if (auto result = decode_jpeg(*m_context); result.is_error()) {
-            m_context->state = JPEGLoadingContext::State::Error;
-            return result.release_error();
-        }
-        m_context->state = JPEGLoadingContext::State::BitmapDecoded;
-    }
+    TRY(decode(block_size_for_ideal_size(size(), ideal_size)));
 
     if (m_context->cmyk_bitmap && !m_context->bitmap)
         return ImageFrameDescriptor { TRY(m_context->cmyk_bitmap->to_low_quality_rgb()), 0 };
@@ -2038,6 +2306,29 @@ ErrorOr<ImageFrameDescriptor> JPEGImageDecoderPlugin::frame(size_t index, Option
     return ImageFrameDescriptor { m_context->bitmap, 0 };
 }
 
+ErrorOr<ImageFrameDescriptor> JPEGImageDecoderPlugin::frame_region(size_t index, IntRect region, Optional<IntSize> ideal_size)
+{
+    if (index > 0)
+        return Error::from_string_literal("JPEGImageDecoderPlugin: Invalid frame index");
+
+    if (m_context->state == JPEGLoadingContext::State::Error)
+        return Error::from_string_literal("JPEGImageDecoderPlugin: Decoding failed");
+
+    // CMYK images are always composed as a whole, and a bitmap that has been decoded at the right scale already only
+    // needs to be cropped.
+    auto const block_size = block_size_for_ideal_size(region.size(), ideal_size);
+    bool const is_decoded_at_scale = m_context->state == JPEGLoadingContext::State::BitmapDecoded && m_context->block_size == block_size;
+    if (natural_frame_format() == NaturalFrameFormat::CMYK || is_decoded_at_scale)
+        return ImageDecoderPlugin::frame_region(index, region, ideal_size);
+
+    // Entropy decoding still has to go through the whole image, but everything after it only happens for the region.
+    auto context = TRY(create_context(m_data, m_context->options));
+    context->block_size = block_size;
+    context->region = region;
+    TRY(decode_jpeg(*context));
+    return ImageFrameDescriptor { context->bitmap, 0 };
+}
+
 Optional<Metadata const&> JPEGImageDecoderPlugin::metadata()
 {
     if (m_context->exif_metadata)
@@ -2068,13 +2359,10 @@ ErrorOr<NonnullRefPtr<CMYKBitmap>> JPEGImageDecoderPlugin::cmyk_frame()
 {
     VERIFY(natural_frame_format() == NaturalFrameFormat::CMYK);
 
-    if (m_context->state < JPEGLoadingContext::State::BitmapDecoded) {
-        if (auto result = decode_jpeg(*m_context); result.is_error()) {
-            m_context->state = JPEGLoadingContext::State::Error;
-            return result.release_error();
-        }
-        m_context->state = JPEGLoadingContext::State::BitmapDecoded;
-    }
+    if (m_context->state == JPEGLoadingContext::State::Error)
+        return Error::from_string_literal("JPEGImageDecoderPlugin: Decoding failed");
+
+    TRY(decode(8));
 
     return *m_context->cmyk_bitmap;
 }
@@ -37,6 +37,7 @@ public:
     virtual IntSize size() override;
 
     virtual ErrorOr<ImageFrameDescriptor> frame(size_t index, Optional<IntSize> ideal_size = {}) override;
+    virtual ErrorOr<ImageFrameDescriptor> frame_region(size_t index, IntRect region, Optional<IntSize> ideal_size = {}) override;
 
     virtual Optional<Metadata const&> metadata() override;
 
@@ -46,9 +47,12 @@ public:
     virtual ErrorOr<NonnullRefPtr<CMYKBitmap>> cmyk_frame() override;
 
 private:
-    JPEGImageDecoderPlugin(NonnullOwnPtr<JPEGLoadingContext>);
+    JPEGImageDecoderPlugin(NonnullOwnPtr<JPEGLoadingContext>, ReadonlyBytes);
+
+    ErrorOr<void> decode(u8 block_size);
 
     NonnullOwnPtr<JPEGLoadingContext> m_context;
+    ReadonlyBytes m_data;
 };
 
 }
@@ -11,6 +11,7 @@
 #include <AK/Vector.h>
 #include <LibCompress/Zlib.h>
 #include <LibGfx/ImageFormats/PNGLoader.h>
+#include <LibGfx/ImageFormats/ScanlineDownscaler.h>
 #include <LibGfx/ImageFormats/TIFFLoader.h>
 #include <LibGfx/ImageFormats/TIFFMetadata.h>
 #include <LibGfx/Painter.h>
@@ -876,6 +877,58 @@ static ErrorOr<void> decode_png_bitmap(PNGLoadingContext& context)
     return {};
 }
 
+// Decodes only the rows of a non-interlaced image up to the end of the region, one at a time, so that neither the whole
+// decompressed image nor a full-size bitmap has to be kept around.
+static ErrorOr<NonnullRefPtr<Bitmap>> decode_png_bitmap_region(PNGLoadingContext& context, IntRect region, int scale_factor)
+{
+    VERIFY(context.interlace_method == PngInterlaceMethod::Null);
+
+    if (context.state < PNGLoadingContext::State::ChunksDecoded) {
+        if (!decode_png_chunks(context))
+            return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed");
+    }
+
+    if (context.color_type == PNG::ColorType::IndexedColor && context.palette_data.is_empty())
+        return Error::from_string_literal("PNGImageDecoderPlugin: Didn't see a PLTE chunk for a palletized image, or it was empty.");
+
+    auto row_size = context.compute_row_size_for_width(context.width);
+    if (row_size.has_overflow())
+        return Error::from_string_literal("PNGImageDecoderPlugin: Row size overflow");
+
+    auto format = context.has_alpha() ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888;
+    auto downscaler = TRY(ScanlineDownscaler::create(region, scale_factor, format));
+
+    // Every row is unpacked into a bitmap of its own, after being unfiltered here.
+    auto row_context = context.create_subimage_context(context.width, 1);
+    row_context.bitmap = TRY(Bitmap::create(format, { context.width, 1 }));
+    u8 bytes_per_complete_pixel = ceil_div(context.bit_depth, (u8)8) * context.channels;
+
+    auto decompressor = TRY(Compress::ZlibDecompressor::create(make<FixedMemoryStream>(context.compressed_data.span())));
+
+    // The current and the previous row, each preceded by its filter byte. The first row uses zeroes as previous row.
+    auto const stride = row_size.value() + 1;
+    auto rows = TRY(ByteBuffer::create_zeroed(2 * stride));
+    for (int y = 0; !downscaler.is_complete(); ++y) {
+        auto row = rows.bytes().slice((y % 2) * stride, stride);
+        auto previous_row = rows.bytes().slice(((y + 1) % 2) * stride + 1, row_size.value());
+        TRY(decompressor->read_until_filled(row));
+
+        if (row[0] > 4)
+            return Error::from_string_literal("PNGImageDecoderPlugin: Invalid PNG filter");
+        auto scanline_data = row.slice(1);
+        PNGImageDecoderPlugin::unfilter_scanline(MUST(PNG::filter_type(row[0])), scanline_data, previous_row, bytes_per_complete_pixel);
+
+        if (!downscaler.needs_row(y))
+            continue;
+        row_context.scanlines.clear_with_capacity();
+        row_context.scanlines.append({ PNG::FilterType::None, scanline_data });
+        TRY(unfilter(row_context));
+        downscaler.add_row(y, row_context.bitmap->scanline(0));
+    }
+
+    return downscaler.bitmap();
+}
+
 static ErrorOr<RefPtr<Bitmap>> decode_png_animation_frame_bitmap(PNGLoadingContext& context, AnimationFrame& animation_frame)
 {
     if (context.color_type == PNG::ColorType::IndexedColor && context.palette_data.is_empty())
@@ -1380,7 +1433,24 @@ static ErrorOr<RefPtr<Bitmap>> render_animation_frame(AnimationFrame const& prev
     return rendered_bitmap;
 }
 
-ErrorOr<ImageFrameDescriptor> PNGImageDecoderPlugin::frame(size_t index, Optional<IntSize>)
+bool PNGImageDecoderPlugin::can_decode_region_directly()
+{
+    // Animations build each frame upon the previous one, and interlaced images spread each region over the whole data.
+    if (!ensure_image_data_chunk_was_decoded())
+        return false;
+    return !m_context->has_seen_actl_chunk_before_idat && m_context->interlace_method == PngInterlaceMethod::Null && m_context->state < PNGLoadingContext::State::BitmapDecoded;
+}
+
+ErrorOr<ImageFrameDescriptor> PNGImageDecoderPlugin::frame_region(size_t index, IntRect region, Optional<IntSize> ideal_size)
+{
+    if (index > 0 || !can_decode_region_directly())
+        return ImageDecoderPlugin::frame_region(index, region, ideal_size);
+
+    auto scale_factor = ScanlineDownscaler::factor_for_ideal_size(region.size(), ideal_size);
+    return ImageFrameDescriptor { TRY(decode_png_bitmap_region(*m_context, region, scale_factor)) };
+}
+
+ErrorOr<ImageFrameDescriptor> PNGImageDecoderPlugin::frame(size_t index, Optional<IntSize> ideal_size)
 {
     if (m_context->state == PNGLoadingContext::State::Error)
         return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed");
@@ -1388,6 +1458,10 @@ ErrorOr<ImageFrameDescriptor> PNGImageDecoderPlugin::frame(size_t index, Optiona
     if (!ensure_image_data_chunk_was_decoded())
         return Error::from_string_literal("PNGImageDecoderPlugin: Decoding image data chunk");
 
+    // Images that are wanted at a smaller size are scaled down while decoding, and never kept at full size.
+    if (index == 0 && ScanlineDownscaler::factor_for_ideal_size(size(), ideal_size) > 1 && can_decode_region_directly())
+        return frame_region(index, { {}, size() }, ideal_size);
+
     auto set_descriptor_duration = [](ImageFrameDescriptor& descriptor, AnimationFrame const& animation_frame) {
         descriptor.duration = static_cast<int>(animation_frame.duration_ms());
         if (descriptor.duration < 0)
@@ -1421,6 +1495,13 @@ ErrorOr<ImageFrameDescriptor> PNGImageDecoderPlugin::frame(size_t index, Optiona
     if (index >= m_context->animation_frames.size())
         return Error::from_string_literal("PNGImageDecoderPlugin: Invalid animation frame index");
 
+    // Each frame is rendered on top of the previous one, so only the most recently rendered frame is kept around.
+    // Going back to an earlier frame means starting over from the first one.
+    if (index + 1 < m_context->animation_next_frame_to_render) {
+        m_context->animation_frames[m_context->animation_next_frame_to_render - 1].bitmap = nullptr;
+        m_context->animation_next_frame_to_render = 0;
+    }
+
     // We need to assemble each frame up until the one requested,
     // so decode all bitmaps that haven't been decoded yet.
     for (size_t i = m_context->animation_next_frame_to_render; i <= index; i++) {
@@ -1436,8 +1517,9 @@ ErrorOr<ImageFrameDescriptor> PNGImageDecoderPlugin::frame(size_t index, Optiona
 
             auto decoded_bitmap = TRY(decode_png_animation_frame_bitmap(*m_context, animation_frame));
 
-            auto prev_animation_frame = m_context->animation_frames[i - 1];
+            auto& prev_animation_frame = m_context->animation_frames[i - 1];
             animation_frame.bitmap = TRY(render_animation_frame(prev_animation_frame, animation_frame, *decoded_bitmap));
+            prev_animation_frame.bitmap = nullptr;
         }
         m_context->animation_next_frame_to_render = i + 1;
     }
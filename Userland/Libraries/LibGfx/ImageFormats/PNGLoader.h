@@ -27,6 +27,7 @@ public:
     virtual size_t frame_count() override;
     virtual size_t first_animated_frame_index() override;
     virtual ErrorOr<ImageFrameDescriptor> frame(size_t index, Optional<IntSize> ideal_size = {}) override;
+    virtual ErrorOr<ImageFrameDescriptor> frame_region(size_t index, IntRect region, Optional<IntSize> ideal_size = {}) override;
     virtual Optional<Metadata const&> metadata() override;
     virtual ErrorOr<Optional<ReadonlyBytes>> icc_data() override;
 
@@ -36,6 +37,7 @@ private:
     PNGImageDecoderPlugin(u8 const*, size_t);
     bool ensure_image_data_chunk_was_decoded();
     bool ensure_animation_frame_was_decoded(u32);
+    bool can_decode_region_directly();
 
     OwnPtr<PNGLoadingContext> m_context;
 };
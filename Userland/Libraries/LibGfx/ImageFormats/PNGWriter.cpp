@@ -7,13 +7,14 @@
  */
 
 #include <AK/Concepts.h>
-#include <AK/FixedArray.h>
-#include <AK/SIMDExtras.h>
+#include <AK/Math.h>
+#include <AK/SIMD.h>
 #include <AK/String.h>
 #include <LibCompress/Zlib.h>
 #include <LibCrypto/Checksum/CRC32.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/ImageFormats/PNGWriter.h>
+#include <LibGfx/ScanlineKernels.h>
 
 #pragma GCC diagnostic ignored "-Wpsabi"
 
@@ -149,122 +150,212 @@ ErrorOr<void> PNGWriter::add_IEND_chunk()
     return {};
 }
 
-union [[gnu::packed]] Pixel {
-    ARGB32 rgba { 0 };
-    struct {
-        u8 red;
-        u8 green;
-        u8 blue;
-        u8 alpha;
-    };
-    AK::SIMD::u8x4 simd;
-
-    ALWAYS_INLINE static AK::SIMD::u8x4 gfx_to_png(Pixel pixel)
-    {
-        swap(pixel.red, pixel.blue);
-        return pixel.simd;
-    }
-};
-static_assert(AssertSize<Pixel, 4>());
-
-ErrorOr<void> PNGWriter::add_IDAT_chunk(Gfx::Bitmap const& bitmap)
-{
-    PNGChunk png_chunk { "IDAT"_string };
-    TRY(png_chunk.reserve(bitmap.size_in_bytes()));
-
-    ByteBuffer uncompressed_block_data;
-    TRY(uncompressed_block_data.try_ensure_capacity(bitmap.size_in_bytes() + bitmap.height()));
+using AK::SIMD::i16x16;
+using AK::SIMD::u8x16;
 
-    auto dummy_scanline = TRY(FixedArray<Pixel>::create(bitmap.width()));
-    auto const* scanline_minus_1 = dummy_scanline.data();
+static constexpr size_t bytes_per_pixel = 4;
+static constexpr size_t bytes_per_vector = sizeof(u8x16);
 
-    for (int y = 0; y < bitmap.height(); ++y) {
-        auto* scanline = reinterpret_cast<Pixel const*>(bitmap.scanline(y));
+// Rows are stored with this many zero bytes in front of them, so that the pixel to the left of the first one reads as 0
+// without any special casing.
+static constexpr size_t row_padding = bytes_per_vector;
 
-        struct Filter {
-            PNG::FilterType type;
-            ByteBuffer buffer {};
-            int sum = 0;
+ALWAYS_INLINE static u8x16 load(u8 const* bytes)
+{
+    u8x16 vector;
+    __builtin_memcpy(&vector, bytes, sizeof(vector));
+    return vector;
+}
 
-            ErrorOr<void> append(u8 byte)
-            {
-                TRY(buffer.try_append(byte));
-                sum += static_cast<i8>(byte);
-                return {};
-            }
+ALWAYS_INLINE static void store(u8* bytes, u8x16 vector)
+{
+    __builtin_memcpy(bytes, &vector, sizeof(vector));
+}
 
-            ErrorOr<void> append(AK::SIMD::u8x4 simd)
-            {
-                TRY(append(simd[0]));
-                TRY(append(simd[1]));
-                TRY(append(simd[2]));
-                TRY(append(simd[3]));
-                return {};
-            }
-        };
+ALWAYS_INLINE static u8x16 average(u8x16 a, u8x16 b)
+{
+    // The sum Orig(a) + Orig(b) shall be performed without overflow (using at least nine-bit arithmetic).
+    return (a & b) + ((a ^ b) >> 1);
+}
 
-        Filter none_filter { .type = PNG::FilterType::None };
-        TRY(none_filter.buffer.try_ensure_capacity(sizeof(Pixel) * bitmap.width()));
+ALWAYS_INLINE static u8x16 paeth_predictor(u8x16 a, u8x16 b, u8x16 c)
+{
+    auto wide_a = __builtin_convertvector(a, i16x16);
+    auto wide_b = __builtin_convertvector(b, i16x16);
+    auto wide_c = __builtin_convertvector(c, i16x16);
+    auto absolute = [](i16x16 value) {
+        auto sign = value >> 15;
+        return (value ^ sign) - sign;
+    };
 
-        Filter sub_filter { .type = PNG::FilterType::Sub };
-        TRY(sub_filter.buffer.try_ensure_capacity(sizeof(Pixel) * bitmap.width()));
+    // These are |p - a|, |p - b| and |p - c| for p = a + b - c.
+    auto pa = absolute(wide_b - wide_c);
+    auto pb = absolute(wide_a - wide_c);
+    auto pc = absolute(wide_a + wide_b - wide_c - wide_c);
 
-        Filter up_filter { .type = PNG::FilterType::Up };
-        TRY(up_filter.buffer.try_ensure_capacity(sizeof(Pixel) * bitmap.width()));
+    // NOTE: Comparisons yield -1 for true lanes.
+    i16x16 use_a = (pa <= pb) & (pa <= pc);
+    i16x16 use_b = ~use_a & (pb <= pc);
+    i16x16 use_c = ~(use_a | use_b);
+    return __builtin_convertvector((wide_a & use_a) | (wide_b & use_b) | (wide_c & use_c), u8x16);
+}
 
-        Filter average_filter { .type = PNG::FilterType::Average };
-        TRY(average_filter.buffer.try_ensure_capacity(sizeof(ARGB32) * bitmap.width()));
+class RowFilterer {
+public:
+    static ErrorOr<RowFilterer> create(int width)
+    {
+        auto row_size = static_cast<size_t>(width) * bytes_per_pixel;
+        // The buffers are padded to a whole number of vectors on both ends.
+        auto buffer_size = row_padding + round_up_to_power_of_two(row_size, bytes_per_vector);
+        return RowFilterer { row_size, TRY(ByteBuffer::create_zeroed(buffer_size)), TRY(ByteBuffer::create_zeroed(buffer_size)), TRY(ByteBuffer::create_zeroed(buffer_size * filter_count)) };
+    }
 
-        Filter paeth_filter { .type = PNG::FilterType::Paeth };
-        TRY(paeth_filter.buffer.try_ensure_capacity(sizeof(ARGB32) * bitmap.width()));
+    // Filters the row with every filter type, and appends the one that is most likely to compress best, preceded by
+    // its filter type.
+    ErrorOr<void> append_filtered_row(ARGB32 const* scanline, ByteBuffer& output)
+    {
+        swap(m_row, m_previous_row);
+        // Swapping red and blue works both ways.
+        convert_rgba_to_bgra_scanline(reinterpret_cast<ARGB32*>(row()), scanline, m_row_size / bytes_per_pixel);
 
-        auto pixel_x_minus_1 = Pixel::gfx_to_png(dummy_scanline[0]);
-        auto pixel_xy_minus_1 = Pixel::gfx_to_png(dummy_scanline[0]);
+        filter_vectors();
+        filter_tail();
 
-        for (int x = 0; x < bitmap.width(); ++x) {
-            auto pixel = Pixel::gfx_to_png(scanline[x]);
-            auto pixel_y_minus_1 = Pixel::gfx_to_png(scanline_minus_1[x]);
+        // 12.8 Filter selection: https://www.w3.org/TR/PNG/#12Filter-selection
+        // For best compression of truecolour and greyscale images, the recommended approach
+        // is adaptive filtering in which a filter is chosen for each scanline.
+        // NOTE: Rather than the suggested minimum sum of absolute differences, this picks the filter whose output has the
+        //       lowest order-0 entropy. That costs a histogram per filter, but compresses photos about 8% better.
+        size_t best_filter = 0;
+        float best_entropy = entropy(filtered_row(0));
+        for (size_t filter = 1; filter < filter_count; ++filter) {
+            if (auto filter_entropy = entropy(filtered_row(filter)); filter_entropy < best_entropy) {
+                best_filter = filter;
+                best_entropy = filter_entropy;
+            }
+        }
 
-            TRY(none_filter.append(pixel));
+        TRY(output.try_append(static_cast<u8>(best_filter)));
+        TRY(output.try_append(filtered_row(best_filter), m_row_size));
+        return {};
+    }
 
-            TRY(sub_filter.append(pixel - pixel_x_minus_1));
+private:
+    // The filters, in the order of their PNG::FilterType values.
+    static constexpr size_t filter_count = 5;
+
+    RowFilterer(size_t row_size, ByteBuffer row, ByteBuffer previous_row, ByteBuffer filtered_rows)
+        : m_row_size(row_size)
+        , m_row(move(row))
+        , m_previous_row(move(previous_row))
+        , m_filtered_rows(move(filtered_rows))
+    {
+    }
 
-            TRY(up_filter.append(pixel - pixel_y_minus_1));
+    u8* row() { return m_row.data() + row_padding; }
+    u8 const* previous_row() const { return m_previous_row.data() + row_padding; }
+    u8* filtered_row(size_t filter) { return m_filtered_rows.data() + filter * m_row.size(); }
 
-            // The sum Orig(a) + Orig(b) shall be performed without overflow (using at least nine-bit arithmetic).
-            auto sum = AK::SIMD::to_u16x4(pixel_x_minus_1) + AK::SIMD::to_u16x4(pixel_y_minus_1);
-            auto average = AK::SIMD::to_u8x4(sum / 2);
-            TRY(average_filter.append(pixel - average));
+    void filter_vectors()
+    {
+        auto const* x = row();
+        auto const* b = previous_row();
+        for (size_t i = 0; i + bytes_per_vector <= m_row_size; i += bytes_per_vector) {
+            auto pixels = load(x + i);
+            auto left = load(x + i - bytes_per_pixel);
+            auto up = load(b + i);
+            auto up_left = load(b + i - bytes_per_pixel);
+
+            store(filtered_row(to_underlying(PNG::FilterType::None)) + i, pixels);
+            store(filtered_row(to_underlying(PNG::FilterType::Sub)) + i, pixels - left);
+            store(filtered_row(to_underlying(PNG::FilterType::Up)) + i, pixels - up);
+            store(filtered_row(to_underlying(PNG::FilterType::Average)) + i, pixels - average(left, up));
+            store(filtered_row(to_underlying(PNG::FilterType::Paeth)) + i, pixels - paeth_predictor(left, up, up_left));
+        }
+    }
 
-            TRY(paeth_filter.append(pixel - PNG::paeth_predictor(pixel_x_minus_1, pixel_y_minus_1, pixel_xy_minus_1)));
+    void filter_tail()
+    {
+        auto const* x = row();
+        auto const* b = previous_row();
+        for (size_t i = m_row_size - m_row_size % bytes_per_vector; i < m_row_size; ++i) {
+            u8 left = x[i - bytes_per_pixel];
+            u8 up = b[i];
+            u8 up_left = b[i - bytes_per_pixel];
+            filtered_row(to_underlying(PNG::FilterType::None))[i] = x[i];
+            filtered_row(to_underlying(PNG::FilterType::Sub))[i] = x[i] - left;
+            filtered_row(to_underlying(PNG::FilterType::Up))[i] = x[i] - up;
+            filtered_row(to_underlying(PNG::FilterType::Average))[i] = x[i] - (left + up) / 2;
+            filtered_row(to_underlying(PNG::FilterType::Paeth))[i] = x[i] - PNG::paeth_predictor(left, up, up_left);
+        }
+    }
 
-            pixel_x_minus_1 = pixel;
-            pixel_xy_minus_1 = pixel_y_minus_1;
+    // Returns the number of bits an order-0 entropy coder would need for the bytes, up to a constant that is the same for
+    // all rows of the same size: with n bytes of which c_i have the value i, that's n * log2(n) - sum(c_i * log2(c_i)).
+    float entropy(u8 const* bytes) const
+    {
+        // Spread the counts over several histograms, so that runs of the same byte don't wait on each other.
+        Array<Array<u32, 256>, 4> histograms {};
+        size_t i = 0;
+        for (; i + 4 <= m_row_size; i += 4) {
+            ++histograms[0][bytes[i]];
+            ++histograms[1][bytes[i + 1]];
+            ++histograms[2][bytes[i + 2]];
+            ++histograms[3][bytes[i + 3]];
         }
+        for (; i < m_row_size; ++i)
+            ++histograms[0][bytes[i]];
+
+        float sum = 0;
+        for (size_t value = 0; value < 256; ++value) {
+            auto count = histograms[0][value] + histograms[1][value] + histograms[2][value] + histograms[3][value];
+            if (count > 1)
+                sum += count * AK::log2(static_cast<float>(count));
+        }
+        return -sum;
+    }
 
-        scanline_minus_1 = scanline;
+    size_t m_row_size { 0 };
+    ByteBuffer m_row;
+    ByteBuffer m_previous_row;
+    ByteBuffer m_filtered_rows;
+};
 
-        // 12.8 Filter selection: https://www.w3.org/TR/PNG/#12Filter-selection
-        // For best compression of truecolour and greyscale images, the recommended approach
-        // is adaptive filtering in which a filter is chosen for each scanline.
-        // The following simple heuristic has performed well in early tests:
-        // compute the output scanline using all five filters, and select the filter that gives the smallest sum of absolute values of outputs.
-        // (Consider the output bytes as signed differences for this test.)
-        Filter& best_filter = none_filter;
-        if (abs(best_filter.sum) > abs(sub_filter.sum))
-            best_filter = sub_filter;
-        if (abs(best_filter.sum) > abs(up_filter.sum))
-            best_filter = up_filter;
-        if (abs(best_filter.sum) > abs(average_filter.sum))
-            best_filter = average_filter;
-        if (abs(best_filter.sum) > abs(paeth_filter.sum))
-            best_filter = paeth_filter;
-
-        TRY(uncompressed_block_data.try_append(to_underlying(best_filter.type)));
-        TRY(uncompressed_block_data.try_append(best_filter.buffer));
+static Compress::ZlibCompressionLevel zlib_compression_level(PNGWriter::Options::CompressionLevel level)
+{
+    switch (level) {
+    case PNGWriter::Options::CompressionLevel::Fast:
+        return Compress::ZlibCompressionLevel::Fast;
+    case PNGWriter::Options::CompressionLevel::Default:
+        return Compress::ZlibCompressionLevel::Default;
+    case PNGWriter::Options::CompressionLevel::Best:
+        return Compress::ZlibCompressionLevel::Best;
     }
+    VERIFY_NOT_REACHED();
+}
 
-    TRY(png_chunk.compress_and_add(uncompressed_block_data));
+ErrorOr<void> PNGWriter::add_IDAT_chunk(Gfx::Bitmap const& bitmap, Options const& options)
+{
+    PNGChunk png_chunk { "IDAT"_string };
+    TRY(png_chunk.reserve(bitmap.size_in_bytes()));
+
+    ByteBuffer uncompressed_block_data;
+    auto filtered_row_size = 1 + static_cast<size_t>(bitmap.width()) * bytes_per_pixel;
+    TRY(uncompressed_block_data.try_ensure_capacity(filtered_row_size * bitmap.height()));
+
+    auto filterer = TRY(RowFilterer::create(bitmap.width()));
+    for (int y = 0; y < bitmap.height(); ++y)
+        TRY(filterer.append_filtered_row(bitmap.scanline(y), uncompressed_block_data));
+
+    auto compression_level = zlib_compression_level(options.compression_level);
+    if (options.compress_in_parallel) {
+        // Rows only refer to the row above them before compression, so any split is fine. Still, split between rows in
+        // chunks of at least 256 KiB, which keeps the ratio within a few percent of compressing the data in one go.
+        auto rows_per_chunk = max(ceil_div(256 * KiB, filtered_row_size), 1uz);
+        TRY(png_chunk.add(TRY(Compress::ZlibCompressor::compress_all_in_parallel(uncompressed_block_data, rows_per_chunk * filtered_row_size, compression_level))));
+    } else {
+        TRY(png_chunk.add(TRY(Compress::ZlibCompressor::compress_all(uncompressed_block_data, compression_level))));
+    }
     TRY(add_chunk(png_chunk));
     return {};
 }
@@ -276,7 +367,7 @@ ErrorOr<ByteBuffer> PNGWriter::encode(Gfx::Bitmap const& bitmap, Options options
     TRY(writer.add_IHDR_chunk(bitmap.width(), bitmap.height(), 8, PNG::ColorType::TruecolorWithAlpha, 0, 0, 0));
     if (options.icc_data.has_value())
         TRY(writer.add_iCCP_chunk(options.icc_data.value()));
-    TRY(writer.add_IDAT_chunk(bitmap));
+    TRY(writer.add_IDAT_chunk(bitmap, options));
     TRY(writer.add_IEND_chunk());
     return ByteBuffer::copy(writer.m_data);
 }
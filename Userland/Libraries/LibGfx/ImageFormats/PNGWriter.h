@@ -18,9 +18,22 @@ class PNGChunk;
 
 // This is not a nested struct to work around https://llvm.org/PR36684
 struct PNGWriterOptions {
+    enum class CompressionLevel {
+        Fast,
+        Default,
+        Best,
+    };
+
     // Data for the iCCP chunk.
     // FIXME: Allow writing cICP, sRGB, or gAMA instead too.
     Optional<ReadonlyBytes> icc_data;
+
+    // Lower levels trade compression ratio for encoding speed.
+    CompressionLevel compression_level { CompressionLevel::Best };
+
+    // Compresses groups of rows on separate threads (which needs the "thread" pledge on Serenity). The result is
+    // slightly larger, as back references can't reach from one group into the previous one.
+    bool compress_in_parallel { false };
 };
 
 class PNGWriter {
@@ -37,7 +50,7 @@ private:
     ErrorOr<void> add_png_header();
     ErrorOr<void> add_IHDR_chunk(u32 width, u32 height, u8 bit_depth, PNG::ColorType color_type, u8 compression_method, u8 filter_method, u8 interlace_method);
     ErrorOr<void> add_iCCP_chunk(ReadonlyBytes icc_data);
-    ErrorOr<void> add_IDAT_chunk(Gfx::Bitmap const&);
+    ErrorOr<void> add_IDAT_chunk(Gfx::Bitmap const&, Options const&);
     ErrorOr<void> add_IEND_chunk();
 };
 
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGfx/ImageFormats/ScanlineDownscaler.h>
+
+namespace Gfx {
+
+ErrorOr<ScanlineDownscaler> ScanlineDownscaler::create(IntRect region, int factor, BitmapFormat format)
+{
+    if (region.is_empty() || region.x() < 0 || region.y() < 0)
+        return Error::from_string_literal("ScanlineDownscaler: Invalid region");
+    if (factor < 1)
+        return Error::from_string_literal("ScanlineDownscaler: Invalid scale factor");
+
+    auto bitmap = TRY(Bitmap::create(format, scaled_size(region.size(), factor)));
+    Vector<u64> sums;
+    if (factor > 1)
+        TRY(sums.try_resize(bitmap->width() * 4));
+    return ScanlineDownscaler { region, factor, move(bitmap), move(sums) };
+}
+
+ScanlineDownscaler::ScanlineDownscaler(IntRect region, int factor, NonnullRefPtr<Bitmap> bitmap, Vector<u64> sums)
+    : m_region(region)
+    , m_factor(factor)
+    , m_has_alpha(bitmap->has_alpha_channel())
+    , m_bitmap(move(bitmap))
+    , m_sums(move(sums))
+    , m_next_row(region.top())
+{
+}
+
+int ScanlineDownscaler::factor_for_ideal_size(IntSize size, Optional<IntSize> ideal_size)
+{
+    if (!ideal_size.has_value() || ideal_size->width() <= 0 || ideal_size->height() <= 0)
+        return 1;
+    return max(1, min(size.width() / ideal_size->width(), size.height() / ideal_size->height()));
+}
+
+IntSize ScanlineDownscaler::scaled_size(IntSize size, int factor)
+{
+    return { ceil_div(size.width(), factor), ceil_div(size.height(), factor) };
+}
+
+ErrorOr<NonnullRefPtr<Bitmap>> ScanlineDownscaler::downscale(Bitmap const& bitmap, IntRect region, int factor)
+{
+    if (!bitmap.rect().contains(region))
+        return Error::from_string_literal("ScanlineDownscaler: Region is outside of the bitmap");
+
+    auto downscaler = TRY(create(region, factor, bitmap.format()));
+    for (int y = region.top(); y < region.bottom(); ++y)
+        downscaler.add_row(y, bitmap.scanline(y));
+    return downscaler.bitmap();
+}
+
+void ScanlineDownscaler::add_row(int y, ARGB32 const* row)
+{
+    if (!needs_row(y))
+        return;
+    VERIFY(y >= m_next_row);
+    m_next_row = y + 1;
+
+    auto const* source = row + m_region.left();
+    auto const width = m_region.width();
+    auto const output_y = (y - m_region.top()) / m_factor;
+    if (m_factor == 1) {
+        memcpy(m_bitmap->scanline(output_y), source, width * sizeof(ARGB32));
+        return;
+    }
+
+    u64* sums = m_sums.data();
+    for (int x = 0; x < width; x += m_factor, sums += 4) {
+        auto const box_end = min(x + m_factor, width);
+        u64 alpha_sum = 0;
+        u64 red_sum = 0;
+        u64 green_sum = 0;
+        u64 blue_sum = 0;
+        for (int i = x; i < box_end; ++i) {
+            auto const pixel = source[i];
+            u32 const alpha = m_has_alpha ? pixel >> 24 : 0xff;
+            alpha_sum += alpha;
+            red_sum += alpha * ((pixel >> 16) & 0xff);
+            green_sum += alpha * ((pixel >> 8) & 0xff);
+            blue_sum += alpha * (pixel & 0xff);
+        }
+        sums[0] += alpha_sum;
+        sums[1] += red_sum;
+        sums[2] += green_sum;
+        sums[3] += blue_sum;
+    }
+
+    auto const rows_in_box = (y - m_region.top()) % m_factor + 1;
+    if (rows_in_box == m_factor || y == m_region.bottom() - 1)
+        flush_sums(output_y, rows_in_box);
+}
+
+void ScanlineDownscaler::flush_sums(int output_y, int rows_in_box)
+{
+    auto* destination = m_bitmap->scanline(output_y);
+    u64* sums = m_sums.data();
+    for (int x = 0; x < m_bitmap->width(); ++x, sums += 4) {
+        // Boxes on the right and bottom edges may cover fewer pixels.
+        u64 const pixel_count = min(m_factor, m_region.width() - x * m_factor) * rows_in_box;
+        u64 const alpha_sum = sums[0];
+        if (alpha_sum == 0) {
+            destination[x] = 0;
+        } else {
+            auto average = [&](u64 weighted_sum) { return static_cast<u32>((weighted_sum + alpha_sum / 2) / alpha_sum); };
+            auto const alpha = static_cast<u32>((alpha_sum + pixel_count / 2) / pixel_count);
+            destination[x] = (alpha << 24) | (average(sums[1]) << 16) | (average(sums[2]) << 8) | average(sums[3]);
+        }
+        sums[0] = sums[1] = sums[2] = sums[3] = 0;
+    }
+}
+
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Rect.h>
+
+namespace Gfx {
+
+// Crops an image to a region and scales it down by an integer factor while it is being decoded, one scanline at a time,
+// so that the full-size image never has to be held in memory. Each resulting pixel is the alpha-weighted average of the
+// (up to) factor x factor pixels it covers.
+class ScanlineDownscaler {
+public:
+    static ErrorOr<ScanlineDownscaler> create(IntRect region, int factor, BitmapFormat);
+
+    // Returns the largest factor that still scales `size` down to at least `ideal_size`.
+    static int factor_for_ideal_size(IntSize size, Optional<IntSize> ideal_size);
+    static IntSize scaled_size(IntSize, int factor);
+
+    static ErrorOr<NonnullRefPtr<Bitmap>> downscale(Bitmap const&, IntRect region, int factor);
+
+    IntRect const& region() const { return m_region; }
+    bool needs_row(int y) const { return y >= m_region.top() && y < m_region.bottom(); }
+    bool is_complete() const { return m_next_row >= m_region.bottom(); }
+
+    // Rows must be added from top to bottom, and hold (at least) the first region().right() pixels of the row. Rows
+    // outside the region are ignored.
+    void add_row(int y, ARGB32 const* row);
+
+    NonnullRefPtr<Bitmap> bitmap() const { return m_bitmap; }
+
+private:
+    ScanlineDownscaler(IntRect region, int factor, NonnullRefPtr<Bitmap>, Vector<u64> sums);
+
+    void flush_sums(int output_y, int rows_in_box);
+
+    IntRect m_region;
+    int m_factor { 1 };
+    bool m_has_alpha { false };
+    NonnullRefPtr<Bitmap> m_bitmap;
+
+    // Alpha, and alpha-weighted red, green and blue sums of each output pixel of the current row.
+    Vector<u64> m_sums;
+    int m_next_row { 0 };
+};
+
+}
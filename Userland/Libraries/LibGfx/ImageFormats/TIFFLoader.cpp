@@ -8,6 +8,7 @@
 #include <AK/ConstrainedStream.h>
 #include <AK/Debug.h>
 #include <AK/Endian.h>
+#include <AK/ScopeGuard.h>
 #include <AK/String.h>
 #include <LibCompress/Lzw.h>
 #include <LibCompress/PackBitsDecoder.h>
@@ -15,6 +16,7 @@
 #include <LibGfx/CMYKBitmap.h>
 #include <LibGfx/ImageFormats/CCITTDecoder.h>
 #include <LibGfx/ImageFormats/ExifOrientedBitmap.h>
+#include <LibGfx/ImageFormats/ScanlineDownscaler.h>
 #include <LibGfx/ImageFormats/TIFFMetadata.h>
 
 namespace Gfx {
@@ -159,6 +161,31 @@ public:
         return {};
     }
 
+    bool can_decode_region_directly() const
+    {
+        // FIXME: Support regions of rotated and flipped images, and of CMYK images.
+        return m_metadata.orientation().value_or(Orientation::Default) == Orientation::Default
+            && m_metadata.photometric_interpretation() != PhotometricInterpretation::CMYK;
+    }
+
+    // Decodes only the strips or tiles that intersect the region. They are handed to a ScanlineDownscaler one row of
+    // segments at a time, so that no more than a segment's height of the region is ever held at full size.
+    ErrorOr<NonnullRefPtr<Bitmap>> decode_region(IntRect region, int scale_factor)
+    {
+        VERIFY(can_decode_region_directly());
+
+        // The downscaler only ever sees the columns of the region, so its region starts at x = 0.
+        m_region = region;
+        m_region_downscaler = TRY(ScanlineDownscaler::create(region.translated(-region.x(), 0), scale_factor, BitmapFormat::BGRA8888));
+        ScopeGuard clear_region = [&] {
+            m_region.clear();
+            m_region_downscaler.clear();
+        };
+
+        TRY(decode_frame());
+        return m_region_downscaler->bitmap();
+    }
+
     IntSize size() const
     {
         return ExifOrientedBitmap::oriented_size({ *m_metadata.image_width(), *m_metadata.image_length() }, *m_metadata.orientation());
@@ -322,43 +349,84 @@ private:
     {
         auto const offsets = *segment_offsets();
         auto const byte_counts = *segment_byte_counts();
+        auto const image_length = *m_metadata.image_length();
 
-        auto const segment_length = m_metadata.tile_length().value_or(m_metadata.rows_per_strip().value_or(*m_metadata.image_length()));
+        auto const segment_length = m_metadata.tile_length().value_or(m_metadata.rows_per_strip().value_or(image_length));
         auto const segment_width = m_metadata.tile_width().value_or(m_image_width);
         auto const segment_per_rows = m_metadata.tile_width().map([&](u32 w) { return ceil_div(m_image_width, w); }).value_or(1);
 
-        Variant<ExifOrientedBitmap, ExifOrientedCMYKBitmap> oriented_bitmap = TRY(([&]() -> ErrorOr<Variant<ExifOrientedBitmap, ExifOrientedCMYKBitmap>> {
+        u32 bits_per_pixel = 0;
+        for (auto bits : m_bits_per_sample)
+            bits_per_pixel += bits;
+        auto const bytes_per_segment_row = ceil_div(static_cast<u64>(segment_width) * bits_per_pixel, 8ull);
+
+        auto const region = m_region.value_or(IntRect { 0, 0, static_cast<int>(m_image_width), static_cast<int>(image_length) });
+
+        // When decoding a region, the part of each row of segments that is inside the region is collected into a strip,
+        // which is then handed to the downscaler.
+        Variant<ExifOrientedBitmap, ExifOrientedCMYKBitmap, NonnullRefPtr<Bitmap>> destination = TRY(([&]() -> ErrorOr<Variant<ExifOrientedBitmap, ExifOrientedCMYKBitmap, NonnullRefPtr<Bitmap>>> {
+            if (m_region_downscaler.has_value())
+                return TRY(Bitmap::create(BitmapFormat::BGRA8888, { region.width(), static_cast<int>(min(segment_length, static_cast<u32>(region.height()))) }));
             if (m_photometric_interpretation == PhotometricInterpretation::CMYK)
-                return ExifOrientedCMYKBitmap::create(*metadata().orientation(), { m_image_width, *metadata().image_length() });
-            return ExifOrientedBitmap::create(*metadata().orientation(), { m_image_width, *metadata().image_length() }, BitmapFormat::BGRA8888);
+                return ExifOrientedCMYKBitmap::create(*metadata().orientation(), { m_image_width, image_length });
+            return ExifOrientedBitmap::create(*metadata().orientation(), { m_image_width, image_length }, BitmapFormat::BGRA8888);
         }()));
 
+        auto strip_top = [&](u32 segment_top) { return max(segment_top, static_cast<u32>(region.top())); };
+        auto flush_strip = [&](u32 segment_top) {
+            auto& strip = destination.get<NonnullRefPtr<Bitmap>>();
+            auto const strip_bottom = min(segment_top + min(segment_length, image_length), static_cast<u32>(region.bottom()));
+            for (auto row = strip_top(segment_top); row < strip_bottom; ++row)
+                m_region_downscaler->add_row(row, strip->scanline(row - strip_top(segment_top)));
+        };
+
         for (u32 segment_index = 0; segment_index < offsets.size(); ++segment_index) {
+            auto const segment_top = segment_length * (segment_index / segment_per_rows);
+            auto const segment_left = segment_width * (segment_index % segment_per_rows);
+            if (segment_top >= static_cast<u32>(region.bottom()))
+                break;
+
+            bool const is_last_of_row = segment_index % segment_per_rows == segment_per_rows - 1 || segment_index == offsets.size() - 1;
+            IntRect const segment_rect { static_cast<int>(segment_left), static_cast<int>(segment_top), static_cast<int>(segment_width), static_cast<int>(segment_length) };
+            if (!segment_rect.intersects(region)) {
+                if (is_last_of_row && destination.has<NonnullRefPtr<Bitmap>>())
+                    flush_strip(segment_top);
+                continue;
+            }
+
             TRY(m_stream->seek(offsets[segment_index]));
 
-            auto const rows_in_segment = segment_index < offsets.size() - 1 ? segment_length : *m_metadata.image_length() - segment_length * segment_index;
+            // Tiles are always padded to their full length, only the last strip may be shorter.
+            auto const rows_in_segment = is_tiled() ? segment_length : min(segment_length, image_length - segment_top);
             auto const decoded_bytes = TRY(segment_decoder(byte_counts[segment_index], { segment_width, rows_in_segment }));
             auto decoded_segment = make<FixedMemoryStream>(decoded_bytes);
             auto decoded_stream = make<BigEndianInputBitStream>(move(decoded_segment));
 
             for (u32 row = 0; row < segment_length; row++) {
-                auto const image_row = row + segment_length * (segment_index / segment_per_rows);
-                if (image_row >= *m_metadata.image_length())
+                auto const image_row = row + segment_top;
+                if (image_row >= image_length || image_row >= static_cast<u32>(region.bottom()))
                     break;
 
+                // Rows always start on a byte boundary, and the predictor starts over on each row, so rows above the
+                // region can be skipped without looking at their pixels.
+                if (image_row < static_cast<u32>(region.top())) {
+                    TRY(decoded_stream->discard(bytes_per_segment_row));
+                    continue;
+                }
+
                 Optional<Color> last_color {};
 
                 for (u32 column = 0; column < segment_width; ++column) {
                     // If image_length % segment_length != 0, the last tile will be padded.
                     // This variable helps us to skip these last columns. Note that we still
                     // need to read the sample from the stream.
-                    auto const image_column = column + segment_width * (segment_index % segment_per_rows);
+                    auto const image_column = column + segment_left;
 
                     if (m_photometric_interpretation == PhotometricInterpretation::CMYK) {
                         auto const cmyk = TRY(read_color_cmyk(*decoded_stream));
                         if (image_column >= m_image_width)
                             continue;
-                        oriented_bitmap.get<ExifOrientedCMYKBitmap>().set_pixel(image_column, image_row, cmyk);
+                        destination.get<ExifOrientedCMYKBitmap>().set_pixel(image_column, image_row, cmyk);
                     } else {
                         auto color = TRY(read_color(*decoded_stream));
 
@@ -375,18 +443,27 @@ private:
                         last_color = color;
                         if (image_column >= m_image_width)
                             continue;
-                        oriented_bitmap.get<ExifOrientedBitmap>().set_pixel(image_column, image_row, color.value());
+                        destination.visit(
+                            [&](ExifOrientedBitmap& bitmap) { bitmap.set_pixel(image_column, image_row, color.value()); },
+                            [&](NonnullRefPtr<Bitmap>& strip) {
+                                if (region.contains_horizontally(image_column))
+                                    strip->scanline(image_row - strip_top(segment_top))[image_column - region.left()] = color.value();
+                            },
+                            [](ExifOrientedCMYKBitmap&) { VERIFY_NOT_REACHED(); });
                     }
                 }
 
                 decoded_stream->align_to_byte_boundary();
             }
+
+            if (is_last_of_row && destination.has<NonnullRefPtr<Bitmap>>())
+                flush_strip(segment_top);
         }
 
-        if (m_photometric_interpretation == PhotometricInterpretation::CMYK)
-            m_cmyk_bitmap = oriented_bitmap.get<ExifOrientedCMYKBitmap>().bitmap();
-        else
-            m_bitmap = oriented_bitmap.get<ExifOrientedBitmap>().bitmap();
+        destination.visit(
+            [&](ExifOrientedBitmap& bitmap) { m_bitmap = bitmap.bitmap(); },
+            [&](ExifOrientedCMYKBitmap& bitmap) { m_cmyk_bitmap = bitmap.bitmap(); },
+            [](NonnullRefPtr<Bitmap>&) {});
 
         return {};
     }
@@ -739,6 +816,10 @@ private:
     Predictor m_predictor {};
 
     Optional<u8> m_alpha_channel_index {};
+
+    // Only set while decoding a region.
+    Optional<IntRect> m_region {};
+    Optional<ScanlineDownscaler> m_region_downscaler {};
 };
 
 }
@@ -770,7 +851,19 @@ ErrorOr<NonnullOwnPtr<ImageDecoderPlugin>> TIFFImageDecoderPlugin::create(Readon
     return plugin;
 }
 
-ErrorOr<ImageFrameDescriptor> TIFFImageDecoderPlugin::frame(size_t index, Optional<IntSize>)
+ErrorOr<ImageFrameDescriptor> TIFFImageDecoderPlugin::frame_region(size_t index, IntRect region, Optional<IntSize> ideal_size)
+{
+    if (index > 0 || !m_context->can_decode_region_directly())
+        return ImageDecoderPlugin::frame_region(index, region, ideal_size);
+
+    if (m_context->state() == TIFF::TIFFLoadingContext::State::Error)
+        return Error::from_string_literal("TIFFImageDecoderPlugin: Decoding failed");
+
+    auto scale_factor = ScanlineDownscaler::factor_for_ideal_size(region.size(), ideal_size);
+    return ImageFrameDescriptor { TRY(m_context->decode_region(region, scale_factor)), 0 };
+}
+
+ErrorOr<ImageFrameDescriptor> TIFFImageDecoderPlugin::frame(size_t index, Optional<IntSize> ideal_size)
 {
     if (index > 0)
         return Error::from_string_literal("TIFFImageDecoderPlugin: Invalid frame index");
@@ -778,6 +871,10 @@ ErrorOr<ImageFrameDescriptor> TIFFImageDecoderPlugin::frame(size_t index, Option
     if (m_context->state() == TIFF::TIFFLoadingContext::State::Error)
         return Error::from_string_literal("TIFFImageDecoderPlugin: Decoding failed");
 
+    // Images that are wanted at a smaller size are scaled down while decoding, and never kept at full size.
+    if (ScanlineDownscaler::factor_for_ideal_size(size(), ideal_size) > 1 && m_context->can_decode_region_directly())
+        return frame_region(index, { {}, size() }, ideal_size);
+
     if (m_context->state() < TIFF::TIFFLoadingContext::State::FrameDecoded)
         TRY(m_context->decode_frame());
 
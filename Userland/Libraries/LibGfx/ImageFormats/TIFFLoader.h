@@ -43,6 +43,7 @@ public:
     virtual IntSize size() override;
 
     virtual ErrorOr<ImageFrameDescriptor> frame(size_t index, Optional<IntSize> ideal_size = {}) override;
+    virtual ErrorOr<ImageFrameDescriptor> frame_region(size_t index, IntRect region, Optional<IntSize> ideal_size = {}) override;
 
     virtual Optional<Metadata const&> metadata() override;
     virtual ErrorOr<Optional<ReadonlyBytes>> icc_data() override;
@@ -10,6 +10,7 @@
 #include <AK/MemoryStream.h>
 #include <AK/Vector.h>
 #include <LibGfx/FourCC.h>
+#include <LibGfx/ImageFormats/ScanlineDownscaler.h>
 #include <LibGfx/ImageFormats/WebPLoader.h>
 #include <LibGfx/ImageFormats/WebPLoaderLossless.h>
 #include <LibGfx/ImageFormats/WebPLoaderLossy.h>
@@ -672,7 +673,49 @@ size_t WebPImageDecoderPlugin::first_animated_frame_index()
     return 0;
 }
 
-ErrorOr<ImageFrameDescriptor> WebPImageDecoderPlugin::frame(size_t index, Optional<IntSize>)
+// Lossy images without alpha can be decoded a scanline at a time, which allows decoding only a region or scaling them
+// down while decoding. Returns nothing for all other images, and for images that have been fully decoded already.
+static ErrorOr<Optional<VP8Header>> vp8_header_for_scanline_decoding(WebPLoadingContext& context)
+{
+    if (context.state < WebPLoadingContext::State::ChunksDecoded)
+        TRY(decode_webp_chunks(context));
+
+    bool is_animated = context.first_chunk->id() == "VP8X"sv && context.vp8x_header.has_animation;
+    if (is_animated || context.state >= WebPLoadingContext::State::BitmapDecoded)
+        return OptionalNone {};
+
+    auto const& image_data = context.image_data.value();
+    if (image_data.image_data_chunk.id() != "VP8 "sv || image_data.alpha_chunk.has_value())
+        return OptionalNone {};
+
+    auto vp8_header = TRY(decode_webp_chunk_VP8_header(image_data.image_data_chunk.data()));
+    if (context.first_chunk->id() == "VP8X") {
+        if (vp8_header.width != context.vp8x_header.width || vp8_header.height != context.vp8x_header.height)
+            return Error::from_string_literal("WebPImageDecoderPlugin: VP8X and VP8/VP8L chunks store different dimensions");
+    }
+    return vp8_header;
+}
+
+ErrorOr<ImageFrameDescriptor> WebPImageDecoderPlugin::frame_region(size_t index, IntRect region, Optional<IntSize> ideal_size)
+{
+    if (m_context->state == WebPLoadingContext::State::Error)
+        return Error::from_string_literal("WebPImageDecoderPlugin: Decoding failed");
+
+    auto vp8_header_or_error = vp8_header_for_scanline_decoding(*m_context);
+    if (vp8_header_or_error.is_error()) {
+        m_context->state = WebPLoadingContext::State::Error;
+        return vp8_header_or_error.release_error();
+    }
+    auto vp8_header = vp8_header_or_error.release_value();
+
+    if (index > 0 || !vp8_header.has_value())
+        return ImageDecoderPlugin::frame_region(index, region, ideal_size);
+
+    auto scale_factor = ScanlineDownscaler::factor_for_ideal_size(region.size(), ideal_size);
+    return ImageFrameDescriptor { TRY(decode_webp_chunk_VP8_contents(*vp8_header, false, region, scale_factor)), 0 };
+}
+
+ErrorOr<ImageFrameDescriptor> WebPImageDecoderPlugin::frame(size_t index, Optional<IntSize> ideal_size)
 {
     if (index >= frame_count())
         return Error::from_string_literal("WebPImageDecoderPlugin: Invalid frame index");
@@ -680,6 +723,17 @@ ErrorOr<ImageFrameDescriptor> WebPImageDecoderPlugin::frame(size_t index, Option
     if (m_context->state == WebPLoadingContext::State::Error)
         return Error::from_string_literal("WebPImageDecoderPlugin: Decoding failed");
 
+    // Images that are wanted at a smaller size are scaled down while decoding, and never kept at full size.
+    if (index == 0 && ScanlineDownscaler::factor_for_ideal_size(size(), ideal_size) > 1) {
+        auto vp8_header_or_error = vp8_header_for_scanline_decoding(*m_context);
+        if (vp8_header_or_error.is_error()) {
+            m_context->state = WebPLoadingContext::State::Error;
+            return vp8_header_or_error.release_error();
+        }
+        if (vp8_header_or_error.value().has_value())
+            return frame_region(index, { {}, size() }, ideal_size);
+    }
+
     // In a lambda so that only one check to set State::Error is needed, instead of one per TRY.
     auto decode_frame = [this](size_t index) -> ErrorOr<ImageFrameDescriptor> {
         if (m_context->state < WebPLoadingContext::State::ChunksDecoded)
@@ -10,6 +10,7 @@
 #include <AK/MemoryStream.h>
 #include <AK/Vector.h>
 #include <LibGfx/ImageFormats/BooleanDecoder.h>
+#include <LibGfx/ImageFormats/ScanlineDownscaler.h>
 #include <LibGfx/ImageFormats/WebPLoaderLossy.h>
 #include <LibGfx/ImageFormats/WebPLoaderLossyTables.h>
 
@@ -1135,7 +1136,7 @@ void convert_yuv_to_rgb(Bitmap& bitmap, int mb_x, int mb_y, ReadonlyBytes y_data
     }
 }
 
-ErrorOr<void> decode_VP8_image_data(Gfx::Bitmap& bitmap, FrameHeader const& header, Vector<ReadonlyBytes> data_partitions, int macroblock_width, int macroblock_height, Vector<MacroblockMetadata> const& macroblock_metadata)
+ErrorOr<void> decode_VP8_image_data(ScanlineDownscaler& downscaler, FrameHeader const& header, Vector<ReadonlyBytes> data_partitions, int macroblock_width, int macroblock_height, Vector<MacroblockMetadata> const& macroblock_metadata)
 {
 
     Vector<BooleanDecoder> streams;
@@ -1162,8 +1163,14 @@ ErrorOr<void> decode_VP8_image_data(Gfx::Bitmap& bitmap, FrameHeader const& head
     for (size_t i = 0; i < predicted_v_above.size(); ++i)
         predicted_v_above[i] = 127;
 
+    // Each row of macroblocks is converted to RGB into this, and then handed to the downscaler a scanline at a time.
+    // Macroblocks that don't intersect the region are still decoded, as later ones are predicted from them, but not converted.
+    auto strip = TRY(Bitmap::create(downscaler.bitmap()->format(), { macroblock_width * 16, 16 }));
+    auto const& region = downscaler.region();
+
     for (int mb_y = 0, macroblock_index = 0; mb_y < macroblock_height; ++mb_y) {
         BooleanDecoder& decoder = streams[mb_y % streams.size()];
+        bool const is_row_in_region = mb_y * 16 < region.bottom() && (mb_y + 1) * 16 > region.top();
 
         coefficient_reading_context.start_new_row();
 
@@ -1196,7 +1203,8 @@ ErrorOr<void> decode_VP8_image_data(Gfx::Bitmap& bitmap, FrameHeader const& head
 
             // FIXME: insert loop filtering here
 
-            convert_yuv_to_rgb(bitmap, mb_x, mb_y, y_data, u_data, v_data);
+            if (is_row_in_region && mb_x * 16 < region.right() && (mb_x + 1) * 16 > region.left())
+                convert_yuv_to_rgb(*strip, mb_x, 0, y_data, u_data, v_data);
 
             y_truemotion_corner = predicted_y_above[mb_x * 16 + 15];
             for (int i = 0; i < 16; ++i)
@@ -1216,6 +1224,15 @@ ErrorOr<void> decode_VP8_image_data(Gfx::Bitmap& bitmap, FrameHeader const& head
             for (int i = 0; i < 8; ++i)
                 predicted_v_above[mb_x * 8 + i] = v_data[7 * 8 + i];
         }
+
+        if (is_row_in_region) {
+            for (int y = 0; y < 16; ++y)
+                downscaler.add_row(mb_y * 16 + y, strip->scanline(y));
+        }
+
+        // Nothing below the region is needed.
+        if (downscaler.is_complete())
+            return {};
     }
 
     for (auto& decoder : streams)
@@ -1260,7 +1277,7 @@ static ErrorOr<Vector<ReadonlyBytes>> split_data_partitions(ReadonlyBytes second
 
 }
 
-ErrorOr<NonnullRefPtr<Bitmap>> decode_webp_chunk_VP8_contents(VP8Header const& vp8_header, bool include_alpha_channel)
+ErrorOr<NonnullRefPtr<Bitmap>> decode_webp_chunk_VP8_contents(VP8Header const& vp8_header, bool include_alpha_channel, Optional<IntRect> region, int scale_factor)
 {
     // The first partition stores header, per-segment state, and macroblock metadata.
     auto decoder = TRY(BooleanDecoder::initialize(vp8_header.first_partition));
@@ -1279,17 +1296,17 @@ ErrorOr<NonnullRefPtr<Bitmap>> decode_webp_chunk_VP8_contents(VP8Header const& v
     TRY(decoder.finish_decode());
     // Done with the first partition!
 
+    auto width = static_cast<int>(vp8_header.width);
+    auto height = static_cast<int>(vp8_header.height);
+    if (region.has_value() && !IntRect { 0, 0, width, height }.contains(*region))
+        return Error::from_string_literal("WebPImageDecoderPlugin: Region is outside of the image");
+
     auto bitmap_format = include_alpha_channel ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888;
-    auto bitmap = TRY(Bitmap::create(bitmap_format, { macroblock_width * 16, macroblock_height * 16 }));
+    auto downscaler = TRY(ScanlineDownscaler::create(region.value_or({ 0, 0, width, height }), scale_factor, bitmap_format));
 
     auto data_partitions = TRY(split_data_partitions(vp8_header.second_partition, header.number_of_dct_partitions));
-    TRY(decode_VP8_image_data(*bitmap, header, move(data_partitions), macroblock_width, macroblock_height, macroblock_metadata));
-
-    auto width = static_cast<int>(vp8_header.width);
-    auto height = static_cast<int>(vp8_header.height);
-    if (bitmap->physical_size() == IntSize { width, height })
-        return bitmap;
-    return bitmap->cropped({ 0, 0, width, height });
+    TRY(decode_VP8_image_data(downscaler, header, move(data_partitions), macroblock_width, macroblock_height, macroblock_metadata));
+    return downscaler.bitmap();
 }
 
 }
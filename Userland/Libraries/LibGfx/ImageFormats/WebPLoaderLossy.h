@@ -9,6 +9,7 @@
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <LibGfx/Bitmap.h>
+#include <LibGfx/Rect.h>
 
 namespace Gfx {
 
@@ -27,6 +28,8 @@ struct VP8Header {
 // Parses the header data in a VP8 chunk. Pass the payload of a `VP8 ` chunk, after the tag and after the tag's data size.
 ErrorOr<VP8Header> decode_webp_chunk_VP8_header(ReadonlyBytes vp8_data);
 
-ErrorOr<NonnullRefPtr<Bitmap>> decode_webp_chunk_VP8_contents(VP8Header const&, bool include_alpha_channel);
+// If `region` is given, only that part of the image is decoded (skipping all macroblock rows below it), and the result is
+// scaled down by `scale_factor`.
+ErrorOr<NonnullRefPtr<Bitmap>> decode_webp_chunk_VP8_contents(VP8Header const&, bool include_alpha_channel, Optional<IntRect> region = {}, int scale_factor = 1);
 
 }
@@ -30,6 +30,7 @@
 #include <LibGfx/Palette.h>
 #include <LibGfx/Path.h>
 #include <LibGfx/Quad.h>
+#include <LibGfx/ScanlineKernels.h>
 #include <LibGfx/TextDirection.h>
 #include <LibGfx/TextLayout.h>
 #include <LibUnicode/CharacterTypes.h>
@@ -108,10 +109,10 @@ void Painter::fill_physical_rect(IntRect const& physical_rect, Color color)
     ARGB32* dst = m_target->scanline(physical_rect.top()) + physical_rect.left();
     size_t const dst_skip = m_target->pitch() / sizeof(ARGB32);
 
-    auto dst_format = target()->format();
+    auto dst_has_alpha = target()->format() == BitmapFormat::BGRA8888;
+    VERIFY(dst_has_alpha || target()->format() == BitmapFormat::BGRx8888);
     for (int i = physical_rect.height() - 1; i >= 0; --i) {
-        for (int j = 0; j < physical_rect.width(); ++j)
-            dst[j] = color_for_format(dst_format, dst[j]).blend(color).value();
+        blend_color_over_scanline(dst, physical_rect.width(), color, dst_has_alpha);
         dst += dst_skip;
     }
 }
@@ -824,39 +825,28 @@ struct BlitState {
     BitmapFormat src_format;
 };
 
-// FIXME: This is a hack to support blit_with_opacity() with RGBA8888 source.
-//        Ideally we'd have a more generic solution that allows any source format.
-static void swap_red_and_blue_channels(Color& color)
-{
-    u32 rgba = color.value();
-    u32 bgra = (rgba & 0xff00ff00)
-        | ((rgba & 0x000000ff) << 16)
-        | ((rgba & 0x00ff0000) >> 16);
-    color = Color::from_argb(bgra);
-}
-
-// FIXME: This function is very unoptimized.
 template<BlitState::AlphaState has_alpha>
 static void do_blit_with_opacity(BlitState& state)
 {
-    for (int row = 0; row < state.row_count; ++row) {
-        for (int x = 0; x < state.column_count; ++x) {
-            Color dest_color = (has_alpha & BlitState::DstAlpha) ? Color::from_argb(state.dst[x]) : Color::from_rgb(state.dst[x]);
-            if constexpr (has_alpha & BlitState::SrcAlpha) {
-                Color src_color_with_alpha = Color::from_argb(state.src[x]);
-                if (state.src_format == BitmapFormat::RGBA8888)
-                    swap_red_and_blue_channels(src_color_with_alpha);
-                float pixel_opacity = src_color_with_alpha.alpha() / 255.0;
-                src_color_with_alpha.set_alpha(255 * (state.opacity * pixel_opacity));
-                state.dst[x] = dest_color.blend(src_color_with_alpha).value();
-            } else {
-                Color src_color_with_alpha = Color::from_rgb(state.src[x]);
-                if (state.src_format == BitmapFormat::RGBA8888)
-                    swap_red_and_blue_channels(src_color_with_alpha);
-                src_color_with_alpha.set_alpha(state.opacity * 255);
-                state.dst[x] = dest_color.blend(src_color_with_alpha).value();
-            }
+    // The source alpha is scaled by the opacity, rounded the same way as it always has been.
+    Array<u8, 256> alpha_table;
+    for (size_t alpha = 0; alpha < alpha_table.size(); ++alpha) {
+        if constexpr (has_alpha & BlitState::SrcAlpha) {
+            float pixel_opacity = alpha / 255.0;
+            alpha_table[alpha] = 255 * (state.opacity * pixel_opacity);
+        } else {
+            alpha_table[alpha] = state.opacity * 255;
         }
+    }
+
+    ScanlineBlendOptions options {
+        .source_is_rgba = state.src_format == BitmapFormat::RGBA8888,
+        .source_has_alpha = (has_alpha & BlitState::SrcAlpha) != 0,
+        .destination_has_alpha = (has_alpha & BlitState::DstAlpha) != 0,
+        .source_alpha_table = alpha_table.data(),
+    };
+    for (int row = 0; row < state.row_count; ++row) {
+        blend_scanline(state.dst, state.src, state.column_count, options);
         state.dst += state.dst_pitch;
         state.src += state.src_pitch;
     }
@@ -1091,13 +1081,7 @@ void Painter::blit(IntPoint position, Gfx::Bitmap const& source, IntRect const&
         u32 const* src = source.scanline(src_rect.top() + first_row) + src_rect.left() + first_column;
         size_t const src_skip = source.pitch() / sizeof(u32);
         for (int row = first_row; row < last_row; ++row) {
-            for (int i = 0; i < clipped_rect.width(); ++i) {
-                u32 rgba = src[i];
-                u32 bgra = (rgba & 0xff00ff00)
-                    | ((rgba & 0x000000ff) << 16)
-                    | ((rgba & 0x00ff0000) >> 16);
-                dst[i] = bgra;
-            }
+            convert_rgba_to_bgra_scanline(dst, src, clipped_rect.width());
             dst += dst_skip;
             src += src_skip;
         }
@@ -1220,8 +1204,12 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, IntRect con
     i64 src_left = src_rect.left() * shift;
     i64 src_top = src_rect.top() * shift;
 
+    // Each row is sampled into a buffer first, so that it can be composited onto the target all at once.
+    Vector<ARGB32> sampled_row;
+    sampled_row.resize(clipped_rect.width());
+
     for (int y = clipped_rect.top(); y < clipped_rect.bottom(); ++y) {
-        auto* scanline = reinterpret_cast<Color*>(target.scanline(y));
+        auto* scanline = target.scanline(y) + clipped_rect.left();
         auto desired_y = (y - dst_rect.y()) * vscale + src_top;
 
         for (int x = clipped_rect.left(); x < clipped_rect.right(); ++x) {
@@ -1245,10 +1233,7 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, IntRect con
                 auto bottom_left = get_pixel(source, scaled_x0, scaled_y1);
                 auto bottom_right = get_pixel(source, scaled_x1, scaled_y1);
 
-                auto top = top_left.mixed_with(top_right, x_ratio);
-                auto bottom = bottom_left.mixed_with(bottom_right, x_ratio);
-
-                src_pixel = top.mixed_with(bottom, y_ratio);
+                src_pixel = bilinear_blend(top_left, top_right, bottom_left, bottom_right, x_ratio, y_ratio);
             } else if constexpr (scaling_mode == Painter::ScalingMode::SmoothPixels) {
                 auto scaled_x1 = clamp(desired_x >> 32, clipped_src_rect.left(), clipped_src_rect.right() - 1);
                 auto scaled_x0 = clamp(scaled_x1 - 1, clipped_src_rect.left(), clipped_src_rect.right() - 1);
@@ -1266,10 +1251,7 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, IntRect con
                 auto bottom_left = get_pixel(source, scaled_x0, scaled_y1);
                 auto bottom_right = get_pixel(source, scaled_x1, scaled_y1);
 
-                auto top = top_left.mixed_with(top_right, scaled_x_ratio);
-                auto bottom = bottom_left.mixed_with(bottom_right, scaled_x_ratio);
-
-                src_pixel = top.mixed_with(bottom, scaled_y_ratio);
+                src_pixel = bilinear_blend(top_left, top_right, bottom_left, bottom_right, scaled_x_ratio, scaled_y_ratio);
             } else {
                 auto scaled_x = clamp(desired_x >> 32, clipped_src_rect.left(), clipped_src_rect.right() - 1);
                 auto scaled_y = clamp(desired_y >> 32, clipped_src_rect.top(), clipped_src_rect.bottom() - 1);
@@ -1279,11 +1261,13 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, IntRect con
             if (has_opacity)
                 src_pixel.set_alpha(src_pixel.alpha() * opacity);
 
-            if constexpr (has_alpha_channel)
-                scanline[x] = scanline[x].blend(src_pixel);
-            else
-                scanline[x] = src_pixel;
+            sampled_row[x - clipped_rect.left()] = src_pixel.value();
         }
+
+        if constexpr (has_alpha_channel)
+            blend_scanline(scanline, sampled_row.data(), sampled_row.size());
+        else
+            memcpy(scanline, sampled_row.data(), sampled_row.size() * sizeof(ARGB32));
     }
 }
 
@@ -1370,17 +1354,17 @@ FLATTEN void Painter::draw_glyph(FloatPoint point, u32 code_point, Font const& f
         draw_bitmap(top_left.to_type<int>(), glyph.glyph_bitmap(), color);
     } else if (glyph.is_color_bitmap()) {
         float scaled_width = glyph.advance();
-        float ratio = static_cast<float>(glyph.bitmap()->height()) / static_cast<float>(glyph.bitmap()->width());
+        float ratio = static_cast<float>(glyph.bitmap_rect().height()) / static_cast<float>(glyph.bitmap_rect().width());
         float scaled_height = scaled_width * ratio;
 
         FloatRect rect(point.x(), point.y(), scaled_width, scaled_height);
-        draw_scaled_bitmap(rect.to_rounded<int>(), *glyph.bitmap(), glyph.bitmap()->rect(), 1.0f, ScalingMode::BilinearBlend);
+        draw_scaled_bitmap(rect.to_rounded<int>(), *glyph.bitmap(), glyph.bitmap_rect(), 1.0f, ScalingMode::BilinearBlend);
     } else if (color.alpha() != 255) {
-        blit_filtered(glyph_position.blit_position, *glyph.bitmap(), glyph.bitmap()->rect(), [color](Color pixel) -> Color {
+        blit_filtered(glyph_position.blit_position, *glyph.bitmap(), glyph.bitmap_rect(), [color](Color pixel) -> Color {
             return pixel.multiply(color);
         });
     } else {
-        blit_filtered(glyph_position.blit_position, *glyph.bitmap(), glyph.bitmap()->rect(), [color](Color pixel) -> Color {
+        blit_filtered(glyph_position.blit_position, *glyph.bitmap(), glyph.bitmap_rect(), [color](Color pixel) -> Color {
             return color.with_alpha(pixel.alpha());
         });
     }
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/BitCast.h>
+#include <AK/SIMD.h>
+#include <AK/SIMDExtras.h>
+#include <LibGfx/ScanlineKernels.h>
+
+#if defined(AK_COMPILER_GCC)
+#    pragma GCC optimize("O3")
+#endif
+
+namespace Gfx {
+
+using AK::SIMD::all;
+using AK::SIMD::f32x4;
+using AK::SIMD::i32x4;
+using AK::SIMD::u16x16;
+using AK::SIMD::u32x4;
+using AK::SIMD::u8x16;
+
+static constexpr size_t pixels_per_vector = 4;
+
+ALWAYS_INLINE static u32x4 load_pixels(u32 const* pixels)
+{
+    u32x4 vector;
+    __builtin_memcpy(&vector, pixels, sizeof(vector));
+    return vector;
+}
+
+ALWAYS_INLINE static void store_pixels(u32* pixels, u32x4 vector)
+{
+    __builtin_memcpy(pixels, &vector, sizeof(vector));
+}
+
+ALWAYS_INLINE static u32 swap_red_and_blue(u32 pixel)
+{
+    return (pixel & 0xff00ff00) | ((pixel & 0x000000ff) << 16) | ((pixel & 0x00ff0000) >> 16);
+}
+
+ALWAYS_INLINE static u32x4 swap_red_and_blue(u32x4 pixels)
+{
+    return (pixels & 0xff00ff00) | ((pixels & 0x000000ff) << 16) | ((pixels & 0x00ff0000) >> 16);
+}
+
+// Divides the numerators by the denominators, rounding towards zero like integer division does. All numerators must be
+// below 2^24, so that they are exactly representable as floats, and all denominators must be positive.
+ALWAYS_INLINE static i32x4 divide(i32x4 numerators, i32x4 denominators, f32x4 reciprocals)
+{
+    auto quotients = __builtin_convertvector(__builtin_convertvector(numerators, f32x4) * reciprocals, i32x4);
+    // The floating point estimate is off by at most one, so correct it in either direction.
+    // NOTE: Comparisons yield -1 for true lanes.
+    quotients += quotients * denominators > numerators;
+    quotients -= (quotients + 1) * denominators <= numerators;
+    return quotients;
+}
+
+// Color::blend(), for four pixels at a time.
+ALWAYS_INLINE static u32x4 blend_general(u32x4 destination, u32x4 source)
+{
+    auto destination_alpha = __builtin_convertvector(destination >> 24, i32x4);
+    auto source_alpha = __builtin_convertvector(source >> 24, i32x4);
+
+    // NOTE: Color::blend() returns early if either alpha is 0 or the source alpha is 255, but the general formula gives
+    //       the same result in all of those cases, except for when both alphas are 0 and d is 0.
+    i32x4 d = 255 * (destination_alpha + source_alpha) - destination_alpha * source_alpha;
+    auto d_is_zero = d == 0;
+    auto safe_d = d - d_is_zero;
+    auto reciprocals = 1.0f / __builtin_convertvector(safe_d, f32x4);
+
+    auto destination_weight = destination_alpha * (255 - source_alpha);
+    auto source_weight = 255 * source_alpha;
+
+    auto blend_channel = [&](int shift) {
+        auto destination_channel = __builtin_convertvector((destination >> shift) & 0xff, i32x4);
+        auto source_channel = __builtin_convertvector((source >> shift) & 0xff, i32x4);
+        return divide(destination_channel * destination_weight + source_channel * source_weight, safe_d, reciprocals);
+    };
+
+    auto red = blend_channel(16);
+    auto green = blend_channel(8);
+    auto blue = blend_channel(0);
+    // d / 255, exact for all d below 2^16.
+    auto alpha = (d * 0x8081) >> 23;
+
+    auto blended = __builtin_convertvector((alpha << 24) | (red << 16) | (green << 8) | blue, u32x4);
+    auto keep_source = __builtin_convertvector(d_is_zero, u32x4);
+    return (source & keep_source) | (blended & ~keep_source);
+}
+
+// Color::blend() for four pixels over opaque destination pixels, where it simplifies to
+// (destination * (255 - alpha) + source * alpha) / 255 for each color channel. This fits in 16 bits per channel.
+ALWAYS_INLINE static u32x4 blend_over_opaque(u32x4 destination, u32x4 source)
+{
+    auto source_alpha = source >> 24;
+    source_alpha |= source_alpha << 8;
+    source_alpha |= source_alpha << 16;
+
+    auto destination_channels = __builtin_convertvector(bit_cast<u8x16>(destination), u16x16);
+    auto source_channels = __builtin_convertvector(bit_cast<u8x16>(source), u16x16);
+    auto alpha_channels = __builtin_convertvector(bit_cast<u8x16>(source_alpha), u16x16);
+
+    u16x16 products = destination_channels * (255 - alpha_channels) + source_channels * alpha_channels;
+    // x / 255, exact for all x below 65535.
+    auto quotients = (products + 1 + (products >> 8)) >> 8;
+    return bit_cast<u32x4>(__builtin_convertvector(quotients, u8x16)) | 0xff000000;
+}
+
+ALWAYS_INLINE static u32x4 blend(u32x4 destination, u32x4 source)
+{
+    auto source_alpha = bit_cast<i32x4>(source >> 24);
+    auto destination_alpha = bit_cast<i32x4>(destination >> 24);
+
+    // Opaque and fully transparent sources are common, as are opaque destinations, and they have much cheaper results.
+    if (all(source_alpha == 255))
+        return source;
+    if (all(source_alpha == 0)) {
+        // NOTE: If both colors are fully transparent, the result is the source color.
+        auto keep_source = bit_cast<u32x4>(destination_alpha == 0);
+        return (source & keep_source) | (destination & ~keep_source);
+    }
+    if (all(destination_alpha == 255))
+        return blend_over_opaque(destination, source);
+    return blend_general(destination, source);
+}
+
+ALWAYS_INLINE static u32x4 apply_alpha_table(u32x4 pixels, u8 const* alpha_table)
+{
+    u32x4 alphas {
+        alpha_table[pixels[0] >> 24],
+        alpha_table[pixels[1] >> 24],
+        alpha_table[pixels[2] >> 24],
+        alpha_table[pixels[3] >> 24],
+    };
+    return (pixels & 0x00ffffff) | (alphas << 24);
+}
+
+void blend_scanline(ARGB32* destination, ARGB32 const* source, size_t count, ScanlineBlendOptions const& options)
+{
+    u32 const source_alpha_mask = options.source_has_alpha ? 0 : 0xff000000;
+    u32 const destination_alpha_mask = options.destination_has_alpha ? 0 : 0xff000000;
+
+    size_t i = 0;
+    for (; i + pixels_per_vector <= count; i += pixels_per_vector) {
+        auto source_pixels = load_pixels(source + i);
+        if (options.source_is_rgba)
+            source_pixels = swap_red_and_blue(source_pixels);
+        source_pixels |= source_alpha_mask;
+        if (options.source_alpha_table)
+            source_pixels = apply_alpha_table(source_pixels, options.source_alpha_table);
+
+        auto destination_pixels = load_pixels(destination + i) | destination_alpha_mask;
+        store_pixels(destination + i, blend(destination_pixels, source_pixels));
+    }
+
+    for (; i < count; ++i) {
+        auto source_pixel = source[i];
+        if (options.source_is_rgba)
+            source_pixel = swap_red_and_blue(source_pixel);
+        auto source_color = Color::from_argb(source_pixel | source_alpha_mask);
+        if (options.source_alpha_table)
+            source_color.set_alpha(options.source_alpha_table[source_color.alpha()]);
+        destination[i] = Color::from_argb(destination[i] | destination_alpha_mask).blend(source_color).value();
+    }
+}
+
+void blend_color_over_scanline(ARGB32* destination, size_t count, Color color, bool destination_has_alpha)
+{
+    u32 const destination_alpha_mask = destination_has_alpha ? 0 : 0xff000000;
+    u32x4 source_pixels = u32x4 {} + color.value();
+
+    size_t i = 0;
+    for (; i + pixels_per_vector <= count; i += pixels_per_vector) {
+        auto destination_pixels = load_pixels(destination + i) | destination_alpha_mask;
+        store_pixels(destination + i, blend(destination_pixels, source_pixels));
+    }
+
+    for (; i < count; ++i)
+        destination[i] = Color::from_argb(destination[i] | destination_alpha_mask).blend(color).value();
+}
+
+void convert_rgba_to_bgra_scanline(ARGB32* destination, u32 const* source, size_t count)
+{
+    size_t i = 0;
+    for (; i + pixels_per_vector <= count; i += pixels_per_vector)
+        store_pixels(destination + i, swap_red_and_blue(load_pixels(source + i)));
+
+    for (; i < count; ++i)
+        destination[i] = swap_red_and_blue(source[i]);
+}
+
+// The channels of a pixel, in the order blue, green, red, alpha.
+ALWAYS_INLINE static f32x4 to_channels(Color color)
+{
+    auto value = color.value();
+    auto channels = u32x4 { value, value >> 8, value >> 16, value >> 24 } & 0xff;
+    return __builtin_convertvector(channels, f32x4);
+}
+
+// Rounds to the nearest integer, with ties to even, and truncates to 8 bits, just like round_to<u8>() does.
+// NOTE: Mixing away from a fully transparent color with a weight of 0 divides by a mixed alpha of 0. Converting the
+//       resulting NaNs yields the same "integer indefinite" value the scalar conversion does, keeping that case bit-exact.
+ALWAYS_INLINE static f32x4 round_channels(f32x4 channels)
+{
+    constexpr float rounding_constant = 12582912.0f; // 1.5 * 2^23
+    auto rounded = (channels + rounding_constant) - rounding_constant;
+    auto truncated = __builtin_convertvector(rounded, i32x4) & 0xff;
+    return __builtin_convertvector(truncated, f32x4);
+}
+
+// Color::mixed_with(), on all channels at once.
+ALWAYS_INLINE static f32x4 mix_channels(f32x4 a, f32x4 b, float weight)
+{
+    if (a[3] == b[3] || (a[0] == b[0] && a[1] == b[1] && a[2] == b[2]))
+        return round_channels(a + (b - a) * weight);
+
+    // Fall back to a premultiplied alpha mix.
+    auto mixed_alpha = a[3] + (b[3] - a[3]) * weight;
+    auto premultiplied_a = a * a[3];
+    auto premultiplied_b = b * b[3];
+    auto mixed = (premultiplied_a + (premultiplied_b - premultiplied_a) * weight) / mixed_alpha;
+    mixed[3] = mixed_alpha;
+    return round_channels(mixed);
+}
+
+Color bilinear_blend(Color top_left, Color top_right, Color bottom_left, Color bottom_right, float x_ratio, float y_ratio)
+{
+    auto top = mix_channels(to_channels(top_left), to_channels(top_right), x_ratio);
+    auto bottom = mix_channels(to_channels(bottom_left), to_channels(bottom_right), x_ratio);
+    auto mixed = __builtin_convertvector(mix_channels(top, bottom, y_ratio), u32x4);
+    return Color::from_argb(mixed[0] | (mixed[1] << 8) | (mixed[2] << 16) | (mixed[3] << 24));
+}
+
+}
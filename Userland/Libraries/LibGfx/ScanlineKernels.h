@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+#include <LibGfx/Color.h>
+
+namespace Gfx {
+
+// Row kernels for the hot loops of Painter. They process several pixels at a time with AK/SIMD.h vector types, and
+// produce exactly the same pixels as the per-pixel Color operations they replace.
+
+struct ScanlineBlendOptions {
+    // The source is in RGBA8888 rather than BGRA8888 or BGRx8888 order.
+    bool source_is_rgba { false };
+    // If false, the alpha channel of the source (or destination) is ignored, and the pixels are treated as opaque.
+    bool source_has_alpha { true };
+    bool destination_has_alpha { true };
+    // If set, each source alpha value `a` is replaced by `source_alpha_table[a]` before blending. This is how opacity
+    // is applied, as the tables reproduce the exact rounding of the callers' scalar code.
+    u8 const* source_alpha_table { nullptr };
+};
+
+// Blends `count` source pixels over the destination pixels, like Color::blend() does.
+void blend_scanline(ARGB32* destination, ARGB32 const* source, size_t count, ScanlineBlendOptions const& = {});
+
+// Blends a single color over `count` destination pixels, like Color::blend() does.
+void blend_color_over_scanline(ARGB32* destination, size_t count, Color, bool destination_has_alpha);
+
+// Converts `count` RGBA8888 pixels to BGRA8888.
+void convert_rgba_to_bgra_scanline(ARGB32* destination, u32 const* source, size_t count);
+
+// Equivalent to `top_left.mixed_with(top_right, x_ratio).mixed_with(bottom_left.mixed_with(bottom_right, x_ratio), y_ratio)`,
+// with the channels of each pixel processed in parallel.
+Color bilinear_blend(Color top_left, Color top_right, Color bottom_left, Color bottom_right, float x_ratio, float y_ratio);
+
+}
@@ -17,6 +17,7 @@
 #include <LibCompress/Brotli.h>
 #include <LibCompress/Gzip.h>
 #include <LibCompress/Zlib.h>
+#include <LibCompress/Zstd.h>
 #include <LibCore/Event.h>
 #include <LibCore/EventLoop.h>
 #include <LibHTTP/HttpResponse.h>
@@ -145,6 +146,17 @@ static ErrorOr<ByteBuffer> handle_content_encoding(ByteBuffer const& buf, ByteSt
             dbgln("  Output size: {}", uncompressed.size());
         }
 
+        return uncompressed;
+    } else if (content_encoding == "zstd") {
+        dbgln_if(JOB_DEBUG, "Job::handle_content_encoding: buf is zstd compressed!");
+
+        auto uncompressed = TRY(Compress::ZstdDecompressor::decompress_all(buf));
+        if constexpr (JOB_DEBUG) {
+            dbgln("Job::handle_content_encoding: Zstd::decompress() successful.");
+            dbgln("  Input size: {}", buf.size());
+            dbgln("  Output size: {}", uncompressed.size());
+        }
+
         return uncompressed;
     }
 
@@ -20,12 +20,16 @@ void Client::die()
         promise->reject(Error::from_string_literal("ImageDecoder disconnected"));
     }
     m_pending_decoded_images.clear();
+    for (auto& pending_frame : m_pending_frames) {
+        pending_frame.promise->reject(Error::from_string_literal("ImageDecoder disconnected"));
+    }
+    m_pending_frames.clear();
 
     if (on_death)
         on_death();
 }
 
-NonnullRefPtr<Core::Promise<DecodedImage>> Client::decode_image(ReadonlyBytes encoded_data, Function<ErrorOr<void>(DecodedImage&)> on_resolved, Function<void(Error&)> on_rejected, Optional<Gfx::IntSize> ideal_size, Optional<ByteString> mime_type)
+NonnullRefPtr<Core::Promise<DecodedImage>> Client::decode_image(ReadonlyBytes encoded_data, Function<ErrorOr<void>(DecodedImage&)> on_resolved, Function<void(Error&)> on_rejected, Optional<Gfx::IntSize> ideal_size, Optional<ByteString> mime_type, Optional<Gfx::IntRect> region)
 {
     auto promise = Core::Promise<DecodedImage>::construct();
     if (on_resolved)
@@ -48,7 +52,7 @@ NonnullRefPtr<Core::Promise<DecodedImage>> Client::decode_image(ReadonlyBytes en
 
     memcpy(encoded_buffer.data<void>(), encoded_data.data(), encoded_data.size());
 
-    auto response = send_sync_but_allow_failure<Messages::ImageDecoderServer::DecodeImage>(move(encoded_buffer), ideal_size, mime_type);
+    auto response = send_sync_but_allow_failure<Messages::ImageDecoderServer::DecodeImage>(move(encoded_buffer), ideal_size, region, mime_type);
     if (!response) {
         dbgln("ImageDecoder disconnected trying to decode image");
         promise->reject(Error::from_string_literal("ImageDecoder disconnected"));
@@ -60,7 +64,28 @@ NonnullRefPtr<Core::Promise<DecodedImage>> Client::decode_image(ReadonlyBytes en
     return promise;
 }
 
-void Client::did_decode_image(i64 image_id, bool is_animated, u32 loop_count, Vector<Gfx::ShareableBitmap> const& bitmaps, Vector<u32> const& durations, Gfx::FloatPoint scale)
+NonnullRefPtr<Core::Promise<Frame>> Client::request_frame(i64 image_id, u32 frame_index, Function<ErrorOr<void>(Frame&)> on_resolved, Function<void(Error&)> on_rejected)
+{
+    auto promise = Core::Promise<Frame>::construct();
+    if (on_resolved)
+        promise->on_resolution = move(on_resolved);
+    if (on_rejected)
+        promise->on_rejection = move(on_rejected);
+
+    if (!post_message(Messages::ImageDecoderServer::RequestFrame(image_id, frame_index)).is_error())
+        m_pending_frames.append({ image_id, frame_index, promise });
+    else
+        promise->reject(Error::from_string_literal("ImageDecoder disconnected"));
+
+    return promise;
+}
+
+void Client::release_image(i64 image_id)
+{
+    async_release_image(image_id);
+}
+
+void Client::did_decode_image(i64 image_id, bool is_animated, u32 loop_count, u32 frame_count, Vector<Gfx::ShareableBitmap> const& bitmaps, Vector<u32> const& durations, Gfx::FloatPoint scale)
 {
     VERIFY(!bitmaps.is_empty());
 
@@ -72,8 +97,10 @@ void Client::did_decode_image(i64 image_id, bool is_animated, u32 loop_count, Ve
     auto promise = maybe_promise.release_value();
 
     DecodedImage image;
+    image.image_id = image_id;
     image.is_animated = is_animated;
     image.loop_count = loop_count;
+    image.frame_count = frame_count;
     image.scale = scale;
     image.frames.ensure_capacity(bitmaps.size());
     for (size_t i = 0; i < bitmaps.size(); ++i) {
@@ -103,4 +130,42 @@ void Client::did_fail_to_decode_image(i64 image_id, String const& error_message)
     promise->reject(Error::from_string_literal("Image decoding failed or aborted"));
 }
 
+Optional<NonnullRefPtr<Core::Promise<Frame>>> Client::take_pending_frame(i64 image_id, u32 frame_index)
+{
+    // Frames of the same image are decoded in the order they were requested in.
+    for (size_t i = 0; i < m_pending_frames.size(); ++i) {
+        if (m_pending_frames[i].image_id == image_id && m_pending_frames[i].frame_index == frame_index)
+            return m_pending_frames.take(i).promise;
+    }
+    dbgln("ImageDecoderClient: No pending frame {} of image with ID {}", frame_index, image_id);
+    return {};
+}
+
+void Client::did_decode_frame(i64 image_id, u32 frame_index, Gfx::ShareableBitmap const& bitmap, u32 duration)
+{
+    auto maybe_promise = take_pending_frame(image_id, frame_index);
+    if (!maybe_promise.has_value())
+        return;
+    auto promise = maybe_promise.release_value();
+
+    if (!bitmap.is_valid()) {
+        dbgln("ImageDecoderClient: Invalid bitmap for frame {} of image with ID {}", frame_index, image_id);
+        promise->reject(Error::from_string_literal("Invalid bitmap"));
+        return;
+    }
+
+    promise->resolve({ *bitmap.bitmap(), duration });
+}
+
+void Client::did_fail_to_decode_frame(i64 image_id, u32 frame_index, String const& error_message)
+{
+    auto maybe_promise = take_pending_frame(image_id, frame_index);
+    if (!maybe_promise.has_value())
+        return;
+    auto promise = maybe_promise.release_value();
+
+    dbgln("ImageDecoderClient: Failed to decode frame {} of image with ID {}: {}", frame_index, image_id, error_message);
+    promise->reject(Error::from_string_literal("Frame decoding failed"));
+}
+
 }
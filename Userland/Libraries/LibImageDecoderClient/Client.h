@@ -20,9 +20,12 @@ struct Frame {
 };
 
 struct DecodedImage {
+    i64 image_id { 0 };
     bool is_animated { false };
     Gfx::FloatPoint scale { 1, 1 };
     u32 loop_count { 0 };
+    u32 frame_count { 0 };
+    // NOTE: Animated images only come with their first frame, the others have to be requested with request_frame().
     Vector<Frame> frames;
 };
 
@@ -34,17 +37,32 @@ class Client final
 public:
     Client(NonnullOwnPtr<Core::LocalSocket>);
 
-    NonnullRefPtr<Core::Promise<DecodedImage>> decode_image(ReadonlyBytes, Function<ErrorOr<void>(DecodedImage&)> on_resolved, Function<void(Error&)> on_rejected, Optional<Gfx::IntSize> ideal_size = {}, Optional<ByteString> mime_type = {});
+    NonnullRefPtr<Core::Promise<DecodedImage>> decode_image(ReadonlyBytes, Function<ErrorOr<void>(DecodedImage&)> on_resolved, Function<void(Error&)> on_rejected, Optional<Gfx::IntSize> ideal_size = {}, Optional<ByteString> mime_type = {}, Optional<Gfx::IntRect> region = {});
+
+    // The decoder of an animated image is kept around by ImageDecoder until the image is released.
+    NonnullRefPtr<Core::Promise<Frame>> request_frame(i64 image_id, u32 frame_index, Function<ErrorOr<void>(Frame&)> on_resolved, Function<void(Error&)> on_rejected);
+    void release_image(i64 image_id);
 
     Function<void()> on_death;
 
 private:
     virtual void die() override;
 
-    virtual void did_decode_image(i64 image_id, bool is_animated, u32 loop_count, Vector<Gfx::ShareableBitmap> const& bitmaps, Vector<u32> const& durations, Gfx::FloatPoint scale) override;
+    virtual void did_decode_image(i64 image_id, bool is_animated, u32 loop_count, u32 frame_count, Vector<Gfx::ShareableBitmap> const& bitmaps, Vector<u32> const& durations, Gfx::FloatPoint scale) override;
     virtual void did_fail_to_decode_image(i64 image_id, String const& error_message) override;
+    virtual void did_decode_frame(i64 image_id, u32 frame_index, Gfx::ShareableBitmap const& bitmap, u32 duration) override;
+    virtual void did_fail_to_decode_frame(i64 image_id, u32 frame_index, String const& error_message) override;
+
+    Optional<NonnullRefPtr<Core::Promise<Frame>>> take_pending_frame(i64 image_id, u32 frame_index);
 
     HashMap<i64, NonnullRefPtr<Core::Promise<DecodedImage>>> m_pending_decoded_images;
+
+    struct PendingFrame {
+        i64 image_id { 0 };
+        u32 frame_index { 0 };
+        NonnullRefPtr<Core::Promise<Frame>> promise;
+    };
+    Vector<PendingFrame> m_pending_frames;
 };
 
 }
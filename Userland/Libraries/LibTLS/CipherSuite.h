@@ -34,6 +34,9 @@ enum class KeyExchangeAlgorithm {
     ECDH_RSA,
     ECDHE_ECDSA,
     ECDH_anon,
+    // Defined in RFC 8446 section 4.1.1: TLS 1.3 cipher suites leave the key exchange to the key_share and
+    // pre_shared_key extensions.
+    Negotiated,
 };
 
 // Defined in RFC 5246 section 7.4.1.4.1
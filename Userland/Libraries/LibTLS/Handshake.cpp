@@ -17,7 +17,39 @@ namespace TLS {
 
 ByteBuffer TLSv12::build_hello()
 {
-    fill_with_random(m_context.local_random);
+    // RFC 8446 section 4.1.2: The ClientHello after a HelloRetryRequest keeps the random and the session ID of the
+    // first one, and only changes what the server asked for.
+    if (!m_context.tls13.did_hello_retry) {
+        fill_with_random(m_context.local_random);
+
+        if (supports_version(ProtocolVersion::VERSION_1_2))
+            offer_tls12_session();
+
+        if (supports_version(ProtocolVersion::VERSION_1_3)) {
+            auto key_share_group = m_context.options.elliptic_curves.is_empty() ? Optional<SupportedGroup> {} : m_context.options.elliptic_curves.first();
+            if (!key_share_group.has_value() || build_tls13_key_share(*key_share_group).is_error()) {
+                dbgln("Cannot offer TLS 1.3 without a key share");
+                m_context.options.supported_versions.remove_all_matching([](auto version) { return version == ProtocolVersion::VERSION_1_3; });
+            }
+        }
+
+        if (supports_version(ProtocolVersion::VERSION_1_3)) {
+            // RFC 8446 appendix D.4: A non-empty session ID makes the handshake look like a resumed TLS 1.2 session to middleboxes.
+            if (m_context.session_id_size == 0) {
+                fill_with_random({ m_context.session_id, 32 });
+                m_context.session_id_size = 32;
+            }
+
+            if (auto& cache = m_context.options.session_cache; cache && !m_context.extensions.SNI.is_empty()) {
+                m_context.tls13.offered_ticket = cache->take_tls13_ticket(m_context.extensions.SNI);
+                if (m_context.tls13.offered_ticket.has_value() && !m_context.options.usable_cipher_suites.contains_slow(m_context.tls13.offered_ticket->cipher))
+                    m_context.tls13.offered_ticket.clear();
+            }
+        }
+    }
+
+    bool offer_tls12 = supports_version(ProtocolVersion::VERSION_1_2);
+    bool offer_tls13 = supports_version(ProtocolVersion::VERSION_1_3);
 
     auto packet_version = (u16)m_context.options.version;
     auto version = (u16)m_context.options.version;
@@ -57,9 +89,20 @@ ByteBuffer TLSv12::build_hello()
     }
 
     // Ciphers
-    builder.append((u16)(m_context.options.usable_cipher_suites.size() * sizeof(u16)));
-    for (auto suite : m_context.options.usable_cipher_suites)
-        builder.append((u16)suite);
+    // TLS 1.3 cipher suites cannot be used with TLS 1.2 and vice versa, so only offer those of the offered versions.
+    auto is_offered = [&](CipherSuite suite) {
+        return get_key_exchange_algorithm(suite) == KeyExchangeAlgorithm::Negotiated ? offer_tls13 : offer_tls12;
+    };
+    size_t offered_cipher_suites = 0;
+    for (auto suite : m_context.options.usable_cipher_suites) {
+        if (is_offered(suite))
+            ++offered_cipher_suites;
+    }
+    builder.append((u16)(offered_cipher_suites * sizeof(u16)));
+    for (auto suite : m_context.options.usable_cipher_suites) {
+        if (is_offered(suite))
+            builder.append((u16)suite);
+    }
 
     // we don't like compression
     VERIFY(!m_context.options.use_compression);
@@ -76,6 +119,25 @@ ByteBuffer TLSv12::build_hello()
     bool supports_elliptic_curves = elliptic_curves_length && supported_ec_point_formats_length;
     bool enable_extended_master_secret = m_context.options.enable_extended_master_secret;
 
+    // RFC 5077 section 3.2: An empty session_ticket extension asks for a ticket, a non-empty one resumes a session.
+    bool enable_session_ticket = offer_tls12 && m_context.options.session_cache;
+    ReadonlyBytes session_ticket;
+    if (enable_session_ticket && m_context.tls12_resumption.offered_session.has_value())
+        session_ticket = m_context.tls12_resumption.offered_session->ticket;
+
+    size_t supported_versions_count = 0;
+    if (offer_tls13) {
+        for (auto supported_version : m_context.options.supported_versions) {
+            if (supports_version(supported_version))
+                ++supported_versions_count;
+        }
+    }
+
+    auto const& offered_ticket = m_context.tls13.offered_ticket;
+    size_t psk_binder_length = 0;
+    if (offer_tls13 && offered_ticket.has_value())
+        psk_binder_length = get_hash_size(offered_ticket->cipher);
+
     // signature_algorithms: 2b extension ID, 2b extension length, 2b vector length, 2xN signatures and hashes
     extension_length += 2 + 2 + 2 + 2 * m_context.options.supported_signature_algorithms.size();
 
@@ -89,6 +151,24 @@ ByteBuffer TLSv12::build_hello()
     if (enable_extended_master_secret)
         extension_length += 4;
 
+    if (enable_session_ticket)
+        extension_length += 4 + session_ticket.size();
+
+    if (offer_tls13) {
+        // supported_versions: 2b extension ID, 2b extension length, 1b vector length, 2xN versions
+        extension_length += 4 + 1 + 2 * supported_versions_count;
+        // key_share: 2b extension ID, 2b extension length, 2b vector length, 2b group, 2b key length, key
+        extension_length += 4 + 2 + 2 + 2 + m_context.tls13.key_share_public_key.size();
+        // psk_key_exchange_modes: 2b extension ID, 2b extension length, 1b vector length, 1b mode
+        extension_length += 4 + 1 + 1;
+        if (!m_context.tls13.cookie.is_empty())
+            extension_length += 4 + m_context.tls13.cookie.size();
+        // pre_shared_key: 2b extension ID, 2b extension length, 2b identities length, 2b identity length, identity,
+        //                 4b obfuscated ticket age, 2b binders length, 1b binder length, binder
+        if (psk_binder_length)
+            extension_length += 4 + 2 + 2 + offered_ticket->ticket.size() + 4 + 2 + 1 + psk_binder_length;
+    }
+
     builder.append((u16)extension_length);
 
     if (sni_length) {
@@ -139,11 +219,70 @@ ByteBuffer TLSv12::build_hello()
         builder.append((u16)0);
     }
 
+    if (enable_session_ticket) {
+        // session_ticket extension
+        builder.append((u16)ExtensionType::SESSION_TICKET);
+        builder.append((u16)session_ticket.size());
+        builder.append(session_ticket);
+    }
+
+    if (offer_tls13) {
+        // supported_versions extension
+        builder.append((u16)ExtensionType::SUPPORTED_VERSIONS);
+        builder.append((u16)(1 + 2 * supported_versions_count));
+        builder.append((u8)(2 * supported_versions_count));
+        for (auto supported_version : m_context.options.supported_versions) {
+            if (supports_version(supported_version))
+                builder.append((u16)supported_version);
+        }
+
+        // key_share extension
+        auto& public_key = m_context.tls13.key_share_public_key;
+        builder.append((u16)ExtensionType::KEY_SHARE);
+        builder.append((u16)(2 + 2 + 2 + public_key.size()));
+        builder.append((u16)(2 + 2 + public_key.size()));
+        builder.append((u16)m_context.tls13.key_share_group);
+        builder.append((u16)public_key.size());
+        builder.append(public_key.bytes());
+
+        // psk_key_exchange_modes extension, we only support psk_dhe_ke (1)
+        builder.append((u16)ExtensionType::PSK_KEY_EXCHANGE_MODES);
+        builder.append((u16)2);
+        builder.append((u8)1);
+        builder.append((u8)1);
+
+        if (!m_context.tls13.cookie.is_empty()) {
+            // cookie extension, echoed from the HelloRetryRequest
+            builder.append((u16)ExtensionType::COOKIE);
+            builder.append((u16)m_context.tls13.cookie.size());
+            builder.append(m_context.tls13.cookie.bytes());
+        }
+    }
+
     if (alpn_length) {
         // TODO
         VERIFY_NOT_REACHED();
     }
 
+    if (psk_binder_length) {
+        // RFC 8446 section 4.2.11: The pre_shared_key extension MUST be the last extension in the ClientHello.
+        auto& ticket = offered_ticket->ticket;
+        auto ticket_age = (UnixDateTime::now() - offered_ticket->received_at).to_milliseconds();
+        builder.append((u16)ExtensionType::PRE_SHARED_KEY);
+        builder.append((u16)(2 + 2 + ticket.size() + 4 + 2 + 1 + psk_binder_length));
+        builder.append((u16)(2 + ticket.size() + 4));
+        builder.append((u16)ticket.size());
+        builder.append(ticket.bytes());
+        u32 obfuscated_ticket_age = (u32)ticket_age + offered_ticket->age_add;
+        builder.append((u16)(obfuscated_ticket_age >> 16));
+        builder.append((u16)obfuscated_ticket_age);
+        builder.append((u16)(1 + psk_binder_length));
+        builder.append((u8)psk_binder_length);
+        // The binder depends on the rest of the ClientHello, it is filled in below.
+        for (size_t i = 0; i < psk_binder_length; ++i)
+            builder.append((u8)0);
+    }
+
     // set the "length" field of the packet
     size_t remaining = builder.length() - start_length;
     size_t payload_position = 6;
@@ -154,6 +293,10 @@ ByteBuffer TLSv12::build_hello()
     builder.set(payload_position + 2, remaining);
 
     auto packet = builder.build();
+    if (psk_binder_length) {
+        if (auto result = write_tls13_psk_binder(packet); result.is_error())
+            dbgln("Failed to compute the pre-shared key binder: {}", result.error());
+    }
     update_packet(packet);
 
     return packet;
@@ -187,7 +330,8 @@ ByteBuffer TLSv12::build_handshake_finished()
     auto outbuffer = Bytes { out, verify_data_length };
     ByteBuffer dummy;
 
-    auto digest = m_context.handshake_hash.digest();
+    // Note: The transcript goes on after this, the server Finished covers our Finished as well.
+    auto digest = m_context.handshake_hash.copy().digest();
     auto hashbuf = ReadonlyBytes { digest.immutable_data(), m_context.handshake_hash.digest_size() };
     pseudorandom_function(outbuffer, m_context.master_key, (u8 const*)"client finished", 15, hashbuf, dummy);
 
@@ -198,6 +342,115 @@ ByteBuffer TLSv12::build_handshake_finished()
     return packet;
 }
 
+void TLSv12::offer_tls12_session()
+{
+    auto& cache = m_context.options.session_cache;
+    if (!cache || m_context.extensions.SNI.is_empty())
+        return;
+
+    auto session = cache->tls12_session(m_context.extensions.SNI);
+    if (!session.has_value() || !m_context.options.usable_cipher_suites.contains_slow(session->cipher))
+        return;
+
+    if (!session->ticket.is_empty()) {
+        // RFC 5077 section 3.4: The server echoes the session ID that we send along with a ticket if it accepts the
+        // ticket, so a fresh random one tells us whether it did.
+        fill_with_random({ m_context.session_id, 32 });
+        m_context.session_id_size = 32;
+    } else {
+        VERIFY(session->session_id.size() <= sizeof(m_context.session_id));
+        memcpy(m_context.session_id, session->session_id.data(), session->session_id.size());
+        m_context.session_id_size = session->session_id.size();
+    }
+
+    m_context.tls12_resumption.offered_session = session.release_value();
+}
+
+// https://www.rfc-editor.org/rfc/rfc5077#section-3.3
+ssize_t TLSv12::handle_tls12_new_session_ticket(ReadonlyBytes buffer)
+{
+    // struct {
+    //     uint32 ticket_lifetime_hint;
+    //     opaque ticket<0..2^16-1>;
+    // } NewSessionTicket;
+    if (buffer.size() < 3 + 6)
+        return (i8)Error::BrokenPacket;
+
+    size_t ticket_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset(3 + 4)));
+    if (buffer.size() - 3 - 6 != ticket_length)
+        return (i8)Error::BrokenPacket;
+
+    auto ticket = ByteBuffer::copy(buffer.slice(3 + 6, ticket_length));
+    if (ticket.is_error())
+        return (i8)Error::OutOfMemory;
+
+    m_context.tls12_resumption.new_ticket_lifetime = AK::convert_between_host_and_network_endian(ByteReader::load32(buffer.offset(3)));
+    m_context.tls12_resumption.new_ticket = ticket.release_value();
+    return buffer.size();
+}
+
+bool TLSv12::verify_tls12_server_finished(ReadonlyBytes verify_data)
+{
+    // RFC 5246 section 7.4.9: verify_data = PRF(master_secret, finished_label, Hash(handshake_messages))
+    constexpr u32 verify_data_length = 12;
+    if (verify_data.size() != verify_data_length)
+        return false;
+
+    u8 expected[verify_data_length];
+    ByteBuffer dummy;
+    auto digest = m_context.handshake_hash.copy().digest();
+    auto hashbuf = ReadonlyBytes { digest.immutable_data(), m_context.handshake_hash.digest_size() };
+    pseudorandom_function({ expected, verify_data_length }, m_context.master_key, (u8 const*)"server finished", 15, hashbuf, dummy);
+
+    return timing_safe_compare(expected, verify_data.data(), verify_data_length);
+}
+
+void TLSv12::store_tls12_session()
+{
+    auto& cache = m_context.options.session_cache;
+    if (!cache || m_context.extensions.SNI.is_empty())
+        return;
+
+    auto& resumption = m_context.tls12_resumption;
+
+    // A ticket that the server did not replace stays valid.
+    ByteBuffer ticket = move(resumption.new_ticket);
+    if (ticket.is_empty() && resumption.resumed && resumption.offered_session.has_value())
+        ticket = move(resumption.offered_session->ticket);
+
+    ByteBuffer session_id;
+    if (ticket.is_empty()) {
+        // Without a ticket or a session ID, the server cannot resume this session.
+        if (m_context.session_id_size == 0)
+            return;
+        auto session_id_copy = ByteBuffer::copy(m_context.session_id, m_context.session_id_size);
+        if (session_id_copy.is_error())
+            return;
+        session_id = session_id_copy.release_value();
+    }
+
+    auto master_secret = ByteBuffer::copy(m_context.master_key);
+    if (master_secret.is_error())
+        return;
+
+    // RFC 5246 appendix F.1.4 suggests an upper limit of 24 hours for session IDs, and the ticket lifetime hint is
+    // only a hint as well.
+    constexpr u32 max_session_lifetime_in_seconds = 24 * 60 * 60;
+    u32 lifetime = max_session_lifetime_in_seconds;
+    if (!ticket.is_empty() && resumption.new_ticket_lifetime != 0)
+        lifetime = min(resumption.new_ticket_lifetime, max_session_lifetime_in_seconds);
+
+    cache->store_tls12_session(m_context.extensions.SNI,
+        SessionCache::TLS12Session {
+            .session_id = move(session_id),
+            .ticket = move(ticket),
+            .master_secret = master_secret.release_value(),
+            .cipher = m_context.cipher,
+            .extended_master_secret = m_context.extensions.extended_master_secret,
+            .expires_at = UnixDateTime::now() + Duration::from_seconds(lifetime),
+        });
+}
+
 ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage& write_packets)
 {
     if (m_context.connection_status < ConnectionStatus::KeyExchange || m_context.connection_status == ConnectionStatus::Established) {
@@ -225,8 +478,16 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
         return (i8)Error::NeedMoreData;
     }
 
-    // TODO: Compare Hashes
-    dbgln_if(TLS_DEBUG, "FIXME: handle_handshake_finished :: Check message validity");
+    if (!verify_tls12_server_finished(buffer.slice(index, 12))) {
+        dbgln("Server Finished does not match the handshake");
+        return (i8)Error::NotSafe;
+    }
+
+    // RFC 5246 section 7.3: In an abbreviated handshake, the server sends its Finished first and we answer with ours.
+    if (m_context.tls12_resumption.resumed)
+        write_packets = WritePacketStage::Finished;
+
+    store_tls12_session();
     m_context.connection_status = ConnectionStatus::Established;
 
     if (m_handshake_timeout_timer) {
@@ -244,7 +505,8 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
 
 ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
 {
-    if (m_context.connection_status == ConnectionStatus::Established) {
+    // Note: TLS 1.3 has post-handshake messages such as NewSessionTicket and KeyUpdate.
+    if (m_context.connection_status == ConnectionStatus::Established && !is_tls13()) {
         dbgln_if(TLS_DEBUG, "Renegotiation attempt ignored");
         // FIXME: We should properly say "NoRenegotiation", but that causes a handshake failure
         //        so we just roll with it and pretend that we _did_ renegotiate
@@ -252,181 +514,217 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
         //        we do not have those at the moment :^)
         return 1;
     }
+
+    // Handshake messages may span several records, so hold on to an incomplete message until the rest of it arrives.
+    ByteBuffer reassembled_buffer;
     auto buffer = vbuffer;
+    if (!m_context.handshake_fragment.is_empty()) {
+        reassembled_buffer = move(m_context.handshake_fragment);
+        if (reassembled_buffer.try_append(vbuffer).is_error())
+            return (i8)Error::OutOfMemory;
+        buffer = reassembled_buffer;
+    }
+
     auto buffer_length = buffer.size();
-    auto original_length = buffer_length;
-    while (buffer_length >= 4 && !m_context.critical_error) {
+    auto original_length = vbuffer.size();
+    while (buffer_length > 0 && !m_context.critical_error) {
         ssize_t payload_res = 0;
-        if (buffer_length < 1)
-            return (i8)Error::NeedMoreData;
+        size_t payload_size = buffer_length >= 4 ? buffer[1] * 0x10000 + buffer[2] * 0x100 + buffer[3] + 3 : 0;
+        if (buffer_length < 4 || payload_size + 1 > buffer_length) {
+            dbgln_if(TLS_DEBUG, "Partial handshake message of {} bytes, waiting for more data", buffer_length);
+            auto fragment = ByteBuffer::copy(buffer.slice(0, buffer_length));
+            if (fragment.is_error())
+                return (i8)Error::OutOfMemory;
+            m_context.handshake_fragment = fragment.release_value();
+            break;
+        }
         auto type = static_cast<HandshakeType>(buffer[0]);
         auto write_packets { WritePacketStage::Initial };
-        size_t payload_size = buffer[1] * 0x10000 + buffer[2] * 0x100 + buffer[3] + 3;
         dbgln_if(TLS_DEBUG, "payload size: {} buffer length: {}", payload_size, buffer_length);
-        if (payload_size + 1 > buffer_length)
-            return (i8)Error::NeedMoreData;
 
-        switch (type) {
-        case HandshakeType::HELLO_REQUEST_RESERVED:
-            if (m_context.handshake_messages[0] >= 1) {
-                dbgln("unexpected hello request message");
-                payload_res = (i8)Error::UnexpectedMessage;
+        // Everything after the ServerHello has its own state machine in TLS 1.3.
+        if (is_tls13() && m_context.tls13.state != TLS13HandshakeState::WaitServerHello) {
+            // The handshake messages after the ServerHello follow their own state machine in TLS 1.3.
+            payload_res = handle_tls13_handshake_message(type, buffer.slice(0, payload_size + 1), write_packets);
+        } else {
+            switch (type) {
+            case HandshakeType::HELLO_REQUEST_RESERVED:
+                if (m_context.handshake_messages[0] >= 1) {
+                    dbgln("unexpected hello request message");
+                    payload_res = (i8)Error::UnexpectedMessage;
+                    break;
+                }
+                ++m_context.handshake_messages[0];
+                dbgln("hello request (renegotiation?)");
+                if (m_context.connection_status == ConnectionStatus::Established) {
+                    // renegotiation
+                    payload_res = (i8)Error::NoRenegotiation;
+                } else {
+                    // :shrug:
+                    payload_res = (i8)Error::UnexpectedMessage;
+                }
                 break;
-            }
-            ++m_context.handshake_messages[0];
-            dbgln("hello request (renegotiation?)");
-            if (m_context.connection_status == ConnectionStatus::Established) {
-                // renegotiation
-                payload_res = (i8)Error::NoRenegotiation;
-            } else {
-                // :shrug:
-                payload_res = (i8)Error::UnexpectedMessage;
-            }
-            break;
-        case HandshakeType::CLIENT_HELLO:
-            // FIXME: We only support client mode right now
-            if (m_context.is_server) {
-                VERIFY_NOT_REACHED();
-            }
-            payload_res = (i8)Error::UnexpectedMessage;
-            break;
-        case HandshakeType::SERVER_HELLO:
-            if (m_context.handshake_messages[2] >= 1) {
-                dbgln("unexpected server hello message");
+            case HandshakeType::CLIENT_HELLO:
+                // FIXME: We only support client mode right now
+                if (m_context.is_server) {
+                    VERIFY_NOT_REACHED();
+                }
                 payload_res = (i8)Error::UnexpectedMessage;
                 break;
-            }
-            ++m_context.handshake_messages[2];
-            dbgln_if(TLS_DEBUG, "server hello");
-            if (m_context.is_server) {
-                dbgln("unsupported: server mode");
-                VERIFY_NOT_REACHED();
-            }
-            payload_res = handle_server_hello(buffer.slice(1, payload_size), write_packets);
-            break;
-        case HandshakeType::HELLO_VERIFY_REQUEST_RESERVED:
-            dbgln("unsupported: DTLS");
-            payload_res = (i8)Error::UnexpectedMessage;
-            break;
-        case HandshakeType::CERTIFICATE:
-            if (m_context.handshake_messages[4] >= 1) {
-                dbgln("unexpected certificate message");
+            case HandshakeType::SERVER_HELLO:
+                if (m_context.handshake_messages[2] >= 1) {
+                    dbgln("unexpected server hello message");
+                    payload_res = (i8)Error::UnexpectedMessage;
+                    break;
+                }
+                ++m_context.handshake_messages[2];
+                dbgln_if(TLS_DEBUG, "server hello");
+                if (m_context.is_server) {
+                    dbgln("unsupported: server mode");
+                    VERIFY_NOT_REACHED();
+                }
+                payload_res = handle_server_hello(buffer.slice(1, payload_size), write_packets);
+                break;
+            case HandshakeType::HELLO_VERIFY_REQUEST_RESERVED:
+                dbgln("unsupported: DTLS");
                 payload_res = (i8)Error::UnexpectedMessage;
                 break;
-            }
-            ++m_context.handshake_messages[4];
-            dbgln_if(TLS_DEBUG, "certificate");
-            if (m_context.connection_status == ConnectionStatus::Negotiating) {
+            case HandshakeType::CERTIFICATE:
+                if (m_context.handshake_messages[4] >= 1) {
+                    dbgln("unexpected certificate message");
+                    payload_res = (i8)Error::UnexpectedMessage;
+                    break;
+                }
+                ++m_context.handshake_messages[4];
+                dbgln_if(TLS_DEBUG, "certificate");
+                if (m_context.connection_status == ConnectionStatus::Negotiating) {
+                    if (m_context.is_server) {
+                        dbgln("unsupported: server mode");
+                        VERIFY_NOT_REACHED();
+                    }
+                    payload_res = handle_certificate(buffer.slice(1, payload_size));
+                } else {
+                    payload_res = (i8)Error::UnexpectedMessage;
+                }
+                break;
+            case HandshakeType::SERVER_KEY_EXCHANGE_RESERVED:
+                if (m_context.handshake_messages[5] >= 1) {
+                    dbgln("unexpected server key exchange message");
+                    payload_res = (i8)Error::UnexpectedMessage;
+                    break;
+                }
+                ++m_context.handshake_messages[5];
+                dbgln_if(TLS_DEBUG, "server key exchange");
                 if (m_context.is_server) {
                     dbgln("unsupported: server mode");
                     VERIFY_NOT_REACHED();
+                } else {
+                    payload_res = handle_server_key_exchange(buffer.slice(1, payload_size));
                 }
-                payload_res = handle_certificate(buffer.slice(1, payload_size));
-            } else {
-                payload_res = (i8)Error::UnexpectedMessage;
-            }
-            break;
-        case HandshakeType::SERVER_KEY_EXCHANGE_RESERVED:
-            if (m_context.handshake_messages[5] >= 1) {
-                dbgln("unexpected server key exchange message");
-                payload_res = (i8)Error::UnexpectedMessage;
                 break;
-            }
-            ++m_context.handshake_messages[5];
-            dbgln_if(TLS_DEBUG, "server key exchange");
-            if (m_context.is_server) {
-                dbgln("unsupported: server mode");
-                VERIFY_NOT_REACHED();
-            } else {
-                payload_res = handle_server_key_exchange(buffer.slice(1, payload_size));
-            }
-            break;
-        case HandshakeType::CERTIFICATE_REQUEST:
-            if (m_context.handshake_messages[6] >= 1) {
-                dbgln("unexpected certificate request message");
-                payload_res = (i8)Error::UnexpectedMessage;
+            case HandshakeType::CERTIFICATE_REQUEST:
+                if (m_context.handshake_messages[6] >= 1) {
+                    dbgln("unexpected certificate request message");
+                    payload_res = (i8)Error::UnexpectedMessage;
+                    break;
+                }
+                ++m_context.handshake_messages[6];
+                if (m_context.is_server) {
+                    dbgln("invalid request");
+                    dbgln("unsupported: server mode");
+                    VERIFY_NOT_REACHED();
+                } else {
+                    // we do not support "certificate request"
+                    dbgln("certificate request");
+                    if (on_tls_certificate_request)
+                        on_tls_certificate_request(*this);
+                    m_context.client_verified = VerificationNeeded;
+                }
                 break;
-            }
-            ++m_context.handshake_messages[6];
-            if (m_context.is_server) {
-                dbgln("invalid request");
-                dbgln("unsupported: server mode");
-                VERIFY_NOT_REACHED();
-            } else {
-                // we do not support "certificate request"
-                dbgln("certificate request");
-                if (on_tls_certificate_request)
-                    on_tls_certificate_request(*this);
-                m_context.client_verified = VerificationNeeded;
-            }
-            break;
-        case HandshakeType::SERVER_HELLO_DONE_RESERVED:
-            if (m_context.handshake_messages[7] >= 1) {
-                dbgln("unexpected server hello done message");
-                payload_res = (i8)Error::UnexpectedMessage;
+            case HandshakeType::SERVER_HELLO_DONE_RESERVED:
+                if (m_context.handshake_messages[7] >= 1) {
+                    dbgln("unexpected server hello done message");
+                    payload_res = (i8)Error::UnexpectedMessage;
+                    break;
+                }
+                ++m_context.handshake_messages[7];
+                dbgln_if(TLS_DEBUG, "server hello done");
+                if (m_context.is_server) {
+                    dbgln("unsupported: server mode");
+                    VERIFY_NOT_REACHED();
+                } else {
+                    payload_res = handle_server_hello_done(buffer.slice(1, payload_size));
+                    if (payload_res > 0)
+                        write_packets = WritePacketStage::ClientHandshake;
+                }
                 break;
-            }
-            ++m_context.handshake_messages[7];
-            dbgln_if(TLS_DEBUG, "server hello done");
-            if (m_context.is_server) {
-                dbgln("unsupported: server mode");
-                VERIFY_NOT_REACHED();
-            } else {
-                payload_res = handle_server_hello_done(buffer.slice(1, payload_size));
-                if (payload_res > 0)
-                    write_packets = WritePacketStage::ClientHandshake;
-            }
-            break;
-        case HandshakeType::CERTIFICATE_VERIFY:
-            if (m_context.handshake_messages[8] >= 1) {
-                dbgln("unexpected certificate verify message");
-                payload_res = (i8)Error::UnexpectedMessage;
+            case HandshakeType::CERTIFICATE_VERIFY:
+                if (m_context.handshake_messages[8] >= 1) {
+                    dbgln("unexpected certificate verify message");
+                    payload_res = (i8)Error::UnexpectedMessage;
+                    break;
+                }
+                ++m_context.handshake_messages[8];
+                dbgln_if(TLS_DEBUG, "certificate verify");
+                if (m_context.connection_status == ConnectionStatus::KeyExchange) {
+                    payload_res = handle_certificate_verify(buffer.slice(1, payload_size));
+                } else {
+                    payload_res = (i8)Error::UnexpectedMessage;
+                }
                 break;
-            }
-            ++m_context.handshake_messages[8];
-            dbgln_if(TLS_DEBUG, "certificate verify");
-            if (m_context.connection_status == ConnectionStatus::KeyExchange) {
-                payload_res = handle_certificate_verify(buffer.slice(1, payload_size));
-            } else {
-                payload_res = (i8)Error::UnexpectedMessage;
-            }
-            break;
-        case HandshakeType::CLIENT_KEY_EXCHANGE_RESERVED:
-            if (m_context.handshake_messages[9] >= 1) {
-                dbgln("unexpected client key exchange message");
-                payload_res = (i8)Error::UnexpectedMessage;
+            case HandshakeType::CLIENT_KEY_EXCHANGE_RESERVED:
+                if (m_context.handshake_messages[9] >= 1) {
+                    dbgln("unexpected client key exchange message");
+                    payload_res = (i8)Error::UnexpectedMessage;
+                    break;
+                }
+                ++m_context.handshake_messages[9];
+                dbgln_if(TLS_DEBUG, "client key exchange");
+                if (m_context.is_server) {
+                    dbgln("unsupported: server mode");
+                    VERIFY_NOT_REACHED();
+                } else {
+                    payload_res = (i8)Error::UnexpectedMessage;
+                }
                 break;
-            }
-            ++m_context.handshake_messages[9];
-            dbgln_if(TLS_DEBUG, "client key exchange");
-            if (m_context.is_server) {
-                dbgln("unsupported: server mode");
-                VERIFY_NOT_REACHED();
-            } else {
-                payload_res = (i8)Error::UnexpectedMessage;
-            }
-            break;
-        case HandshakeType::FINISHED:
-            m_context.cached_handshake.clear();
-            if (m_context.handshake_messages[10] >= 1) {
-                dbgln("unexpected finished message");
-                payload_res = (i8)Error::UnexpectedMessage;
+            case HandshakeType::NEW_SESSION_TICKET:
+                if (m_context.handshake_messages[3] >= 1 || !m_context.tls12_resumption.ticket_requested) {
+                    dbgln("unexpected new session ticket message");
+                    payload_res = (i8)Error::UnexpectedMessage;
+                    break;
+                }
+                ++m_context.handshake_messages[3];
+                dbgln_if(TLS_DEBUG, "new session ticket");
+                payload_res = handle_tls12_new_session_ticket(buffer.slice(1, payload_size));
+                break;
+            case HandshakeType::FINISHED:
+                m_context.cached_handshake.clear();
+                if (m_context.handshake_messages[10] >= 1) {
+                    dbgln("unexpected finished message");
+                    payload_res = (i8)Error::UnexpectedMessage;
+                    break;
+                }
+                ++m_context.handshake_messages[10];
+                dbgln_if(TLS_DEBUG, "finished");
+                payload_res = handle_handshake_finished(buffer.slice(1, payload_size), write_packets);
+                if (payload_res > 0) {
+                    memset(m_context.handshake_messages, 0, sizeof(m_context.handshake_messages));
+                }
                 break;
+            default:
+                dbgln("message type not understood: {}", enum_to_string(type));
+                return (i8)Error::NotUnderstood;
             }
-            ++m_context.handshake_messages[10];
-            dbgln_if(TLS_DEBUG, "finished");
-            payload_res = handle_handshake_finished(buffer.slice(1, payload_size), write_packets);
-            if (payload_res > 0) {
-                memset(m_context.handshake_messages, 0, sizeof(m_context.handshake_messages));
+
+            if (type != HandshakeType::HELLO_REQUEST_RESERVED) {
+                update_hash(buffer.slice(0, payload_size + 1), 0);
             }
-            break;
-        default:
-            dbgln("message type not understood: {}", enum_to_string(type));
-            return (i8)Error::NotUnderstood;
-        }
 
-        if (type != HandshakeType::HELLO_REQUEST_RESERVED) {
-            update_hash(buffer.slice(0, payload_size + 1), 0);
+            // The handshake traffic keys cover the transcript up to the ServerHello.
+            if (type == HandshakeType::SERVER_HELLO && payload_res >= 0 && m_context.tls13.state == TLS13HandshakeState::WaitEncryptedExtensions) {
+                if (derive_tls13_handshake_secrets().is_error())
+                    payload_res = (i8)Error::OutOfMemory;
+            }
         }
 
         // if something went wrong, send an alert about it
@@ -535,6 +833,17 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
             dbgln("UNSUPPORTED: Server mode");
             VERIFY_NOT_REACHED();
             break;
+        case WritePacketStage::ClientHelloRetry: {
+            dbgln_if(TLS_DEBUG, "> client hello (retry)");
+            auto packet = build_hello();
+            write_packet(packet);
+            // Note: We are still disconnected as far as write_packet() is concerned, so nothing flushes this for us.
+            write_into_socket();
+            break;
+        }
+        case WritePacketStage::ClientFinishedTLS13:
+            send_tls13_client_finished();
+            break;
         case WritePacketStage::Finished:
             // finished
             {
@@ -17,6 +17,7 @@
 #include <LibCrypto/Curves/X25519.h>
 #include <LibCrypto/Curves/X448.h>
 #include <LibCrypto/PK/Code/EMSA_PKCS1_V1_5.h>
+#include <LibCrypto/PK/Code/EMSA_PSS.h>
 #include <LibTLS/TLSv12.h>
 
 namespace TLS {
@@ -49,18 +50,30 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
     auto version = static_cast<ProtocolVersion>(AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res))));
 
     res += 2;
-    if (!supports_version(version))
+    // RFC 8446 section 4.1.3: TLS 1.3 servers also put TLS 1.2 here, the actual version is in the supported_versions extension.
+    if (version != ProtocolVersion::VERSION_1_2)
         return (i8)Error::NotSafe;
 
     memcpy(m_context.remote_random, buffer.offset_pointer(res), sizeof(m_context.remote_random));
     res += sizeof(m_context.remote_random);
 
+    // RFC 8446 section 4.1.3: A HelloRetryRequest is a ServerHello with this special random value.
+    static constexpr Array<u8, 32> hello_retry_request_random {
+        0xCF, 0x21, 0xAD, 0x74, 0xE5, 0x9A, 0x61, 0x11, 0xBE, 0x1D, 0x8C, 0x02, 0x1E, 0x65, 0xB8, 0x91,
+        0xC2, 0xA2, 0x11, 0x16, 0x7A, 0xBB, 0x8C, 0x5E, 0x07, 0x9E, 0x09, 0xE2, 0xC8, 0xA8, 0x33, 0x9C
+    };
+    bool is_hello_retry_request = ReadonlyBytes { m_context.remote_random, sizeof(m_context.remote_random) } == hello_retry_request_random.span();
+
     u8 session_length = buffer[res++];
     if (buffer.size() - res < session_length) {
         dbgln("not enough data for session id");
         return (i8)Error::NeedMoreData;
     }
 
+    bool session_id_echoed = session_length > 0
+        && session_length == m_context.session_id_size
+        && ReadonlyBytes { m_context.session_id, m_context.session_id_size } == buffer.slice(res, session_length);
+
     if (session_length && session_length <= 32) {
         memcpy(m_context.session_id, buffer.offset_pointer(res), session_length);
         m_context.session_id_size = session_length;
@@ -84,12 +97,14 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         dbgln("No supported cipher could be agreed upon");
         return (i8)Error::NoCommonCipher;
     }
+    // RFC 8446 section 4.1.4: The ServerHello after a HelloRetryRequest has to pick the same cipher suite.
+    if (m_context.tls13.did_hello_retry && cipher != m_context.cipher) {
+        dbgln("Server changed the cipher suite after a HelloRetryRequest");
+        return (i8)Error::NotSafe;
+    }
     m_context.cipher = cipher;
     dbgln_if(TLS_DEBUG, "Cipher: {}", enum_to_string(cipher));
 
-    // Simplification: We only support handshake hash functions via HMAC
-    m_context.handshake_hash.initialize(hmac_hash());
-
     // Compression method
     if (buffer.size() - res < 1)
         return (i8)Error::NeedMoreData;
@@ -97,8 +112,6 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
     if (compression != 0)
         return (i8)Error::CompressionNotSupported;
 
-    if (m_context.connection_status != ConnectionStatus::Renegotiating)
-        m_context.connection_status = ConnectionStatus::Negotiating;
     if (m_context.is_server) {
         dbgln("unsupported: server mode");
         write_packets = WritePacketStage::ServerHandshake;
@@ -110,6 +123,11 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         dbgln_if(TLS_DEBUG, "Extensions bytes total: {}", extensions_bytes_total);
     }
 
+    Optional<ProtocolVersion> selected_version;
+    Optional<u16> selected_identity;
+    ReadonlyBytes key_share;
+    ReadonlyBytes cookie;
+
     while (buffer.size() - res >= 4) {
         auto extension_type = (ExtensionType)AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res)));
         res += 2;
@@ -190,12 +208,87 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         } else if (extension_type == ExtensionType::EXTENDED_MASTER_SECRET) {
             m_context.extensions.extended_master_secret = true;
             res += extension_length;
+        } else if (extension_type == ExtensionType::SESSION_TICKET) {
+            // RFC 5077 section 3.2: The server will send a NewSessionTicket message before its ChangeCipherSpec.
+            m_context.tls12_resumption.ticket_requested = true;
+            res += extension_length;
+        } else if (extension_type == ExtensionType::SUPPORTED_VERSIONS) {
+            if (extension_length != 2)
+                return (i8)Error::BrokenPacket;
+            selected_version = static_cast<ProtocolVersion>(AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res))));
+            res += extension_length;
+        } else if (extension_type == ExtensionType::KEY_SHARE) {
+            key_share = buffer.slice(res, extension_length);
+            res += extension_length;
+        } else if (extension_type == ExtensionType::PRE_SHARED_KEY) {
+            if (extension_length != 2)
+                return (i8)Error::BrokenPacket;
+            selected_identity = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res)));
+            res += extension_length;
+        } else if (extension_type == ExtensionType::COOKIE) {
+            cookie = buffer.slice(res, extension_length);
+            res += extension_length;
         } else {
             dbgln("Encountered unknown extension {} with length {}", enum_to_string(extension_type), extension_length);
             res += extension_length;
         }
     }
 
+    if (selected_version.has_value()) {
+        if (*selected_version != ProtocolVersion::VERSION_1_3 || !supports_version(ProtocolVersion::VERSION_1_3)) {
+            dbgln("Server selected a version that we did not offer: {}", enum_to_string(*selected_version));
+            return (i8)Error::NotSafe;
+        }
+        m_context.negotiated_version = ProtocolVersion::VERSION_1_3;
+    } else {
+        if (!supports_version(ProtocolVersion::VERSION_1_2) || is_hello_retry_request)
+            return (i8)Error::NotSafe;
+
+        // RFC 8446 section 4.1.3: TLS 1.3 servers that negotiate TLS 1.2 set the last bytes of their random to
+        // "DOWNGRD" followed by 0x01, so that an attacker cannot make us fall back to TLS 1.2.
+        static constexpr auto downgrade_sentinel = "DOWNGRD\x01"sv;
+        if (supports_version(ProtocolVersion::VERSION_1_3) && ReadonlyBytes { m_context.remote_random + 24, 8 } == downgrade_sentinel.bytes()) {
+            dbgln("Server negotiated TLS 1.2 even though we both support TLS 1.3");
+            return (i8)Error::NotSafe;
+        }
+        m_context.negotiated_version = ProtocolVersion::VERSION_1_2;
+    }
+
+    if (is_tls13() != (get_key_exchange_algorithm(m_context.cipher) == KeyExchangeAlgorithm::Negotiated)) {
+        dbgln("Cipher suite {} cannot be used with {}", enum_to_string(m_context.cipher), enum_to_string(m_context.negotiated_version));
+        return (i8)Error::NoCommonCipher;
+    }
+
+    // Simplification: We only support handshake hash functions via HMAC
+    // Note: After a HelloRetryRequest, the transcript has been set up already.
+    if (!m_context.tls13.did_hello_retry)
+        m_context.handshake_hash.initialize(hmac_hash());
+
+    if (is_tls13()) {
+        auto result = handle_tls13_server_hello(key_share, selected_identity, cookie, is_hello_retry_request, write_packets);
+        if (result < 0)
+            return result;
+        if (is_hello_retry_request)
+            return res;
+    } else if (auto& offered_session = m_context.tls12_resumption.offered_session; offered_session.has_value() && session_id_echoed) {
+        // RFC 5246 section 7.4.1.3 and RFC 5077 section 3.4: The server resumes the session we offered by echoing its ID.
+        // RFC 7627 section 5.3: Both sessions have to agree on the use of the extended master secret.
+        if (offered_session->cipher != m_context.cipher || offered_session->extended_master_secret != m_context.extensions.extended_master_secret) {
+            dbgln("Server resumed a session with different parameters");
+            return (i8)Error::NotSafe;
+        }
+        m_context.master_key = move(offered_session->master_secret);
+        if (!expand_key())
+            return (i8)Error::NotSafe;
+        m_context.tls12_resumption.resumed = true;
+        dbgln_if(TLS_DEBUG, "Resuming TLS 1.2 session");
+    }
+
+    if (m_context.tls12_resumption.resumed)
+        m_context.connection_status = ConnectionStatus::KeyExchange;
+    else if (m_context.connection_status != ConnectionStatus::Renegotiating)
+        m_context.connection_status = ConnectionStatus::Negotiating;
+
     return res;
 }
 
@@ -360,20 +453,85 @@ ssize_t TLSv12::handle_ecdhe_rsa_server_key_exchange(ReadonlyBytes buffer)
     return verify_rsa_server_key_exchange(server_key_info, signature);
 }
 
+// RFC 5246 section 7.4.3: The signature covers ClientHello.random, ServerHello.random and the ServerKeyExchange params.
+static ErrorOr<ByteBuffer> server_key_exchange_signed_content(Context const& context, ReadonlyBytes server_key_info_buffer)
+{
+    ByteBuffer message;
+    TRY(message.try_ensure_capacity(sizeof(context.local_random) + sizeof(context.remote_random) + server_key_info_buffer.size()));
+    TRY(message.try_append(context.local_random, sizeof(context.local_random)));
+    TRY(message.try_append(context.remote_random, sizeof(context.remote_random)));
+    TRY(message.try_append(server_key_info_buffer));
+    return message;
+}
+
 ssize_t TLSv12::verify_rsa_server_key_exchange(ReadonlyBytes server_key_info_buffer, ReadonlyBytes signature_buffer)
 {
-    auto signature_hash = signature_buffer[0];
-    auto signature_algorithm = static_cast<SignatureAlgorithm>(signature_buffer[1]);
-    if (signature_algorithm != SignatureAlgorithm::RSA) {
-        dbgln("verify_rsa_server_key_exchange failed: Signature algorithm is not RSA, instead {}", enum_to_string(signature_algorithm));
-        return (i8)Error::NotUnderstood;
-    }
+    if (signature_buffer.size() < 4)
+        return (i8)Error::NeedMoreData;
 
+    auto signature_hash = static_cast<HashAlgorithm>(signature_buffer[0]);
+    auto signature_algorithm = static_cast<SignatureAlgorithm>(signature_buffer[1]);
     auto signature_length = AK::convert_between_host_and_network_endian(ByteReader::load16(signature_buffer.offset_pointer(2)));
+    if (signature_buffer.size() - 4 < signature_length)
+        return (i8)Error::NeedMoreData;
     auto signature = signature_buffer.slice(4, signature_length);
 
+    auto message_result = server_key_exchange_signed_content(m_context, server_key_info_buffer);
+    if (message_result.is_error()) {
+        dbgln("verify_rsa_server_key_exchange failed: Not enough memory");
+        return (i8)Error::OutOfMemory;
+    }
+    auto message = message_result.release_value();
+
+    return verify_rsa_signature({ signature_hash, signature_algorithm }, message, signature);
+}
+
+ssize_t TLSv12::verify_rsa_signature(SignatureAndHashAlgorithm algorithm, ReadonlyBytes message, ReadonlyBytes signature)
+{
+    bool is_pss = false;
+    Crypto::Hash::HashKind hash_kind;
+    if (algorithm.signature == SignatureAlgorithm::RSA) {
+        switch (algorithm.hash) {
+        case HashAlgorithm::SHA1:
+            hash_kind = Crypto::Hash::HashKind::SHA1;
+            break;
+        case HashAlgorithm::SHA256:
+            hash_kind = Crypto::Hash::HashKind::SHA256;
+            break;
+        case HashAlgorithm::SHA384:
+            hash_kind = Crypto::Hash::HashKind::SHA384;
+            break;
+        case HashAlgorithm::SHA512:
+            hash_kind = Crypto::Hash::HashKind::SHA512;
+            break;
+        default:
+            dbgln("verify_rsa_signature failed: Hash algorithm is not SHA1/256/384/512, instead {}", to_underlying(algorithm.hash));
+            return (i8)Error::NotUnderstood;
+        }
+    } else if (algorithm.hash == HashAlgorithm::INTRINSIC) {
+        // RFC 8446 section 4.2.3: RSASSA-PSS algorithms with public key OID rsaEncryption
+        is_pss = true;
+        switch (algorithm.signature) {
+        case SignatureAlgorithm::RSA_PSS_RSAE_SHA256:
+            hash_kind = Crypto::Hash::HashKind::SHA256;
+            break;
+        case SignatureAlgorithm::RSA_PSS_RSAE_SHA384:
+            hash_kind = Crypto::Hash::HashKind::SHA384;
+            break;
+        case SignatureAlgorithm::RSA_PSS_RSAE_SHA512:
+            hash_kind = Crypto::Hash::HashKind::SHA512;
+            break;
+        default:
+            dbgln("verify_rsa_signature failed: Signature algorithm is not RSA, instead {}", enum_to_string(algorithm.signature));
+            return (i8)Error::NotUnderstood;
+        }
+    } else {
+        dbgln("verify_rsa_signature failed: Signature algorithm is not RSA, instead {}", enum_to_string(algorithm.signature));
+        return (i8)Error::NotUnderstood;
+    }
+
     if (m_context.certificates.is_empty()) {
-        dbgln("verify_rsa_server_key_exchange failed: Attempting to verify signature without certificates");
+        dbgln("verify_rsa_signature failed: Attempting to verify signature without certificates");
         return (i8)Error::NotSafe;
     }
     // RFC5246 section 7.4.2: The sender's certificate MUST come first in the list.
@@ -381,49 +539,27 @@ ssize_t TLSv12::verify_rsa_server_key_exchange(ReadonlyBytes server_key_info_buf
     Crypto::PK::RSAPrivateKey dummy_private_key;
     auto rsa = Crypto::PK::RSA(certificate_public_key.rsa, dummy_private_key);
 
-    auto signature_verify_buffer_result = ByteBuffer::create_uninitialized(signature_length);
+    auto signature_verify_buffer_result = ByteBuffer::create_uninitialized(signature.size());
     if (signature_verify_buffer_result.is_error()) {
-        dbgln("verify_rsa_server_key_exchange failed: Not enough memory");
+        dbgln("verify_rsa_signature failed: Not enough memory");
         return (i8)Error::OutOfMemory;
     }
     auto signature_verify_buffer = signature_verify_buffer_result.release_value();
     auto signature_verify_bytes = signature_verify_buffer.bytes();
     rsa.verify(signature, signature_verify_bytes);
 
-    auto message_result = ByteBuffer::create_uninitialized(64 + server_key_info_buffer.size());
-    if (message_result.is_error()) {
-        dbgln("verify_rsa_server_key_exchange failed: Not enough memory");
-        return (i8)Error::OutOfMemory;
-    }
-    auto message = message_result.release_value();
-    message.overwrite(0, m_context.local_random, 32);
-    message.overwrite(32, m_context.remote_random, 32);
-    message.overwrite(64, server_key_info_buffer.data(), server_key_info_buffer.size());
-
-    Crypto::Hash::HashKind hash_kind;
-    switch ((HashAlgorithm)signature_hash) {
-    case HashAlgorithm::SHA1:
-        hash_kind = Crypto::Hash::HashKind::SHA1;
-        break;
-    case HashAlgorithm::SHA256:
-        hash_kind = Crypto::Hash::HashKind::SHA256;
-        break;
-    case HashAlgorithm::SHA384:
-        hash_kind = Crypto::Hash::HashKind::SHA384;
-        break;
-    case HashAlgorithm::SHA512:
-        hash_kind = Crypto::Hash::HashKind::SHA512;
-        break;
-    default:
-        dbgln("verify_rsa_server_key_exchange failed: Hash algorithm is not SHA1/256/384/512, instead {}", signature_hash);
-        return (i8)Error::NotUnderstood;
+    Crypto::VerificationConsistency verification;
+    if (is_pss) {
+        auto modulus_bits = certificate_public_key.rsa.modulus().one_based_index_of_highest_set_bit();
+        auto pss = Crypto::PK::EMSA_PSS<Crypto::Hash::Manager>(hash_kind);
+        verification = pss.verify(message, signature_verify_bytes, modulus_bits - 1);
+    } else {
+        auto pkcs1 = Crypto::PK::EMSA_PKCS1_V1_5<Crypto::Hash::Manager>(hash_kind);
+        verification = pkcs1.verify(message, signature_verify_bytes, signature.size() * 8);
     }
 
-    auto pkcs1 = Crypto::PK::EMSA_PKCS1_V1_5<Crypto::Hash::Manager>(hash_kind);
-    auto verification = pkcs1.verify(message, signature_verify_bytes, signature_length * 8);
-
     if (verification == Crypto::VerificationConsistency::Inconsistent) {
-        dbgln("verify_rsa_server_key_exchange failed: Verification of signature inconsistent");
+        dbgln("verify_rsa_signature failed: Verification of signature inconsistent");
         return (i8)Error::NotSafe;
     }
 
@@ -444,7 +580,10 @@ ssize_t TLSv12::handle_ecdhe_ecdsa_server_key_exchange(ReadonlyBytes buffer)
 
 ssize_t TLSv12::verify_ecdsa_server_key_exchange(ReadonlyBytes server_key_info_buffer, ReadonlyBytes signature_buffer)
 {
-    auto signature_hash = signature_buffer[0];
+    if (signature_buffer.size() < 4)
+        return (i8)Error::NeedMoreData;
+
+    auto signature_hash = static_cast<HashAlgorithm>(signature_buffer[0]);
     auto signature_algorithm = signature_buffer[1];
     if (signature_algorithm != (u8)SignatureAlgorithm::ECDSA) {
         dbgln("verify_ecdsa_server_key_exchange failed: Signature algorithm is not ECDSA, instead {}", signature_algorithm);
@@ -452,26 +591,30 @@ ssize_t TLSv12::verify_ecdsa_server_key_exchange(ReadonlyBytes server_key_info_b
     }
 
     auto signature_length = AK::convert_between_host_and_network_endian(ByteReader::load16(signature_buffer.offset_pointer(2)));
+    if (signature_buffer.size() - 4 < signature_length)
+        return (i8)Error::NeedMoreData;
     auto signature = signature_buffer.slice(4, signature_length);
 
-    if (m_context.certificates.is_empty()) {
-        dbgln("verify_ecdsa_server_key_exchange failed: Attempting to verify signature without certificates");
-        return (i8)Error::NotSafe;
-    }
-    ReadonlyBytes server_point = m_context.certificates.first().public_key.raw_key;
-
-    auto message_result = ByteBuffer::create_uninitialized(64 + server_key_info_buffer.size());
+    auto message_result = server_key_exchange_signed_content(m_context, server_key_info_buffer);
     if (message_result.is_error()) {
         dbgln("verify_ecdsa_server_key_exchange failed: Not enough memory");
         return (i8)Error::OutOfMemory;
     }
     auto message = message_result.release_value();
-    message.overwrite(0, m_context.local_random, 32);
-    message.overwrite(32, m_context.remote_random, 32);
-    message.overwrite(64, server_key_info_buffer.data(), server_key_info_buffer.size());
+
+    return verify_ecdsa_signature(signature_hash, message, signature);
+}
+
+ssize_t TLSv12::verify_ecdsa_signature(HashAlgorithm hash, ReadonlyBytes message, ReadonlyBytes signature)
+{
+    if (m_context.certificates.is_empty()) {
+        dbgln("verify_ecdsa_signature failed: Attempting to verify signature without certificates");
+        return (i8)Error::NotSafe;
+    }
+    ReadonlyBytes server_point = m_context.certificates.first().public_key.raw_key;
 
     Crypto::Hash::HashKind hash_kind;
-    switch ((HashAlgorithm)signature_hash) {
+    switch (hash) {
     case HashAlgorithm::SHA256:
         hash_kind = Crypto::Hash::HashKind::SHA256;
         break;
@@ -482,7 +625,7 @@ ssize_t TLSv12::verify_ecdsa_server_key_exchange(ReadonlyBytes server_key_info_b
         hash_kind = Crypto::Hash::HashKind::SHA512;
         break;
     default:
-        dbgln("verify_ecdsa_server_key_exchange failed: Hash algorithm is not SHA256/384/512, instead {}", signature_hash);
+        dbgln("verify_ecdsa_signature failed: Hash algorithm is not SHA256/384/512, instead {}", to_underlying(hash));
         return (i8)Error::NotUnderstood;
     }
 
@@ -508,19 +651,35 @@ ssize_t TLSv12::verify_ecdsa_server_key_exchange(ReadonlyBytes server_key_info_b
         break;
     }
     default: {
-        dbgln("verify_ecdsa_server_key_exchange failed: Server certificate public key algorithm is not supported: {}", to_underlying(public_key.algorithm.ec_parameters));
+        dbgln("verify_ecdsa_signature failed: Server certificate public key algorithm is not supported: {}", to_underlying(public_key.algorithm.ec_parameters));
         break;
     }
     }
 
     if (res.is_error()) {
-        dbgln("verify_ecdsa_server_key_exchange failed: {}", res.error());
+        dbgln("verify_ecdsa_signature failed: {}", res.error());
         return (i8)Error::NotUnderstood;
     }
 
     bool verification_ok = res.release_value();
     if (!verification_ok) {
-        dbgln("verify_ecdsa_server_key_exchange failed: Verification of signature failed");
+        dbgln("verify_ecdsa_signature failed: Verification of signature failed");
+        return (i8)Error::NotSafe;
+    }
+
+    return 0;
+}
+
+ssize_t TLSv12::verify_ed25519_signature(ReadonlyBytes message, ReadonlyBytes signature)
+{
+    if (m_context.certificates.is_empty()) {
+        dbgln("verify_ed25519_signature failed: Attempting to verify signature without certificates");
+        return (i8)Error::NotSafe;
+    }
+
+    Crypto::Curves::Ed25519 curve;
+    if (!curve.verify(m_context.certificates.first().public_key.raw_key, signature, message)) {
+        dbgln("verify_ed25519_signature failed: Verification of signature failed");
         return (i8)Error::NotSafe;
     }
 
@@ -0,0 +1,785 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/Endian.h>
+#include <AK/Hex.h>
+#include <AK/Memory.h>
+#include <AK/Random.h>
+#include <LibCore/File.h>
+#include <LibCore/Timer.h>
+#include <LibCrypto/Authentication/HMAC.h>
+#include <LibCrypto/Curves/SECPxxxr1.h>
+#include <LibCrypto/Curves/X25519.h>
+#include <LibCrypto/Curves/X448.h>
+#include <LibCrypto/Hash/HKDF.h>
+#include <LibTLS/KeySchedule.h>
+#include <LibTLS/TLSv12.h>
+
+namespace TLS {
+
+using HKDF = Crypto::Hash::HKDF<Crypto::Hash::Manager>;
+
+static void log_tls13_secret(ReadonlyBytes client_random, StringView label, ReadonlyBytes secret)
+{
+    if constexpr (TLS_SSL_KEYLOG_DEBUG) {
+        auto file = MUST(Core::File::open("/home/anon/ssl_keylog"sv, Core::File::OpenMode::Append | Core::File::OpenMode::Write));
+        MUST(file->write_until_depleted(label));
+        MUST(file->write_until_depleted(" "sv));
+        MUST(file->write_until_depleted(encode_hex(client_random)));
+        MUST(file->write_until_depleted(" "sv));
+        MUST(file->write_until_depleted(encode_hex(secret)));
+        MUST(file->write_until_depleted("\n"sv));
+    } else {
+        (void)client_random;
+        (void)label;
+        (void)secret;
+    }
+}
+
+ErrorOr<void> TLSv12::build_tls13_key_share(SupportedGroup group)
+{
+    OwnPtr<Crypto::Curves::EllipticCurve> curve;
+    switch (group) {
+    case SupportedGroup::X25519:
+        curve = make<Crypto::Curves::X25519>();
+        break;
+    case SupportedGroup::X448:
+        curve = make<Crypto::Curves::X448>();
+        break;
+    case SupportedGroup::SECP256R1:
+        curve = make<Crypto::Curves::SECP256r1>();
+        break;
+    case SupportedGroup::SECP384R1:
+        curve = make<Crypto::Curves::SECP384r1>();
+        break;
+    default:
+        return AK::Error::from_string_literal("Unsupported key share group");
+    }
+
+    auto private_key = TRY(curve->generate_private_key());
+    auto public_key = TRY(curve->generate_public_key(private_key));
+
+    m_context.tls13.key_share_group = group;
+    m_context.tls13.key_share_curve = move(curve);
+    m_context.tls13.key_share_private_key = move(private_key);
+    m_context.tls13.key_share_public_key = move(public_key);
+    return {};
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.2.11.2
+ErrorOr<void> TLSv12::write_tls13_psk_binder(ByteBuffer& client_hello)
+{
+    VERIFY(m_context.tls13.offered_ticket.has_value());
+    auto& ticket = *m_context.tls13.offered_ticket;
+    auto hash_kind = TLS13::hash_kind(ticket.cipher);
+
+    // The binder covers the ClientHello up to, but not including, the list of binders. After a HelloRetryRequest,
+    // it also covers the messages before this ClientHello.
+    Crypto::Hash::Manager transcript = m_context.tls13.did_hello_retry ? m_context.handshake_hash.copy() : Crypto::Hash::Manager(hash_kind);
+    auto hash_size = transcript.digest_size();
+    auto binders_size = 2 + 1 + hash_size;
+    constexpr size_t header_size = 5;
+    VERIFY(client_hello.size() >= header_size + binders_size);
+
+    transcript.update(client_hello.bytes().slice(header_size, client_hello.size() - header_size - binders_size));
+    auto transcript_hash = transcript.digest();
+
+    auto early_secret = TRY(HKDF::extract({}, ticket.pre_shared_key, hash_kind));
+    auto binder_key = TRY(TLS13::derive_secret_for_empty_transcript(hash_kind, early_secret, "res binder"sv));
+    auto finished_key = TRY(TLS13::hkdf_expand_label(hash_kind, binder_key, "finished"sv, {}, hash_size));
+
+    Crypto::Authentication::HMAC<Crypto::Hash::Manager> hmac(finished_key.bytes(), hash_kind);
+    auto binder = hmac.process(transcript_hash.bytes());
+    client_hello.overwrite(client_hello.size() - hash_size, binder.immutable_data(), hash_size);
+    return {};
+}
+
+ssize_t TLSv12::handle_tls13_server_hello(ReadonlyBytes key_share, Optional<u16> selected_identity, ReadonlyBytes cookie, bool is_hello_retry_request, WritePacketStage& write_packets)
+{
+    if (is_hello_retry_request) {
+        // https://www.rfc-editor.org/rfc/rfc8446#section-4.1.4
+        if (m_context.tls13.did_hello_retry) {
+            dbgln("Received a second HelloRetryRequest");
+            return (i8)Error::UnexpectedMessage;
+        }
+
+        // A HelloRetryRequest only carries the group that the server wants a key share for.
+        if (!key_share.is_empty()) {
+            if (key_share.size() != 2)
+                return (i8)Error::BrokenPacket;
+            auto group = static_cast<SupportedGroup>(AK::convert_between_host_and_network_endian(ByteReader::load16(key_share.data())));
+            if (group == m_context.tls13.key_share_group || !m_context.options.elliptic_curves.contains_slow(group)) {
+                dbgln("HelloRetryRequest asks for a key share for an unexpected group: {}", to_underlying(group));
+                return (i8)Error::NotSafe;
+            }
+            if (build_tls13_key_share(group).is_error()) {
+                dbgln("Failed to build a key share for the group requested by the server: {}", to_underlying(group));
+                return (i8)Error::NotUnderstood;
+            }
+        } else if (cookie.is_empty()) {
+            dbgln("HelloRetryRequest would not change the ClientHello");
+            return (i8)Error::NotSafe;
+        }
+
+        if (!cookie.is_empty()) {
+            auto cookie_copy = ByteBuffer::copy(cookie);
+            if (cookie_copy.is_error())
+                return (i8)Error::OutOfMemory;
+            m_context.tls13.cookie = cookie_copy.release_value();
+        }
+
+        // The binder in the second ClientHello is computed with the hash of the cipher suite picked by the server.
+        if (auto& ticket = m_context.tls13.offered_ticket; ticket.has_value() && TLS13::hash_kind(ticket->cipher) != hmac_hash())
+            ticket.clear();
+
+        if (restart_transcript_for_hello_retry().is_error())
+            return (i8)Error::OutOfMemory;
+
+        m_context.tls13.did_hello_retry = true;
+        // The real ServerHello is still to come.
+        m_context.handshake_messages[2] = 0;
+        write_packets = WritePacketStage::ClientHelloRetry;
+        return 0;
+    }
+
+    // https://www.rfc-editor.org/rfc/rfc8446#section-4.2.8
+    // struct {
+    //     NamedGroup group;
+    //     opaque key_exchange<1..2^16-1>;
+    // } KeyShareEntry;
+    if (key_share.size() < 4) {
+        dbgln("Server did not send a key share");
+        return (i8)Error::NotSafe;
+    }
+    auto group = static_cast<SupportedGroup>(AK::convert_between_host_and_network_endian(ByteReader::load16(key_share.data())));
+    auto key_exchange_length = AK::convert_between_host_and_network_endian(ByteReader::load16(key_share.offset(2)));
+    if (key_share.size() - 4 != key_exchange_length)
+        return (i8)Error::BrokenPacket;
+    if (group != m_context.tls13.key_share_group) {
+        dbgln("Server sent a key share for a group that we did not offer: {}", to_underlying(group));
+        return (i8)Error::NotSafe;
+    }
+
+    auto& curve = *m_context.tls13.key_share_curve;
+    auto shared_point = curve.compute_coordinate(m_context.tls13.key_share_private_key, key_share.slice(4));
+    if (shared_point.is_error()) {
+        dbgln("Failed to compute the shared secret: {}", shared_point.error());
+        return (i8)Error::NotSafe;
+    }
+    auto premaster_key = curve.derive_premaster_key(shared_point.value());
+    if (premaster_key.is_error()) {
+        dbgln("Failed to derive the shared secret: {}", premaster_key.error());
+        return (i8)Error::NotSafe;
+    }
+    m_context.premaster_key = premaster_key.release_value();
+    m_context.tls13.key_share_private_key.clear();
+
+    // https://www.rfc-editor.org/rfc/rfc8446#section-4.2.11
+    if (selected_identity.has_value()) {
+        auto& ticket = m_context.tls13.offered_ticket;
+        if (!ticket.has_value() || *selected_identity != 0 || TLS13::hash_kind(ticket->cipher) != hmac_hash()) {
+            dbgln("Server selected a pre-shared key that we did not offer");
+            return (i8)Error::NotSafe;
+        }
+        m_context.tls13.psk_accepted = true;
+        dbgln_if(TLS_DEBUG, "Resuming TLS 1.3 session");
+    }
+
+    m_context.tls13.state = TLS13HandshakeState::WaitEncryptedExtensions;
+    return 0;
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.4.1
+ErrorOr<void> TLSv12::restart_transcript_for_hello_retry()
+{
+    // Note: The ClientHello may still be waiting in the pre-initialization buffer of the hash, so flush it first.
+    u8 const nothing = 0;
+    m_context.handshake_hash.update(&nothing, 0);
+    auto client_hello_hash = m_context.handshake_hash.digest();
+    auto hash_size = m_context.handshake_hash.digest_size();
+
+    // Transcript-Hash(ClientHello1, HelloRetryRequest, ... Mn) =
+    //     Hash(message_hash ||        /* Handshake type */
+    //          00 00 Hash.length  ||  /* Handshake message length (bytes) */
+    //          Hash(ClientHello1) ||  /* Hash of ClientHello1 */
+    //          HelloRetryRequest  || ... || Mn)
+    u8 header[4] = { (u8)HandshakeType::MESSAGE_HASH, 0, 0, (u8)hash_size };
+    m_context.handshake_hash.update(header, sizeof(header));
+    m_context.handshake_hash.update(client_hello_hash.immutable_data(), hash_size);
+    return {};
+}
+
+ErrorOr<void> TLSv12::derive_tls13_handshake_secrets()
+{
+    auto& tls13 = m_context.tls13;
+    auto pre_shared_key = tls13.psk_accepted ? tls13.offered_ticket->pre_shared_key.bytes() : ReadonlyBytes {};
+    auto transcript_hash = m_context.handshake_hash.copy().digest();
+    auto secrets = TRY(TLS13::derive_handshake_secrets(hmac_hash(), pre_shared_key, m_context.premaster_key, transcript_hash.bytes().trim(mac_length())));
+    m_context.premaster_key.clear();
+
+    tls13.early_secret = move(secrets.early_secret);
+    tls13.handshake_secret = move(secrets.handshake_secret);
+    tls13.client_handshake_traffic_secret = move(secrets.client_handshake_traffic_secret);
+    tls13.server_handshake_traffic_secret = move(secrets.server_handshake_traffic_secret);
+    tls13.master_secret = move(secrets.master_secret);
+
+    ReadonlyBytes client_random { m_context.local_random, sizeof(m_context.local_random) };
+    log_tls13_secret(client_random, "CLIENT_HANDSHAKE_TRAFFIC_SECRET"sv, tls13.client_handshake_traffic_secret);
+    log_tls13_secret(client_random, "SERVER_HANDSHAKE_TRAFFIC_SECRET"sv, tls13.server_handshake_traffic_secret);
+
+    TRY(install_tls13_traffic_key(tls13.client_handshake_traffic_secret, true));
+    TRY(install_tls13_traffic_key(tls13.server_handshake_traffic_secret, false));
+    return {};
+}
+
+ErrorOr<void> TLSv12::derive_tls13_application_secrets()
+{
+    //   0 -> HKDF-Extract = Master Secret
+    //              |
+    //              +-----> Derive-Secret(., "c ap traffic", ClientHello...server Finished)
+    //              +-----> Derive-Secret(., "s ap traffic", ClientHello...server Finished)
+    auto hash_kind = hmac_hash();
+    auto transcript_hash = m_context.handshake_hash.copy().digest();
+    auto transcript = transcript_hash.bytes().trim(mac_length());
+
+    auto& tls13 = m_context.tls13;
+    tls13.client_application_traffic_secret = TRY(TLS13::derive_secret(hash_kind, tls13.master_secret, "c ap traffic"sv, transcript));
+    tls13.server_application_traffic_secret = TRY(TLS13::derive_secret(hash_kind, tls13.master_secret, "s ap traffic"sv, transcript));
+
+    ReadonlyBytes client_random { m_context.local_random, sizeof(m_context.local_random) };
+    log_tls13_secret(client_random, "CLIENT_TRAFFIC_SECRET_0"sv, tls13.client_application_traffic_secret);
+    log_tls13_secret(client_random, "SERVER_TRAFFIC_SECRET_0"sv, tls13.server_application_traffic_secret);
+    return {};
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-7.3
+ErrorOr<void> TLSv12::install_tls13_traffic_key(ReadonlyBytes traffic_secret, bool local)
+{
+    auto key_size = key_length();
+    auto traffic_key = TRY(TLS13::derive_traffic_key(hmac_hash(), traffic_secret, key_size));
+
+    if (local) {
+        memcpy(m_context.crypto.local_aead_iv, traffic_key.iv, sizeof(traffic_key.iv));
+        m_cipher_local = Crypto::Cipher::AESCipher::GCMMode(traffic_key.key, key_size * 8, Crypto::Cipher::Intent::Encryption, Crypto::Cipher::PaddingMode::RFC5246);
+        m_context.local_sequence_number = 0;
+    } else {
+        memcpy(m_context.crypto.remote_aead_iv, traffic_key.iv, sizeof(traffic_key.iv));
+        m_cipher_remote = Crypto::Cipher::AESCipher::GCMMode(traffic_key.key, key_size * 8, Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::RFC5246);
+        m_context.remote_sequence_number = 0;
+    }
+
+    m_context.crypto.created = 1;
+    m_context.cipher_spec_set = 1;
+    return {};
+}
+
+ssize_t TLSv12::handle_tls13_handshake_message(HandshakeType type, ReadonlyBytes message, WritePacketStage& write_packets)
+{
+    auto payload = message.slice(4);
+    auto state = m_context.tls13.state;
+    auto expects = [&](TLS13HandshakeState expected_state) {
+        if (state == expected_state)
+            return true;
+        dbgln("unexpected TLS 1.3 handshake message: {}", enum_to_string(type));
+        return false;
+    };
+
+    // https://www.rfc-editor.org/rfc/rfc8446#appendix-A.1
+    bool is_part_of_transcript = true;
+    ssize_t result = 0;
+    switch (type) {
+    case HandshakeType::ENCRYPTED_EXTENSIONS:
+        if (!expects(TLS13HandshakeState::WaitEncryptedExtensions))
+            return (i8)Error::UnexpectedMessage;
+        dbgln_if(TLS_DEBUG, "encrypted extensions");
+        result = handle_tls13_encrypted_extensions(payload);
+        break;
+    case HandshakeType::CERTIFICATE_REQUEST:
+        if (!expects(TLS13HandshakeState::WaitCertificateOrCertificateRequest))
+            return (i8)Error::UnexpectedMessage;
+        dbgln_if(TLS_DEBUG, "certificate request");
+        result = handle_tls13_certificate_request(payload);
+        break;
+    case HandshakeType::CERTIFICATE:
+        if (state != TLS13HandshakeState::WaitCertificate && !expects(TLS13HandshakeState::WaitCertificateOrCertificateRequest))
+            return (i8)Error::UnexpectedMessage;
+        dbgln_if(TLS_DEBUG, "certificate");
+        result = handle_tls13_certificate(payload);
+        break;
+    case HandshakeType::CERTIFICATE_VERIFY:
+        if (!expects(TLS13HandshakeState::WaitCertificateVerify))
+            return (i8)Error::UnexpectedMessage;
+        dbgln_if(TLS_DEBUG, "certificate verify");
+        result = handle_tls13_certificate_verify(payload);
+        break;
+    case HandshakeType::FINISHED:
+        if (!expects(TLS13HandshakeState::WaitFinished))
+            return (i8)Error::UnexpectedMessage;
+        dbgln_if(TLS_DEBUG, "finished");
+        result = handle_tls13_finished(payload);
+        if (result >= 0)
+            write_packets = WritePacketStage::ClientFinishedTLS13;
+        break;
+    case HandshakeType::NEW_SESSION_TICKET:
+        if (!expects(TLS13HandshakeState::Connected))
+            return (i8)Error::UnexpectedMessage;
+        dbgln_if(TLS_DEBUG, "new session ticket");
+        result = handle_tls13_new_session_ticket(payload);
+        is_part_of_transcript = false;
+        break;
+    case HandshakeType::KEY_UPDATE:
+        if (!expects(TLS13HandshakeState::Connected))
+            return (i8)Error::UnexpectedMessage;
+        dbgln_if(TLS_DEBUG, "key update");
+        result = handle_tls13_key_update(payload);
+        is_part_of_transcript = false;
+        break;
+    default:
+        dbgln("unexpected TLS 1.3 handshake message: {}", enum_to_string(type));
+        return (i8)Error::UnexpectedMessage;
+    }
+
+    if (result < 0)
+        return result;
+
+    if (is_part_of_transcript)
+        update_hash(message, 0);
+
+    // The application traffic secrets cover the transcript up to the server Finished.
+    if (type == HandshakeType::FINISHED && derive_tls13_application_secrets().is_error())
+        return (i8)Error::OutOfMemory;
+
+    return message.size();
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.3.1
+ssize_t TLSv12::handle_tls13_encrypted_extensions(ReadonlyBytes buffer)
+{
+    // struct {
+    //     Extension extensions<0..2^16-1>;
+    // } EncryptedExtensions;
+    if (buffer.size() < 2)
+        return (i8)Error::BrokenPacket;
+    auto extensions_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.data()));
+    if (buffer.size() - 2 != extensions_length)
+        return (i8)Error::BrokenPacket;
+
+    size_t offset = 2;
+    while (offset < buffer.size()) {
+        if (buffer.size() - offset < 4)
+            return (i8)Error::BrokenPacket;
+        auto extension_type = static_cast<ExtensionType>(AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset(offset))));
+        auto extension_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset(offset + 2)));
+        offset += 4;
+        if (buffer.size() - offset < extension_length)
+            return (i8)Error::BrokenPacket;
+        // Note: We do not ask for any of the extensions that servers put here (e.g. ALPN or early_data).
+        dbgln_if(TLS_DEBUG, "Encrypted extension {} with length {}", enum_to_string(extension_type), extension_length);
+        offset += extension_length;
+    }
+
+    // A server that accepted our pre-shared key does not authenticate itself with a certificate again.
+    m_context.tls13.state = m_context.tls13.psk_accepted ? TLS13HandshakeState::WaitFinished : TLS13HandshakeState::WaitCertificateOrCertificateRequest;
+    return buffer.size();
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.3.2
+ssize_t TLSv12::handle_tls13_certificate_request(ReadonlyBytes buffer)
+{
+    // struct {
+    //     opaque certificate_request_context<0..2^8-1>;
+    //     Extension extensions<2..2^16-1>;
+    // } CertificateRequest;
+    if (buffer.size() < 1 || buffer.size() - 1 < buffer[0])
+        return (i8)Error::BrokenPacket;
+
+    auto context = ByteBuffer::copy(buffer.slice(1, buffer[0]));
+    if (context.is_error())
+        return (i8)Error::OutOfMemory;
+    m_context.tls13.certificate_request_context = context.release_value();
+
+    if (on_tls_certificate_request)
+        on_tls_certificate_request(*this);
+
+    m_context.tls13.state = TLS13HandshakeState::WaitCertificate;
+    return buffer.size();
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.4.2
+ssize_t TLSv12::handle_tls13_certificate(ReadonlyBytes buffer)
+{
+    // struct {
+    //     opaque cert_data<1..2^24-1>;
+    //     Extension extensions<0..2^16-1>;
+    // } CertificateEntry;
+    //
+    // struct {
+    //     opaque certificate_request_context<0..2^8-1>;
+    //     CertificateEntry certificate_list<0..2^24-1>;
+    // } Certificate;
+    if (buffer.size() < 4)
+        return (i8)Error::BrokenPacket;
+    if (buffer[0] != 0) {
+        dbgln("Server certificate has a non-empty request context");
+        return (i8)Error::UnexpectedMessage;
+    }
+
+    size_t certificate_list_length = buffer[1] * 0x10000 + buffer[2] * 0x100 + buffer[3];
+    if (buffer.size() - 4 != certificate_list_length)
+        return (i8)Error::BrokenPacket;
+
+    size_t offset = 4;
+    while (offset < buffer.size()) {
+        if (buffer.size() - offset < 3)
+            return (i8)Error::BrokenPacket;
+        size_t certificate_size = buffer[offset] * 0x10000 + buffer[offset + 1] * 0x100 + buffer[offset + 2];
+        offset += 3;
+        if (buffer.size() - offset < certificate_size + 2)
+            return (i8)Error::BrokenPacket;
+
+        auto certificate = Certificate::parse_certificate(buffer.slice(offset, certificate_size), false);
+        if (!certificate.is_error()) {
+            m_context.certificates.empend(certificate.release_value());
+        } else {
+            dbgln("Failed to parse server certificate: {}", certificate.error());
+            // RFC 8446 section 4.4.2: The sender's certificate MUST come first in the list.
+            if (m_context.certificates.is_empty())
+                return (i8)Error::UnsupportedCertificate;
+        }
+        offset += certificate_size;
+
+        size_t extensions_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset(offset)));
+        offset += 2;
+        if (buffer.size() - offset < extensions_length)
+            return (i8)Error::BrokenPacket;
+        offset += extensions_length;
+    }
+
+    if (m_context.certificates.is_empty()) {
+        dbgln("Server did not send a certificate");
+        return (i8)Error::BadCertificate;
+    }
+
+    if (!m_context.verify_chain(m_context.extensions.SNI)) {
+        dbgln("certificate verification failed :(");
+        return (i8)Error::BadCertificate;
+    }
+
+    m_context.tls13.state = TLS13HandshakeState::WaitCertificateVerify;
+    return buffer.size();
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.4.3
+ssize_t TLSv12::handle_tls13_certificate_verify(ReadonlyBytes buffer)
+{
+    // struct {
+    //     SignatureScheme algorithm;
+    //     opaque signature<0..2^16-1>;
+    // } CertificateVerify;
+    if (buffer.size() < 4)
+        return (i8)Error::BrokenPacket;
+    SignatureAndHashAlgorithm algorithm { static_cast<HashAlgorithm>(buffer[0]), static_cast<SignatureAlgorithm>(buffer[1]) };
+    auto signature_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset(2)));
+    if (buffer.size() - 4 != signature_length)
+        return (i8)Error::BrokenPacket;
+    auto signature = buffer.slice(4);
+
+    bool was_offered = any_of(m_context.options.supported_signature_algorithms, [&](auto& offered) {
+        return offered.hash == algorithm.hash && offered.signature == algorithm.signature;
+    });
+    if (!was_offered) {
+        dbgln("Server signed with an algorithm that we did not offer: {}/{}", to_underlying(algorithm.hash), enum_to_string(algorithm.signature));
+        return (i8)Error::NotSafe;
+    }
+
+    // The signature covers 64 spaces, a context string, a zero byte and the transcript hash.
+    constexpr auto context_string = "TLS 1.3, server CertificateVerify"sv;
+    auto transcript_hash = m_context.handshake_hash.copy().digest();
+    auto hash_size = mac_length();
+
+    u8 content[64 + context_string.length() + 1 + Crypto::Hash::SHA512::DigestSize];
+    memset(content, 0x20, 64);
+    memcpy(content + 64, context_string.characters_without_null_termination(), context_string.length());
+    content[64 + context_string.length()] = 0;
+    memcpy(content + 64 + context_string.length() + 1, transcript_hash.immutable_data(), hash_size);
+    ReadonlyBytes message { content, 64 + context_string.length() + 1 + hash_size };
+
+    ssize_t result;
+    if (algorithm.hash == HashAlgorithm::INTRINSIC && algorithm.signature == SignatureAlgorithm::ED25519) {
+        result = verify_ed25519_signature(message, signature);
+    } else if (algorithm.hash == HashAlgorithm::INTRINSIC) {
+        result = verify_rsa_signature(algorithm, message, signature);
+    } else if (algorithm.signature == SignatureAlgorithm::ECDSA) {
+        result = verify_ecdsa_signature(algorithm.hash, message, signature);
+    } else {
+        // RSASSA-PKCS1-v1_5 is only allowed in certificates, not in handshake signatures.
+        dbgln("Server signed with an algorithm that TLS 1.3 does not allow: {}", enum_to_string(algorithm.signature));
+        return (i8)Error::NotSafe;
+    }
+    if (result < 0)
+        return result;
+
+    m_context.tls13.state = TLS13HandshakeState::WaitFinished;
+    return buffer.size();
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.4.4
+ssize_t TLSv12::handle_tls13_finished(ReadonlyBytes buffer)
+{
+    auto hash_size = mac_length();
+    if (buffer.size() != hash_size)
+        return (i8)Error::BrokenPacket;
+
+    auto transcript_hash = m_context.handshake_hash.copy().digest();
+    auto verify_data = TLS13::finished_verify_data(hmac_hash(), m_context.tls13.server_handshake_traffic_secret, transcript_hash.bytes().trim(hash_size));
+    if (verify_data.is_error())
+        return (i8)Error::OutOfMemory;
+
+    if (!timing_safe_compare(verify_data.value().data(), buffer.data(), hash_size)) {
+        dbgln("Server Finished does not match the handshake");
+        return (i8)Error::NotSafe;
+    }
+
+    m_context.tls13.state = TLS13HandshakeState::Connected;
+    return buffer.size();
+}
+
+ErrorOr<ByteBuffer> TLSv12::build_tls13_finished()
+{
+    auto hash_size = mac_length();
+    auto transcript_hash = m_context.handshake_hash.copy().digest();
+    auto verify_data = TRY(TLS13::finished_verify_data(hmac_hash(), m_context.tls13.client_handshake_traffic_secret, transcript_hash.bytes().trim(hash_size)));
+
+    PacketBuilder builder { ContentType::HANDSHAKE, m_context.options.version, hash_size + 64 };
+    builder.append((u8)HandshakeType::FINISHED);
+    builder.append_u24(hash_size);
+    builder.append(verify_data.data(), hash_size);
+    auto packet = builder.build();
+    update_packet(packet);
+    return packet;
+}
+
+void TLSv12::send_tls13_client_finished()
+{
+    // RFC 8446 appendix D.4: A change_cipher_spec record before the second flight makes the handshake look like a
+    // resumed TLS 1.2 session to middleboxes. It is neither protected nor counted.
+    {
+        dbgln_if(TLS_DEBUG, "> change cipher spec (compatibility)");
+        PacketBuilder builder { ContentType::CHANGE_CIPHER_SPEC, m_context.options.version, 6 };
+        builder.append((u8)1);
+        auto packet = builder.build();
+        ByteReader::store(packet.offset_pointer(3), AK::convert_between_host_and_network_endian((u16)1));
+        write_packet(packet);
+    }
+
+    if (auto& context = m_context.tls13.certificate_request_context; context.has_value()) {
+        // FIXME: Send the client certificates along with a CertificateVerify. For now we tell the server that we
+        //        have none, which it may or may not accept.
+        dbgln_if(TLS_DEBUG, "> empty client certificate");
+        PacketBuilder builder { ContentType::HANDSHAKE, m_context.options.version, 16 + context->size() };
+        builder.append((u8)HandshakeType::CERTIFICATE);
+        builder.append_u24(1 + context->size() + 3);
+        builder.append((u8)context->size());
+        builder.append(context->bytes());
+        builder.append_u24(0);
+        auto packet = builder.build();
+        update_packet(packet);
+        write_packet(packet);
+    }
+
+    auto finished = build_tls13_finished();
+    if (finished.is_error()) {
+        dbgln("Failed to build the client Finished: {}", finished.error());
+        alert(AlertLevel::FATAL, AlertDescription::INTERNAL_ERROR);
+        return;
+    }
+    dbgln_if(TLS_DEBUG, "> client finished");
+    write_packet(finished.value());
+
+    // The resumption master secret covers the transcript up to the client Finished.
+    auto& tls13 = m_context.tls13;
+    auto transcript_hash = m_context.handshake_hash.copy().digest();
+    auto resumption_master_secret = TLS13::derive_secret(hmac_hash(), tls13.master_secret, "res master"sv, transcript_hash.bytes().trim(mac_length()));
+    if (resumption_master_secret.is_error()
+        || install_tls13_traffic_key(tls13.client_application_traffic_secret, true).is_error()
+        || install_tls13_traffic_key(tls13.server_application_traffic_secret, false).is_error()) {
+        dbgln("Failed to derive the application traffic keys");
+        alert(AlertLevel::FATAL, AlertDescription::INTERNAL_ERROR);
+        return;
+    }
+    tls13.resumption_master_secret = resumption_master_secret.release_value();
+
+    // None of these are needed anymore.
+    tls13.early_secret.clear();
+    tls13.handshake_secret.clear();
+    tls13.master_secret.clear();
+    tls13.client_handshake_traffic_secret.clear();
+    tls13.server_handshake_traffic_secret.clear();
+    tls13.offered_ticket.clear();
+
+    m_context.connection_status = ConnectionStatus::Established;
+
+    if (m_handshake_timeout_timer) {
+        // Disable the handshake timeout timer as handshake has been established.
+        m_handshake_timeout_timer->stop();
+        m_handshake_timeout_timer->remove_from_parent();
+        m_handshake_timeout_timer = nullptr;
+    }
+
+    if (on_connected)
+        on_connected();
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.6.1
+ssize_t TLSv12::handle_tls13_new_session_ticket(ReadonlyBytes buffer)
+{
+    // struct {
+    //     uint32 ticket_lifetime;
+    //     uint32 ticket_age_add;
+    //     opaque ticket_nonce<0..255>;
+    //     opaque ticket<1..2^16-1>;
+    //     Extension extensions<0..2^16-2>;
+    // } NewSessionTicket;
+    if (buffer.size() < 9)
+        return (i8)Error::BrokenPacket;
+    u32 lifetime = AK::convert_between_host_and_network_endian(ByteReader::load32(buffer.data()));
+    u32 age_add = AK::convert_between_host_and_network_endian(ByteReader::load32(buffer.offset(4)));
+    size_t nonce_length = buffer[8];
+    size_t offset = 9;
+    if (buffer.size() - offset < nonce_length + 2)
+        return (i8)Error::BrokenPacket;
+    auto nonce = buffer.slice(offset, nonce_length);
+    offset += nonce_length;
+    size_t ticket_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset(offset)));
+    offset += 2;
+    if (ticket_length == 0 || buffer.size() - offset < ticket_length + 2)
+        return (i8)Error::BrokenPacket;
+    auto ticket = buffer.slice(offset, ticket_length);
+    offset += ticket_length;
+    size_t extensions_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset(offset)));
+    offset += 2;
+    if (buffer.size() - offset != extensions_length)
+        return (i8)Error::BrokenPacket;
+
+    // Servers must not use lifetimes longer than seven days, and zero means that the ticket should be dropped right away.
+    constexpr u32 max_ticket_lifetime_in_seconds = 7 * 24 * 60 * 60;
+    auto& cache = m_context.options.session_cache;
+    if (!cache || m_context.extensions.SNI.is_empty() || lifetime == 0 || lifetime > max_ticket_lifetime_in_seconds)
+        return buffer.size();
+
+    auto hash_kind = hmac_hash();
+    auto pre_shared_key = TLS13::hkdf_expand_label(hash_kind, m_context.tls13.resumption_master_secret, "resumption"sv, nonce, mac_length());
+    auto ticket_copy = ByteBuffer::copy(ticket);
+    if (pre_shared_key.is_error() || ticket_copy.is_error())
+        return (i8)Error::OutOfMemory;
+
+    auto now = UnixDateTime::now();
+    cache->store_tls13_ticket(m_context.extensions.SNI,
+        SessionCache::TLS13Ticket {
+            .ticket = ticket_copy.release_value(),
+            .pre_shared_key = pre_shared_key.release_value(),
+            .cipher = m_context.cipher,
+            .age_add = age_add,
+            .received_at = now,
+            .expires_at = now + Duration::from_seconds(lifetime),
+        });
+    return buffer.size();
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.6.3
+ssize_t TLSv12::handle_tls13_key_update(ReadonlyBytes buffer)
+{
+    // enum {
+    //     update_not_requested(0), update_requested(1), (255)
+    // } KeyUpdateRequest;
+    if (buffer.size() != 1 || buffer[0] > 1)
+        return (i8)Error::BrokenPacket;
+    bool update_requested = buffer[0] == 1;
+
+    // application_traffic_secret_N+1 = HKDF-Expand-Label(application_traffic_secret_N, "traffic upd", "", Hash.length)
+    auto hash_kind = hmac_hash();
+    auto& tls13 = m_context.tls13;
+    auto server_secret = TLS13::hkdf_expand_label(hash_kind, tls13.server_application_traffic_secret, "traffic upd"sv, {}, mac_length());
+    if (server_secret.is_error())
+        return (i8)Error::OutOfMemory;
+    tls13.server_application_traffic_secret = server_secret.release_value();
+    if (install_tls13_traffic_key(tls13.server_application_traffic_secret, false).is_error())
+        return (i8)Error::OutOfMemory;
+
+    if (update_requested) {
+        // Our KeyUpdate is still protected with the old key, everything after it uses the new one.
+        auto packet = build_tls13_key_update(false);
+        write_packet(packet);
+
+        auto client_secret = TLS13::hkdf_expand_label(hash_kind, tls13.client_application_traffic_secret, "traffic upd"sv, {}, mac_length());
+        if (client_secret.is_error())
+            return (i8)Error::OutOfMemory;
+        tls13.client_application_traffic_secret = client_secret.release_value();
+        if (install_tls13_traffic_key(tls13.client_application_traffic_secret, true).is_error())
+            return (i8)Error::OutOfMemory;
+    }
+
+    return buffer.size();
+}
+
+ByteBuffer TLSv12::build_tls13_key_update(bool update_requested)
+{
+    PacketBuilder builder { ContentType::HANDSHAKE, m_context.options.version, 32 };
+    builder.append((u8)HandshakeType::KEY_UPDATE);
+    builder.append_u24(1);
+    builder.append((u8)(update_requested ? 1 : 0));
+    auto packet = builder.build();
+    update_packet(packet);
+    return packet;
+}
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-5.2
+void TLSv12::encrypt_tls13_record(ByteBuffer& packet)
+{
+    constexpr size_t header_size = 5;
+
+    auto& gcm = m_cipher_local.get<Crypto::Cipher::AESCipher::GCMMode>();
+    auto record = TLS13::encrypt_record(gcm, m_context.crypto.local_aead_iv, m_context.local_sequence_number, static_cast<ContentType>(packet[0]), packet.bytes().slice(header_size));
+    if (record.is_error()) {
+        dbgln("LibTLS: Failed to allocate enough memory for the ciphertext");
+        VERIFY_NOT_REACHED();
+    }
+
+    packet = record.release_value();
+}
+
+ssize_t TLSv12::decrypt_tls13_record(ReadonlyBytes buffer, ByteBuffer& decrypted, ContentType& type)
+{
+    auto& gcm = m_cipher_remote.get<Crypto::Cipher::AESCipher::GCMMode>();
+    auto result = TLS13::decrypt_record(gcm, m_context.crypto.remote_aead_iv, m_context.remote_sequence_number, buffer, decrypted);
+    if (result.is_error()) {
+        auto alert_description = result.error();
+        dbgln("Failed to decrypt TLS 1.3 record: {}", enum_to_string(alert_description));
+        auto packet = build_alert(true, (u8)alert_description);
+        write_packet(packet);
+
+        switch (alert_description) {
+        case AlertDescription::DECODE_ERROR:
+            return (i8)Error::BrokenPacket;
+        case AlertDescription::BAD_RECORD_MAC:
+            return (i8)Error::IntegrityCheckFailed;
+        case AlertDescription::UNEXPECTED_MESSAGE:
+            return (i8)Error::UnexpectedMessage;
+        default:
+            return (i8)Error::DecryptionFailed;
+        }
+    }
+    type = result.release_value();
+
+    if constexpr (TLS_DEBUG) {
+        dbgln("Decrypted TLS 1.3 record of type {}: ", enum_to_string(type));
+        print_buffer(decrypted);
+    }
+    return 0;
+}
+
+}
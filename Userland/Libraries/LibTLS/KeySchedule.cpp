@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <LibCrypto/Authentication/HMAC.h>
+#include <LibCrypto/Hash/HKDF.h>
+#include <LibCrypto/Hash/SHA2.h>
+#include <LibTLS/KeySchedule.h>
+
+namespace TLS::TLS13 {
+
+using HKDF = Crypto::Hash::HKDF<Crypto::Hash::Manager>;
+
+static constexpr size_t record_header_size = 5;
+static constexpr size_t record_tag_size = 16;
+
+Crypto::Hash::HashKind hash_kind(CipherSuite suite)
+{
+    switch (suite) {
+    case CipherSuite::TLS_AES_256_GCM_SHA384:
+        return Crypto::Hash::HashKind::SHA384;
+    default:
+        return Crypto::Hash::HashKind::SHA256;
+    }
+}
+
+ErrorOr<ByteBuffer> hkdf_expand_label(Crypto::Hash::HashKind hash_kind, ReadonlyBytes secret, StringView label, ReadonlyBytes context, size_t length)
+{
+    // struct {
+    //     uint16 length = Length;
+    //     opaque label<7..255> = "tls13 " + Label;
+    //     opaque context<0..255> = Context;
+    // } HkdfLabel;
+    constexpr auto label_prefix = "tls13 "sv;
+    VERIFY(label_prefix.length() + label.length() <= 255);
+    VERIFY(context.size() <= 255);
+
+    ByteBuffer hkdf_label;
+    TRY(hkdf_label.try_ensure_capacity(2 + 1 + label_prefix.length() + label.length() + 1 + context.size()));
+
+    u16 length_in_network_order = AK::convert_between_host_and_network_endian((u16)length);
+    TRY(hkdf_label.try_append(&length_in_network_order, sizeof(length_in_network_order)));
+    TRY(hkdf_label.try_append((u8)(label_prefix.length() + label.length())));
+    TRY(hkdf_label.try_append(label_prefix.bytes()));
+    TRY(hkdf_label.try_append(label.bytes()));
+    TRY(hkdf_label.try_append((u8)context.size()));
+    TRY(hkdf_label.try_append(context));
+
+    return HKDF::expand(secret, hkdf_label, length, hash_kind);
+}
+
+// Derive-Secret(Secret, Label, Messages) = HKDF-Expand-Label(Secret, Label, Transcript-Hash(Messages), Hash.length)
+ErrorOr<ByteBuffer> derive_secret(Crypto::Hash::HashKind hash_kind, ReadonlyBytes secret, StringView label, ReadonlyBytes transcript_hash)
+{
+    return hkdf_expand_label(hash_kind, secret, label, transcript_hash, transcript_hash.size());
+}
+
+ErrorOr<ByteBuffer> derive_secret_for_empty_transcript(Crypto::Hash::HashKind hash_kind, ReadonlyBytes secret, StringView label)
+{
+    Crypto::Hash::Manager hash { hash_kind };
+    auto empty_hash = hash.digest();
+    return derive_secret(hash_kind, secret, label, empty_hash.bytes());
+}
+
+ErrorOr<HandshakeSecrets> derive_handshake_secrets(Crypto::Hash::HashKind hash_kind, ReadonlyBytes pre_shared_key, ReadonlyBytes shared_secret, ReadonlyBytes transcript_hash)
+{
+    auto hash_size = transcript_hash.size();
+    u8 zeros[Crypto::Hash::SHA512::DigestSize] {};
+    VERIFY(hash_size <= sizeof(zeros));
+    ReadonlyBytes zero_secret { zeros, hash_size };
+
+    //              0
+    //              |
+    //              v
+    //    PSK ->  HKDF-Extract = Early Secret
+    //              |
+    //              v
+    //        Derive-Secret(., "derived", "")
+    //              |
+    //              v
+    // (EC)DHE -> HKDF-Extract = Handshake Secret
+    //              |
+    //              +-----> Derive-Secret(., "c hs traffic", ClientHello...ServerHello)
+    //              +-----> Derive-Secret(., "s hs traffic", ClientHello...ServerHello)
+    //              v
+    //        Derive-Secret(., "derived", "")
+    //              |
+    //              v
+    //   0 -> HKDF-Extract = Master Secret
+    HandshakeSecrets secrets;
+    secrets.early_secret = TRY(HKDF::extract({}, pre_shared_key.is_empty() ? zero_secret : pre_shared_key, hash_kind));
+
+    auto derived_secret = TRY(derive_secret_for_empty_transcript(hash_kind, secrets.early_secret, "derived"sv));
+    secrets.handshake_secret = TRY(HKDF::extract(derived_secret, shared_secret, hash_kind));
+
+    secrets.client_handshake_traffic_secret = TRY(derive_secret(hash_kind, secrets.handshake_secret, "c hs traffic"sv, transcript_hash));
+    secrets.server_handshake_traffic_secret = TRY(derive_secret(hash_kind, secrets.handshake_secret, "s hs traffic"sv, transcript_hash));
+
+    derived_secret = TRY(derive_secret_for_empty_transcript(hash_kind, secrets.handshake_secret, "derived"sv));
+    secrets.master_secret = TRY(HKDF::extract(derived_secret, zero_secret, hash_kind));
+    return secrets;
+}
+
+// verify_data = HMAC(finished_key, Transcript-Hash(Handshake Context, Certificate*, CertificateVerify*))
+ErrorOr<ByteBuffer> finished_verify_data(Crypto::Hash::HashKind hash_kind, ReadonlyBytes handshake_traffic_secret, ReadonlyBytes transcript_hash)
+{
+    auto finished_key = TRY(hkdf_expand_label(hash_kind, handshake_traffic_secret, "finished"sv, {}, transcript_hash.size()));
+    Crypto::Authentication::HMAC<Crypto::Hash::Manager> hmac(finished_key.bytes(), hash_kind);
+    auto verify_data = hmac.process(transcript_hash);
+    return ByteBuffer::copy(verify_data.immutable_data(), transcript_hash.size());
+}
+
+ErrorOr<TrafficKey> derive_traffic_key(Crypto::Hash::HashKind hash_kind, ReadonlyBytes traffic_secret, size_t key_length)
+{
+    TrafficKey traffic_key;
+    traffic_key.key = TRY(hkdf_expand_label(hash_kind, traffic_secret, "key"sv, {}, key_length));
+    auto iv = TRY(hkdf_expand_label(hash_kind, traffic_secret, "iv"sv, {}, sizeof(traffic_key.iv)));
+    memcpy(traffic_key.iv, iv.data(), sizeof(traffic_key.iv));
+    return traffic_key;
+}
+
+// The IV of a record is the traffic IV XORed with the record sequence number (RFC 8446 section 5.3).
+static void compute_nonce(u8 const (&traffic_iv)[12], u64 sequence_number, Bytes iv)
+{
+    // Our GCM implementation takes 16 bytes: The 12 byte nonce, followed by a zero counter.
+    VERIFY(iv.size() == 16);
+    memcpy(iv.data(), traffic_iv, 12);
+    for (size_t i = 0; i < 8; ++i)
+        iv[4 + i] ^= (sequence_number >> (56 - 8 * i)) & 0xff;
+    memset(iv.offset(12), 0, 4);
+}
+
+ErrorOr<ByteBuffer> encrypt_record(Crypto::Cipher::AESCipher::GCMMode& gcm, u8 const (&traffic_iv)[12], u64 sequence_number, ContentType type, ReadonlyBytes content)
+{
+    // struct {
+    //     opaque content[TLSPlaintext.length];
+    //     ContentType type;
+    //     uint8 zeros[length_of_padding];
+    // } TLSInnerPlaintext;
+    auto inner_plaintext = TRY(ByteBuffer::create_uninitialized(content.size() + 1));
+    inner_plaintext.overwrite(0, content.data(), content.size());
+    inner_plaintext[content.size()] = (u8)type;
+
+    // struct {
+    //     ContentType opaque_type = application_data; /* 23 */
+    //     ProtocolVersion legacy_record_version = 0x0303; /* TLS v1.2 */
+    //     uint16 length;
+    //     opaque encrypted_record[TLSCiphertext.length];
+    // } TLSCiphertext;
+    auto record = TRY(ByteBuffer::create_uninitialized(record_header_size + inner_plaintext.size() + record_tag_size));
+    record[0] = (u8)ContentType::APPLICATION_DATA;
+    ByteReader::store(record.offset_pointer(1), AK::convert_between_host_and_network_endian((u16)ProtocolVersion::VERSION_1_2));
+    ByteReader::store(record.offset_pointer(3), AK::convert_between_host_and_network_endian((u16)(inner_plaintext.size() + record_tag_size)));
+
+    u8 iv[16];
+    compute_nonce(traffic_iv, sequence_number, { iv, sizeof(iv) });
+
+    // The additional data is the record header.
+    gcm.encrypt(
+        inner_plaintext,
+        record.bytes().slice(record_header_size, inner_plaintext.size()),
+        { iv, sizeof(iv) },
+        record.bytes().trim(record_header_size),
+        record.bytes().slice(record_header_size + inner_plaintext.size(), record_tag_size));
+
+    return record;
+}
+
+ErrorOr<ContentType, AlertDescription> decrypt_record(Crypto::Cipher::AESCipher::GCMMode& gcm, u8 const (&traffic_iv)[12], u64 sequence_number, ReadonlyBytes record, ByteBuffer& content)
+{
+    if (record.size() < record_header_size + 1 + record_tag_size)
+        return AlertDescription::DECODE_ERROR;
+
+    auto ciphertext = record.slice(record_header_size, record.size() - record_header_size - record_tag_size);
+    auto tag = record.slice(record.size() - record_tag_size);
+    auto decrypted = ByteBuffer::create_uninitialized(ciphertext.size());
+    if (decrypted.is_error())
+        return AlertDescription::INTERNAL_ERROR;
+    content = decrypted.release_value();
+
+    u8 iv[16];
+    compute_nonce(traffic_iv, sequence_number, { iv, sizeof(iv) });
+
+    auto consistency = gcm.decrypt(ciphertext, content, { iv, sizeof(iv) }, record.trim(record_header_size), tag);
+    if (consistency != Crypto::VerificationConsistency::Consistent)
+        return AlertDescription::BAD_RECORD_MAC;
+
+    // The actual content type is the last non-zero byte, anything after it is padding.
+    size_t content_length = content.size();
+    while (content_length > 0 && content[content_length - 1] == 0)
+        --content_length;
+    if (content_length == 0)
+        return AlertDescription::UNEXPECTED_MESSAGE;
+
+    auto type = static_cast<ContentType>(content[content_length - 1]);
+    content.resize(content_length - 1);
+    return type;
+}
+
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Error.h>
+#include <AK/StringView.h>
+#include <LibCrypto/Cipher/AES.h>
+#include <LibCrypto/Hash/HashManager.h>
+#include <LibTLS/CipherSuite.h>
+#include <LibTLS/Extensions.h>
+
+// The TLS 1.3 key schedule and record protection, apart from the state of a connection.
+namespace TLS::TLS13 {
+
+// https://www.rfc-editor.org/rfc/rfc8446#appendix-B.4
+Crypto::Hash::HashKind hash_kind(CipherSuite);
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-7.1
+ErrorOr<ByteBuffer> hkdf_expand_label(Crypto::Hash::HashKind, ReadonlyBytes secret, StringView label, ReadonlyBytes context, size_t length);
+ErrorOr<ByteBuffer> derive_secret(Crypto::Hash::HashKind, ReadonlyBytes secret, StringView label, ReadonlyBytes transcript_hash);
+ErrorOr<ByteBuffer> derive_secret_for_empty_transcript(Crypto::Hash::HashKind, ReadonlyBytes secret, StringView label);
+
+struct HandshakeSecrets {
+    ByteBuffer early_secret;
+    ByteBuffer handshake_secret;
+    ByteBuffer client_handshake_traffic_secret;
+    ByteBuffer server_handshake_traffic_secret;
+    ByteBuffer master_secret;
+};
+
+// Runs the key schedule up to the master secret. An empty pre-shared key stands for a string of zeros, as used without
+// resumption. `transcript_hash` is the hash of ClientHello...ServerHello.
+ErrorOr<HandshakeSecrets> derive_handshake_secrets(Crypto::Hash::HashKind, ReadonlyBytes pre_shared_key, ReadonlyBytes shared_secret, ReadonlyBytes transcript_hash);
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-4.4.4
+ErrorOr<ByteBuffer> finished_verify_data(Crypto::Hash::HashKind, ReadonlyBytes handshake_traffic_secret, ReadonlyBytes transcript_hash);
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-7.3
+struct TrafficKey {
+    ByteBuffer key;
+    u8 iv[12] {};
+};
+ErrorOr<TrafficKey> derive_traffic_key(Crypto::Hash::HashKind, ReadonlyBytes traffic_secret, size_t key_length);
+
+// https://www.rfc-editor.org/rfc/rfc8446#section-5.2
+// Builds a whole TLSCiphertext record (header included) that carries `content` of the given type.
+ErrorOr<ByteBuffer> encrypt_record(Crypto::Cipher::AESCipher::GCMMode&, u8 const (&traffic_iv)[12], u64 sequence_number, ContentType, ReadonlyBytes content);
+// Opens a whole TLSCiphertext record and returns the type of its content, or the alert to answer with if that fails.
+ErrorOr<ContentType, AlertDescription> decrypt_record(Crypto::Cipher::AESCipher::GCMMode&, u8 const (&traffic_iv)[12], u64 sequence_number, ReadonlyBytes record, ByteBuffer& content);
+
+}
@@ -39,17 +39,20 @@ void TLSv12::write_packet(ByteBuffer& packet, bool immediately)
 {
     auto schedule_or_perform_flush = [&](bool immediate) {
         if (m_context.connection_status > ConnectionStatus::Disconnected) {
-            if (!m_has_scheduled_write_flush && !immediate) {
-                dbgln_if(TLS_DEBUG, "Scheduling write of {}", m_context.tls_buffer.size());
-                Core::deferred_invoke([this] { write_into_socket(); });
-                m_has_scheduled_write_flush = true;
-            } else {
-                // multiple packet are available, let's flush some out
+            if (immediate) {
                 dbgln_if(TLS_DEBUG, "Flushing scheduled write of {}", m_context.tls_buffer.size());
+                auto had_scheduled_write_flush = m_has_scheduled_write_flush;
                 write_into_socket();
-                // the deferred invoke is still in place
+                // the deferred invoke (if any) is still in place
+                m_has_scheduled_write_flush = had_scheduled_write_flush;
+            } else if (!m_has_scheduled_write_flush) {
+                dbgln_if(TLS_DEBUG, "Scheduling write of {}", m_context.tls_buffer.size());
+                Core::deferred_invoke([this] { write_into_socket(); });
                 m_has_scheduled_write_flush = true;
             }
+            // Otherwise, the scheduled flush picks this record up as well. Sending a whole flight (e.g. ClientKeyExchange,
+            // ChangeCipherSpec and Finished) in one write keeps Nagle's algorithm from holding its tail back until the
+            // peer's delayed ACK.
         }
     };
     // Record size limit is 18432 bytes, leave some headroom and flush at 16K.
@@ -76,6 +79,12 @@ void TLSv12::update_packet(ByteBuffer& packet)
             }
         }
         if (m_context.cipher_spec_set && m_context.crypto.created) {
+            if (is_tls13()) {
+                encrypt_tls13_record(packet);
+                ++m_context.local_sequence_number;
+                return;
+            }
+
             size_t length = packet.size() - header_size;
             size_t block_size = 0;
             size_t padding = 0;
@@ -345,7 +354,32 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
 
     ByteBuffer decrypted;
 
-    if (m_context.cipher_spec_set && type != ContentType::CHANGE_CIPHER_SPEC) {
+    if (is_tls13() && type == ContentType::CHANGE_CIPHER_SPEC) {
+        // RFC 8446 section 5: change_cipher_spec records only exist for middlebox compatibility. They are dropped
+        // without being counted, as long as they look like the one that TLS 1.2 would send.
+        if (length != 1 || plain[0] != 1 || m_context.connection_status == ConnectionStatus::Established) {
+            dbgln("unexpected change cipher message");
+            auto packet = build_alert(true, (u8)AlertDescription::UNEXPECTED_MESSAGE);
+            write_packet(packet);
+            return (i8)Error::UnexpectedMessage;
+        }
+        return header_size + length;
+    }
+
+    if (is_tls13() && m_context.cipher_spec_set) {
+        // Protected records all claim to be application data, the actual type is part of the ciphertext.
+        if (type != ContentType::APPLICATION_DATA) {
+            dbgln("unexpected unprotected record of type {}", enum_to_string(type));
+            auto packet = build_alert(true, (u8)AlertDescription::UNEXPECTED_MESSAGE);
+            write_packet(packet);
+            return (i8)Error::UnexpectedMessage;
+        }
+        auto result = decrypt_tls13_record(buffer.slice(0, header_size + length), decrypted, type);
+        if (result < 0)
+            return result;
+        plain = decrypted;
+        length = decrypted.size();
+    } else if (m_context.cipher_spec_set && type != ContentType::CHANGE_CIPHER_SPEC) {
         if constexpr (TLS_DEBUG) {
             dbgln("Encrypted: ");
             print_buffer(buffer.slice(header_size, length));
@@ -541,7 +575,8 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
 
             if (code == (u8)AlertDescription::CLOSE_NOTIFY) {
                 res += 2;
-                alert(AlertLevel::FATAL, AlertDescription::CLOSE_NOTIFY);
+                // RFC 5246 section 7.2.1: close_notify is a warning, peers drop the session from their cache after a fatal alert.
+                alert(AlertLevel::WARNING, AlertDescription::CLOSE_NOTIFY);
                 if (!m_context.cipher_spec_set) {
                     // AWS CloudFront hits this.
                     dbgln("Server sent a close notify and we haven't agreed on a cipher suite. Treating it as a handshake failure.");
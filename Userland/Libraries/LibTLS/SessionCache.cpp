@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTLS/SessionCache.h>
+
+namespace TLS {
+
+SessionCache::Entry& SessionCache::ensure_entry(HashMap<ByteString, Entry>& entries, StringView host)
+{
+    if (auto it = entries.find(host); it != entries.end()) {
+        it->value.last_used = ++m_use_counter;
+        return it->value;
+    }
+
+    // Make room by evicting the host that we have not talked to for the longest time.
+    if (entries.size() >= max_hosts) {
+        auto least_recently_used = entries.begin();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->value.last_used < least_recently_used->value.last_used)
+                least_recently_used = it;
+        }
+        entries.remove(least_recently_used);
+    }
+
+    auto& entry = entries.ensure(host);
+    entry.last_used = ++m_use_counter;
+    return entry;
+}
+
+void SessionCache::store_tls12_session(StringView host, TLS12Session session)
+{
+    m_entries.with_locked([&](auto& entries) {
+        ensure_entry(entries, host).tls12_session = move(session);
+    });
+}
+
+Optional<SessionCache::TLS12Session> SessionCache::tls12_session(StringView host)
+{
+    return m_entries.with_locked([&](auto& entries) -> Optional<TLS12Session> {
+        auto it = entries.find(host);
+        if (it == entries.end() || !it->value.tls12_session.has_value())
+            return {};
+
+        auto& session = *it->value.tls12_session;
+        if (session.expires_at < UnixDateTime::now()) {
+            it->value.tls12_session.clear();
+            return {};
+        }
+
+        it->value.last_used = ++m_use_counter;
+        auto session_id = ByteBuffer::copy(session.session_id);
+        auto ticket = ByteBuffer::copy(session.ticket);
+        auto master_secret = ByteBuffer::copy(session.master_secret);
+        if (session_id.is_error() || ticket.is_error() || master_secret.is_error())
+            return {};
+
+        return TLS12Session {
+            .session_id = session_id.release_value(),
+            .ticket = ticket.release_value(),
+            .master_secret = master_secret.release_value(),
+            .cipher = session.cipher,
+            .extended_master_secret = session.extended_master_secret,
+            .expires_at = session.expires_at,
+        };
+    });
+}
+
+void SessionCache::forget_tls12_session(StringView host)
+{
+    m_entries.with_locked([&](auto& entries) {
+        if (auto it = entries.find(host); it != entries.end())
+            it->value.tls12_session.clear();
+    });
+}
+
+void SessionCache::store_tls13_ticket(StringView host, TLS13Ticket ticket)
+{
+    m_entries.with_locked([&](auto& entries) {
+        auto& tickets = ensure_entry(entries, host).tls13_tickets;
+        if (tickets.size() >= max_tls13_tickets_per_host)
+            tickets.remove(0);
+        tickets.append(move(ticket));
+    });
+}
+
+Optional<SessionCache::TLS13Ticket> SessionCache::take_tls13_ticket(StringView host)
+{
+    return m_entries.with_locked([&](auto& entries) -> Optional<TLS13Ticket> {
+        auto it = entries.find(host);
+        if (it == entries.end())
+            return {};
+
+        auto now = UnixDateTime::now();
+        auto& tickets = it->value.tls13_tickets;
+        tickets.remove_all_matching([&](auto& ticket) { return ticket.expires_at < now; });
+        if (tickets.is_empty())
+            return {};
+
+        // Prefer the newest ticket, as the server is the most likely to still accept it.
+        it->value.last_used = ++m_use_counter;
+        return tickets.take_last();
+    });
+}
+
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/AtomicRefCounted.h>
+#include <AK/ByteBuffer.h>
+#include <AK/ByteString.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/Time.h>
+#include <AK/Vector.h>
+#include <LibTLS/Extensions.h>
+#include <LibThreading/MutexProtected.h>
+
+namespace TLS {
+
+// Remembers what it takes to resume sessions with servers we have talked to before, so that later connections can
+// skip the certificate exchange and the public key operations of a full handshake.
+// A cache can be shared by any number of connections (across threads, too), entries are keyed by the server name.
+class SessionCache : public AtomicRefCounted<SessionCache> {
+public:
+    // https://www.rfc-editor.org/rfc/rfc5246#section-7.3 (session IDs) and https://www.rfc-editor.org/rfc/rfc5077 (tickets)
+    struct TLS12Session {
+        ByteBuffer session_id;
+        ByteBuffer ticket;
+        ByteBuffer master_secret;
+        CipherSuite cipher { CipherSuite::TLS_NULL_WITH_NULL_NULL };
+        bool extended_master_secret { false };
+        UnixDateTime expires_at;
+    };
+
+    // https://www.rfc-editor.org/rfc/rfc8446#section-4.6.1
+    struct TLS13Ticket {
+        ByteBuffer ticket;
+        ByteBuffer pre_shared_key;
+        CipherSuite cipher { CipherSuite::TLS_NULL_WITH_NULL_NULL };
+        u32 age_add { 0 };
+        UnixDateTime received_at;
+        UnixDateTime expires_at;
+    };
+
+    static constexpr size_t max_hosts = 256;
+    static constexpr size_t max_tls13_tickets_per_host = 4;
+
+    static NonnullRefPtr<SessionCache> create() { return adopt_ref(*new SessionCache); }
+
+    void store_tls12_session(StringView host, TLS12Session);
+    Optional<TLS12Session> tls12_session(StringView host);
+    void forget_tls12_session(StringView host);
+
+    void store_tls13_ticket(StringView host, TLS13Ticket);
+    // RFC 8446 section 8.1 and appendix C.4: Clients should not reuse a ticket for multiple connections, so this
+    // removes the returned ticket from the cache.
+    Optional<TLS13Ticket> take_tls13_ticket(StringView host);
+
+private:
+    SessionCache() = default;
+
+    struct Entry {
+        Optional<TLS12Session> tls12_session;
+        Vector<TLS13Ticket> tls13_tickets;
+        u64 last_used { 0 };
+    };
+
+    Entry& ensure_entry(HashMap<ByteString, Entry>&, StringView host);
+
+    Threading::MutexProtected<HashMap<ByteString, Entry>> m_entries;
+    u64 m_use_counter { 0 };
+};
+
+}
@@ -356,7 +356,7 @@ ErrorOr<bool> TLSv12::flush()
 void TLSv12::close()
 {
     if (underlying_stream().is_open())
-        alert(AlertLevel::FATAL, AlertDescription::CLOSE_NOTIFY);
+        alert(AlertLevel::WARNING, AlertDescription::CLOSE_NOTIFY);
     // bye bye.
     m_context.connection_status = ConnectionStatus::Disconnected;
 }
@@ -20,6 +20,7 @@
 #include <LibCrypto/Hash/HashManager.h>
 #include <LibCrypto/PK/RSA.h>
 #include <LibTLS/CipherSuite.h>
+#include <LibTLS/SessionCache.h>
 #include <LibTLS/TLSPacketBuilder.h>
 
 namespace TLS {
@@ -70,6 +71,8 @@ enum class WritePacketStage {
     ClientHandshake = 1,
     ServerHandshake = 2,
     Finished = 3,
+    ClientHelloRetry = 4,
+    ClientFinishedTLS13 = 5,
 };
 
 enum class ConnectionStatus {
@@ -80,11 +83,26 @@ enum class ConnectionStatus {
     Established,
 };
 
+// https://www.rfc-editor.org/rfc/rfc8446#appendix-A.1
+enum class TLS13HandshakeState {
+    WaitServerHello,
+    WaitEncryptedExtensions,
+    WaitCertificateOrCertificateRequest,
+    WaitCertificate,
+    WaitCertificateVerify,
+    WaitFinished,
+    Connected,
+};
+
 enum ClientVerificationStaus {
     Verified,
     VerificationNeeded,
 };
 
+// Note for the 12 iv length of the TLS 1.3 suites:
+// TLS 1.3 derives the whole 12 byte nonce from the key schedule and XORs the
+// record sequence number into it, nothing is transmitted (RFC 8446 section 5.3).
+//
 // Note for the 16 iv length instead of 8:
 // 4 bytes of fixed IV, 8 random (nonce) bytes, 4 bytes for counter
 // GCM specifically asks us to transmit only the nonce, the counter is zero
@@ -96,6 +114,8 @@ enum ClientVerificationStaus {
 //
 // https://wiki.mozilla.org/Security/Server_Side_TLS
 #define ENUMERATE_CIPHERS(C)                                                                                                                                      \
+    C(true, CipherSuite::TLS_AES_128_GCM_SHA256, KeyExchangeAlgorithm::Negotiated, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 12, true)                  \
+    C(true, CipherSuite::TLS_AES_256_GCM_SHA384, KeyExchangeAlgorithm::Negotiated, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 12, true)                  \
     C(true, CipherSuite::TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::ECDHE_ECDSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true) \
     C(true, CipherSuite::TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::ECDHE_RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true)     \
     C(true, CipherSuite::TLS_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384, KeyExchangeAlgorithm::ECDHE_ECDSA, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 8, true) \
@@ -139,6 +159,19 @@ constexpr CipherAlgorithm get_cipher_algorithm(CipherSuite suite)
     }
 }
 
+inline size_t get_hash_size(CipherSuite suite)
+{
+    switch (suite) {
+#define C(is_supported, suite, key_exchange, cipher, hash, iv_size, is_aead) \
+    case suite:                                                              \
+        return hash ::digest_size();
+        ENUMERATE_CIPHERS(C)
+#undef C
+    default:
+        return 0;
+    }
+}
+
 struct Options {
     static Vector<CipherSuite> default_usable_cipher_suites()
     {
@@ -169,8 +202,14 @@ struct Options {
         return move(*this);                  \
     }
 
+    // The version in the record layer and the legacy_version field of the ClientHello, see supported_versions for the
+    // versions that are actually offered.
     OPTION_WITH_DEFAULTS(ProtocolVersion, version, ProtocolVersion::VERSION_1_2)
+    OPTION_WITH_DEFAULTS(Vector<ProtocolVersion>, supported_versions, ProtocolVersion::VERSION_1_3, ProtocolVersion::VERSION_1_2)
     OPTION_WITH_DEFAULTS(Vector<SignatureAndHashAlgorithm>, supported_signature_algorithms,
+        { HashAlgorithm::INTRINSIC, SignatureAlgorithm::RSA_PSS_RSAE_SHA256 },
+        { HashAlgorithm::INTRINSIC, SignatureAlgorithm::RSA_PSS_RSAE_SHA384 },
+        { HashAlgorithm::INTRINSIC, SignatureAlgorithm::RSA_PSS_RSAE_SHA512 },
         { HashAlgorithm::SHA512, SignatureAlgorithm::RSA },
         { HashAlgorithm::SHA384, SignatureAlgorithm::RSA },
         { HashAlgorithm::SHA256, SignatureAlgorithm::RSA },
@@ -194,6 +233,8 @@ struct Options {
     OPTION_WITH_DEFAULTS(Function<void()>, finish_callback, [] {})
     OPTION_WITH_DEFAULTS(Function<Vector<Certificate>()>, certificate_provider, [] { return Vector<Certificate> {}; })
     OPTION_WITH_DEFAULTS(bool, enable_extended_master_secret, true)
+    // Resumes earlier sessions with the same server if set, and remembers the session of this connection.
+    OPTION_WITH_DEFAULTS(RefPtr<SessionCache>, session_cache, )
 
 #undef OPTION_WITH_DEFAULTS
 };
@@ -260,8 +301,9 @@ struct Context {
         u8 local_mac[32];
         u8 local_iv[16];
         u8 remote_iv[16];
-        u8 local_aead_iv[4];
-        u8 remote_aead_iv[4];
+        // TLS 1.2 only uses the first 4 bytes, TLS 1.3 uses all of them.
+        u8 local_aead_iv[12];
+        u8 remote_aead_iv[12];
     } crypto;
 
     Crypto::Hash::Manager handshake_hash;
@@ -316,6 +358,46 @@ struct Context {
     } server_diffie_hellman_params;
 
     OwnPtr<Crypto::Curves::EllipticCurve> server_key_exchange_curve;
+
+    // Only known once the ServerHello has been handled.
+    ProtocolVersion negotiated_version { ProtocolVersion::VERSION_1_2 };
+
+    // Partial handshake message that continues in the next record.
+    ByteBuffer handshake_fragment;
+
+    struct {
+        // The session or ticket that the ClientHello offered, and whether the server agreed to resume it.
+        Optional<SessionCache::TLS12Session> offered_session;
+        bool resumed { false };
+        bool ticket_requested { false };
+        ByteBuffer new_ticket;
+        u32 new_ticket_lifetime { 0 };
+    } tls12_resumption;
+
+    struct {
+        TLS13HandshakeState state { TLS13HandshakeState::WaitServerHello };
+
+        SupportedGroup key_share_group { SupportedGroup::X25519 };
+        OwnPtr<Crypto::Curves::EllipticCurve> key_share_curve;
+        ByteBuffer key_share_private_key;
+        ByteBuffer key_share_public_key;
+
+        Optional<SessionCache::TLS13Ticket> offered_ticket;
+        bool psk_accepted { false };
+        bool did_hello_retry { false };
+        ByteBuffer cookie;
+        Optional<ByteBuffer> certificate_request_context;
+
+        // https://www.rfc-editor.org/rfc/rfc8446#section-7.1
+        ByteBuffer early_secret;
+        ByteBuffer handshake_secret;
+        ByteBuffer master_secret;
+        ByteBuffer client_handshake_traffic_secret;
+        ByteBuffer server_handshake_traffic_secret;
+        ByteBuffer client_application_traffic_secret;
+        ByteBuffer server_application_traffic_secret;
+        ByteBuffer resumption_master_secret;
+    } tls13;
 };
 
 class TLSv12 final : public Core::Socket {
@@ -398,9 +480,11 @@ public:
 
     bool supports_version(ProtocolVersion v) const
     {
-        return v == ProtocolVersion::VERSION_1_2;
+        return (v == ProtocolVersion::VERSION_1_2 || v == ProtocolVersion::VERSION_1_3) && m_context.options.supported_versions.contains_slow(v);
     }
 
+    bool is_tls13() const { return m_context.negotiated_version == ProtocolVersion::VERSION_1_3; }
+
     void alert(AlertLevel, AlertDescription);
 
     Function<void(AlertDescription)> on_tls_error;
@@ -457,6 +541,37 @@ private:
 
     ssize_t verify_rsa_server_key_exchange(ReadonlyBytes server_key_info_buffer, ReadonlyBytes signature_buffer);
     ssize_t verify_ecdsa_server_key_exchange(ReadonlyBytes server_key_info_buffer, ReadonlyBytes signature_buffer);
+    ssize_t verify_rsa_signature(SignatureAndHashAlgorithm, ReadonlyBytes message, ReadonlyBytes signature);
+    ssize_t verify_ecdsa_signature(HashAlgorithm, ReadonlyBytes message, ReadonlyBytes signature);
+    ssize_t verify_ed25519_signature(ReadonlyBytes message, ReadonlyBytes signature);
+
+    // TLS 1.2 session resumption
+    void offer_tls12_session();
+    ssize_t handle_tls12_new_session_ticket(ReadonlyBytes);
+    bool verify_tls12_server_finished(ReadonlyBytes verify_data);
+    void store_tls12_session();
+
+    // TLS 1.3, see HandshakeTLS13.cpp
+    ErrorOr<void> build_tls13_key_share(SupportedGroup);
+    ErrorOr<void> write_tls13_psk_binder(ByteBuffer& client_hello);
+    ssize_t handle_tls13_server_hello(ReadonlyBytes key_share, Optional<u16> selected_identity, ReadonlyBytes cookie, bool is_hello_retry_request, WritePacketStage&);
+    ssize_t handle_tls13_handshake_message(HandshakeType, ReadonlyBytes message, WritePacketStage&);
+    ssize_t handle_tls13_encrypted_extensions(ReadonlyBytes);
+    ssize_t handle_tls13_certificate_request(ReadonlyBytes);
+    ssize_t handle_tls13_certificate(ReadonlyBytes);
+    ssize_t handle_tls13_certificate_verify(ReadonlyBytes);
+    ssize_t handle_tls13_finished(ReadonlyBytes);
+    ssize_t handle_tls13_new_session_ticket(ReadonlyBytes);
+    ssize_t handle_tls13_key_update(ReadonlyBytes);
+    ErrorOr<void> restart_transcript_for_hello_retry();
+    ErrorOr<void> derive_tls13_handshake_secrets();
+    ErrorOr<void> derive_tls13_application_secrets();
+    ErrorOr<void> install_tls13_traffic_key(ReadonlyBytes traffic_secret, bool local);
+    ErrorOr<ByteBuffer> build_tls13_finished();
+    void send_tls13_client_finished();
+    ByteBuffer build_tls13_key_update(bool update_requested);
+    void encrypt_tls13_record(ByteBuffer& packet);
+    ssize_t decrypt_tls13_record(ReadonlyBytes buffer, ByteBuffer& decrypted, ContentType& type);
 
     size_t key_length() const
     {
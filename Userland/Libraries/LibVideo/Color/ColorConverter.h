@@ -8,6 +8,7 @@
 
 #include <AK/Array.h>
 #include <AK/Function.h>
+#include <AK/SIMD.h>
 #include <LibGfx/Color.h>
 #include <LibGfx/Matrix4x4.h>
 #include <LibVideo/Color/CodingIndependentCodePoints.h>
@@ -154,96 +155,121 @@ public:
     template<MatrixCoefficients MC, VideoFullRangeFlag FR, Unsigned T>
     static ALWAYS_INLINE Gfx::Color convert_simple_yuv_to_rgb(T y_in, T u_in, T v_in)
     {
-        static constexpr i32 bit_depth = 8;
-        static constexpr i32 maximum_value = (1 << bit_depth) - 1;
-        static constexpr i32 one = 1 << 14;
-        static constexpr auto fraction = [](i32 numerator, i32 denominator) constexpr {
-            auto temp = static_cast<i64>(numerator) * one;
-            return static_cast<i32>(temp / denominator);
-        };
-        static constexpr auto coef = [](i32 hundred_thousandths) constexpr {
-            return fraction(hundred_thousandths, 100'000);
+        using Coefficients = SimpleYUVToRGBCoefficients<MC, FR>;
+
+        i32 y = y_in + Coefficients::y_offset;
+        i32 u = u_in + Coefficients::uv_offset;
+        i32 v = v_in + Coefficients::uv_offset;
+
+        i32 red = y * Coefficients::y_scale + v * Coefficients::red_v;
+        i32 green = y * Coefficients::y_scale + u * Coefficients::green_u + v * Coefficients::green_v;
+        i32 blue = y * Coefficients::y_scale + u * Coefficients::blue_u;
+
+        red = clamp(red, 0, Coefficients::maximum_value * Coefficients::one);
+        green = clamp(green, 0, Coefficients::maximum_value * Coefficients::one);
+        blue = clamp(blue, 0, Coefficients::maximum_value * Coefficients::one);
+
+        red >>= Coefficients::fraction_bits;
+        green >>= Coefficients::fraction_bits;
+        blue >>= Coefficients::fraction_bits;
+
+        return Gfx::Color(u8(red), u8(green), u8(blue));
+    }
+
+    // Converts a row of 8-bit YUV samples to full-range RGB, giving the same results as convert_simple_yuv_to_rgb(), but
+    // four samples at a time.
+    template<MatrixCoefficients MC, VideoFullRangeFlag FR>
+    static ALWAYS_INLINE void convert_simple_yuv_to_rgb_row(u16 const* y_row, u16 const* u_row, u16 const* v_row, Gfx::ARGB32* destination, size_t width)
+    {
+        using Coefficients = SimpleYUVToRGBCoefficients<MC, FR>;
+        using AK::SIMD::f32x4;
+        using AK::SIMD::i32x4;
+        using AK::SIMD::u16x4;
+        using AK::SIMD::u32x4;
+
+        // NOTE: The fixed-point products and sums all stay well below 2^24, so they are exact in single precision floats.
+        //       Unlike 32-bit integer multiplications, float multiplications are available with any SSE version.
+        static_assert(Coefficients::maximum_value * Coefficients::one * 4 < (1 << 24));
+
+        auto load = [](u16 const* samples) {
+            u16x4 vector;
+            __builtin_memcpy(&vector, samples, sizeof(vector));
+            // NOTE: Going through i32x4 lets the compiler use a single conversion instruction instead of converting each lane.
+            return __builtin_convertvector(__builtin_convertvector(vector, i32x4), f32x4);
         };
-        static constexpr auto multiply = [](i32 a, i32 b) constexpr {
-            return (a * b) / one;
+        auto clamp_and_scale = [](f32x4 value) {
+            constexpr float maximum = Coefficients::maximum_value * Coefficients::one;
+            value = value < 0.0f ? 0.0f : value;
+            value = value > maximum ? maximum : value;
+            return __builtin_convertvector(__builtin_convertvector(value, i32x4) >> Coefficients::fraction_bits, u32x4);
         };
 
-        struct RangeFactors {
-            i32 y_offset, y_scale;
-            i32 uv_offset, uv_scale;
-        };
+        size_t column = 0;
+        for (; column + 4 <= width; column += 4) {
+            auto y = load(y_row + column) + static_cast<float>(Coefficients::y_offset);
+            auto u = load(u_row + column) + static_cast<float>(Coefficients::uv_offset);
+            auto v = load(v_row + column) + static_cast<float>(Coefficients::uv_offset);
 
-        constexpr auto range_factors = [] {
-            RangeFactors range_factors;
+            auto scaled_y = y * static_cast<float>(Coefficients::y_scale);
+            auto red = clamp_and_scale(scaled_y + v * static_cast<float>(Coefficients::red_v));
+            auto green = clamp_and_scale(scaled_y + u * static_cast<float>(Coefficients::green_u) + v * static_cast<float>(Coefficients::green_v));
+            auto blue = clamp_and_scale(scaled_y + u * static_cast<float>(Coefficients::blue_u));
 
-            i32 min = 0;
-            i32 y_max = 255;
-            i32 uv_max = 255;
+            u32x4 pixels = 0xff000000 | (red << 16) | (green << 8) | blue;
+            __builtin_memcpy(destination + column, &pixels, sizeof(pixels));
+        }
+        for (; column < width; column++)
+            destination[column] = convert_simple_yuv_to_rgb<MC, FR>(y_row[column], u_row[column], v_row[column]).value();
+    }
 
-            if constexpr (FR == VideoFullRangeFlag::Studio) {
-                min = 16;
-                y_max = 235;
-                uv_max = 240;
-            }
+private:
+    // The fixed-point factors used to convert 8-bit YUV to full-range RGB. They have the following effects:
+    //  - Scale the Y, U and V values into the range 0...maximum_value*one for these fixed-point operations.
+    //  - Scale the values by the color range defined by VideoFullRangeFlag.
+    //  - Scale the U and V values by 2 to put them in the actual YCbCr coordinate space.
+    //  - Multiply by the YCbCr coefficients to convert to RGB.
+    template<MatrixCoefficients MC, VideoFullRangeFlag FR>
+    struct SimpleYUVToRGBCoefficients {
+        static constexpr i32 bit_depth = 8;
+        static constexpr i32 maximum_value = (1 << bit_depth) - 1;
+        static constexpr i32 fraction_bits = 14;
+        static constexpr i32 one = 1 << fraction_bits;
 
-            range_factors.y_offset = -min * maximum_value / 255;
-            range_factors.y_scale = fraction(255, y_max - min);
-            range_factors.uv_offset = -((min + uv_max) * maximum_value) / (255 * 2);
-            range_factors.uv_scale = fraction(255, uv_max - min) * 2;
-
-            range_factors.y_scale = multiply(range_factors.y_scale, fraction(255, maximum_value));
-            range_factors.uv_scale = multiply(range_factors.uv_scale, fraction(255, maximum_value));
-
-            return range_factors;
-        }();
-
-        i32 y = y_in + range_factors.y_offset;
-        i32 u = u_in + range_factors.uv_offset;
-        i32 v = v_in + range_factors.uv_offset;
-
-        i32 red;
-        i32 green;
-        i32 blue;
-
-        constexpr i32 y_scale = range_factors.y_scale;
-        constexpr i32 uv_scale = range_factors.uv_scale;
-
-        // The equations below will have the following effects:
-        //  - Scale the Y, U and V values into the range 0...maximum_value*one for these fixed-point operations.
-        //  - Scale the values by the color range defined by VideoFullRangeFlag.
-        //  - Scale the U and V values by 2 to put them in the actual YCbCr coordinate space.
-        //  - Multiply by the YCbCr coefficients to convert to RGB.
-        if constexpr (MC == MatrixCoefficients::BT709) {
-            red = y * y_scale + v * multiply(coef(78740), uv_scale);
-            green = y * y_scale + u * multiply(coef(-9366), uv_scale) + v * multiply(coef(-23406), uv_scale);
-            blue = y * y_scale + u * multiply(coef(92780), uv_scale);
+        static constexpr i32 fraction(i32 numerator, i32 denominator)
+        {
+            auto temp = static_cast<i64>(numerator) * one;
+            return static_cast<i32>(temp / denominator);
         }
-
-        if constexpr (MC == MatrixCoefficients::BT601) {
-            red = y * y_scale + v * multiply(coef(70100), uv_scale);
-            green = y * y_scale + u * multiply(coef(-17207), uv_scale) + v * multiply(coef(-35707), uv_scale);
-            blue = y * y_scale + u * multiply(coef(88600), uv_scale);
+        static constexpr i32 coef(i32 hundred_thousandths)
+        {
+            return fraction(hundred_thousandths, 100'000);
         }
-
-        if constexpr (MC == MatrixCoefficients::BT2020ConstantLuminance) {
-            red = y * y_scale + v * multiply(coef(73730), uv_scale);
-            green = y * y_scale + u * multiply(coef(-8228), uv_scale) + v * multiply(coef(-28568), uv_scale);
-            blue = y * y_scale + u * multiply(coef(94070), uv_scale);
+        static constexpr i32 multiply(i32 a, i32 b)
+        {
+            return (a * b) / one;
         }
 
-        red = clamp(red, 0, maximum_value * one);
-        green = clamp(green, 0, maximum_value * one);
-        blue = clamp(blue, 0, maximum_value * one);
+        static constexpr i32 minimum = FR == VideoFullRangeFlag::Studio ? 16 : 0;
+        static constexpr i32 y_maximum = FR == VideoFullRangeFlag::Studio ? 235 : 255;
+        static constexpr i32 uv_maximum = FR == VideoFullRangeFlag::Studio ? 240 : 255;
 
-        // This compiles down to a bit shift if maximum_value == 255
-        red /= fraction(maximum_value, 255);
-        green /= fraction(maximum_value, 255);
-        blue /= fraction(maximum_value, 255);
+        static constexpr i32 y_offset = -minimum * maximum_value / 255;
+        static constexpr i32 uv_offset = -((minimum + uv_maximum) * maximum_value) / (255 * 2);
+        static constexpr i32 y_scale = multiply(fraction(255, y_maximum - minimum), fraction(255, maximum_value));
+        static constexpr i32 uv_scale = multiply(fraction(255, uv_maximum - minimum) * 2, fraction(255, maximum_value));
 
-        return Gfx::Color(u8(red), u8(green), u8(blue));
-    }
+        static constexpr i32 red_v_coefficient = MC == MatrixCoefficients::BT709 ? 78740 : MC == MatrixCoefficients::BT601 ? 70100 : 73730;
+        static constexpr i32 green_u_coefficient = MC == MatrixCoefficients::BT709 ? -9366 : MC == MatrixCoefficients::BT601 ? -17207 : -8228;
+        static constexpr i32 green_v_coefficient = MC == MatrixCoefficients::BT709 ? -23406 : MC == MatrixCoefficients::BT601 ? -35707 : -28568;
+        static constexpr i32 blue_u_coefficient = MC == MatrixCoefficients::BT709 ? 92780 : MC == MatrixCoefficients::BT601 ? 88600 : 94070;
+        static_assert(MC == MatrixCoefficients::BT709 || MC == MatrixCoefficients::BT601 || MC == MatrixCoefficients::BT2020ConstantLuminance);
+
+        static constexpr i32 red_v = multiply(coef(red_v_coefficient), uv_scale);
+        static constexpr i32 green_u = multiply(coef(green_u_coefficient), uv_scale);
+        static constexpr i32 green_v = multiply(coef(green_v_coefficient), uv_scale);
+        static constexpr i32 blue_u = multiply(coef(blue_u_coefficient), uv_scale);
+    };
 
-private:
     static constexpr size_t to_linear_size = 64;
     static constexpr size_t to_non_linear_size = 64;
 
@@ -192,6 +192,24 @@ void PlaybackManager::restart_playback()
     seek_to_timestamp(Duration::zero());
 }
 
+DecoderErrorOr<NonnullRefPtr<Gfx::Bitmap>> PlaybackManager::take_frame_bitmap(Gfx::IntSize size)
+{
+    // Every frame in the queue, the next frame and the one being displayed may hold on to a bitmap.
+    static constexpr size_t max_frame_bitmap_count = frame_buffer_count + 2;
+
+    // Bitmaps that only we refer to are free, but the ones of the wrong size (e.g. after a resolution change) can go.
+    m_frame_bitmaps.remove_all_matching([&](auto const& bitmap) { return bitmap->ref_count() == 1 && bitmap->size() != size; });
+    for (auto& bitmap : m_frame_bitmaps) {
+        if (bitmap->ref_count() == 1)
+            return bitmap;
+    }
+
+    auto bitmap = DECODER_TRY_ALLOC(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, size));
+    if (m_frame_bitmaps.size() < max_frame_bitmap_count)
+        DECODER_TRY_ALLOC(m_frame_bitmaps.try_append(bitmap));
+    return bitmap;
+}
+
 void PlaybackManager::decode_and_queue_one_sample()
 {
 #if PLAYBACK_MANAGER_DEBUG
@@ -258,7 +276,11 @@ void PlaybackManager::decode_and_queue_one_sample()
                 break;
             }
 
-            auto bitmap_result = decoded_frame->to_bitmap();
+            auto bitmap_result = [&]() -> DecoderErrorOr<NonnullRefPtr<Gfx::Bitmap>> {
+                auto bitmap = TRY(take_frame_bitmap({ decoded_frame->width(), decoded_frame->height() }));
+                TRY(decoded_frame->output_to_bitmap(bitmap));
+                return bitmap;
+            }();
 
             if (bitmap_result.is_error())
                 item_to_enqueue = FrameQueueItem::error_marker(bitmap_result.release_error(), sample->timestamp());
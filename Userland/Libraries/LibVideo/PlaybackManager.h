@@ -165,6 +165,7 @@ private:
     void set_state_update_timer(int delay_ms);
 
     void decode_and_queue_one_sample();
+    DecoderErrorOr<NonnullRefPtr<Gfx::Bitmap>> take_frame_bitmap(Gfx::IntSize);
 
     void dispatch_decoder_error(DecoderError error);
     void dispatch_new_frame(RefPtr<Gfx::Bitmap> frame);
@@ -194,6 +195,10 @@ private:
     OwnPtr<PlaybackStateHandler> m_playback_handler;
     Optional<FrameQueueItem> m_next_frame;
 
+    // The bitmaps that frames are converted into. A bitmap is reused as soon as the frame queue and the consumer of
+    // on_video_frame have let go of it, so playing a video does not allocate a new bitmap for every frame.
+    Vector<NonnullRefPtr<Gfx::Bitmap>> m_frame_bitmaps;
+
     u64 m_skipped_frames { 0 };
 
     // This is a nested class to allow private access.
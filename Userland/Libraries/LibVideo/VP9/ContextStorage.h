@@ -9,6 +9,8 @@
 
 #include <AK/Array.h>
 #include <AK/Error.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
 #include <AK/Vector.h>
 #include <LibGfx/Size.h>
 #include <LibVideo/Color/CodingIndependentCodePoints.h>
@@ -271,12 +273,18 @@ using SegmentationPredictionContextView = Span<u8>;
 using PartitionContext = FixedArray<u8>;
 using PartitionContextView = Span<u8>;
 
+// The samples of a frame that is stored as a reference frame, extended by MV_BORDER on each side. A frame is often stored
+// into several reference frame slots at once, which then all share the same planes.
+struct ReferenceFramePlanes : public RefCounted<ReferenceFramePlanes> {
+    Array<Vector<u16>, 3> planes {};
+};
+
 struct ReferenceFrame {
     Gfx::Size<u32> size { 0, 0 };
     bool subsampling_x { false };
     bool subsampling_y { false };
     u8 bit_depth { 0 };
-    Array<Vector<u16>, 3> frame_planes {};
+    RefPtr<ReferenceFramePlanes> frame_planes;
 
     bool is_valid() const { return bit_depth > 0; }
 
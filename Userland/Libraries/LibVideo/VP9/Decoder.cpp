@@ -142,41 +142,16 @@ DecoderErrorOr<void> Decoder::create_video_frame(FrameContext const& frame_conte
         dbgln("FIXME: Show an existing reference frame.");
     }
 
-    // FIXME: The math isn't entirely accurate to spec. output_uv_size is probably incorrect for certain
-    //        sizes, as the spec seems to prefer that the halved sizes be ceiled.
-    u32 decoded_y_width = frame_context.decoded_size(false).width();
-    auto decoded_uv_width = frame_context.decoded_size(true).width();
-    Gfx::Size<u32> output_y_size = frame_context.size();
+    // NOTE: The frame refers to the buffers that were decoded into, so that the samples don't have to be copied. The
+    //       buffers are not touched again after this, since the next frame is decoded into a different buffer.
+    VERIFY(m_output_buffer);
     auto subsampling_x = frame_context.color_config.subsampling_x;
     auto subsampling_y = frame_context.color_config.subsampling_y;
-    Gfx::Size<u32> output_uv_size = {
-        y_size_to_uv_size(subsampling_x, output_y_size.width()),
-        y_size_to_uv_size(subsampling_y, output_y_size.height()),
-    };
-    Array<FixedArray<u16>, 3> output_buffers = {
-        DECODER_TRY_ALLOC(FixedArray<u16>::create(output_y_size.width() * output_y_size.height())),
-        DECODER_TRY_ALLOC(FixedArray<u16>::create(output_uv_size.width() * output_uv_size.height())),
-        DECODER_TRY_ALLOC(FixedArray<u16>::create(output_uv_size.width() * output_uv_size.height())),
-    };
-    for (u8 plane = 0; plane < 3; plane++) {
-        auto& buffer = output_buffers[plane];
-        auto decoded_width = plane == 0 ? decoded_y_width : decoded_uv_width;
-        auto output_size = plane == 0 ? output_y_size : output_uv_size;
-        auto const& decoded_buffer = get_output_buffer(plane);
-
-        for (u32 row = 0; row < output_size.height(); row++) {
-            memcpy(
-                buffer.data() + row * output_size.width(),
-                decoded_buffer.data() + row * decoded_width,
-                output_size.width() * sizeof(*buffer.data()));
-        }
-    }
-
     auto frame = DECODER_TRY_ALLOC(adopt_nonnull_own_or_enomem(new (nothrow) SubsampledYUVFrame(
-        { output_y_size.width(), output_y_size.height() },
+        frame_context.size(),
         frame_context.color_config.bit_depth, get_cicp_color_space(frame_context),
         subsampling_x, subsampling_y,
-        output_buffers[0], output_buffers[1], output_buffers[2])));
+        *m_output_buffer, frame_context.decoded_size(false).width(), frame_context.decoded_size(true).width())));
     m_video_frame_queue.enqueue(move(frame));
 
     return {};
@@ -184,6 +159,10 @@ DecoderErrorOr<void> Decoder::create_video_frame(FrameContext const& frame_conte
 
 DecoderErrorOr<void> Decoder::allocate_buffers(FrameContext const& frame_context)
 {
+    // Drop our reference first, so that the buffer can be reused if no frame refers to it.
+    m_output_buffer = nullptr;
+    m_output_buffer = DECODER_TRY_ALLOC(m_output_buffer_pool.take());
+
     for (size_t plane = 0; plane < 3; plane++) {
         auto size = frame_context.decoded_size(plane > 0);
 
@@ -196,7 +175,7 @@ DecoderErrorOr<void> Decoder::allocate_buffers(FrameContext const& frame_context
 
 Vector<u16>& Decoder::get_output_buffer(u8 plane)
 {
-    return m_output_buffers[plane];
+    return m_output_buffer->plane(plane);
 }
 
 DecoderErrorOr<NonnullOwnPtr<VideoFrame>> Decoder::get_decoded_frame()
@@ -906,7 +885,7 @@ DecoderErrorOr<void> Decoder::predict_inter_block(u8 plane, BlockContext const&
     i32 offset_scaled_block_y = (base_y << SUBPEL_BITS) + scaled_vector_y;
 
     // A variable ref specifying the reference frame contents is set equal to FrameStore[ refIdx ].
-    auto& reference_frame_buffer = reference_frame.frame_planes[plane];
+    auto const& reference_frame_buffer = reference_frame.frame_planes->planes[plane];
     auto reference_frame_width = y_size_to_uv_size(subsampling_x, reference_frame.size.width()) + MV_BORDER * 2;
 
     // The variable lastX is set equal to ( (RefFrameWidth[ refIdx ] + subX) >> subX) - 1.
@@ -1820,12 +1799,25 @@ ALWAYS_INLINE DecoderErrorOr<void> Decoder::inverse_transform_2d(BlockContext co
     Array<Intermediate, block_size * block_size> row_array;
     Span<Intermediate> row = row_array.span().trim(block_size);
 
+    // The DCT and ADST turn an array of zeroes into zeroes again, so rows and columns without any non-zero values can be
+    // skipped. Most blocks only have a few low-frequency coefficients, which makes this skip most of the row transforms.
+    auto is_all_zero = [](ReadonlySpan<Intermediate> values) {
+        for (auto value : values) {
+            if (value != 0)
+                return false;
+        }
+        return true;
+    };
+
     // 2. The row transforms with i = 0..(n0-1) are applied as follows:
     for (auto i = 0u; i < block_size; i++) {
         // 1. Set T[ j ] equal to Dequant[ i ][ j ] for j = 0..(n0-1).
         for (auto j = 0u; j < block_size; j++)
             row[j] = dequantized[i * block_size + j];
 
+        if (!block_context.frame_context.lossless && is_all_zero(row))
+            continue;
+
         // 2. If Lossless is equal to 1, invoke the Inverse WHT process as specified in section 8.7.1.10 with shift equal
         //    to 2.
         if (block_context.frame_context.lossless) {
@@ -1864,6 +1856,9 @@ ALWAYS_INLINE DecoderErrorOr<void> Decoder::inverse_transform_2d(BlockContext co
         for (auto i = 0u; i < block_size; i++)
             column[i] = dequantized[i * block_size + j];
 
+        if (!block_context.frame_context.lossless && is_all_zero(column))
+            continue;
+
         // 2. If Lossless is equal to 1, invoke the Inverse WHT process as specified in section 8.7.1.10 with shift equal
         //    to 0.
         if (block_context.frame_context.lossless) {
@@ -1905,6 +1900,46 @@ ALWAYS_INLINE DecoderErrorOr<void> Decoder::inverse_transform_2d(BlockContext co
     return {};
 }
 
+DecoderErrorOr<void> Decoder::copy_into_frame_store(FrameContext const& frame_context, ReferenceFramePlanes& frame_planes)
+{
+    // FIXME: Frame width is not equal to the buffer's stride. If we store the stride of the buffer with the reference
+    //        frame, we can just copy the framebuffer data instead. Alternatively, we should crop the output framebuffer.
+    for (auto plane = 0u; plane < 3; plane++) {
+        auto width = frame_context.size().width();
+        auto height = frame_context.size().height();
+        auto stride = frame_context.decoded_size(plane > 0).width();
+        if (plane > 0) {
+            width = y_size_to_uv_size(frame_context.color_config.subsampling_x, width);
+            height = y_size_to_uv_size(frame_context.color_config.subsampling_y, height);
+        }
+
+        auto const& original_buffer = get_output_buffer(plane);
+        auto& frame_store_buffer = frame_planes.planes[plane];
+        auto frame_store_width = width + MV_BORDER * 2;
+        auto frame_store_height = height + MV_BORDER * 2;
+        DECODER_TRY_ALLOC(frame_store_buffer.try_resize_and_keep_capacity(frame_store_width * frame_store_height));
+
+        VERIFY(original_buffer.size() >= width * height);
+        for (auto destination_y = 0u; destination_y < frame_store_height; destination_y++) {
+            // Offset the source row by the motion vector border and then clamp it to the range of 0...height.
+            // This will create an extended border on the top and bottom of the reference frame to avoid having to bounds check
+            // inter-prediction.
+            auto source_y = min(destination_y >= MV_BORDER ? destination_y - MV_BORDER : 0, height - 1);
+            auto const* source = &original_buffer[source_y * stride];
+            auto* destination = &frame_store_buffer[destination_y * frame_store_width];
+
+            // Stretch the leftmost and rightmost samples out into the border.
+            AK::TypedTransfer<u16>::copy(destination + MV_BORDER, source, width);
+            for (auto destination_x = 0u; destination_x < MV_BORDER; destination_x++) {
+                destination[destination_x] = source[0];
+                destination[MV_BORDER + width + destination_x] = source[width - 1];
+            }
+        }
+    }
+
+    return {};
+}
+
 DecoderErrorOr<void> Decoder::update_reference_frames(FrameContext const& frame_context)
 {
     // This process is invoked as the final step in decoding a frame.
@@ -1914,6 +1949,9 @@ DecoderErrorOr<void> Decoder::update_reference_frames(FrameContext const& frame_
 
     // 1. For each value of i from 0 to NUM_REF_FRAMES - 1, the following applies if bit i of refresh_frame_flags
     // is equal to 1 (i.e. if (refresh_frame_flags>>i)&1 is equal to 1):
+    // NOTE: Every slot that is refreshed receives the same samples, so they are only copied into the frame store once, and
+    //       the resulting planes are shared between those slots.
+    RefPtr<ReferenceFramePlanes> frame_planes;
     for (u8 i = 0; i < NUM_REF_FRAMES; i++) {
         if (frame_context.should_update_reference_frame_at_index(i)) {
             auto& reference_frame = m_parser->m_reference_frames[i];
@@ -1933,51 +1971,15 @@ DecoderErrorOr<void> Decoder::update_reference_frames(FrameContext const& frame_
             // − FrameStore[ i ][ plane ][ y ][ x ] is set equal to CurrFrame[ plane ][ y ][ x ] for plane = 1..2, for x =
             // 0..((FrameWidth+subsampling_x) >> subsampling_x)-1, for y = 0..((FrameHeight+subsampling_y) >>
             // subsampling_y)-1.
-
-            // FIXME: Frame width is not equal to the buffer's stride. If we store the stride of the buffer with the reference
-            //        frame, we can just copy the framebuffer data instead. Alternatively, we should crop the output framebuffer.
-            for (auto plane = 0u; plane < 3; plane++) {
-                auto width = frame_context.size().width();
-                auto height = frame_context.size().height();
-                auto stride = frame_context.decoded_size(plane > 0).width();
-                if (plane > 0) {
-                    width = y_size_to_uv_size(frame_context.color_config.subsampling_x, width);
-                    height = y_size_to_uv_size(frame_context.color_config.subsampling_y, height);
-                }
-
-                auto const& original_buffer = get_output_buffer(plane);
-                auto& frame_store_buffer = reference_frame.frame_planes[plane];
-                auto frame_store_width = width + MV_BORDER * 2;
-                auto frame_store_height = height + MV_BORDER * 2;
-                frame_store_buffer.resize_and_keep_capacity(frame_store_width * frame_store_height);
-
-                VERIFY(original_buffer.size() >= width * height);
-                for (auto destination_y = 0u; destination_y < frame_store_height; destination_y++) {
-                    // Offset the source row by the motion vector border and then clamp it to the range of 0...height.
-                    // This will create an extended border on the top and bottom of the reference frame to avoid having to bounds check
-                    // inter-prediction.
-                    auto source_y = min(destination_y >= MV_BORDER ? destination_y - MV_BORDER : 0, height - 1);
-                    auto const* source = &original_buffer[source_y * stride];
-                    auto* destination = &frame_store_buffer[destination_y * frame_store_width + MV_BORDER];
-                    AK::TypedTransfer<RemoveReference<decltype(*destination)>>::copy(destination, source, width);
-                }
-
-                for (auto destination_y = 0u; destination_y < frame_store_height; destination_y++) {
-                    // Stretch the leftmost samples out into the border.
-                    auto sample = frame_store_buffer[destination_y * frame_store_width + MV_BORDER];
-
-                    for (auto destination_x = 0u; destination_x < MV_BORDER; destination_x++) {
-                        frame_store_buffer[destination_y * frame_store_width + destination_x] = sample;
-                    }
-
-                    // Stretch the rightmost samples out into the border.
-                    sample = frame_store_buffer[destination_y * frame_store_width + MV_BORDER + width - 1];
-
-                    for (auto destination_x = MV_BORDER + width; destination_x < frame_store_width; destination_x++) {
-                        frame_store_buffer[destination_y * frame_store_width + destination_x] = sample;
-                    }
-                }
+            if (!frame_planes) {
+                // Reuse the buffers of the frame that is being replaced if no other slot refers to them anymore.
+                if (reference_frame.frame_planes && reference_frame.frame_planes->ref_count() == 1)
+                    frame_planes = reference_frame.frame_planes;
+                else
+                    frame_planes = DECODER_TRY_ALLOC(try_make_ref_counted<ReferenceFramePlanes>());
+                TRY(copy_into_frame_store(frame_context, *frame_planes));
             }
+            reference_frame.frame_planes = frame_planes;
         }
     }
 
@@ -138,11 +138,16 @@ private:
     inline DecoderErrorOr<void> inverse_asymmetric_discrete_sine_transform(Span<Intermediate> data);
 
     /* (8.10) Reference Frame Update Process */
+    DecoderErrorOr<void> copy_into_frame_store(FrameContext const&, ReferenceFramePlanes&);
     DecoderErrorOr<void> update_reference_frames(FrameContext const&);
 
     NonnullOwnPtr<Parser> m_parser;
 
-    Vector<u16> m_output_buffers[3];
+    // The planes of the frame that is being decoded, which are handed to the VideoFrame once it is output.
+    RefPtr<VideoFrameBuffer> m_output_buffer;
+    // The frame is converted and released by the consumer soon after it has been decoded, so only a few buffers are
+    // needed to avoid allocating new ones.
+    VideoFrameBufferPool m_output_buffer_pool { 4 };
 
     Queue<NonnullOwnPtr<VideoFrame>, 1> m_video_frame_queue;
 };
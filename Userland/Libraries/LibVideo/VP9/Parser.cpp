@@ -1450,7 +1450,9 @@ DecoderErrorOr<bool> Parser::residual(BlockContext& block_context, bool has_bloc
                         auto transform_set = select_transform_type(block_context, plane, transform_size, sub_block_index);
                         sub_block_had_non_zero_tokens = tokens(block_context, plane, x, y, transform_size, transform_set, token_cache);
                         block_had_non_zero_tokens = block_had_non_zero_tokens || sub_block_had_non_zero_tokens;
-                        TRY(m_decoder.reconstruct(plane, block_context, transform_x_in_px, transform_y_in_px, transform_size, transform_set));
+                        // A transform block without any coefficients has a residual of zero, so there is nothing to add.
+                        if (sub_block_had_non_zero_tokens)
+                            TRY(m_decoder.reconstruct(plane, block_context, transform_x_in_px, transform_y_in_px, transform_size, transform_set));
                     }
                 }
 
@@ -1500,15 +1502,16 @@ static u16 const* get_scan(TransformSize transform_size, TransformSet transform_
     return default_scan_32x32;
 }
 
-bool Parser::tokens(BlockContext& block_context, size_t plane, u32 sub_block_column, u32 sub_block_row, TransformSize transform_size, TransformSet transform_set, Array<u8, 1024> token_cache)
+bool Parser::tokens(BlockContext& block_context, size_t plane, u32 sub_block_column, u32 sub_block_row, TransformSize transform_size, TransformSet transform_set, Array<u8, 1024>& token_cache)
 {
-    block_context.residual_tokens.fill(0);
+    u16 transform_pixel_count = 16 << (transform_size << 1);
+    // Only the coefficients of the transform block are read by the reconstruction, so leave the rest alone.
+    block_context.residual_tokens.span().trim(transform_pixel_count).fill(0);
 
     auto const* scan = get_scan(transform_size, transform_set);
 
     auto check_for_more_coefficients = true;
     u16 coef_index = 0;
-    u16 transform_pixel_count = 16 << (transform_size << 1);
     for (; coef_index < transform_pixel_count; coef_index++) {
         auto band = (transform_size == Transform_4x4) ? coefband_4x4[coef_index] : coefband_8x8plus[coef_index];
         auto token_position = scan[coef_index];
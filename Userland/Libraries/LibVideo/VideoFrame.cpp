@@ -12,53 +12,108 @@
 
 namespace Video {
 
+ErrorOr<NonnullRefPtr<VideoFrameBuffer>> VideoFrameBuffer::create()
+{
+    return adopt_nonnull_ref_or_enomem(new (nothrow) VideoFrameBuffer());
+}
+
+ErrorOr<NonnullRefPtr<VideoFrameBuffer>> VideoFrameBufferPool::take()
+{
+    for (auto& buffer : m_buffers) {
+        if (buffer->ref_count() == 1)
+            return buffer;
+    }
+
+    auto buffer = TRY(VideoFrameBuffer::create());
+    // If the consumer holds on to more frames than we are willing to keep around, the buffer is freed with its frame.
+    if (m_buffers.size() < m_max_pooled_buffer_count)
+        TRY(m_buffers.try_append(buffer));
+    return buffer;
+}
+
 ErrorOr<NonnullOwnPtr<SubsampledYUVFrame>> SubsampledYUVFrame::try_create(
     Gfx::Size<u32> size,
     u8 bit_depth, CodingIndependentCodePoints cicp,
     bool subsampling_horizontal, bool subsampling_vertical,
     Span<u16> plane_y, Span<u16> plane_u, Span<u16> plane_v)
 {
-    auto plane_y_array = TRY(FixedArray<u16>::create(plane_y));
-    auto plane_u_array = TRY(FixedArray<u16>::create(plane_u));
-    auto plane_v_array = TRY(FixedArray<u16>::create(plane_v));
-    return adopt_nonnull_own_or_enomem(new (nothrow) SubsampledYUVFrame(size, bit_depth, cicp, subsampling_horizontal, subsampling_vertical, plane_y_array, plane_u_array, plane_v_array));
+    auto buffer = TRY(VideoFrameBuffer::create());
+    TRY(buffer->plane(0).try_append(plane_y.data(), plane_y.size()));
+    TRY(buffer->plane(1).try_append(plane_u.data(), plane_u.size()));
+    TRY(buffer->plane(2).try_append(plane_v.data(), plane_v.size()));
+    auto uv_width = (size.width() + subsampling_horizontal) >> subsampling_horizontal;
+    return adopt_nonnull_own_or_enomem(new (nothrow) SubsampledYUVFrame(size, bit_depth, cicp, subsampling_horizontal, subsampling_vertical, move(buffer), size.width(), uv_width));
 }
 
 template<u32 subsampling_horizontal>
-ALWAYS_INLINE void interpolate_row(u32 const row, u32 const width, u16 const* plane_u, u16 const* plane_v, u16* __restrict__ u_row, u16* __restrict__ v_row)
+ALWAYS_INLINE void interpolate_row(u32 const row, u32 const width, u16 const* plane_u, u16 const* plane_v, u32 const uv_stride, u16* __restrict__ u_row, u16* __restrict__ v_row)
 {
     // OPTIMIZATION: __restrict__ allows some load eliminations because the planes and the rows will not alias.
 
     constexpr auto horizontal_step = 1u << subsampling_horizontal;
-    auto const uv_width = (width + subsampling_horizontal) >> subsampling_horizontal;
+    auto const* u_samples = plane_u + static_cast<size_t>(row) * uv_stride;
+    auto const* v_samples = plane_v + static_cast<size_t>(row) * uv_stride;
+
+    if constexpr (subsampling_horizontal == 0) {
+        AK::TypedTransfer<u16>::copy(u_row, u_samples, width);
+        AK::TypedTransfer<u16>::copy(v_row, v_samples, width);
+        return;
+    }
+
     // Set the first column to the first chroma samples.
-    u_row[0] = plane_u[row * uv_width];
-    v_row[0] = plane_v[row * uv_width];
+    u_row[0] = u_samples[0];
+    v_row[0] = v_samples[0];
 
     auto const columns_end = width - subsampling_horizontal;
-    // Interpolate the inner chroma columns.
-    for (u32 column = 1; column < columns_end; column += horizontal_step) {
-        auto uv_column = column >> subsampling_horizontal;
-        u_row[column] = plane_u[row * uv_width + uv_column];
-        v_row[column] = plane_v[row * uv_width + uv_column];
+    u32 column = 1;
+
+    // Interpolate the inner chroma columns, sixteen output samples at a time: each chroma sample is followed by the
+    // average of it and the next one.
+    auto interpolate_eight_samples = [](u16 const* samples, u16* destination) {
+        using AK::SIMD::u16x8;
+        u16x8 current;
+        u16x8 next;
+        __builtin_memcpy(&current, samples, sizeof(current));
+        __builtin_memcpy(&next, samples + 1, sizeof(next));
+        u16x8 averages = (current + next) >> 1;
+        u16x8 low = __builtin_shufflevector(current, averages, 0, 8, 1, 9, 2, 10, 3, 11);
+        u16x8 high = __builtin_shufflevector(current, averages, 4, 12, 5, 13, 6, 14, 7, 15);
+        __builtin_memcpy(destination, &low, sizeof(low));
+        __builtin_memcpy(destination + 8, &high, sizeof(high));
+    };
+    auto const uv_width = (width + 1) >> 1;
+    for (; column + 16 < columns_end && (column >> 1) + 9 <= uv_width; column += 16) {
+        interpolate_eight_samples(u_samples + (column >> 1), u_row + column);
+        interpolate_eight_samples(v_samples + (column >> 1), v_row + column);
+    }
 
-        if constexpr (subsampling_horizontal != 0) {
-            u_row[column + 1] = (plane_u[row * uv_width + uv_column] + plane_u[row * uv_width + uv_column + 1]) >> 1;
-            v_row[column + 1] = (plane_v[row * uv_width + uv_column] + plane_v[row * uv_width + uv_column + 1]) >> 1;
-        }
+    for (; column < columns_end; column += horizontal_step) {
+        auto uv_column = column >> subsampling_horizontal;
+        u_row[column] = u_samples[uv_column];
+        v_row[column] = v_samples[uv_column];
+        u_row[column + 1] = (u_samples[uv_column] + u_samples[uv_column + 1]) >> 1;
+        v_row[column + 1] = (v_samples[uv_column] + v_samples[uv_column + 1]) >> 1;
     }
 
     // If there is a last chroma sample that hasn't been set above, set it now.
-    if constexpr (subsampling_horizontal != 0) {
-        if ((width & 1) == 0) {
-            u_row[width - 1] = u_row[width - 2];
-            v_row[width - 1] = v_row[width - 2];
-        }
+    if ((width & 1) == 0) {
+        u_row[width - 1] = u_row[width - 2];
+        v_row[width - 1] = v_row[width - 2];
     }
 }
 
-template<u32 subsampling_horizontal, u32 subsampling_vertical, typename Convert>
-ALWAYS_INLINE DecoderErrorOr<void> convert_to_bitmap_subsampled(Convert convert, u32 const width, u32 const height, FixedArray<u16> const& plane_y, FixedArray<u16> const& plane_u, FixedArray<u16> const& plane_v, Gfx::Bitmap& bitmap)
+struct PlanesToConvert {
+    u16 const* y;
+    u16 const* u;
+    u16 const* v;
+    u32 y_stride;
+    u32 uv_stride;
+};
+
+// Converts the planes to the bitmap one row at a time. `convert_row` is called with the luma samples and the (upsampled)
+// chroma samples of each row, and writes the resulting pixels to the row of the bitmap it is given.
+template<u32 subsampling_horizontal, u32 subsampling_vertical, typename ConvertRow>
+ALWAYS_INLINE DecoderErrorOr<void> convert_to_bitmap_subsampled(ConvertRow convert_row, u32 const width, u32 const height, PlanesToConvert const& planes, Gfx::Bitmap& bitmap)
 {
     VERIFY(bitmap.width() >= 0 && static_cast<u32>(bitmap.width()) == width);
     VERIFY(bitmap.height() >= 0 && static_cast<u32>(bitmap.height()) == height);
@@ -74,15 +129,16 @@ ALWAYS_INLINE DecoderErrorOr<void> convert_to_bitmap_subsampled(Convert convert,
     auto* v_row_b = temporary_buffer.span().slice(static_cast<size_t>(width) * 3, width).data();
 
     u32 const vertical_step = 1 << subsampling_vertical;
+    auto y_row_at = [&](u32 row) { return planes.y + static_cast<size_t>(row) * planes.y_stride; };
 
-    interpolate_row<subsampling_horizontal>(0, width, plane_u.data(), plane_v.data(), u_row_a, v_row_a);
+    interpolate_row<subsampling_horizontal>(0, width, planes.u, planes.v, planes.uv_stride, u_row_a, v_row_a);
 
     // Do interpolation for all inner rows.
     u32 const rows_end = height - subsampling_vertical;
     for (u32 row = 0; row < rows_end; row += vertical_step) {
         // Horizontally scale the row if subsampled.
         auto uv_row = row >> subsampling_vertical;
-        interpolate_row<subsampling_horizontal>(uv_row, width, plane_u.data(), plane_v.data(), u_row_b, v_row_b);
+        interpolate_row<subsampling_horizontal>(uv_row, width, planes.u, planes.v, planes.uv_stride, u_row_b, v_row_b);
 
         // If subsampled vertically, vertically interpolate the middle row between the above and below rows.
         if constexpr (subsampling_vertical != 0) {
@@ -95,81 +151,100 @@ ALWAYS_INLINE DecoderErrorOr<void> convert_to_bitmap_subsampled(Convert convert,
             }
         }
 
-        auto const* y_row_a = &plane_y[static_cast<size_t>(row) * width];
-        auto* scan_line_a = bitmap.scanline(static_cast<int>(row));
-
-        for (size_t column = 0; column < width; column++) {
-            scan_line_a[column] = convert(y_row_a[column], u_row_a[column], v_row_a[column]).value();
-        }
         if constexpr (subsampling_vertical != 0) {
-            auto const* y_row_b = &plane_y[static_cast<size_t>(row + 1) * width];
-            auto* scan_line_b = bitmap.scanline(static_cast<int>(row + 1));
-            for (size_t column = 0; column < width; column++) {
-                scan_line_b[column] = convert(y_row_b[column], u_row_b[column], v_row_b[column]).value();
-            }
+            convert_row(y_row_at(row), u_row_a, v_row_a, bitmap.scanline(static_cast<int>(row)), width);
+            convert_row(y_row_at(row + 1), u_row_b, v_row_b, bitmap.scanline(static_cast<int>(row + 1)), width);
+        } else {
+            // Without vertical subsampling, the chroma samples of this row are the ones that were just interpolated.
+            convert_row(y_row_at(row), u_row_b, v_row_b, bitmap.scanline(static_cast<int>(row)), width);
         }
 
-        AK::TypedTransfer<RemoveReference<decltype(*u_row_a)>>::move(u_row_a, u_row_b, width);
-        AK::TypedTransfer<RemoveReference<decltype(*u_row_a)>>::move(v_row_a, v_row_b, width);
+        swap(u_row_a, u_row_b);
+        swap(v_row_a, v_row_b);
     }
 
     if constexpr (subsampling_vertical != 0) {
         // If there is a final row that hasn't been set above, convert it now.
-        if ((height & 1) == 0) {
-            auto const* y_row = &plane_y[static_cast<size_t>(height - 1) * width];
-            auto* scan_line = bitmap.scanline(static_cast<int>(height - 1));
-            for (size_t column = 0; column < width; column++) {
-                scan_line[column] = convert(y_row[column], u_row_a[column], v_row_a[column]).value();
-            }
-        }
+        if ((height & 1) == 0)
+            convert_row(y_row_at(height - 1), u_row_a, v_row_a, bitmap.scanline(static_cast<int>(height - 1)), width);
     }
 
     return {};
 }
 
 template<u32 subsampling_horizontal, u32 subsampling_vertical>
-static ALWAYS_INLINE DecoderErrorOr<void> convert_to_bitmap_selecting_converter(CodingIndependentCodePoints cicp, u8 bit_depth, u32 const width, u32 const height, FixedArray<u16> const& plane_y, FixedArray<u16> const& plane_u, FixedArray<u16> const& plane_v, Gfx::Bitmap& bitmap)
+static ALWAYS_INLINE DecoderErrorOr<void> convert_to_bitmap_selecting_converter(CodingIndependentCodePoints cicp, u8 bit_depth, u32 const width, u32 const height, PlanesToConvert const& planes, Gfx::Bitmap& bitmap)
 {
     constexpr auto output_cicp = CodingIndependentCodePoints(ColorPrimaries::BT709, TransferCharacteristics::SRGB, MatrixCoefficients::BT709, VideoFullRangeFlag::Full);
 
-    if (bit_depth == 8 && cicp.transfer_characteristics() == output_cicp.transfer_characteristics() && cicp.color_primaries() == output_cicp.color_primaries() && cicp.video_full_range_flag() == VideoFullRangeFlag::Studio) {
+    auto convert_simple = [&]<MatrixCoefficients MC, VideoFullRangeFlag FR>() {
+        return convert_to_bitmap_subsampled<subsampling_horizontal, subsampling_vertical>([](u16 const* y_row, u16 const* u_row, u16 const* v_row, Gfx::ARGB32* destination, u32 width) { ColorConverter::convert_simple_yuv_to_rgb_row<MC, FR>(y_row, u_row, v_row, destination, width); }, width, height, planes, bitmap);
+    };
+    auto convert_simple_selecting_matrix = [&]<VideoFullRangeFlag FR>() -> Optional<DecoderErrorOr<void>> {
         switch (cicp.matrix_coefficients()) {
         case MatrixCoefficients::BT709:
-            return convert_to_bitmap_subsampled<subsampling_horizontal, subsampling_vertical>([](u16 y, u16 u, u16 v) { return ColorConverter::convert_simple_yuv_to_rgb<MatrixCoefficients::BT709, VideoFullRangeFlag::Studio>(y, u, v); }, width, height, plane_y, plane_u, plane_v, bitmap);
+            return convert_simple.template operator()<MatrixCoefficients::BT709, FR>();
         case MatrixCoefficients::BT601:
-            return convert_to_bitmap_subsampled<subsampling_horizontal, subsampling_vertical>([](u16 y, u16 u, u16 v) { return ColorConverter::convert_simple_yuv_to_rgb<MatrixCoefficients::BT601, VideoFullRangeFlag::Studio>(y, u, v); }, width, height, plane_y, plane_u, plane_v, bitmap);
+            return convert_simple.template operator()<MatrixCoefficients::BT601, FR>();
         case MatrixCoefficients::BT2020ConstantLuminance:
         case MatrixCoefficients::BT2020NonConstantLuminance:
-            return convert_to_bitmap_subsampled<subsampling_horizontal, subsampling_vertical>([](u16 y, u16 u, u16 v) { return ColorConverter::convert_simple_yuv_to_rgb<MatrixCoefficients::BT2020ConstantLuminance, VideoFullRangeFlag::Studio>(y, u, v); }, width, height, plane_y, plane_u, plane_v, bitmap);
+            return convert_simple.template operator()<MatrixCoefficients::BT2020ConstantLuminance, FR>();
         default:
-            VERIFY_NOT_REACHED();
+            return {};
         }
+    };
+
+    // The transfer characteristics and primaries already match the output, so only the matrix and range have to be applied.
+    if (bit_depth == 8 && cicp.transfer_characteristics() == output_cicp.transfer_characteristics() && cicp.color_primaries() == output_cicp.color_primaries()) {
+        auto result = cicp.video_full_range_flag() == VideoFullRangeFlag::Studio
+            ? convert_simple_selecting_matrix.template operator()<VideoFullRangeFlag::Studio>()
+            : convert_simple_selecting_matrix.template operator()<VideoFullRangeFlag::Full>();
+        if (result.has_value())
+            return result.release_value();
     }
 
     auto converter = TRY(ColorConverter::create(bit_depth, cicp, output_cicp));
-    return convert_to_bitmap_subsampled<subsampling_horizontal, subsampling_vertical>([&](u16 y, u16 u, u16 v) { return converter.convert_yuv(y, u, v); }, width, height, plane_y, plane_u, plane_v, bitmap);
+    auto convert_row = [&](u16 const* y_row, u16 const* u_row, u16 const* v_row, Gfx::ARGB32* destination, u32 width) {
+        for (u32 column = 0; column < width; column++)
+            destination[column] = converter.convert_yuv(y_row[column], u_row[column], v_row[column]).value();
+    };
+    return convert_to_bitmap_subsampled<subsampling_horizontal, subsampling_vertical>(convert_row, width, height, planes, bitmap);
 }
 
-static DecoderErrorOr<void> convert_to_bitmap_selecting_subsampling(bool subsampling_horizontal, bool subsampling_vertical, CodingIndependentCodePoints cicp, u8 bit_depth, u32 const width, u32 const height, FixedArray<u16> const& plane_y, FixedArray<u16> const& plane_u, FixedArray<u16> const& plane_v, Gfx::Bitmap& bitmap)
+static DecoderErrorOr<void> convert_to_bitmap_selecting_subsampling(bool subsampling_horizontal, bool subsampling_vertical, CodingIndependentCodePoints cicp, u8 bit_depth, u32 const width, u32 const height, PlanesToConvert const& planes, Gfx::Bitmap& bitmap)
 {
     if (subsampling_horizontal && subsampling_vertical) {
-        return convert_to_bitmap_selecting_converter<true, true>(cicp, bit_depth, width, height, plane_y, plane_u, plane_v, bitmap);
+        return convert_to_bitmap_selecting_converter<true, true>(cicp, bit_depth, width, height, planes, bitmap);
     }
 
     if (subsampling_horizontal && !subsampling_vertical) {
-        return convert_to_bitmap_selecting_converter<true, false>(cicp, bit_depth, width, height, plane_y, plane_u, plane_v, bitmap);
+        return convert_to_bitmap_selecting_converter<true, false>(cicp, bit_depth, width, height, planes, bitmap);
     }
 
     if (!subsampling_horizontal && subsampling_vertical) {
-        return convert_to_bitmap_selecting_converter<false, true>(cicp, bit_depth, width, height, plane_y, plane_u, plane_v, bitmap);
+        return convert_to_bitmap_selecting_converter<false, true>(cicp, bit_depth, width, height, planes, bitmap);
     }
 
-    return convert_to_bitmap_selecting_converter<false, false>(cicp, bit_depth, width, height, plane_y, plane_u, plane_v, bitmap);
+    return convert_to_bitmap_selecting_converter<false, false>(cicp, bit_depth, width, height, planes, bitmap);
 }
 
 DecoderErrorOr<void> SubsampledYUVFrame::output_to_bitmap(Gfx::Bitmap& bitmap)
 {
-    return convert_to_bitmap_selecting_subsampling(m_subsampling_horizontal, m_subsampling_vertical, cicp(), bit_depth(), width(), height(), m_plane_y, m_plane_u, m_plane_v, bitmap);
+    auto uv_width = (width() + m_subsampling_horizontal) >> m_subsampling_horizontal;
+    auto uv_height = (height() + m_subsampling_vertical) >> m_subsampling_vertical;
+    VERIFY(m_y_stride >= width() && m_uv_stride >= uv_width);
+    VERIFY(m_buffer->plane(0).size() >= static_cast<size_t>(m_y_stride) * (height() - 1) + width());
+    VERIFY(m_buffer->plane(1).size() >= static_cast<size_t>(m_uv_stride) * (uv_height - 1) + uv_width);
+    VERIFY(m_buffer->plane(2).size() >= static_cast<size_t>(m_uv_stride) * (uv_height - 1) + uv_width);
+
+    PlanesToConvert planes {
+        .y = m_buffer->plane(0).data(),
+        .u = m_buffer->plane(1).data(),
+        .v = m_buffer->plane(2).data(),
+        .y_stride = m_y_stride,
+        .uv_stride = m_uv_stride,
+    };
+    return convert_to_bitmap_selecting_subsampling(m_subsampling_horizontal, m_subsampling_vertical, cicp(), bit_depth(), width(), height(), planes, bitmap);
 }
 
 }
@@ -6,8 +6,13 @@
 
 #pragma once
 
+#include <AK/Array.h>
+#include <AK/AtomicRefCounted.h>
 #include <AK/ByteBuffer.h>
 #include <AK/FixedArray.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Vector.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/Size.h>
 #include <LibVideo/Color/CodingIndependentCodePoints.h>
@@ -15,6 +20,37 @@
 
 namespace Video {
 
+// The samples of the three planes of a frame. Decoders hand these to the frames they output instead of copying them out,
+// so they must not be modified once a frame refers to them.
+class VideoFrameBuffer : public AtomicRefCounted<VideoFrameBuffer> {
+public:
+    static ErrorOr<NonnullRefPtr<VideoFrameBuffer>> create();
+
+    Vector<u16>& plane(u8 index) { return m_planes[index]; }
+    Vector<u16> const& plane(u8 index) const { return m_planes[index]; }
+
+private:
+    VideoFrameBuffer() = default;
+
+    Array<Vector<u16>, 3> m_planes;
+};
+
+// Hands out frame buffers, reusing the ones that nothing but the pool refers to anymore, so that decoding a frame does
+// not have to allocate (and fault in) its planes every time.
+class VideoFrameBufferPool {
+public:
+    explicit VideoFrameBufferPool(size_t max_pooled_buffer_count)
+        : m_max_pooled_buffer_count(max_pooled_buffer_count)
+    {
+    }
+
+    ErrorOr<NonnullRefPtr<VideoFrameBuffer>> take();
+
+private:
+    size_t m_max_pooled_buffer_count { 0 };
+    Vector<NonnullRefPtr<VideoFrameBuffer>> m_buffers;
+};
+
 class VideoFrame {
 
 public:
@@ -58,28 +94,34 @@ public:
         bool subsampling_horizontal, bool subsampling_vertical,
         Span<u16> plane_y, Span<u16> plane_u, Span<u16> plane_v);
 
+    // The rows of the planes in `buffer` are `y_stride` and `uv_stride` samples apart, which allows a decoder to output
+    // the buffers it decoded into (including their padding) as they are.
     SubsampledYUVFrame(
         Gfx::Size<u32> size,
         u8 bit_depth, CodingIndependentCodePoints cicp,
         bool subsampling_horizontal, bool subsampling_vertical,
-        FixedArray<u16>& plane_y, FixedArray<u16>& plane_u, FixedArray<u16>& plane_v)
+        NonnullRefPtr<VideoFrameBuffer> buffer, u32 y_stride, u32 uv_stride)
         : VideoFrame(size, bit_depth, cicp)
         , m_subsampling_horizontal(subsampling_horizontal)
         , m_subsampling_vertical(subsampling_vertical)
-        , m_plane_y(move(plane_y))
-        , m_plane_u(move(plane_u))
-        , m_plane_v(move(plane_v))
+        , m_buffer(move(buffer))
+        , m_y_stride(y_stride)
+        , m_uv_stride(uv_stride)
     {
     }
 
     DecoderErrorOr<void> output_to_bitmap(Gfx::Bitmap& bitmap) override;
 
+    VideoFrameBuffer const& buffer() const { return m_buffer; }
+    u32 y_stride() const { return m_y_stride; }
+    u32 uv_stride() const { return m_uv_stride; }
+
 protected:
     bool m_subsampling_horizontal;
     bool m_subsampling_vertical;
-    FixedArray<u16> m_plane_y;
-    FixedArray<u16> m_plane_u;
-    FixedArray<u16> m_plane_v;
+    NonnullRefPtr<VideoFrameBuffer> m_buffer;
+    u32 m_y_stride;
+    u32 m_uv_stride;
 };
 
 }
@@ -993,6 +993,8 @@ void KeyframeEffect::update_style_properties()
     if (target->layout_node())
         target->layout_node()->apply_style(*style);
 
+    // NOTE: A layout of the whole document also drops the intrinsic sizes cached on boxes, which inherited animated
+    //       properties may have changed for the target's descendants as well.
     if (invalidation.relayout)
         document.set_needs_layout();
     if (invalidation.rebuild_layout_tree)
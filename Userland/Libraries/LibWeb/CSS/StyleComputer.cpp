@@ -2448,7 +2448,7 @@ RefPtr<StyleProperties> StyleComputer::compute_style_impl(DOM::Element& element,
 
 void StyleComputer::build_rule_cache_if_needed() const
 {
-    if (m_author_rule_cache && m_user_rule_cache && m_user_agent_rule_cache)
+    if (m_author_rule_cache && m_user_rule_cache && m_user_agent_rule_cache && m_style_invalidation_data)
         return;
     const_cast<StyleComputer&>(*this).build_rule_cache();
 }
@@ -2485,6 +2485,8 @@ NonnullOwnPtr<StyleComputer::RuleCache> StyleComputer::make_rule_cache_for_casca
                     SelectorEngine::can_use_fast_matches(selector),
                 };
 
+                m_style_invalidation_data->add_selector(selector);
+
                 for (auto const& simple_selector : selector.compound_selectors().last().simple_selectors) {
                     if (!matching_rule.contains_pseudo_element) {
                         if (simple_selector.type == CSS::Selector::SimpleSelector::Type::PseudoElement) {
@@ -2608,6 +2610,7 @@ void StyleComputer::build_rule_cache()
         m_user_style_sheet = JS::make_handle(parse_css_stylesheet(CSS::Parser::ParsingContext(document()), user_style_source.value()));
     }
 
+    m_style_invalidation_data = make<StyleInvalidationData>();
     m_author_rule_cache = make_rule_cache_for_cascade_origin(CascadeOrigin::Author);
     m_user_rule_cache = make_rule_cache_for_cascade_origin(CascadeOrigin::User);
     m_user_agent_rule_cache = make_rule_cache_for_cascade_origin(CascadeOrigin::UserAgent);
@@ -2616,6 +2619,7 @@ void StyleComputer::build_rule_cache()
 void StyleComputer::invalidate_rule_cache()
 {
     m_author_rule_cache = nullptr;
+    m_style_invalidation_data = nullptr;
 
     // NOTE: We could be smarter about keeping the user rule cache, and style sheet.
     //       Currently we are re-parsing the user style sheet every time we build the caches,
@@ -2628,6 +2632,12 @@ void StyleComputer::invalidate_rule_cache()
     m_user_agent_rule_cache = nullptr;
 }
 
+StyleInvalidationData const& StyleComputer::style_invalidation_data() const
+{
+    build_rule_cache_if_needed();
+    return *m_style_invalidation_data;
+}
+
 void StyleComputer::did_load_font(FlyString const&)
 {
     document().invalidate_style();
@@ -15,6 +15,7 @@
 #include <LibWeb/CSS/CSSKeyframesRule.h>
 #include <LibWeb/CSS/CSSStyleDeclaration.h>
 #include <LibWeb/CSS/Selector.h>
+#include <LibWeb/CSS/StyleInvalidation.h>
 #include <LibWeb/CSS/StyleProperties.h>
 #include <LibWeb/Forward.h>
 #include <LibWeb/Loader/ResourceLoader.h>
@@ -134,6 +135,8 @@ public:
 
     void invalidate_rule_cache();
 
+    [[nodiscard]] StyleInvalidationData const& style_invalidation_data() const;
+
     Gfx::Font const& initial_font() const;
 
     void did_load_font(FlyString const& family_name);
@@ -217,6 +220,7 @@ private:
     OwnPtr<RuleCache> m_author_rule_cache;
     OwnPtr<RuleCache> m_user_rule_cache;
     OwnPtr<RuleCache> m_user_agent_rule_cache;
+    OwnPtr<StyleInvalidationData> m_style_invalidation_data;
     JS::Handle<CSSStyleSheet> m_user_style_sheet;
 
     using FontLoaderList = Vector<NonnullOwnPtr<FontLoader>>;
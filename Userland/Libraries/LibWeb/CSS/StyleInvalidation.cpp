@@ -58,4 +58,169 @@ RequiredInvalidationAfterStyleChange compute_property_invalidation(CSS::Property
     return invalidation;
 }
 
+// How the elements affected by a feature relate to the element that gained or lost it.
+enum class InvalidationScope {
+    Self,
+    Descendants,
+    AllDescendants,
+    FollowingSiblings,
+    WholeDocument,
+};
+
+static InvalidationScope invalidation_scope_for_compound_at(Selector const& selector, size_t compound_index)
+{
+    auto const& compound_selectors = selector.compound_selectors();
+    if (compound_index == compound_selectors.size() - 1)
+        return InvalidationScope::Self;
+
+    bool has_sibling_combinator = false;
+    for (size_t i = compound_index + 1; i < compound_selectors.size(); ++i) {
+        switch (compound_selectors[i].combinator) {
+        case Selector::Combinator::Column:
+            return InvalidationScope::WholeDocument;
+        case Selector::Combinator::NextSibling:
+        case Selector::Combinator::SubsequentSibling:
+            has_sibling_combinator = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    auto next_combinator = compound_selectors[compound_index + 1].combinator;
+    if (next_combinator == Selector::Combinator::NextSibling || next_combinator == Selector::Combinator::SubsequentSibling)
+        return InvalidationScope::FollowingSiblings;
+
+    // NOTE: A sibling combinator further to the right means that siblings of descendants can be affected,
+    //       and those are descendants too. We don't try to narrow that case down.
+    if (has_sibling_combinator)
+        return InvalidationScope::AllDescendants;
+    return InvalidationScope::Descendants;
+}
+
+// Picks a feature that every element matching the subject compound must have, in the same order of preference
+// as the rule cache buckets. Returns nullptr if there is no such feature.
+static Selector::SimpleSelector const* descendant_feature_for_subject(Selector const& selector)
+{
+    for (auto type : { Selector::SimpleSelector::Type::Id, Selector::SimpleSelector::Type::Class, Selector::SimpleSelector::Type::TagName, Selector::SimpleSelector::Type::Attribute }) {
+        for (auto const& simple_selector : selector.compound_selectors().last().simple_selectors) {
+            if (simple_selector.type == type)
+                return &simple_selector;
+        }
+    }
+    return nullptr;
+}
+
+static void add_scope_to_invalidation_set(InvalidationSet& set, InvalidationScope scope, Selector::SimpleSelector const* descendant_feature)
+{
+    switch (scope) {
+    case InvalidationScope::Self:
+        set.invalidate_self = true;
+        break;
+    case InvalidationScope::Descendants:
+        if (!descendant_feature) {
+            set.invalidate_all_descendants = true;
+            break;
+        }
+        switch (descendant_feature->type) {
+        case Selector::SimpleSelector::Type::Id:
+            set.descendant_ids.set(descendant_feature->name());
+            break;
+        case Selector::SimpleSelector::Type::Class:
+            set.descendant_classes.set(descendant_feature->name());
+            break;
+        case Selector::SimpleSelector::Type::TagName:
+            set.descendant_tag_names.set(descendant_feature->qualified_name().name.lowercase_name);
+            break;
+        case Selector::SimpleSelector::Type::Attribute:
+            set.descendant_attribute_names.set(descendant_feature->attribute().qualified_name.name.lowercase_name);
+            break;
+        default:
+            VERIFY_NOT_REACHED();
+        }
+        break;
+    case InvalidationScope::AllDescendants:
+        set.invalidate_all_descendants = true;
+        break;
+    case InvalidationScope::FollowingSiblings:
+        set.invalidate_following_siblings = true;
+        break;
+    case InvalidationScope::WholeDocument:
+        set.invalidate_whole_document = true;
+        break;
+    }
+}
+
+static void collect_invalidation_sets_for_compound(StyleInvalidationData&, Selector::CompoundSelector const&, InvalidationScope, Selector::SimpleSelector const* descendant_feature, Optional<PseudoClass> nth_child_pseudo_class = {});
+
+static void collect_invalidation_sets_for_argument_selector(StyleInvalidationData& data, Selector const& argument_selector, InvalidationScope scope, Selector::SimpleSelector const* descendant_feature, PseudoClass pseudo_class)
+{
+    auto const& compound_selectors = argument_selector.compound_selectors();
+    for (size_t i = 0; i < compound_selectors.size(); ++i) {
+        auto argument_scope = invalidation_scope_for_compound_at(argument_selector, i);
+        if (argument_scope == InvalidationScope::Self) {
+            Optional<PseudoClass> nth_child_pseudo_class;
+            if (pseudo_class == PseudoClass::NthChild || pseudo_class == PseudoClass::NthLastChild)
+                nth_child_pseudo_class = pseudo_class;
+            collect_invalidation_sets_for_compound(data, compound_selectors[i], scope, descendant_feature, nth_child_pseudo_class);
+            continue;
+        }
+
+        // NOTE: Features outside the argument's subject compound describe ancestors or siblings of the element
+        //       matched by the pseudo-class. Whatever the outer selector does with that element, the affected
+        //       elements stay within the scope below.
+        if (argument_scope == InvalidationScope::Descendants)
+            argument_scope = InvalidationScope::AllDescendants;
+        if (scope == InvalidationScope::WholeDocument)
+            argument_scope = InvalidationScope::WholeDocument;
+        collect_invalidation_sets_for_compound(data, compound_selectors[i], argument_scope, nullptr);
+    }
+}
+
+static void collect_invalidation_sets_for_compound(StyleInvalidationData& data, Selector::CompoundSelector const& compound, InvalidationScope scope, Selector::SimpleSelector const* descendant_feature, Optional<PseudoClass> nth_child_pseudo_class)
+{
+    auto add_to = [&](InvalidationSet& set) {
+        add_scope_to_invalidation_set(set, scope, descendant_feature);
+        if (!nth_child_pseudo_class.has_value())
+            return;
+        // :nth-child(An+B of S) counts preceding siblings matching S, and :nth-last-child() counts following ones.
+        if (scope != InvalidationScope::Self)
+            set.invalidate_whole_document = true;
+        else if (nth_child_pseudo_class.value() == PseudoClass::NthChild)
+            set.invalidate_following_siblings = true;
+        else
+            set.invalidate_preceding_siblings = true;
+    };
+
+    for (auto const& simple_selector : compound.simple_selectors) {
+        switch (simple_selector.type) {
+        case Selector::SimpleSelector::Type::Id:
+            add_to(data.id_invalidation_sets.ensure(simple_selector.name()));
+            break;
+        case Selector::SimpleSelector::Type::Class:
+            add_to(data.class_invalidation_sets.ensure(simple_selector.name()));
+            break;
+        case Selector::SimpleSelector::Type::Attribute:
+            add_to(data.attribute_invalidation_sets.ensure(simple_selector.attribute().qualified_name.name.lowercase_name));
+            break;
+        case Selector::SimpleSelector::Type::PseudoClass: {
+            auto const& pseudo_class = simple_selector.pseudo_class();
+            for (auto const& argument_selector : pseudo_class.argument_selector_list)
+                collect_invalidation_sets_for_argument_selector(data, argument_selector, scope, descendant_feature, pseudo_class.type);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+void StyleInvalidationData::add_selector(Selector const& selector)
+{
+    auto const* descendant_feature = descendant_feature_for_subject(selector);
+    auto const& compound_selectors = selector.compound_selectors();
+    for (size_t i = 0; i < compound_selectors.size(); ++i)
+        collect_invalidation_sets_for_compound(*this, compound_selectors[i], invalidation_scope_for_compound_at(selector, i), descendant_feature);
+}
+
 }
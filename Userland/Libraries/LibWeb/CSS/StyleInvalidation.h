@@ -6,7 +6,11 @@
 
 #pragma once
 
+#include <AK/FlyString.h>
+#include <AK/HashMap.h>
+#include <AK/HashTable.h>
 #include <LibWeb/CSS/PropertyID.h>
+#include <LibWeb/CSS/Selector.h>
 
 namespace Web::CSS {
 
@@ -30,4 +34,43 @@ struct RequiredInvalidationAfterStyleChange {
 
 RequiredInvalidationAfterStyleChange compute_property_invalidation(CSS::PropertyID property_id, RefPtr<CSS::StyleValue const> const& old_value, RefPtr<CSS::StyleValue const> const& new_value);
 
+// Describes which elements may need their style recomputed when a class, id or attribute name
+// starts or stops applying to an element.
+struct InvalidationSet {
+    // The element itself (and, because of inheritance, its subtree).
+    bool invalidate_self { false };
+
+    // Descendants of the element. If invalidate_all_descendants is false, only descendants that
+    // carry one of the listed features can be affected.
+    bool invalidate_all_descendants { false };
+    HashTable<FlyString, AK::ASCIICaseInsensitiveFlyStringTraits> descendant_classes;
+    HashTable<FlyString, AK::ASCIICaseInsensitiveFlyStringTraits> descendant_ids;
+    HashTable<FlyString, AK::ASCIICaseInsensitiveFlyStringTraits> descendant_tag_names;
+    HashTable<FlyString, AK::ASCIICaseInsensitiveFlyStringTraits> descendant_attribute_names;
+
+    // Siblings of the element (and their subtrees), as reached through `+`, `~` or :nth-child(... of S).
+    bool invalidate_following_siblings { false };
+    bool invalidate_preceding_siblings { false };
+
+    // Used for combinators we don't track precisely, such as `||`.
+    bool invalidate_whole_document { false };
+
+    [[nodiscard]] bool is_empty() const
+    {
+        return !invalidate_self && !invalidate_all_descendants && descendant_classes.is_empty() && descendant_ids.is_empty()
+            && descendant_tag_names.is_empty() && descendant_attribute_names.is_empty()
+            && !invalidate_following_siblings && !invalidate_preceding_siblings && !invalidate_whole_document;
+    }
+};
+
+// Invalidation sets for every class, id and attribute name that appears in a selector, built
+// alongside the rule caches in StyleComputer.
+struct StyleInvalidationData {
+    HashMap<FlyString, InvalidationSet, AK::ASCIICaseInsensitiveFlyStringTraits> class_invalidation_sets;
+    HashMap<FlyString, InvalidationSet, AK::ASCIICaseInsensitiveFlyStringTraits> id_invalidation_sets;
+    HashMap<FlyString, InvalidationSet, AK::ASCIICaseInsensitiveFlyStringTraits> attribute_invalidation_sets;
+
+    void add_selector(Selector const&);
+};
+
 }
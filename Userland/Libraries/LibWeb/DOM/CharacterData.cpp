@@ -123,7 +123,11 @@ WebIDL::ExceptionOr<void> CharacterData::replace_data(size_t offset, size_t coun
     if (auto* layout_node = this->layout_node(); layout_node && layout_node->is_text_node())
         static_cast<Layout::TextNode&>(*layout_node).invalidate_text_for_rendering();
 
-    document().set_needs_layout();
+    // NOTE: If we have a layout node, only the part of the layout tree around it has to be laid out again.
+    if (auto* layout_node = this->layout_node())
+        layout_node->set_needs_layout();
+    else
+        document().set_needs_layout();
     return {};
 }
 
@@ -8,6 +8,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/AnyOf.h>
 #include <AK/CharacterTypes.h>
 #include <AK/Debug.h>
 #include <AK/GenericLexer.h>
@@ -108,6 +109,7 @@
 #include <LibWeb/Layout/BlockFormattingContext.h>
 #include <LibWeb/Layout/TreeBuilder.h>
 #include <LibWeb/Layout/Viewport.h>
+#include <LibWeb/Loader/ResourceLoader.h>
 #include <LibWeb/Namespace.h>
 #include <LibWeb/Page/Page.h>
 #include <LibWeb/Painting/ViewportPaintable.h>
@@ -1071,7 +1073,7 @@ void Document::update_layout()
 
     update_style();
 
-    if (!m_needs_layout && m_layout_root)
+    if (!m_needs_layout && m_layout_root && !m_layout_root->needs_layout() && !m_layout_root->child_needs_layout())
         return;
 
     // NOTE: If this is a document hosting <template> contents, layout is unnecessary.
@@ -1084,39 +1086,60 @@ void Document::update_layout()
     auto* document_element = this->document_element();
     auto viewport_rect = this->viewport_rect();
 
+    bool needs_full_layout = m_needs_layout;
+
+    // NOTE: A layout of the whole document is requested when something outside of the layout tree has changed, e.g.
+    //       the size of the viewport that viewport-relative lengths are resolved against. The intrinsic sizes cached on
+    //       boxes may depend on it, so they can't be trusted anymore.
+    if (m_needs_layout && m_layout_root) {
+        m_layout_root->for_each_in_inclusive_subtree_of_type<Layout::Box>([](auto& box) {
+            box.reset_cached_intrinsic_sizes();
+            return TraversalDecision::Continue;
+        });
+    }
+
     if (!m_layout_root) {
+        needs_full_layout = true;
+
         Layout::TreeBuilder tree_builder;
         m_layout_root = verify_cast<Layout::Viewport>(*tree_builder.build(*this));
+        m_needs_relayout_boundary_update = true;
 
         if (document_element && document_element->layout_node()) {
             propagate_overflow_to_viewport(*document_element, *m_layout_root);
         }
     }
 
-    Layout::LayoutState layout_state;
+    // NOTE: If only some layout nodes need layout, we try to lay out nothing but the subtrees around them again.
+    if (needs_full_layout || !relayout_dirty_subtrees()) {
+        Layout::LayoutState layout_state;
 
-    {
-        Layout::BlockFormattingContext root_formatting_context(layout_state, *m_layout_root, nullptr);
+        {
+            Layout::BlockFormattingContext root_formatting_context(layout_state, *m_layout_root, nullptr);
 
-        auto& viewport = static_cast<Layout::Viewport&>(*m_layout_root);
-        auto& viewport_state = layout_state.get_mutable(viewport);
-        viewport_state.set_content_width(viewport_rect.width());
-        viewport_state.set_content_height(viewport_rect.height());
+            auto& viewport = static_cast<Layout::Viewport&>(*m_layout_root);
+            auto& viewport_state = layout_state.get_mutable(viewport);
+            viewport_state.set_content_width(viewport_rect.width());
+            viewport_state.set_content_height(viewport_rect.height());
 
-        if (document_element && document_element->layout_node()) {
-            auto& icb_state = layout_state.get_mutable(verify_cast<Layout::NodeWithStyleAndBoxModelMetrics>(*document_element->layout_node()));
-            icb_state.set_content_width(viewport_rect.width());
+            if (document_element && document_element->layout_node()) {
+                auto& icb_state = layout_state.get_mutable(verify_cast<Layout::NodeWithStyleAndBoxModelMetrics>(*document_element->layout_node()));
+                icb_state.set_content_width(viewport_rect.width());
+            }
+
+            root_formatting_context.run(
+                *m_layout_root,
+                Layout::LayoutMode::Normal,
+                Layout::AvailableSpace(
+                    Layout::AvailableSize::make_definite(viewport_rect.width()),
+                    Layout::AvailableSize::make_definite(viewport_rect.height())));
         }
 
-        root_formatting_context.run(
-            *m_layout_root,
-            Layout::LayoutMode::Normal,
-            Layout::AvailableSpace(
-                Layout::AvailableSize::make_definite(viewport_rect.width()),
-                Layout::AvailableSize::make_definite(viewport_rect.height())));
+        layout_state.commit(*m_layout_root);
+        did_finish_layout_pass(layout_state);
     }
 
-    layout_state.commit(*m_layout_root);
+    m_layout_root->clear_needs_layout();
 
     // Broadcast the current viewport rect to any new paintables, so they know whether they're visible or not.
     inform_all_viewport_clients_about_the_current_viewport_rect();
@@ -1138,6 +1161,106 @@ void Document::update_layout()
     m_needs_layout = false;
 }
 
+void Document::did_finish_layout_pass(Layout::LayoutState const& layout_state)
+{
+    m_intrinsic_size_cache_hit_count += layout_state.intrinsic_size_cache_hit_count;
+    m_intrinsic_size_cache_miss_count += layout_state.intrinsic_size_cache_miss_count;
+}
+
+static Optional<CSSPixels> baseline_of_atomic_inline(Layout::Box const& box)
+{
+    auto const* containing_block = box.containing_block();
+    if (!containing_block || !containing_block->paintable() || !is<Painting::PaintableWithLines>(*containing_block->paintable()))
+        return {};
+    for (auto const& fragment : static_cast<Painting::PaintableWithLines const&>(*containing_block->paintable()).fragments()) {
+        if (&fragment.layout_node() == &box)
+            return fragment.baseline();
+    }
+    return {};
+}
+
+// Lays out the subtrees below the nearest relayout boundaries of all layout nodes that need layout again,
+// keeping the layout of everything around them. Returns false if a full layout is needed instead.
+bool Document::relayout_dirty_subtrees()
+{
+    if (m_needs_relayout_boundary_update) {
+        m_layout_root->update_relayout_boundaries();
+        m_needs_relayout_boundary_update = false;
+    }
+
+    Vector<JS::NonnullGCPtr<Layout::Box>> relayout_boundaries;
+    bool needs_full_layout = false;
+
+    m_layout_root->for_each_in_inclusive_subtree([&](Layout::Node& node) {
+        if (!node.needs_layout())
+            return node.child_needs_layout() ? TraversalDecision::Continue : TraversalDecision::SkipChildrenAndContinue;
+
+        Layout::Box* relayout_boundary = nullptr;
+        for (auto* ancestor = node.parent(); ancestor; ancestor = ancestor->parent()) {
+            if (is<Layout::Box>(*ancestor) && static_cast<Layout::Box&>(*ancestor).is_relayout_boundary()) {
+                relayout_boundary = static_cast<Layout::Box*>(ancestor);
+                break;
+            }
+        }
+        if (!relayout_boundary || relayout_boundary->is_viewport()) {
+            needs_full_layout = true;
+            return TraversalDecision::Break;
+        }
+        if (!relayout_boundaries.contains_slow(JS::NonnullGCPtr { *relayout_boundary }))
+            relayout_boundaries.append(*relayout_boundary);
+
+        // NOTE: Everything below this node is laid out again along with it.
+        return TraversalDecision::SkipChildrenAndContinue;
+    });
+
+    if (needs_full_layout)
+        return false;
+
+    // NOTE: Relayout boundaries inside of another relayout boundary are laid out again along with the outer one.
+    Vector<JS::NonnullGCPtr<Layout::Box>> outermost_relayout_boundaries;
+    for (auto& relayout_boundary : relayout_boundaries) {
+        auto is_inside_other_relayout_boundary = any_of(relayout_boundaries, [&](auto& other) {
+            return other->is_ancestor_of(*relayout_boundary);
+        });
+        if (!is_inside_other_relayout_boundary)
+            outermost_relayout_boundaries.append(relayout_boundary);
+    }
+
+    Vector<NonnullOwnPtr<Layout::LayoutState>> layout_states;
+    for (auto& relayout_boundary : outermost_relayout_boundaries) {
+        auto layout_state = make<Layout::LayoutState>();
+        layout_state->populate_from_paintables(*relayout_boundary);
+
+        auto const& relayout_boundary_state = layout_state->get(*relayout_boundary);
+        Layout::BlockFormattingContext formatting_context(*layout_state, verify_cast<Layout::BlockContainer>(*relayout_boundary), nullptr);
+        formatting_context.run(
+            *relayout_boundary,
+            Layout::LayoutMode::Normal,
+            Layout::AvailableSpace(
+                Layout::AvailableSize::make_definite(relayout_boundary_state.content_width()),
+                Layout::AvailableSize::make_definite(relayout_boundary_state.content_height())));
+        formatting_context.parent_context_did_dimension_child_root_box();
+        did_finish_layout_pass(*layout_state);
+
+        // NOTE: An inline-block is aligned in its line box by its baseline, which is derived from its contents.
+        //       If the baseline has moved, the line box around it has to be laid out again as well.
+        if (relayout_boundary->display().is_inline_outside()) {
+            auto previous_baseline = baseline_of_atomic_inline(*relayout_boundary);
+            if (!previous_baseline.has_value() || formatting_context.box_baseline(*relayout_boundary) != previous_baseline.value())
+                return false;
+        }
+
+        layout_states.append(move(layout_state));
+    }
+
+    for (size_t i = 0; i < outermost_relayout_boundaries.size(); ++i)
+        layout_states[i]->commit(*outermost_relayout_boundaries[i]);
+    m_relayout_boundary_layout_count += outermost_relayout_boundaries.size();
+
+    invalidate_stacking_context_tree();
+    return true;
+}
+
 [[nodiscard]] static CSS::RequiredInvalidationAfterStyleChange update_style_recursively(Node& node, CSS::StyleComputer& style_computer)
 {
     bool const needs_full_style_update = node.document().needs_full_style_update();
@@ -1748,6 +1871,30 @@ void Document::add_script_to_execute_as_soon_as_possible(Badge<HTML::HTMLScriptE
     m_scripts_to_execute_as_soon_as_possible.append(script);
 }
 
+static constexpr size_t max_unclaimed_preloads = 64;
+
+void Document::add_preloaded_response(PreloadedResponseKey key, NonnullRefPtr<PreloadedResponse> response)
+{
+    if (m_unclaimed_preloads.size() >= max_unclaimed_preloads)
+        m_unclaimed_preloads.remove(0);
+    m_unclaimed_preloads.append({ move(key), move(response) });
+    ++m_preloaded_response_count;
+}
+
+RefPtr<PreloadedResponse> Document::take_preloaded_response(PreloadedResponseKey const& key)
+{
+    auto index = m_unclaimed_preloads.find_first_index_if([&](auto const& preload) { return preload.key == key; });
+    if (!index.has_value())
+        return nullptr;
+    ++m_claimed_preloaded_response_count;
+    return m_unclaimed_preloads.take(*index).response;
+}
+
+void Document::discard_preloaded_responses()
+{
+    m_unclaimed_preloads.clear();
+}
+
 Vector<JS::Handle<HTML::HTMLScriptElement>> Document::take_scripts_to_execute_as_soon_as_possible(Badge<HTML::HTMLParser>)
 {
     Vector<JS::Handle<HTML::HTMLScriptElement>> handles;
@@ -3131,6 +3278,8 @@ void Document::run_unloading_cleanup_steps()
     }
 
     FileAPI::run_unloading_cleanup_steps(*this);
+
+    discard_preloaded_responses();
 }
 
 // https://html.spec.whatwg.org/multipage/document-lifecycle.html#destroy-a-document
@@ -3353,6 +3502,9 @@ void Document::unload(JS::GCPtr<Document>)
 
     // FIXME: 17. Set oldDocument's has been scrolled by the user to false.
 
+    // NOTE: Speculative fetches are only for this document, and nothing will claim them anymore.
+    discard_preloaded_responses();
+
     // FIXME: 18. Run any unloading document cleanup steps for oldDocument that are defined by this specification and other applicable specifications.
 
     // 19. If oldDocument's salvageable state is false, then destroy oldDocument.
@@ -23,6 +23,7 @@
 #include <LibWeb/Cookie/Cookie.h>
 #include <LibWeb/DOM/NonElementParentNode.h>
 #include <LibWeb/DOM/ParentNode.h>
+#include <LibWeb/Fetch/Infrastructure/HTTP/Requests.h>
 #include <LibWeb/HTML/BrowsingContext.h>
 #include <LibWeb/HTML/CrossOrigin/CrossOriginOpenerPolicy.h>
 #include <LibWeb/HTML/DocumentReadyState.h>
@@ -298,6 +299,25 @@ public:
     Vector<JS::Handle<HTML::HTMLScriptElement>> take_scripts_to_execute_as_soon_as_possible(Badge<HTML::HTMLParser>);
     Vector<JS::NonnullGCPtr<HTML::HTMLScriptElement>>& scripts_to_execute_as_soon_as_possible() { return m_scripts_to_execute_as_soon_as_possible; }
 
+    HashTable<URL::URL>& list_of_speculative_fetch_urls() { return m_list_of_speculative_fetch_urls; }
+
+    // The responses to speculative fetches are only used by fetches of this document that make the same request.
+    struct PreloadedResponseKey {
+        URL::URL url;
+        ByteString method;
+        Fetch::Infrastructure::Request::CredentialsMode credentials_mode;
+        Optional<Fetch::Infrastructure::Request::Destination> destination;
+
+        bool operator==(PreloadedResponseKey const&) const = default;
+    };
+    void add_preloaded_response(PreloadedResponseKey, NonnullRefPtr<PreloadedResponse>);
+    RefPtr<PreloadedResponse> take_preloaded_response(PreloadedResponseKey const&);
+    void discard_preloaded_responses();
+
+    // Total number of speculative fetches that were made for (and claimed by fetches of) this document. Used by tests.
+    u64 preloaded_response_count() const { return m_preloaded_response_count; }
+    u64 claimed_preloaded_response_count() const { return m_claimed_preloaded_response_count; }
+
     void add_script_to_execute_in_order_as_soon_as_possible(Badge<HTML::HTMLScriptElement>, HTML::HTMLScriptElement&);
     Vector<JS::Handle<HTML::HTMLScriptElement>> take_scripts_to_execute_in_order_as_soon_as_possible(Badge<HTML::HTMLParser>);
     Vector<JS::NonnullGCPtr<HTML::HTMLScriptElement>>& scripts_to_execute_in_order_as_soon_as_possible() { return m_scripts_to_execute_in_order_as_soon_as_possible; }
@@ -474,6 +494,20 @@ public:
     bool needs_full_style_update() const { return m_needs_full_style_update; }
     void set_needs_full_style_update(bool b) { m_needs_full_style_update = b; }
 
+    // Total number of elements newly marked for a style update by Node::invalidate_style(). Used by tests.
+    u64 style_invalidation_count() const { return m_style_invalidation_count; }
+    void add_to_style_invalidation_count(u64 element_count) { m_style_invalidation_count += element_count; }
+
+    // Total number of intrinsic size lookups that were answered by (or missed) the per-box cache during layout.
+    u64 intrinsic_size_cache_hit_count() const { return m_intrinsic_size_cache_hit_count; }
+    u64 intrinsic_size_cache_miss_count() const { return m_intrinsic_size_cache_miss_count; }
+
+    // Total number of relayout boundaries whose subtree was laid out again on its own. Used by tests.
+    u64 relayout_boundary_layout_count() const { return m_relayout_boundary_layout_count; }
+
+    // Called when the computed values of a layout node change, as they decide which boxes are relayout boundaries.
+    void set_needs_relayout_boundary_update() { m_needs_relayout_boundary_update = true; }
+
     void set_needs_to_refresh_clip_state(bool b);
     void set_needs_to_refresh_scroll_state(bool b);
 
@@ -685,6 +719,8 @@ private:
     virtual JS::GCPtr<EventTarget> global_event_handlers_to_event_target(FlyString const&) final { return *this; }
 
     void tear_down_layout_tree();
+    [[nodiscard]] bool relayout_dirty_subtrees();
+    void did_finish_layout_pass(Layout::LayoutState const&);
 
     void run_unloading_cleanup_steps();
 
@@ -724,6 +760,18 @@ private:
 
     JS::GCPtr<HTML::HTMLScriptElement> m_pending_parsing_blocking_script;
 
+    // https://html.spec.whatwg.org/multipage/parsing.html#list-of-speculative-fetch-urls
+    HashTable<URL::URL> m_list_of_speculative_fetch_urls;
+
+    // Preloads that have not been claimed by a fetch yet. Bounded so that mispredicted preloads don't pile up.
+    struct UnclaimedPreload {
+        PreloadedResponseKey key;
+        NonnullRefPtr<PreloadedResponse> response;
+    };
+    Vector<UnclaimedPreload> m_unclaimed_preloads;
+    u64 m_preloaded_response_count { 0 };
+    u64 m_claimed_preloaded_response_count { 0 };
+
     Vector<JS::NonnullGCPtr<HTML::HTMLScriptElement>> m_scripts_to_execute_when_parsing_has_finished;
 
     // https://html.spec.whatwg.org/multipage/scripting.html#list-of-scripts-that-will-execute-in-order-as-soon-as-possible
@@ -923,6 +971,13 @@ private:
 
     u64 m_dom_tree_version { 0 };
 
+    u64 m_style_invalidation_count { 0 };
+    u64 m_intrinsic_size_cache_hit_count { 0 };
+    u64 m_intrinsic_size_cache_miss_count { 0 };
+    u64 m_relayout_boundary_layout_count { 0 };
+
+    bool m_needs_relayout_boundary_update { true };
+
     // https://drafts.csswg.org/css-position-4/#document-top-layer
     // Documents have a top layer, an ordered set containing elements from the document.
     // Elements in the top layer do not lay out normally based on their position in the document;
@@ -160,11 +160,19 @@ static WebIDL::ExceptionOr<JS::NonnullGCPtr<DOM::Document>> load_html_document(H
     //    document's relevant global object to have the parser to process the implied EOF character, which eventually
     //    causes a load event to be fired.
     else {
-        // FIXME: Parse as we receive the document data, instead of waiting for the whole document to be fetched first.
-        auto process_body = JS::create_heap_function(document->heap(), [document, url = navigation_params.response->url().value()](ByteBuffer data) {
-            Platform::EventLoopPlugin::the().deferred_invoke([document = document, data = move(data), url = url] {
-                auto parser = HTML::HTMLParser::create_with_uncertain_encoding(document, data);
-                parser->run(url);
+        auto parser = HTML::HTMLParser::create_for_streaming(document, navigation_params.response->url().value());
+
+        // NOTE: The parser is run from a deferred invocation so that it doesn't run (and execute scripts) within the
+        //       execution context of the fetch task.
+        auto process_body_chunk = JS::create_heap_function(document->heap(), [parser](ByteBuffer data) {
+            Platform::EventLoopPlugin::the().deferred_invoke([parser = JS::make_handle(parser), data = move(data)] {
+                parser->append_to_input_byte_stream(data);
+            });
+        });
+
+        auto process_end_of_body = JS::create_heap_function(document->heap(), [parser] {
+            Platform::EventLoopPlugin::the().deferred_invoke([parser = JS::make_handle(parser)] {
+                parser->close_input_byte_stream();
             });
         });
 
@@ -173,7 +181,7 @@ static WebIDL::ExceptionOr<JS::NonnullGCPtr<DOM::Document>> load_html_document(H
         });
 
         auto& realm = document->realm();
-        navigation_params.response->body()->fully_read(realm, process_body, process_body_error, JS::NonnullGCPtr { realm.global_object() });
+        navigation_params.response->body()->incrementally_read(process_body_chunk, process_end_of_body, process_body_error, JS::NonnullGCPtr { realm.global_object() });
     }
 
     // 4. Return document.
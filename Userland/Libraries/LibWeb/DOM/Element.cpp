@@ -446,7 +446,7 @@ void Element::run_attribute_change_steps(FlyString const& local_name, Optional<S
 
     // AD-HOC: Run our own internal attribute change handler.
     attribute_changed(local_name, value);
-    invalidate_style_after_attribute_change(local_name);
+    invalidate_style_after_attribute_change(local_name, old_value, value);
 
     document().bump_dom_tree_version();
 }
@@ -558,6 +558,13 @@ CSS::RequiredInvalidationAfterStyleChange Element::recompute_style()
         layout_node()->apply_style(*m_computed_css_values);
         if (invalidation.repaint && paintable())
             paintable()->set_needs_display();
+
+        // NOTE: Instead of laying out the whole document again, mark our layout node as needing layout.
+        //       This allows Document::update_layout() to only lay out the part of the layout tree around it.
+        if (invalidation.relayout) {
+            layout_node()->set_needs_layout();
+            invalidation.relayout = false;
+        }
     }
 
     return invalidation;
@@ -1783,13 +1790,124 @@ ErrorOr<void> Element::scroll_into_view(Optional<Variant<bool, ScrollIntoViewOpt
     // FIXME: 8. Optionally perform some other action that brings the element to the user’s attention.
 }
 
-void Element::invalidate_style_after_attribute_change(FlyString const& attribute_name)
+void Element::invalidate_style_after_attribute_change(FlyString const& attribute_name, Optional<String> const& old_value, Optional<String> const& new_value)
 {
-    // FIXME: Only invalidate if the attribute can actually affect style.
-    (void)attribute_name;
+    // NOTE: Disconnected elements get their style computed once they are inserted, and a pending full style update
+    //       will visit every element anyway.
+    if (!is_connected() || document().needs_full_style_update())
+        return;
 
-    // FIXME: This will need to become smarter when we implement the :has() selector.
-    invalidate_style();
+    auto const& invalidation_data = document().style_computer().style_invalidation_data();
+
+    auto invalidate_for_class = [&](FlyString const& class_name) {
+        if (auto invalidation_set = invalidation_data.class_invalidation_sets.get(class_name); invalidation_set.has_value())
+            invalidate_style_for_invalidation_set(*invalidation_set);
+    };
+    auto invalidate_for_id = [&](FlyString const& id) {
+        if (auto invalidation_set = invalidation_data.id_invalidation_sets.get(id); invalidation_set.has_value())
+            invalidate_style_for_invalidation_set(*invalidation_set);
+    };
+
+    if (attribute_name == HTML::AttributeNames::class_) {
+        // NOTE: m_classes has already been updated, so compare it against the old attribute value.
+        //       Only classes that were added or removed can change which selectors match.
+        Vector<FlyString> old_classes;
+        if (old_value.has_value()) {
+            for (auto old_class : old_value->bytes_as_string_view().split_view_if(Infra::is_ascii_whitespace))
+                old_classes.append(MUST(FlyString::from_utf8(old_class)));
+        }
+        for (auto const& old_class : old_classes) {
+            if (!m_classes.contains_slow(old_class))
+                invalidate_for_class(old_class);
+        }
+        for (auto const& new_class : m_classes) {
+            if (!old_classes.contains_slow(new_class))
+                invalidate_for_class(new_class);
+        }
+    } else if (attribute_name == HTML::AttributeNames::id) {
+        if (old_value != new_value) {
+            if (old_value.has_value())
+                invalidate_for_id(FlyString { *old_value });
+            if (new_value.has_value())
+                invalidate_for_id(FlyString { *new_value });
+        }
+    } else {
+        // NOTE: Any other attribute may affect this element's own style through presentational hints, the style
+        //       attribute, or pseudo-classes such as :checked and :disabled.
+        invalidate_style();
+    }
+
+    if (auto invalidation_set = invalidation_data.attribute_invalidation_sets.get(attribute_name); invalidation_set.has_value())
+        invalidate_style_for_invalidation_set(*invalidation_set);
+}
+
+static bool element_has_invalidation_set_descendant_feature(Element const& element, CSS::InvalidationSet const& invalidation_set)
+{
+    if (element.id().has_value() && invalidation_set.descendant_ids.contains(*element.id()))
+        return true;
+    if (invalidation_set.descendant_tag_names.contains(element.local_name()))
+        return true;
+    for (auto const& class_name : element.class_names()) {
+        if (invalidation_set.descendant_classes.contains(class_name))
+            return true;
+    }
+    if (!invalidation_set.descendant_attribute_names.is_empty()) {
+        for (size_t i = 0; i < element.attribute_list_size(); ++i) {
+            if (invalidation_set.descendant_attribute_names.contains(element.attributes()->item(i)->local_name()))
+                return true;
+        }
+    }
+    return false;
+}
+
+static void invalidate_style_of_descendants_matching(Node& root, CSS::InvalidationSet const& invalidation_set)
+{
+    root.for_each_in_subtree([&](Node& node) {
+        if (!node.is_element())
+            return TraversalDecision::Continue;
+        auto& element = static_cast<Element&>(node);
+        if (element_has_invalidation_set_descendant_feature(element, invalidation_set)) {
+            // NOTE: This invalidates the element's whole subtree, including its shadow tree.
+            element.invalidate_style();
+            return TraversalDecision::SkipChildrenAndContinue;
+        }
+        if (auto* shadow_root = element.shadow_root_internal())
+            invalidate_style_of_descendants_matching(*shadow_root, invalidation_set);
+        return TraversalDecision::Continue;
+    });
+}
+
+void Element::invalidate_style_for_invalidation_set(CSS::InvalidationSet const& invalidation_set)
+{
+    if (invalidation_set.invalidate_whole_document) {
+        document().invalidate_style();
+        return;
+    }
+
+    // NOTE: Invalidating an element also invalidates its subtree, since descendants may inherit from it.
+    if (invalidation_set.invalidate_self) {
+        invalidate_style();
+    } else if (invalidation_set.invalidate_all_descendants) {
+        if (auto* shadow_root = shadow_root_internal())
+            shadow_root->invalidate_style();
+        for_each_child([](Node& child) {
+            child.invalidate_style();
+            return IterationDecision::Continue;
+        });
+    } else if (!invalidation_set.descendant_classes.is_empty() || !invalidation_set.descendant_ids.is_empty() || !invalidation_set.descendant_tag_names.is_empty() || !invalidation_set.descendant_attribute_names.is_empty()) {
+        if (auto* shadow_root = shadow_root_internal())
+            invalidate_style_of_descendants_matching(*shadow_root, invalidation_set);
+        invalidate_style_of_descendants_matching(*this, invalidation_set);
+    }
+
+    if (invalidation_set.invalidate_following_siblings) {
+        for (auto* sibling = next_element_sibling(); sibling; sibling = sibling->next_element_sibling())
+            sibling->invalidate_style();
+    }
+    if (invalidation_set.invalidate_preceding_siblings) {
+        for (auto* sibling = previous_element_sibling(); sibling; sibling = sibling->previous_element_sibling())
+            sibling->invalidate_style();
+    }
 }
 
 // https://www.w3.org/TR/wai-aria-1.2/#tree_exclusion
@@ -271,7 +271,10 @@ void Node::invalidate_style()
         return;
     }
 
+    u64 invalidated_element_count = 0;
     for_each_in_inclusive_subtree([&](Node& node) {
+        if (node.is_element() && !node.m_needs_style_update)
+            ++invalidated_element_count;
         node.m_needs_style_update = true;
         if (node.has_children())
             node.m_child_needs_style_update = true;
@@ -285,6 +288,7 @@ void Node::invalidate_style()
     });
     for (auto* ancestor = parent_or_shadow_host(); ancestor; ancestor = ancestor->parent_or_shadow_host())
         ancestor->m_child_needs_style_update = true;
+    document().add_to_style_invalidation_count(invalidated_element_count);
     document().schedule_style_update();
 }
 
@@ -40,10 +40,16 @@ void FetchedDataReceiver::set_pending_promise(JS::NonnullGCPtr<WebIDL::Promise>
     auto had_pending_promise = m_pending_promise != nullptr;
     m_pending_promise = promise;
 
-    if (!had_pending_promise && !m_buffer.is_empty()) {
+    if (had_pending_promise)
+        return;
+
+    if (!m_buffer.is_empty()) {
         on_data_received(m_buffer);
         m_buffer.clear();
     }
+
+    if (m_has_received_all_data)
+        close_stream_after_received_data();
 }
 
 // This implements the parallel steps of the pullAlgorithm in HTTP-network-fetch.
@@ -87,4 +93,33 @@ void FetchedDataReceiver::on_data_received(ReadonlyBytes bytes)
         }));
 }
 
+// This implements the step of HTTP-network-fetch that runs once the bytes transmission for the response's message body
+// is done normally.
+void FetchedDataReceiver::on_complete()
+{
+    m_has_received_all_data = true;
+
+    // NOTE: Until the stream has been pulled from, the received data is held in our buffer. It is handed to the stream
+    //       once that happens, so the stream must not be closed before then.
+    if (m_pending_promise)
+        close_stream_after_received_data();
+}
+
+void FetchedDataReceiver::close_stream_after_received_data()
+{
+    // NOTE: The data received so far may still be waiting in fetch tasks to be pulled into the stream. Closing the stream
+    //       from a fetch task as well makes sure that it only happens after all of them have run.
+    Infrastructure::queue_fetch_task(
+        m_fetch_params->controller(),
+        m_fetch_params->task_destination().get<JS::NonnullGCPtr<JS::Object>>(),
+        JS::create_heap_function(heap(), [this]() {
+            HTML::TemporaryExecutionContext execution_context { Bindings::host_defined_environment_settings_object(m_stream->realm()), HTML::TemporaryExecutionContext::CallbacksEnabled::Yes };
+
+            // If the bytes transmission for response’s message body is done normally and stream is readable, then close
+            // stream, and abort these in-parallel steps.
+            if (m_stream->is_readable())
+                m_stream->close();
+        }));
+}
+
 }
@@ -22,16 +22,20 @@ public:
 
     void set_pending_promise(JS::NonnullGCPtr<WebIDL::Promise>);
     void on_data_received(ReadonlyBytes);
+    void on_complete();
 
 private:
     FetchedDataReceiver(JS::NonnullGCPtr<Infrastructure::FetchParams const>, JS::NonnullGCPtr<Streams::ReadableStream>);
 
     virtual void visit_edges(Visitor& visitor) override;
 
+    void close_stream_after_received_data();
+
     JS::NonnullGCPtr<Infrastructure::FetchParams const> m_fetch_params;
     JS::NonnullGCPtr<Streams::ReadableStream> m_stream;
     JS::GCPtr<WebIDL::Promise> m_pending_promise;
     ByteBuffer m_buffer;
+    bool m_has_received_all_data { false };
 };
 
 }
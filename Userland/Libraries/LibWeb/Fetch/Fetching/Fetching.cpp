@@ -1936,7 +1936,7 @@ WebIDL::ExceptionOr<JS::NonnullGCPtr<PendingResponse>> nonstandard_resource_load
     // FIXME: This check should be removed and all HTTP requests should go through the `ResourceLoader::load_unbuffered`
     //        path. The buffer option should then be supplied to the steps below that allow us to buffer data up to a
     //        user-agent-defined limit (or not). However, we will need to fully use stream operations throughout the
-    //        fetch process to enable this (e.g. Body::fully_read must use streams for this to work).
+    //        fetch process to enable this (e.g. for request bodies, and for the preloaded responses below).
     if (request->buffer_policy() == Infrastructure::Request::BufferPolicy::DoNotBufferResponse) {
         HTML::TemporaryExecutionContext execution_context { Bindings::host_defined_environment_settings_object(realm), HTML::TemporaryExecutionContext::CallbacksEnabled::Yes };
 
@@ -2019,14 +2019,14 @@ WebIDL::ExceptionOr<JS::NonnullGCPtr<PendingResponse>> nonstandard_resource_load
             }
         };
 
-        auto on_complete = [&vm, &realm, pending_response, stream](auto success, auto error_message) {
+        auto on_complete = [&vm, &realm, pending_response, stream, fetched_data_receiver](auto success, auto error_message) {
             HTML::TemporaryExecutionContext execution_context { Bindings::host_defined_environment_settings_object(realm), HTML::TemporaryExecutionContext::CallbacksEnabled::Yes };
 
             // 16.1.1.2. Otherwise, if the bytes transmission for response’s message body is done normally and stream is readable,
             //           then close stream, and abort these in-parallel steps.
+            // NOTE: FetchedDataReceiver closes the stream once it has pulled all of the received data into it.
             if (success) {
-                if (stream->is_readable())
-                    stream->close();
+                fetched_data_receiver->on_complete();
             }
             // 16.1.2.2. Otherwise, if stream is readable, error stream with a TypeError.
             else {
@@ -2080,7 +2080,17 @@ WebIDL::ExceptionOr<JS::NonnullGCPtr<PendingResponse>> nonstandard_resource_load
             pending_response->resolve(response);
         };
 
-        ResourceLoader::the().load(load_request, move(on_load_success), move(on_load_error));
+        // NOTE: If the document that made this request has speculatively fetched the same resource, use that response.
+        RefPtr<PreloadedResponse> preloaded_response;
+        if (auto client = request->client(); client && is<HTML::Window>(client->global_object()) && load_request.body().is_empty()) {
+            auto& document = verify_cast<HTML::Window>(client->global_object()).associated_document();
+            preloaded_response = document.take_preloaded_response({ load_request.url(), load_request.method(), request->credentials_mode(), request->destination() });
+        }
+
+        if (preloaded_response)
+            ResourceLoader::the().load_preloaded(load_request, preloaded_response.release_nonnull(), move(on_load_success), move(on_load_error));
+        else
+            ResourceLoader::the().load(load_request, move(on_load_success), move(on_load_error));
     }
 
     return pending_response;
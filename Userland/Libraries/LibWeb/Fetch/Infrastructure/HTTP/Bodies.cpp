@@ -5,6 +5,7 @@
  */
 
 #include <LibJS/Runtime/PromiseCapability.h>
+#include <LibWeb/Bindings/ExceptionOrUtils.h>
 #include <LibWeb/Bindings/MainThreadVM.h>
 #include <LibWeb/Fetch/BodyInit.h>
 #include <LibWeb/Fetch/Infrastructure/HTTP/Bodies.h>
@@ -12,6 +13,7 @@
 #include <LibWeb/Fetch/Infrastructure/Task.h>
 #include <LibWeb/HTML/Scripting/TemporaryExecutionContext.h>
 #include <LibWeb/Streams/AbstractOperations.h>
+#include <LibWeb/Streams/ReadableStreamDefaultReader.h>
 #include <LibWeb/WebIDL/Promise.h>
 
 namespace Web::Fetch::Infrastructure {
@@ -81,15 +83,13 @@ void Body::fully_read(JS::Realm& realm, Web::Fetch::Infrastructure::Body::Proces
     };
 
     // 3. Let errorSteps optionally given an exception exception be to queue a fetch task to run processBodyError given exception, with taskDestination.
-    auto error_steps = [&realm, process_body_error, task_destination_object](JS::GCPtr<WebIDL::DOMException> exception) {
+    auto error_steps = [&realm, process_body_error, task_destination_object](JS::Value exception) {
         queue_fetch_task(*task_destination_object, JS::create_heap_function(realm.heap(), [process_body_error, exception]() {
             process_body_error->function()(exception);
         }));
     };
 
-    // 4. Let reader be the result of getting a reader for body’s stream. If that threw an exception, then run errorSteps with that exception and return.
-    // 5. Read all bytes from reader, given successSteps and errorSteps.
-    // FIXME: Use streams for these steps.
+    // FIXME: Bodies with a source are read from that directly, instead of from their stream.
     m_source.visit(
         [&](ByteBuffer const& byte_buffer) {
             if (auto result = success_steps(byte_buffer); result.is_error())
@@ -100,7 +100,22 @@ void Body::fully_read(JS::Realm& realm, Web::Fetch::Infrastructure::Body::Proces
                 error_steps(WebIDL::UnknownError::create(realm, "Out-of-memory"_fly_string));
         },
         [&](Empty) {
-            error_steps(WebIDL::DOMException::create(realm, "DOMException"_fly_string, "Reading from Blob, FormData or null source is not yet implemented"_fly_string));
+            HTML::TemporaryExecutionContext const execution_context { Bindings::host_defined_environment_settings_object(m_stream->realm()), HTML::TemporaryExecutionContext::CallbacksEnabled::Yes };
+
+            // 4. Let reader be the result of getting a reader for body’s stream. If that threw an exception, then run errorSteps with that exception and return.
+            auto reader = Streams::acquire_readable_stream_default_reader(m_stream);
+            if (reader.is_exception()) {
+                auto throw_completion = Bindings::dom_exception_to_throw_completion(realm.vm(), reader.release_error());
+                error_steps(throw_completion.value().value());
+                return;
+            }
+
+            // 5. Read all bytes from reader, given successSteps and errorSteps.
+            auto on_bytes_read = [&realm, success_steps = move(success_steps), error_steps](ByteBuffer bytes) {
+                if (auto result = success_steps(bytes); result.is_error())
+                    error_steps(WebIDL::UnknownError::create(realm, "Out-of-memory"_fly_string));
+            };
+            reader.value()->read_all_bytes(move(on_bytes_read), move(error_steps));
         });
 }
 
@@ -16,6 +16,7 @@ class LoadRequest;
 class Page;
 class PageClient;
 class PaintContext;
+class PreloadedResponse;
 class Resource;
 class ResourceLoader;
 enum class TraversalDecision;
@@ -146,6 +147,7 @@ class InheritStyleValue;
 class InitialStyleValue;
 class IntegerOrCalculated;
 class IntegerStyleValue;
+struct InvalidationSet;
 class Length;
 class LengthBox;
 class LengthOrCalculated;
@@ -457,6 +459,7 @@ class PluginArray;
 class PromiseRejectionEvent;
 class SelectedFile;
 class SharedImageRequest;
+class SpeculativeHTMLParser;
 class Storage;
 class SubmitEvent;
 class TextMetrics;
@@ -11,15 +11,94 @@
 
 namespace Web::HTML {
 
+// Holds the frames of the image. If they weren't all decoded up front, the missing ones are requested from the frame
+// source a few frames before the animation gets to them, and frames it has moved past are dropped again. The first
+// frame is always kept, as it determines the intrinsic size of the image.
+class AnimatedBitmapDecodedImageData::Frames : public RefCounted<Frames> {
+public:
+    static constexpr size_t frames_to_decode_ahead = 3;
+
+    Frames(Vector<Frame>&& frames, size_t frame_count, RefPtr<Platform::FrameSource> source)
+        : m_source(move(source))
+    {
+        m_slots.resize(max(frames.size(), frame_count));
+        for (size_t i = 0; i < frames.size(); ++i)
+            m_slots[i] = { frames[i].bitmap, frames[i].duration, false };
+    }
+
+    size_t count() const { return m_slots.size(); }
+    Gfx::ImmutableBitmap const& first_bitmap() const { return *m_slots.first().bitmap; }
+
+    RefPtr<Gfx::ImmutableBitmap> bitmap(size_t index)
+    {
+        if (!m_source)
+            return m_slots[index].bitmap;
+
+        m_current_index = index;
+        for (size_t i = 1; i < count(); ++i) {
+            if (!is_near_current_index(i))
+                m_slots[i].bitmap = nullptr;
+        }
+        for (size_t i = 0; i <= frames_to_decode_ahead; ++i)
+            request((index + i) % count());
+
+        // If the frame isn't ready yet, keep showing the last frame that was.
+        if (m_slots[index].bitmap)
+            m_last_shown_bitmap = m_slots[index].bitmap;
+        if (!m_last_shown_bitmap)
+            m_last_shown_bitmap = m_slots.first().bitmap;
+        return m_last_shown_bitmap;
+    }
+
+    int duration(size_t index) const
+    {
+        // Until a frame has been decoded, assume it is shown as long as the first one.
+        return m_slots[index].duration.value_or(m_slots.first().duration.value_or(0));
+    }
+
+private:
+    struct Slot {
+        RefPtr<Gfx::ImmutableBitmap> bitmap;
+        Optional<int> duration;
+        bool is_pending { false };
+    };
+
+    bool is_near_current_index(size_t index) const
+    {
+        return (index + count() - m_current_index) % count() <= frames_to_decode_ahead;
+    }
+
+    void request(size_t index)
+    {
+        auto& slot = m_slots[index];
+        if (slot.bitmap || slot.is_pending)
+            return;
+        slot.is_pending = true;
+        m_source->request_frame(index, [self = NonnullRefPtr(*this), index](Platform::Frame& frame) {
+            auto& slot = self->m_slots[index];
+            slot.is_pending = false;
+            slot.duration = static_cast<int>(frame.duration);
+            // The animation may have moved on while the frame was being decoded.
+            if (index == 0 || self->is_near_current_index(index))
+                slot.bitmap = Gfx::ImmutableBitmap::create(*frame.bitmap);
+        });
+    }
+
+    Vector<Slot> m_slots;
+    RefPtr<Platform::FrameSource> m_source;
+    size_t m_current_index { 0 };
+    RefPtr<Gfx::ImmutableBitmap> m_last_shown_bitmap;
+};
+
 JS_DEFINE_ALLOCATOR(AnimatedBitmapDecodedImageData);
 
-ErrorOr<JS::NonnullGCPtr<AnimatedBitmapDecodedImageData>> AnimatedBitmapDecodedImageData::create(JS::Realm& realm, Vector<Frame>&& frames, size_t loop_count, bool animated)
+ErrorOr<JS::NonnullGCPtr<AnimatedBitmapDecodedImageData>> AnimatedBitmapDecodedImageData::create(JS::Realm& realm, Vector<Frame>&& frames, size_t loop_count, bool animated, size_t frame_count, RefPtr<Platform::FrameSource> frame_source)
 {
-    return realm.heap().allocate<AnimatedBitmapDecodedImageData>(realm, move(frames), loop_count, animated);
+    return realm.heap().allocate<AnimatedBitmapDecodedImageData>(realm, move(frames), loop_count, animated, frame_count, move(frame_source));
 }
 
-AnimatedBitmapDecodedImageData::AnimatedBitmapDecodedImageData(Vector<Frame>&& frames, size_t loop_count, bool animated)
-    : m_frames(move(frames))
+AnimatedBitmapDecodedImageData::AnimatedBitmapDecodedImageData(Vector<Frame>&& frames, size_t loop_count, bool animated, size_t frame_count, RefPtr<Platform::FrameSource> frame_source)
+    : m_frames(adopt_ref(*new Frames(move(frames), frame_count, move(frame_source))))
     , m_loop_count(loop_count)
     , m_animated(animated)
 {
@@ -29,31 +108,36 @@ AnimatedBitmapDecodedImageData::~AnimatedBitmapDecodedImageData() = default;
 
 RefPtr<Gfx::ImmutableBitmap> AnimatedBitmapDecodedImageData::bitmap(size_t frame_index, Gfx::IntSize) const
 {
-    if (frame_index >= m_frames.size())
+    if (frame_index >= m_frames->count())
         return nullptr;
-    return m_frames[frame_index].bitmap;
+    return m_frames->bitmap(frame_index);
 }
 
 int AnimatedBitmapDecodedImageData::frame_duration(size_t frame_index) const
 {
-    if (frame_index >= m_frames.size())
+    if (frame_index >= m_frames->count())
         return 0;
-    return m_frames[frame_index].duration;
+    return m_frames->duration(frame_index);
+}
+
+size_t AnimatedBitmapDecodedImageData::frame_count() const
+{
+    return m_frames->count();
 }
 
 Optional<CSSPixels> AnimatedBitmapDecodedImageData::intrinsic_width() const
 {
-    return m_frames.first().bitmap->width();
+    return m_frames->first_bitmap().width();
 }
 
 Optional<CSSPixels> AnimatedBitmapDecodedImageData::intrinsic_height() const
 {
-    return m_frames.first().bitmap->height();
+    return m_frames->first_bitmap().height();
 }
 
 Optional<CSSPixelFraction> AnimatedBitmapDecodedImageData::intrinsic_aspect_ratio() const
 {
-    return CSSPixels(m_frames.first().bitmap->width()) / CSSPixels(m_frames.first().bitmap->height());
+    return CSSPixels(m_frames->first_bitmap().width()) / CSSPixels(m_frames->first_bitmap().height());
 }
 
 }
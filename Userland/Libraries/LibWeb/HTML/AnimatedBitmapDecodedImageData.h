@@ -8,6 +8,7 @@
 
 #include <LibGfx/ImmutableBitmap.h>
 #include <LibWeb/HTML/DecodedImageData.h>
+#include <LibWeb/Platform/ImageCodecPlugin.h>
 
 namespace Web::HTML {
 
@@ -21,13 +22,14 @@ public:
         int duration { 0 };
     };
 
-    static ErrorOr<JS::NonnullGCPtr<AnimatedBitmapDecodedImageData>> create(JS::Realm&, Vector<Frame>&&, size_t loop_count, bool animated);
+    // If fewer than frame_count frames are given, the others are requested from the frame source as they are needed.
+    static ErrorOr<JS::NonnullGCPtr<AnimatedBitmapDecodedImageData>> create(JS::Realm&, Vector<Frame>&&, size_t loop_count, bool animated, size_t frame_count = 0, RefPtr<Platform::FrameSource> = {});
     virtual ~AnimatedBitmapDecodedImageData() override;
 
     virtual RefPtr<Gfx::ImmutableBitmap> bitmap(size_t frame_index, Gfx::IntSize = {}) const override;
     virtual int frame_duration(size_t frame_index) const override;
 
-    virtual size_t frame_count() const override { return m_frames.size(); }
+    virtual size_t frame_count() const override;
     virtual size_t loop_count() const override { return m_loop_count; }
     virtual bool is_animated() const override { return m_animated; }
 
@@ -36,9 +38,10 @@ public:
     virtual Optional<CSSPixelFraction> intrinsic_aspect_ratio() const override;
 
 private:
-    AnimatedBitmapDecodedImageData(Vector<Frame>&&, size_t loop_count, bool animated);
+    AnimatedBitmapDecodedImageData(Vector<Frame>&&, size_t loop_count, bool animated, size_t frame_count, RefPtr<Platform::FrameSource>);
 
-    Vector<Frame> m_frames;
+    class Frames;
+    NonnullRefPtr<Frames> m_frames;
     size_t m_loop_count { 0 };
     bool m_animated { false };
 };
@@ -716,6 +716,10 @@ static WebIDL::ExceptionOr<Variant<Empty, JS::NonnullGCPtr<NavigationParams>, JS
     request->set_mode(Fetch::Infrastructure::Request::Mode::Navigate);
     request->set_referrer(entry->document_state()->request_referrer());
 
+    // AD-HOC: We must not buffer the response, so that the document can be loaded (and e.g. parsed) as its body is
+    //         received, rather than only once all of it has arrived.
+    request->set_buffer_policy(Fetch::Infrastructure::Request::BufferPolicy::DoNotBufferResponse);
+
     // 4. If documentResource is a POST resource, then:
     if (document_resource.has<POSTResource>()) {
         // 1. Set request's method to `POST`.
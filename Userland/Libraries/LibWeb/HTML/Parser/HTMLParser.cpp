@@ -6,8 +6,10 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/AllOf.h>
 #include <AK/Debug.h>
 #include <AK/SourceLocation.h>
+#include <AK/TemporaryChange.h>
 #include <AK/Utf32View.h>
 #include <LibTextCodec/Decoder.h>
 #include <LibWeb/Bindings/MainThreadVM.h>
@@ -33,6 +35,7 @@
 #include <LibWeb/HTML/Parser/HTMLEncodingDetection.h>
 #include <LibWeb/HTML/Parser/HTMLParser.h>
 #include <LibWeb/HTML/Parser/HTMLToken.h>
+#include <LibWeb/HTML/Parser/SpeculativeHTMLParser.h>
 #include <LibWeb/HTML/Window.h>
 #include <LibWeb/HighResolutionTime/TimeOrigin.h>
 #include <LibWeb/Infra/CharacterTypes.h>
@@ -167,6 +170,9 @@ void HTMLParser::visit_edges(Cell::Visitor& visitor)
 
     m_stack_of_open_elements.visit_edges(visitor);
     m_list_of_active_formatting_elements.visit_edges(visitor);
+
+    if (m_speculative_html_parser)
+        m_speculative_html_parser->visit_edges(visitor);
 }
 
 void HTMLParser::run(HTMLTokenizer::StopAtInsertionPoint stop_at_insertion_point)
@@ -176,11 +182,28 @@ void HTMLParser::run(HTMLTokenizer::StopAtInsertionPoint stop_at_insertion_point
         if (!m_tokenizer.is_eof_inserted() && m_tokenizer.is_insertion_point_reached())
             return;
 
+        // Most of the text in a typical document is a run of character tokens in the "in body" insertion mode, which
+        // are all handled the same way. Consume such runs from the tokenizer in one go.
+        if (!m_skip_next_newline
+            && m_insertion_mode == InsertionMode::InBody
+            && !m_stack_of_open_elements.is_empty()
+            && adjusted_current_node().namespace_uri() == Namespace::HTML) {
+            if (auto text = m_tokenizer.consume_text_run(stop_at_insertion_point); !text.is_empty()) {
+                process_text_run_in_body(text);
+                continue;
+            }
+        }
+
         auto optional_token = m_tokenizer.next_token(stop_at_insertion_point);
         if (!optional_token.has_value())
             break;
         auto& token = optional_token.value();
 
+        // NOTE: The start tags of pre, listing and textarea elements ask for an immediately following newline to be
+        //       ignored. That token may only arrive with the next chunk of input, so this can't look ahead.
+        if (exchange(m_skip_next_newline, false) && token.is_character() && token.code_point() == '\n')
+            continue;
+
         dbgln_if(HTML_PARSER_DEBUG, "[{}] {}", insertion_mode_name(), token.to_string());
 
         // https://html.spec.whatwg.org/multipage/parsing.html#tree-construction-dispatcher
@@ -292,6 +315,10 @@ void HTMLParser::the_end(JS::NonnullGCPtr<DOM::Document> document, JS::GCPtr<HTM
 
     // 6. Queue a global task on the DOM manipulation task source given the Document's relevant global object to run the following substeps:
     queue_global_task(HTML::Task::Source::DOMManipulation, *document, JS::create_heap_function(document->heap(), [document = document] {
+        // NOTE: All elements created by the parser have started their fetches by now, so nothing will claim the
+        //       responses to speculative fetches that are left.
+        document->discard_preloaded_responses();
+
         // 1. Set the Document's load timing info's DOM content loaded event start time to the current high resolution time given the Document's relevant global object.
         document->load_timing_info().dom_content_loaded_event_start_time = HighResolutionTime::current_high_resolution_time(relevant_global_object(*document));
 
@@ -1065,6 +1092,32 @@ void HTMLParser::insert_character(u32 data)
     m_character_insertion_builder.append(Utf32View { &data, 1 });
 }
 
+void HTMLParser::insert_characters(StringView data)
+{
+    auto node = find_character_insertion_node();
+    if (node != m_character_insertion_node.ptr()) {
+        flush_character_insertions();
+        m_character_insertion_node = JS::make_handle(node);
+    }
+    m_character_insertion_builder.append(data);
+}
+
+// Equivalent to processing each code point of the text as a character token in the "in body" insertion mode. The text
+// never contains U+0000 NULL or U+000D CR, see HTMLTokenizer::consume_text_run().
+void HTMLParser::process_text_run_in_body(StringView text)
+{
+    // Reconstruct the active formatting elements, if any.
+    // NOTE: Once this has been done for the first character, it doesn't do anything for the rest of them.
+    reconstruct_the_active_formatting_elements();
+
+    // Insert the token's character.
+    insert_characters(text);
+
+    // If any of the characters isn't parser whitespace, set the frameset-ok flag to "not ok".
+    if (!all_of(text.bytes(), [](u8 byte) { return byte == '\t' || byte == '\n' || byte == '\f' || byte == ' '; }))
+        m_frameset_ok = false;
+}
+
 void HTMLParser::handle_after_head(HTMLToken& token)
 {
     if (token.is_character() && token.is_parser_whitespace()) {
@@ -1803,12 +1856,7 @@ void HTMLParser::handle_in_body(HTMLToken& token)
         // If the next token is a U+000A LINE FEED (LF) character token,
         // then ignore that token and move on to the next one.
         // (Newlines at the start of pre blocks are ignored as an authoring convenience.)
-        auto next_token = m_tokenizer.next_token();
-        if (next_token.has_value() && next_token.value().is_character() && next_token.value().code_point() == '\n') {
-            // Ignore it.
-        } else {
-            process_using_the_rules_for(m_insertion_mode, next_token.value());
-        }
+        m_skip_next_newline = true;
 
         // Set the frameset-ok flag to "not ok".
         m_frameset_ok = false;
@@ -2343,16 +2391,12 @@ void HTMLParser::handle_in_body(HTMLToken& token)
         // 1. Insert an HTML element for the token.
         (void)insert_html_element(token);
 
-        // FIXME: 2. If the next token is a U+000A LINE FEED (LF) character token, then ignore that token and move on to the next one. (Newlines at the start of textarea elements are ignored as an authoring convenience.)
+        // 2. If the next token is a U+000A LINE FEED (LF) character token, then ignore that token and move on to the next one. (Newlines at the start of textarea elements are ignored as an authoring convenience.)
+        m_skip_next_newline = true;
 
         // 3. Switch the tokenizer to the RCDATA state.
         m_tokenizer.switch_to({}, HTMLTokenizer::State::RCDATA);
 
-        // If the next token is a U+000A LINE FEED (LF) character token,
-        // then ignore that token and move on to the next one.
-        // (Newlines at the start of pre blocks are ignored as an authoring convenience.)
-        auto next_token = m_tokenizer.next_token();
-
         // 4. Let the original insertion mode be the current insertion mode.
         m_original_insertion_mode = m_insertion_mode;
 
@@ -2361,13 +2405,6 @@ void HTMLParser::handle_in_body(HTMLToken& token)
 
         // 6. Switch the insertion mode to "text".
         m_insertion_mode = InsertionMode::Text;
-
-        // FIXME: This step is not in the spec.
-        if (next_token.has_value() && next_token.value().is_character() && next_token.value().code_point() == '\n') {
-            // Ignore it.
-        } else {
-            process_using_the_rules_for(m_insertion_mode, next_token.value());
-        }
         return;
     }
 
@@ -2826,7 +2863,8 @@ void HTMLParser::handle_text(HTMLToken& token)
                     // 2. Set the pending parsing-blocking script to null.
                     auto the_script = document().take_pending_parsing_blocking_script({});
 
-                    // FIXME: 3. Start the speculative HTML parser for this instance of the HTML parser.
+                    // 3. Start the speculative HTML parser for this instance of the HTML parser.
+                    m_speculative_html_parser = make<SpeculativeHTMLParser>(*m_document, m_tokenizer.unconsumed_input(), m_tokenizer.is_input_stream_closed());
 
                     // 4. Block the tokenizer for this instance of the HTML parser, such that the event loop will not run tasks that invoke the tokenizer.
                     m_tokenizer.set_blocked(true);
@@ -2845,7 +2883,8 @@ void HTMLParser::handle_text(HTMLToken& token)
                     if (m_aborted)
                         return;
 
-                    // FIXME: 7. Stop the speculative HTML parser for this instance of the HTML parser.
+                    // 7. Stop the speculative HTML parser for this instance of the HTML parser.
+                    m_speculative_html_parser = nullptr;
 
                     // 8. Unblock the tokenizer for this instance of the HTML parser, such that tasks that invoke the tokenizer can again be run.
                     m_tokenizer.set_blocked(false);
@@ -4277,6 +4316,153 @@ JS::NonnullGCPtr<HTMLParser> HTMLParser::create(DOM::Document& document, StringV
     return document.heap().allocate_without_realm<HTMLParser>(document, input, encoding);
 }
 
+JS::NonnullGCPtr<HTMLParser> HTMLParser::create_for_streaming(DOM::Document& document, URL::URL const& url)
+{
+    auto parser = document.heap().allocate_without_realm<HTMLParser>(document);
+    parser->m_tokenizer.open_input_stream();
+    document.set_url(url);
+    return parser;
+}
+
+void HTMLParser::append_to_input_byte_stream(ReadonlyBytes bytes)
+{
+    VERIFY(!m_tokenizer.is_input_stream_closed());
+    m_undecoded_input_bytes.append(bytes);
+
+    // NOTE: The encoding sniffing algorithm prescans the first 1024 bytes for a meta element, so we wait for those
+    //       before committing to an encoding.
+    if (!m_input_byte_stream_encoding.has_value() && m_undecoded_input_bytes.size() < 1024)
+        return;
+
+    decode_input_byte_stream(IsEndOfInput::No);
+    run_with_streamed_input();
+}
+
+void HTMLParser::close_input_byte_stream()
+{
+    decode_input_byte_stream(IsEndOfInput::Yes);
+
+    m_tokenizer.close_input_stream();
+    if (m_speculative_html_parser)
+        m_speculative_html_parser->close_input_stream();
+
+    run_with_streamed_input();
+}
+
+// Returns how many of the given bytes can be decoded without cutting a character in half.
+static size_t length_of_decodable_input(StringView encoding, ReadonlyBytes bytes)
+{
+    if (encoding.equals_ignoring_ascii_case("UTF-8"sv)) {
+        // Find the lead byte of the last sequence, and hold it back if its continuation bytes haven't arrived yet.
+        for (size_t i = 1; i <= min<size_t>(bytes.size(), 4); ++i) {
+            auto byte = bytes[bytes.size() - i];
+            if ((byte & 0xC0) == 0x80)
+                continue;
+
+            size_t sequence_length = 1;
+            if ((byte & 0xE0) == 0xC0)
+                sequence_length = 2;
+            else if ((byte & 0xF0) == 0xE0)
+                sequence_length = 3;
+            else if ((byte & 0xF8) == 0xF0)
+                sequence_length = 4;
+            return sequence_length > i ? bytes.size() - i : bytes.size();
+        }
+        return bytes.size();
+    }
+
+    if (encoding.equals_ignoring_ascii_case("UTF-16BE"sv) || encoding.equals_ignoring_ascii_case("UTF-16LE"sv)) {
+        auto length = bytes.size() & ~static_cast<size_t>(1);
+        if (length < 2)
+            return 0;
+
+        // Hold back a trailing high surrogate until its low surrogate arrives.
+        auto is_big_endian = encoding.equals_ignoring_ascii_case("UTF-16BE"sv);
+        u16 last_code_unit = is_big_endian
+            ? (bytes[length - 2] << 8) | bytes[length - 1]
+            : (bytes[length - 1] << 8) | bytes[length - 2];
+        if (last_code_unit >= 0xD800 && last_code_unit <= 0xDBFF)
+            length -= 2;
+        return length;
+    }
+
+    // The remaining multi-byte encodings keep decoder state between characters, and the replacement encoding produces
+    // a single replacement character for the whole input, so those are only decoded once all input has arrived.
+    for (auto encoding_to_decode_at_end : { "Big5"sv, "EUC-JP"sv, "EUC-KR"sv, "GBK"sv, "gb18030"sv, "ISO-2022-JP"sv, "Shift_JIS"sv, "replacement"sv }) {
+        if (encoding.equals_ignoring_ascii_case(encoding_to_decode_at_end))
+            return 0;
+    }
+
+    // Everything else is a single-byte encoding.
+    return bytes.size();
+}
+
+void HTMLParser::decode_input_byte_stream(IsEndOfInput is_end_of_input)
+{
+    if (!m_input_byte_stream_encoding.has_value()) {
+        ByteString encoding;
+        if (m_document->has_encoding()) {
+            encoding = m_document->encoding().value().to_byte_string();
+        } else {
+            encoding = run_encoding_sniffing_algorithm(*m_document, m_undecoded_input_bytes);
+            dbgln_if(HTML_PARSER_DEBUG, "The encoding sniffing algorithm returned encoding '{}'", encoding);
+        }
+
+        auto standardized_encoding = TextCodec::get_standardized_encoding(encoding);
+        VERIFY(standardized_encoding.has_value());
+        m_document->set_encoding(MUST(String::from_utf8(standardized_encoding.value())));
+        m_input_byte_stream_encoding = standardized_encoding->to_byte_string();
+    }
+
+    auto length = is_end_of_input == IsEndOfInput::Yes
+        ? m_undecoded_input_bytes.size()
+        : length_of_decodable_input(*m_input_byte_stream_encoding, m_undecoded_input_bytes);
+    if (length == 0)
+        return;
+
+    auto decoder = TextCodec::decoder_for(*m_input_byte_stream_encoding);
+    VERIFY(decoder.has_value());
+
+    StringView input { m_undecoded_input_bytes.bytes().trim(length) };
+    String decoded_input;
+    if (!m_has_decoded_input_bytes) {
+        // NOTE: Only the very start of the input may contain a byte order mark, which to_utf8() strips.
+        decoded_input = decoder->to_utf8(input).release_value_but_fixme_should_propagate_errors();
+        m_has_decoded_input_bytes = true;
+    } else {
+        StringBuilder builder { input.length() };
+        decoder->process(input, [&builder](u32 code_point) { return builder.try_append_code_point(code_point); }).release_value_but_fixme_should_propagate_errors();
+        decoded_input = builder.to_string_without_validation();
+    }
+
+    m_undecoded_input_bytes = MUST(m_undecoded_input_bytes.slice(length, m_undecoded_input_bytes.size() - length));
+
+    m_tokenizer.append_to_input_stream(decoded_input);
+    if (m_speculative_html_parser)
+        m_speculative_html_parser->append_to_input_stream(decoded_input);
+}
+
+void HTMLParser::run_with_streamed_input()
+{
+    // NOTE: While the tokenizer is blocked on a parser-blocking script, the parser is still running further up the
+    //       stack, and it will pick up the newly appended input by itself once the script has executed.
+    if (m_is_running_with_streamed_input || m_tokenizer.is_blocked() || m_script_nesting_level > 0)
+        return;
+
+    {
+        TemporaryChange is_running_change { m_is_running_with_streamed_input, true };
+        run();
+    }
+
+    // NOTE: An aborted parser never reaches "the end".
+    if (!m_tokenizer.is_input_stream_closed() || m_aborted)
+        return;
+
+    m_document->set_source(MUST(String::from_byte_string(m_tokenizer.source())));
+    the_end(*m_document, this);
+    m_document->detach_parser({});
+}
+
 enum class AttributeMode {
     No,
     Yes,
@@ -4752,7 +4938,8 @@ void HTMLParser::abort()
     // 1. Throw away any pending content in the input stream, and discard any future content that would have been added to it.
     m_tokenizer.abort();
 
-    // FIXME: 2. Stop the speculative HTML parser for this HTML parser.
+    // 2. Stop the speculative HTML parser for this HTML parser.
+    m_speculative_html_parser = nullptr;
 
     // 3. Update the current document readiness to "interactive".
     m_document->update_readiness(DocumentReadyState::Interactive);
@@ -52,10 +52,16 @@ public:
     static JS::NonnullGCPtr<HTMLParser> create_for_scripting(DOM::Document&);
     static JS::NonnullGCPtr<HTMLParser> create_with_uncertain_encoding(DOM::Document&, ByteBuffer const& input);
     static JS::NonnullGCPtr<HTMLParser> create(DOM::Document&, StringView input, StringView encoding);
+    static JS::NonnullGCPtr<HTMLParser> create_for_streaming(DOM::Document&, URL::URL const&);
 
     void run(HTMLTokenizer::StopAtInsertionPoint = HTMLTokenizer::StopAtInsertionPoint::No);
     void run(const URL::URL&, HTMLTokenizer::StopAtInsertionPoint = HTMLTokenizer::StopAtInsertionPoint::No);
 
+    // For parsers created with create_for_streaming(): parse the document incrementally as its bytes arrive. Once the
+    // input byte stream is closed and everything has been parsed, the parser runs "the end" and detaches itself.
+    void append_to_input_byte_stream(ReadonlyBytes);
+    void close_input_byte_stream();
+
     static void the_end(JS::NonnullGCPtr<DOM::Document>, JS::GCPtr<HTMLParser> = nullptr);
 
     DOM::Document& document();
@@ -119,6 +125,13 @@ private:
 
     void stop_parsing() { m_stop_parsing = true; }
 
+    enum class IsEndOfInput {
+        No,
+        Yes,
+    };
+    void decode_input_byte_stream(IsEndOfInput);
+    void run_with_streamed_input();
+
     void generate_implied_end_tags(FlyString const& exception = {});
     void generate_all_implied_end_tags_thoroughly();
     JS::NonnullGCPtr<DOM::Element> create_element_for(HTMLToken const&, Optional<FlyString> const& namespace_, DOM::Node& intended_parent);
@@ -138,6 +151,8 @@ private:
     DOM::Element& adjusted_current_node();
     DOM::Element& node_before_current_node();
     void insert_character(u32 data);
+    void insert_characters(StringView data);
+    void process_text_run_in_body(StringView text);
     void insert_comment(HTMLToken&);
     void reconstruct_the_active_formatting_elements();
     void close_a_p_element();
@@ -185,6 +200,7 @@ private:
     bool m_aborted { false };
     bool m_parser_pause_flag { false };
     bool m_stop_parsing { false };
+    bool m_skip_next_newline { false };
     size_t m_script_nesting_level { 0 };
 
     JS::Realm& realm();
@@ -198,6 +214,15 @@ private:
 
     JS::GCPtr<DOM::Text> m_character_insertion_node;
     StringBuilder m_character_insertion_builder;
+
+    // State for parsers that receive their input as a byte stream, see create_for_streaming().
+    Optional<ByteString> m_input_byte_stream_encoding;
+    ByteBuffer m_undecoded_input_bytes;
+    bool m_has_decoded_input_bytes { false };
+    bool m_is_running_with_streamed_input { false };
+
+    // https://html.spec.whatwg.org/multipage/parsing.html#active-speculative-html-parser
+    OwnPtr<SpeculativeHTMLParser> m_speculative_html_parser;
 };
 
 RefPtr<CSS::StyleValue> parse_dimension_value(StringView);
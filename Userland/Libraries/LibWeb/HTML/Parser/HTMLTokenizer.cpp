@@ -5,9 +5,11 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/BitCast.h>
 #include <AK/CharacterTypes.h>
 #include <AK/Debug.h>
 #include <AK/GenericShorthands.h>
+#include <AK/SIMD.h>
 #include <AK/SourceLocation.h>
 #include <LibTextCodec/Decoder.h>
 #include <LibWeb/HTML/Parser/Entities.h>
@@ -259,11 +261,14 @@ HTMLToken::Position HTMLTokenizer::nth_last_position(size_t n)
 
 Optional<HTMLToken> HTMLTokenizer::next_token(StopAtInsertionPoint stop_at_insertion_point)
 {
-    if (!m_source_positions.is_empty()) {
+    // NOTE: If we previously stopped in the middle of a token to wait for more input, keep the source positions of the
+    //       code points consumed so far, so the token ends up with the same positions as if the input had been complete.
+    if (!m_source_positions.is_empty() && !m_stopped_waiting_for_more_input) {
         auto last_position = m_source_positions.last();
         m_source_positions.clear_with_capacity();
         m_source_positions.append(move(last_position));
     }
+    m_stopped_waiting_for_more_input = false;
 _StartOfFunction:
     if (!m_queued_tokens.is_empty())
         return m_queued_tokens.dequeue();
@@ -275,6 +280,11 @@ _StartOfFunction:
         if (stop_at_insertion_point == StopAtInsertionPoint::Yes && is_insertion_point_reached())
             return {};
 
+        if (is_waiting_for_more_input()) {
+            m_stopped_waiting_for_more_input = true;
+            return {};
+        }
+
         auto current_input_character = next_code_point();
         switch (m_state) {
             // 13.2.5.1 Data state, https://html.spec.whatwg.org/multipage/parsing.html#data-state
@@ -1654,7 +1664,7 @@ _StartOfFunction:
             {
                 size_t byte_offset = m_utf8_view.byte_offset_of(m_prev_utf8_iterator);
 
-                auto match = HTML::code_points_from_entity(m_decoded_input.substring_view(byte_offset, m_decoded_input.length() - byte_offset));
+                auto match = HTML::code_points_from_entity(m_decoded_input.string_view().substring_view(byte_offset));
 
                 if (match.has_value()) {
                     skip(match->entity.length() - 1);
@@ -2793,8 +2803,7 @@ void HTMLTokenizer::create_new_token(HTMLToken::Type type)
 
 HTMLTokenizer::HTMLTokenizer()
 {
-    m_decoded_input = "";
-    m_utf8_view = Utf8View(m_decoded_input);
+    m_utf8_view = Utf8View(m_decoded_input.string_view());
     m_utf8_iterator = m_utf8_view.begin();
     m_prev_utf8_iterator = m_utf8_view.begin();
     m_source_positions.empend(0u, 0u);
@@ -2804,8 +2813,8 @@ HTMLTokenizer::HTMLTokenizer(StringView input, ByteString const& encoding)
 {
     auto decoder = TextCodec::decoder_for(encoding);
     VERIFY(decoder.has_value());
-    m_decoded_input = decoder->to_utf8(input).release_value_but_fixme_should_propagate_errors().to_byte_string();
-    m_utf8_view = Utf8View(m_decoded_input);
+    m_decoded_input.append(decoder->to_utf8(input).release_value_but_fixme_should_propagate_errors());
+    m_utf8_view = Utf8View(m_decoded_input.string_view());
     m_utf8_iterator = m_utf8_view.begin();
     m_prev_utf8_iterator = m_utf8_view.begin();
     m_source_positions.empend(0u, 0u);
@@ -2817,19 +2826,133 @@ void HTMLTokenizer::insert_input_at_insertion_point(StringView input)
     auto prev_utf8_iterator_byte_offset = m_utf8_view.byte_offset_of(m_prev_utf8_iterator);
 
     // FIXME: Implement a InputStream to handle insertion_point and iterators.
-    StringBuilder builder {};
-    builder.append(m_decoded_input.substring_view(0, m_insertion_point.position));
+    StringBuilder builder { m_decoded_input.length() + input.length() };
+    builder.append(m_decoded_input.string_view().substring_view(0, m_insertion_point.position));
     builder.append(input);
-    builder.append(m_decoded_input.substring_view(m_insertion_point.position));
-    m_decoded_input = builder.to_byte_string();
+    builder.append(m_decoded_input.string_view().substring_view(m_insertion_point.position));
+    m_decoded_input = move(builder);
 
-    m_utf8_view = Utf8View(m_decoded_input);
-    m_utf8_iterator = m_utf8_view.iterator_at_byte_offset(utf8_iterator_byte_offset);
-    m_prev_utf8_iterator = m_utf8_view.iterator_at_byte_offset(prev_utf8_iterator_byte_offset);
+    m_utf8_view = Utf8View(m_decoded_input.string_view());
+    m_utf8_iterator = m_utf8_view.iterator_at_byte_offset_without_validation(utf8_iterator_byte_offset);
+    m_prev_utf8_iterator = m_utf8_view.iterator_at_byte_offset_without_validation(prev_utf8_iterator_byte_offset);
 
     m_insertion_point.position += input.length();
 }
 
+void HTMLTokenizer::append_to_input_stream(StringView input)
+{
+    VERIFY(!m_input_stream_closed);
+
+    auto utf8_iterator_byte_offset = m_utf8_view.byte_offset_of(m_utf8_iterator);
+    auto prev_utf8_iterator_byte_offset = m_utf8_view.byte_offset_of(m_prev_utf8_iterator);
+
+    // NOTE: Only the new input is copied, as the StringBuilder grows its capacity geometrically. The iterators have to be
+    //       recreated as its buffer may have moved.
+    m_decoded_input.append(input);
+
+    m_utf8_view = Utf8View(m_decoded_input.string_view());
+    m_utf8_iterator = m_utf8_view.iterator_at_byte_offset_without_validation(utf8_iterator_byte_offset);
+    m_prev_utf8_iterator = m_utf8_view.iterator_at_byte_offset_without_validation(prev_utf8_iterator_byte_offset);
+}
+
+// Some states look ahead of the current input character (CRLF pairs, markup declarations, named character references).
+// While more input may still arrive, we hold back enough of the input stream that this lookahead never sees a truncated
+// sequence.
+static constexpr size_t max_lookahead_length = 64;
+
+// Returns the offset of the first byte in input[start..end) that ends a text run in the data state, or end if there is none.
+static size_t find_end_of_text_run(ReadonlyBytes input, size_t start, size_t end)
+{
+    using AK::SIMD::u64x2;
+    using AK::SIMD::u8x16;
+
+    auto offset = start;
+    for (; offset + sizeof(u8x16) <= end; offset += sizeof(u8x16)) {
+        u8x16 bytes;
+        __builtin_memcpy(&bytes, input.offset_pointer(offset), sizeof(bytes));
+        auto is_special = (bytes == '<') | (bytes == '&') | (bytes == '\r') | (bytes == 0);
+        auto lanes = bit_cast<u64x2>(is_special);
+        if ((lanes[0] | lanes[1]) != 0)
+            break;
+    }
+
+    for (; offset < end; ++offset) {
+        auto byte = input[offset];
+        if (byte == '<' || byte == '&' || byte == '\r' || byte == 0)
+            break;
+    }
+    return offset;
+}
+
+StringView HTMLTokenizer::consume_text_run(StopAtInsertionPoint stop_at_insertion_point)
+{
+    if (m_state != State::Data || !m_queued_tokens.is_empty() || m_aborted || m_has_emitted_eof)
+        return {};
+
+    auto input = m_decoded_input.string_view().bytes();
+    auto start = m_utf8_view.byte_offset_of(m_utf8_iterator);
+
+    // Mirror where next_token() and the parser would stop: at the insertion point, or before the held back part of a
+    // still open input stream.
+    auto end = input.size();
+    if (m_insertion_point.defined) {
+        if (stop_at_insertion_point == StopAtInsertionPoint::Yes)
+            end = min(end, m_insertion_point.position);
+    } else if (!m_input_stream_closed) {
+        if (end < max_lookahead_length - 1)
+            return {};
+        end -= max_lookahead_length - 1;
+    }
+    if (start >= end)
+        return {};
+
+    auto run_end = find_end_of_text_run(input, start, end);
+    // A code point that starts before the limit is consumed entirely, just like next_code_point() would.
+    while (run_end == end && run_end < input.size() && (input[run_end] & 0xC0) == 0x80)
+        ++run_end;
+    if (run_end == start)
+        return {};
+
+    auto run = m_decoded_input.string_view().substring_view(start, run_end - start);
+
+    // Keep the source position in sync, as if each code point had been consumed by skip().
+    auto position = m_source_positions.is_empty() ? HTMLToken::Position {} : m_source_positions.last();
+    for (auto byte : run.bytes()) {
+        if (byte == '\n') {
+            position.line++;
+            position.column = 0;
+        } else if ((byte & 0xC0) != 0x80) {
+            position.column++;
+        }
+    }
+    position.byte_offset += run.length();
+    if (!m_source_positions.is_empty()) {
+        m_source_positions.clear_with_capacity();
+        m_source_positions.append(position);
+    }
+
+    auto last_code_point_offset = run_end - 1;
+    while (last_code_point_offset > start && (input[last_code_point_offset] & 0xC0) == 0x80)
+        --last_code_point_offset;
+    m_prev_utf8_iterator = m_utf8_view.iterator_at_byte_offset_without_validation(last_code_point_offset);
+    m_utf8_iterator = m_utf8_view.iterator_at_byte_offset_without_validation(run_end);
+    m_stopped_waiting_for_more_input = false;
+
+    return run;
+}
+
+StringView HTMLTokenizer::unconsumed_input() const
+{
+    return m_decoded_input.string_view().substring_view(m_utf8_view.byte_offset_of(m_utf8_iterator));
+}
+
+bool HTMLTokenizer::is_waiting_for_more_input() const
+{
+    if (m_input_stream_closed || m_insertion_point.defined)
+        return false;
+    return m_decoded_input.length() - m_utf8_view.byte_offset_of(m_utf8_iterator) < max_lookahead_length;
+}
+
 void HTMLTokenizer::insert_eof()
 {
     m_explicit_eof_inserted = true;
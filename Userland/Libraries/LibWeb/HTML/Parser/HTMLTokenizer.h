@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <AK/Noncopyable.h>
 #include <AK/Queue.h>
 #include <AK/StringBuilder.h>
 #include <AK/StringView.h>
@@ -101,6 +102,10 @@ namespace Web::HTML {
     __ENUMERATE_TOKENIZER_STATE(NumericCharacterReferenceEnd)
 
 class HTMLTokenizer {
+    // NOTE: m_utf8_view points into m_decoded_input, which may use the inline capacity of its StringBuilder.
+    AK_MAKE_NONCOPYABLE(HTMLTokenizer);
+    AK_MAKE_NONMOVABLE(HTMLTokenizer);
+
 public:
     explicit HTMLTokenizer();
     explicit HTMLTokenizer(StringView input, ByteString const& encoding);
@@ -117,6 +122,12 @@ public:
     };
     Optional<HTMLToken> next_token(StopAtInsertionPoint = StopAtInsertionPoint::No);
 
+    // Fast path for runs of ordinary text in the data state: consumes all code points up to the next one that isn't
+    // simply emitted as a character token of its own ('<', '&', U+000D CR or U+0000 NULL), and returns them.
+    // Consuming a run is equivalent to calling next_token() once per code point, which the caller must account for.
+    // Returns an empty view if the tokenizer isn't at the start of such a run.
+    StringView consume_text_run(StopAtInsertionPoint = StopAtInsertionPoint::No);
+
     void set_parser(Badge<HTMLParser>, HTMLParser& parser) { m_parser = &parser; }
 
     void switch_to(Badge<HTMLParser>, State new_state);
@@ -128,12 +139,22 @@ public:
     void set_blocked(bool b) { m_blocked = b; }
     bool is_blocked() const { return m_blocked; }
 
-    ByteString source() const { return m_decoded_input; }
+    ByteString source() const { return m_decoded_input.to_byte_string(); }
 
     void insert_input_at_insertion_point(StringView input);
     void insert_eof();
     bool is_eof_inserted();
 
+    // When the document is streamed in from the network, the input stream stays open until all bytes have arrived.
+    // Until then, running out of input makes the tokenizer wait for more instead of emitting an end-of-file token.
+    void open_input_stream() { m_input_stream_closed = false; }
+    void append_to_input_stream(StringView input);
+    void close_input_stream() { m_input_stream_closed = true; }
+    bool is_input_stream_closed() const { return m_input_stream_closed; }
+
+    // The part of the input stream that has been received but not consumed yet.
+    StringView unconsumed_input() const;
+
     bool is_insertion_point_defined() const { return m_insertion_point.defined; }
     bool is_insertion_point_reached()
     {
@@ -152,6 +173,8 @@ public:
     void abort() { m_aborted = true; }
 
 private:
+    bool is_waiting_for_more_input() const;
+
     void skip(size_t count);
     Optional<u32> next_code_point();
     Optional<u32> peek_code_point(size_t offset) const;
@@ -188,7 +211,9 @@ private:
 
     Vector<u32> m_temporary_buffer;
 
-    ByteString m_decoded_input;
+    // NOTE: The input stream only ever grows at the end (unless script inserts input at the insertion point), so we
+    //       keep it in a StringBuilder to make appending to it cheap.
+    StringBuilder m_decoded_input;
 
     struct InsertionPoint {
         size_t position { 0 };
@@ -209,6 +234,9 @@ private:
     bool m_explicit_eof_inserted { false };
     bool m_has_emitted_eof { false };
 
+    bool m_input_stream_closed { true };
+    bool m_stopped_waiting_for_more_input { false };
+
     Queue<HTMLToken> m_queued_tokens;
 
     u32 m_character_reference_code { 0 };
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibWeb/DOM/Document.h>
+#include <LibWeb/DOMURL/DOMURL.h>
+#include <LibWeb/HTML/AttributeNames.h>
+#include <LibWeb/HTML/Parser/SpeculativeHTMLParser.h>
+#include <LibWeb/HTML/TagNames.h>
+#include <LibWeb/Infra/CharacterTypes.h>
+#include <LibWeb/Loader/LoadRequest.h>
+#include <LibWeb/Loader/ResourceLoader.h>
+#include <LibWeb/MimeSniff/MimeType.h>
+
+namespace Web::HTML {
+
+SpeculativeHTMLParser::SpeculativeHTMLParser(DOM::Document& document, StringView input, bool input_stream_closed)
+    : m_document(document)
+    , m_tokenizer(input, "UTF-8"sv)
+    , m_base_url(document.base_url())
+{
+    if (!input_stream_closed)
+        m_tokenizer.open_input_stream();
+    run();
+}
+
+SpeculativeHTMLParser::~SpeculativeHTMLParser() = default;
+
+void SpeculativeHTMLParser::visit_edges(JS::Cell::Visitor& visitor)
+{
+    visitor.visit(m_document);
+}
+
+void SpeculativeHTMLParser::append_to_input_stream(StringView input)
+{
+    m_tokenizer.append_to_input_stream(input);
+    run();
+}
+
+void SpeculativeHTMLParser::close_input_stream()
+{
+    m_tokenizer.close_input_stream();
+    run();
+}
+
+void SpeculativeHTMLParser::run()
+{
+    for (;;) {
+        auto token = m_tokenizer.next_token();
+        if (!token.has_value() || token->is_end_of_file())
+            return;
+
+        if (token->is_start_tag())
+            process_start_tag(*token);
+        else if (token->is_end_tag())
+            process_end_tag(*token);
+    }
+}
+
+static bool has_space_separated_token(StringView value, StringView token)
+{
+    for (auto part : value.split_view_if(Infra::is_ascii_whitespace)) {
+        if (part.equals_ignoring_ascii_case(token))
+            return true;
+    }
+    return false;
+}
+
+// https://html.spec.whatwg.org/multipage/parsing.html#speculative-fetch
+void SpeculativeHTMLParser::process_start_tag(HTMLToken const& token)
+{
+    auto const& tag_name = token.tag_name();
+
+    if (tag_name.is_one_of(TagNames::svg, TagNames::math)) {
+        if (!token.is_self_closing())
+            ++m_foreign_content_depth;
+        return;
+    }
+    if (m_foreign_content_depth > 0)
+        return;
+
+    // Switch the tokenizer into the same state the tree builder would, so that the contents of raw text elements
+    // aren't mistaken for markup.
+    if (tag_name.is_one_of(TagNames::title, TagNames::textarea)) {
+        m_tokenizer.switch_to(HTMLTokenizer::State::RCDATA);
+    } else if (tag_name.is_one_of(TagNames::style, TagNames::xmp, TagNames::iframe, TagNames::noembed, TagNames::noframes)
+        || (tag_name == TagNames::noscript && m_document->is_scripting_enabled())) {
+        m_tokenizer.switch_to(HTMLTokenizer::State::RAWTEXT);
+    } else if (tag_name == TagNames::plaintext) {
+        m_tokenizer.switch_to(HTMLTokenizer::State::PLAINTEXT);
+    } else if (tag_name == TagNames::script) {
+        m_tokenizer.switch_to(HTMLTokenizer::State::ScriptData);
+    }
+
+    if (tag_name == TagNames::template_) {
+        ++m_template_depth;
+        return;
+    }
+    if (m_template_depth > 0)
+        return;
+
+    // The first base element with an href attribute determines the document base URL, both for the speculative
+    // HTML parser and for the real one.
+    if (tag_name == TagNames::base) {
+        if (auto href = token.attribute(AttributeNames::href); href.has_value() && !m_seen_base_element) {
+            m_seen_base_element = true;
+            if (auto url = DOMURL::parse(*href, m_document->fallback_base_url()); url.is_valid())
+                m_base_url = url;
+        }
+        return;
+    }
+
+    // NOTE: Requests with a CORS mode other than "no-cors" would not match the element's own fetch, so we leave those
+    //       for the real parser.
+    if (token.has_attribute(AttributeNames::crossorigin))
+        return;
+
+    if (tag_name == TagNames::script) {
+        auto src = token.attribute(AttributeNames::src);
+        if (!src.has_value() || token.has_attribute(AttributeNames::nomodule))
+            return;
+        if (auto type = token.attribute(AttributeNames::type); type.has_value() && !type->is_empty()) {
+            if (!MimeSniff::is_javascript_mime_type_essence_match(MUST(type->trim(Infra::ASCII_WHITESPACE))))
+                return;
+        }
+        speculative_fetch(*src, Fetch::Infrastructure::Request::Destination::Script);
+        return;
+    }
+
+    if (tag_name == TagNames::link) {
+        auto rel = token.attribute(AttributeNames::rel);
+        auto href = token.attribute(AttributeNames::href);
+        if (!rel.has_value() || !href.has_value())
+            return;
+        if (!has_space_separated_token(*rel, "stylesheet"sv) || has_space_separated_token(*rel, "alternate"sv))
+            return;
+        speculative_fetch(*href, Fetch::Infrastructure::Request::Destination::Style);
+        return;
+    }
+
+    if (tag_name == TagNames::img) {
+        // NOTE: With srcset, the image source depends on the viewport and the final layout, so we can't guess it here.
+        auto src = token.attribute(AttributeNames::src);
+        if (!src.has_value() || token.has_attribute(AttributeNames::srcset))
+            return;
+        if (auto loading = token.attribute(AttributeNames::loading); loading.has_value() && loading->equals_ignoring_ascii_case("lazy"sv))
+            return;
+        speculative_fetch(*src, Fetch::Infrastructure::Request::Destination::Image);
+        return;
+    }
+}
+
+void SpeculativeHTMLParser::process_end_tag(HTMLToken const& token)
+{
+    auto const& tag_name = token.tag_name();
+
+    if (tag_name.is_one_of(TagNames::svg, TagNames::math)) {
+        if (m_foreign_content_depth > 0)
+            --m_foreign_content_depth;
+        return;
+    }
+    if (m_foreign_content_depth > 0)
+        return;
+
+    if (tag_name == TagNames::template_ && m_template_depth > 0)
+        --m_template_depth;
+}
+
+void SpeculativeHTMLParser::speculative_fetch(StringView url_string, Fetch::Infrastructure::Request::Destination destination)
+{
+    auto url = DOMURL::parse(url_string, m_base_url);
+    if (!url.is_valid() || !url.scheme().is_one_of("http"sv, "https"sv))
+        return;
+
+    // https://html.spec.whatwg.org/multipage/parsing.html#list-of-speculative-fetch-urls
+    // If the URL is already in the document's list of speculative fetch URLs, don't fetch it again.
+    if (m_document->list_of_speculative_fetch_urls().set(url) != HashSetResult::InsertedNewEntry)
+        return;
+
+    auto request = LoadRequest::create_for_url_on_page(url, &m_document->page());
+    auto preloaded_response = ResourceLoader::the().preload(request);
+    if (!preloaded_response)
+        return;
+
+    // NOTE: Elements without a crossorigin attribute fetch in "no-cors" mode, which includes credentials.
+    m_document->add_preloaded_response({ url, request.method(), Fetch::Infrastructure::Request::CredentialsMode::Include, destination }, preloaded_response.release_nonnull());
+}
+
+}
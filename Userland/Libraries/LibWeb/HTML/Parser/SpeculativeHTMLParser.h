@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <LibJS/Heap/Cell.h>
+#include <LibURL/URL.h>
+#include <LibWeb/Fetch/Infrastructure/HTTP/Requests.h>
+#include <LibWeb/Forward.h>
+#include <LibWeb/HTML/Parser/HTMLTokenizer.h>
+
+namespace Web::HTML {
+
+// https://html.spec.whatwg.org/multipage/parsing.html#speculative-html-parsing
+// While the HTML parser is blocked on a parser-blocking script, the speculative HTML parser tokenizes the rest of the
+// input that has already arrived, and starts fetching the scripts, style sheets and images it comes across. It never
+// modifies the document.
+class SpeculativeHTMLParser {
+public:
+    SpeculativeHTMLParser(DOM::Document&, StringView input, bool input_stream_closed);
+    ~SpeculativeHTMLParser();
+
+    void append_to_input_stream(StringView input);
+    void close_input_stream();
+
+    void visit_edges(JS::Cell::Visitor&);
+
+private:
+    void run();
+    void process_start_tag(HTMLToken const&);
+    void process_end_tag(HTMLToken const&);
+    void speculative_fetch(StringView url, Fetch::Infrastructure::Request::Destination);
+
+    JS::NonnullGCPtr<DOM::Document> m_document;
+    HTMLTokenizer m_tokenizer;
+
+    URL::URL m_base_url;
+    bool m_seen_base_element { false };
+
+    // Nothing inside template contents or foreign content is fetched, and foreign content doesn't switch the tokenizer
+    // into its text states.
+    size_t m_template_depth { 0 };
+    size_t m_foreign_content_depth { 0 };
+};
+
+}
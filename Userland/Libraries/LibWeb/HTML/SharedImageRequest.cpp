@@ -177,7 +177,7 @@ void SharedImageRequest::handle_successful_fetch(URL::URL const& url_string, Str
                 .duration = static_cast<int>(frame.duration),
             });
         }
-        strong_this->m_image_data = AnimatedBitmapDecodedImageData::create(strong_this->m_document->realm(), move(frames), result.loop_count, result.is_animated).release_value_but_fixme_should_propagate_errors();
+        strong_this->m_image_data = AnimatedBitmapDecodedImageData::create(strong_this->m_document->realm(), move(frames), result.loop_count, result.is_animated, result.frame_count, move(result.frame_source)).release_value_but_fixme_should_propagate_errors();
         handle_successful_decode(*strong_this);
         return {};
     };
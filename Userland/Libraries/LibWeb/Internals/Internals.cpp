@@ -11,7 +11,9 @@
 #include <LibWeb/DOM/Event.h>
 #include <LibWeb/DOM/EventTarget.h>
 #include <LibWeb/HTML/BrowsingContext.h>
+#include <LibWeb/HTML/HTMLDocument.h>
 #include <LibWeb/HTML/HTMLElement.h>
+#include <LibWeb/HTML/Parser/HTMLParser.h>
 #include <LibWeb/HTML/Window.h>
 #include <LibWeb/Internals/Internals.h>
 #include <LibWeb/Page/Page.h>
@@ -107,4 +109,58 @@ JS::NonnullGCPtr<InternalAnimationTimeline> Internals::create_internal_animation
     return realm.heap().allocate<InternalAnimationTimeline>(realm, realm);
 }
 
+u64 Internals::style_invalidation_count()
+{
+    return global_object().associated_document().style_invalidation_count();
+}
+
+u64 Internals::intrinsic_size_cache_hit_count()
+{
+    return global_object().associated_document().intrinsic_size_cache_hit_count();
+}
+
+u64 Internals::intrinsic_size_cache_miss_count()
+{
+    return global_object().associated_document().intrinsic_size_cache_miss_count();
+}
+
+u64 Internals::relayout_boundary_layout_count()
+{
+    return global_object().associated_document().relayout_boundary_layout_count();
+}
+
+// Feeds each chunk to the parser of a new document separately, like the chunks of a response body that arrive one after
+// the other. Every code point of a chunk is one byte.
+WebIDL::ExceptionOr<JS::NonnullGCPtr<DOM::Document>> Internals::parse_html_in_chunks(Vector<String> const& chunks)
+{
+    auto& realm = this->realm();
+    auto document = HTML::HTMLDocument::create(realm);
+    document->set_content_type("text/html"_string);
+    document->set_document_type(DOM::Document::Type::HTML);
+
+    auto parser = HTML::HTMLParser::create_for_streaming(*document, document->url());
+    for (auto const& chunk : chunks) {
+        ByteBuffer bytes;
+        for (auto code_point : chunk.code_points()) {
+            if (code_point > 0xff)
+                return WebIDL::SyntaxError::create(realm, "Chunks must only contain code points up to U+00FF"_fly_string);
+            bytes.append(static_cast<u8>(code_point));
+        }
+        parser->append_to_input_byte_stream(bytes);
+    }
+    parser->close_input_byte_stream();
+
+    return document;
+}
+
+u64 Internals::preloaded_response_count()
+{
+    return global_object().associated_document().preloaded_response_count();
+}
+
+u64 Internals::claimed_preloaded_response_count()
+{
+    return global_object().associated_document().claimed_preloaded_response_count();
+}
+
 }
@@ -34,6 +34,15 @@ public:
 
     JS::NonnullGCPtr<InternalAnimationTimeline> create_internal_animation_timeline();
 
+    u64 style_invalidation_count();
+    u64 intrinsic_size_cache_hit_count();
+    u64 intrinsic_size_cache_miss_count();
+    u64 relayout_boundary_layout_count();
+
+    WebIDL::ExceptionOr<JS::NonnullGCPtr<DOM::Document>> parse_html_in_chunks(Vector<String> const& chunks);
+    u64 preloaded_response_count();
+    u64 claimed_preloaded_response_count();
+
 private:
     explicit Internals(JS::Realm&);
     virtual void initialize(JS::Realm&) override;
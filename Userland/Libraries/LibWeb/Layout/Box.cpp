@@ -60,6 +60,51 @@ bool Box::is_user_scrollable() const
     return computed_values().overflow_y() == CSS::Overflow::Scroll || computed_values().overflow_y() == CSS::Overflow::Auto;
 }
 
+bool Box::is_relayout_boundary() const
+{
+    if (is_viewport())
+        return true;
+
+    // NOTE: A box that hasn't been laid out yet has no geometry that could be kept.
+    return m_is_relayout_boundary && paintable_box();
+}
+
+bool Box::can_be_relayout_boundary() const
+{
+    if (is_anonymous())
+        return false;
+
+    // The box must be laid out in the normal flow of a block container, and establish a block formatting context of
+    // its own that doesn't let anything (e.g. floats or scrollable overflow) escape.
+    if (is_floating() || is_absolutely_positioned() || is_flex_item() || is_grid_item())
+        return false;
+    if (!display().is_block_outside() && !display().is_inline_block())
+        return false;
+    if (FormattingContext::formatting_context_type_created_by_box(*this) != FormattingContext::Type::Block)
+        return false;
+    auto const& computed_values = this->computed_values();
+    if (computed_values.overflow_x() == CSS::Overflow::Visible || computed_values.overflow_y() == CSS::Overflow::Visible)
+        return false;
+
+    // The size of the box must not depend on its contents.
+    if (!computed_values.width().is_length() || !computed_values.height().is_length())
+        return false;
+    auto is_auto_or_length = [](CSS::Size const& size) { return size.is_auto() || size.is_none() || size.is_length(); };
+    if (!is_auto_or_length(computed_values.min_width()) || !is_auto_or_length(computed_values.max_width()))
+        return false;
+    if (!is_auto_or_length(computed_values.min_height()) || !is_auto_or_length(computed_values.max_height()))
+        return false;
+
+    return true;
+}
+
+Box::IntrinsicSizes& Box::cached_intrinsic_sizes() const
+{
+    if (!m_cached_intrinsic_sizes)
+        m_cached_intrinsic_sizes = make<IntrinsicSizes>();
+    return *m_cached_intrinsic_sizes;
+}
+
 bool Box::is_body() const
 {
     return dom_node() && dom_node() == document().body();
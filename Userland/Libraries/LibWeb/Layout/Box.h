@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/HashMap.h>
 #include <AK/OwnPtr.h>
 #include <LibGfx/Rect.h>
 #include <LibJS/Heap/Cell.h>
@@ -54,6 +55,30 @@ public:
 
     bool is_user_scrollable() const;
 
+    // A relayout boundary is a box whose own geometry, and the geometry of everything around it, does not depend on
+    // its contents. When something inside of it needs layout, the box can be laid out again on its own.
+    // NOTE: Whether a box is a relayout boundary depends on its ancestors and descendants as well. To avoid walking the
+    //       layout tree every time, this is determined for all boxes at once, see Viewport::update_relayout_boundaries().
+    bool is_relayout_boundary() const;
+    void set_is_relayout_boundary(bool is_relayout_boundary) { m_is_relayout_boundary = is_relayout_boundary; }
+
+    // Whether this box could be a relayout boundary, judging by nothing but its own computed values.
+    bool can_be_relayout_boundary() const;
+
+    // We cache intrinsic sizes once determined, as they only change when the box or one of its descendants needs layout,
+    // or the whole document needs layout (see Document::update_layout()).
+    // This avoids computing them several times while performing flex and grid layout, and across layouts.
+    struct IntrinsicSizes {
+        Optional<CSSPixels> min_content_width;
+        Optional<CSSPixels> max_content_width;
+
+        HashMap<CSSPixels, Optional<CSSPixels>> min_content_height;
+        HashMap<CSSPixels, Optional<CSSPixels>> max_content_height;
+    };
+
+    IntrinsicSizes& cached_intrinsic_sizes() const;
+    void reset_cached_intrinsic_sizes() const { m_cached_intrinsic_sizes = nullptr; }
+
 protected:
     Box(DOM::Document&, DOM::Node*, NonnullRefPtr<CSS::StyleProperties>);
     Box(DOM::Document&, DOM::Node*, NonnullOwnPtr<CSS::ComputedValues>);
@@ -64,6 +89,10 @@ private:
     Optional<CSSPixels> m_natural_width;
     Optional<CSSPixels> m_natural_height;
     Optional<CSSPixelFraction> m_natural_aspect_ratio;
+
+    mutable OwnPtr<IntrinsicSizes> m_cached_intrinsic_sizes;
+
+    bool m_is_relayout_boundary { false };
 };
 
 template<>
@@ -1435,16 +1435,19 @@ CSSPixels FormattingContext::calculate_fit_content_height(Layout::Box const& box
     return calculate_max_content_height(box, available_space.width.to_px_or_zero());
 }
 
+static constexpr size_t max_cached_intrinsic_heights_per_box = 16;
+
 CSSPixels FormattingContext::calculate_min_content_width(Layout::Box const& box) const
 {
     if (box.has_natural_width())
         return *box.natural_width();
 
-    auto& root_state = m_state.m_root;
-
-    auto& cache = *root_state.intrinsic_sizes.ensure(&box, [] { return adopt_own(*new LayoutState::IntrinsicSizes); });
-    if (cache.min_content_width.has_value())
+    auto& cache = box.cached_intrinsic_sizes();
+    if (cache.min_content_width.has_value()) {
+        ++m_state.m_root.intrinsic_size_cache_hit_count;
         return *cache.min_content_width;
+    }
+    ++m_state.m_root.intrinsic_size_cache_miss_count;
 
     LayoutState throwaway_state(&m_state);
 
@@ -1478,11 +1481,12 @@ CSSPixels FormattingContext::calculate_max_content_width(Layout::Box const& box)
     if (box.has_natural_width())
         return *box.natural_width();
 
-    auto& root_state = m_state.m_root;
-
-    auto& cache = *root_state.intrinsic_sizes.ensure(&box, [] { return adopt_own(*new LayoutState::IntrinsicSizes); });
-    if (cache.max_content_width.has_value())
+    auto& cache = box.cached_intrinsic_sizes();
+    if (cache.max_content_width.has_value()) {
+        ++m_state.m_root.intrinsic_size_cache_hit_count;
         return *cache.max_content_width;
+    }
+    ++m_state.m_root.intrinsic_size_cache_miss_count;
 
     LayoutState throwaway_state(&m_state);
 
@@ -1522,13 +1526,18 @@ CSSPixels FormattingContext::calculate_min_content_height(Layout::Box const& box
         return *box.natural_height();
 
     auto get_cache_slot = [&]() -> Optional<CSSPixels>* {
-        auto& root_state = m_state.m_root;
-        auto& cache = *root_state.intrinsic_sizes.ensure(&box, [] { return adopt_own(*new LayoutState::IntrinsicSizes); });
+        auto& cache = box.cached_intrinsic_sizes();
+        // NOTE: The cache outlives a single layout, so don't let it grow without bounds when the width keeps changing.
+        if (cache.min_content_height.size() >= max_cached_intrinsic_heights_per_box && !cache.min_content_height.contains(width))
+            cache.min_content_height.clear();
         return &cache.min_content_height.ensure(width);
     };
 
-    if (auto* cache_slot = get_cache_slot(); cache_slot && cache_slot->has_value())
+    if (auto* cache_slot = get_cache_slot(); cache_slot && cache_slot->has_value()) {
+        ++m_state.m_root.intrinsic_size_cache_hit_count;
         return cache_slot->value();
+    }
+    ++m_state.m_root.intrinsic_size_cache_miss_count;
 
     LayoutState throwaway_state(&m_state);
 
@@ -1566,13 +1575,18 @@ CSSPixels FormattingContext::calculate_max_content_height(Layout::Box const& box
         return *box.natural_height();
 
     auto get_cache_slot = [&]() -> Optional<CSSPixels>* {
-        auto& root_state = m_state.m_root;
-        auto& cache = *root_state.intrinsic_sizes.ensure(&box, [] { return adopt_own(*new LayoutState::IntrinsicSizes); });
+        auto& cache = box.cached_intrinsic_sizes();
+        // NOTE: The cache outlives a single layout, so don't let it grow without bounds when the width keeps changing.
+        if (cache.max_content_height.size() >= max_cached_intrinsic_heights_per_box && !cache.max_content_height.contains(width))
+            cache.max_content_height.clear();
         return &cache.max_content_height.ensure(width);
     };
 
-    if (auto* cache_slot = get_cache_slot(); cache_slot && cache_slot->has_value())
+    if (auto* cache_slot = get_cache_slot(); cache_slot && cache_slot->has_value()) {
+        ++m_state.m_root.intrinsic_size_cache_hit_count;
         return cache_slot->value();
+    }
+    ++m_state.m_root.intrinsic_size_cache_miss_count;
 
     LayoutState throwaway_state(&m_state);
 
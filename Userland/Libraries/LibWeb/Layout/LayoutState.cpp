@@ -205,6 +205,17 @@ void LayoutState::commit(Box& root)
     // Only the top-level LayoutState should ever be committed.
     VERIFY(!m_parent);
 
+    // NOTE: If only the subtree below a relayout boundary was laid out, the used values that were populated for the
+    //       boundary's containing block chain must not be committed, as everything outside of it keeps its paintable.
+    bool const is_relayout_of_subtree = !root.is_viewport();
+    JS::GCPtr<Painting::Paintable> previous_root_paintable;
+    if (is_relayout_of_subtree) {
+        previous_root_paintable = root.paintable();
+        used_values_per_layout_node.remove_all_matching([&](auto& node, auto&) {
+            return !root.is_inclusive_ancestor_of(*node);
+        });
+    }
+
     // NOTE: In case this is a relayout of an existing tree, we start by detaching the old paint tree
     //       from the layout tree. This is done to ensure that we don't end up with any old-tree pointers
     //       when text paintables shift around in the tree.
@@ -212,7 +223,8 @@ void LayoutState::commit(Box& root)
         node.set_paintable(nullptr);
         return TraversalDecision::Continue;
     });
-    root.document().for_each_shadow_including_inclusive_descendant([&](DOM::Node& node) {
+    auto& dom_root = is_relayout_of_subtree ? *root.dom_node() : root.document();
+    dom_root.for_each_shadow_including_inclusive_descendant([&](DOM::Node& node) {
         node.set_paintable(nullptr);
         return TraversalDecision::Continue;
     });
@@ -350,6 +362,13 @@ void LayoutState::commit(Box& root)
 
     build_paint_tree(root);
 
+    // Put the new paintable of the relayout boundary where the previous one was in the paintable tree.
+    if (previous_root_paintable && previous_root_paintable->parent()) {
+        auto& parent_paintable = *previous_root_paintable->parent();
+        parent_paintable.insert_before(*root.paintable(), previous_root_paintable);
+        parent_paintable.remove_child(*previous_root_paintable);
+    }
+
     resolve_relative_positions();
 
     // Measure overflow in scroll containers.
@@ -369,6 +388,48 @@ void LayoutState::commit(Box& root)
     }
 }
 
+void LayoutState::populate_from_paintables(Box const& root)
+{
+    Vector<Box const&> boxes;
+    for (auto const* box = &root; box; box = box->containing_block())
+        boxes.append(*box);
+
+    // NOTE: We go from the outermost containing block inwards, so that every box finds the used values of its
+    //       containing block already populated.
+    for (auto const& box : boxes.in_reverse()) {
+        auto& used_values = get_mutable(box);
+        auto const* paintable_box = box.paintable_box();
+        if (!paintable_box)
+            continue;
+
+        auto const& box_model = box.box_model();
+        used_values.set_content_width(paintable_box->content_width());
+        used_values.set_content_height(paintable_box->content_height());
+        used_values.margin_top = box_model.margin.top;
+        used_values.margin_right = box_model.margin.right;
+        used_values.margin_bottom = box_model.margin.bottom;
+        used_values.margin_left = box_model.margin.left;
+        used_values.border_top = box_model.border.top;
+        used_values.border_right = box_model.border.right;
+        used_values.border_bottom = box_model.border.bottom;
+        used_values.border_left = box_model.border.left;
+        used_values.padding_top = box_model.padding.top;
+        used_values.padding_right = box_model.padding.right;
+        used_values.padding_bottom = box_model.padding.bottom;
+        used_values.padding_left = box_model.padding.left;
+        used_values.inset_top = box_model.inset.top;
+        used_values.inset_right = box_model.inset.right;
+        used_values.inset_bottom = box_model.inset.bottom;
+        used_values.inset_left = box_model.inset.left;
+
+        // NOTE: The paintable offset includes the relative position inset, which commit() applies on its own.
+        auto offset = paintable_box->offset();
+        if (box.computed_values().position() == CSS::Positioning::Relative)
+            offset.translate_by(-box_model.inset.left, -box_model.inset.top);
+        used_values.offset = offset;
+    }
+}
+
 void LayoutState::UsedValues::set_node(NodeWithStyle& node, UsedValues const* containing_block_used_values)
 {
     m_node = &node;
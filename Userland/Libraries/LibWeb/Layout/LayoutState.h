@@ -168,8 +168,14 @@ struct LayoutState {
     };
 
     // Commits the used values produced by layout and builds a paintable tree.
+    // If `root` is not the viewport, only the subtree below it is committed, and its new paintable takes the place of
+    // the previous one in the paintable tree.
     void commit(Box& root);
 
+    // Populates the used values of `root` and its containing block chain from their current paintables.
+    // This allows laying out the subtree below a relayout boundary again, without laying out anything around it.
+    void populate_from_paintables(Box const& root);
+
     // NOTE: get_mutable() will CoW the UsedValues if it's inherited from an ancestor state;
     UsedValues& get_mutable(NodeWithStyle const&);
 
@@ -178,17 +184,10 @@ struct LayoutState {
 
     HashMap<JS::NonnullGCPtr<Layout::Node const>, NonnullOwnPtr<UsedValues>> used_values_per_layout_node;
 
-    // We cache intrinsic sizes once determined, as they will not change over the course of a full layout.
-    // This avoids computing them several times while performing flex layout.
-    struct IntrinsicSizes {
-        Optional<CSSPixels> min_content_width;
-        Optional<CSSPixels> max_content_width;
-
-        HashMap<CSSPixels, Optional<CSSPixels>> min_content_height;
-        HashMap<CSSPixels, Optional<CSSPixels>> max_content_height;
-    };
-
-    HashMap<JS::GCPtr<NodeWithStyle const>, NonnullOwnPtr<IntrinsicSizes>> mutable intrinsic_sizes;
+    // NOTE: Intrinsic sizes are cached on each Box, see Box::cached_intrinsic_sizes().
+    //       These count how often the cache was used during this layout.
+    mutable u64 intrinsic_size_cache_hit_count { 0 };
+    mutable u64 intrinsic_size_cache_miss_count { 0 };
 
     LayoutState const* m_parent { nullptr };
     LayoutState const& m_root;
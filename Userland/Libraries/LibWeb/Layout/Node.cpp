@@ -312,6 +312,8 @@ static CSSPixels snap_a_length_as_a_border_width(double device_pixels_per_css_pi
 
 void NodeWithStyle::apply_style(const CSS::StyleProperties& computed_style)
 {
+    document().set_needs_relayout_boundary_update();
+
     auto& computed_values = mutable_computed_values();
 
     // NOTE: color must be set first to ensure currentColor can be resolved in other properties (e.g. background-color).
@@ -987,6 +989,34 @@ void Node::set_paintable(JS::GCPtr<Painting::Paintable> paintable)
     m_paintable = move(paintable);
 }
 
+void Node::set_needs_layout()
+{
+    if (m_needs_layout)
+        return;
+    m_needs_layout = true;
+
+    // NOTE: The intrinsic sizes of this node and its ancestors may depend on whatever changed here.
+    if (is<Box>(*this))
+        static_cast<Box const&>(*this).reset_cached_intrinsic_sizes();
+    for (Node* ancestor = parent(); ancestor && !ancestor->m_child_needs_layout; ancestor = ancestor->parent()) {
+        ancestor->m_child_needs_layout = true;
+        if (is<Box>(*ancestor))
+            static_cast<Box const&>(*ancestor).reset_cached_intrinsic_sizes();
+    }
+
+    document().schedule_layout_update();
+}
+
+void Node::clear_needs_layout()
+{
+    m_needs_layout = false;
+    if (!m_child_needs_layout)
+        return;
+    m_child_needs_layout = false;
+    for (auto* child = first_child(); child; child = child->next_sibling())
+        child->clear_needs_layout();
+}
+
 JS::GCPtr<Painting::Paintable> Node::create_paintable() const
 {
     return nullptr;
@@ -164,6 +164,13 @@ public:
     u32 initial_quote_nesting_level() const { return m_initial_quote_nesting_level; }
     void set_initial_quote_nesting_level(u32 value) { m_initial_quote_nesting_level = value; }
 
+    // NOTE: A node that needs layout marks all of its ancestors as having a child that needs layout.
+    //       This allows Document::update_layout() to find the dirty subtrees without visiting the whole tree.
+    bool needs_layout() const { return m_needs_layout; }
+    bool child_needs_layout() const { return m_child_needs_layout; }
+    void set_needs_layout();
+    void clear_needs_layout();
+
 protected:
     Node(DOM::Document&, DOM::Node*);
 
@@ -186,6 +193,9 @@ private:
     bool m_is_flex_item { false };
     bool m_is_grid_item { false };
 
+    bool m_needs_layout { false };
+    bool m_child_needs_layout { false };
+
     GeneratedFor m_generated_for { GeneratedFor::NotGenerated };
 
     u32 m_initial_quote_nesting_level { 0 };
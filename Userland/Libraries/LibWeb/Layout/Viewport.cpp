@@ -27,4 +27,39 @@ JS::GCPtr<Painting::Paintable> Viewport::create_paintable() const
     return Painting::ViewportPaintable::create(*this);
 }
 
+// NOTE: The baseline of a box is derived from its contents, and inline-blocks, flex items, grid items and table cells
+//       may be aligned by the baseline of their descendants. To keep things simple, we only allow block-level ancestors
+//       that aren't aligned by their baseline. The baseline of an inline-block relayout boundary itself is checked after
+//       it has been laid out again, see Document::relayout_dirty_subtrees().
+static void update_relayout_boundaries_in_subtree(Node& node, bool ancestors_allow_relayout_boundaries)
+{
+    if (is<Box>(node)) {
+        auto& box = static_cast<Box&>(node);
+        box.set_is_relayout_boundary(ancestors_allow_relayout_boundaries && box.can_be_relayout_boundary());
+    }
+
+    ancestors_allow_relayout_boundaries = ancestors_allow_relayout_boundaries && node.display().is_block_outside() && !node.is_flex_item() && !node.is_grid_item();
+    for (auto* child = node.first_child(); child; child = child->next_sibling())
+        update_relayout_boundaries_in_subtree(*child, ancestors_allow_relayout_boundaries);
+}
+
+void Viewport::update_relayout_boundaries()
+{
+    for (auto* child = first_child(); child; child = child->next_sibling())
+        update_relayout_boundaries_in_subtree(*child, true);
+
+    // Absolutely positioned descendants are laid out by their containing block, so it must be inside of a relayout
+    // boundary. Every box between an absolutely positioned box and its containing block is therefore not one.
+    for_each_in_subtree([&](Node& node) {
+        if (!node.is_absolutely_positioned())
+            return TraversalDecision::Continue;
+        auto const* containing_block = node.containing_block();
+        for (auto* ancestor = node.parent(); ancestor && ancestor != containing_block; ancestor = ancestor->parent()) {
+            if (is<Box>(*ancestor))
+                static_cast<Box&>(*ancestor).set_is_relayout_boundary(false);
+        }
+        return TraversalDecision::Continue;
+    });
+}
+
 }
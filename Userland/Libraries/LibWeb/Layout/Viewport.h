@@ -21,6 +21,9 @@ public:
 
     const DOM::Document& dom_node() const { return static_cast<const DOM::Document&>(*Node::dom_node()); }
 
+    // Determines which boxes are relayout boundaries, see Box::is_relayout_boundary().
+    void update_relayout_boundaries();
+
 private:
     virtual JS::GCPtr<Painting::Paintable> create_paintable() const override;
 
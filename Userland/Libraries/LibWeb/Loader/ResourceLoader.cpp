@@ -227,6 +227,83 @@ static bool should_block_request(LoadRequest const& request)
     return false;
 }
 
+static void deliver_preloaded_response(LoadRequest const& request, PreloadedResponse const& response, ResourceLoader::SuccessCallback const& success_callback, ResourceLoader::ErrorCallback const& error_callback)
+{
+    auto const& status_code = response.status_code;
+    if (!response.success || (status_code.has_value() && *status_code >= 400 && *status_code <= 599 && (response.payload.is_empty() || !request.is_main_resource()))) {
+        StringBuilder error_builder;
+        if (status_code.has_value())
+            error_builder.appendff("Load failed: {}", *status_code);
+        else
+            error_builder.append("Load failed"sv);
+        log_failure(request, error_builder.string_view());
+        if (error_callback)
+            error_callback(error_builder.to_byte_string(), status_code, response.payload, response.response_headers);
+        return;
+    }
+
+    log_success(request);
+    success_callback(response.payload, response.response_headers, status_code);
+}
+
+RefPtr<PreloadedResponse> ResourceLoader::preload(LoadRequest& request)
+{
+    auto const& url = request.url();
+
+    if (!url.scheme().is_one_of("http"sv, "https"sv) || request.method() != "GET"sv || !request.body().is_empty())
+        return nullptr;
+
+    log_request_start(request);
+    request.start_timer();
+
+    if (should_block_request(request))
+        return nullptr;
+
+    auto protocol_request = start_network_request(request);
+    if (!protocol_request)
+        return nullptr;
+
+    auto preloaded_response = adopt_ref(*new PreloadedResponse);
+
+    auto on_buffered_request_finished = [this, request, preloaded_response, &protocol_request = *protocol_request](bool success, auto, auto& response_headers, auto status_code, ReadonlyBytes payload) mutable {
+        handle_network_response_headers(request, response_headers);
+        finish_network_request(protocol_request);
+
+        auto maybe_payload = ByteBuffer::copy(payload);
+        preloaded_response->finished = true;
+        preloaded_response->success = success && !maybe_payload.is_error();
+        preloaded_response->response_headers = response_headers;
+        preloaded_response->status_code = status_code;
+        if (!maybe_payload.is_error())
+            preloaded_response->payload = maybe_payload.release_value();
+
+        if (preloaded_response->waiting_request.has_value())
+            deliver_preloaded_response(*preloaded_response->waiting_request, preloaded_response, preloaded_response->success_callback, preloaded_response->error_callback);
+    };
+
+    protocol_request->set_buffered_request_finished_callback(move(on_buffered_request_finished));
+    return preloaded_response;
+}
+
+void ResourceLoader::load_preloaded(LoadRequest& request, NonnullRefPtr<PreloadedResponse> preloaded_response, SuccessCallback success_callback, ErrorCallback error_callback)
+{
+    dbgln_if(SPAM_DEBUG, "ResourceLoader: Using preloaded response for \"{}\"", sanitized_url_for_logging(request.url()));
+
+    log_request_start(request);
+    request.start_timer();
+
+    if (!preloaded_response->finished) {
+        preloaded_response->waiting_request = request;
+        preloaded_response->success_callback = move(success_callback);
+        preloaded_response->error_callback = move(error_callback);
+        return;
+    }
+
+    Platform::EventLoopPlugin::the().deferred_invoke([request, preloaded_response = move(preloaded_response), success_callback = move(success_callback), error_callback = move(error_callback)] {
+        deliver_preloaded_response(request, preloaded_response, success_callback, error_callback);
+    });
+}
+
 void ResourceLoader::load(LoadRequest& request, SuccessCallback success_callback, ErrorCallback error_callback, Optional<u32> timeout, TimeoutCallback timeout_callback)
 {
     auto const& url = request.url();
@@ -504,7 +581,7 @@ RefPtr<ResourceLoaderConnectorRequest> ResourceLoader::start_network_request(Loa
 
     HTTP::HeaderMap headers;
     headers.set("User-Agent", m_user_agent.to_byte_string());
-    headers.set("Accept-Encoding", "gzip, deflate, br");
+    headers.set("Accept-Encoding", "gzip, deflate, br, zstd");
 
     for (auto const& it : request.headers()) {
         headers.set(it.key, it.value);
@@ -84,6 +84,12 @@ public:
 
     void load_unbuffered(LoadRequest&, OnHeadersReceived, OnDataReceived, OnComplete);
 
+    // Starts loading a resource before anyone has asked for it, e.g. when the HTML parser speculatively discovers it.
+    // The caller keeps the returned response around, and serves a later request for the same resource from it with
+    // load_preloaded() instead of hitting the network a second time.
+    RefPtr<PreloadedResponse> preload(LoadRequest&);
+    void load_preloaded(LoadRequest&, NonnullRefPtr<PreloadedResponse>, SuccessCallback success_callback, ErrorCallback error_callback = nullptr);
+
     ResourceLoaderConnector& connector() { return *m_connector; }
 
     void prefetch_dns(URL::URL const&);
@@ -119,4 +125,18 @@ private:
     Optional<JS::GCPtr<Page>> m_page {};
 };
 
+class PreloadedResponse : public RefCounted<PreloadedResponse> {
+public:
+    bool finished { false };
+    bool success { false };
+    HTTP::HeaderMap response_headers;
+    Optional<u32> status_code;
+    ByteBuffer payload;
+
+    // Set if a request came in for the response while it was still in flight.
+    Optional<LoadRequest> waiting_request;
+    ResourceLoader::SuccessCallback success_callback;
+    ResourceLoader::ErrorCallback error_callback;
+};
+
 }
@@ -69,6 +69,10 @@ void ViewportPaintable::paint_all_phases(PaintContext& context)
 
 void ViewportPaintable::assign_scroll_frames()
 {
+    // NOTE: The viewport paintable survives relayout of a subtree, so drop the scroll frames of previous layouts.
+    scroll_state.clear();
+    m_needs_to_refresh_scroll_state = true;
+
     int next_id = 0;
     for_each_in_subtree_of_type<PaintableBox>([&](auto const& paintable_box) {
         if (paintable_box.has_scrollable_overflow()) {
@@ -98,6 +102,9 @@ void ViewportPaintable::assign_scroll_frames()
 
 void ViewportPaintable::assign_clip_frames()
 {
+    clip_state.clear();
+    m_needs_to_refresh_clip_state = true;
+
     for_each_in_subtree_of_type<PaintableBox>([&](auto const& paintable_box) {
         auto overflow_x = paintable_box.computed_values().overflow_x();
         auto overflow_y = paintable_box.computed_values().overflow_y();
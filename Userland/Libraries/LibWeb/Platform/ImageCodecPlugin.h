@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <AK/RefCounted.h>
 #include <AK/RefPtr.h>
 #include <AK/Vector.h>
 #include <LibCore/Promise.h>
@@ -19,10 +20,22 @@ struct Frame {
     size_t duration { 0 };
 };
 
+// Decodes the frames of an animated image that weren't decoded up front, for as long as it is kept alive.
+class FrameSource : public RefCounted<FrameSource> {
+public:
+    virtual ~FrameSource() = default;
+
+    // NOTE: on_decoded is not called if the frame can't be decoded.
+    virtual void request_frame(size_t frame_index, Function<void(Frame&)> on_decoded) = 0;
+};
+
 struct DecodedImage {
     bool is_animated { false };
     u32 loop_count { 0 };
+    u32 frame_count { 0 };
+    // If this holds fewer than frame_count frames, the others have to be requested from the frame source.
     Vector<Frame> frames;
+    RefPtr<FrameSource> frame_source;
 };
 
 class ImageCodecPlugin {
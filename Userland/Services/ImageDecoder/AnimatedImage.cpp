@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <ImageDecoder/AnimatedImage.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/ImageFormats/ScanlineDownscaler.h>
+
+namespace ImageDecoder {
+
+ErrorOr<Gfx::ImageFrameDescriptor> decode_frame(Gfx::ImageDecoder const& decoder, size_t index, Optional<Gfx::IntSize> ideal_size, Optional<Gfx::IntRect> region)
+{
+    auto frame = region.has_value() ? TRY(decoder.frame_region(index, *region, ideal_size)) : TRY(decoder.frame(index, ideal_size));
+
+    // Decoders that can't scale images down natively return them at a larger size, but there's no need to send all of
+    // that to the client.
+    auto const& bitmap = *frame.image;
+    if (auto factor = Gfx::ScanlineDownscaler::factor_for_ideal_size(bitmap.size(), ideal_size); factor > 1)
+        frame.image = TRY(Gfx::ScanlineDownscaler::downscale(bitmap, bitmap.rect(), factor));
+    return frame;
+}
+
+NonnullRefPtr<AnimatedImage> AnimatedImage::create(Core::AnonymousBuffer encoded_data, NonnullRefPtr<Gfx::ImageDecoder> decoder, Optional<Gfx::IntSize> ideal_size, Optional<Gfx::IntRect> region, size_t cache_budget_in_bytes)
+{
+    return adopt_ref(*new AnimatedImage(move(encoded_data), move(decoder), ideal_size, region, cache_budget_in_bytes));
+}
+
+AnimatedImage::AnimatedImage(Core::AnonymousBuffer encoded_data, NonnullRefPtr<Gfx::ImageDecoder> decoder, Optional<Gfx::IntSize> ideal_size, Optional<Gfx::IntRect> region, size_t cache_budget_in_bytes)
+    : m_encoded_data(move(encoded_data))
+    , m_decoder(move(decoder))
+    , m_ideal_size(ideal_size)
+    , m_region(region)
+    , m_cache_budget_in_bytes(cache_budget_in_bytes)
+{
+}
+
+ErrorOr<DecodedFrame> AnimatedImage::frame(size_t index)
+{
+    if (index >= frame_count())
+        return Error::from_string_literal("Invalid frame index");
+
+    for (size_t i = 0; i < m_cached_frames.size(); ++i) {
+        if (m_cached_frames[i].index != index)
+            continue;
+        auto cached_frame = m_cached_frames.take(i);
+        auto frame = cached_frame.frame;
+        m_cached_frames.append(move(cached_frame));
+        return frame;
+    }
+
+    auto descriptor = TRY(decode_frame(*m_decoder, index, m_ideal_size, m_region));
+    DecodedFrame frame { descriptor.image->to_shareable_bitmap(), static_cast<u32>(descriptor.duration) };
+    if (!frame.bitmap.is_valid())
+        return Error::from_string_literal("Could not allocate frame bitmap");
+
+    add_to_cache(index, frame);
+    return frame;
+}
+
+void AnimatedImage::add_to_cache(size_t index, DecodedFrame const& frame)
+{
+    auto size_in_bytes = frame.bitmap.bitmap()->size_in_bytes();
+    if (size_in_bytes > m_cache_budget_in_bytes)
+        return;
+
+    while (m_cached_bytes + size_in_bytes > m_cache_budget_in_bytes)
+        m_cached_bytes -= m_cached_frames.take_first().size_in_bytes;
+
+    m_cached_frames.append({ index, frame, size_in_bytes });
+    m_cached_bytes += size_in_bytes;
+}
+
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/AtomicRefCounted.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Vector.h>
+#include <LibCore/AnonymousBuffer.h>
+#include <LibGfx/ImageFormats/ImageDecoder.h>
+#include <LibGfx/ShareableBitmap.h>
+
+namespace ImageDecoder {
+
+ErrorOr<Gfx::ImageFrameDescriptor> decode_frame(Gfx::ImageDecoder const&, size_t index, Optional<Gfx::IntSize> ideal_size, Optional<Gfx::IntRect> region);
+
+struct DecodedFrame {
+    Gfx::ShareableBitmap bitmap;
+    u32 duration { 0 };
+};
+
+// Keeps the decoder of an animated image around between frame requests, so that frames can be decoded as the client
+// needs them instead of all at once. Most plugins decode frames incrementally, so playing the animation in order never
+// has to go back to the first frame. Recently decoded frames are cached, up to a budget of bytes.
+// NOTE: Frames are only ever decoded on the background thread, so none of this needs any locking.
+class AnimatedImage : public AtomicRefCounted<AnimatedImage> {
+public:
+    static constexpr size_t default_cache_budget_in_bytes = 32 * MiB;
+
+    static NonnullRefPtr<AnimatedImage> create(Core::AnonymousBuffer encoded_data, NonnullRefPtr<Gfx::ImageDecoder>, Optional<Gfx::IntSize> ideal_size, Optional<Gfx::IntRect> region, size_t cache_budget_in_bytes = default_cache_budget_in_bytes);
+
+    size_t frame_count() const { return m_decoder->frame_count(); }
+    size_t cached_bytes() const { return m_cached_bytes; }
+
+    ErrorOr<DecodedFrame> frame(size_t index);
+
+private:
+    AnimatedImage(Core::AnonymousBuffer encoded_data, NonnullRefPtr<Gfx::ImageDecoder>, Optional<Gfx::IntSize> ideal_size, Optional<Gfx::IntRect> region, size_t cache_budget_in_bytes);
+
+    struct CachedFrame {
+        size_t index { 0 };
+        DecodedFrame frame;
+        size_t size_in_bytes { 0 };
+    };
+
+    void add_to_cache(size_t index, DecodedFrame const&);
+
+    // The decoder reads straight from the encoded data, so this has to be destroyed after it.
+    Core::AnonymousBuffer m_encoded_data;
+    NonnullRefPtr<Gfx::ImageDecoder> m_decoder;
+    Optional<Gfx::IntSize> m_ideal_size;
+    Optional<Gfx::IntRect> m_region;
+
+    // Ordered from least to most recently used.
+    Vector<CachedFrame> m_cached_frames;
+    size_t m_cached_bytes { 0 };
+    size_t m_cache_budget_in_bytes { 0 };
+};
+
+}
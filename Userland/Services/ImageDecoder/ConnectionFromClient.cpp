@@ -24,15 +24,20 @@ void ConnectionFromClient::die()
         job->cancel();
     }
     m_pending_jobs.clear();
+    for (auto& [_, job] : m_pending_frame_jobs) {
+        job->cancel();
+    }
+    m_pending_frame_jobs.clear();
+    m_animated_images.clear();
 
     Threading::quit_background_thread();
     Core::EventLoop::current().quit(0);
 }
 
-static void decode_image_to_bitmaps_and_durations_with_decoder(Gfx::ImageDecoder const& decoder, Optional<Gfx::IntSize> ideal_size, Vector<Gfx::ShareableBitmap>& bitmaps, Vector<u32>& durations)
+static void decode_image_to_bitmaps_and_durations_with_decoder(Gfx::ImageDecoder const& decoder, Optional<Gfx::IntSize> ideal_size, Optional<Gfx::IntRect> region, Vector<Gfx::ShareableBitmap>& bitmaps, Vector<u32>& durations)
 {
     for (size_t i = 0; i < decoder.frame_count(); ++i) {
-        auto frame_or_error = decoder.frame(i, ideal_size);
+        auto frame_or_error = decode_frame(decoder, i, ideal_size, region);
         if (frame_or_error.is_error()) {
             bitmaps.append(Gfx::ShareableBitmap {});
             durations.append(0);
@@ -44,7 +49,7 @@ static void decode_image_to_bitmaps_and_durations_with_decoder(Gfx::ImageDecoder
     }
 }
 
-static ErrorOr<ConnectionFromClient::DecodeResult> decode_image_to_details(Core::AnonymousBuffer const& encoded_buffer, Optional<Gfx::IntSize> ideal_size, Optional<ByteString> const& known_mime_type)
+static ErrorOr<ConnectionFromClient::DecodeResult> decode_image_to_details(Core::AnonymousBuffer const& encoded_buffer, Optional<Gfx::IntSize> ideal_size, Optional<Gfx::IntRect> region, Optional<ByteString> const& known_mime_type)
 {
     auto decoder = TRY(Gfx::ImageDecoder::try_create_for_raw_bytes(ReadonlyBytes { encoded_buffer.data<u8>(), encoded_buffer.size() }, known_mime_type));
 
@@ -57,6 +62,7 @@ static ErrorOr<ConnectionFromClient::DecodeResult> decode_image_to_details(Core:
     ConnectionFromClient::DecodeResult result;
     result.is_animated = decoder->is_animated();
     result.loop_count = decoder->loop_count();
+    result.frame_count = decoder->frame_count();
 
     if (auto maybe_metadata = decoder->metadata(); maybe_metadata.has_value() && is<Gfx::ExifMetadata>(*maybe_metadata)) {
         auto const& exif = static_cast<Gfx::ExifMetadata const&>(maybe_metadata.value());
@@ -70,7 +76,17 @@ static ErrorOr<ConnectionFromClient::DecodeResult> decode_image_to_details(Core:
         }
     }
 
-    decode_image_to_bitmaps_and_durations_with_decoder(*decoder, move(ideal_size), result.bitmaps, result.durations);
+    if (result.is_animated && result.frame_count > 1) {
+        // Send the first frame right away, and keep the decoder around for the rest.
+        auto animated_image = AnimatedImage::create(encoded_buffer, decoder.release_nonnull(), ideal_size, region);
+        auto first_frame = TRY(animated_image->frame(0));
+        result.bitmaps.append(move(first_frame.bitmap));
+        result.durations.append(first_frame.duration);
+        result.animated_image = move(animated_image);
+        return result;
+    }
+
+    decode_image_to_bitmaps_and_durations_with_decoder(*decoder, move(ideal_size), move(region), result.bitmaps, result.durations);
 
     if (result.bitmaps.is_empty())
         return Error::from_string_literal("Could not decode image");
@@ -78,14 +94,16 @@ static ErrorOr<ConnectionFromClient::DecodeResult> decode_image_to_details(Core:
     return result;
 }
 
-NonnullRefPtr<ConnectionFromClient::Job> ConnectionFromClient::make_decode_image_job(i64 image_id, Core::AnonymousBuffer encoded_buffer, Optional<Gfx::IntSize> ideal_size, Optional<ByteString> mime_type)
+NonnullRefPtr<ConnectionFromClient::Job> ConnectionFromClient::make_decode_image_job(i64 image_id, Core::AnonymousBuffer encoded_buffer, Optional<Gfx::IntSize> ideal_size, Optional<Gfx::IntRect> region, Optional<ByteString> mime_type)
 {
     return Job::construct(
-        [encoded_buffer = move(encoded_buffer), ideal_size = move(ideal_size), mime_type = move(mime_type)](auto&) -> ErrorOr<DecodeResult> {
-            return TRY(decode_image_to_details(encoded_buffer, ideal_size, mime_type));
+        [encoded_buffer = move(encoded_buffer), ideal_size = move(ideal_size), region = move(region), mime_type = move(mime_type)](auto&) -> ErrorOr<DecodeResult> {
+            return TRY(decode_image_to_details(encoded_buffer, ideal_size, region, mime_type));
         },
         [strong_this = NonnullRefPtr(*this), image_id](DecodeResult result) -> ErrorOr<void> {
-            strong_this->async_did_decode_image(image_id, result.is_animated, result.loop_count, result.bitmaps, result.durations, result.scale);
+            if (result.animated_image)
+                strong_this->m_animated_images.set(image_id, result.animated_image.release_nonnull());
+            strong_this->async_did_decode_image(image_id, result.is_animated, result.loop_count, result.frame_count, result.bitmaps, result.durations, result.scale);
             strong_this->m_pending_jobs.remove(image_id);
             return {};
         },
@@ -96,7 +114,27 @@ NonnullRefPtr<ConnectionFromClient::Job> ConnectionFromClient::make_decode_image
         });
 }
 
-Messages::ImageDecoderServer::DecodeImageResponse ConnectionFromClient::decode_image(Core::AnonymousBuffer const& encoded_buffer, Optional<Gfx::IntSize> const& ideal_size, Optional<ByteString> const& mime_type)
+NonnullRefPtr<ConnectionFromClient::FrameJob> ConnectionFromClient::make_decode_frame_job(i64 request_id, i64 image_id, u32 frame_index, NonnullRefPtr<AnimatedImage> animated_image)
+{
+    return FrameJob::construct(
+        [animated_image = move(animated_image), frame_index](auto&) -> ErrorOr<DecodedFrame> {
+            return TRY(animated_image->frame(frame_index));
+        },
+        [strong_this = NonnullRefPtr(*this), request_id, image_id, frame_index](DecodedFrame frame) -> ErrorOr<void> {
+            // The client may have lost interest in the image while the frame was being decoded.
+            if (strong_this->m_animated_images.contains(image_id))
+                strong_this->async_did_decode_frame(image_id, frame_index, frame.bitmap, frame.duration);
+            strong_this->m_pending_frame_jobs.remove(request_id);
+            return {};
+        },
+        [strong_this = NonnullRefPtr(*this), request_id, image_id, frame_index](Error error) -> void {
+            if (strong_this->is_open())
+                strong_this->async_did_fail_to_decode_frame(image_id, frame_index, MUST(String::formatted("Decoding failed: {}", error)));
+            strong_this->m_pending_frame_jobs.remove(request_id);
+        });
+}
+
+Messages::ImageDecoderServer::DecodeImageResponse ConnectionFromClient::decode_image(Core::AnonymousBuffer const& encoded_buffer, Optional<Gfx::IntSize> const& ideal_size, Optional<Gfx::IntRect> const& region, Optional<ByteString> const& mime_type)
 {
     auto image_id = m_next_image_id++;
 
@@ -106,7 +144,7 @@ Messages::ImageDecoderServer::DecodeImageResponse ConnectionFromClient::decode_i
         return image_id;
     }
 
-    m_pending_jobs.set(image_id, make_decode_image_job(image_id, encoded_buffer, ideal_size, mime_type));
+    m_pending_jobs.set(image_id, make_decode_image_job(image_id, encoded_buffer, ideal_size, region, mime_type));
 
     return image_id;
 }
@@ -118,4 +156,22 @@ void ConnectionFromClient::cancel_decoding(i64 image_id)
     }
 }
 
+void ConnectionFromClient::request_frame(i64 image_id, u32 frame_index)
+{
+    auto animated_image = m_animated_images.get(image_id);
+    if (!animated_image.has_value()) {
+        async_did_fail_to_decode_frame(image_id, frame_index, "No animated image with this ID"_string);
+        return;
+    }
+
+    auto request_id = m_next_frame_request_id++;
+    m_pending_frame_jobs.set(request_id, make_decode_frame_job(request_id, image_id, frame_index, *animated_image.value()));
+}
+
+void ConnectionFromClient::release_image(i64 image_id)
+{
+    // Frame jobs that are still pending keep the image alive until they are done.
+    m_animated_images.remove(image_id);
+}
+
 }
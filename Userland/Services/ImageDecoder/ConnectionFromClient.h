@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/HashMap.h>
+#include <ImageDecoder/AnimatedImage.h>
 #include <ImageDecoder/Forward.h>
 #include <ImageDecoder/ImageDecoderClientEndpoint.h>
 #include <ImageDecoder/ImageDecoderServerEndpoint.h>
@@ -27,23 +28,34 @@ public:
     struct DecodeResult {
         bool is_animated = false;
         u32 loop_count = 0;
+        u32 frame_count = 0;
         Gfx::FloatPoint scale { 1, 1 };
         Vector<Gfx::ShareableBitmap> bitmaps;
         Vector<u32> durations;
+        // Only the first frame of an animated image is decoded up front, the others are decoded as they are requested.
+        RefPtr<AnimatedImage> animated_image;
     };
 
 private:
     using Job = Threading::BackgroundAction<DecodeResult>;
+    using FrameJob = Threading::BackgroundAction<DecodedFrame>;
 
     explicit ConnectionFromClient(NonnullOwnPtr<Core::LocalSocket>);
 
-    virtual Messages::ImageDecoderServer::DecodeImageResponse decode_image(Core::AnonymousBuffer const&, Optional<Gfx::IntSize> const& ideal_size, Optional<ByteString> const& mime_type) override;
+    virtual Messages::ImageDecoderServer::DecodeImageResponse decode_image(Core::AnonymousBuffer const&, Optional<Gfx::IntSize> const& ideal_size, Optional<Gfx::IntRect> const& region, Optional<ByteString> const& mime_type) override;
     virtual void cancel_decoding(i64 image_id) override;
+    virtual void request_frame(i64 image_id, u32 frame_index) override;
+    virtual void release_image(i64 image_id) override;
 
-    NonnullRefPtr<Job> make_decode_image_job(i64 image_id, Core::AnonymousBuffer, Optional<Gfx::IntSize> ideal_size, Optional<ByteString> mime_type);
+    NonnullRefPtr<Job> make_decode_image_job(i64 image_id, Core::AnonymousBuffer, Optional<Gfx::IntSize> ideal_size, Optional<Gfx::IntRect> region, Optional<ByteString> mime_type);
+    NonnullRefPtr<FrameJob> make_decode_frame_job(i64 request_id, i64 image_id, u32 frame_index, NonnullRefPtr<AnimatedImage>);
 
     i64 m_next_image_id { 0 };
     HashMap<i64, NonnullRefPtr<Job>> m_pending_jobs;
+
+    i64 m_next_frame_request_id { 0 };
+    HashMap<i64, NonnullRefPtr<FrameJob>> m_pending_frame_jobs;
+    HashMap<i64, NonnullRefPtr<AnimatedImage>> m_animated_images;
 };
 
 }
@@ -14,6 +14,7 @@ namespace RequestServer::ConnectionCache {
 Threading::RWLockProtected<HashMap<ConnectionKey, NonnullOwnPtr<Vector<NonnullOwnPtr<Connection<Core::TCPSocket, Core::Socket>>>>>> g_tcp_connection_cache {};
 Threading::RWLockProtected<HashMap<ConnectionKey, NonnullOwnPtr<Vector<NonnullOwnPtr<Connection<TLS::TLSv12>>>>>> g_tls_connection_cache {};
 Threading::RWLockProtected<HashMap<ByteString, InferredServerProperties>> g_inferred_server_properties;
+NonnullRefPtr<TLS::SessionCache> g_tls_session_cache = TLS::SessionCache::create();
 
 void request_did_finish(URL::URL const& url, Core::Socket const* socket)
 {
@@ -174,6 +174,7 @@ struct InferredServerProperties {
 extern Threading::RWLockProtected<HashMap<ConnectionKey, NonnullOwnPtr<Vector<NonnullOwnPtr<Connection<Core::TCPSocket, Core::Socket>>>>>> g_tcp_connection_cache;
 extern Threading::RWLockProtected<HashMap<ConnectionKey, NonnullOwnPtr<Vector<NonnullOwnPtr<Connection<TLS::TLSv12>>>>>> g_tls_connection_cache;
 extern Threading::RWLockProtected<HashMap<ByteString, InferredServerProperties>> g_inferred_server_properties;
+extern NonnullRefPtr<TLS::SessionCache> g_tls_session_cache;
 
 void request_did_finish(URL::URL const&, Core::Socket const*);
 void dump_jobs();
@@ -182,6 +183,19 @@ constexpr static size_t MaxConcurrentConnectionsPerURL = 4;
 constexpr static size_t ConnectionKeepAliveTimeMilliseconds = 10'000;
 constexpr static size_t ConnectionCacheQueueHighWatermark = 4;
 
+template<typename T>
+Coroutine<ErrorOr<NonnullOwnPtr<typename T::StorageType>>> create_socket(Proxy& proxy, URL::URL const& url)
+{
+    if constexpr (IsSame<TLS::TLSv12, typename T::SocketType>) {
+        // Note: All TLS connections share one session cache, so that connecting to a host again can resume an earlier session.
+        TLS::Options options;
+        options.set_session_cache(g_tls_session_cache);
+        co_return co_await proxy.tunnel<typename T::SocketType, typename T::StorageType>(url, move(options));
+    } else {
+        co_return co_await proxy.tunnel<typename T::SocketType, typename T::StorageType>(url);
+    }
+}
+
 template<typename T>
 Coroutine<ErrorOr<void>> recreate_socket_if_needed(T& connection, URL::URL const& url)
 {
@@ -215,6 +229,7 @@ Coroutine<ErrorOr<void>> recreate_socket_if_needed(T& connection, URL::URL const
                     return connection.job_data->provide_client_certificates();
                 return {};
             });
+            options.set_session_cache(g_tls_session_cache);
             CO_TRY(set_socket(CO_TRY(co_await (connection.proxy.template tunnel<SocketType, SocketStorageType>(url, move(options))))));
         } else {
             CO_TRY(set_socket(CO_TRY(co_await (connection.proxy.template tunnel<SocketType, SocketStorageType>(url)))));
@@ -267,7 +282,7 @@ Coroutine<void> async_get_or_create_connection(auto& cache, URL::URL url, auto j
             socket_for_url->is_being_started = false;
         };
 
-        auto connection_result = co_await proxy.tunnel<typename ConnectionType::SocketType, typename ConnectionType::StorageType>(url);
+        auto connection_result = co_await create_socket<ConnectionType>(proxy, url);
         if (connection_result.is_error()) {
             dbgln("ConnectionCache: Connection to {} failed: {}", url, connection_result.error());
             Core::deferred_invoke([job] {
@@ -10,6 +10,37 @@
 
 namespace WebContent {
 
+class FrameSource final : public Web::Platform::FrameSource {
+public:
+    FrameSource(NonnullRefPtr<ImageDecoderClient::Client> client, i64 image_id)
+        : m_client(move(client))
+        , m_image_id(image_id)
+    {
+    }
+
+    virtual ~FrameSource() override
+    {
+        m_client->release_image(m_image_id);
+    }
+
+    virtual void request_frame(size_t frame_index, Function<void(Web::Platform::Frame&)> on_decoded) override
+    {
+        (void)m_client->request_frame(
+            m_image_id,
+            frame_index,
+            [on_decoded = move(on_decoded)](ImageDecoderClient::Frame& frame) -> ErrorOr<void> {
+                Web::Platform::Frame decoded_frame { move(frame.bitmap), frame.duration };
+                on_decoded(decoded_frame);
+                return {};
+            },
+            {});
+    }
+
+private:
+    NonnullRefPtr<ImageDecoderClient::Client> m_client;
+    i64 m_image_id { 0 };
+};
+
 ImageCodecPluginSerenity::ImageCodecPluginSerenity() = default;
 ImageCodecPluginSerenity::~ImageCodecPluginSerenity() = default;
 
@@ -30,14 +61,17 @@ NonnullRefPtr<Core::Promise<Web::Platform::DecodedImage>> ImageCodecPluginSereni
 
     auto image_decoder_promise = m_client->decode_image(
         bytes,
-        [promise](ImageDecoderClient::DecodedImage& result) -> ErrorOr<void> {
+        [promise, client = NonnullRefPtr(*m_client)](ImageDecoderClient::DecodedImage& result) -> ErrorOr<void> {
             // FIXME: Remove this codec plugin and just use the ImageDecoderClient directly to avoid these copies
             Web::Platform::DecodedImage decoded_image;
             decoded_image.is_animated = result.is_animated;
             decoded_image.loop_count = result.loop_count;
+            decoded_image.frame_count = result.frame_count;
             for (auto const& frame : result.frames) {
                 decoded_image.frames.empend(move(frame.bitmap), frame.duration);
             }
+            if (decoded_image.frames.size() < decoded_image.frame_count)
+                decoded_image.frame_source = adopt_ref(*new FrameSource(client, result.image_id));
             promise->resolve(move(decoded_image));
             return {};
         },
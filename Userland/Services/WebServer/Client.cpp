@@ -13,6 +13,9 @@
 #include <AK/NumberFormat.h>
 #include <AK/QuickSort.h>
 #include <AK/StringBuilder.h>
+#include <LibCompress/Brotli.h>
+#include <LibCompress/Gzip.h>
+#include <LibCompress/Zstd.h>
 #include <LibCore/DateTime.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
@@ -176,8 +179,70 @@ ErrorOr<bool> Client::handle_request(HTTP::HttpRequest const& request)
     return true;
 }
 
+static bool is_compressible_mime_type(StringView type)
+{
+    return type.starts_with("text/"sv)
+        || type.is_one_of("application/javascript"sv, "application/json"sv, "application/xml"sv, "application/xhtml+xml"sv, "image/svg+xml"sv);
+}
+
+// https://httpwg.org/specs/rfc9110.html#field.accept-encoding
+static Client::ContentEncoding negotiate_content_encoding(HTTP::HttpRequest const& request)
+{
+    using ContentEncoding = Client::ContentEncoding;
+
+    auto it = request.headers().headers().find_if([](auto& header) { return header.name.equals_ignoring_ascii_case("Accept-Encoding"sv); });
+    if (it.is_end())
+        return ContentEncoding::Identity;
+
+    Optional<double> zstd_weight;
+    Optional<double> brotli_weight;
+    Optional<double> gzip_weight;
+    Optional<double> wildcard_weight;
+
+    it->value.view().for_each_split_view(',', SplitBehavior::Nothing, [&](StringView element) {
+        auto parts = element.split_view(';');
+        auto coding = parts[0].trim_whitespace();
+
+        double weight = 1;
+        for (auto parameter : parts.span().slice(1)) {
+            parameter = parameter.trim_whitespace();
+            if (parameter.starts_with("q="sv, CaseSensitivity::CaseInsensitive))
+                weight = parameter.substring_view(2).to_number<double>().value_or(0);
+        }
+
+        if (coding.equals_ignoring_ascii_case("zstd"sv))
+            zstd_weight = weight;
+        else if (coding.equals_ignoring_ascii_case("br"sv))
+            brotli_weight = weight;
+        else if (coding.equals_ignoring_ascii_case("gzip"sv) || coding.equals_ignoring_ascii_case("x-gzip"sv))
+            gzip_weight = weight;
+        else if (coding == "*"sv)
+            wildcard_weight = weight;
+    });
+
+    auto zstd = zstd_weight.value_or(wildcard_weight.value_or(0));
+    auto brotli = brotli_weight.value_or(wildcard_weight.value_or(0));
+    auto gzip = gzip_weight.value_or(wildcard_weight.value_or(0));
+
+    // Among the codings with the highest weight, prefer the fastest one that compresses at least as well as gzip.
+    auto best_weight = max(zstd, max(brotli, gzip));
+    if (best_weight <= 0)
+        return ContentEncoding::Identity;
+    if (zstd == best_weight)
+        return ContentEncoding::Zstd;
+    if (brotli == best_weight)
+        return ContentEncoding::Brotli;
+    return ContentEncoding::Gzip;
+}
+
 ErrorOr<void> Client::send_response(Stream& response, HTTP::HttpRequest const& request, ContentInfo content_info)
 {
+    bool is_compressible = is_compressible_mime_type(content_info.type);
+    if (is_compressible && content_info.encoding.is_empty() && content_info.length <= maximum_compressed_response_length) {
+        if (auto encoding = negotiate_content_encoding(request); encoding != ContentEncoding::Identity)
+            return send_compressed_response(response, request, move(content_info), encoding);
+    }
+
     StringBuilder builder;
     TRY(builder.try_append("HTTP/1.0 200 OK\r\n"sv));
     TRY(builder.try_append("Server: WebServer (SerenityOS)\r\n"sv));
@@ -188,6 +253,10 @@ ErrorOr<void> Client::send_response(Stream& response, HTTP::HttpRequest const& r
         TRY(builder.try_appendff("Content-Type: {}; charset=utf-8\r\n", content_info.type));
     else
         TRY(builder.try_appendff("Content-Type: {}\r\n", content_info.type));
+    if (!content_info.encoding.is_empty())
+        TRY(builder.try_appendff("Content-Encoding: {}\r\n", content_info.encoding));
+    if (is_compressible)
+        TRY(builder.try_append("Vary: Accept-Encoding\r\n"sv));
     TRY(builder.try_appendff("Content-Length: {}\r\n", content_info.length));
     TRY(builder.try_append("\r\n"sv));
 
@@ -224,6 +293,33 @@ ErrorOr<void> Client::send_response(Stream& response, HTTP::HttpRequest const& r
     return {};
 }
 
+ErrorOr<void> Client::send_compressed_response(Stream& response, HTTP::HttpRequest const& request, ContentInfo content_info, ContentEncoding encoding)
+{
+    auto data = TRY(response.read_until_eof());
+
+    ByteBuffer compressed;
+    switch (encoding) {
+    case ContentEncoding::Zstd:
+        compressed = TRY(Compress::ZstdCompressor::compress_all(data));
+        content_info.encoding = "zstd"sv;
+        break;
+    case ContentEncoding::Brotli:
+        compressed = TRY(Compress::BrotliCompressor::compress_all(data));
+        content_info.encoding = "br"sv;
+        break;
+    case ContentEncoding::Gzip:
+        compressed = TRY(Compress::GzipCompressor::compress_all(data));
+        content_info.encoding = "gzip"sv;
+        break;
+    case ContentEncoding::Identity:
+        VERIFY_NOT_REACHED();
+    }
+
+    FixedMemoryStream stream { compressed.bytes() };
+    content_info.length = compressed.size();
+    return send_response(stream, request, move(content_info));
+}
+
 ErrorOr<void> Client::send_redirect(StringView redirect_path, HTTP::HttpRequest const& request)
 {
     StringBuilder builder;
@@ -19,6 +19,13 @@ class Client final : public Core::EventReceiver {
     C_OBJECT(Client);
 
 public:
+    enum class ContentEncoding {
+        Identity,
+        Zstd,
+        Brotli,
+        Gzip,
+    };
+
     void start();
 
 private:
@@ -29,11 +36,16 @@ private:
     struct ContentInfo {
         String type;
         u64 length {};
+        StringView encoding {}; // The Content-Encoding, if the content has been compressed.
     };
 
+    // Larger responses are sent as they are, as they would have to be compressed in memory.
+    static constexpr u64 maximum_compressed_response_length = 16 * MiB;
+
     ErrorOr<void, WrappedError> on_ready_to_read();
     ErrorOr<bool> handle_request(HTTP::HttpRequest const&);
     ErrorOr<void> send_response(Stream&, HTTP::HttpRequest const&, ContentInfo);
+    ErrorOr<void> send_compressed_response(Stream&, HTTP::HttpRequest const&, ContentInfo, ContentEncoding);
     ErrorOr<void> send_redirect(StringView redirect, HTTP::HttpRequest const&);
     ErrorOr<void> send_error_response(unsigned code, HTTP::HttpRequest const&, Vector<String> const& headers = {});
     void die();
@@ -14,6 +14,7 @@
 #include <LibCrypto/Authentication/GHash.h>
 #include <LibCrypto/Authentication/HMAC.h>
 #include <LibCrypto/Authentication/Poly1305.h>
+#include <LibCrypto/CPUFeatures.h>
 #include <LibCrypto/Checksum/Adler32.h>
 #include <LibCrypto/Checksum/CRC32.h>
 #include <LibCrypto/Cipher/AES.h>
@@ -27,27 +28,41 @@
 #include <LibCrypto/Hash/SHA2.h>
 #include <LibMain/Main.h>
 
-#define ALL_ALGORITHMS(E)                                            \
-    E(md5, hash, Hash::MD5)                                          \
-    E(sha1, hash, Hash::SHA1)                                        \
-    E(sha256, hash, Hash::SHA256)                                    \
-    E(sha512, hash, Hash::SHA512)                                    \
-    E(blake2b, hash, Hash::BLAKE2b)                                  \
-    E(adler32, checksum, Checksum::Adler32)                          \
-    E(crc32, checksum, Checksum::CRC32)                              \
-    E(hmac_md5, auth, Authentication::HMAC<Crypto::Hash::MD5>)       \
-    E(hmac_sha1, auth, Authentication::HMAC<Crypto::Hash::SHA1>)     \
-    E(hmac_sha256, auth, Authentication::HMAC<Crypto::Hash::SHA256>) \
-    E(hmac_sha512, auth, Authentication::HMAC<Crypto::Hash::SHA512>) \
-    E(poly1305, auth, Authentication::Poly1305)                      \
-    E(ghash, auth, Authentication::GHash)                            \
-    E(aes_128_cbc, cipher, Cipher::AESCipher::CBCMode, 128)          \
-    E(aes_128_ctr, cipher, Cipher::AESCipher::CTRMode, 128)          \
-    E(aes_128_gcm, cipher, Cipher::AESCipher::GCMMode, 128)          \
-    E(aes_256_cbc, cipher, Cipher::AESCipher::CBCMode, 256)          \
-    E(aes_256_ctr, cipher, Cipher::AESCipher::CTRMode, 256)          \
-    E(chacha20_128, cipher, Cipher::ChaCha20, 128, 96)               \
-    E(chacha20_256, cipher, Cipher::ChaCha20, 256, 96)
+// The accelerated implementation of an algorithm (if any), and the CPU features that it needs.
+struct AcceleratedImplementation {
+    StringView instruction_sets;
+    Crypto::CPUFeatures features { Crypto::CPUFeatures::None };
+};
+
+static constexpr AcceleratedImplementation portable_only {};
+static constexpr AcceleratedImplementation aes_ni { "AES-NI"sv, Crypto::CPUFeatures::AES | Crypto::CPUFeatures::SSSE3 };
+static constexpr AcceleratedImplementation aes_ni_pclmul { "AES-NI+PCLMULQDQ"sv, Crypto::CPUFeatures::AES | Crypto::CPUFeatures::PCLMUL | Crypto::CPUFeatures::SSSE3 };
+static constexpr AcceleratedImplementation pclmul_ghash { "PCLMULQDQ"sv, Crypto::CPUFeatures::PCLMUL | Crypto::CPUFeatures::SSSE3 };
+static constexpr AcceleratedImplementation pclmul_crc32 { "PCLMULQDQ"sv, Crypto::CPUFeatures::PCLMUL | Crypto::CPUFeatures::SSE41 };
+static constexpr AcceleratedImplementation sha_ni { "SHA-NI"sv, Crypto::CPUFeatures::SHA | Crypto::CPUFeatures::SSE41 };
+
+#define ALL_ALGORITHMS(E)                                                           \
+    E(md5, hash, portable_only, Hash::MD5)                                          \
+    E(sha1, hash, sha_ni, Hash::SHA1)                                               \
+    E(sha256, hash, sha_ni, Hash::SHA256)                                           \
+    E(sha512, hash, portable_only, Hash::SHA512)                                    \
+    E(blake2b, hash, portable_only, Hash::BLAKE2b)                                  \
+    E(adler32, checksum, portable_only, Checksum::Adler32)                          \
+    E(crc32, checksum, pclmul_crc32, Checksum::CRC32)                               \
+    E(hmac_md5, auth, portable_only, Authentication::HMAC<Crypto::Hash::MD5>)       \
+    E(hmac_sha1, auth, sha_ni, Authentication::HMAC<Crypto::Hash::SHA1>)            \
+    E(hmac_sha256, auth, sha_ni, Authentication::HMAC<Crypto::Hash::SHA256>)        \
+    E(hmac_sha512, auth, portable_only, Authentication::HMAC<Crypto::Hash::SHA512>) \
+    E(poly1305, auth, portable_only, Authentication::Poly1305)                      \
+    E(ghash, auth, pclmul_ghash, Authentication::GHash)                             \
+    E(aes_128_cbc, cipher, aes_ni, Cipher::AESCipher::CBCMode, 128)                 \
+    E(aes_128_ctr, cipher, aes_ni, Cipher::AESCipher::CTRMode, 128)                 \
+    E(aes_128_gcm, cipher, aes_ni_pclmul, Cipher::AESCipher::GCMMode, 128)          \
+    E(aes_256_cbc, cipher, aes_ni, Cipher::AESCipher::CBCMode, 256)                 \
+    E(aes_256_ctr, cipher, aes_ni, Cipher::AESCipher::CTRMode, 256)                 \
+    E(aes_256_gcm, cipher, aes_ni_pclmul, Cipher::AESCipher::GCMMode, 256)          \
+    E(chacha20_128, cipher, portable_only, Cipher::ChaCha20, 128, 96)               \
+    E(chacha20_256, cipher, portable_only, Cipher::ChaCha20, 256, 96)
 
 struct Timings {
     u64 total_us { 0 };
@@ -56,7 +71,7 @@ struct Timings {
     size_t count { 0 };
     size_t unit_bytes { 0 };
 };
-static HashMap<StringView, HashMap<size_t, Timings>> g_all_timings;
+static OrderedHashMap<ByteString, HashMap<size_t, Timings>> g_all_timings;
 static auto g_time_slice_per_size = Duration::from_seconds(3);
 
 constexpr size_t sizes_in_bytes[] = { 16, 1 * KiB, 16 * KiB, 256 * KiB, 1 * MiB, 16 * MiB };
@@ -141,7 +156,8 @@ static ErrorOr<void> run_cipher_benchmark(StringView name, size_t key_bits, Opti
 
     auto out_buffer = TRY(ByteBuffer::create_uninitialized(16 * MiB));
 
-    auto iv = TRY(ByteBuffer::create_uninitialized(key_bits / 8));
+    // The IV of the block cipher modes is one block long, regardless of the key size.
+    auto iv = TRY(ByteBuffer::create_uninitialized(16));
     fill_with_random(iv);
 
     auto remaining_options = Tuple { options... };
@@ -160,7 +176,11 @@ static ErrorOr<void> run_cipher_benchmark(StringView name, size_t key_bits, Opti
         else
             cipher = Algorithm(key.bytes(), key_bits, Crypto::Cipher::Intent::Encryption);
         auto out_bytes = out_buffer.bytes();
-        if constexpr (requires { cipher->encrypt(buffer, out_bytes, iv.bytes()); })
+        if constexpr (IsSame<Algorithm, Crypto::Cipher::AESCipher::GCMMode>) {
+            // Authenticate the data itself, without any associated data.
+            u8 tag[16];
+            cipher->encrypt(buffer, out_bytes.trim(buffer.size()), iv.bytes(), {}, { tag, sizeof(tag) });
+        } else if constexpr (requires { cipher->encrypt(buffer, out_bytes, iv.bytes()); })
             cipher->encrypt(buffer, out_bytes, iv.bytes());
         else
             cipher->encrypt(buffer, out_bytes);
@@ -169,12 +189,30 @@ static ErrorOr<void> run_cipher_benchmark(StringView name, size_t key_bits, Opti
     return {};
 }
 
+// Runs a benchmark with the portable implementation, and with the accelerated one if this CPU supports it.
+static ErrorOr<void> run_with_each_implementation(StringView name, AcceleratedImplementation const& accelerated, Function<ErrorOr<void>(StringView)> run_benchmark)
+{
+    Crypto::set_enabled_cpu_features(Crypto::CPUFeatures::None);
+    TRY(run_benchmark(ByteString::formatted("{} (portable)", name)));
+
+    Crypto::set_enabled_cpu_features(Crypto::CPUFeatures::All);
+    if (accelerated.features != Crypto::CPUFeatures::None) {
+        if (Crypto::has_cpu_features(accelerated.features))
+            TRY(run_benchmark(ByteString::formatted("{} ({})", name, accelerated.instruction_sets)));
+        else
+            warnln("Skipping the {} implementation of {}, which this CPU doesn't support", accelerated.instruction_sets, name);
+    }
+    return {};
+}
+
 static ErrorOr<void> benchmark(StringView algorithm)
 {
-#define BENCH(name, type, algo, ...)                                                       \
-    if (algorithm == #name) {                                                              \
-        outln("Benchmarking {}...", #name);                                                \
-        return run_##type##_benchmark<Crypto::algo>(#name##sv __VA_OPT__(, ) __VA_ARGS__); \
+#define BENCH(name, type, accelerated, algo, ...)                                                        \
+    if (algorithm == #name) {                                                                            \
+        outln("Benchmarking {}...", #name);                                                              \
+        return run_with_each_implementation(#name##sv, accelerated, [&](StringView benchmark_name) {     \
+            return run_##type##_benchmark<Crypto::algo>(benchmark_name __VA_OPT__(, ) __VA_ARGS__);      \
+        });                                                                                              \
     }
 
     ALL_ALGORITHMS(BENCH);
@@ -187,14 +225,14 @@ static ErrorOr<void> benchmark(StringView algorithm)
 static void print_benchmark_results()
 {
     // algo, size, min, max, avg, throughput
-    outln("{:<20} {:<10} {:<10} {:<10} {:<10} {:<10}", "Algorithm", "Size", "Min us/op", "Max us/op", "Avg us/op", "Throughput");
+    outln("{:<30} {:<10} {:<10} {:<10} {:<10} {:<10}", "Algorithm", "Size", "Min us/op", "Max us/op", "Avg us/op", "Throughput");
     for (auto& [algo, timings] : g_all_timings) {
         for (auto size : sizes_in_bytes) {
             auto t = timings.get(size);
             if (!t.has_value())
                 continue;
             auto& timing = t.value();
-            outln("{:<20} {:<10} {:<10} {:<10} {:<10} {:<10}/s",
+            outln("{:<30} {:<10} {:<10} {:<10} {:<10} {:<10}/s",
                 algo,
                 human_readable_size(timing.unit_bytes),
                 timing.min_us,
@@ -219,9 +257,9 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         .long_name = "list",
         .short_name = 'l',
         .accept_value = [](auto) -> bool {
-            warnln("{:<20} {:<10}", "Algorithm", "Type");
-#define BENCH(name, type, ...) \
-    warnln("{:<20} {:<10}", #name, #type);
+            warnln("{:<20} {:<10} {:<10}", "Algorithm", "Type", "Accelerated");
+#define BENCH(name, type, accelerated, ...) \
+    warnln("{:<20} {:<10} {:<10}", #name, #type, accelerated.instruction_sets.is_empty() ? "-"sv : accelerated.instruction_sets);
 
             ALL_ALGORITHMS(BENCH);
 #undef BENCH
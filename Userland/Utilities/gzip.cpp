@@ -20,11 +20,15 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     bool keep_input_files { false };
     bool write_to_stdout { false };
     bool decompress { false };
+    Optional<size_t> thread_count;
+    bool write_index { false };
 
     Core::ArgsParser args_parser;
     args_parser.add_option(keep_input_files, "Keep (don't delete) input files", "keep", 'k');
     args_parser.add_option(write_to_stdout, "Write to stdout, keep original files unchanged", "stdout", 'c');
     args_parser.add_option(decompress, "Decompress", "decompress", 'd');
+    args_parser.add_option(thread_count, "Compress on this many threads at once (0 for one per CPU)", "threads", 'j', "count");
+    args_parser.add_option(write_index, "Write an index for seeking next to each compressed file, instead of decompressing it", "index");
     args_parser.add_positional_argument(filenames, "Files", "FILES", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
@@ -46,6 +50,19 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     if (write_to_stdout)
         keep_input_files = true;
 
+    if (write_index) {
+        for (auto const& input_filename : filenames) {
+            auto mapped_file = TRY(Core::MappedFile::map(input_filename));
+            auto index = TRY(Compress::GzipIndex::create(mapped_file->bytes()));
+
+            auto index_filename = ByteString::formatted("{}{}", input_filename, Compress::GzipIndex::sidecar_suffix);
+            auto index_file = TRY(Core::OutputBufferedFile::create(TRY(Core::File::open(index_filename, Core::File::OpenMode::Write))));
+            TRY(index.write_to_stream(*index_file));
+            TRY(index_file->flush_buffer());
+        }
+        return 0;
+    }
+
     for (auto const& input_filename : filenames) {
         OwnPtr<Stream> output_stream;
 
@@ -71,8 +88,16 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         // Buffer reads, which yields a significant performance improvement.
         NonnullOwnPtr<Stream> input_stream = TRY(Core::InputBufferedFile::create(move(input_file), 1 * MiB));
 
+        Compress::ParallelGzipCompressor* parallel_compressor = nullptr;
         if (decompress) {
             input_stream = TRY(try_make<Compress::GzipDecompressor>(move(input_stream)));
+        } else if (thread_count.has_value()) {
+            Optional<size_t> threads_to_use;
+            if (thread_count.value() != 0)
+                threads_to_use = thread_count.value();
+            auto compressor = TRY(Compress::ParallelGzipCompressor::construct(output_stream.release_nonnull(), threads_to_use));
+            parallel_compressor = compressor.ptr();
+            output_stream = move(compressor);
         } else {
             output_stream = TRY(try_make<Compress::GzipCompressor>(output_stream.release_nonnull()));
         }
@@ -84,6 +109,9 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             TRY(output_stream->write_until_depleted(span));
         }
 
+        if (parallel_compressor)
+            TRY(parallel_compressor->finish());
+
         if (!keep_input_files)
             TRY(Core::System::unlink(input_filename));
     }
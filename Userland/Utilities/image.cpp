@@ -150,7 +150,7 @@ static ErrorOr<OwnPtr<Core::MappedFile>> convert_image_profile(LoadedImage& imag
     return icc_file;
 }
 
-static ErrorOr<void> save_image(LoadedImage& image, StringView out_path, bool ppm_ascii, u8 jpeg_quality, Optional<unsigned> webp_allowed_transforms)
+static ErrorOr<void> save_image(LoadedImage& image, StringView out_path, bool ppm_ascii, u8 jpeg_quality, Optional<unsigned> webp_allowed_transforms, Gfx::PNGWriter::Options::CompressionLevel png_compression_level, bool png_compress_in_parallel)
 {
     auto stream = [out_path]() -> ErrorOr<NonnullOwnPtr<Core::OutputBufferedFile>> {
         auto output_stream = TRY(Core::File::open(out_path, Core::File::OpenMode::Write));
@@ -196,7 +196,11 @@ static ErrorOr<void> save_image(LoadedImage& image, StringView out_path, bool pp
     if (out_path.ends_with(".bmp"sv, CaseSensitivity::CaseInsensitive)) {
         bytes = TRY(Gfx::BMPWriter::encode(*frame, { .icc_data = image.icc_data }));
     } else if (out_path.ends_with(".png"sv, CaseSensitivity::CaseInsensitive)) {
-        bytes = TRY(Gfx::PNGWriter::encode(*frame, { .icc_data = image.icc_data }));
+        Gfx::PNGWriter::Options options;
+        options.icc_data = image.icc_data;
+        options.compression_level = png_compression_level;
+        options.compress_in_parallel = png_compress_in_parallel;
+        bytes = TRY(Gfx::PNGWriter::encode(*frame, options));
     } else if (out_path.ends_with(".qoi"sv, CaseSensitivity::CaseInsensitive)) {
         bytes = TRY(Gfx::QOIWriter::encode(*frame));
     } else {
@@ -222,6 +226,8 @@ struct Options {
     bool ppm_ascii = false;
     u8 quality = 75;
     Optional<unsigned> webp_allowed_transforms;
+    Gfx::PNGWriter::Options::CompressionLevel png_compression_level = Gfx::PNGWriter::Options::CompressionLevel::Best;
+    bool png_compress_in_parallel = false;
 };
 
 template<class T>
@@ -264,6 +270,17 @@ static ErrorOr<unsigned> parse_webp_allowed_transforms_string(StringView string)
     return allowed_transforms;
 }
 
+static ErrorOr<Gfx::PNGWriter::Options::CompressionLevel> parse_png_compression_level_string(StringView string)
+{
+    if (string == "fast"sv)
+        return Gfx::PNGWriter::Options::CompressionLevel::Fast;
+    if (string == "default"sv)
+        return Gfx::PNGWriter::Options::CompressionLevel::Default;
+    if (string == "best"sv)
+        return Gfx::PNGWriter::Options::CompressionLevel::Best;
+    return Error::from_string_view("unknown PNG compression level; valid values: fast, default, best"sv);
+}
+
 static ErrorOr<Options> parse_options(Main::Arguments arguments)
 {
     Options options;
@@ -284,6 +301,9 @@ static ErrorOr<Options> parse_options(Main::Arguments arguments)
     args_parser.add_option(options.quality, "Quality used for the JPEG encoder, the default value is 75 on a scale from 0 to 100", "quality", {}, {});
     StringView webp_allowed_transforms = "default"sv;
     args_parser.add_option(webp_allowed_transforms, "Comma-separated list of allowed transforms (predictor,p,color,c,subtract-green,sg,color-indexing,ci) for WebP output (default: all allowed)", "webp-allowed-transforms", {}, {});
+    StringView png_compression_level;
+    args_parser.add_option(png_compression_level, "Compression level (fast,default,best) for PNG output (default: best)", "png-compression-level", {}, {});
+    args_parser.add_option(options.png_compress_in_parallel, "Compress PNG output on multiple threads", "png-compress-in-parallel", {});
     args_parser.parse(arguments);
 
     if (options.out_path.is_empty() ^ options.no_output)
@@ -293,6 +313,8 @@ static ErrorOr<Options> parse_options(Main::Arguments arguments)
         options.crop_rect = TRY(parse_rect_string(crop_rect_string));
     if (webp_allowed_transforms != "default"sv)
         options.webp_allowed_transforms = TRY(parse_webp_allowed_transforms_string(webp_allowed_transforms));
+    if (!png_compression_level.is_empty())
+        options.png_compression_level = TRY(parse_png_compression_level_string(png_compression_level));
 
     return options;
 }
@@ -335,7 +357,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     if (options.no_output)
         return 0;
 
-    TRY(save_image(image, options.out_path, options.ppm_ascii, options.quality, options.webp_allowed_transforms));
+    TRY(save_image(image, options.out_path, options.ppm_ascii, options.quality, options.webp_allowed_transforms, options.png_compression_level, options.png_compress_in_parallel));
 
     return 0;
 }
@@ -10,6 +10,8 @@
 #include <AK/LexicalPath.h>
 #include <AK/Span.h>
 #include <AK/Vector.h>
+#include <LibArchive/Extraction.h>
+#include <LibArchive/ReadAheadStream.h>
 #include <LibArchive/TarStream.h>
 #include <LibCompress/Gzip.h>
 #include <LibCompress/Lzma.h>
@@ -17,15 +19,45 @@
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/Directory.h>
+#include <LibCore/MappedFile.h>
 #include <LibCore/System.h>
 #include <LibFileSystem/FileSystem.h>
 #include <LibMain/Main.h>
-#include <fcntl.h>
 #include <stdio.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
 constexpr size_t buffer_size = 4096;
+constexpr size_t file_buffer_size = 256 * KiB;
+
+// XZ files can always be seeked in using the Index of their Blocks, gzip files only if an index was written next to them.
+// Returns null if the archive has to be decompressed from start to end instead.
+static ErrorOr<OwnPtr<Stream>> open_seekable_decompressor(StringView archive_file, ReadonlyBytes archive, bool gzip)
+{
+    if (!gzip) {
+        // If the Index is broken, the regular decompressor will tell where the file stops making sense.
+        auto decompressor_or_error = Compress::SeekableXzDecompressor::create(archive);
+        if (decompressor_or_error.is_error())
+            return nullptr;
+        return decompressor_or_error.release_value();
+    }
+
+    auto index_file_or_error = Core::File::open(ByteString::formatted("{}{}", archive_file, Compress::GzipIndex::sidecar_suffix), Core::File::OpenMode::Read);
+    if (index_file_or_error.is_error())
+        return nullptr;
+
+    auto index_or_error = Compress::GzipIndex::read_from_stream(*TRY(Core::InputBufferedFile::create(index_file_or_error.release_value())));
+    if (index_or_error.is_error()) {
+        warnln("Ignoring the index of {}: {}", archive_file, index_or_error.error());
+        return nullptr;
+    }
+    if (!index_or_error.value().matches(archive)) {
+        warnln("Ignoring the index of {}, which was written for a different version of it", archive_file);
+        return nullptr;
+    }
+
+    return TRY(Compress::SeekableGzipDecompressor::create(archive, index_or_error.release_value()));
+}
 
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
@@ -72,21 +104,41 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     }
 
     if (list || extract) {
-        NonnullOwnPtr<Stream> input_stream = TRY(Core::InputBufferedFile::create(TRY(Core::File::open_file_or_standard_stream(archive_file, Core::File::OpenMode::Read))));
+        // Listing skips over the contents of the files, which a seekable decompressor can do without decompressing them.
+        OwnPtr<Core::MappedFile> mapped_archive;
+        OwnPtr<Stream> input_stream;
+        if (list && (gzip || xz) && !archive_file.is_empty() && archive_file != "-"sv) {
+            if (auto mapped_archive_or_error = Core::MappedFile::map(archive_file); !mapped_archive_or_error.is_error()) {
+                mapped_archive = mapped_archive_or_error.release_value();
+                input_stream = TRY(open_seekable_decompressor(archive_file, mapped_archive->bytes(), gzip));
+            }
+        }
 
-        if (!directory.is_empty())
-            TRY(Core::System::chdir(directory));
+        if (!input_stream) {
+            NonnullOwnPtr<Stream> stream = TRY(Core::InputBufferedFile::create(TRY(Core::File::open_file_or_standard_stream(archive_file, Core::File::OpenMode::Read))));
 
-        if (gzip)
-            input_stream = make<Compress::GzipDecompressor>(move(input_stream));
+            if (gzip)
+                stream = make<Compress::GzipDecompressor>(move(stream));
 
-        if (lzma)
-            input_stream = TRY(Compress::LzmaDecompressor::create_from_container(move(input_stream)));
+            if (lzma)
+                stream = TRY(Compress::LzmaDecompressor::create_from_container(move(stream)));
 
-        if (xz)
-            input_stream = TRY(Compress::XzDecompressor::create(move(input_stream)));
+            if (xz)
+                stream = TRY(Compress::XzDecompressor::create(move(stream)));
+
+            // Decompress on a separate thread, so that it overlaps with writing out the files.
+            if (gzip || lzma || xz)
+                stream = TRY(Archive::ReadAheadStream::create(move(stream)));
+
+            input_stream = move(stream);
+        }
+
+        if (!directory.is_empty())
+            TRY(Core::System::chdir(directory));
+
+        auto tar_stream = TRY(Archive::TarInputStream::construct(input_stream.release_nonnull()));
 
-        auto tar_stream = TRY(Archive::TarInputStream::construct(move(input_stream)));
+        auto file_buffer = TRY(ByteBuffer::create_uninitialized(file_buffer_size));
 
         HashMap<ByteString, ByteString> global_overrides;
         HashMap<ByteString, ByteString> local_overrides;
@@ -176,15 +228,14 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
                 case Archive::TarFileType::AlternateNormalFile: {
                     MUST(Core::Directory::create(parent_path, Core::Directory::CreateDirectories::Yes));
 
-                    int fd = TRY(Core::System::open(absolute_path, O_CREAT | O_WRONLY, header_mode));
+                    auto file = TRY(Archive::create_file_for_extraction(absolute_path, header_mode, TRY(header.size())));
 
-                    Array<u8, buffer_size> buffer;
                     while (!file_stream.is_eof()) {
-                        auto slice = TRY(file_stream.read_some(buffer));
-                        TRY(Core::System::write(fd, slice));
+                        auto slice = TRY(file_stream.read_some(file_buffer));
+                        TRY(file->write_until_depleted(slice));
                     }
 
-                    TRY(Core::System::close(fd));
+                    file->close();
                     break;
                 }
                 case Archive::TarFileType::SymLink: {
@@ -238,7 +289,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             output_stream = TRY(Compress::LzmaCompressor::create_container(move(output_stream), {}));
 
         if (xz)
-            TODO();
+            output_stream = TRY(Compress::XzCompressor::create(move(output_stream)));
 
         Archive::TarOutputStream tar_stream(move(output_stream));
 
@@ -4,103 +4,17 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <AK/Assertions.h>
 #include <AK/DOSPackedTime.h>
-#include <AK/NumberFormat.h>
 #include <AK/StringUtils.h>
+#include <LibArchive/Extraction.h>
 #include <LibArchive/Zip.h>
-#include <LibCompress/Deflate.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DateTime.h>
 #include <LibCore/Directory.h>
-#include <LibCore/File.h>
 #include <LibCore/MappedFile.h>
 #include <LibCore/System.h>
-#include <LibCrypto/Checksum/CRC32.h>
-#include <LibFileSystem/FileSystem.h>
 #include <sys/stat.h>
 
-static ErrorOr<void> adjust_modification_time(Archive::ZipMember const& zip_member)
-{
-    auto time = time_from_packed_dos(zip_member.modification_date, zip_member.modification_time);
-    auto seconds = static_cast<time_t>(time.seconds_since_epoch());
-    struct utimbuf buf {
-        .actime = seconds,
-        .modtime = seconds
-    };
-
-    return Core::System::utime(zip_member.name, buf);
-}
-
-static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
-{
-    if (zip_member.is_directory) {
-        if (auto maybe_error = Core::System::mkdir(zip_member.name, 0755); maybe_error.is_error()) {
-            warnln("Failed to create directory '{}': {}", zip_member.name, maybe_error.error());
-            return false;
-        }
-        if (!quiet)
-            outln(" extracting: {}", zip_member.name);
-        return true;
-    }
-    MUST(Core::Directory::create(LexicalPath(zip_member.name.to_byte_string()).parent(), Core::Directory::CreateDirectories::Yes));
-    auto new_file_or_error = Core::File::open(zip_member.name.to_byte_string(), Core::File::OpenMode::Write);
-    if (new_file_or_error.is_error()) {
-        warnln("Can't write file {}: {}", zip_member.name, new_file_or_error.release_error());
-        return false;
-    }
-    auto new_file = new_file_or_error.release_value();
-
-    if (!quiet)
-        outln(" extracting: {}", zip_member.name);
-
-    Crypto::Checksum::CRC32 checksum;
-    switch (zip_member.compression_method) {
-    case Archive::ZipCompressionMethod::Store: {
-        if (auto maybe_error = new_file->write_until_depleted(zip_member.compressed_data); maybe_error.is_error()) {
-            warnln("Can't write file contents in {}: {}", zip_member.name, maybe_error.release_error());
-            return false;
-        }
-        checksum.update({ zip_member.compressed_data.data(), zip_member.compressed_data.size() });
-        break;
-    }
-    case Archive::ZipCompressionMethod::Deflate: {
-        auto decompressed_data = Compress::DeflateDecompressor::decompress_all(zip_member.compressed_data);
-        if (decompressed_data.is_error()) {
-            warnln("Failed decompressing file {}: {}", zip_member.name, decompressed_data.error());
-            return false;
-        }
-        if (decompressed_data.value().size() != zip_member.uncompressed_size) {
-            warnln("Failed decompressing file {}", zip_member.name);
-            return false;
-        }
-        if (auto maybe_error = new_file->write_until_depleted(decompressed_data.value()); maybe_error.is_error()) {
-            warnln("Can't write file contents in {}: {}", zip_member.name, maybe_error.release_error());
-            return false;
-        }
-        checksum.update(decompressed_data.value());
-        break;
-    }
-    default:
-        VERIFY_NOT_REACHED();
-    }
-
-    if (adjust_modification_time(zip_member).is_error()) {
-        warnln("Failed setting modification_time for file {}", zip_member.name);
-        return false;
-    }
-
-    new_file->close();
-
-    if (checksum.digest() != zip_member.crc32) {
-        warnln("Failed decompressing file {}: CRC32 mismatch", zip_member.name);
-        MUST(FileSystem::remove(zip_member.name, FileSystem::RecursionMode::Disallowed));
-        return false;
-    }
-
-    return true;
-}
-
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
     StringView zip_file_path;
@@ -108,11 +22,13 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     bool list_files { false };
     StringView output_directory_path;
     Vector<StringView> file_filters;
+    Optional<size_t> thread_count;
 
     Core::ArgsParser args_parser;
     args_parser.add_option(list_files, "Only list files in the archive", "list", 'l');
     args_parser.add_option(output_directory_path, "Directory to receive the archive content", "output-directory", 'd', "path");
     args_parser.add_option(quiet, "Be less verbose", "quiet", 'q');
+    args_parser.add_option(thread_count, "Extract on this many threads at once (0 for one per CPU, the default)", "threads", 'j', "count");
     args_parser.add_positional_argument(zip_file_path, "File to unzip", "path", Core::ArgsParser::Required::Yes);
     args_parser.add_positional_argument(file_filters, "Files or filters in the archive to extract", "files", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
@@ -160,9 +76,9 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         return 0;
     }
 
-    Vector<Archive::ZipMember> zip_directories;
+    Vector<Archive::ZipMember> zip_members;
 
-    auto success = TRY(zip_file->for_each_member([&](auto zip_member) {
+    TRY(zip_file->for_each_member([&](auto zip_member) -> ErrorOr<IterationDecision> {
         bool keep_file = false;
 
         if (!file_filters.is_empty()) {
@@ -178,26 +94,23 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             keep_file = true;
         }
 
-        if (keep_file) {
-            if (!unpack_zip_member(zip_member, quiet))
-                return IterationDecision::Break;
-            if (zip_member.is_directory)
-                zip_directories.append(zip_member);
-        }
+        if (keep_file)
+            TRY(zip_members.try_append(zip_member));
 
         return IterationDecision::Continue;
     }));
 
-    if (!success) {
-        return 1;
-    }
+    // The central directory says where every member starts, so they can be extracted on several threads.
+    Optional<size_t> threads_to_use;
+    if (thread_count.value_or(0) != 0)
+        threads_to_use = thread_count.value();
 
-    for (auto& directory : zip_directories) {
-        if (adjust_modification_time(directory).is_error()) {
-            warnln("Failed setting modification time for directory {}", directory.name);
-            return 1;
-        }
-    }
+    auto result = Archive::extract_zip_members(zip_members, threads_to_use, [&](Archive::ZipMember const& zip_member, ErrorOr<void> const& member_result) {
+        if (member_result.is_error())
+            warnln("Failed to extract {}: {}", zip_member.name, member_result.error());
+        else if (!quiet)
+            outln(" extracting: {}", zip_member.name);
+    });
 
-    return success ? 0 : 1;
+    return result.is_error() ? 1 : 0;
 }
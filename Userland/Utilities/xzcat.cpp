@@ -7,20 +7,37 @@
 #include <LibCompress/Xz.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/File.h>
+#include <LibCore/MappedFile.h>
 #include <LibCore/System.h>
 #include <LibMain/Main.h>
 
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
-    TRY(Core::System::pledge("rpath stdio"));
+    TRY(Core::System::pledge("rpath stdio thread"));
 
     StringView filename;
+    Optional<size_t> thread_count;
 
     Core::ArgsParser args_parser;
     args_parser.set_general_help("Decompress and print an XZ archive");
+    args_parser.add_option(thread_count, "Decompress on this many threads at once (0 for one per CPU, the default)", "threads", 'j', "count");
     args_parser.add_positional_argument(filename, "File to decompress", "file");
     args_parser.parse(arguments);
 
+    // The Index of a file says where each of its Blocks starts, so the Blocks can be decompressed on several threads.
+    if (filename != "-"sv) {
+        auto mapped_file_or_error = Core::MappedFile::map(filename);
+        if (!mapped_file_or_error.is_error()) {
+            Optional<size_t> threads_to_use;
+            if (thread_count.value_or(0) != 0)
+                threads_to_use = thread_count.value();
+
+            auto output_stream = TRY(Core::File::standard_output());
+            TRY(Compress::XzDecompressor::decompress_all_in_parallel(mapped_file_or_error.value()->bytes(), *output_stream, threads_to_use));
+            return 0;
+        }
+    }
+
     auto file = TRY(Core::File::open_file_or_standard_stream(filename, Core::File::OpenMode::Read));
     auto buffered_file = TRY(Core::InputBufferedFile::create(move(file)));
     auto stream = TRY(Compress::XzDecompressor::create(move(buffered_file)));